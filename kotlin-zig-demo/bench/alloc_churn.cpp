@@ -0,0 +1,60 @@
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "bench_common.hpp"
+#include "dowel_steek_core.h"
+
+// Allocation churn at the sizes the Kotlin/Native bridge uses (16-256 bytes):
+// each thread keeps a window of live blocks and replaces one per operation,
+// so allocations and frees interleave the way marshalled strings and buffers
+// do. dowel_malloc/dowel_free against glibc malloc/free, 1 and 4 threads.
+
+static const int window = 256;
+static const std::int64_t ops_per_thread = 2000000;
+
+template <typename Alloc, typename Free>
+static void churn(std::int64_t ops, unsigned seed, Alloc alloc, Free release) {
+    std::vector<void*> live(window, nullptr);
+    std::uint32_t rng = 0x9e3779b9u * (seed + 1);
+    for (std::int64_t i = 0; i < ops; i++) {
+        rng = rng * 1664525u + 1013904223u;
+        size_t slot = rng % window;
+        release(live[slot]);
+        auto* block = static_cast<unsigned char*>(alloc(16 + (rng >> 16) % 241));
+        block[0] = 1;
+        live[slot] = block;
+    }
+    for (void* block : live) release(block);
+}
+
+template <typename Alloc, typename Free>
+static double run(int threads, Alloc alloc, Free release) {
+    return bench::measure(ops_per_thread, [&](std::int64_t ops) {
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; t++) workers.emplace_back([&, t] { churn(ops, unsigned(t), alloc, release); });
+        for (auto& worker : workers) worker.join();
+    }, 3) / threads;
+}
+
+int main() {
+    auto pool_alloc = [](size_t size) { return dowel_malloc(size); };
+    auto pool_free = [](void* ptr) { dowel_free(ptr); };
+    auto libc_alloc = [](size_t size) { return std::malloc(size); };
+    auto libc_free = [](void* ptr) { std::free(ptr); };
+
+    std::cout << "⚡ Allocation churn, 16-256 bytes (ns per alloc+free)\n";
+    std::cout << "======================================================\n";
+    for (int threads : {1, 4}) {
+        std::string suffix = ", " + std::to_string(threads) + (threads == 1 ? " thread" : " threads");
+        bench::report("glibc malloc/free" + suffix, run(threads, libc_alloc, libc_free));
+        bench::report("dowel_malloc/dowel_free" + suffix, run(threads, pool_alloc, pool_free));
+    }
+
+    std::vector<dowel_alloc_class_stats_t> stats(dowel_alloc_get_stats(nullptr, 0));
+    dowel_alloc_get_stats(stats.data(), stats.size());
+    size_t reserved = 0;
+    for (auto& entry : stats) reserved += entry.block_size ? entry.reserved_bytes : 0;
+    std::cout << "   pooled memory reserved: " << reserved / 1024 << " KiB\n";
+    return 0;
+}
@@ -0,0 +1,71 @@
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "bench_common.hpp"
+#include "dowel_steek_core.h"
+
+// A frame's worth of FFI scratch results: small digests, a formatted log line
+// and a decompressed payload per item. The heap variant frees each result
+// with dowel_free_buffer/dowel_free_string; the arena variant allocates them
+// with the *_in calls and releases the whole frame with one reset.
+
+static const int items_per_frame = 32;
+
+int main() {
+    dowel_core_init();
+
+    std::string text(512, 'a');
+    for (size_t i = 0; i < text.size(); i++) text[i] = char('a' + i % 23);
+    dowel_buffer_t* packed = dowel_compress_gzip(reinterpret_cast<const uint8_t*>(text.data()), text.size());
+    const uint8_t* id = reinterpret_cast<const uint8_t*>("user-42");
+
+    dowel_arena_t* arena = dowel_arena_create(0);
+
+    auto heap_frames = [&](bool with_payload) {
+        return bench::measure(20000, [&](std::int64_t frames) {
+            std::vector<dowel_buffer_t*> results;
+            std::vector<char*> lines;
+            for (std::int64_t f = 0; f < frames; f++) {
+                for (int i = 0; i < items_per_frame; i++) {
+                    results.push_back(dowel_crypto_hash_sha256(id, 7));
+                    if (with_payload) results.push_back(dowel_decompress_gzip(packed->data, packed->size));
+                    char* line = static_cast<char*>(malloc(64));
+                    snprintf(line, 64, "item %d of frame %lld", i, static_cast<long long>(f));
+                    lines.push_back(line);
+                }
+                for (auto* result : results) dowel_free_buffer(result);
+                for (auto* line : lines) dowel_free_string(line);
+                results.clear();
+                lines.clear();
+            }
+        }, 3) / items_per_frame;
+    };
+
+    auto arena_frames = [&](bool with_payload) {
+        return bench::measure(20000, [&](std::int64_t frames) {
+            for (std::int64_t f = 0; f < frames; f++) {
+                for (int i = 0; i < items_per_frame; i++) {
+                    bench::do_not_optimize(dowel_crypto_hash_sha256_in(arena, id, 7));
+                    if (with_payload) bench::do_not_optimize(dowel_decompress_gzip_in(arena, packed->data, packed->size));
+                    bench::do_not_optimize(
+                        dowel_arena_format(arena, "item %d of frame %lld", i, static_cast<long long>(f)));
+                }
+                dowel_arena_reset(arena);
+            }
+        }, 3) / items_per_frame;
+    };
+
+    std::cout << "⚡ Per-frame FFI results: heap vs arena (ns per item)\n";
+    std::cout << "=====================================================\n";
+    bench::report("digest + line, heap + dowel_free_*", heap_frames(false));
+    bench::report("digest + line, arena + one reset", arena_frames(false));
+    bench::report("with gunzip, heap + dowel_free_*", heap_frames(true));
+    bench::report("with gunzip, arena + one reset", arena_frames(true));
+
+    dowel_arena_destroy(arena);
+    dowel_free_buffer(packed);
+    dowel_core_shutdown();
+    return 0;
+}
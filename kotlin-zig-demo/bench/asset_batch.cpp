@@ -0,0 +1,76 @@
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+#include "bench_common.hpp"
+#include "dowel_steek_core.hpp"
+
+// Cold-start asset loading: a directory of 48 assets, 1-64 KB, each checked
+// for existence, size and modtime and then read. One call at a time, as the
+// loader does today, against a stat_directory + one read batch on io_uring
+// and on the thread backend. Files stay in the page cache, so this measures
+// syscall and dispatch overhead rather than the device.
+
+static const int asset_count = 48;
+
+int main() {
+    dowel::core_session session;
+
+    char dir_template[] = "/tmp/dowel_assets_XXXXXX";
+    std::string dir = mkdtemp(dir_template);
+    std::vector<std::string> paths;
+    for (int i = 0; i < asset_count; i++) {
+        paths.push_back(dir + "/asset" + std::to_string(i) + ".bin");
+        std::string body(size_t(1024 + (i * 7919) % (63 * 1024)), char('A' + i % 26));
+        dowel::storage::write_file(paths.back(), dowel::as_bytes(body));
+    }
+
+    // Contents go to a per-load arena in every variant, so all of them reuse
+    // the same memory instead of faulting in fresh heap pages
+    dowel::arena scratch;
+    double one_by_one = bench::measure(200, [&](std::int64_t n) {
+        for (std::int64_t r = 0; r < n; r++) {
+            for (const auto& path : paths) {
+                if (!dowel::storage::file_exists(path)) continue;
+                bench::do_not_optimize(dowel::storage::file_size(path));
+                bench::do_not_optimize(dowel::storage::file_modtime(path));
+                bench::do_not_optimize(dowel::storage::read_file(scratch, path).size());
+            }
+            scratch.reset();
+        }
+    }, 5);
+
+    auto batched = [&](bool use_ring) {
+        dowel_config_set_bool("storage.io_uring", use_ring);
+        return bench::measure(200, [&](std::int64_t n) {
+            for (std::int64_t r = 0; r < n; r++) {
+                auto entries = dowel::storage::stat_directory(dir);
+                std::vector<std::string> names;
+                std::vector<dowel_io_request_t> requests(entries.size());
+                names.reserve(entries.size());
+                for (size_t i = 0; i < entries.size(); i++) {
+                    names.push_back(dir + "/" + entries[i].name);
+                    requests[i] = {};
+                    requests[i].op = DOWEL_IO_READ;
+                    requests[i].path = names[i].c_str();
+                }
+                dowel::storage::submit(scratch, requests);
+                scratch.reset();
+            }
+        }, 5);
+    };
+    double ring_ns = batched(true);
+    std::string ring_backend(dowel::storage::backend());
+    double thread_ns = batched(false);
+    dowel_config_set_bool("storage.io_uring", true);
+
+    std::cout << "⚡ Asset load, " << asset_count << " files (per full load)\n";
+    std::cout << "==========================================\n";
+    bench::report("exists + size + modtime + read each", one_by_one);
+    bench::report("stat_directory + batch (" + ring_backend + ")", ring_ns);
+    bench::report("stat_directory + batch (threads)", thread_ns);
+
+    for (const auto& path : paths) dowel::storage::delete_file(path);
+    rmdir(dir.c_str());
+    return 0;
+}
@@ -0,0 +1,73 @@
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "bench_common.hpp"
+#include "dowel_steek_core.h"
+
+// Fan-out/fan-in over 1M tiny tasks (one relaxed increment each):
+//  - flat: spawned from the main thread through the injection queue, then
+//    waited for and freed in order
+//  - tree: a root task splits recursively, so tasks are pushed to and stolen
+//    from the workers' deques and waits run other tasks
+// against one std::thread per task, the previous dowel_async_spawn design,
+// measured on fewer tasks.
+
+static const int task_count = 1 << 20;
+static std::atomic<std::uint64_t> hits{0};
+
+static void tiny(void*) {
+    hits.fetch_add(1, std::memory_order_relaxed);
+}
+
+struct range {
+    int count;
+};
+
+static void split(void* data) {
+    int count = static_cast<range*>(data)->count;
+    if (count <= 1) {
+        tiny(nullptr);
+        return;
+    }
+    range left{count / 2};
+    range right{count - count / 2};
+    dowel_task_t* a = dowel_async_spawn(split, &left);
+    dowel_task_t* b = dowel_async_spawn(split, &right);
+    dowel_async_free_task(a);
+    dowel_async_free_task(b);
+}
+
+int main() {
+    dowel_core_init();
+    int workers = dowel_async_worker_count();
+
+    std::vector<dowel_task_t*> tasks(task_count);
+    double flat_ns = bench::measure(task_count, [&](std::int64_t n) {
+        for (std::int64_t i = 0; i < n; i++) tasks[size_t(i)] = dowel_async_spawn(tiny, nullptr);
+        for (std::int64_t i = 0; i < n; i++) dowel_async_free_task(tasks[size_t(i)]);
+    }, 3);
+
+    // A full binary tree over task_count leaves is about 2 * task_count tasks
+    double tree_ns = bench::measure(task_count, [&](std::int64_t n) {
+        range root{int(n)};
+        dowel_async_free_task(dowel_async_spawn(split, &root));
+    }, 3);
+
+    double thread_ns = bench::measure(2000, [&](std::int64_t n) {
+        std::vector<std::thread> threads;
+        for (std::int64_t i = 0; i < n; i++) threads.emplace_back(tiny, nullptr);
+        for (auto& thread : threads) thread.join();
+    }, 3);
+
+    std::cout << "⚡ Async fan-out/fan-in, " << task_count << " tiny tasks, " << workers << " workers\n";
+    std::cout << "=================================================================\n";
+    bench::report("flat spawn + wait (per task)", flat_ns);
+    bench::report_throughput("flat spawn + wait", 1e9 / flat_ns);
+    bench::report("recursive split (per leaf)", tree_ns);
+    bench::report_throughput("recursive split (leaves)", 1e9 / tree_ns);
+    bench::report("thread per task (2000 tasks)", thread_ns);
+
+    dowel_core_shutdown();
+    return hits.load() > 0 ? 0 : 1;
+}
@@ -0,0 +1,50 @@
+#ifndef DOWEL_BENCH_COMMON_HPP
+#define DOWEL_BENCH_COMMON_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+// Shared timing helpers for the core benchmarks
+
+namespace bench {
+
+// Keeps the optimizer from discarding a benchmarked result
+template <typename T>
+inline void do_not_optimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+inline std::int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Runs fn(iterations) a few times and returns the best ns per iteration
+template <typename F>
+inline double measure(std::int64_t iterations, F&& fn, int repeats = 5) {
+    double best = 1e300;
+    for (int r = 0; r < repeats; r++) {
+        std::int64_t start = now_ns();
+        fn(iterations);
+        double per_op = double(now_ns() - start) / double(iterations);
+        if (per_op < best) best = per_op;
+    }
+    return best;
+}
+
+inline void report(const std::string& name, double ns_per_op) {
+    std::cout << "   • " << std::left << std::setw(40) << name << std::right << std::fixed
+              << std::setprecision(1) << std::setw(12) << ns_per_op << " ns/op\n";
+}
+
+inline void report_throughput(const std::string& name, double ops_per_sec) {
+    std::cout << "   • " << std::left << std::setw(40) << name << std::right << std::fixed
+              << std::setprecision(2) << std::setw(12) << ops_per_sec / 1e6 << " Mops/s\n";
+}
+
+} // namespace bench
+
+#endif // DOWEL_BENCH_COMMON_HPP
@@ -0,0 +1,126 @@
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "bench_common.hpp"
+#include "dowel_steek_core.hpp"
+
+// 2000 small sync batches compressed one by one through a context reused
+// across messages, a context made per message and one-shot frames; then the
+// 6.7 MB export streamed through each codec in 16 KB pieces.
+
+static std::string read_sample(const std::string& name) {
+    std::string path = __FILE__;
+    path = path.substr(0, path.rfind('/')) + "/../../" + name;
+    std::ifstream in(path);
+    std::stringstream text;
+    text << in.rdbuf();
+    return text.str();
+}
+
+static const char* codec_name(dowel_codec_t codec) {
+    switch (codec) {
+        case DOWEL_CODEC_GZIP: return "gzip";
+        case DOWEL_CODEC_LZ4: return "lz4";
+        case DOWEL_CODEC_ZSTD: return "zstd";
+    }
+    return "?";
+}
+
+int main() {
+    dowel::core_session session;
+
+    std::cout << "🚰 Streaming codec contexts\n";
+    std::cout << "===========================\n";
+
+    std::vector<std::string> batches;
+    for (int b = 0; b < 2000; b++) {
+        std::string batch;
+        for (int i = 0; i < 30; i++) {
+            batch += "2024-01-15T12:00:" + std::to_string(i) + "Z INFO sync: pushed note " + std::to_string(b * 31 + i * 7 % 100003) +
+                " rev " + std::to_string(b + i) + "\n";
+        }
+        batches.push_back(batch);
+    }
+    std::size_t total = 0;
+    for (const std::string& batch : batches) total += batch.size();
+    std::cout << "\n2000 log batches of " << total / batches.size() << " bytes, per message\n";
+
+    for (dowel_codec_t codec : {DOWEL_CODEC_LZ4, DOWEL_CODEC_GZIP, DOWEL_CODEC_ZSTD}) {
+        if (!dowel::codec_available(codec)) {
+            std::cout << "   • " << codec_name(codec) << ": not built in\n";
+            continue;
+        }
+        std::size_t packed = 0;
+        auto count = [&](dowel::bytes_view out) { packed += out.size(); };
+        auto reused = dowel::codec_context::compressor(codec, 1, count);
+        double reused_ns = bench::measure(5, [&](std::int64_t n) {
+            for (std::int64_t i = 0; i < n; i++) {
+                for (const std::string& batch : batches) {
+                    reused.feed(batch);
+                    reused.finish();
+                }
+            }
+        }) / double(batches.size());
+        double fresh_ns = bench::measure(5, [&](std::int64_t n) {
+            for (std::int64_t i = 0; i < n; i++) {
+                for (const std::string& batch : batches) {
+                    auto fresh = dowel::codec_context::compressor(codec, 1, count);
+                    fresh.feed(batch);
+                    fresh.finish();
+                }
+            }
+        }) / double(batches.size());
+        double frame_ns = bench::measure(5, [&](std::int64_t n) {
+            for (std::int64_t i = 0; i < n; i++) {
+                for (const std::string& batch : batches) bench::do_not_optimize(dowel::compress(dowel::as_bytes(batch), codec, 1).size());
+            }
+        }) / double(batches.size());
+        std::string name = codec_name(codec);
+        bench::report(name + " reused context", reused_ns);
+        bench::report(name + " context per message", fresh_ns);
+        bench::report(name + " one-shot frame", frame_ns);
+        bench::do_not_optimize(packed);
+    }
+
+    std::string rag = read_sample("sample_rag_tools_conversation.json");
+    std::string export_text = "{\"conversations\":{";
+    for (int i = 0; i < 300; i++) {
+        if (i > 0) export_text += ",";
+        export_text += "\"conv_" + std::to_string(i) + "\":" + rag;
+    }
+    export_text += "}}";
+    double mb = double(export_text.size()) / 1e6;
+    std::cout << "\nexport of 300 conversations (" << export_text.size() << " bytes) in 16 KB pieces\n";
+
+    for (dowel_codec_t codec : {DOWEL_CODEC_LZ4, DOWEL_CODEC_GZIP, DOWEL_CODEC_ZSTD}) {
+        if (!dowel::codec_available(codec)) continue;
+        std::string packed;
+        auto keep = [&](dowel::bytes_view out) { packed.append(reinterpret_cast<const char*>(out.data()), out.size()); };
+        auto compressor = dowel::codec_context::compressor(codec, 1, keep);
+        double pack_ns = bench::measure(3, [&](std::int64_t n) {
+            for (std::int64_t i = 0; i < n; i++) {
+                packed.clear();
+                for (std::size_t at = 0; at < export_text.size(); at += 16384) compressor.feed(std::string_view(export_text).substr(at, 16384));
+                compressor.finish();
+            }
+        });
+        std::size_t unpacked = 0;
+        auto count = [&](dowel::bytes_view out) { unpacked += out.size(); };
+        auto decompressor = dowel::codec_context::decompressor(codec, count);
+        double unpack_ns = bench::measure(3, [&](std::int64_t n) {
+            for (std::int64_t i = 0; i < n; i++) {
+                for (std::size_t at = 0; at < packed.size(); at += 16384) decompressor.feed(std::string_view(packed).substr(at, 16384));
+                decompressor.finish();
+            }
+        });
+        std::string name = codec_name(codec);
+        bench::report(name + " compress stream", pack_ns);
+        std::cout << "     " << double(export_text.size()) / double(packed.size()) << "x, " << mb / pack_ns * 1e9 << " MB/s\n";
+        bench::report(name + " decompress stream", unpack_ns);
+        std::cout << "     " << mb / unpack_ns * 1e9 << " MB/s\n";
+        bench::do_not_optimize(unpacked);
+    }
+    return 0;
+}
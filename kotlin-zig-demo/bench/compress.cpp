@@ -0,0 +1,108 @@
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "bench_common.hpp"
+#include "dowel_steek_core.hpp"
+
+// Ratio and speed of each codec and level on the sample conversations and a
+// 6.7 MB export built from them, then 1000 small message records compressed
+// one by one, with and without a trained dictionary.
+
+static std::string read_sample(const std::string& name) {
+    std::string path = __FILE__;
+    path = path.substr(0, path.rfind('/')) + "/../../" + name;
+    std::ifstream in(path);
+    std::stringstream text;
+    text << in.rdbuf();
+    return text.str();
+}
+
+static const char* codec_name(dowel_codec_t codec) {
+    switch (codec) {
+        case DOWEL_CODEC_GZIP: return "gzip";
+        case DOWEL_CODEC_LZ4: return "lz4";
+        case DOWEL_CODEC_ZSTD: return "zstd";
+    }
+    return "?";
+}
+
+static void run_codecs(const std::string& title, const std::string& data) {
+    double mb = double(data.size()) / 1e6;
+    std::int64_t iterations = data.size() > 1000000 ? 1 : 50;
+    std::cout << "\n" << title << " (" << data.size() << " bytes)\n";
+    for (dowel_codec_t codec : {DOWEL_CODEC_LZ4, DOWEL_CODEC_GZIP, DOWEL_CODEC_ZSTD}) {
+        if (!dowel::codec_available(codec)) {
+            std::cout << "   • " << codec_name(codec) << ": not built in\n";
+            continue;
+        }
+        for (int level : {1, 3, 6, 9}) {
+            auto packed = dowel::compress(dowel::as_bytes(data), codec, level);
+            double pack_ns = bench::measure(iterations, [&](std::int64_t n) {
+                for (std::int64_t i = 0; i < n; i++) bench::do_not_optimize(dowel::compress(dowel::as_bytes(data), codec, level).size());
+            }, 3);
+            double unpack_ns = bench::measure(iterations, [&](std::int64_t n) {
+                for (std::int64_t i = 0; i < n; i++) bench::do_not_optimize(dowel::decompress(packed.bytes()).size());
+            }, 3);
+            std::cout << "   • " << std::left << std::setw(10) << (std::string(codec_name(codec)) + " " + std::to_string(level))
+                      << std::right << std::fixed << std::setprecision(2) << std::setw(7) << double(data.size()) / double(packed.size())
+                      << "x" << std::setprecision(0) << std::setw(9) << mb / pack_ns * 1e9 << " MB/s in"
+                      << std::setw(9) << mb / unpack_ns * 1e9 << " MB/s out\n";
+        }
+    }
+}
+
+int main() {
+    dowel::core_session session;
+
+    std::cout << "🗜️  Compression codecs\n";
+    std::cout << "=====================\n";
+    std::cout << "   ratio, compression and decompression speed\n";
+
+    std::string chat = read_sample("sample_conversation.json");
+    std::string rag = read_sample("sample_rag_tools_conversation.json");
+    std::string export_text = "{\"conversations\":{";
+    for (int i = 0; i < 300; i++) {
+        if (i > 0) export_text += ",";
+        export_text += "\"conv_" + std::to_string(i) + "\":" + rag;
+    }
+    export_text += "}}";
+    run_codecs("sample_conversation.json", chat);
+    run_codecs("sample_rag_tools_conversation.json", rag);
+    run_codecs("export of 300 conversations", export_text);
+
+    std::vector<std::string> records;
+    for (int i = 0; i < 2000; i++) {
+        records.push_back(R"({"type":"message","conversation_id":"conv_)" + std::to_string(i % 37) +
+            R"(","role":")" + (i % 2 ? "assistant" : "user") + R"(","model":"small-model-2024","created_at":"2024-01-)" +
+            std::to_string(10 + i % 20) + R"(T12:00:00Z","content":"Message )" + std::to_string(i) +
+            R"( about the sync schedule","metadata":{"tokens":)" + std::to_string(i * 13 % 900) + R"(,"cached":false}})");
+    }
+    std::vector<dowel::bytes_view> samples;
+    for (int i = 0; i < 1000; i++) samples.push_back(dowel::as_bytes(records[i]));
+    std::int64_t start = bench::now_ns();
+    auto dict = dowel::compress_dict::train(samples, 4096);
+    double train_ms = double(bench::now_ns() - start) / 1e6;
+
+    size_t raw = 0;
+    for (int i = 1000; i < 2000; i++) raw += records[i].size();
+    std::cout << "\n1000 small records (" << raw << " bytes), dictionary of " << dict.bytes().size()
+              << " bytes trained in " << std::setprecision(1) << train_ms << " ms\n";
+    for (dowel_codec_t codec : {DOWEL_CODEC_LZ4, DOWEL_CODEC_GZIP, DOWEL_CODEC_ZSTD}) {
+        if (!dowel::codec_available(codec)) continue;
+        for (const dowel::compress_dict* with : std::initializer_list<const dowel::compress_dict*>{nullptr, &dict}) {
+            size_t packed = 0;
+            for (int i = 1000; i < 2000; i++) packed += dowel::compress(dowel::as_bytes(records[i]), codec, 0, with).size();
+            double ns = bench::measure(3, [&](std::int64_t n) {
+                for (std::int64_t r = 0; r < n; r++) {
+                    for (int i = 1000; i < 2000; i++) bench::do_not_optimize(dowel::compress(dowel::as_bytes(records[i]), codec, 0, with).size());
+                }
+            }) / 1000.0;
+            std::cout << "   • " << std::left << std::setw(22) << (std::string(codec_name(codec)) + (with ? " + dictionary" : ""))
+                      << std::right << std::fixed << std::setprecision(2) << std::setw(7) << double(raw) / double(packed)
+                      << "x" << std::setprecision(0) << std::setw(9) << ns << " ns/record\n";
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,53 @@
+#include <string>
+
+#include "bench_common.hpp"
+#include "dowel_steek_core.hpp"
+
+// A 32 MB sync log compressed as one frame on one core and as a seekable
+// archive of 1 MB blocks across the task pool; then reading 4 KB from the
+// middle of the archive against inflating all of it.
+
+int main() {
+    dowel::core_session session;
+
+    std::string log;
+    for (int i = 0; log.size() < (32u << 20); i++) {
+        log += "2024-01-15T12:" + std::to_string(i / 60 % 60) + ":" + std::to_string(i % 60) + " INFO sync: pushed note " +
+            std::to_string(i * 2654435761u % 1000003) + " (" + std::to_string(i % 977) + " bytes) to device " +
+            std::to_string(i % 7) + "\n";
+    }
+    auto text = dowel::as_bytes(log);
+    double mb = double(log.size()) / 1e6;
+
+    std::cout << "🗄️  Block compression, 32 MB log, " << dowel_async_worker_count() << " pool worker(s)\n";
+    std::cout << "=================================================\n";
+    for (dowel_codec_t codec : {DOWEL_CODEC_LZ4, DOWEL_CODEC_GZIP, DOWEL_CODEC_ZSTD}) {
+        if (!dowel::codec_available(codec)) continue;
+        const char* name = codec == DOWEL_CODEC_LZ4 ? "lz4" : codec == DOWEL_CODEC_GZIP ? "gzip" : "zstd";
+
+        auto frame = dowel::compress(text, codec);
+        double single_ns = bench::measure(1, [&](std::int64_t n) {
+            for (std::int64_t i = 0; i < n; i++) bench::do_not_optimize(dowel::compress(text, codec).size());
+        }, 3);
+        auto archive = dowel::compress_blocks(text, codec);
+        double blocks_ns = bench::measure(1, [&](std::int64_t n) {
+            for (std::int64_t i = 0; i < n; i++) bench::do_not_optimize(dowel::compress_blocks(text, codec).size());
+        }, 3);
+        double inflate_ns = bench::measure(1, [&](std::int64_t n) {
+            for (std::int64_t i = 0; i < n; i++) bench::do_not_optimize(dowel::decompress_blocks(archive.bytes()).size());
+        }, 3);
+        auto reader = dowel::seekable_archive::open(archive.bytes());
+        double seek_ns = bench::measure(200, [&](std::int64_t n) {
+            for (std::int64_t i = 0; i < n; i++) bench::do_not_optimize(reader.read(log.size() / 2 + std::uint64_t(i) * 4096, 4096).size());
+        });
+
+        std::cout << "\n" << name << ": one frame " << frame.size() << " bytes, archive " << archive.size() << " bytes\n";
+        bench::report("compress, one frame", single_ns);
+        std::cout << "     " << mb / single_ns * 1e9 << " MB/s\n";
+        bench::report("compress, 1 MB blocks", blocks_ns);
+        std::cout << "     " << mb / blocks_ns * 1e9 << " MB/s\n";
+        bench::report("decompress whole archive", inflate_ns);
+        bench::report("read 4 KB from the middle", seek_ns);
+    }
+    return 0;
+}
@@ -0,0 +1,60 @@
+#include <string>
+#include <vector>
+
+#include "bench_common.hpp"
+#include "dowel_steek_core.hpp"
+
+// Per-read cost of path lookups against pre-resolved key handles. The
+// "build path" case mirrors final_demo.cpp, which concatenates
+// "service." + name on every call. Target: well over 1M reads/s per thread.
+
+int main() {
+    std::cout << "⚡ Config path lookup vs key handles\n";
+    std::cout << "====================================\n";
+
+    dowel::core_session session;
+    const std::int64_t n = 1000000;
+
+    std::vector<std::string> names = {"Display Manager", "Audio System", "Network Stack", "Power Management"};
+    std::vector<std::string> paths;
+    std::vector<dowel::config_key> keys;
+    for (const auto& name : names) {
+        paths.push_back("service." + name);
+        dowel_config_set_string(paths.back().c_str(), "active");
+        keys.push_back(dowel::config_key::resolve(paths.back()));
+    }
+
+    auto report = [](const std::string& name, double ns) {
+        bench::report(name, ns);
+        bench::report_throughput(name, 1e9 / ns);
+    };
+
+    std::cout << "\n🔎 String value read\n";
+    report("build path + lookup", bench::measure(n, [&](std::int64_t iters) {
+        for (std::int64_t i = 0; i < iters; i++) {
+            std::string path = "service." + names[i & 3];
+            bench::do_not_optimize(dowel_config_get_string(path.c_str(), "inactive"));
+        }
+    }));
+    report("path lookup", bench::measure(n, [&](std::int64_t iters) {
+        for (std::int64_t i = 0; i < iters; i++) {
+            bench::do_not_optimize(dowel_config_get_string(paths[i & 3].c_str(), "inactive"));
+        }
+    }));
+    report("key handle", bench::measure(n, [&](std::int64_t iters) {
+        for (std::int64_t i = 0; i < iters; i++) {
+            bench::do_not_optimize(dowel_config_key_get_string(keys[i & 3].get(), "inactive"));
+        }
+    }));
+
+    std::cout << "\n🔁 Change detection\n";
+    std::vector<std::uint32_t> seen;
+    for (const auto& key : keys) seen.push_back(key.generation());
+    report("generation check", bench::measure(n, [&](std::int64_t iters) {
+        for (std::int64_t i = 0; i < iters; i++) {
+            bench::do_not_optimize(keys[i & 3].changed_since(seen[i & 3]));
+        }
+    }));
+
+    return 0;
+}
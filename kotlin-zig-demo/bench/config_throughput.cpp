@@ -0,0 +1,104 @@
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "bench_common.hpp"
+#include "dowel_steek_core.h"
+
+// Multi-threaded read/write throughput of the config store, against a
+// shared_mutex + unordered_map baseline with the same key set. Readers hit
+// random keys while one writer keeps updating them.
+
+static const int key_count = 1024;
+static const auto run_time = std::chrono::milliseconds(500);
+
+struct locked_map {
+    std::shared_mutex mutex;
+    std::unordered_map<std::string, int64_t> values;
+
+    int64_t get(const char* key, int64_t fallback) {
+        std::shared_lock lock(mutex);
+        auto it = values.find(key);
+        return it == values.end() ? fallback : it->second;
+    }
+
+    void set(const char* key, int64_t value) {
+        std::unique_lock lock(mutex);
+        values[key] = value;
+    }
+};
+
+template <typename Get, typename Set>
+static void run(const std::string& name, const std::vector<std::string>& keys, int readers, Get get, Set set) {
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> reads{0};
+    std::atomic<uint64_t> writes{0};
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < readers; t++) {
+        threads.emplace_back([&, t] {
+            uint64_t local = 0;
+            uint32_t rng = 0x9e3779b9u * (t + 1);
+            while (!stop.load(std::memory_order_relaxed)) {
+                for (int i = 0; i < 256; i++) {
+                    rng = rng * 1664525u + 1013904223u;
+                    bench::do_not_optimize(get(keys[rng % key_count].c_str(), 0));
+                }
+                local += 256;
+            }
+            reads.fetch_add(local);
+        });
+    }
+    threads.emplace_back([&] {
+        uint64_t local = 0;
+        while (!stop.load(std::memory_order_relaxed)) {
+            set(keys[local % key_count].c_str(), (int64_t)local);
+            local++;
+        }
+        writes.fetch_add(local);
+    });
+
+    std::this_thread::sleep_for(run_time);
+    stop.store(true);
+    for (auto& thread : threads) thread.join();
+
+    double seconds = std::chrono::duration<double>(run_time).count();
+    bench::report_throughput(name + " reads (" + std::to_string(readers) + " threads)", reads.load() / seconds);
+    bench::report_throughput(name + " writes (1 thread)", writes.load() / seconds);
+}
+
+int main() {
+    std::cout << "⚡ Config store throughput\n";
+    std::cout << "==========================\n";
+
+    dowel_core_init();
+
+    std::vector<std::string> keys;
+    locked_map baseline;
+    for (int i = 0; i < key_count; i++) {
+        keys.push_back("service.component_" + std::to_string(i) + ".timeout_ms");
+        dowel_config_set_int(keys.back().c_str(), i);
+        baseline.set(keys.back().c_str(), i);
+    }
+
+    int hw = (int)std::thread::hardware_concurrency();
+    std::vector<int> reader_counts = {1, 2, 4};
+    if (hw > 4) reader_counts.push_back(hw);
+
+    for (int readers : reader_counts) {
+        std::cout << "\n🧵 " << readers << " reader(s) + 1 writer\n";
+        run("dowel_config", keys, readers,
+            [](const char* key, int64_t fallback) { return dowel_config_get_int(key, fallback); },
+            [](const char* key, int64_t value) { dowel_config_set_int(key, value); });
+        run("shared_mutex map", keys, readers,
+            [&](const char* key, int64_t fallback) { return baseline.get(key, fallback); },
+            [&](const char* key, int64_t value) { baseline.set(key, value); });
+    }
+
+    dowel_core_shutdown();
+    return 0;
+}
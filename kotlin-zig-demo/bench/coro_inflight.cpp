@@ -0,0 +1,91 @@
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+#include "bench_common.hpp"
+#include "dowel_steek_coro.hpp"
+
+// Read + gzip of many small files issued from one thread:
+//  - blocking: each step is a pool task the caller waits on before the next,
+//    the dowel_async_spawn/dowel_async_wait pattern
+//  - coroutines: every file is a dowel::async::task started up front; the
+//    caller blocks once per result at the end while the rest stay in flight
+// plus the cost of one suspend/resume hop through the pool.
+
+static const int file_count = 256;
+
+struct job {
+    std::string path;
+    dowel::buffer data;
+    dowel::buffer packed;
+};
+
+static void read_step(void* data) {
+    auto* j = static_cast<job*>(data);
+    j->data = dowel::storage::read_file(j->path);
+}
+
+static void pack_step(void* data) {
+    auto* j = static_cast<job*>(data);
+    j->packed = dowel::compress_gzip(j->data.bytes());
+}
+
+static dowel::async::task<std::size_t> pack_file(const std::string& path) {
+    dowel::buffer data = co_await dowel::async::read_file(path);
+    dowel::buffer packed = co_await dowel::async::compress_gzip(data.bytes());
+    co_return packed.size();
+}
+
+static dowel::async::task<int> hop() {
+    co_await dowel::async::schedule();
+    co_return 1;
+}
+
+int main() {
+    dowel::core_session session;
+
+    char dir_template[] = "/tmp/dowel_coro_XXXXXX";
+    std::string dir = mkdtemp(dir_template);
+    std::string text;
+    for (int i = 0; i < 4096; i++) text += char('a' + (i * 7) % 26);
+    std::vector<std::string> paths;
+    for (int i = 0; i < file_count; i++) {
+        paths.push_back(dir + "/f" + std::to_string(i));
+        dowel::storage::write_file(paths.back(), dowel::as_bytes(text));
+    }
+
+    double blocking_ns = bench::measure(file_count, [&](std::int64_t n) {
+        for (std::int64_t i = 0; i < n; i++) {
+            job j{ paths[size_t(i)], {}, {} };
+            dowel_async_free_task(dowel_async_spawn(read_step, &j));
+            dowel_async_free_task(dowel_async_spawn(pack_step, &j));
+            bench::do_not_optimize(j.packed.size());
+        }
+    }, 5);
+
+    double coro_ns = bench::measure(file_count, [&](std::int64_t n) {
+        std::vector<dowel::async::task<std::size_t>> tasks;
+        tasks.reserve(size_t(n));
+        for (std::int64_t i = 0; i < n; i++) {
+            tasks.push_back(pack_file(paths[size_t(i)]));
+            tasks.back().start();
+        }
+        for (auto& task : tasks) bench::do_not_optimize(task.get());
+    }, 5);
+
+    double hop_ns = bench::measure(20000, [&](std::int64_t n) {
+        for (std::int64_t i = 0; i < n; i++) bench::do_not_optimize(hop().get());
+    }, 3);
+
+    std::cout << "⚡ Read + gzip of " << file_count << " x 4 KB files, " << dowel::async::worker_count()
+              << " workers (ns per file)\n";
+    std::cout << "=================================================================\n";
+    bench::report("spawn + wait per step", blocking_ns);
+    bench::report("coroutines, all in flight", coro_ns);
+    bench::report("task<int> schedule() round trip", hop_ns);
+
+    for (auto& path : paths) dowel::storage::delete_file(path);
+    rmdir(dir.c_str());
+    return 0;
+}
@@ -0,0 +1,96 @@
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__)
+#include <x86intrin.h>
+#endif
+
+#include "bench_common.hpp"
+#include "dowel_steek_core.hpp"
+#include "../core/core_internal.h"
+
+// SHA-256 and AES-256-GCM seal/open at a few message sizes, once with every
+// kernel the CPU offers and again with each hardware path switched off, so
+// the dispatch gain shows per primitive. Cycles per byte come from the TSC
+// on x86 and are left out elsewhere.
+
+struct kernel_set {
+    const char* name;
+    std::uint32_t features;
+};
+
+static double cycles_per_ns() {
+#if defined(__x86_64__)
+    std::int64_t start_ns = bench::now_ns();
+    std::uint64_t start = __rdtsc();
+    while (bench::now_ns() - start_ns < 50000000) {
+    }
+    return double(__rdtsc() - start) / double(bench::now_ns() - start_ns);
+#else
+    return 0;
+#endif
+}
+
+static void report_bytes(const std::string& name, double ns, std::size_t size, double ghz) {
+    bench::report(name, ns);
+    std::cout << "     " << double(size) / ns * 1e3 << " MB/s";
+    if (ghz > 0) std::cout << ", " << std::setprecision(2) << ns * ghz / double(size) << " cycles/byte";
+    std::cout << "\n";
+}
+
+int main() {
+    dowel::core_session session;
+
+    std::cout << "🔐 Crypto kernels\n";
+    std::cout << "=================\n";
+
+    double ghz = cycles_per_ns();
+    if (ghz > 0) std::cout << "\nTSC at " << std::fixed << std::setprecision(2) << ghz << " GHz\n";
+
+    const kernel_set sets[] = {
+        {"best", UINT32_MAX},
+        {"no VAES", ~std::uint32_t(DCORE_CPU_VAES)},
+        {"no AES/CLMUL", ~std::uint32_t(DCORE_CPU_VAES | DCORE_CPU_AES | DCORE_CPU_CLMUL)},
+        {"portable", 0},
+    };
+    std::vector<std::uint8_t> data(1 << 20);
+    for (std::size_t i = 0; i < data.size(); i++) data[i] = std::uint8_t((i * 2654435761u) >> 13);
+    std::vector<std::uint8_t> key_bytes(32, 0x5c), nonce(DCORE_GCM_NONCE_SIZE, 0x11);
+    dowel_crypto_key_t key{key_bytes.data(), key_bytes.size()};
+    std::vector<std::uint8_t> sealed(data.size() + DCORE_GCM_TAG_SIZE), opened(data.size());
+
+    for (std::size_t size : {std::size_t(64), std::size_t(1024), std::size_t(16384), std::size_t(1 << 20)}) {
+        std::int64_t iterations = std::int64_t((8u << 20) / (size + 256)) + 1;
+        dowel::bytes_view input(data.data(), size);
+        std::cout << "\n" << size << " byte messages\n";
+
+        for (const kernel_set& set : {sets[0], sets[3]}) {
+            dcore_cpu_restrict(set.features);
+            double ns = bench::measure(iterations, [&](std::int64_t n) {
+                for (std::int64_t i = 0; i < n; i++) bench::do_not_optimize(dowel::sha256(input).size());
+            }, 3);
+            report_bytes(std::string("sha256 ") + set.name, ns, size, ghz);
+        }
+        for (const kernel_set& set : sets) {
+            dcore_cpu_restrict(set.features);
+            dcore_gcm_t* gcm = dcore_gcm_new(&key);
+            double seal_ns = bench::measure(iterations, [&](std::int64_t n) {
+                for (std::int64_t i = 0; i < n; i++) {
+                    dcore_gcm_seal(gcm, nonce.data(), data.data(), size, sealed.data());
+                    bench::do_not_optimize(sealed[0]);
+                }
+            }, 3);
+            double open_ns = bench::measure(iterations, [&](std::int64_t n) {
+                for (std::int64_t i = 0; i < n; i++) {
+                    bench::do_not_optimize(dcore_gcm_open(gcm, nonce.data(), sealed.data(), size + DCORE_GCM_TAG_SIZE, opened.data()));
+                }
+            }, 3);
+            dcore_gcm_free(gcm);
+            report_bytes(std::string("gcm seal ") + set.name, seal_ns, size, ghz);
+            report_bytes(std::string("gcm open ") + set.name, open_ns, size, ghz);
+        }
+    }
+    dcore_cpu_restrict(UINT32_MAX);
+    return 0;
+}
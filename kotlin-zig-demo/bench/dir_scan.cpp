@@ -0,0 +1,81 @@
+#include <filesystem>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+#include "bench_common.hpp"
+#include "dowel_steek_core.hpp"
+
+// Listing a photo library of 64 folders x 16 subfolders x 20 files (20480
+// files) with sizes and modtimes. The baseline walks it the way callers do
+// today: list_directory per folder, then a stat per name.
+// A second pair keeps only the .jpg files, a quarter of the library.
+
+static void walk(const std::string& dir, std::string_view extension, std::size_t& files, std::int64_t& bytes) {
+    auto names = dowel::storage::list_directory(dir);
+    for (std::size_t i = 0; i < names.size(); i++) {
+        std::string path = dir + "/" + std::string(names[i]);
+        struct stat st;
+        if (stat(path.c_str(), &st) != 0) continue;
+        if (S_ISDIR(st.st_mode)) {
+            walk(path, extension, files, bytes);
+            continue;
+        }
+        if (!names[i].ends_with(extension)) continue;
+        bytes += st.st_size;
+        bench::do_not_optimize(st.st_mtime);
+        files++;
+    }
+}
+
+int main() {
+    dowel::core_session session;
+
+    char dir_template[] = "/tmp/dowel_scan_XXXXXX";
+    std::string root = mkdtemp(dir_template);
+    const char* kinds[] = {".jpg", ".heic", ".png", ".txt"};
+    for (int a = 0; a < 64; a++) {
+        std::string album = root + "/album" + std::to_string(a);
+        dowel::storage::create_directory(album);
+        for (int d = 0; d < 16; d++) {
+            std::string day = album + "/day" + std::to_string(d);
+            dowel::storage::create_directory(day);
+            for (int f = 0; f < 20; f++) {
+                dowel::storage::write_file(day + "/img" + std::to_string(f) + kinds[f % 4],
+                                           dowel::as_bytes(std::string_view("x")));
+            }
+        }
+    }
+
+    std::cout << "⚡ Recursive scan, 20480 files in 1088 folders\n";
+    std::cout << "==============================================\n";
+    std::size_t files = 0;
+    std::int64_t bytes = 0;
+    bench::report("list_directory + stat", bench::measure(1, [&](std::int64_t) {
+        files = 0;
+        walk(root, "", files, bytes);
+    }, 3));
+    std::cout << "     (" << files << " files)\n";
+    bench::report("dowel_storage_scan", bench::measure(1, [&](std::int64_t) {
+        auto result = dowel::storage::scan(root);
+        files = result.size();
+    }, 3));
+    std::cout << "     (" << files << " files)\n";
+
+    bench::report("list_directory + stat, .jpg only", bench::measure(1, [&](std::int64_t) {
+        files = 0;
+        walk(root, ".jpg", files, bytes);
+    }, 3));
+    const char* jpg[] = {"jpg"};
+    dowel_scan_options_t options = {};
+    options.extensions = jpg;
+    options.extension_count = 1;
+    bench::report("dowel_storage_scan, .jpg filter", bench::measure(1, [&](std::int64_t) {
+        files = dowel::storage::scan(root, &options).size();
+    }, 3));
+    std::cout << "     (" << files << " files)\n";
+
+    std::filesystem::remove_all(root);
+    return 0;
+}
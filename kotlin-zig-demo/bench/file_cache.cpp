@@ -0,0 +1,98 @@
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+#include "bench_common.hpp"
+#include "dowel_steek_core.hpp"
+
+// Concurrent cached reads of 256 files of 4 KB that all fit in the cache.
+// The baseline is the StorageManager design: one mutex around one map, with
+// the contents copied out on every hit. Uncached read_file is shown for
+// scale.
+
+static const int file_count = 256;
+static const auto run_time = std::chrono::milliseconds(500);
+
+struct single_lock_cache {
+    std::mutex mutex;
+    std::unordered_map<std::string, std::string> files;
+
+    std::string get(const std::string& path) {
+        {
+            std::lock_guard lock(mutex);
+            auto it = files.find(path);
+            if (it != files.end()) return it->second;
+        }
+        auto data = dowel::storage::read_file(path);
+        std::lock_guard lock(mutex);
+        return files.emplace(path, std::string(data.str())).first->second;
+    }
+};
+
+template <typename Read>
+static void run(const std::string& name, const std::vector<std::string>& paths, int readers, Read read) {
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> reads{0};
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < readers; t++) {
+        threads.emplace_back([&, t] {
+            uint64_t local = 0;
+            uint32_t rng = 0x9e3779b9u * (t + 1);
+            while (!stop.load(std::memory_order_relaxed)) {
+                for (int i = 0; i < 64; i++) {
+                    rng = rng * 1664525u + 1013904223u;
+                    read(paths[rng % file_count]);
+                }
+                local += 64;
+            }
+            reads.fetch_add(local);
+        });
+    }
+    std::this_thread::sleep_for(run_time);
+    stop.store(true);
+    for (auto& thread : threads) thread.join();
+
+    double seconds = std::chrono::duration<double>(run_time).count();
+    bench::report_throughput(name + " (" + std::to_string(readers) + " threads)", reads.load() / seconds);
+}
+
+int main() {
+    dowel::core_session session;
+
+    char dir_template[] = "/tmp/dowel_cache_XXXXXX";
+    std::string dir = mkdtemp(dir_template);
+    std::vector<std::string> paths;
+    std::string body(4096, 'c');
+    for (int i = 0; i < file_count; i++) {
+        paths.push_back(dir + "/file" + std::to_string(i));
+        dowel::storage::write_file(paths.back(), dowel::as_bytes(body));
+    }
+
+    std::cout << "⚡ File cache read throughput\n";
+    std::cout << "=============================\n";
+    for (int readers : {1, 4}) {
+        single_lock_cache baseline;
+        run("single mutex, copy out", paths, readers, [&](const std::string& path) {
+            bench::do_not_optimize(baseline.get(path).size());
+        });
+        run("read_cached", paths, readers, [](const std::string& path) {
+            bench::do_not_optimize(dowel::storage::read_cached(path).size());
+        });
+        run("read_file (uncached)", paths, readers, [](const std::string& path) {
+            bench::do_not_optimize(dowel::storage::read_file(path).size());
+        });
+    }
+
+    auto metrics = dowel::storage::metrics();
+    std::cout << "   hits " << metrics.cache_hits << ", misses " << metrics.cache_misses << ", cached "
+              << metrics.cached_bytes / 1024 << " KB\n";
+
+    for (const auto& path : paths) dowel::storage::delete_file(path);
+    rmdir(dir.c_str());
+    return 0;
+}
@@ -0,0 +1,126 @@
+#include <atomic>
+#include <fcntl.h>
+#include <filesystem>
+#include <string>
+#include <sys/resource.h>
+#include <unistd.h>
+#include <vector>
+
+#include "bench_common.hpp"
+#include "dowel_steek_core.hpp"
+
+// Writes to 100k files in 100 folders under a recursive watcher: wall time
+// until the last event arrives, events delivered, and process CPU compared
+// with the same writes unwatched. Then single-event latency, immediate and
+// with a 20 ms coalescing window.
+
+static const int folder_count = 100;
+static const int files_per_folder = 1000;
+static const int all_events =
+    DOWEL_FILE_EVENT_CREATED | DOWEL_FILE_EVENT_MODIFIED | DOWEL_FILE_EVENT_DELETED | DOWEL_FILE_EVENT_MOVED;
+
+static std::int64_t cpu_ns() {
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return (std::int64_t(usage.ru_utime.tv_sec) + usage.ru_stime.tv_sec) * 1000000000LL +
+        (std::int64_t(usage.ru_utime.tv_usec) + usage.ru_stime.tv_usec) * 1000LL;
+}
+
+static void touch(const std::string& path) {
+    int fd = open(path.c_str(), O_WRONLY | O_TRUNC);
+    bench::do_not_optimize(write(fd, "y", 1));
+    close(fd);
+}
+
+struct counter {
+    std::atomic<std::uint64_t> records{0};
+    std::atomic<std::uint64_t> batches{0};
+    std::atomic<std::int64_t> last_ns{0};
+    void operator()(std::span<const dowel_file_event_record_t> batch) {
+        records.fetch_add(batch.size());
+        batches.fetch_add(1);
+        last_ns.store(bench::now_ns());
+    }
+};
+
+static void storm(const std::string& root, const std::vector<std::string>& paths, std::uint32_t coalesce_ms,
+                  std::int64_t baseline_cpu_ns) {
+    counter count;
+    dowel_file_watcher_options_t options{};
+    options.recursive = true;
+    options.coalesce_ms = coalesce_ms;
+    auto watcher = dowel::file_watcher::create_batched(root, all_events, options, count);
+    watcher.start();
+
+    std::int64_t cpu = cpu_ns();
+    std::int64_t start = bench::now_ns();
+    for (const auto& path : paths) touch(path);
+    std::int64_t written = bench::now_ns();
+    // Settled once nothing has arrived for 200 ms past the window
+    while (bench::now_ns() - std::max(count.last_ns.load(), written) < (200 + std::int64_t(coalesce_ms)) * 1000000LL) {
+        usleep(10000);
+    }
+    cpu = cpu_ns() - cpu;
+    watcher = dowel::file_watcher();
+
+    std::cout << "   • " << (coalesce_ms ? "coalescing " + std::to_string(coalesce_ms) + " ms" : std::string("immediate"))
+              << ": " << count.records.load() << " events in " << count.batches.load() << " batches, last after "
+              << double(count.last_ns.load() - start) / 1e6 << " ms, CPU " << double(cpu) / 1e6 << " ms ("
+              << double(cpu - baseline_cpu_ns) / 1e6 << " ms over unwatched)\n";
+}
+
+static void latency(const std::string& file, std::uint32_t coalesce_ms) {
+    std::atomic<std::int64_t> seen_ns{0};
+    auto on_event = [&](std::span<const dowel_file_event_record_t>) { seen_ns.store(bench::now_ns()); };
+    dowel_file_watcher_options_t options{};
+    options.coalesce_ms = coalesce_ms;
+    auto watcher = dowel::file_watcher::create_batched(file, DOWEL_FILE_EVENT_MODIFIED, options, on_event);
+    watcher.start();
+
+    const int rounds = 200;
+    std::int64_t total = 0;
+    for (int i = 0; i < rounds; i++) {
+        seen_ns.store(0);
+        std::int64_t start = bench::now_ns();
+        touch(file);
+        while (seen_ns.load() == 0) usleep(50);
+        total += seen_ns.load() - start;
+        usleep(coalesce_ms * 1000 + 1000);
+    }
+    std::cout << "   • latency, " << (coalesce_ms ? std::to_string(coalesce_ms) + " ms window" : std::string("immediate"))
+              << ": " << double(total) / rounds / 1000 << " µs\n";
+}
+
+int main() {
+    dowel::core_session session;
+
+    char dir_template[] = "/tmp/dowel_watch_XXXXXX";
+    std::string root = mkdtemp(dir_template);
+    std::vector<std::string> paths;
+    for (int d = 0; d < folder_count; d++) {
+        std::string folder = root + "/f" + std::to_string(d);
+        dowel::storage::create_directory(folder);
+        for (int f = 0; f < files_per_folder; f++) {
+            paths.push_back(folder + "/asset" + std::to_string(f) + ".bin");
+            dowel::storage::write_file(paths.back(), dowel::as_bytes(std::string_view("x")));
+        }
+    }
+
+    std::cout << "⚡ File watcher, 100k writes in 100 folders\n";
+    std::cout << "===========================================\n";
+    std::int64_t cpu = cpu_ns();
+    std::int64_t start = bench::now_ns();
+    for (const auto& path : paths) touch(path);
+    std::int64_t baseline_cpu = cpu_ns() - cpu;
+    std::cout << "   • unwatched: " << double(bench::now_ns() - start) / 1e6 << " ms, CPU " << double(baseline_cpu) / 1e6
+              << " ms\n";
+
+    storm(root, paths, 0, baseline_cpu);
+    storm(root, paths, 50, baseline_cpu);
+
+    latency(paths.front(), 0);
+    latency(paths.front(), 20);
+
+    std::filesystem::remove_all(root);
+    return 0;
+}
@@ -0,0 +1,77 @@
+#include <malloc.h>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "bench_common.hpp"
+#include "dowel_steek_core.hpp"
+
+// Reading three fields out of a 6.7 MB export: the tape parser builds the
+// whole document first, on-demand mode indexes it and reads only the fields.
+// Memory is what each holds once the fields have been read.
+
+static std::string read_sample(const std::string& name) {
+    std::string path = __FILE__;
+    path = path.substr(0, path.rfind('/')) + "/../../" + name;
+    std::ifstream in(path);
+    std::stringstream text;
+    text << in.rdbuf();
+    return text.str();
+}
+
+static size_t heap_in_use() {
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+}
+
+int main() {
+    dowel::core_session session;
+
+    std::string rag = read_sample("sample_rag_tools_conversation.json");
+    std::string export_text = "{\"conversations\":{";
+    for (int i = 0; i < 300; i++) {
+        if (i > 0) export_text += ",";
+        export_text += "\"conv_" + std::to_string(i) + "\":" + rag;
+    }
+    export_text += "}}";
+
+    std::cout << "🔎 Three fields from a 6.7 MB export\n";
+    std::cout << "=====================================\n";
+
+    size_t tree_bytes = 0;
+    double tree = bench::measure(3, [&](std::int64_t n) {
+        for (std::int64_t i = 0; i < n; i++) {
+            size_t before = heap_in_use();
+            auto doc = dowel::json_document::parse(export_text);
+            auto conversation = doc["conversations"]["conv_250"];
+            bench::do_not_optimize(conversation["title"].as_string().size());
+            bench::do_not_optimize(conversation["mapping"]["msg_2"]["message"]["author"]["role"].as_string().size());
+            bench::do_not_optimize(conversation["mapping"]["msg_2"]["message"]["create_time"].as_float());
+            tree_bytes = heap_in_use() - before;
+        }
+    });
+    bench::report("tape parse + 3 lookups", tree);
+
+    size_t lazy_bytes = 0;
+    double lazy = bench::measure(3, [&](std::int64_t n) {
+        for (std::int64_t i = 0; i < n; i++) {
+            size_t before = heap_in_use();
+            auto doc = dowel::json_lazy::open(export_text);
+            bench::do_not_optimize(doc.find("/conversations/conv_250/title").as_string().size());
+            bench::do_not_optimize(doc.find("/conversations/conv_250/mapping/msg_2/message/author/role").as_string().size());
+            bench::do_not_optimize(doc.find("/conversations/conv_250/mapping/msg_2/message/create_time").as_float());
+            lazy_bytes = heap_in_use() - before;
+        }
+    });
+    bench::report("on-demand open + 3 finds", lazy);
+    std::cout << "     tape " << tree_bytes / 1024 << " KB, on-demand " << lazy_bytes / 1024 << " KB held\n";
+
+    auto doc = dowel::json_lazy::open(export_text);
+    bench::report("find /conversations/conv_250/title", bench::measure(100000, [&](std::int64_t n) {
+        for (std::int64_t i = 0; i < n; i++) {
+            bench::do_not_optimize(doc.find("/conversations/conv_250/title").as_string().size());
+        }
+    }));
+    return 0;
+}
@@ -0,0 +1,58 @@
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "bench_common.hpp"
+#include "dowel_steek_core.hpp"
+
+// dowel_json_parse + dowel_json_free over the repo's sample conversations
+// and a 6 MB export built from 300 copies of the larger one, then reading
+// one message field out of the parsed export.
+
+static std::string read_sample(const std::string& name) {
+    std::string path = __FILE__;
+    path = path.substr(0, path.rfind('/')) + "/../../" + name;
+    std::ifstream in(path);
+    std::stringstream text;
+    text << in.rdbuf();
+    return text.str();
+}
+
+static void parse(const std::string& name, const std::string& text, std::int64_t iterations) {
+    double ns = bench::measure(iterations, [&](std::int64_t n) {
+        for (std::int64_t i = 0; i < n; i++) {
+            dowel_json_value_t* doc = dowel_json_parse(text.c_str());
+            bench::do_not_optimize(doc);
+            dowel_json_free(doc);
+        }
+    });
+    bench::report(name, ns);
+    std::cout << "     " << double(text.size()) / ns * 1e3 << " MB/s\n";
+}
+
+int main() {
+    dowel::core_session session;
+
+    std::string small = read_sample("sample_conversation.json");
+    std::string rag = read_sample("sample_rag_tools_conversation.json");
+    std::string export_text = "{\"conversations\":{";
+    for (int i = 0; i < 300; i++) {
+        if (i > 0) export_text += ",";
+        export_text += "\"conv_" + std::to_string(i) + "\":" + rag;
+    }
+    export_text += "}}";
+
+    std::cout << "⚡ JSON parse + free\n";
+    std::cout << "====================\n";
+    parse("sample_conversation.json (5.5 KB)", small, 2000);
+    parse("sample_rag_tools_conversation.json (22 KB)", rag, 500);
+    parse("export, 300 conversations (6.7 MB)", export_text, 3);
+
+    auto doc = dowel::json_document::parse(export_text);
+    bench::report("lookup conversations/conv_250/title", bench::measure(100000, [&](std::int64_t n) {
+        for (std::int64_t i = 0; i < n; i++) {
+            bench::do_not_optimize(doc["conversations"]["conv_250"]["title"].as_string().size());
+        }
+    }));
+    return 0;
+}
@@ -0,0 +1,137 @@
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "bench_common.hpp"
+#include "dowel_steek_core.hpp"
+
+// Exporting notes with the streaming writer, into its buffer and through a
+// file stream, next to a plain memcpy of the same bytes; then double
+// formatting against printf and stringify of the 6.7 MB conversation export.
+
+struct note {
+    std::int64_t id;
+    double modified;
+    std::string title;
+    std::string body;
+};
+
+static std::string read_sample(const std::string& name) {
+    std::string path = __FILE__;
+    path = path.substr(0, path.rfind('/')) + "/../../" + name;
+    std::ifstream in(path);
+    std::stringstream text;
+    text << in.rdbuf();
+    return text.str();
+}
+
+static void write_notes(dowel::json_writer& writer, const std::vector<note>& notes) {
+    writer.begin_array();
+    for (const note& n : notes) {
+        writer.begin_object()
+            .key("id").value(n.id)
+            .key("modified").value(n.modified)
+            .key("title").value(n.title)
+            .key("body").value(n.body)
+            .key("tags").begin_array().value("inbox").value("synced").end_array()
+            .end_object();
+    }
+    writer.end_array();
+}
+
+int main() {
+    dowel::core_session session;
+
+    std::vector<note> notes;
+    for (int i = 0; i < 50000; i++) {
+        std::string body;
+        for (int line = 0; line < 4; line++) body += "Line " + std::to_string(line) + " of note " + std::to_string(i) + ", with \"quotes\" and a tab\t.\n";
+        notes.push_back({i, 1703001720.25 + i * 0.001, "Note " + std::to_string(i), body});
+    }
+
+    auto writer = dowel::json_writer::create();
+    write_notes(writer, notes);
+    writer.finish();
+    std::string reference(writer.text());
+    double mb = double(reference.size()) / 1e6;
+
+    std::cout << "✏️  JSON writer, 50k notes (" << int(mb) << " MB)\n";
+    std::cout << "==================================\n";
+    std::vector<char> copy(reference.size());
+    double copy_ns = bench::measure(5, [&](std::int64_t n) {
+        for (std::int64_t i = 0; i < n; i++) {
+            std::memcpy(copy.data(), reference.data(), reference.size());
+            bench::do_not_optimize(copy.data());
+        }
+    });
+    bench::report("memcpy of the output", copy_ns);
+    std::cout << "     " << mb / copy_ns * 1e9 << " MB/s\n";
+
+    double buffer_ns = bench::measure(5, [&](std::int64_t n) {
+        for (std::int64_t i = 0; i < n; i++) {
+            writer.reset();
+            write_notes(writer, notes);
+            bench::do_not_optimize(writer.finish());
+        }
+    });
+    bench::report("writer into its buffer", buffer_ns);
+    std::cout << "     " << mb / buffer_ns * 1e9 << " MB/s\n";
+
+    char dir[] = "/tmp/dowel_bench_XXXXXX";
+    if (!mkdtemp(dir)) return 1;
+    std::string path = std::string(dir) + "/notes.json";
+    double stream_ns = bench::measure(3, [&](std::int64_t n) {
+        for (std::int64_t i = 0; i < n; i++) {
+            auto file = dowel::storage::open_stream(path, DOWEL_STREAM_WRITE);
+            auto streamed = dowel::json_writer::create(file);
+            write_notes(streamed, notes);
+            bench::do_not_optimize(streamed.finish());
+            file.close();
+        }
+    });
+    bench::report("writer into a file stream", stream_ns);
+    std::cout << "     " << mb / stream_ns * 1e9 << " MB/s\n";
+    std::remove(path.c_str());
+    rmdir(dir);
+
+    std::vector<double> doubles;
+    for (int i = 0; i < 4096; i++) doubles.push_back(double(i * 2654435761u % 1000003) / 997.0);
+    double printf_ns = bench::measure(50, [&](std::int64_t n) {
+        char text[32];
+        for (std::int64_t i = 0; i < n; i++) {
+            for (double d : doubles) bench::do_not_optimize(std::snprintf(text, sizeof(text), "%.17g", d));
+        }
+    }) / double(doubles.size());
+    bench::report("double via snprintf %.17g", printf_ns);
+    double shortest_ns = bench::measure(50, [&](std::int64_t n) {
+        for (std::int64_t i = 0; i < n; i++) {
+            writer.reset();
+            writer.begin_array();
+            for (double d : doubles) writer.value(d);
+            writer.end_array();
+            bench::do_not_optimize(writer.finish());
+        }
+    }) / double(doubles.size());
+    bench::report("double via writer (shortest)", shortest_ns);
+
+    std::string rag = read_sample("sample_rag_tools_conversation.json");
+    std::string export_text = "{\"conversations\":{";
+    for (int i = 0; i < 300; i++) {
+        if (i > 0) export_text += ",";
+        export_text += "\"conv_" + std::to_string(i) + "\":" + rag;
+    }
+    export_text += "}}";
+    double stringify_ns = bench::measure(3, [&](std::int64_t n) {
+        for (std::int64_t i = 0; i < n; i++) {
+            auto doc = dowel::json_document::parse(export_text);
+            bench::do_not_optimize(doc.stringify().size());
+        }
+    });
+    bench::report("parse + stringify export (6.7 MB)", stringify_ns);
+    return 0;
+}
@@ -0,0 +1,75 @@
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "bench_common.hpp"
+#include "dowel_steek_core.hpp"
+
+// Caller-side cost of a log line: final_demo.cpp's string concatenation +
+// dowel_log_info against DOWEL_LOG_STRUCTURED into a binary log. Entries are
+// timed in batches that stay under the ring's wake threshold, with a flush
+// between batches outside the timed region, so the writer never runs inside a
+// sample and nothing is dropped. Output goes to /dev/null.
+
+static const int batch = 200;
+static const int batches = 1000;
+
+// Median batch time per entry
+template <typename F>
+static double time_batches(F log) {
+    std::vector<std::int64_t> samples;
+    std::uint64_t dropped = dowel_log_get_metrics().dropped_entries;
+    for (int b = 0; b < batches; b++) {
+        std::int64_t start = bench::now_ns();
+        for (int i = 0; i < batch; i++) log(i);
+        samples.push_back(bench::now_ns() - start);
+        dowel_log_flush();
+    }
+    if (dowel_log_get_metrics().dropped_entries != dropped) std::cerr << "warning: entries were dropped\n";
+    std::sort(samples.begin(), samples.end());
+    return double(samples[samples.size() / 2]) / double(batch);
+}
+
+int main() {
+    dowel::core_session session;
+    std::vector<std::string> services = {"Display Manager", "Input Handler", "Audio System", "Network Stack"};
+
+    int saved_out = dup(STDOUT_FILENO);
+    int null_fd = open("/dev/null", O_WRONLY);
+    std::fflush(stdout);
+    dup2(null_fd, STDOUT_FILENO);
+
+    double text_ns = time_batches([&](int i) {
+        std::string message = "Starting service: " + services[i & 3];
+        dowel_log_info("services", message.c_str());
+    });
+    double fallback_ns = time_batches([&](int i) {
+        DOWEL_LOG_STRUCTURED(DOWEL_LOG_INFO, "services", "Starting service: %s", services[i & 3].c_str());
+    });
+
+    dowel_log_binary_open("/dev/null");
+    double binary_ns = time_batches([&](int i) {
+        DOWEL_LOG_STRUCTURED(DOWEL_LOG_INFO, "services", "Starting service: %s", services[i & 3].c_str());
+    });
+    double binary_int_ns = time_batches([&](int i) {
+        DOWEL_LOG_STRUCTURED(DOWEL_LOG_INFO, "display", "frame %d took %d us", i, i * 3);
+    });
+    dowel_log_binary_close();
+
+    std::fflush(stdout);
+    dup2(saved_out, STDOUT_FILENO);
+    close(null_fd);
+    close(saved_out);
+
+    std::cout << "⚡ Structured vs text logging (caller thread)\n";
+    std::cout << "=============================================\n";
+    bench::report("concat + dowel_log_info", text_ns);
+    bench::report("structured, text fallback", fallback_ns);
+    bench::report("structured, binary (string arg)", binary_ns);
+    bench::report("structured, binary (two ints)", binary_int_ns);
+    return 0;
+}
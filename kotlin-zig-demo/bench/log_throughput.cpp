@@ -0,0 +1,84 @@
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bench_common.hpp"
+#include "dowel_steek_core.hpp"
+
+// Cost per log call of the asynchronous pipeline against the synchronous
+// printf + fflush the wrappers used to do, with stdout sent to /dev/null.
+// Reported times are wall time per entry across all threads. A tight loop
+// logs faster than any terminal can take, so the drop count shows the bounded
+// rings doing their job rather than lost work; on few cores it is high.
+
+static const std::int64_t entries_per_thread = 200000;
+
+static void sync_log(const char* module, const char* message) {
+    std::printf("[INFO] %s: %s\n", module, message);
+    std::fflush(stdout);
+}
+
+template <typename F>
+static double run(int threads, F log) {
+    std::int64_t start = bench::now_ns();
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&] {
+            for (std::int64_t i = 0; i < entries_per_thread; i++) log("bench", "Starting service: Display Manager");
+        });
+    }
+    for (auto& worker : workers) worker.join();
+    return double(bench::now_ns() - start) / double(entries_per_thread * threads);
+}
+
+struct result {
+    int threads;
+    double sync_ns;
+    double async_ns;
+    std::uint64_t dropped;
+    std::uint64_t writer_ns;
+};
+
+int main() {
+    dowel::core_session session;
+
+    // stdout carries the log lines while measuring; results are printed after
+    int saved_out = dup(STDOUT_FILENO);
+    int null_fd = open("/dev/null", O_WRONLY);
+    std::fflush(stdout);
+    dup2(null_fd, STDOUT_FILENO);
+
+    std::vector<result> results;
+    for (int threads : {1, 4}) {
+        result r{threads, run(threads, sync_log), 0, 0, 0};
+
+        auto before = dowel::log::metrics();
+        r.async_ns = run(threads, [](const char* module, const char* message) { dowel_log_info(module, message); });
+        dowel::log::flush();
+        auto after = dowel::log::metrics();
+        r.dropped = after.dropped_entries - before.dropped_entries;
+        r.writer_ns = after.avg_write_time_ns;
+        results.push_back(r);
+    }
+
+    std::fflush(stdout);
+    dup2(saved_out, STDOUT_FILENO);
+    close(null_fd);
+    close(saved_out);
+
+    std::cout << "⚡ Logging throughput (stdout -> /dev/null)\n";
+    std::cout << "===========================================\n";
+    for (const auto& r : results) {
+        std::cout << "\n🧵 " << r.threads << " thread(s)\n";
+        bench::report("printf + fflush", r.sync_ns);
+        bench::report("dowel_log_info", r.async_ns);
+        bench::report("writer time per entry", double(r.writer_ns));
+        std::cout << "   • dropped: " << r.dropped << " of " << entries_per_thread * r.threads << "\n";
+    }
+    std::cout << "\n   Peak ring memory: " << dowel::log::metrics().peak_memory_usage / 1024 << " KiB\n";
+    return 0;
+}
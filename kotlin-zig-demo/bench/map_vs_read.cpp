@@ -0,0 +1,84 @@
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "bench_common.hpp"
+#include "dowel_steek_core.h"
+
+// Whole-file reads from a warm page cache, 4 KB to 1 GB: dowel_storage_read_file
+// (allocate + copy) against dowel_storage_map_file (no copy), each followed by
+// one pass summing the contents so both pay for touching every byte.
+// DOWEL_BENCH_MAX_MB caps the largest file for smaller devices.
+
+static std::uint64_t checksum(const std::uint8_t* data, std::size_t size) {
+    std::uint64_t sum = 0;
+    for (std::size_t i = 0; i < size; i += 64) sum += data[i];
+    return sum;
+}
+
+static bool write_file(const std::string& path, std::size_t size) {
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return false;
+    std::vector<char> block(1 << 20);
+    for (std::size_t i = 0; i < block.size(); i++) block[i] = char(i * 31);
+    std::size_t written = 0;
+    while (written < size) {
+        std::size_t n = std::min(block.size(), size - written);
+        if (write(fd, block.data(), n) != ssize_t(n)) break;
+        written += n;
+    }
+    close(fd);
+    return written == size;
+}
+
+int main() {
+    dowel_core_init();
+
+    std::size_t max_size = std::size_t(1) << 30;
+    if (const char* cap = std::getenv("DOWEL_BENCH_MAX_MB")) max_size = std::size_t(std::atoll(cap)) << 20;
+
+    char dir_template[] = "/tmp/dowel_map_XXXXXX";
+    std::string path = std::string(mkdtemp(dir_template)) + "/data.bin";
+
+    std::cout << "⚡ Whole-file read: copy vs mmap view (warm cache)\n";
+    std::cout << "=================================================\n";
+    std::printf("   %-10s %14s %14s %10s\n", "size", "read (us)", "map (us)", "speedup");
+
+    const std::size_t sizes[] = { 4 << 10, 64 << 10, 1 << 20, 16 << 20, 256 << 20, std::size_t(1) << 30 };
+    for (std::size_t size : sizes) {
+        if (size > max_size) break;
+        if (!write_file(path, size)) {
+            std::cout << "   could not write a " << size << " byte file\n";
+            break;
+        }
+        std::int64_t iterations = std::max<std::int64_t>(1, std::int64_t((64 << 20) / size));
+        int repeats = size >= (256 << 20) ? 2 : 5;
+
+        double read_ns = bench::measure(iterations, [&](std::int64_t n) {
+            for (std::int64_t i = 0; i < n; i++) {
+                dowel_buffer_t* buffer = dowel_storage_read_file(path.c_str());
+                bench::do_not_optimize(checksum(buffer->data, buffer->size));
+                dowel_free_buffer(buffer);
+            }
+        }, repeats);
+
+        double map_ns = bench::measure(iterations, [&](std::int64_t n) {
+            for (std::int64_t i = 0; i < n; i++) {
+                dowel_file_view_t* view = dowel_storage_map_file(path.c_str(), DOWEL_MAP_SEQUENTIAL);
+                bench::do_not_optimize(checksum(view->data, view->size));
+                dowel_file_view_release(view);
+            }
+        }, repeats);
+
+        std::string label = size >= (1 << 20) ? std::to_string(size >> 20) + " MB" : std::to_string(size >> 10) + " KB";
+        std::printf("   %-10s %14.1f %14.1f %9.2fx\n", label.c_str(), read_ns / 1e3, map_ns / 1e3, read_ns / map_ns);
+    }
+
+    unlink(path.c_str());
+    rmdir(path.substr(0, path.rfind('/')).c_str());
+    dowel_core_shutdown();
+    return 0;
+}
@@ -0,0 +1,80 @@
+#include <atomic>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "bench_common.hpp"
+#include "dowel_steek_core.hpp"
+
+// Cache-staleness checks (file_exists + file_modtime) over 20480 files in
+// 1024 folders, with and without the metadata index, then how long opening
+// the index takes cold (full scan) and warm (from its snapshot).
+
+static const int folder_count = 1024;
+static const int files_per_folder = 20;
+
+int main() {
+    dowel::core_session session;
+
+    char dir_template[] = "/tmp/dowel_index_XXXXXX";
+    std::string root = mkdtemp(dir_template);
+    std::string snapshot = root + ".index";
+    std::vector<std::string> paths;
+    for (int d = 0; d < folder_count; d++) {
+        std::string folder = root + "/f" + std::to_string(d);
+        dowel::storage::create_directory(folder);
+        for (int f = 0; f < files_per_folder; f++) {
+            paths.push_back(folder + "/asset" + std::to_string(f) + ".bin");
+            dowel::storage::write_file(paths.back(), dowel::as_bytes(std::string_view("x")));
+        }
+    }
+
+    auto check = [&](std::int64_t n) {
+        std::uint32_t rng = 12345;
+        for (std::int64_t i = 0; i < n; i++) {
+            rng = rng * 1664525u + 1013904223u;
+            const std::string& path = paths[rng % paths.size()];
+            bench::do_not_optimize(dowel::storage::file_exists(path) && dowel::storage::file_modtime(path) > 0);
+        }
+    };
+
+    std::cout << "⚡ Metadata index, 20480 files\n";
+    std::cout << "==============================\n";
+    bench::report("exists + modtime, stat", bench::measure(200000, check));
+
+    std::int64_t start = bench::now_ns();
+    dowel::storage::open_index(root, snapshot);
+    double cold_ms = double(bench::now_ns() - start) / 1e6;
+    bench::report("exists + modtime, index", bench::measure(200000, check));
+
+    std::atomic<bool> stop{false};
+    std::atomic<std::uint64_t> checks{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&] {
+            std::uint64_t local = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                check(1000);
+                local += 1000;
+            }
+            checks.fetch_add(local);
+        });
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    stop.store(true);
+    for (auto& thread : threads) thread.join();
+    bench::report_throughput("exists + modtime, index (4 threads)", checks.load() / 0.5);
+
+    dowel::storage::close_index();
+    start = bench::now_ns();
+    dowel::storage::open_index(root, snapshot);
+    double warm_ms = double(bench::now_ns() - start) / 1e6;
+    std::cout << "   • open: cold scan " << cold_ms << " ms, warm from snapshot " << warm_ms << " ms\n";
+    dowel::storage::close_index();
+
+    std::filesystem::remove_all(root);
+    std::filesystem::remove(snapshot);
+    return 0;
+}
@@ -0,0 +1,86 @@
+#include <cstring>
+#include <numeric>
+#include <string>
+
+#include "bench_common.hpp"
+#include "dowel_steek_core.hpp"
+
+// Compares the header-only C++ SDK against the equivalent raw C calls.
+// Both columns should match within noise: the SDK only adds inline moves
+// and destructor calls that the raw path performs by hand.
+
+static const char* sample_json =
+    R"({"title":"Conversation","create_time":1700000000,"mapping":{"root":{"id":"root","message":{"content":"hello"}}},"moderation":false})";
+
+int main() {
+    std::cout << "⚡ C++ SDK overhead vs raw C API\n";
+    std::cout << "================================\n";
+
+    dowel::core_session session;
+    const std::int64_t n = 200000;
+    std::uint8_t payload[64];
+    std::memset(payload, 0x5a, sizeof(payload));
+
+    std::cout << "\n🔐 SHA-256 of 64 bytes (allocate + free result)\n";
+    bench::report("raw C", bench::measure(n, [&](std::int64_t iters) {
+        for (std::int64_t i = 0; i < iters; i++) {
+            dowel_buffer_t* digest = dowel_crypto_hash_sha256(payload, sizeof(payload));
+            bench::do_not_optimize(digest->data[0]);
+            dowel_free_buffer(digest);
+        }
+    }));
+    bench::report("C++ SDK", bench::measure(n, [&](std::int64_t iters) {
+        for (std::int64_t i = 0; i < iters; i++) {
+            auto digest = dowel::sha256(payload);
+            bench::do_not_optimize(digest.bytes()[0]);
+        }
+    }));
+
+    std::cout << "\n🧾 JSON nested lookup (mapping.root.message.content)\n";
+    dowel_json_value_t* raw_doc = dowel_json_parse(sample_json);
+    auto doc = dowel::json_document::parse(sample_json);
+    bench::report("raw C", bench::measure(n * 10, [&](std::int64_t iters) {
+        for (std::int64_t i = 0; i < iters; i++) {
+            const dowel_json_value_t* v = dowel_json_get_object_value(raw_doc, "mapping");
+            v = dowel_json_get_object_value(v, "root");
+            v = dowel_json_get_object_value(v, "message");
+            const char* s = dowel_json_get_string(dowel_json_get_object_value(v, "content"));
+            bench::do_not_optimize(std::strlen(s));
+        }
+    }));
+    bench::report("C++ SDK", bench::measure(n * 10, [&](std::int64_t iters) {
+        for (std::int64_t i = 0; i < iters; i++) {
+            auto s = doc["mapping"]["root"]["message"]["content"].as_string();
+            bench::do_not_optimize(s.size());
+        }
+    }));
+    dowel_json_free(raw_doc);
+
+    std::cout << "\n📦 Summing a 64 KB gzip buffer\n";
+    std::string text(65536, 'x');
+    auto packed = dowel::compress_gzip(dowel::as_bytes(text));
+    dowel_buffer_t* raw_packed = packed.get();
+    bench::report("raw C (pointer loop)", bench::measure(2000, [&](std::int64_t iters) {
+        for (std::int64_t i = 0; i < iters; i++) {
+            unsigned sum = 0;
+            for (size_t j = 0; j < raw_packed->size; j++) sum += raw_packed->data[j];
+            bench::do_not_optimize(sum);
+        }
+    }));
+    bench::report("C++ SDK (span)", bench::measure(2000, [&](std::int64_t iters) {
+        for (std::int64_t i = 0; i < iters; i++) {
+            auto bytes = packed.bytes();
+            bench::do_not_optimize(std::accumulate(bytes.begin(), bytes.end(), 0u));
+        }
+    }));
+
+    std::cout << "\n🗂️ Storage existence check\n";
+    bench::report("raw C", bench::measure(n, [&](std::int64_t iters) {
+        for (std::int64_t i = 0; i < iters; i++) bench::do_not_optimize(dowel_storage_file_exists("/tmp"));
+    }));
+    bench::report("C++ SDK", bench::measure(n, [&](std::int64_t iters) {
+        for (std::int64_t i = 0; i < iters; i++) bench::do_not_optimize(dowel::storage::file_exists("/tmp"));
+    }));
+
+    return 0;
+}
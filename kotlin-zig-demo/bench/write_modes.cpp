@@ -0,0 +1,86 @@
+#include <atomic>
+#include <fcntl.h>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "bench_common.hpp"
+#include "dowel_steek_core.hpp"
+
+// Small config/vault-sized writes (512 bytes) in each write mode: latency of
+// one writer, then wall time per write with 8 writers to separate files. The baseline
+// is what config and vault files do today, an in-place rewrite followed by
+// fsync. Results depend heavily on the device and filesystem.
+
+static const int writer_count = 8;
+static const auto run_time = std::chrono::milliseconds(1000);
+
+static int write_and_fsync(const std::string& path, dowel::bytes_view data) {
+    int status = dowel::storage::write_file(path, data);
+    int fd = open(path.c_str(), O_WRONLY | O_CLOEXEC);
+    if (fd < 0) return DOWEL_ERROR_STORAGE_ERROR;
+    fsync(fd);
+    close(fd);
+    return status;
+}
+
+template <typename Write>
+static void run(const std::string& name, const std::string& dir, Write write) {
+    std::string body(512, 'v');
+    std::string single = dir + "/single";
+    double latency = bench::measure(50, [&](std::int64_t n) {
+        for (std::int64_t i = 0; i < n; i++) write(single, dowel::as_bytes(body));
+    }, 3);
+    bench::report(name + " (1 writer)", latency);
+
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> writes{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < writer_count; t++) {
+        threads.emplace_back([&, t] {
+            std::string path = dir + "/writer" + std::to_string(t);
+            uint64_t local = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                write(path, dowel::as_bytes(body));
+                local++;
+            }
+            writes.fetch_add(local);
+        });
+    }
+    std::this_thread::sleep_for(run_time);
+    stop.store(true);
+    for (auto& thread : threads) thread.join();
+
+    // Wall time per completed write across all writers
+    double elapsed_ns = std::chrono::duration<double, std::nano>(run_time).count();
+    bench::report(name + " (" + std::to_string(writer_count) + " writers)", elapsed_ns / double(writes.load()));
+}
+
+int main() {
+    dowel::core_session session;
+
+    char dir_template[] = "/tmp/dowel_writes_XXXXXX";
+    std::string dir = mkdtemp(dir_template);
+
+    std::cout << "⚡ Write modes, 512 byte files\n";
+    std::cout << "==============================\n";
+    run("in place + fsync (today)", dir, write_and_fsync);
+    run("FAST", dir, [](const std::string& path, dowel::bytes_view data) {
+        return dowel::storage::write_file(path, data, DOWEL_WRITE_FAST);
+    });
+    run("ATOMIC", dir, [](const std::string& path, dowel::bytes_view data) {
+        return dowel::storage::write_file(path, data, DOWEL_WRITE_ATOMIC);
+    });
+    auto group = [](const std::string& path, dowel::bytes_view data) {
+        return dowel::storage::write_file(path, data, DOWEL_WRITE_GROUP);
+    };
+    run("GROUP", dir, group);
+    dowel_config_set_int("storage.group_commit_us", 500);
+    run("GROUP, 500 us window", dir, group);
+
+    dowel::storage::delete_file(dir + "/single");
+    for (int t = 0; t < writer_count; t++) dowel::storage::delete_file(dir + "/writer" + std::to_string(t));
+    rmdir(dir.c_str());
+    return 0;
+}
@@ -35,7 +35,7 @@ compose.desktop {
 tasks.register<Exec>("buildNativeLibrary") {
     description = "Build shared library for JVM integration"
     workingDir = projectDir
-    commandLine("gcc", "-shared", "-fPIC", "-o", "libdowel-steek-jvm.so", "c_wrapper.c")
+    commandLine("gcc", "-shared", "-fPIC", "-pthread", "-o", "libdowel-steek-jvm.so", "c_wrapper.c", "core/config_store.c", "core/log_pipeline.c", "core/pool_alloc.c")
 
     doLast {
         val resourcesDir = file("src/main/resources")
@@ -0,0 +1,97 @@
+#!/bin/bash
+
+# Build script for the C core (full dowel_steek_core.h API)
+# Usage: ./build_core.sh [lib|wrapper|tools|test|bench|clean]
+set -e
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+BUILD_DIR="$SCRIPT_DIR/core-build"
+HEADER_PATH="$SCRIPT_DIR/../mobile-rewrite/zig-core/c_headers"
+LIB_PATH="$BUILD_DIR/libdowel-steek-core.a"
+
+CC="${CC:-gcc}"
+CXX="${CXX:-g++}"
+CFLAGS="-std=gnu11 -O2 -g -Wall -Wextra -fPIC -pthread -I$HEADER_PATH $CFLAGS"
+CXXFLAGS="-std=c++20 -O2 -g -Wall -Wextra -pthread -I$HEADER_PATH -I$SCRIPT_DIR/bench $CXXFLAGS"
+LDLIBS="-lz -pthread $LDLIBS"
+
+# zstd is optional: the zstd codec is built in when its header and library
+# are found, otherwise dowel_codec_available(DOWEL_CODEC_ZSTD) is false
+if printf '#include <zstd.h>\nint main(void) { return (int)ZSTD_compressBound(0); }\n' |
+    $CC $CFLAGS -x c - $LDLIBS -lzstd -o /dev/null 2>/dev/null; then
+    CFLAGS="$CFLAGS -DDOWEL_HAVE_ZSTD"
+    LDLIBS="$LDLIBS -lzstd"
+fi
+
+build_lib() {
+    echo "🔨 Building C core library..."
+    mkdir -p "$BUILD_DIR/obj"
+
+    local objects=()
+    for src in "$SCRIPT_DIR"/core/*.c; do
+        local obj="$BUILD_DIR/obj/$(basename "${src%.c}").o"
+        $CC $CFLAGS -c "$src" -o "$obj"
+        objects+=("$obj")
+    done
+
+    rm -f "$LIB_PATH"
+    ar rcs "$LIB_PATH" "${objects[@]}"
+    echo "✅ Library built: $LIB_PATH"
+}
+
+# The minimal C wrapper (c_wrapper.c) shares the config store, log pipeline
+# and pool allocator with the core
+build_wrapper() {
+    echo "🔨 Building minimal C wrapper library..."
+    mkdir -p "$BUILD_DIR/obj"
+    $CC $CFLAGS -c "$SCRIPT_DIR/c_wrapper.c" -o "$BUILD_DIR/obj/wrapper_c_wrapper.o"
+    $CC $CFLAGS -c "$SCRIPT_DIR/core/config_store.c" -o "$BUILD_DIR/obj/wrapper_config_store.o"
+    $CC $CFLAGS -c "$SCRIPT_DIR/core/log_pipeline.c" -o "$BUILD_DIR/obj/wrapper_log_pipeline.o"
+    $CC $CFLAGS -c "$SCRIPT_DIR/core/pool_alloc.c" -o "$BUILD_DIR/obj/wrapper_pool_alloc.o"
+
+    rm -f "$SCRIPT_DIR/libdowel-steek-c-wrapper.a"
+    ar rcs "$SCRIPT_DIR/libdowel-steek-c-wrapper.a" "$BUILD_DIR/obj/wrapper_c_wrapper.o" \
+        "$BUILD_DIR/obj/wrapper_config_store.o" "$BUILD_DIR/obj/wrapper_log_pipeline.o" \
+        "$BUILD_DIR/obj/wrapper_pool_alloc.o"
+    echo "✅ Library built: $SCRIPT_DIR/libdowel-steek-c-wrapper.a"
+}
+
+# Offline tools that share format definitions with the core
+build_tools() {
+    echo "🔨 Building tools..."
+    mkdir -p "$BUILD_DIR"
+    $CC $CFLAGS "$SCRIPT_DIR/tools/log_decode.c" "$SCRIPT_DIR/core/log_format.c" -o "$BUILD_DIR/dowel_log_decode"
+    echo "✅ $BUILD_DIR/dowel_log_decode"
+}
+
+build_test() {
+    build_lib
+    build_tools
+    echo "🔨 Building core tests..."
+    $CXX $CXXFLAGS "$SCRIPT_DIR/core_test.cpp" "$LIB_PATH" $LDLIBS -o "$BUILD_DIR/core_test"
+    echo "🧪 Running core tests..."
+    DOWEL_LOG_DECODE="$BUILD_DIR/dowel_log_decode" "$BUILD_DIR/core_test"
+}
+
+build_bench() {
+    build_lib
+    echo "🔨 Building benchmarks..."
+    for src in "$SCRIPT_DIR"/bench/*.cpp; do
+        local name="bench_$(basename "${src%.cpp}")"
+        $CXX $CXXFLAGS "$src" "$LIB_PATH" $LDLIBS -o "$BUILD_DIR/$name"
+        echo "✅ $BUILD_DIR/$name"
+    done
+}
+
+case "${1:-test}" in
+    lib) build_lib ;;
+    wrapper) build_wrapper ;;
+    tools) build_tools ;;
+    test) build_test ;;
+    bench) build_bench ;;
+    clean) rm -rf "$BUILD_DIR" ;;
+    *)
+        echo "Usage: $0 [lib|wrapper|tools|test|bench|clean]"
+        exit 1
+        ;;
+esac
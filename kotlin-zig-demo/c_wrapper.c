@@ -5,6 +5,10 @@
 #include <unistd.h>
 #include <sys/time.h>
 
+#include "core/config_store.h"
+#include "core/log_pipeline.h"
+#include "core/pool_alloc.h"
+
 // Simple C implementations that mimic the Zig functions
 // This avoids the stack probing issues when linking with Kotlin/Native
 
@@ -21,6 +25,8 @@ int dowel_core_init(void) {
 void dowel_core_shutdown(void) {
     printf("[C_WRAPPER] Shutting down Dowel-Steek core system...\n");
     system_initialized = false;
+    dcore_log_shutdown();
+    dcore_config_reset();
 }
 
 bool dowel_core_is_initialized(void) {
@@ -49,19 +55,13 @@ int dowel_string_length(const char* str) {
     return strlen(str);
 }
 
-// Logging functions
+// Logging functions - queued and written by the shared background writer
 void dowel_log_info(const char* message) {
-    if (message) {
-        printf("[INFO] %s\n", message);
-        fflush(stdout);
-    }
+    dcore_log_write(DCORE_LOG_INFO, NULL, message);
 }
 
 void dowel_log_error(const char* message) {
-    if (message) {
-        fprintf(stderr, "[ERROR] %s\n", message);
-        fflush(stderr);
-    }
+    dcore_log_write(DCORE_LOG_ERROR, NULL, message);
 }
 
 // Utility functions
@@ -77,38 +77,36 @@ void dowel_sleep_ms(int milliseconds) {
     }
 }
 
-// Memory management functions
+// Memory management functions - shared size-class pools (core/pool_alloc.c)
 void* dowel_malloc(size_t size) {
-    return malloc(size);
+    return dcore_pool_alloc(size);
 }
 
 void dowel_free(void* ptr) {
-    free(ptr);
+    dcore_pool_free(ptr);
 }
 
-// Configuration functions (simple implementation)
-static char config_buffer[1024] = {0};
-
+// Configuration functions - shared keyed store (core/config_store.c)
 int dowel_config_set_string(const char* key, const char* value) {
     if (!key || !value) return -1;
-    // Simple implementation - just store one value
-    snprintf(config_buffer, sizeof(config_buffer), "%s", value);
-    return 0;
+    dcore_config_value_t v = { .type = DCORE_CONFIG_STRING, .as.string = value };
+    return dcore_config_set(key, &v) ? 0 : -2; // DOWEL_OUT_OF_MEMORY
 }
 
 const char* dowel_config_get_string(const char* key, const char* default_value) {
-    if (!key) return default_value;
-    // Simple implementation - return stored value or default
-    if (strlen(config_buffer) > 0) {
-        return config_buffer;
-    }
-    return default_value;
+    dcore_config_value_t v;
+    if (!dcore_config_get(key, &v) || v.type != DCORE_CONFIG_STRING) return default_value;
+    return v.as.string;
 }
 
 int dowel_config_get_int(const char* key, int default_value) {
-    return default_value; // Simple implementation
+    dcore_config_value_t v;
+    if (!dcore_config_get(key, &v) || v.type != DCORE_CONFIG_INT) return default_value;
+    return (int)v.as.integer;
 }
 
 int dowel_config_set_int(const char* key, int value) {
-    return 0; // Simple implementation
-}
\ No newline at end of file
+    if (!key) return -1;
+    dcore_config_value_t v = { .type = DCORE_CONFIG_INT, .as.integer = value };
+    return dcore_config_set(key, &v) ? 0 : -2; // DOWEL_OUT_OF_MEMORY
+}
@@ -112,7 +112,7 @@ tasks.register<Exec>("buildNativeLibrary") {
         println("🔧 Building native library for Compose Desktop integration...")
     }
 
-    commandLine("gcc", "-shared", "-fPIC", "-o", "libdowel-steek-jvm.so", "c_wrapper.c")
+    commandLine("gcc", "-shared", "-fPIC", "-pthread", "-o", "libdowel-steek-jvm.so", "c_wrapper.c", "core/config_store.c", "core/log_pipeline.c", "core/pool_alloc.c")
 
     doLast {
         println("✅ Native library built: libdowel-steek-jvm.so")
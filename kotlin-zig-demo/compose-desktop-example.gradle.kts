@@ -83,10 +83,10 @@ tasks.withType<org.jetbrains.kotlin.gradle.tasks.KotlinCompile> {
 tasks.register<Exec>("buildNativeLibrary") {
     description = "Build the C wrapper library"
     workingDir = projectDir
-    commandLine("gcc", "-c", "-fPIC", "c_wrapper.c", "-o", "c_wrapper.o")
+    commandLine("gcc", "-c", "-fPIC", "-pthread", "c_wrapper.c", "core/config_store.c", "core/log_pipeline.c", "core/pool_alloc.c")
     doLast {
         exec {
-            commandLine("ar", "rcs", "libdowel-steek-c-wrapper.so", "c_wrapper.o")
+            commandLine("ar", "rcs", "libdowel-steek-c-wrapper.so", "c_wrapper.o", "config_store.o", "log_pipeline.o", "pool_alloc.o")
         }
     }
 }
@@ -0,0 +1,188 @@
+#define _GNU_SOURCE
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "core_internal.h"
+
+// Arenas are a list of chunks in allocation order. Reset rewinds to the first
+// chunk and keeps the default-sized ones for the next frame; chunks made for
+// a single oversized allocation are freed so one large file read does not
+// stay resident. Blocks are 16 byte aligned, like malloc.
+
+#define ARENA_ALIGN 16
+#define ARENA_DEFAULT_CHUNK (64 * 1024)
+
+typedef struct arena_chunk {
+    struct arena_chunk* next;
+    size_t capacity;
+    size_t used;
+    _Alignas(ARENA_ALIGN) uint8_t data[];
+} arena_chunk_t;
+
+struct dowel_arena {
+    arena_chunk_t* first;
+    arena_chunk_t* current;
+    size_t chunk_size;
+    size_t used;    // bytes handed out since the last reset
+    uint8_t* last;  // most recent allocation, which can grow or be returned in place
+};
+
+static inline size_t align_up(size_t size) {
+    return (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+}
+
+static arena_chunk_t* chunk_new(size_t capacity) {
+    arena_chunk_t* chunk = malloc(sizeof(*chunk) + capacity);
+    if (!chunk) return NULL;
+    chunk->next = NULL;
+    chunk->capacity = capacity;
+    chunk->used = 0;
+    return chunk;
+}
+
+dowel_arena_t* dowel_arena_create(size_t chunk_size) {
+    dowel_arena_t* arena = calloc(1, sizeof(*arena));
+    if (!arena) return NULL;
+
+    arena->chunk_size = chunk_size ? align_up(chunk_size) : ARENA_DEFAULT_CHUNK;
+    arena->first = arena->current = chunk_new(arena->chunk_size);
+    if (!arena->first) {
+        free(arena);
+        return NULL;
+    }
+    return arena;
+}
+
+void* dowel_arena_alloc(dowel_arena_t* arena, size_t size) {
+    if (!arena || size > SIZE_MAX - ARENA_ALIGN) return NULL;
+    size_t needed = align_up(size ? size : 1);
+
+    arena_chunk_t* chunk = arena->current;
+    if (chunk->capacity - chunk->used < needed) {
+        // Move to a retained chunk, or link in a new one after the current
+        arena_chunk_t* next = chunk->next;
+        if (!next || next->capacity < needed) {
+            next = chunk_new(needed > arena->chunk_size ? needed : arena->chunk_size);
+            if (!next) return NULL;
+            next->next = chunk->next;
+            chunk->next = next;
+        }
+        chunk = arena->current = next;
+    }
+
+    uint8_t* block = chunk->data + chunk->used;
+    chunk->used += needed;
+    arena->used += needed;
+    arena->last = block;
+    return block;
+}
+
+char* dowel_arena_strdup(dowel_arena_t* arena, const char* str) {
+    if (!str) return NULL;
+    size_t length = strlen(str);
+    char* copy = dowel_arena_alloc(arena, length + 1);
+    if (copy) memcpy(copy, str, length + 1);
+    return copy;
+}
+
+char* dowel_arena_format(dowel_arena_t* arena, const char* format, ...) {
+    if (!arena || !format) return NULL;
+
+    va_list args;
+    va_start(args, format);
+    arena_chunk_t* chunk = arena->current;
+    size_t room = chunk->capacity - chunk->used;
+    int length = vsnprintf((char*)chunk->data + chunk->used, room, format, args);
+    va_end(args);
+    if (length < 0) return NULL;
+
+    // Formatted straight into the free space when it fits
+    if (align_up((size_t)length + 1) <= room) return dowel_arena_alloc(arena, (size_t)length + 1);
+
+    char* out = dowel_arena_alloc(arena, (size_t)length + 1);
+    if (!out) return NULL;
+    va_start(args, format);
+    vsnprintf(out, (size_t)length + 1, format, args);
+    va_end(args);
+    return out;
+}
+
+void dowel_arena_reset(dowel_arena_t* arena) {
+    if (!arena) return;
+
+    arena_chunk_t** link = &arena->first->next;
+    while (*link) {
+        arena_chunk_t* chunk = *link;
+        if (chunk->capacity > arena->chunk_size) {
+            *link = chunk->next;
+            free(chunk);
+        } else {
+            chunk->used = 0;
+            link = &chunk->next;
+        }
+    }
+    arena->first->used = 0;
+    arena->current = arena->first;
+    arena->used = 0;
+    arena->last = NULL;
+}
+
+void dowel_arena_destroy(dowel_arena_t* arena) {
+    if (!arena) return;
+    arena_chunk_t* chunk = arena->first;
+    while (chunk) {
+        arena_chunk_t* next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+    free(arena);
+}
+
+size_t dowel_arena_used(const dowel_arena_t* arena) {
+    return arena ? arena->used : 0;
+}
+
+// Allocation for data returned through the public API
+
+void* dcore_alloc_in(dowel_arena_t* arena, size_t size) {
+    return arena ? dowel_arena_alloc(arena, size) : malloc(size ? size : 1);
+}
+
+void* dcore_realloc_in(dowel_arena_t* arena, void* ptr, size_t old_size, size_t new_size) {
+    if (!arena) return realloc(ptr, new_size ? new_size : 1);
+    if (!ptr) return dowel_arena_alloc(arena, new_size);
+
+    // The latest block grows in place while its chunk has room
+    arena_chunk_t* chunk = arena->current;
+    if (ptr == arena->last) {
+        size_t offset = (size_t)((uint8_t*)ptr - chunk->data);
+        size_t needed = align_up(new_size ? new_size : 1);
+        if (needed <= chunk->capacity - offset) {
+            size_t old_needed = chunk->used - offset;
+            chunk->used = offset + needed;
+            arena->used = arena->used - old_needed + needed;
+            return ptr;
+        }
+    }
+
+    void* grown = dowel_arena_alloc(arena, new_size);
+    if (grown) memcpy(grown, ptr, old_size < new_size ? old_size : new_size);
+    return grown;
+}
+
+void dcore_free_in(dowel_arena_t* arena, void* ptr) {
+    if (!arena) {
+        free(ptr);
+        return;
+    }
+    // Only the latest block can be given back; the rest waits for the reset
+    if (ptr && ptr == arena->last) {
+        arena_chunk_t* chunk = arena->current;
+        size_t offset = (size_t)((uint8_t*)ptr - chunk->data);
+        arena->used -= chunk->used - offset;
+        chunk->used = offset;
+        arena->last = NULL;
+    }
+}
@@ -0,0 +1,674 @@
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+
+#include "core_internal.h"
+#include "pool_alloc.h"
+
+// Threading and async support - a work-stealing pool
+//
+//  - One worker per online CPU (at least two, so a task blocked in a syscall
+//    does not stall a single-core device), or "async.worker_threads" if set
+//    before the first spawn. Workers start with the first spawn and are
+//    joined by dowel_core_shutdown after draining every queued task.
+//  - Each worker owns a Chase-Lev deque. Tasks spawned on a worker are pushed
+//    to its own deque and popped LIFO; idle workers steal FIFO from the
+//    others. Tasks spawned from outside the pool go through a locked
+//    injection queue; affinity hints go to the preferred worker's inbox,
+//    which that worker drains first and others only steal from when idle.
+//  - A task holds two references, the caller's handle and the scheduler's,
+//    so a handle can be freed while a cancelled task is still queued.
+//  - Continuations (then/when_all) are edges pushed onto a lock-free list on
+//    each antecedent. A finishing task seals its list and counts down each
+//    successor's dependencies; the last one schedules it. Successors of a
+//    cancelled task are cancelled with it, except dowel_async_finally ones.
+//  - Task objects come from the pooled allocator (pool_alloc.c), so a spawn
+//    is a thread-cache pop rather than a malloc.
+
+enum {
+    TASK_PENDING = 0,
+    TASK_RUNNING = 1,
+    TASK_COMPLETE = 2,
+    TASK_CANCELLED = 3,
+};
+
+// Continuation edge: successor waits for the task it hangs off
+typedef struct task_edge {
+    struct task_edge* next;
+    dowel_task_t* successor;
+    bool always; // dowel_async_finally: runs even if the antecedent is cancelled
+} task_edge_t;
+
+// Replaces the successor list once the task has finished
+#define EDGES_SEALED ((task_edge_t*)1)
+
+struct dowel_task {
+    dowel_callback_t callback;
+    void* user_data;
+    struct dowel_task* next; // inbox and injection queue link
+    _Atomic(task_edge_t*) successors;
+    atomic_int dependencies;  // unfinished antecedents, plus one while being set up
+    atomic_int state;
+    atomic_int refs;
+    atomic_bool cancel_requested;
+};
+
+// Chase-Lev deque (Le et al., "Correct and Efficient Work-Stealing for Weak
+// Memory Models"). The owner pushes and takes at the bottom; thieves steal
+// from the top. Arrays replaced by growth are kept until the pool stops,
+// since a thief may still be reading one.
+
+#define DEQUE_INITIAL_CAPACITY 1024
+
+typedef struct deque_array {
+    struct deque_array* retired;
+    int64_t mask;
+    _Atomic(dowel_task_t*) slots[];
+} deque_array_t;
+
+typedef struct {
+    _Alignas(64) atomic_llong top;
+    _Alignas(64) atomic_llong bottom;
+    _Atomic(deque_array_t*) array;
+} deque_t;
+
+static deque_array_t* deque_array_new(int64_t capacity) {
+    deque_array_t* array = malloc(sizeof(*array) + (size_t)capacity * sizeof(array->slots[0]));
+    if (!array) return NULL;
+    array->retired = NULL;
+    array->mask = capacity - 1;
+    return array;
+}
+
+static bool deque_init(deque_t* deque) {
+    deque_array_t* array = deque_array_new(DEQUE_INITIAL_CAPACITY);
+    if (!array) return false;
+    atomic_init(&deque->top, 0);
+    atomic_init(&deque->bottom, 0);
+    atomic_init(&deque->array, array);
+    return true;
+}
+
+static void deque_destroy(deque_t* deque) {
+    deque_array_t* array = atomic_load_explicit(&deque->array, memory_order_relaxed);
+    while (array) {
+        deque_array_t* retired = array->retired;
+        free(array);
+        array = retired;
+    }
+}
+
+static bool deque_push(deque_t* deque, dowel_task_t* task) {
+    int64_t bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed);
+    int64_t top = atomic_load_explicit(&deque->top, memory_order_acquire);
+    deque_array_t* array = atomic_load_explicit(&deque->array, memory_order_relaxed);
+
+    if (bottom - top > array->mask) {
+        deque_array_t* grown = deque_array_new((array->mask + 1) * 2);
+        if (!grown) return false;
+        for (int64_t i = top; i < bottom; i++) {
+            dowel_task_t* item = atomic_load_explicit(&array->slots[i & array->mask], memory_order_relaxed);
+            atomic_store_explicit(&grown->slots[i & grown->mask], item, memory_order_relaxed);
+        }
+        grown->retired = array;
+        atomic_store_explicit(&deque->array, grown, memory_order_release);
+        array = grown;
+    }
+
+    atomic_store_explicit(&array->slots[bottom & array->mask], task, memory_order_relaxed);
+    atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_release);
+    return true;
+}
+
+static dowel_task_t* deque_take(deque_t* deque) {
+    int64_t bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed) - 1;
+    deque_array_t* array = atomic_load_explicit(&deque->array, memory_order_relaxed);
+    atomic_store_explicit(&deque->bottom, bottom, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t top = atomic_load_explicit(&deque->top, memory_order_relaxed);
+
+    if (top > bottom) {
+        atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+        return NULL;
+    }
+
+    dowel_task_t* task = atomic_load_explicit(&array->slots[bottom & array->mask], memory_order_relaxed);
+    if (top == bottom) {
+        // Last item: race the thieves for it
+        if (!atomic_compare_exchange_strong_explicit(&deque->top, &top, top + 1,
+                                                     memory_order_seq_cst, memory_order_relaxed)) {
+            task = NULL;
+        }
+        atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+    }
+    return task;
+}
+
+static dowel_task_t* deque_steal(deque_t* deque) {
+    int64_t top = atomic_load_explicit(&deque->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t bottom = atomic_load_explicit(&deque->bottom, memory_order_acquire);
+    if (top >= bottom) return NULL;
+
+    deque_array_t* array = atomic_load_explicit(&deque->array, memory_order_acquire);
+    dowel_task_t* task = atomic_load_explicit(&array->slots[top & array->mask], memory_order_relaxed);
+    if (!atomic_compare_exchange_strong_explicit(&deque->top, &top, top + 1,
+                                                 memory_order_seq_cst, memory_order_relaxed)) {
+        return NULL; // lost to the owner or another thief
+    }
+    return task;
+}
+
+// Locked FIFO used for the injection queue and the affinity inboxes
+typedef struct {
+    pthread_mutex_t lock;
+    dowel_task_t* head;
+    dowel_task_t* tail;
+    atomic_bool nonempty; // lets idle workers skip the lock
+} task_queue_t;
+
+static void queue_init(task_queue_t* queue) {
+    pthread_mutex_init(&queue->lock, NULL);
+    queue->head = queue->tail = NULL;
+    atomic_init(&queue->nonempty, false);
+}
+
+static void queue_push(task_queue_t* queue, dowel_task_t* task) {
+    task->next = NULL;
+    pthread_mutex_lock(&queue->lock);
+    if (queue->tail) {
+        queue->tail->next = task;
+    } else {
+        queue->head = task;
+    }
+    queue->tail = task;
+    atomic_store_explicit(&queue->nonempty, true, memory_order_relaxed);
+    pthread_mutex_unlock(&queue->lock);
+}
+
+static dowel_task_t* queue_pop(task_queue_t* queue) {
+    if (!atomic_load_explicit(&queue->nonempty, memory_order_relaxed)) return NULL;
+
+    pthread_mutex_lock(&queue->lock);
+    dowel_task_t* task = queue->head;
+    if (task) {
+        queue->head = task->next;
+        if (!queue->head) {
+            queue->tail = NULL;
+            atomic_store_explicit(&queue->nonempty, false, memory_order_relaxed);
+        }
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return task;
+}
+
+// The pool
+
+typedef struct {
+    deque_t deque;
+    task_queue_t inbox;
+    pthread_t thread;
+    int index;
+    uint32_t rng;
+    bool idle_slot; // no thread; its inbox is served by stealing
+} worker_t;
+
+static struct {
+    pthread_mutex_t lock; // start/stop, idle sleep and blocked waiters
+    pthread_cond_t work_available;
+    pthread_cond_t task_done;
+    worker_t* workers;
+    int worker_count;
+    atomic_bool running;
+    atomic_bool stopping;
+    atomic_int sleepers;
+    atomic_bool wake_pending;
+    atomic_int blocked_waiters;
+    task_queue_t injection;
+} pool = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .work_available = PTHREAD_COND_INITIALIZER,
+    .task_done = PTHREAD_COND_INITIALIZER,
+};
+
+static pthread_once_t injection_once = PTHREAD_ONCE_INIT;
+static _Thread_local worker_t* current_worker;
+static _Thread_local dowel_task_t* current_task;
+
+static void init_injection(void) {
+    queue_init(&pool.injection);
+}
+
+static void release_task(dowel_task_t* task) {
+    if (atomic_fetch_sub_explicit(&task->refs, 1, memory_order_acq_rel) == 1) dcore_pool_free(task);
+}
+
+static void wake_worker(void) {
+    // Pairs with the fence in idle(): either the sleeper sees the new work on
+    // its last scan or we see it counted here
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&pool.sleepers, memory_order_relaxed) > 0 &&
+        !atomic_exchange_explicit(&pool.wake_pending, true, memory_order_relaxed)) {
+        // One wake-up in flight at a time; the woken worker clears the flag
+        pthread_mutex_lock(&pool.lock);
+        pthread_cond_signal(&pool.work_available);
+        pthread_mutex_unlock(&pool.lock);
+    }
+}
+
+static void notify_waiters(void) {
+    if (atomic_load_explicit(&pool.blocked_waiters, memory_order_seq_cst) > 0) {
+        pthread_mutex_lock(&pool.lock);
+        pthread_cond_broadcast(&pool.task_done);
+        pthread_mutex_unlock(&pool.lock);
+    }
+}
+
+static void schedule(dowel_task_t* task, int worker) {
+    worker_t* self = current_worker;
+    if (worker >= 0 && worker < pool.worker_count && &pool.workers[worker] != self) {
+        queue_push(&pool.workers[worker].inbox, task);
+    } else if (self) {
+        if (!deque_push(&self->deque, task)) queue_push(&pool.injection, task);
+    } else {
+        queue_push(&pool.injection, task);
+    }
+    wake_worker();
+}
+
+static bool cancel_pending(dowel_task_t* task) {
+    atomic_store_explicit(&task->cancel_requested, true, memory_order_relaxed);
+    int expected = TASK_PENDING;
+    if (!atomic_compare_exchange_strong(&task->state, &expected, TASK_CANCELLED)) return false;
+    notify_waiters();
+    return true;
+}
+
+static void resolve_dependency(dowel_task_t* task) {
+    if (atomic_fetch_sub_explicit(&task->dependencies, 1, memory_order_acq_rel) == 1) {
+        schedule(task, DOWEL_ASYNC_ANY_WORKER);
+    }
+}
+
+static void finish_successors(dowel_task_t* task, bool cancelled) {
+    task_edge_t* edge = atomic_exchange_explicit(&task->successors, EDGES_SEALED, memory_order_acq_rel);
+    while (edge) {
+        task_edge_t* next = edge->next;
+        if (cancelled && !edge->always) cancel_pending(edge->successor);
+        resolve_dependency(edge->successor);
+        dcore_pool_free(edge);
+        edge = next;
+    }
+}
+
+static void run_task(dowel_task_t* task) {
+    int expected = TASK_PENDING;
+    bool cancelled = true;
+    if (atomic_compare_exchange_strong_explicit(&task->state, &expected, TASK_RUNNING,
+                                                memory_order_acquire, memory_order_relaxed)) {
+        dowel_task_t* outer = current_task;
+        current_task = task;
+        task->callback(task->user_data);
+        current_task = outer;
+
+        atomic_store_explicit(&task->state, TASK_COMPLETE, memory_order_seq_cst);
+        notify_waiters();
+        cancelled = false;
+    }
+    finish_successors(task, cancelled);
+    release_task(task);
+}
+
+static dowel_task_t* steal_any(worker_t* self) {
+    int count = pool.worker_count;
+    // Start at a random victim so thieves spread out
+    uint32_t start = 0;
+    if (self) {
+        self->rng = self->rng * 1664525u + 1013904223u;
+        start = self->rng >> 8;
+    }
+    for (int i = 0; i < count; i++) {
+        worker_t* victim = &pool.workers[(start + (uint32_t)i) % (uint32_t)count];
+        if (victim == self) continue;
+        dowel_task_t* task = deque_steal(&victim->deque);
+        if (task) return task;
+    }
+    for (int i = 0; i < count; i++) {
+        worker_t* victim = &pool.workers[(start + (uint32_t)i) % (uint32_t)count];
+        if (victim == self) continue;
+        dowel_task_t* task = queue_pop(&victim->inbox);
+        if (task) return task;
+    }
+    return NULL;
+}
+
+static dowel_task_t* find_task(worker_t* self) {
+    dowel_task_t* task = deque_take(&self->deque);
+    if (!task) task = queue_pop(&self->inbox);
+    if (!task) task = queue_pop(&pool.injection);
+    if (!task) task = steal_any(self);
+    return task;
+}
+
+static bool has_work(void) {
+    if (atomic_load_explicit(&pool.injection.nonempty, memory_order_relaxed)) return true;
+    for (int i = 0; i < pool.worker_count; i++) {
+        worker_t* worker = &pool.workers[i];
+        if (atomic_load_explicit(&worker->inbox.nonempty, memory_order_relaxed)) return true;
+        if (atomic_load_explicit(&worker->deque.top, memory_order_relaxed) <
+            atomic_load_explicit(&worker->deque.bottom, memory_order_relaxed)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Sleeps until work may be available; returns false once the pool is stopping
+// and every queue is empty
+static bool idle(void) {
+    for (int spin = 0; spin < 16; spin++) {
+        if (has_work()) return true;
+        sched_yield();
+    }
+
+    pthread_mutex_lock(&pool.lock);
+    atomic_fetch_add_explicit(&pool.sleepers, 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    bool keep_running = true;
+    if (!has_work()) {
+        if (atomic_load(&pool.stopping)) {
+            keep_running = false;
+        } else {
+            atomic_store_explicit(&pool.wake_pending, false, memory_order_relaxed);
+            pthread_cond_wait(&pool.work_available, &pool.lock);
+        }
+    }
+    atomic_store_explicit(&pool.wake_pending, false, memory_order_relaxed);
+    atomic_fetch_sub_explicit(&pool.sleepers, 1, memory_order_relaxed);
+    pthread_mutex_unlock(&pool.lock);
+    return keep_running;
+}
+
+static void* worker_main(void* arg) {
+    worker_t* self = arg;
+    current_worker = self;
+
+    for (;;) {
+        dowel_task_t* task = find_task(self);
+        if (task) {
+            // Wake-ups are coalesced into one, so pass it on while work is
+            // left for a sleeping peer; a burst then wakes a worker per task
+            if (atomic_load_explicit(&pool.sleepers, memory_order_relaxed) > 0 && has_work()) wake_worker();
+            run_task(task);
+        } else if (!idle()) {
+            break;
+        }
+    }
+
+    current_worker = NULL;
+    return NULL;
+}
+
+static int configured_workers(void) {
+    int64_t configured = dowel_config_get_int("async.worker_threads", 0);
+    if (configured > 0) return configured > 256 ? 256 : (int)configured;
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    return cpus > 2 ? (int)cpus : 2;
+}
+
+static bool ensure_pool(void) {
+    if (atomic_load_explicit(&pool.running, memory_order_acquire)) return true;
+
+    pthread_once(&injection_once, init_injection);
+    pthread_mutex_lock(&pool.lock);
+    if (atomic_load(&pool.running)) {
+        pthread_mutex_unlock(&pool.lock);
+        return true;
+    }
+
+    int count = configured_workers();
+    // Cache-line aligned so neighbouring deques do not share lines
+    worker_t* workers = aligned_alloc(64, (size_t)count * sizeof(*workers));
+    if (workers) memset(workers, 0, (size_t)count * sizeof(*workers));
+    int ready = 0;
+    for (; workers && ready < count; ready++) {
+        worker_t* worker = &workers[ready];
+        worker->index = ready;
+        worker->rng = 0x9e3779b9u * (uint32_t)(ready + 1);
+        queue_init(&worker->inbox);
+        if (!deque_init(&worker->deque)) break;
+    }
+
+    // Every deque exists before any worker can try to steal from it
+    pool.workers = workers;
+    pool.worker_count = ready;
+    atomic_store(&pool.stopping, false);
+    int started = 0;
+    for (; started < ready; started++) {
+        if (pthread_create(&workers[started].thread, NULL, worker_main, &workers[started]) != 0) break;
+    }
+    for (int i = started; i < ready; i++) workers[i].idle_slot = true;
+
+    if (started == 0) {
+        for (int i = 0; i < ready; i++) deque_destroy(&workers[i].deque);
+        free(workers);
+        pool.workers = NULL;
+        pool.worker_count = 0;
+        pthread_mutex_unlock(&pool.lock);
+        dcore_report_error(DOWEL_ERROR_SYSTEM_ERROR, "Failed to start task workers");
+        return false;
+    }
+    atomic_store_explicit(&pool.running, true, memory_order_release);
+    pthread_mutex_unlock(&pool.lock);
+    return true;
+}
+
+void dcore_async_shutdown(void) {
+    pthread_mutex_lock(&pool.lock);
+    if (!atomic_load(&pool.running) || current_worker) {
+        pthread_mutex_unlock(&pool.lock);
+        return;
+    }
+    atomic_store(&pool.stopping, true);
+    pthread_cond_broadcast(&pool.work_available);
+    pthread_mutex_unlock(&pool.lock);
+
+    // Workers exit once every queue is empty, so queued tasks still run
+    for (int i = 0; i < pool.worker_count; i++) {
+        if (!pool.workers[i].idle_slot) pthread_join(pool.workers[i].thread, NULL);
+    }
+
+    pthread_mutex_lock(&pool.lock);
+    for (int i = 0; i < pool.worker_count; i++) {
+        deque_destroy(&pool.workers[i].deque);
+        pthread_mutex_destroy(&pool.workers[i].inbox.lock);
+    }
+    free(pool.workers);
+    pool.workers = NULL;
+    pool.worker_count = 0;
+    atomic_store(&pool.running, false);
+    pthread_mutex_unlock(&pool.lock);
+}
+
+// Public API
+
+// Starts with one dependency held by the caller while it adds antecedents;
+// the task is scheduled once that and every antecedent are resolved
+static _Atomic int tasks_until_failure = -1;
+
+void dcore_async_fail_task_after(int count) {
+    atomic_store(&tasks_until_failure, count);
+}
+
+static dowel_task_t* create_task(dowel_callback_t callback, void* user_data) {
+    if (!ensure_pool()) return NULL;
+    if (atomic_load_explicit(&tasks_until_failure, memory_order_relaxed) >= 0 &&
+        atomic_fetch_sub(&tasks_until_failure, 1) == 0) {
+        return NULL;
+    }
+
+    dowel_task_t* task = dcore_pool_alloc(sizeof(*task));
+    if (!task) return NULL;
+
+    task->callback = callback;
+    task->user_data = user_data;
+    task->next = NULL;
+    atomic_init(&task->successors, NULL);
+    atomic_init(&task->dependencies, 1);
+    atomic_init(&task->state, TASK_PENDING);
+    atomic_init(&task->refs, 2);
+    atomic_init(&task->cancel_requested, false);
+    return task;
+}
+
+// Makes successor wait for antecedent; false if antecedent already finished
+static bool add_edge(dowel_task_t* antecedent, dowel_task_t* successor, task_edge_t* edge, bool always) {
+    edge->successor = successor;
+    edge->always = always;
+    task_edge_t* head = atomic_load_explicit(&antecedent->successors, memory_order_acquire);
+    do {
+        if (head == EDGES_SEALED) return false;
+        edge->next = head;
+    } while (!atomic_compare_exchange_weak_explicit(&antecedent->successors, &head, edge,
+                                                    memory_order_acq_rel, memory_order_acquire));
+    return true;
+}
+
+static void no_op(void* user_data) {
+    (void)user_data;
+}
+
+static dowel_task_t* submit(dowel_callback_t callback, void* user_data, int worker) {
+    if (!callback) return NULL;
+    dowel_task_t* task = create_task(callback, user_data);
+    if (!task) return NULL;
+
+    atomic_store_explicit(&task->dependencies, 0, memory_order_relaxed);
+    schedule(task, worker);
+    return task;
+}
+
+dowel_task_t* dowel_async_spawn(dowel_callback_t callback, void* user_data) {
+    return submit(callback, user_data, DOWEL_ASYNC_ANY_WORKER);
+}
+
+dowel_task_t* dowel_async_spawn_on(int worker, dowel_callback_t callback, void* user_data) {
+    return submit(callback, user_data, worker);
+}
+
+static dowel_task_t* attach(dowel_task_t* const* tasks, size_t count,
+                            dowel_callback_t callback, void* user_data, bool always) {
+    dowel_task_t* task = create_task(callback ? callback : no_op, user_data);
+    if (!task) return NULL;
+
+    bool cancelled = false;
+    for (size_t i = 0; i < count; i++) {
+        dowel_task_t* antecedent = tasks[i];
+        if (!antecedent) continue;
+
+        task_edge_t* edge = dcore_pool_alloc(sizeof(*edge));
+        if (!edge) {
+            // Cannot track this antecedent; wait for it here instead
+            dowel_async_wait(antecedent);
+        } else {
+            atomic_fetch_add_explicit(&task->dependencies, 1, memory_order_relaxed);
+            if (add_edge(antecedent, task, edge, always)) continue;
+            atomic_fetch_sub_explicit(&task->dependencies, 1, memory_order_relaxed);
+            dcore_pool_free(edge);
+        }
+        // Already finished: only its outcome matters
+        if (!always && atomic_load_explicit(&antecedent->state, memory_order_acquire) == TASK_CANCELLED) {
+            cancelled = true;
+        }
+    }
+
+    if (cancelled) cancel_pending(task);
+    resolve_dependency(task);
+    return task;
+}
+
+dowel_task_t* dowel_async_when_all(dowel_task_t* const* tasks, size_t count,
+                                   dowel_callback_t callback, void* user_data) {
+    if (count > 0 && !tasks) return NULL;
+    return attach(tasks, count, callback, user_data, false);
+}
+
+dowel_task_t* dowel_async_then(dowel_task_t* antecedent, dowel_callback_t callback, void* user_data) {
+    if (!antecedent || !callback) return NULL;
+    return attach(&antecedent, 1, callback, user_data, false);
+}
+
+dowel_task_t* dowel_async_finally(dowel_task_t* antecedent, dowel_callback_t callback, void* user_data) {
+    if (!antecedent || !callback) return NULL;
+    return attach(&antecedent, 1, callback, user_data, true);
+}
+
+bool dowel_async_is_complete(const dowel_task_t* task) {
+    if (!task) return true;
+    int state = atomic_load_explicit(&((dowel_task_t*)task)->state, memory_order_acquire);
+    return state == TASK_COMPLETE || state == TASK_CANCELLED;
+}
+
+void dowel_async_wait(dowel_task_t* task) {
+    if (!task) return;
+
+    // On a worker, run other tasks until this one is done instead of blocking
+    // the worker the task may be queued behind
+    worker_t* self = current_worker;
+    if (self) {
+        while (!dowel_async_is_complete(task)) {
+            dowel_task_t* other = find_task(self);
+            if (other) {
+                run_task(other);
+            } else {
+                sched_yield();
+            }
+        }
+        return;
+    }
+
+    for (int spin = 0; spin < 64 && !dowel_async_is_complete(task); spin++) sched_yield();
+    if (dowel_async_is_complete(task)) return;
+
+    pthread_mutex_lock(&pool.lock);
+    atomic_fetch_add_explicit(&pool.blocked_waiters, 1, memory_order_seq_cst);
+    while (!dowel_async_is_complete(task)) pthread_cond_wait(&pool.task_done, &pool.lock);
+    atomic_fetch_sub_explicit(&pool.blocked_waiters, 1, memory_order_relaxed);
+    pthread_mutex_unlock(&pool.lock);
+}
+
+void dowel_async_cancel(dowel_task_t* task) {
+    if (!task) return;
+    // A pending task is dropped; a running one sees the request through
+    // dowel_async_cancel_requested and may stop early
+    cancel_pending(task);
+}
+
+bool dowel_async_cancel_requested(void) {
+    dowel_task_t* task = current_task;
+    return task && atomic_load_explicit(&task->cancel_requested, memory_order_relaxed);
+}
+
+int dowel_async_worker_count(void) {
+    return ensure_pool() ? pool.worker_count : 0;
+}
+
+int dowel_async_current_worker(void) {
+    return current_worker ? current_worker->index : DOWEL_ASYNC_ANY_WORKER;
+}
+
+void dowel_async_free_task(dowel_task_t* task) {
+    if (!task) return;
+    dowel_async_wait(task);
+    release_task(task);
+}
+
+void dowel_async_detach(dowel_task_t* task) {
+    if (!task) return;
+    // The scheduler's reference keeps it alive until it has run
+    release_task(task);
+}
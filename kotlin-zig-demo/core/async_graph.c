@@ -0,0 +1,337 @@
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+
+#include "core_internal.h"
+
+// Task graphs - nodes and dependency edges submitted as one unit on top of
+// dowel_async_spawn/dowel_async_when_all. Launching sorts the nodes
+// topologically (rejecting cycles), spawns the roots and attaches every other
+// node as a when_all continuation of its dependencies, so each node starts
+// as soon as its last input finishes. Nodes record start and end times; the
+// critical path is the chain of dependent nodes with the largest summed run
+// time, which bounds the graph's wall time however many workers there are.
+
+typedef struct {
+    char* name;
+    dowel_callback_t callback;
+    void* user_data;
+    int* dependencies;
+    size_t dependency_count;
+    size_t dependency_capacity;
+    int64_t start_ns;
+    int64_t end_ns;
+} graph_node_t;
+
+struct dowel_task_graph {
+    graph_node_t* nodes;
+    size_t node_count;
+    size_t node_capacity;
+
+    // State of the current or last launch
+    dowel_task_t** tasks;
+    dowel_task_t* join;
+    int64_t launch_ns;
+    int64_t finish_ns;
+    size_t skipped_nodes; // no task: creation failed or a dependency was skipped
+};
+
+dowel_task_graph_t* dowel_graph_create(void) {
+    return calloc(1, sizeof(dowel_task_graph_t));
+}
+
+// Waits for the last launch and releases its task handles
+static void settle(dowel_task_graph_t* graph) {
+    dowel_async_free_task(graph->join);
+    graph->join = NULL;
+    for (size_t i = 0; i < graph->node_count; i++) {
+        dowel_async_free_task(graph->tasks[i]);
+        graph->tasks[i] = NULL;
+    }
+}
+
+// Nodes and edges can only change while no launch is in flight
+static bool editable(dowel_task_graph_t* graph) {
+    if (graph->join && !dowel_async_is_complete(graph->join)) return false;
+    settle(graph);
+    return true;
+}
+
+void dowel_graph_destroy(dowel_task_graph_t* graph) {
+    if (!graph) return;
+    settle(graph);
+    for (size_t i = 0; i < graph->node_count; i++) {
+        free(graph->nodes[i].name);
+        free(graph->nodes[i].dependencies);
+    }
+    free(graph->nodes);
+    free(graph->tasks);
+    free(graph);
+}
+
+int dowel_graph_add_node(dowel_task_graph_t* graph, const char* name, dowel_callback_t callback, void* user_data) {
+    if (!graph || !callback) return DOWEL_ERROR_INVALID_PARAMETER;
+    if (!editable(graph)) return DOWEL_ERROR_SYSTEM_ERROR;
+
+    if (graph->node_count == graph->node_capacity) {
+        size_t capacity = graph->node_capacity ? graph->node_capacity * 2 : 16;
+        graph_node_t* nodes = realloc(graph->nodes, capacity * sizeof(*nodes));
+        if (!nodes) return DOWEL_ERROR_OUT_OF_MEMORY;
+        graph->nodes = nodes;
+        dowel_task_t** tasks = realloc(graph->tasks, capacity * sizeof(*tasks));
+        if (!tasks) return DOWEL_ERROR_OUT_OF_MEMORY;
+        graph->tasks = tasks;
+        graph->node_capacity = capacity;
+    }
+
+    graph_node_t* node = &graph->nodes[graph->node_count];
+    memset(node, 0, sizeof(*node));
+    node->name = strdup(name ? name : "");
+    if (!node->name) return DOWEL_ERROR_OUT_OF_MEMORY;
+    node->callback = callback;
+    node->user_data = user_data;
+    graph->tasks[graph->node_count] = NULL;
+    return (int)graph->node_count++;
+}
+
+int dowel_graph_add_dependency(dowel_task_graph_t* graph, int node, int depends_on) {
+    if (!graph || node < 0 || depends_on < 0 || (size_t)node >= graph->node_count ||
+        (size_t)depends_on >= graph->node_count || node == depends_on) {
+        return DOWEL_ERROR_INVALID_PARAMETER;
+    }
+    if (!editable(graph)) return DOWEL_ERROR_SYSTEM_ERROR;
+
+    graph_node_t* target = &graph->nodes[node];
+    for (size_t i = 0; i < target->dependency_count; i++) {
+        if (target->dependencies[i] == depends_on) return DOWEL_SUCCESS;
+    }
+    if (target->dependency_count == target->dependency_capacity) {
+        size_t capacity = target->dependency_capacity ? target->dependency_capacity * 2 : 4;
+        int* grown = realloc(target->dependencies, capacity * sizeof(*grown));
+        if (!grown) return DOWEL_ERROR_OUT_OF_MEMORY;
+        target->dependencies = grown;
+        target->dependency_capacity = capacity;
+    }
+    target->dependencies[target->dependency_count++] = depends_on;
+    return DOWEL_SUCCESS;
+}
+
+// Kahn's algorithm; returns false if the graph has a cycle
+static bool topological_order(const dowel_task_graph_t* graph, int* order) {
+    size_t count = graph->node_count;
+    size_t* remaining = malloc((count ? count : 1) * sizeof(*remaining));
+    size_t* dependents_start = calloc(count + 1, sizeof(*dependents_start));
+    int* dependents = NULL;
+    size_t edge_count = 0;
+    for (size_t i = 0; i < count; i++) edge_count += graph->nodes[i].dependency_count;
+    if (edge_count) dependents = malloc(edge_count * sizeof(*dependents));
+    if (!remaining || !dependents_start || (edge_count && !dependents)) {
+        free(remaining);
+        free(dependents_start);
+        free(dependents);
+        return false;
+    }
+
+    // Reverse edges in CSR form: dependents[dependents_start[n]..] depend on n
+    for (size_t i = 0; i < count; i++) {
+        remaining[i] = graph->nodes[i].dependency_count;
+        for (size_t d = 0; d < remaining[i]; d++) dependents_start[graph->nodes[i].dependencies[d] + 1]++;
+    }
+    for (size_t i = 0; i < count; i++) dependents_start[i + 1] += dependents_start[i];
+    size_t* fill = malloc((count ? count : 1) * sizeof(*fill));
+    if (!fill) {
+        free(remaining);
+        free(dependents_start);
+        free(dependents);
+        return false;
+    }
+    memcpy(fill, dependents_start, count * sizeof(*fill));
+    for (size_t i = 0; i < count; i++) {
+        for (size_t d = 0; d < graph->nodes[i].dependency_count; d++) {
+            dependents[fill[graph->nodes[i].dependencies[d]]++] = (int)i;
+        }
+    }
+
+    size_t head = 0, tail = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (remaining[i] == 0) order[tail++] = (int)i;
+    }
+    while (head < tail) {
+        int n = order[head++];
+        for (size_t e = dependents_start[n]; e < dependents_start[n + 1]; e++) {
+            if (--remaining[dependents[e]] == 0) order[tail++] = dependents[e];
+        }
+    }
+
+    free(fill);
+    free(remaining);
+    free(dependents_start);
+    free(dependents);
+    return tail == count;
+}
+
+static void run_node(void* user_data) {
+    graph_node_t* node = user_data;
+    node->start_ns = dcore_now_ns();
+    node->callback(node->user_data);
+    node->end_ns = dcore_now_ns();
+}
+
+static void finish_graph(void* user_data) {
+    dowel_task_graph_t* graph = user_data;
+    // A graph with skipped nodes did not run to completion
+    if (graph->skipped_nodes == 0) graph->finish_ns = dcore_now_ns();
+}
+
+static dowel_task_t* launch(dowel_task_graph_t* graph, int* status) {
+    settle(graph);
+    *status = DOWEL_ERROR_OUT_OF_MEMORY;
+
+    size_t count = graph->node_count;
+    int* order = malloc((count ? count : 1) * sizeof(*order));
+    if (!order) return NULL;
+    if (!topological_order(graph, order)) {
+        free(order);
+        *status = DOWEL_ERROR_INVALID_PARAMETER;
+        dcore_report_error(DOWEL_ERROR_INVALID_PARAMETER, "Task graph has a dependency cycle");
+        return NULL;
+    }
+
+    size_t max_dependencies = 0;
+    for (size_t i = 0; i < count; i++) {
+        graph->nodes[i].start_ns = graph->nodes[i].end_ns = 0;
+        if (graph->nodes[i].dependency_count > max_dependencies) max_dependencies = graph->nodes[i].dependency_count;
+    }
+    dowel_task_t** inputs = malloc((max_dependencies ? max_dependencies : 1) * sizeof(*inputs));
+    if (!inputs) {
+        free(order);
+        return NULL;
+    }
+
+    graph->launch_ns = dcore_now_ns();
+    graph->finish_ns = 0;
+    graph->skipped_nodes = 0;
+    for (size_t i = 0; i < count; i++) {
+        graph_node_t* node = &graph->nodes[order[i]];
+        // when_all ignores NULL inputs, so a node whose dependency has no task
+        // must not get one either or it would run without that ordering
+        bool runnable = true;
+        for (size_t d = 0; d < node->dependency_count; d++) {
+            inputs[d] = graph->tasks[node->dependencies[d]];
+            runnable = runnable && inputs[d];
+        }
+        graph->tasks[order[i]] = runnable ? dowel_async_when_all(inputs, node->dependency_count, run_node, node) : NULL;
+        if (!graph->tasks[order[i]]) graph->skipped_nodes++;
+    }
+    if (graph->skipped_nodes) dcore_report_error(DOWEL_ERROR_OUT_OF_MEMORY, "Task graph nodes skipped: tasks could not be created");
+    graph->join = dowel_async_when_all(graph->tasks, count, finish_graph, graph);
+
+    free(inputs);
+    free(order);
+    if (!graph->join) {
+        settle(graph);
+        return NULL;
+    }
+    *status = DOWEL_SUCCESS;
+    return graph->join;
+}
+
+dowel_task_t* dowel_graph_launch(dowel_task_graph_t* graph) {
+    int status;
+    return graph ? launch(graph, &status) : NULL;
+}
+
+int dowel_graph_run(dowel_task_graph_t* graph) {
+    if (!graph) return DOWEL_ERROR_INVALID_PARAMETER;
+    int status;
+    dowel_task_t* join = launch(graph, &status);
+    if (!join) return status;
+
+    dowel_async_wait(join);
+    bool finished = graph->finish_ns != 0;
+    settle(graph);
+    if (finished) return DOWEL_SUCCESS;
+    return graph->skipped_nodes ? DOWEL_ERROR_OUT_OF_MEMORY : DOWEL_ERROR_SYSTEM_ERROR;
+}
+
+// Longest chain by summed node run time; fills prev with each node's
+// predecessor on its longest chain and returns the chain's last node
+static int longest_chain(const dowel_task_graph_t* graph, int* order, int64_t* finish, int* prev) {
+    int last = -1;
+    if (!topological_order(graph, order)) return -1;
+    for (size_t i = 0; i < graph->node_count; i++) {
+        int n = order[i];
+        const graph_node_t* node = &graph->nodes[n];
+        int64_t best = 0;
+        prev[n] = -1;
+        for (size_t d = 0; d < node->dependency_count; d++) {
+            int dep = node->dependencies[d];
+            if (finish[dep] > best) {
+                best = finish[dep];
+                prev[n] = dep;
+            }
+        }
+        int64_t duration = node->end_ns > node->start_ns ? node->end_ns - node->start_ns : 0;
+        finish[n] = best + duration;
+        if (last < 0 || finish[n] > finish[last]) last = n;
+    }
+    return last;
+}
+
+static size_t critical_path(const dowel_task_graph_t* graph, int* nodes, size_t max, int64_t* length_ns) {
+    size_t count = graph->node_count;
+    int* order = malloc((count ? count : 1) * sizeof(*order));
+    int64_t* finish = malloc((count ? count : 1) * sizeof(*finish));
+    int* prev = malloc((count ? count : 1) * sizeof(*prev));
+    size_t length = 0;
+    *length_ns = 0;
+
+    int last = (order && finish && prev && count) ? longest_chain(graph, order, finish, prev) : -1;
+    if (last >= 0) {
+        *length_ns = finish[last];
+        for (int n = last; n >= 0; n = prev[n]) length++;
+        // Walked backwards from the last node; store first node first
+        size_t i = length;
+        for (int n = last; n >= 0; n = prev[n]) {
+            i--;
+            if (nodes && i < max) nodes[i] = n;
+        }
+    }
+
+    free(order);
+    free(finish);
+    free(prev);
+    return length;
+}
+
+int dowel_graph_get_stats(const dowel_task_graph_t* graph, dowel_graph_stats_t* stats) {
+    if (!graph || !stats) return DOWEL_ERROR_INVALID_PARAMETER;
+    memset(stats, 0, sizeof(*stats));
+    if (graph->finish_ns == 0) return DOWEL_ERROR_NOT_INITIALIZED; // not run to completion
+
+    stats->wall_ns = graph->finish_ns - graph->launch_ns;
+    for (size_t i = 0; i < graph->node_count; i++) {
+        const graph_node_t* node = &graph->nodes[i];
+        if (node->end_ns > node->start_ns) stats->work_ns += node->end_ns - node->start_ns;
+    }
+    stats->critical_path_nodes = critical_path(graph, NULL, 0, &stats->critical_path_ns);
+    return DOWEL_SUCCESS;
+}
+
+size_t dowel_graph_critical_path(const dowel_task_graph_t* graph, int* nodes, size_t max) {
+    if (!graph || graph->finish_ns == 0) return 0;
+    int64_t length_ns;
+    return critical_path(graph, nodes, max, &length_ns);
+}
+
+const char* dowel_graph_node_name(const dowel_task_graph_t* graph, int node) {
+    if (!graph || node < 0 || (size_t)node >= graph->node_count) return NULL;
+    return graph->nodes[node].name;
+}
+
+int64_t dowel_graph_node_duration_ns(const dowel_task_graph_t* graph, int node) {
+    if (!graph || node < 0 || (size_t)node >= graph->node_count) return -1;
+    const graph_node_t* n = &graph->nodes[node];
+    return n->end_ns > n->start_ns ? n->end_ns - n->start_ns : 0;
+}
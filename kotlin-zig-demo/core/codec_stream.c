@@ -0,0 +1,645 @@
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <string.h>
+#include <zlib.h>
+#ifdef DOWEL_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#include "core_internal.h"
+
+// Streaming codec contexts - dowel_codec_ctx_t
+//
+//  - A context compresses or decompresses one message at a time as it is
+//    fed, handing output to the caller's sink whenever its output buffer
+//    fills and on flush and finish. Memory stays fixed whatever the message
+//    size: the codec's own state, a 64 KB output buffer and, for LZ4, a
+//    block buffer and 64 KB of history.
+//  - Finishing a message keeps everything for the next one: zlib streams
+//    are reset rather than reallocated, zstd contexts start a new frame and
+//    the LZ4 match tables just move past the old data.
+//  - Output is each codec's standard streaming format, so the usual tools
+//    read it: gzip members (consecutive messages read back as one file),
+//    zstd frames, and LZ4 frames of linked 64 KB blocks with a content
+//    checksum.
+//  - Errors stick until the message is finished or reset, so a run of feeds
+//    needs one check at the end.
+
+#define OUT_SIZE (64 * 1024)
+#define FEED_SLICE (1u << 30) // zlib counts input in unsigned int
+#define GZIP_WINDOW_BITS (15 + 16)
+#define GZIP_AUTO_WINDOW_BITS (15 + 32)
+#define ZSTD_WINDOW_LOG_MAX 23 // 8 MB, what level 19 uses
+
+// LZ4 frame format (lz4.org/lz4_Frame_format)
+#define LZ4F_MAGIC 0x184D2204u
+#define LZ4F_SKIPPABLE 0x184D2A50u // low four bits free
+#define LZ4F_VERSION 0x40
+#define LZ4F_BLOCK_INDEPENDENT 0x20
+#define LZ4F_BLOCK_CHECKSUM 0x10
+#define LZ4F_CONTENT_SIZE 0x08
+#define LZ4F_CONTENT_CHECKSUM 0x04
+#define LZ4F_DICT_ID 0x01
+#define LZ4F_BLOCK_64KB 0x40
+#define LZ4F_UNCOMPRESSED 0x80000000u
+#define LZ4_HISTORY (64 * 1024)
+
+typedef enum {
+    LZ4_MAGIC,
+    LZ4_DESCRIPTOR,  // flags and block size
+    LZ4_HEADER_REST, // optional fields and the header checksum
+    LZ4_BLOCK_SIZE,
+    LZ4_BLOCK,
+    LZ4_CHECKSUM,
+    LZ4_SKIP_SIZE,
+    LZ4_SKIP,
+} lz4_stage_t;
+
+struct dowel_codec_ctx {
+    dowel_codec_t codec;
+    bool compressing;
+    dowel_codec_sink_t sink;
+    void* user_data;
+    int error;
+    bool open; // mid-message: a header has been written or read
+
+    uint8_t* out;
+    size_t out_used;
+    size_t out_capacity;
+
+    z_stream zs;
+    bool zs_ready;
+#ifdef DOWEL_HAVE_ZSTD
+    ZSTD_CCtx* cctx;
+    ZSTD_DCtx* dctx;
+#endif
+
+    // LZ4
+    dcore_lz4_stream_t* lz4;
+    dcore_xxh32_t checksum;
+    uint8_t* block; // compressing: input gathered into a block; decompressing: the unit being read
+    size_t block_used;
+    size_t block_capacity;
+    lz4_stage_t stage;
+    size_t need; // size of the unit being read
+    uint8_t descriptor[15];
+    size_t block_max;
+    size_t block_size;
+    bool block_raw;
+    uint8_t* window; // decompressing: up to 64 KB of history, then the block being decoded
+    size_t history;
+    uint64_t skip;
+};
+
+static inline uint32_t load32(const uint8_t* p) {
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static inline void store32(uint8_t* p, uint32_t v) {
+    for (int i = 0; i < 4; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static int fail(dowel_codec_ctx_t* ctx, int status, const char* message) {
+    if (ctx->error == DOWEL_SUCCESS) {
+        ctx->error = status;
+        dcore_report_error(status, message);
+    }
+    return ctx->error;
+}
+
+static int drain(dowel_codec_ctx_t* ctx) {
+    if (ctx->out_used == 0 || ctx->error != DOWEL_SUCCESS) return ctx->error;
+    int status = ctx->sink(ctx->out, ctx->out_used, ctx->user_data);
+    ctx->out_used = 0;
+    if (status != DOWEL_SUCCESS) return fail(ctx, status, "Codec output sink failed");
+    return DOWEL_SUCCESS;
+}
+
+static int emit(dowel_codec_ctx_t* ctx, const uint8_t* data, size_t size) {
+    while (size > 0) {
+        size_t take = ctx->out_capacity - ctx->out_used;
+        if (take > size) take = size;
+        memcpy(ctx->out + ctx->out_used, data, take);
+        ctx->out_used += take;
+        data += take;
+        size -= take;
+        if (ctx->out_used == ctx->out_capacity && drain(ctx) != DOWEL_SUCCESS) return ctx->error;
+    }
+    return DOWEL_SUCCESS;
+}
+
+// gzip
+
+static int deflate_step(dowel_codec_ctx_t* ctx, const uint8_t* data, size_t size, int mode) {
+    ctx->zs.next_in = (Bytef*)data;
+    ctx->zs.avail_in = (uInt)size;
+    for (;;) {
+        ctx->zs.next_out = ctx->out + ctx->out_used;
+        ctx->zs.avail_out = (uInt)(ctx->out_capacity - ctx->out_used);
+        int result = deflate(&ctx->zs, mode);
+        ctx->out_used = ctx->out_capacity - ctx->zs.avail_out;
+        if (result == Z_STREAM_ERROR) return fail(ctx, DOWEL_ERROR_UNKNOWN, "Compression failed");
+        if (ctx->zs.avail_out == 0) {
+            if (drain(ctx) != DOWEL_SUCCESS) return ctx->error;
+            continue;
+        }
+        // Room left over means deflate has done all this call asks
+        if (mode != Z_FINISH || result == Z_STREAM_END) return DOWEL_SUCCESS;
+    }
+}
+
+static int inflate_step(dowel_codec_ctx_t* ctx, const uint8_t* data, size_t size) {
+    ctx->zs.next_in = (Bytef*)data;
+    ctx->zs.avail_in = (uInt)size;
+    for (;;) {
+        ctx->zs.next_out = ctx->out + ctx->out_used;
+        ctx->zs.avail_out = (uInt)(ctx->out_capacity - ctx->out_used);
+        int result = inflate(&ctx->zs, Z_NO_FLUSH);
+        ctx->out_used = ctx->out_capacity - ctx->zs.avail_out;
+        if (result == Z_STREAM_END) {
+            // Another member may follow, as in a gzip file
+            ctx->open = false;
+            inflateReset(&ctx->zs);
+        } else if (result == Z_OK) {
+            ctx->open = true;
+        } else if (result != Z_BUF_ERROR) {
+            return fail(ctx, DOWEL_ERROR_INVALID_PARAMETER, "Compressed stream is corrupt");
+        }
+        bool full = ctx->zs.avail_out == 0;
+        if (full && drain(ctx) != DOWEL_SUCCESS) return ctx->error;
+        if (!full && (ctx->zs.avail_in == 0 || result == Z_BUF_ERROR)) return DOWEL_SUCCESS;
+    }
+}
+
+// zstd
+
+#ifdef DOWEL_HAVE_ZSTD
+
+static int zstd_compress_step(dowel_codec_ctx_t* ctx, const uint8_t* data, size_t size, ZSTD_EndDirective mode) {
+    ZSTD_inBuffer in = { data, size, 0 };
+    for (;;) {
+        ZSTD_outBuffer out = { ctx->out, ctx->out_capacity, ctx->out_used };
+        size_t left = ZSTD_compressStream2(ctx->cctx, &out, &in, mode);
+        ctx->out_used = out.pos;
+        if (ZSTD_isError(left)) return fail(ctx, DOWEL_ERROR_UNKNOWN, "Compression failed");
+        if (ctx->out_used == ctx->out_capacity && drain(ctx) != DOWEL_SUCCESS) return ctx->error;
+        // Asking again once a frame has ended would start another
+        if (mode == ZSTD_e_continue ? in.pos == in.size : left == 0) return DOWEL_SUCCESS;
+    }
+}
+
+static int zstd_decompress_step(dowel_codec_ctx_t* ctx, const uint8_t* data, size_t size) {
+    ZSTD_inBuffer in = { data, size, 0 };
+    for (;;) {
+        ZSTD_outBuffer out = { ctx->out, ctx->out_capacity, ctx->out_used };
+        size_t hint = ZSTD_decompressStream(ctx->dctx, &out, &in);
+        ctx->out_used = out.pos;
+        if (ZSTD_isError(hint)) return fail(ctx, DOWEL_ERROR_INVALID_PARAMETER, "Compressed stream is corrupt");
+        ctx->open = hint != 0;
+        bool full = ctx->out_used == ctx->out_capacity;
+        if (full && drain(ctx) != DOWEL_SUCCESS) return ctx->error;
+        // A frame that has ended holds nothing back
+        if (in.pos == in.size && (!full || hint == 0)) return DOWEL_SUCCESS;
+    }
+}
+
+#endif
+
+// LZ4 frames, compressing
+
+static int lz4_write_header(dowel_codec_ctx_t* ctx) {
+    uint8_t header[7];
+    store32(header, LZ4F_MAGIC);
+    header[4] = LZ4F_VERSION | LZ4F_CONTENT_CHECKSUM;
+    header[5] = LZ4F_BLOCK_64KB;
+    header[6] = (uint8_t)(dcore_xxh32(header + 4, 2, 0) >> 8);
+    dcore_xxh32_init(&ctx->checksum, 0);
+    ctx->open = true;
+    return emit(ctx, header, sizeof(header));
+}
+
+static int lz4_write_block(dowel_codec_ctx_t* ctx, const uint8_t* data, size_t size) {
+    if (ctx->out_capacity - ctx->out_used < 4 + dcore_lz4_bound(size) && drain(ctx) != DOWEL_SUCCESS) return ctx->error;
+    dcore_xxh32_update(&ctx->checksum, data, size);
+
+    // A block that does not shrink is stored as it is
+    uint8_t* at = ctx->out + ctx->out_used;
+    size_t written = dcore_lz4_stream_compress(ctx->lz4, data, size, at + 4);
+    if (written == 0 || written >= size) {
+        store32(at, (uint32_t)size | LZ4F_UNCOMPRESSED);
+        memcpy(at + 4, data, size);
+        written = size;
+    } else {
+        store32(at, (uint32_t)written);
+    }
+    ctx->out_used += 4 + written;
+    return DOWEL_SUCCESS;
+}
+
+static int lz4_compress_feed(dowel_codec_ctx_t* ctx, const uint8_t* data, size_t size) {
+    if (!ctx->open && lz4_write_header(ctx) != DOWEL_SUCCESS) return ctx->error;
+    while (size > 0) {
+        // Whole blocks go straight from the caller's data
+        if (ctx->block_used == 0 && size >= DCORE_LZ4_BLOCK_MAX) {
+            if (lz4_write_block(ctx, data, DCORE_LZ4_BLOCK_MAX) != DOWEL_SUCCESS) return ctx->error;
+            data += DCORE_LZ4_BLOCK_MAX;
+            size -= DCORE_LZ4_BLOCK_MAX;
+            continue;
+        }
+        size_t take = DCORE_LZ4_BLOCK_MAX - ctx->block_used;
+        if (take > size) take = size;
+        memcpy(ctx->block + ctx->block_used, data, take);
+        ctx->block_used += take;
+        data += take;
+        size -= take;
+        if (ctx->block_used == DCORE_LZ4_BLOCK_MAX) {
+            ctx->block_used = 0;
+            if (lz4_write_block(ctx, ctx->block, DCORE_LZ4_BLOCK_MAX) != DOWEL_SUCCESS) return ctx->error;
+        }
+    }
+    return DOWEL_SUCCESS;
+}
+
+static int lz4_compress_flush(dowel_codec_ctx_t* ctx) {
+    if (ctx->block_used == 0) return DOWEL_SUCCESS;
+    size_t size = ctx->block_used;
+    ctx->block_used = 0;
+    return lz4_write_block(ctx, ctx->block, size);
+}
+
+static int lz4_compress_finish(dowel_codec_ctx_t* ctx) {
+    if (!ctx->open && lz4_write_header(ctx) != DOWEL_SUCCESS) return ctx->error;
+    if (lz4_compress_flush(ctx) != DOWEL_SUCCESS) return ctx->error;
+    uint8_t end[8];
+    store32(end, 0);
+    store32(end + 4, dcore_xxh32_digest(&ctx->checksum));
+    return emit(ctx, end, sizeof(end));
+}
+
+// LZ4 frames, decompressing
+
+// Makes room for blocks of the frame's declared size
+static bool lz4_reserve(dowel_codec_ctx_t* ctx, size_t block_max) {
+    if (block_max + 4 <= ctx->block_capacity) return true;
+    uint8_t* block = malloc(block_max + 4);
+    uint8_t* window = malloc(LZ4_HISTORY + block_max);
+    if (!block || !window) {
+        free(block);
+        free(window);
+        return false;
+    }
+    free(ctx->block);
+    free(ctx->window);
+    ctx->block = block;
+    ctx->window = window;
+    ctx->block_capacity = block_max + 4;
+    ctx->history = 0;
+    return true;
+}
+
+static int lz4_decode_block(dowel_codec_ctx_t* ctx, const uint8_t* unit) {
+    uint8_t flags = ctx->descriptor[0];
+    if ((flags & LZ4F_BLOCK_CHECKSUM) && dcore_xxh32(unit, ctx->block_size, 0) != load32(unit + ctx->block_size)) {
+        return fail(ctx, DOWEL_ERROR_INVALID_PARAMETER, "LZ4 block checksum mismatch");
+    }
+    if (flags & LZ4F_BLOCK_INDEPENDENT) ctx->history = 0;
+    if (ctx->history > LZ4_HISTORY) {
+        memmove(ctx->window, ctx->window + ctx->history - LZ4_HISTORY, LZ4_HISTORY);
+        ctx->history = LZ4_HISTORY;
+    }
+
+    uint8_t* dst = ctx->window + ctx->history;
+    int64_t produced = (int64_t)ctx->block_size;
+    if (ctx->block_raw) {
+        memcpy(dst, unit, ctx->block_size);
+    } else {
+        produced = dcore_lz4_decompress(ctx->window, ctx->history, unit, ctx->block_size, dst, ctx->block_max, false);
+        if (produced < 0) return fail(ctx, DOWEL_ERROR_INVALID_PARAMETER, "Compressed stream is corrupt");
+    }
+    if (flags & LZ4F_CONTENT_CHECKSUM) dcore_xxh32_update(&ctx->checksum, dst, (size_t)produced);
+    ctx->history += (size_t)produced;
+    return emit(ctx, dst, (size_t)produced);
+}
+
+// Handles one complete unit of ctx->need bytes and says what comes next
+static int lz4_unit(dowel_codec_ctx_t* ctx, const uint8_t* unit) {
+    switch (ctx->stage) {
+        case LZ4_MAGIC: {
+            uint32_t magic = load32(unit);
+            ctx->open = true;
+            if (magic == LZ4F_MAGIC) {
+                ctx->stage = LZ4_DESCRIPTOR;
+                ctx->need = 2;
+            } else if ((magic & ~0xfu) == LZ4F_SKIPPABLE) {
+                ctx->stage = LZ4_SKIP_SIZE;
+                ctx->need = 4;
+            } else {
+                return fail(ctx, DOWEL_ERROR_INVALID_PARAMETER, "Not an LZ4 frame");
+            }
+            return DOWEL_SUCCESS;
+        }
+        case LZ4_DESCRIPTOR: {
+            uint8_t flags = unit[0];
+            uint8_t bd = unit[1];
+            int size_id = (bd >> 4) & 7;
+            if ((flags & 0xc2) != LZ4F_VERSION || (bd & 0x8f) != 0 || size_id < 4) {
+                return fail(ctx, DOWEL_ERROR_INVALID_PARAMETER, "Unsupported LZ4 frame header");
+            }
+            if (flags & LZ4F_DICT_ID) {
+                return fail(ctx, DOWEL_ERROR_INVALID_PARAMETER, "LZ4 frame needs a dictionary");
+            }
+            ctx->block_max = (size_t)1 << (8 + 2 * size_id);
+            if (!lz4_reserve(ctx, ctx->block_max)) {
+                return fail(ctx, DOWEL_ERROR_OUT_OF_MEMORY, "Failed to allocate LZ4 frame buffers");
+            }
+            ctx->descriptor[0] = flags;
+            ctx->descriptor[1] = bd;
+            ctx->stage = LZ4_HEADER_REST;
+            ctx->need = 1 + ((flags & LZ4F_CONTENT_SIZE) ? 8 : 0);
+            return DOWEL_SUCCESS;
+        }
+        case LZ4_HEADER_REST: {
+            memcpy(ctx->descriptor + 2, unit, ctx->need - 1);
+            uint8_t check = (uint8_t)(dcore_xxh32(ctx->descriptor, 2 + ctx->need - 1, 0) >> 8);
+            if (check != unit[ctx->need - 1]) return fail(ctx, DOWEL_ERROR_INVALID_PARAMETER, "LZ4 header checksum mismatch");
+            dcore_xxh32_init(&ctx->checksum, 0);
+            ctx->history = 0;
+            ctx->stage = LZ4_BLOCK_SIZE;
+            ctx->need = 4;
+            return DOWEL_SUCCESS;
+        }
+        case LZ4_BLOCK_SIZE: {
+            uint32_t size = load32(unit);
+            if (size == 0) {
+                bool checked = ctx->descriptor[0] & LZ4F_CONTENT_CHECKSUM;
+                ctx->stage = checked ? LZ4_CHECKSUM : LZ4_MAGIC;
+                ctx->need = 4;
+                ctx->open = checked;
+                return DOWEL_SUCCESS;
+            }
+            ctx->block_raw = size & LZ4F_UNCOMPRESSED;
+            ctx->block_size = size & ~LZ4F_UNCOMPRESSED;
+            if (ctx->block_size > ctx->block_max) return fail(ctx, DOWEL_ERROR_INVALID_PARAMETER, "LZ4 block too large");
+            ctx->stage = LZ4_BLOCK;
+            ctx->need = ctx->block_size + ((ctx->descriptor[0] & LZ4F_BLOCK_CHECKSUM) ? 4 : 0);
+            return DOWEL_SUCCESS;
+        }
+        case LZ4_BLOCK:
+            ctx->stage = LZ4_BLOCK_SIZE;
+            ctx->need = 4;
+            return lz4_decode_block(ctx, unit);
+        case LZ4_CHECKSUM:
+            if (load32(unit) != dcore_xxh32_digest(&ctx->checksum)) {
+                return fail(ctx, DOWEL_ERROR_INVALID_PARAMETER, "LZ4 content checksum mismatch");
+            }
+            ctx->stage = LZ4_MAGIC;
+            ctx->open = false;
+            return DOWEL_SUCCESS;
+        case LZ4_SKIP_SIZE:
+            ctx->skip = load32(unit);
+            ctx->stage = ctx->skip ? LZ4_SKIP : LZ4_MAGIC;
+            ctx->open = ctx->skip != 0;
+            return DOWEL_SUCCESS;
+        case LZ4_SKIP:
+            break;
+    }
+    return DOWEL_SUCCESS;
+}
+
+static int lz4_decompress_feed(dowel_codec_ctx_t* ctx, const uint8_t* data, size_t size) {
+    while (size > 0 && ctx->error == DOWEL_SUCCESS) {
+        if (ctx->stage == LZ4_SKIP) {
+            size_t take = ctx->skip < size ? (size_t)ctx->skip : size;
+            data += take;
+            size -= take;
+            ctx->skip -= take;
+            if (ctx->skip == 0) {
+                ctx->stage = LZ4_MAGIC;
+                ctx->need = 4;
+                ctx->open = false;
+            }
+            continue;
+        }
+        // Units that arrive whole are read in place
+        if (ctx->block_used == 0 && size >= ctx->need) {
+            size_t need = ctx->need;
+            lz4_unit(ctx, data);
+            data += need;
+            size -= need;
+            continue;
+        }
+        size_t take = ctx->need - ctx->block_used;
+        if (take > size) take = size;
+        memcpy(ctx->block + ctx->block_used, data, take);
+        ctx->block_used += take;
+        data += take;
+        size -= take;
+        if (ctx->block_used == ctx->need) {
+            ctx->block_used = 0;
+            lz4_unit(ctx, ctx->block);
+        }
+    }
+    return ctx->error;
+}
+
+// Public API
+
+static dowel_codec_ctx_t* create(dowel_codec_t codec, bool compressing, int level, dowel_codec_sink_t sink,
+                                 void* user_data) {
+    dowel_codec_ctx_t* ctx = calloc(1, sizeof(*ctx));
+    if (!ctx) return NULL;
+    ctx->codec = codec;
+    ctx->compressing = compressing;
+    ctx->sink = sink;
+    ctx->user_data = user_data;
+    ctx->stage = LZ4_MAGIC;
+    ctx->need = 4;
+    // Room for a whole compressed block next to what is waiting for the sink
+    ctx->out_capacity = codec == DOWEL_CODEC_LZ4 && compressing ? 4 + dcore_lz4_bound(DCORE_LZ4_BLOCK_MAX) : OUT_SIZE;
+    ctx->out = malloc(ctx->out_capacity);
+    if (!ctx->out) return ctx;
+
+    bool ready = false;
+    switch (codec) {
+        case DOWEL_CODEC_GZIP:
+            ready = compressing ? deflateInit2(&ctx->zs, level, Z_DEFLATED, GZIP_WINDOW_BITS, 8, Z_DEFAULT_STRATEGY) == Z_OK
+                                : inflateInit2(&ctx->zs, GZIP_AUTO_WINDOW_BITS) == Z_OK;
+            ctx->zs_ready = ready;
+            break;
+        case DOWEL_CODEC_LZ4:
+            if (compressing) {
+                ctx->lz4 = dcore_lz4_stream_new(level);
+                ctx->block = malloc(DCORE_LZ4_BLOCK_MAX);
+                ready = ctx->lz4 && ctx->block;
+            } else {
+                ready = lz4_reserve(ctx, DCORE_LZ4_BLOCK_MAX);
+            }
+            break;
+        case DOWEL_CODEC_ZSTD:
+#ifdef DOWEL_HAVE_ZSTD
+            if (compressing) {
+                ctx->cctx = ZSTD_createCCtx();
+                ready = ctx->cctx && !ZSTD_isError(ZSTD_CCtx_setParameter(ctx->cctx, ZSTD_c_compressionLevel, level));
+            } else {
+                ctx->dctx = ZSTD_createDCtx();
+                ready = ctx->dctx &&
+                        !ZSTD_isError(ZSTD_DCtx_setParameter(ctx->dctx, ZSTD_d_windowLogMax, ZSTD_WINDOW_LOG_MAX));
+            }
+#endif
+            break;
+    }
+    if (!ready) {
+        dowel_codec_ctx_destroy(ctx);
+        return NULL;
+    }
+    return ctx;
+}
+
+dowel_codec_ctx_t* dowel_codec_compressor_create(const dowel_compress_options_t* options, dowel_codec_sink_t sink,
+                                                 void* user_data) {
+    dowel_compress_options_t resolved;
+    if (!sink || (options && options->dict)) {
+        dcore_report_error(DOWEL_ERROR_INVALID_PARAMETER, "Codec streams need a sink and take no dictionary");
+        return NULL;
+    }
+    if (!dcore_compress_resolve(options, 0, &resolved)) return NULL;
+    dowel_codec_ctx_t* ctx = create(resolved.codec, true, resolved.level, sink, user_data);
+    if (!ctx) dcore_report_error(DOWEL_ERROR_OUT_OF_MEMORY, "Failed to create compression stream");
+    return ctx;
+}
+
+dowel_codec_ctx_t* dowel_codec_decompressor_create(dowel_codec_t codec, dowel_codec_sink_t sink, void* user_data) {
+    if (!sink || !dowel_codec_available(codec)) {
+        dcore_report_error(DOWEL_ERROR_INVALID_PARAMETER, "Unsupported codec for a decompression stream");
+        return NULL;
+    }
+    dowel_codec_ctx_t* ctx = create(codec, false, 0, sink, user_data);
+    if (!ctx) dcore_report_error(DOWEL_ERROR_OUT_OF_MEMORY, "Failed to create decompression stream");
+    return ctx;
+}
+
+void dowel_codec_ctx_destroy(dowel_codec_ctx_t* ctx) {
+    if (!ctx) return;
+    if (ctx->zs_ready) {
+        if (ctx->compressing) deflateEnd(&ctx->zs); else inflateEnd(&ctx->zs);
+    }
+#ifdef DOWEL_HAVE_ZSTD
+    ZSTD_freeCCtx(ctx->cctx);
+    ZSTD_freeDCtx(ctx->dctx);
+#endif
+    dcore_lz4_stream_free(ctx->lz4);
+    free(ctx->block);
+    free(ctx->window);
+    free(ctx->out);
+    free(ctx);
+}
+
+int dowel_codec_feed(dowel_codec_ctx_t* ctx, const uint8_t* data, size_t size) {
+    if (!ctx || (!data && size > 0)) return DOWEL_ERROR_INVALID_PARAMETER;
+    while (size > 0 && ctx->error == DOWEL_SUCCESS) {
+        size_t slice = size < FEED_SLICE ? size : FEED_SLICE;
+        switch (ctx->codec) {
+            case DOWEL_CODEC_GZIP:
+                if (ctx->compressing) {
+                    ctx->open = true;
+                    deflate_step(ctx, data, slice, Z_NO_FLUSH);
+                } else {
+                    inflate_step(ctx, data, slice);
+                }
+                break;
+            case DOWEL_CODEC_LZ4:
+                if (ctx->compressing) lz4_compress_feed(ctx, data, slice); else lz4_decompress_feed(ctx, data, slice);
+                break;
+            case DOWEL_CODEC_ZSTD:
+#ifdef DOWEL_HAVE_ZSTD
+                if (ctx->compressing) {
+                    ctx->open = true;
+                    zstd_compress_step(ctx, data, slice, ZSTD_e_continue);
+                } else {
+                    zstd_decompress_step(ctx, data, slice);
+                }
+#endif
+                break;
+        }
+        data += slice;
+        size -= slice;
+    }
+    return ctx->error;
+}
+
+int dowel_codec_flush(dowel_codec_ctx_t* ctx) {
+    if (!ctx) return DOWEL_ERROR_INVALID_PARAMETER;
+    if (ctx->compressing && ctx->open && ctx->error == DOWEL_SUCCESS) {
+        switch (ctx->codec) {
+            case DOWEL_CODEC_GZIP:
+                deflate_step(ctx, NULL, 0, Z_SYNC_FLUSH);
+                break;
+            case DOWEL_CODEC_LZ4:
+                lz4_compress_flush(ctx);
+                break;
+            case DOWEL_CODEC_ZSTD:
+#ifdef DOWEL_HAVE_ZSTD
+                zstd_compress_step(ctx, NULL, 0, ZSTD_e_flush);
+#endif
+                break;
+        }
+    }
+    return drain(ctx);
+}
+
+void dowel_codec_reset(dowel_codec_ctx_t* ctx) {
+    if (!ctx) return;
+    switch (ctx->codec) {
+        case DOWEL_CODEC_GZIP:
+            if (ctx->compressing) deflateReset(&ctx->zs); else inflateReset(&ctx->zs);
+            break;
+        case DOWEL_CODEC_LZ4:
+            if (ctx->compressing) dcore_lz4_stream_reset(ctx->lz4);
+            ctx->stage = LZ4_MAGIC;
+            ctx->need = 4;
+            ctx->block_used = 0;
+            ctx->history = 0;
+            break;
+        case DOWEL_CODEC_ZSTD:
+#ifdef DOWEL_HAVE_ZSTD
+            if (ctx->compressing) {
+                ZSTD_CCtx_reset(ctx->cctx, ZSTD_reset_session_only);
+            } else {
+                ZSTD_DCtx_reset(ctx->dctx, ZSTD_reset_session_only);
+            }
+#endif
+            break;
+    }
+    ctx->out_used = 0;
+    ctx->open = false;
+    ctx->error = DOWEL_SUCCESS;
+}
+
+int dowel_codec_finish(dowel_codec_ctx_t* ctx) {
+    if (!ctx) return DOWEL_ERROR_INVALID_PARAMETER;
+    if (ctx->error == DOWEL_SUCCESS) {
+        if (!ctx->compressing) {
+            if (ctx->open || ctx->block_used > 0) {
+                fail(ctx, DOWEL_ERROR_INVALID_PARAMETER, "Compressed stream ended partway through");
+            }
+        } else {
+            switch (ctx->codec) {
+                case DOWEL_CODEC_GZIP:
+                    deflate_step(ctx, NULL, 0, Z_FINISH);
+                    break;
+                case DOWEL_CODEC_LZ4:
+                    lz4_compress_finish(ctx);
+                    break;
+                case DOWEL_CODEC_ZSTD:
+#ifdef DOWEL_HAVE_ZSTD
+                    zstd_compress_step(ctx, NULL, 0, ZSTD_e_end);
+#endif
+                    break;
+            }
+        }
+        drain(ctx);
+    }
+    int status = ctx->error;
+    dowel_codec_reset(ctx);
+    return status;
+}
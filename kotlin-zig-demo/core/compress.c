@@ -0,0 +1,685 @@
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zlib.h>
+#ifdef DOWEL_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#include "core_internal.h"
+
+// Compression utilities - gzip framing through zlib, and codec-tagged frames
+// over gzip, LZ4 (lz4.c) and zstd when built with DOWEL_HAVE_ZSTD
+
+#define GZIP_WINDOW_BITS (15 + 16)
+#define GZIP_AUTO_WINDOW_BITS (15 + 32)
+#define ZSTD_LEVEL_MAX 19 // 20-22 need far more memory than a phone should spend
+
+dowel_buffer_t* dowel_compress_gzip(const uint8_t* data, size_t size) {
+    return dowel_compress_gzip_in(NULL, data, size);
+}
+
+dowel_buffer_t* dowel_compress_gzip_in(dowel_arena_t* arena, const uint8_t* data, size_t size) {
+    if (!data && size > 0) return NULL;
+
+    z_stream zs;
+    memset(&zs, 0, sizeof(zs));
+    if (deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, GZIP_WINDOW_BITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return NULL;
+    }
+
+    size_t bound = deflateBound(&zs, (uLong)size);
+    dowel_buffer_t* out = dcore_buffer_new(arena, bound);
+    if (!out) {
+        deflateEnd(&zs);
+        return NULL;
+    }
+
+    zs.next_in = (Bytef*)data;
+    zs.avail_in = (uInt)size;
+    zs.next_out = out->data;
+    zs.avail_out = (uInt)bound;
+
+    int result = deflate(&zs, Z_FINISH);
+    out->size = zs.total_out;
+    deflateEnd(&zs);
+
+    if (result != Z_STREAM_END) {
+        dcore_buffer_discard(arena, out);
+        return NULL;
+    }
+    return out;
+}
+
+dowel_buffer_t* dowel_decompress_gzip(const uint8_t* compressed_data, size_t size) {
+    return dowel_decompress_gzip_in(NULL, compressed_data, size);
+}
+
+dowel_buffer_t* dowel_decompress_gzip_in(dowel_arena_t* arena, const uint8_t* compressed_data, size_t size) {
+    if (!compressed_data || size == 0) return NULL;
+
+    z_stream zs;
+    memset(&zs, 0, sizeof(zs));
+    if (inflateInit2(&zs, GZIP_AUTO_WINDOW_BITS) != Z_OK) return NULL;
+
+    size_t capacity = size * 4 + 64;
+    uint8_t* data = dcore_alloc_in(arena, capacity);
+    if (!data) {
+        inflateEnd(&zs);
+        return NULL;
+    }
+
+    zs.next_in = (Bytef*)compressed_data;
+    zs.avail_in = (uInt)size;
+
+    int result = Z_OK;
+    while (result == Z_OK) {
+        if (zs.total_out == capacity) {
+            uint8_t* grown = dcore_realloc_in(arena, data, capacity, capacity * 2);
+            if (!grown) break;
+            data = grown;
+            capacity *= 2;
+        }
+        zs.next_out = data + zs.total_out;
+        zs.avail_out = (uInt)(capacity - zs.total_out);
+        result = inflate(&zs, Z_NO_FLUSH);
+    }
+
+    size_t produced = zs.total_out;
+    inflateEnd(&zs);
+
+    if (result != Z_STREAM_END) {
+        dcore_free_in(arena, data);
+        return NULL;
+    }
+
+    // In an arena, give back the unused tail before the header lands after it
+    if (arena) data = dcore_realloc_in(arena, data, capacity, produced);
+    dowel_buffer_t* out = dcore_buffer_adopt(arena, data, produced);
+    if (!out) dcore_free_in(arena, data);
+    return out;
+}
+
+// Multi-codec frames
+//
+//  - A frame is 'D' 'W', a byte holding the codec and FRAME_HAS_DICT, the
+//    content size as a LEB128 varint, the dictionary id when one was used,
+//    then the codec's own output: a gzip member (raw deflate when there is a
+//    dictionary, since gzip members cannot name one), an LZ4 block or a zstd
+//    frame. The header is 4 to 14 bytes, so small records stay small.
+//  - Knowing the content size up front, decompression allocates once and
+//    checks that the codec produced exactly that much. The size comes from
+//    the input, so a frame claiming more than its payload could decode to
+//    at the codec's highest ratio is rejected before anything is allocated.
+//  - A dictionary is raw bytes that small records are likely to share. The
+//    trainer picks them from samples (below); every codec uses the same bytes
+//    as history in front of the data.
+
+#define FRAME_MAGIC_0 'D'
+#define FRAME_MAGIC_1 'W'
+#define FRAME_CODEC_MASK 0x0f
+#define FRAME_HAS_DICT 0x10
+#define FRAME_HEADER_MAX (3 + 10 + 4)
+#define DEFLATE_WINDOW 32768
+
+struct dowel_compress_dict {
+    uint8_t* data;
+    size_t size;
+    uint32_t id;
+#ifdef DOWEL_HAVE_ZSTD
+    pthread_mutex_t lock;
+    ZSTD_CDict* cdicts[ZSTD_LEVEL_MAX + 1]; // digested per level on first use
+    ZSTD_DDict* ddict;
+#endif
+};
+
+bool dowel_codec_available(dowel_codec_t codec) {
+    switch (codec) {
+        case DOWEL_CODEC_GZIP:
+        case DOWEL_CODEC_LZ4:
+            return true;
+        case DOWEL_CODEC_ZSTD:
+#ifdef DOWEL_HAVE_ZSTD
+            return true;
+#else
+            return false;
+#endif
+    }
+    return false;
+}
+
+// Highest ratio each codec reaches: deflate peaks near 1032:1, each LZ4
+// length byte adds at most 255 bytes, and every zstd block takes at least
+// 3 bytes for at most 128 KB
+#define MAX_RATIO_GZIP 1032
+#define MAX_RATIO_LZ4 255
+#define MAX_RATIO_ZSTD ((128 << 10) / 3 + 1)
+#define MAX_CONTENT_SLACK 64
+
+size_t dcore_frame_max_content(dowel_codec_t codec, size_t size) {
+    size_t ratio = codec == DOWEL_CODEC_GZIP ? MAX_RATIO_GZIP
+                 : codec == DOWEL_CODEC_LZ4 ? MAX_RATIO_LZ4
+                 : MAX_RATIO_ZSTD;
+    if (size > (SIZE_MAX - MAX_CONTENT_SLACK) / ratio) return SIZE_MAX;
+    return size * ratio + MAX_CONTENT_SLACK;
+}
+
+static int default_level(dowel_codec_t codec) {
+    switch (codec) {
+        case DOWEL_CODEC_GZIP: return Z_DEFAULT_COMPRESSION;
+        case DOWEL_CODEC_LZ4: return 1;
+        case DOWEL_CODEC_ZSTD: return 3;
+    }
+    return 0;
+}
+
+static int max_level(dowel_codec_t codec) {
+    switch (codec) {
+        case DOWEL_CODEC_GZIP: return 9;
+        case DOWEL_CODEC_LZ4: return 9;
+        case DOWEL_CODEC_ZSTD: return ZSTD_LEVEL_MAX;
+    }
+    return 0;
+}
+
+static size_t write_varint(uint8_t* out, uint64_t value) {
+    size_t n = 0;
+    while (value >= 0x80) {
+        out[n++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    out[n++] = (uint8_t)value;
+    return n;
+}
+
+static bool read_varint(const uint8_t** p, const uint8_t* end, uint64_t* value) {
+    *value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (*p >= end) return false;
+        uint8_t byte = *(*p)++;
+        *value |= (uint64_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+// Parses the header; *payload is where the codec's output starts
+static bool read_frame(const uint8_t* frame, size_t size, dowel_frame_info_t* info, const uint8_t** payload) {
+    const uint8_t* end = frame + size;
+    if (size < 4 || frame[0] != FRAME_MAGIC_0 || frame[1] != FRAME_MAGIC_1) return false;
+    const uint8_t* p = frame + 3;
+    uint64_t content_size;
+    if (!read_varint(&p, end, &content_size) || content_size > SIZE_MAX) return false;
+
+    info->codec = (dowel_codec_t)(frame[2] & FRAME_CODEC_MASK);
+    info->content_size = (size_t)content_size;
+    info->dict_id = 0;
+    if (frame[2] & FRAME_HAS_DICT) {
+        if (end - p < 4) return false;
+        info->dict_id = (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+        p += 4;
+    }
+    *payload = p;
+    return info->content_size <= dcore_frame_max_content(info->codec, (size_t)(end - p));
+}
+
+int dowel_compress_frame_info(const uint8_t* frame, size_t size, dowel_frame_info_t* info) {
+    const uint8_t* payload;
+    if (!frame || !info || !read_frame(frame, size, info, &payload)) return DOWEL_ERROR_INVALID_PARAMETER;
+    return DOWEL_SUCCESS;
+}
+
+// gzip
+
+static size_t deflate_into(const uint8_t* data, size_t size, int level, const dowel_compress_dict_t* dict,
+                           uint8_t* out, size_t capacity) {
+    z_stream zs;
+    memset(&zs, 0, sizeof(zs));
+    int window_bits = dict ? -15 : GZIP_WINDOW_BITS;
+    if (deflateInit2(&zs, level, Z_DEFLATED, window_bits, 8, Z_DEFAULT_STRATEGY) != Z_OK) return 0;
+    if (dict) {
+        size_t tail = dict->size < DEFLATE_WINDOW ? dict->size : DEFLATE_WINDOW;
+        deflateSetDictionary(&zs, dict->data + dict->size - tail, (uInt)tail);
+    }
+    zs.next_in = (Bytef*)data;
+    zs.avail_in = (uInt)size;
+    zs.next_out = out;
+    zs.avail_out = (uInt)capacity;
+    int result = deflate(&zs, Z_FINISH);
+    size_t written = zs.total_out;
+    deflateEnd(&zs);
+    return result == Z_STREAM_END ? written : 0;
+}
+
+// Inflates the first prefix bytes of content_size; the whole stream
+// (checksum included, for gzip members) when prefix is everything
+static bool inflate_into(const uint8_t* payload, size_t size, const dowel_compress_dict_t* dict, uint8_t* out,
+                         size_t content_size, size_t prefix) {
+    z_stream zs;
+    memset(&zs, 0, sizeof(zs));
+    if (inflateInit2(&zs, dict ? -15 : GZIP_WINDOW_BITS) != Z_OK) return false;
+    if (dict) {
+        size_t tail = dict->size < DEFLATE_WINDOW ? dict->size : DEFLATE_WINDOW;
+        inflateSetDictionary(&zs, dict->data + dict->size - tail, (uInt)tail);
+    }
+    zs.next_in = (Bytef*)payload;
+    zs.avail_in = (uInt)size;
+    zs.next_out = out;
+    zs.avail_out = (uInt)prefix;
+    int result = inflate(&zs, prefix == content_size ? Z_FINISH : Z_SYNC_FLUSH);
+    bool complete = prefix == content_size ? result == Z_STREAM_END && zs.total_out == content_size
+                                           : (result == Z_OK || result == Z_BUF_ERROR) && zs.total_out == prefix;
+    inflateEnd(&zs);
+    return complete;
+}
+
+// zstd
+
+#ifdef DOWEL_HAVE_ZSTD
+
+// One compression and one decompression context per thread, reused
+typedef struct {
+    ZSTD_CCtx* cctx;
+    ZSTD_DCtx* dctx;
+} zstd_contexts_t;
+
+static _Thread_local zstd_contexts_t* thread_zstd;
+static pthread_key_t zstd_key;
+static pthread_once_t zstd_key_once = PTHREAD_ONCE_INIT;
+
+static void release_zstd(void* contexts) {
+    zstd_contexts_t* z = contexts;
+    ZSTD_freeCCtx(z->cctx);
+    ZSTD_freeDCtx(z->dctx);
+    free(z);
+}
+
+static void create_zstd_key(void) {
+    pthread_key_create(&zstd_key, release_zstd);
+}
+
+static zstd_contexts_t* zstd_contexts(void) {
+    if (thread_zstd) return thread_zstd;
+    pthread_once(&zstd_key_once, create_zstd_key);
+    zstd_contexts_t* z = calloc(1, sizeof(*z));
+    if (!z) return NULL;
+    z->cctx = ZSTD_createCCtx();
+    z->dctx = ZSTD_createDCtx();
+    if (!z->cctx || !z->dctx) {
+        release_zstd(z);
+        return NULL;
+    }
+    pthread_setspecific(zstd_key, z);
+    thread_zstd = z;
+    return z;
+}
+
+static size_t zstd_into(const uint8_t* data, size_t size, int level, dowel_compress_dict_t* dict, uint8_t* out,
+                        size_t capacity) {
+    zstd_contexts_t* z = zstd_contexts();
+    if (!z) return 0;
+    size_t written;
+    if (dict) {
+        pthread_mutex_lock(&dict->lock);
+        if (!dict->cdicts[level]) dict->cdicts[level] = ZSTD_createCDict(dict->data, dict->size, level);
+        ZSTD_CDict* cdict = dict->cdicts[level];
+        pthread_mutex_unlock(&dict->lock);
+        if (!cdict) return 0;
+        written = ZSTD_compress_usingCDict(z->cctx, out, capacity, data, size, cdict);
+    } else {
+        written = ZSTD_compressCCtx(z->cctx, out, capacity, data, size, level);
+    }
+    return ZSTD_isError(written) ? 0 : written;
+}
+
+static bool unzstd_into(const uint8_t* payload, size_t size, dowel_compress_dict_t* dict, uint8_t* out,
+                        size_t content_size) {
+    zstd_contexts_t* z = zstd_contexts();
+    if (!z) return false;
+    size_t produced;
+    if (dict) {
+        pthread_mutex_lock(&dict->lock);
+        if (!dict->ddict) dict->ddict = ZSTD_createDDict(dict->data, dict->size);
+        ZSTD_DDict* ddict = dict->ddict;
+        pthread_mutex_unlock(&dict->lock);
+        if (!ddict) return false;
+        produced = ZSTD_decompress_usingDDict(z->dctx, out, content_size, payload, size, ddict);
+    } else {
+        produced = ZSTD_decompressDCtx(z->dctx, out, content_size, payload, size);
+    }
+    return !ZSTD_isError(produced) && produced == content_size;
+}
+
+#endif
+
+// Frames
+
+static size_t payload_bound(dowel_codec_t codec, size_t size) {
+    switch (codec) {
+        case DOWEL_CODEC_GZIP: return (size_t)compressBound((uLong)size) + 32;
+        case DOWEL_CODEC_LZ4: return dcore_lz4_bound(size);
+#ifdef DOWEL_HAVE_ZSTD
+        case DOWEL_CODEC_ZSTD: return ZSTD_compressBound(size);
+#else
+        case DOWEL_CODEC_ZSTD: return 0;
+#endif
+    }
+    return 0;
+}
+
+bool dcore_compress_resolve(const dowel_compress_options_t* options, size_t size, dowel_compress_options_t* resolved) {
+    dowel_compress_options_t defaults = { DOWEL_CODEC_LZ4, 0, NULL };
+    if (!options) options = &defaults;
+    if (size > INT32_MAX || !dowel_codec_available(options->codec)) {
+        dcore_report_error(DOWEL_ERROR_INVALID_PARAMETER, "Unsupported compression codec or input");
+        return false;
+    }
+    if (options->level < 0 || options->level > max_level(options->codec)) {
+        dcore_report_error(DOWEL_ERROR_INVALID_PARAMETER, "Compression level out of range for the codec");
+        return false;
+    }
+    *resolved = *options;
+    if (resolved->level == 0) resolved->level = default_level(options->codec);
+    return true;
+}
+
+size_t dcore_frame_bound(dowel_codec_t codec, size_t size) {
+    return FRAME_HEADER_MAX + payload_bound(codec, size);
+}
+
+size_t dcore_frame_write(const dowel_compress_options_t* resolved, const uint8_t* data, size_t size, uint8_t* out,
+                         size_t capacity) {
+    dowel_codec_t codec = resolved->codec;
+    dowel_compress_dict_t* dict = (dowel_compress_dict_t*)resolved->dict;
+    uint8_t* p = out;
+    *p++ = FRAME_MAGIC_0;
+    *p++ = FRAME_MAGIC_1;
+    *p++ = (uint8_t)(codec | (dict ? FRAME_HAS_DICT : 0));
+    p += write_varint(p, size);
+    if (dict) {
+        for (int i = 0; i < 4; i++) *p++ = (uint8_t)(dict->id >> (8 * i));
+    }
+    size_t header = (size_t)(p - out);
+    size_t room = capacity - header;
+
+    size_t written = 0;
+    switch (codec) {
+        case DOWEL_CODEC_GZIP:
+            written = deflate_into(data, size, resolved->level, dict, p, room);
+            break;
+        case DOWEL_CODEC_LZ4:
+            written = dcore_lz4_compress(dict ? dict->data : NULL, dict ? dict->size : 0, data, size, p, resolved->level);
+            break;
+        case DOWEL_CODEC_ZSTD:
+#ifdef DOWEL_HAVE_ZSTD
+            written = zstd_into(data, size, resolved->level, dict, p, room);
+#endif
+            break;
+    }
+    return written ? header + written : 0;
+}
+
+int dcore_frame_read(const uint8_t* frame, size_t size, const dowel_compress_dict_t* dict, uint8_t* out,
+                     size_t out_size, size_t prefix) {
+    dowel_frame_info_t info;
+    const uint8_t* payload;
+    if (!frame || !read_frame(frame, size, &info, &payload) || !dowel_codec_available(info.codec) ||
+        info.content_size != out_size) {
+        return DOWEL_ERROR_INVALID_PARAMETER;
+    }
+    if (info.dict_id != (dict ? dict->id : 0)) return DOWEL_ERROR_INVALID_PARAMETER;
+
+    size_t payload_size = size - (size_t)(payload - frame);
+    bool ok = false;
+    switch (info.codec) {
+        case DOWEL_CODEC_GZIP:
+            ok = inflate_into(payload, payload_size, dict, out, out_size, prefix < out_size ? prefix : out_size);
+            break;
+        case DOWEL_CODEC_LZ4:
+            if (prefix > out_size) prefix = out_size;
+            ok = dcore_lz4_decompress(dict ? dict->data : NULL, dict ? dict->size : 0, payload, payload_size, out, prefix,
+                                      prefix < out_size) == (int64_t)prefix;
+            break;
+        case DOWEL_CODEC_ZSTD:
+#ifdef DOWEL_HAVE_ZSTD
+            ok = unzstd_into(payload, payload_size, (dowel_compress_dict_t*)dict, out, out_size);
+#endif
+            break;
+    }
+    return ok ? DOWEL_SUCCESS : DOWEL_ERROR_INVALID_PARAMETER;
+}
+
+dowel_buffer_t* dowel_compress(const uint8_t* data, size_t size, const dowel_compress_options_t* options) {
+    return dowel_compress_in(NULL, data, size, options);
+}
+
+dowel_buffer_t* dowel_compress_in(dowel_arena_t* arena, const uint8_t* data, size_t size,
+                                  const dowel_compress_options_t* options) {
+    dowel_compress_options_t resolved;
+    if (!data && size > 0) {
+        dcore_report_error(DOWEL_ERROR_INVALID_PARAMETER, "Unsupported compression codec or input");
+        return NULL;
+    }
+    if (!dcore_compress_resolve(options, size, &resolved)) return NULL;
+
+    size_t capacity = dcore_frame_bound(resolved.codec, size);
+    dowel_buffer_t* out = dcore_buffer_new(arena, capacity);
+    if (!out) {
+        dcore_report_error(DOWEL_ERROR_OUT_OF_MEMORY, "Failed to allocate compression buffer");
+        return NULL;
+    }
+    size_t written = dcore_frame_write(&resolved, data, size, out->data, capacity);
+    if (written == 0) {
+        dcore_buffer_discard(arena, out);
+        dcore_report_error(DOWEL_ERROR_UNKNOWN, "Compression failed");
+        return NULL;
+    }
+
+    out->size = written;
+    // Hand back the unused bound
+    if (!arena) {
+        uint8_t* shrunk = realloc(out->data, out->size);
+        if (shrunk) out->data = shrunk;
+    }
+    return out;
+}
+
+dowel_buffer_t* dowel_decompress(const uint8_t* frame, size_t size, const dowel_compress_dict_t* dict) {
+    return dowel_decompress_in(NULL, frame, size, dict);
+}
+
+dowel_buffer_t* dowel_decompress_in(dowel_arena_t* arena, const uint8_t* frame, size_t size,
+                                    const dowel_compress_dict_t* dict) {
+    dowel_frame_info_t info;
+    const uint8_t* payload;
+    if (!frame || !read_frame(frame, size, &info, &payload) || !dowel_codec_available(info.codec)) {
+        dcore_report_error(DOWEL_ERROR_INVALID_PARAMETER, "Not a compressed frame this build can read");
+        return NULL;
+    }
+    if (info.dict_id != (dict ? dict->id : 0)) {
+        dcore_report_error(DOWEL_ERROR_INVALID_PARAMETER, "Compressed frame needs a different dictionary");
+        return NULL;
+    }
+
+    dowel_buffer_t* out = dcore_buffer_new(arena, info.content_size);
+    if (!out) {
+        dcore_report_error(DOWEL_ERROR_OUT_OF_MEMORY, "Failed to allocate decompression buffer");
+        return NULL;
+    }
+    if (dcore_frame_read(frame, size, dict, out->data, info.content_size, info.content_size) != DOWEL_SUCCESS) {
+        dcore_buffer_discard(arena, out);
+        dcore_report_error(DOWEL_ERROR_INVALID_PARAMETER, "Compressed frame is corrupt");
+        return NULL;
+    }
+    return out;
+}
+
+// Dictionaries
+//
+// Training is a simplified COVER (Liskovich et al., as in zstd's trainer):
+// count how many samples contain each 8 byte sequence, split the samples
+// into one epoch per dictionary segment, and from each epoch take the
+// segment whose sequences are most common. Sequences already taken count for
+// nothing afterwards, so segments do not repeat. The best segments go last,
+// where matches are closest to the data.
+
+#define TRAIN_DMER 8
+#define TRAIN_HASH_LOG 20
+
+typedef struct {
+    size_t offset;
+    uint64_t score;
+} dict_segment_t;
+
+static inline uint32_t dmer_hash(const uint8_t* p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return (uint32_t)((v * 0x9E3779B97F4A7C15ULL) >> (64 - TRAIN_HASH_LOG));
+}
+
+static int compare_segments(const void* a, const void* b) {
+    uint64_t x = ((const dict_segment_t*)a)->score;
+    uint64_t y = ((const dict_segment_t*)b)->score;
+    return x < y ? -1 : x > y;
+}
+
+static dowel_compress_dict_t* dict_new(const uint8_t* data, size_t size) {
+    dowel_compress_dict_t* dict = calloc(1, sizeof(*dict));
+    if (!dict) return NULL;
+    dict->data = malloc(size);
+    if (!dict->data) {
+        free(dict);
+        return NULL;
+    }
+    memcpy(dict->data, data, size);
+    dict->size = size;
+    dict->id = (uint32_t)crc32(0, data, (uInt)size) | 1;
+#ifdef DOWEL_HAVE_ZSTD
+    pthread_mutex_init(&dict->lock, NULL);
+#endif
+    return dict;
+}
+
+dowel_compress_dict_t* dowel_compress_dict_load(const uint8_t* data, size_t size) {
+    if (!data || size == 0 || size > UINT32_MAX) {
+        dcore_report_error(DOWEL_ERROR_INVALID_PARAMETER, "Empty compression dictionary");
+        return NULL;
+    }
+    dowel_compress_dict_t* dict = dict_new(data, size);
+    if (!dict) dcore_report_error(DOWEL_ERROR_OUT_OF_MEMORY, "Failed to allocate compression dictionary");
+    return dict;
+}
+
+dowel_compress_dict_t* dowel_compress_dict_train(const uint8_t* const* samples, const size_t* sizes, size_t count,
+                                                 size_t capacity) {
+    size_t total = 0;
+    for (size_t i = 0; samples && sizes && i < count; i++) total += sizes[i];
+    if (!samples || !sizes || count == 0 || capacity < 64 || total < 2 * TRAIN_DMER) {
+        dcore_report_error(DOWEL_ERROR_INVALID_PARAMETER, "Dictionary training needs samples and room");
+        return NULL;
+    }
+
+    // Segments about half a record long, so one covers a record's shared part
+    size_t segment = total / count / 2;
+    if (segment < 32) segment = 32;
+    if (segment > 1024) segment = 1024;
+    if (segment > capacity) segment = capacity;
+
+    uint8_t* text = malloc(total);
+    uint32_t* frequency = calloc((size_t)1 << TRAIN_HASH_LOG, sizeof(uint32_t));
+    uint32_t* last_sample = calloc((size_t)1 << TRAIN_HASH_LOG, sizeof(uint32_t));
+    size_t max_segments = capacity / segment;
+    dict_segment_t* chosen = malloc(max_segments * sizeof(*chosen));
+    uint8_t* out = malloc(capacity);
+    dowel_compress_dict_t* dict = NULL;
+    if (!text || !frequency || !last_sample || !chosen || !out) {
+        dcore_report_error(DOWEL_ERROR_OUT_OF_MEMORY, "Failed to allocate dictionary training state");
+        goto done;
+    }
+
+    // In how many samples each sequence appears
+    size_t at = 0;
+    for (size_t i = 0; i < count; i++) {
+        memcpy(text + at, samples[i], sizes[i]);
+        for (size_t p = 0; p + TRAIN_DMER <= sizes[i]; p++) {
+            uint32_t h = dmer_hash(text + at + p);
+            if (last_sample[h] != (uint32_t)i + 1) {
+                last_sample[h] = (uint32_t)i + 1;
+                frequency[h]++;
+            }
+        }
+        at += sizes[i];
+    }
+
+    size_t epochs = max_segments;
+    if (total / epochs < segment) epochs = total / segment;
+    if (epochs == 0) epochs = 1;
+    size_t epoch_size = total / epochs;
+    size_t segments = 0;
+    for (size_t e = 0; e < epochs; e++) {
+        size_t begin = e * epoch_size;
+        size_t end = e + 1 == epochs ? total : begin + epoch_size;
+        if (end - begin < segment) continue;
+
+        // Slide a segment-wide window, scoring the sequences that start in it
+        size_t window = segment - TRAIN_DMER + 1;
+        uint64_t score = 0;
+        for (size_t p = begin; p < begin + window; p++) score += frequency[dmer_hash(text + p)];
+        uint64_t best_score = score;
+        size_t best = begin;
+        for (size_t p = begin + 1; p + segment <= end; p++) {
+            score += frequency[dmer_hash(text + p + window - 1)];
+            score -= frequency[dmer_hash(text + p - 1)];
+            if (score > best_score) {
+                best_score = score;
+                best = p;
+            }
+        }
+        // Sequences seen in only one sample are not worth a dictionary slot
+        if (best_score <= window) continue;
+
+        chosen[segments].offset = best;
+        chosen[segments].score = best_score;
+        segments++;
+        for (size_t p = best; p < best + window; p++) frequency[dmer_hash(text + p)] = 0;
+    }
+    if (segments == 0) {
+        dcore_report_error(DOWEL_ERROR_INVALID_PARAMETER, "Samples share too little to train a dictionary");
+        goto done;
+    }
+
+    qsort(chosen, segments, sizeof(*chosen), compare_segments);
+    for (size_t i = 0; i < segments; i++) memcpy(out + i * segment, text + chosen[i].offset, segment);
+    dict = dict_new(out, segments * segment);
+    if (!dict) dcore_report_error(DOWEL_ERROR_OUT_OF_MEMORY, "Failed to allocate compression dictionary");
+
+done:
+    free(text);
+    free(frequency);
+    free(last_sample);
+    free(chosen);
+    free(out);
+    return dict;
+}
+
+const uint8_t* dowel_compress_dict_bytes(const dowel_compress_dict_t* dict, size_t* size) {
+    if (!dict) return NULL;
+    if (size) *size = dict->size;
+    return dict->data;
+}
+
+uint32_t dowel_compress_dict_id(const dowel_compress_dict_t* dict) {
+    return dict ? dict->id : 0;
+}
+
+void dowel_compress_dict_free(dowel_compress_dict_t* dict) {
+    if (!dict) return;
+#ifdef DOWEL_HAVE_ZSTD
+    for (int level = 0; level <= ZSTD_LEVEL_MAX; level++) ZSTD_freeCDict(dict->cdicts[level]);
+    ZSTD_freeDDict(dict->ddict);
+    pthread_mutex_destroy(&dict->lock);
+#endif
+    free(dict->data);
+    free(dict);
+}
@@ -0,0 +1,341 @@
+#define _GNU_SOURCE
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "core_internal.h"
+
+// Seekable block archives - dowel_compress_blocks and dowel_seekable_*
+//
+//  - The input is cut into fixed-size blocks, each compressed as its own
+//    codec frame (compress.c), so blocks share no history and any one can be
+//    decoded alone. Task pool workers and the caller take blocks from a
+//    shared counter; every block is compressed straight into its slot of one
+//    output allocation, and the slots are closed up afterwards.
+//  - After the frames comes a table of their sizes and a fixed trailer
+//    (content size, block count, block size, magic), so a reader finds the
+//    table from the end of the archive and touches nothing else until asked.
+//    On a mapped file that means reading from the middle only pages in the
+//    trailer, the table and the frames it decodes.
+//  - Ranges that cover several blocks are decoded in parallel too: whole
+//    blocks land directly in the output, partial ones at the edges go
+//    through a temporary block, decoded only as far as the range reaches.
+
+#define TRAILER_SIZE 20
+#define TRAILER_MAGIC "DWSK"
+#define DEFAULT_BLOCK_SIZE (1u << 20)
+#define MIN_BLOCK_SIZE 4096
+#define MAX_BLOCK_SIZE (256u << 20) // keeps every frame size within 32 bits
+#define MAX_HELPERS 64
+
+struct dowel_seekable {
+    const uint8_t* archive; // borrowed
+    const dowel_compress_dict_t* dict;
+    uint64_t content_size;
+    size_t block_size;
+    size_t count;
+    uint64_t offsets[]; // where each frame starts, then where the table starts
+};
+
+static inline uint32_t load32(const uint8_t* p) {
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static inline void store32(uint8_t* p, uint32_t v) {
+    for (int i = 0; i < 4; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+// Blocks shared out between the caller and the pool
+
+typedef struct block_job block_job_t;
+struct block_job {
+    bool (*run)(block_job_t* job, size_t index);
+    size_t count;
+    atomic_size_t next;
+    atomic_bool failed;
+
+    // Compression
+    const dowel_compress_options_t* options;
+    const uint8_t* input;
+    size_t input_size;
+    size_t block_size;
+    uint8_t* slots;
+    size_t slot_size;
+    uint32_t* frame_sizes;
+
+    // Reads
+    const dowel_seekable_t* reader;
+    size_t first;
+    uint64_t offset;
+    size_t length;
+    uint8_t* out;
+};
+
+static void run_blocks(void* data) {
+    block_job_t* job = data;
+    while (!atomic_load_explicit(&job->failed, memory_order_relaxed)) {
+        size_t index = atomic_fetch_add_explicit(&job->next, 1, memory_order_relaxed);
+        if (index >= job->count) break;
+        if (!job->run(job, index)) atomic_store_explicit(&job->failed, true, memory_order_relaxed);
+    }
+}
+
+static bool for_each_block(block_job_t* job) {
+    atomic_init(&job->next, 0);
+    atomic_init(&job->failed, false);
+
+    // One block needs no help; otherwise a helper per worker, at most one
+    // per block besides the caller's
+    size_t wanted = 0;
+    if (job->count > 1) {
+        int workers = dowel_async_worker_count();
+        wanted = workers > 0 ? (size_t)workers : 0;
+        if (wanted > job->count - 1) wanted = job->count - 1;
+        if (wanted > MAX_HELPERS) wanted = MAX_HELPERS;
+    }
+    dowel_task_t* helpers[MAX_HELPERS];
+    size_t helper_count = 0;
+    for (size_t i = 0; i < wanted; i++) {
+        helpers[helper_count] = dowel_async_spawn(run_blocks, job);
+        if (helpers[helper_count]) helper_count++;
+    }
+    run_blocks(job);
+    for (size_t i = 0; i < helper_count; i++) dowel_async_free_task(helpers[i]);
+    return !atomic_load(&job->failed);
+}
+
+// Compression
+
+static bool compress_block(block_job_t* job, size_t index) {
+    size_t begin = index * job->block_size;
+    size_t size = job->input_size - begin < job->block_size ? job->input_size - begin : job->block_size;
+    size_t written = dcore_frame_write(job->options, job->input + begin, size, job->slots + index * job->slot_size,
+                                       job->slot_size);
+    job->frame_sizes[index] = (uint32_t)written;
+    return written > 0;
+}
+
+dowel_buffer_t* dowel_compress_blocks(const uint8_t* data, size_t size, const dowel_compress_options_t* options,
+                                      size_t block_size) {
+    if (block_size == 0) block_size = DEFAULT_BLOCK_SIZE;
+    dowel_compress_options_t resolved;
+    if ((!data && size > 0) || block_size < MIN_BLOCK_SIZE || block_size > MAX_BLOCK_SIZE) {
+        dcore_report_error(DOWEL_ERROR_INVALID_PARAMETER, "Block size out of range for a seekable archive");
+        return NULL;
+    }
+    if (!dcore_compress_resolve(options, size < block_size ? size : block_size, &resolved)) return NULL;
+
+    size_t count = (size + block_size - 1) / block_size;
+    size_t slot_size = dcore_frame_bound(resolved.codec, block_size);
+    if (count > 0 && slot_size > (SIZE_MAX - TRAILER_SIZE) / (count + 1)) {
+        dcore_report_error(DOWEL_ERROR_OUT_OF_MEMORY, "Input too large for a seekable archive");
+        return NULL;
+    }
+    dowel_buffer_t* out = dcore_buffer_new(NULL, count * slot_size + count * 4 + TRAILER_SIZE);
+    uint32_t* frame_sizes = malloc((count ? count : 1) * sizeof(uint32_t));
+    if (!out || !frame_sizes) {
+        dowel_free_buffer(out);
+        free(frame_sizes);
+        dcore_report_error(DOWEL_ERROR_OUT_OF_MEMORY, "Failed to allocate seekable archive");
+        return NULL;
+    }
+
+    block_job_t job = {
+        .run = compress_block,
+        .count = count,
+        .options = &resolved,
+        .input = data,
+        .input_size = size,
+        .block_size = block_size,
+        .slots = out->data,
+        .slot_size = slot_size,
+        .frame_sizes = frame_sizes,
+    };
+    if (!for_each_block(&job)) {
+        dowel_free_buffer(out);
+        free(frame_sizes);
+        dcore_report_error(DOWEL_ERROR_UNKNOWN, "Block compression failed");
+        return NULL;
+    }
+
+    // Close up the slots, then the size table and trailer
+    uint8_t* p = out->data;
+    for (size_t i = 0; i < count; i++) {
+        memmove(p, out->data + i * slot_size, frame_sizes[i]);
+        p += frame_sizes[i];
+    }
+    for (size_t i = 0; i < count; i++, p += 4) store32(p, frame_sizes[i]);
+    uint64_t content_size = size;
+    store32(p, (uint32_t)content_size);
+    store32(p + 4, (uint32_t)(content_size >> 32));
+    store32(p + 8, (uint32_t)count);
+    store32(p + 12, (uint32_t)block_size);
+    memcpy(p + 16, TRAILER_MAGIC, 4);
+    p += TRAILER_SIZE;
+    free(frame_sizes);
+
+    out->size = (size_t)(p - out->data);
+    uint8_t* shrunk = realloc(out->data, out->size);
+    if (shrunk) out->data = shrunk;
+    return out;
+}
+
+// Reading
+
+static size_t block_content_size(const dowel_seekable_t* reader, size_t index) {
+    uint64_t begin = (uint64_t)index * reader->block_size;
+    uint64_t left = reader->content_size - begin;
+    return left < reader->block_size ? (size_t)left : reader->block_size;
+}
+
+dowel_seekable_t* dowel_seekable_open(const uint8_t* archive, size_t size, const dowel_compress_dict_t* dict) {
+    if (!archive || size < TRAILER_SIZE || memcmp(archive + size - 4, TRAILER_MAGIC, 4) != 0) {
+        dcore_report_error(DOWEL_ERROR_INVALID_PARAMETER, "Not a seekable archive");
+        return NULL;
+    }
+    const uint8_t* trailer = archive + size - TRAILER_SIZE;
+    uint64_t content_size = load32(trailer) | (uint64_t)load32(trailer + 4) << 32;
+    size_t count = load32(trailer + 8);
+    size_t block_size = load32(trailer + 12);
+    size_t table_size = count * 4;
+    // The trailer is untrusted: no codec gets more content than this out of
+    // the archive's bytes, whichever the frames use
+    if (block_size < MIN_BLOCK_SIZE || block_size > MAX_BLOCK_SIZE || table_size > size - TRAILER_SIZE ||
+        content_size > (uint64_t)count * block_size || (count > 0 && content_size <= (uint64_t)(count - 1) * block_size) ||
+        content_size > dcore_frame_max_content(0, size)) {
+        dcore_report_error(DOWEL_ERROR_INVALID_PARAMETER, "Seekable archive trailer is corrupt");
+        return NULL;
+    }
+
+    dowel_seekable_t* reader = malloc(sizeof(*reader) + (count + 1) * sizeof(uint64_t));
+    if (!reader) {
+        dcore_report_error(DOWEL_ERROR_OUT_OF_MEMORY, "Failed to allocate seekable archive reader");
+        return NULL;
+    }
+    reader->archive = archive;
+    reader->dict = dict;
+    reader->content_size = content_size;
+    reader->block_size = block_size;
+    reader->count = count;
+
+    // The frames must exactly fill the space in front of the table, each
+    // big enough for its block
+    const uint8_t* table = trailer - table_size;
+    uint64_t at = 0;
+    bool fits = true;
+    for (size_t i = 0; i < count; i++) {
+        uint32_t frame_size = load32(table + 4 * i);
+        reader->offsets[i] = at;
+        at += frame_size;
+        fits = fits && block_content_size(reader, i) <= dcore_frame_max_content(0, frame_size);
+    }
+    reader->offsets[count] = at;
+    if (at != (uint64_t)(table - archive) || !fits) {
+        free(reader);
+        dcore_report_error(DOWEL_ERROR_INVALID_PARAMETER, "Seekable archive size table is corrupt");
+        return NULL;
+    }
+    return reader;
+}
+
+void dowel_seekable_close(dowel_seekable_t* reader) {
+    free(reader);
+}
+
+uint64_t dowel_seekable_content_size(const dowel_seekable_t* reader) {
+    return reader ? reader->content_size : 0;
+}
+
+size_t dowel_seekable_block_count(const dowel_seekable_t* reader) {
+    return reader ? reader->count : 0;
+}
+
+size_t dowel_seekable_block_size(const dowel_seekable_t* reader) {
+    return reader ? reader->block_size : 0;
+}
+
+static int decode_block(const dowel_seekable_t* reader, size_t index, uint8_t* out, size_t prefix) {
+    const uint8_t* frame = reader->archive + reader->offsets[index];
+    size_t frame_size = (size_t)(reader->offsets[index + 1] - reader->offsets[index]);
+    return dcore_frame_read(frame, frame_size, reader->dict, out, block_content_size(reader, index), prefix);
+}
+
+static bool read_block(block_job_t* job, size_t i) {
+    const dowel_seekable_t* reader = job->reader;
+    size_t index = job->first + i;
+    uint64_t block_start = (uint64_t)index * reader->block_size;
+    size_t block_length = block_content_size(reader, index);
+
+    // The part of this block inside the range
+    uint64_t from = job->offset > block_start ? job->offset : block_start;
+    uint64_t to = job->offset + job->length < block_start + block_length ? job->offset + job->length
+                                                                         : block_start + block_length;
+    uint8_t* dest = job->out + (from - job->offset);
+    if (from == block_start && to == block_start + block_length) {
+        return decode_block(reader, index, dest, block_length) == DOWEL_SUCCESS;
+    }
+
+    // Decoding stops at the end of the range where the codec allows
+    uint8_t* whole = malloc(block_length);
+    bool ok = whole && decode_block(reader, index, whole, (size_t)(to - block_start)) == DOWEL_SUCCESS;
+    if (ok) memcpy(dest, whole + (from - block_start), (size_t)(to - from));
+    free(whole);
+    return ok;
+}
+
+dowel_buffer_t* dowel_seekable_read(const dowel_seekable_t* reader, uint64_t offset, size_t length) {
+    return dowel_seekable_read_in(NULL, reader, offset, length);
+}
+
+dowel_buffer_t* dowel_seekable_read_in(dowel_arena_t* arena, const dowel_seekable_t* reader, uint64_t offset,
+                                       size_t length) {
+    if (!reader || offset > reader->content_size) {
+        dcore_report_error(DOWEL_ERROR_INVALID_PARAMETER, "Read starts past the end of the archive");
+        return NULL;
+    }
+    if (length > reader->content_size - offset) length = (size_t)(reader->content_size - offset);
+
+    dowel_buffer_t* out = dcore_buffer_new(arena, length);
+    if (!out) {
+        dcore_report_error(DOWEL_ERROR_OUT_OF_MEMORY, "Failed to allocate seekable read buffer");
+        return NULL;
+    }
+    if (length == 0) return out;
+
+    block_job_t job = {
+        .run = read_block,
+        .reader = reader,
+        .first = (size_t)(offset / reader->block_size),
+        .offset = offset,
+        .length = length,
+        .out = out->data,
+    };
+    job.count = (size_t)((offset + length - 1) / reader->block_size) - job.first + 1;
+    if (!for_each_block(&job)) {
+        dcore_buffer_discard(arena, out);
+        dcore_report_error(DOWEL_ERROR_INVALID_PARAMETER, "Seekable archive block is corrupt");
+        return NULL;
+    }
+    return out;
+}
+
+dowel_buffer_t* dowel_seekable_read_block(const dowel_seekable_t* reader, size_t index) {
+    return dowel_seekable_read_block_in(NULL, reader, index);
+}
+
+dowel_buffer_t* dowel_seekable_read_block_in(dowel_arena_t* arena, const dowel_seekable_t* reader, size_t index) {
+    if (!reader || index >= reader->count) {
+        dcore_report_error(DOWEL_ERROR_INVALID_PARAMETER, "Block index past the end of the archive");
+        return NULL;
+    }
+    return dowel_seekable_read_in(arena, reader, (uint64_t)index * reader->block_size, block_content_size(reader, index));
+}
+
+dowel_buffer_t* dowel_decompress_blocks(const uint8_t* archive, size_t size, const dowel_compress_dict_t* dict) {
+    dowel_seekable_t* reader = dowel_seekable_open(archive, size, dict);
+    if (!reader) return NULL;
+    dowel_buffer_t* out = NULL;
+    if (reader->content_size <= SIZE_MAX) out = dowel_seekable_read(reader, 0, (size_t)reader->content_size);
+    dowel_seekable_close(reader);
+    return out;
+}
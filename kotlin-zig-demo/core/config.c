@@ -0,0 +1,169 @@
+#include "core_internal.h"
+#include "config_store.h"
+
+// Configuration functions backed by the concurrent store in config_store.c.
+// Getters are typed: a key holding a different type reads as the default,
+// except that numeric types (int, float, bool) convert between each other.
+// Strings returned by dowel_config_get_string stay valid until shutdown.
+//
+// The path and handle variants share the conversions below; they differ only
+// in how the slot is found.
+
+static const char* as_string(bool found, const dcore_config_value_t* value, const char* default_value) {
+    if (!found || value->type != DCORE_CONFIG_STRING) return default_value;
+    return value->as.string;
+}
+
+static int64_t as_int(bool found, const dcore_config_value_t* value, int64_t default_value) {
+    if (!found) return default_value;
+
+    switch (value->type) {
+        case DCORE_CONFIG_INT: return value->as.integer;
+        case DCORE_CONFIG_FLOAT: return (int64_t)value->as.number;
+        case DCORE_CONFIG_BOOL: return value->as.boolean ? 1 : 0;
+        default: return default_value;
+    }
+}
+
+static bool as_bool(bool found, const dcore_config_value_t* value, bool default_value) {
+    if (!found) return default_value;
+
+    switch (value->type) {
+        case DCORE_CONFIG_BOOL: return value->as.boolean;
+        case DCORE_CONFIG_INT: return value->as.integer != 0;
+        case DCORE_CONFIG_FLOAT: return value->as.number != 0.0;
+        default: return default_value;
+    }
+}
+
+static double as_float(bool found, const dcore_config_value_t* value, double default_value) {
+    if (!found) return default_value;
+
+    switch (value->type) {
+        case DCORE_CONFIG_FLOAT: return value->as.number;
+        case DCORE_CONFIG_INT: return (double)value->as.integer;
+        case DCORE_CONFIG_BOOL: return value->as.boolean ? 1.0 : 0.0;
+        default: return default_value;
+    }
+}
+
+const char* dowel_config_get_string(const char* path, const char* default_value) {
+    dcore_config_value_t value;
+    bool found = dcore_config_get(path, &value);
+    return as_string(found, &value, default_value);
+}
+
+int64_t dowel_config_get_int(const char* path, int64_t default_value) {
+    dcore_config_value_t value;
+    bool found = dcore_config_get(path, &value);
+    return as_int(found, &value, default_value);
+}
+
+bool dowel_config_get_bool(const char* path, bool default_value) {
+    dcore_config_value_t value;
+    bool found = dcore_config_get(path, &value);
+    return as_bool(found, &value, default_value);
+}
+
+double dowel_config_get_float(const char* path, double default_value) {
+    dcore_config_value_t value;
+    bool found = dcore_config_get(path, &value);
+    return as_float(found, &value, default_value);
+}
+
+static int store_value(const char* path, const dcore_config_value_t* value) {
+    if (!path) return DOWEL_ERROR_INVALID_PARAMETER;
+    if (!dcore_config_set(path, value)) {
+        dcore_report_error(DOWEL_ERROR_CONFIG_ERROR, "Failed to store configuration value");
+        return DOWEL_ERROR_CONFIG_ERROR;
+    }
+    return DOWEL_SUCCESS;
+}
+
+int dowel_config_set_string(const char* path, const char* value) {
+    if (!value) return DOWEL_ERROR_INVALID_PARAMETER;
+    dcore_config_value_t v = { .type = DCORE_CONFIG_STRING, .as.string = value };
+    return store_value(path, &v);
+}
+
+int dowel_config_set_int(const char* path, int64_t value) {
+    dcore_config_value_t v = { .type = DCORE_CONFIG_INT, .as.integer = value };
+    return store_value(path, &v);
+}
+
+int dowel_config_set_bool(const char* path, bool value) {
+    dcore_config_value_t v = { .type = DCORE_CONFIG_BOOL, .as.boolean = value };
+    return store_value(path, &v);
+}
+
+int dowel_config_set_float(const char* path, double value) {
+    dcore_config_value_t v = { .type = DCORE_CONFIG_FLOAT, .as.number = value };
+    return store_value(path, &v);
+}
+
+// Pre-resolved keys
+
+dowel_config_key_t dowel_config_resolve(const char* path) {
+    if (!path) return DOWEL_CONFIG_INVALID_KEY;
+    uint32_t handle = dcore_config_resolve(path);
+    if (handle == 0) dcore_report_error(DOWEL_ERROR_CONFIG_ERROR, "Failed to resolve configuration key");
+    return handle;
+}
+
+const char* dowel_config_key_get_string(dowel_config_key_t key, const char* default_value) {
+    dcore_config_value_t value;
+    bool found = dcore_config_get_handle(key, &value);
+    return as_string(found, &value, default_value);
+}
+
+int64_t dowel_config_key_get_int(dowel_config_key_t key, int64_t default_value) {
+    dcore_config_value_t value;
+    bool found = dcore_config_get_handle(key, &value);
+    return as_int(found, &value, default_value);
+}
+
+bool dowel_config_key_get_bool(dowel_config_key_t key, bool default_value) {
+    dcore_config_value_t value;
+    bool found = dcore_config_get_handle(key, &value);
+    return as_bool(found, &value, default_value);
+}
+
+double dowel_config_key_get_float(dowel_config_key_t key, double default_value) {
+    dcore_config_value_t value;
+    bool found = dcore_config_get_handle(key, &value);
+    return as_float(found, &value, default_value);
+}
+
+static int store_handle_value(dowel_config_key_t key, const dcore_config_value_t* value) {
+    if (key == DOWEL_CONFIG_INVALID_KEY) return DOWEL_ERROR_INVALID_PARAMETER;
+    if (!dcore_config_set_handle(key, value)) {
+        dcore_report_error(DOWEL_ERROR_CONFIG_ERROR, "Failed to store configuration value");
+        return DOWEL_ERROR_CONFIG_ERROR;
+    }
+    return DOWEL_SUCCESS;
+}
+
+int dowel_config_key_set_string(dowel_config_key_t key, const char* value) {
+    if (!value) return DOWEL_ERROR_INVALID_PARAMETER;
+    dcore_config_value_t v = { .type = DCORE_CONFIG_STRING, .as.string = value };
+    return store_handle_value(key, &v);
+}
+
+int dowel_config_key_set_int(dowel_config_key_t key, int64_t value) {
+    dcore_config_value_t v = { .type = DCORE_CONFIG_INT, .as.integer = value };
+    return store_handle_value(key, &v);
+}
+
+int dowel_config_key_set_bool(dowel_config_key_t key, bool value) {
+    dcore_config_value_t v = { .type = DCORE_CONFIG_BOOL, .as.boolean = value };
+    return store_handle_value(key, &v);
+}
+
+int dowel_config_key_set_float(dowel_config_key_t key, double value) {
+    dcore_config_value_t v = { .type = DCORE_CONFIG_FLOAT, .as.number = value };
+    return store_handle_value(key, &v);
+}
+
+uint32_t dowel_config_key_generation(dowel_config_key_t key) {
+    return dcore_config_generation(key);
+}
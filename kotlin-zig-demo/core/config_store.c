@@ -0,0 +1,393 @@
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "config_store.h"
+
+// Layout:
+//  - Slots live in fixed-size segments that are never moved, so a slot pointer
+//    stays valid for the lifetime of the store.
+//  - The key table is an open-addressing array of (hash, slot) pairs. Readers
+//    probe it without locking; writers insert under write_lock and grow it by
+//    publishing a new table. Old tables are retired, not freed, so a reader
+//    still probing one is safe; they are released by dcore_config_reset.
+//  - Each slot holds its typed value behind a seqlock. The seqlock sequence
+//    doubles as the key's generation counter, and a slot's index (plus one)
+//    is the handle returned by dcore_config_resolve.
+//  - Keys and string values are copied into an append-only arena. String values
+//    are deduplicated, so toggling a key between a few values costs no memory.
+
+#define CONFIG_SEGMENT_SIZE 256
+#define CONFIG_MAX_SEGMENTS 1024
+#define CONFIG_ARENA_CHUNK_SIZE (64 * 1024)
+#define CONFIG_INITIAL_TABLE_SIZE 64
+
+typedef struct {
+    _Atomic uint32_t seq;
+    _Atomic uint32_t type;
+    _Atomic uint64_t bits;
+    const char* key;
+    uint32_t handle; // slot index + 1
+} config_slot_t;
+
+typedef struct {
+    _Atomic uint64_t hash;
+    config_slot_t* _Atomic slot;
+} key_entry_t;
+
+typedef struct key_table {
+    struct key_table* retired_next;
+    size_t mask;
+    size_t count;
+    key_entry_t entries[];
+} key_table_t;
+
+typedef struct arena_chunk {
+    struct arena_chunk* next;
+    size_t used;
+    size_t capacity;
+    char data[];
+} arena_chunk_t;
+
+static struct {
+    pthread_mutex_t write_lock;
+    key_table_t* _Atomic keys;
+    key_table_t* retired_tables;
+    config_slot_t* _Atomic segments[CONFIG_MAX_SEGMENTS];
+    uint32_t slot_count;
+    arena_chunk_t* arena;
+    const char** strings;
+    size_t strings_mask;
+    size_t strings_count;
+} store = { .write_lock = PTHREAD_MUTEX_INITIALIZER };
+
+static uint64_t hash_string(const char* s) {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    while (*s) {
+        h ^= (unsigned char)*s++;
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+static inline void cpu_relax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+// Arena (write_lock held)
+
+static const char* arena_intern(const char* s) {
+    size_t size = strlen(s) + 1;
+    arena_chunk_t* chunk = store.arena;
+
+    if (!chunk || chunk->capacity - chunk->used < size) {
+        size_t capacity = size > CONFIG_ARENA_CHUNK_SIZE ? size : CONFIG_ARENA_CHUNK_SIZE;
+        chunk = malloc(sizeof(arena_chunk_t) + capacity);
+        if (!chunk) return NULL;
+        chunk->next = store.arena;
+        chunk->used = 0;
+        chunk->capacity = capacity;
+        store.arena = chunk;
+    }
+
+    char* copy = chunk->data + chunk->used;
+    memcpy(copy, s, size);
+    chunk->used += size;
+    return copy;
+}
+
+// Deduplicated string values (write_lock held)
+
+static const char* intern_value(const char* s) {
+    if (store.strings_count * 2 >= store.strings_mask) {
+        size_t size = store.strings ? (store.strings_mask + 1) * 2 : CONFIG_INITIAL_TABLE_SIZE;
+        const char** grown = calloc(size, sizeof(*grown));
+        if (!grown) return NULL;
+
+        for (size_t i = 0; store.strings && i <= store.strings_mask; i++) {
+            if (!store.strings[i]) continue;
+            size_t j = hash_string(store.strings[i]) & (size - 1);
+            while (grown[j]) j = (j + 1) & (size - 1);
+            grown[j] = store.strings[i];
+        }
+        free(store.strings);
+        store.strings = grown;
+        store.strings_mask = size - 1;
+    }
+
+    size_t i = hash_string(s) & store.strings_mask;
+    for (; store.strings[i]; i = (i + 1) & store.strings_mask) {
+        if (strcmp(store.strings[i], s) == 0) return store.strings[i];
+    }
+
+    const char* copy = arena_intern(s);
+    if (!copy) return NULL;
+    store.strings[i] = copy;
+    store.strings_count++;
+    return copy;
+}
+
+// Key table
+
+static config_slot_t* find_slot(const char* key, uint64_t hash) {
+    key_table_t* table = atomic_load_explicit(&store.keys, memory_order_acquire);
+    if (!table) return NULL;
+
+    for (size_t i = hash & table->mask;; i = (i + 1) & table->mask) {
+        config_slot_t* slot = atomic_load_explicit(&table->entries[i].slot, memory_order_acquire);
+        if (!slot) return NULL;
+        if (atomic_load_explicit(&table->entries[i].hash, memory_order_relaxed) == hash && strcmp(slot->key, key) == 0) {
+            return slot;
+        }
+    }
+}
+
+static void table_insert(key_table_t* table, uint64_t hash, config_slot_t* slot) {
+    size_t i = hash & table->mask;
+    while (atomic_load_explicit(&table->entries[i].slot, memory_order_relaxed)) {
+        i = (i + 1) & table->mask;
+    }
+    // Readers check the slot pointer first, so the hash must be visible before it
+    atomic_store_explicit(&table->entries[i].hash, hash, memory_order_relaxed);
+    atomic_store_explicit(&table->entries[i].slot, slot, memory_order_release);
+    table->count++;
+}
+
+// Ensures there is room for one more key (write_lock held)
+static key_table_t* reserve_table(void) {
+    key_table_t* table = atomic_load_explicit(&store.keys, memory_order_relaxed);
+    if (table && (table->count + 1) * 2 <= table->mask + 1) return table;
+
+    size_t size = table ? (table->mask + 1) * 2 : CONFIG_INITIAL_TABLE_SIZE;
+    key_table_t* grown = calloc(1, sizeof(key_table_t) + size * sizeof(key_entry_t));
+    if (!grown) return NULL;
+    grown->mask = size - 1;
+
+    if (table) {
+        for (size_t i = 0; i <= table->mask; i++) {
+            config_slot_t* slot = atomic_load_explicit(&table->entries[i].slot, memory_order_relaxed);
+            if (slot) table_insert(grown, atomic_load_explicit(&table->entries[i].hash, memory_order_relaxed), slot);
+        }
+        table->retired_next = store.retired_tables;
+        store.retired_tables = table;
+    }
+
+    atomic_store_explicit(&store.keys, grown, memory_order_release);
+    return grown;
+}
+
+// Creates the slot for a new key (write_lock held)
+static config_slot_t* create_slot(const char* key, uint64_t hash) {
+    uint32_t index = store.slot_count;
+    uint32_t segment = index / CONFIG_SEGMENT_SIZE;
+    if (segment >= CONFIG_MAX_SEGMENTS) return NULL;
+
+    key_table_t* table = reserve_table();
+    if (!table) return NULL;
+
+    config_slot_t* slots = atomic_load_explicit(&store.segments[segment], memory_order_relaxed);
+    if (!slots) {
+        slots = calloc(CONFIG_SEGMENT_SIZE, sizeof(config_slot_t));
+        if (!slots) return NULL;
+        atomic_store_explicit(&store.segments[segment], slots, memory_order_release);
+    }
+
+    const char* interned_key = arena_intern(key);
+    if (!interned_key) return NULL;
+
+    config_slot_t* slot = &slots[index % CONFIG_SEGMENT_SIZE];
+    slot->key = interned_key;
+    slot->handle = index + 1;
+    store.slot_count++;
+
+    table_insert(table, hash, slot);
+    return slot;
+}
+
+// Seqlock
+
+static void slot_read(config_slot_t* slot, uint32_t* type, uint64_t* bits) {
+    for (;;) {
+        uint32_t seq0 = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        if (seq0 & 1) {
+            cpu_relax();
+            continue;
+        }
+
+        *type = atomic_load_explicit(&slot->type, memory_order_relaxed);
+        *bits = atomic_load_explicit(&slot->bits, memory_order_relaxed);
+
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&slot->seq, memory_order_relaxed) == seq0) return;
+    }
+}
+
+static void slot_write(config_slot_t* slot, uint32_t type, uint64_t bits) {
+    uint32_t seq = atomic_load_explicit(&slot->seq, memory_order_relaxed);
+    for (;;) {
+        if (seq & 1) {
+            cpu_relax();
+            seq = atomic_load_explicit(&slot->seq, memory_order_relaxed);
+        } else if (atomic_compare_exchange_weak_explicit(&slot->seq, &seq, seq + 1,
+                                                         memory_order_relaxed, memory_order_relaxed)) {
+            break;
+        }
+    }
+
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&slot->type, type, memory_order_relaxed);
+    atomic_store_explicit(&slot->bits, bits, memory_order_relaxed);
+    atomic_store_explicit(&slot->seq, seq + 2, memory_order_release);
+}
+
+static uint64_t encode_value(const dcore_config_value_t* value) {
+    uint64_t bits = 0;
+    switch (value->type) {
+        case DCORE_CONFIG_STRING: bits = (uint64_t)(uintptr_t)value->as.string; break;
+        case DCORE_CONFIG_INT: bits = (uint64_t)value->as.integer; break;
+        case DCORE_CONFIG_BOOL: bits = value->as.boolean ? 1 : 0; break;
+        case DCORE_CONFIG_FLOAT: memcpy(&bits, &value->as.number, sizeof(bits)); break;
+        case DCORE_CONFIG_NONE: break;
+    }
+    return bits;
+}
+
+static void decode_value(uint32_t type, uint64_t bits, dcore_config_value_t* out) {
+    out->type = (dcore_config_type_t)type;
+    switch (out->type) {
+        case DCORE_CONFIG_STRING: out->as.string = (const char*)(uintptr_t)bits; break;
+        case DCORE_CONFIG_INT: out->as.integer = (int64_t)bits; break;
+        case DCORE_CONFIG_BOOL: out->as.boolean = bits != 0; break;
+        case DCORE_CONFIG_FLOAT: memcpy(&out->as.number, &bits, sizeof(bits)); break;
+        case DCORE_CONFIG_NONE: break;
+    }
+}
+
+static config_slot_t* slot_from_handle(uint32_t handle) {
+    if (handle == 0) return NULL;
+    uint32_t index = handle - 1;
+    if (index / CONFIG_SEGMENT_SIZE >= CONFIG_MAX_SEGMENTS) return NULL;
+
+    config_slot_t* slots = atomic_load_explicit(&store.segments[index / CONFIG_SEGMENT_SIZE], memory_order_acquire);
+    if (!slots) return NULL;
+
+    // Slots past the last resolved key are zeroed and have no handle yet
+    config_slot_t* slot = &slots[index % CONFIG_SEGMENT_SIZE];
+    return slot->handle == handle ? slot : NULL;
+}
+
+static bool load_slot(config_slot_t* slot, dcore_config_value_t* out) {
+    uint32_t type;
+    uint64_t bits;
+    slot_read(slot, &type, &bits);
+    decode_value(type, bits, out);
+    return type != DCORE_CONFIG_NONE;
+}
+
+static bool valid_value(const dcore_config_value_t* value) {
+    if (!value || value->type == DCORE_CONFIG_NONE) return false;
+    return value->type != DCORE_CONFIG_STRING || value->as.string != NULL;
+}
+
+// Looks up or creates the slot for key, taking the write lock only for new keys
+static config_slot_t* resolve_slot(const char* key, uint64_t hash) {
+    config_slot_t* slot = find_slot(key, hash);
+    if (slot) return slot;
+
+    pthread_mutex_lock(&store.write_lock);
+    slot = find_slot(key, hash);
+    if (!slot) slot = create_slot(key, hash);
+    pthread_mutex_unlock(&store.write_lock);
+    return slot;
+}
+
+static bool store_slot(config_slot_t* slot, const dcore_config_value_t* value) {
+    // Scalars go straight into the slot; strings need the lock to be interned
+    if (value->type != DCORE_CONFIG_STRING) {
+        slot_write(slot, value->type, encode_value(value));
+        return true;
+    }
+
+    pthread_mutex_lock(&store.write_lock);
+    const char* interned = intern_value(value->as.string);
+    if (interned) slot_write(slot, DCORE_CONFIG_STRING, (uint64_t)(uintptr_t)interned);
+    pthread_mutex_unlock(&store.write_lock);
+    return interned != NULL;
+}
+
+// Public (internal) API
+
+bool dcore_config_get(const char* key, dcore_config_value_t* out) {
+    if (!key || !out) return false;
+
+    config_slot_t* slot = find_slot(key, hash_string(key));
+    return slot && load_slot(slot, out);
+}
+
+bool dcore_config_set(const char* key, const dcore_config_value_t* value) {
+    if (!key || !valid_value(value)) return false;
+
+    config_slot_t* slot = resolve_slot(key, hash_string(key));
+    return slot && store_slot(slot, value);
+}
+
+uint32_t dcore_config_resolve(const char* key) {
+    if (!key) return 0;
+
+    config_slot_t* slot = resolve_slot(key, hash_string(key));
+    return slot ? slot->handle : 0;
+}
+
+bool dcore_config_get_handle(uint32_t handle, dcore_config_value_t* out) {
+    config_slot_t* slot = slot_from_handle(handle);
+    return slot && out && load_slot(slot, out);
+}
+
+bool dcore_config_set_handle(uint32_t handle, const dcore_config_value_t* value) {
+    config_slot_t* slot = slot_from_handle(handle);
+    return slot && valid_value(value) && store_slot(slot, value);
+}
+
+uint32_t dcore_config_generation(uint32_t handle) {
+    config_slot_t* slot = slot_from_handle(handle);
+    if (!slot) return 0;
+
+    // An odd sequence means a write is in flight; report the generation it will produce
+    uint32_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+    return (seq + 1) / 2;
+}
+
+void dcore_config_reset(void) {
+    pthread_mutex_lock(&store.write_lock);
+
+    free(atomic_exchange(&store.keys, NULL));
+    while (store.retired_tables) {
+        key_table_t* next = store.retired_tables->retired_next;
+        free(store.retired_tables);
+        store.retired_tables = next;
+    }
+
+    for (size_t i = 0; i < CONFIG_MAX_SEGMENTS; i++) {
+        free(atomic_exchange(&store.segments[i], NULL));
+    }
+    store.slot_count = 0;
+
+    while (store.arena) {
+        arena_chunk_t* next = store.arena->next;
+        free(store.arena);
+        store.arena = next;
+    }
+
+    free(store.strings);
+    store.strings = NULL;
+    store.strings_mask = 0;
+    store.strings_count = 0;
+
+    pthread_mutex_unlock(&store.write_lock);
+}
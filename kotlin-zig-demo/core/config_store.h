@@ -0,0 +1,60 @@
+#ifndef DOWEL_CONFIG_STORE_H
+#define DOWEL_CONFIG_STORE_H
+
+// Concurrent keyed configuration store shared by the C core (config.c) and the
+// minimal C wrapper (c_wrapper.c). Self-contained on purpose: it does not pull
+// in either public header, since their error code definitions collide.
+//
+// Keys, string values and handles stay valid until dcore_config_reset().
+// Reads take a per-key seqlock snapshot and never block; writers to the same
+// key serialize on that key only, and inserting a new key takes a short mutex.
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    DCORE_CONFIG_NONE = 0,
+    DCORE_CONFIG_STRING = 1,
+    DCORE_CONFIG_INT = 2,
+    DCORE_CONFIG_BOOL = 3,
+    DCORE_CONFIG_FLOAT = 4,
+} dcore_config_type_t;
+
+typedef struct {
+    dcore_config_type_t type;
+    union {
+        const char* string;
+        int64_t integer;
+        bool boolean;
+        double number;
+    } as;
+} dcore_config_value_t;
+
+// Returns false if the key has never been set
+bool dcore_config_get(const char* key, dcore_config_value_t* out);
+
+// Returns false on invalid parameters or allocation failure
+bool dcore_config_set(const char* key, const dcore_config_value_t* value);
+
+// Handles: a key resolved once can be read and written with an indexed load
+// instead of hashing the path. Resolving a key that was never set creates an
+// empty slot, so handles can be taken at startup. Handle 0 is invalid.
+uint32_t dcore_config_resolve(const char* key);
+bool dcore_config_get_handle(uint32_t handle, dcore_config_value_t* out);
+bool dcore_config_set_handle(uint32_t handle, const dcore_config_value_t* value);
+
+// Number of completed writes to the key; changes whenever its value does
+uint32_t dcore_config_generation(uint32_t handle);
+
+// Drops every key and interned string. Must not race with readers.
+void dcore_config_reset(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DOWEL_CONFIG_STORE_H
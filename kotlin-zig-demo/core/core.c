@@ -0,0 +1,183 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <time.h>
+
+#include "core_internal.h"
+#include "config_store.h"
+#include "log_pipeline.h"
+
+#if defined(__APPLE__)
+#include <TargetConditionals.h>
+#endif
+
+// C implementation of the full dowel_steek_core.h API.
+// Like c_wrapper.c this mirrors the Zig core so it can be linked straight into
+// Kotlin/Native and C++ consumers without the Zig toolchain.
+
+static atomic_bool core_initialized = false;
+static const char* version_string = "0.1.0";
+
+static void (*_Atomic error_callback)(int error_code, const char* message) = NULL;
+
+// Core system functions
+int dowel_core_init(void) {
+    atomic_store(&core_initialized, true);
+    return DOWEL_SUCCESS;
+}
+
+void dowel_core_shutdown(void) {
+    if (!atomic_exchange(&core_initialized, false)) return;
+    dcore_async_shutdown();
+    dcore_meta_index_shutdown();
+    dcore_file_cache_shutdown();
+    dowel_log_binary_close();
+    dcore_log_shutdown();
+    dcore_config_reset();
+}
+
+const char* dowel_core_version(void) {
+    return version_string;
+}
+
+bool dowel_core_is_initialized(void) {
+    return atomic_load(&core_initialized);
+}
+
+// Memory management for returned data
+dowel_buffer_t* dcore_buffer_new(dowel_arena_t* arena, size_t size) {
+    if (arena) {
+        // Header and data in one block, data kept 16 byte aligned
+        size_t header = (sizeof(dowel_buffer_t) + 15) & ~(size_t)15;
+        if (size > SIZE_MAX - header) return NULL;
+        dowel_buffer_t* buffer = dowel_arena_alloc(arena, header + size);
+        if (!buffer) return NULL;
+        buffer->data = (uint8_t*)buffer + header;
+        buffer->size = size;
+        return buffer;
+    }
+
+    uint8_t* data = malloc(size ? size : 1);
+    if (!data) return NULL;
+
+    dowel_buffer_t* buffer = dcore_buffer_adopt(NULL, data, size);
+    if (!buffer) free(data);
+    return buffer;
+}
+
+dowel_buffer_t* dcore_buffer_adopt(dowel_arena_t* arena, uint8_t* data, size_t size) {
+    dowel_buffer_t* buffer = dcore_alloc_in(arena, sizeof(*buffer));
+    if (!buffer) return NULL;
+
+    buffer->data = data;
+    buffer->size = size;
+    return buffer;
+}
+
+void dcore_buffer_discard(dowel_arena_t* arena, dowel_buffer_t* buffer) {
+    if (arena) {
+        dcore_free_in(arena, buffer);
+    } else {
+        dowel_free_buffer(buffer);
+    }
+}
+
+void dowel_free_buffer(dowel_buffer_t* buffer) {
+    if (!buffer) return;
+    free(buffer->data);
+    free(buffer);
+}
+
+void dowel_free_string(char* string) {
+    free(string);
+}
+
+void dowel_free_string_array(char** strings, size_t count) {
+    if (!strings) return;
+    for (size_t i = 0; i < count; i++) {
+        free(strings[i]);
+    }
+    free(strings);
+}
+
+// Error handling
+const char* dowel_error_get_message(int error_code) {
+    switch (error_code) {
+        case DOWEL_SUCCESS: return "Success";
+        case DOWEL_ERROR_INIT_FAILED: return "Initialization failed";
+        case DOWEL_ERROR_NOT_INITIALIZED: return "Not initialized";
+        case DOWEL_ERROR_INVALID_PARAMETER: return "Invalid parameter";
+        case DOWEL_ERROR_OUT_OF_MEMORY: return "Out of memory";
+        case DOWEL_ERROR_SYSTEM_ERROR: return "System error";
+        case DOWEL_ERROR_NETWORK_ERROR: return "Network error";
+        case DOWEL_ERROR_STORAGE_ERROR: return "Storage error";
+        case DOWEL_ERROR_CONFIG_ERROR: return "Configuration error";
+        case DOWEL_ERROR_CRYPTO_ERROR: return "Crypto error";
+        case DOWEL_ERROR_SENSOR_ERROR: return "Sensor error";
+        case DOWEL_ERROR_POWER_ERROR: return "Power error";
+        case DOWEL_ERROR_NOTIFICATION_ERROR: return "Notification error";
+        default: return "Unknown error";
+    }
+}
+
+void dowel_error_set_callback(void (*callback)(int error_code, const char* message)) {
+    atomic_store(&error_callback, callback);
+}
+
+void dcore_report_error(int error_code, const char* message) {
+    void (*callback)(int, const char*) = atomic_load(&error_callback);
+    if (callback) {
+        callback(error_code, message ? message : dowel_error_get_message(error_code));
+    }
+}
+
+// Time utilities
+int64_t dcore_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+int64_t dowel_time_now_timestamp(void) {
+    return (int64_t)time(NULL);
+}
+
+int64_t dowel_time_now_timestamp_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (int64_t)ts.tv_sec * 1000LL + ts.tv_nsec / 1000000LL;
+}
+
+const char* dowel_time_format_iso8601(int64_t timestamp) {
+    // Per-thread buffer, valid until the next call on the same thread
+    static _Thread_local char buffer[32];
+    time_t t = (time_t)timestamp;
+    struct tm tm;
+    if (!gmtime_r(&t, &tm)) return NULL;
+    strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%SZ", &tm);
+    return buffer;
+}
+
+// Platform detection
+dowel_platform_t dowel_platform_get_current(void) {
+#if defined(__ANDROID__)
+    return DOWEL_PLATFORM_ANDROID;
+#elif defined(__APPLE__) && TARGET_OS_IPHONE
+    return DOWEL_PLATFORM_IOS;
+#elif defined(__APPLE__) || defined(__linux__) || defined(_WIN32)
+    return DOWEL_PLATFORM_DESKTOP;
+#else
+    return DOWEL_PLATFORM_UNKNOWN;
+#endif
+}
+
+bool dowel_platform_is_mobile(void) {
+    dowel_platform_t platform = dowel_platform_get_current();
+    return platform == DOWEL_PLATFORM_ANDROID || platform == DOWEL_PLATFORM_IOS;
+}
+
+bool dowel_platform_is_desktop(void) {
+    return dowel_platform_get_current() == DOWEL_PLATFORM_DESKTOP;
+}
@@ -0,0 +1,189 @@
+#ifndef DOWEL_CORE_INTERNAL_H
+#define DOWEL_CORE_INTERNAL_H
+
+// Helpers shared between the translation units of the C core.
+// Nothing in here is part of the public dowel_steek_core.h API.
+
+#include "dowel_steek_core.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Error reporting - forwards to the callback set with dowel_error_set_callback
+void dcore_report_error(int error_code, const char* message);
+
+// Memory for data returned through the public API. With a NULL arena it comes
+// from malloc so that dowel_free_buffer/dowel_free_string can release it;
+// otherwise it is carved from the caller's arena and released by its reset.
+void* dcore_alloc_in(dowel_arena_t* arena, size_t size);
+void* dcore_realloc_in(dowel_arena_t* arena, void* ptr, size_t old_size, size_t new_size);
+void dcore_free_in(dowel_arena_t* arena, void* ptr);
+
+// dcore_buffer_adopt takes data allocated with dcore_alloc_in on the same arena
+dowel_buffer_t* dcore_buffer_new(dowel_arena_t* arena, size_t size);
+dowel_buffer_t* dcore_buffer_adopt(dowel_arena_t* arena, uint8_t* data, size_t size);
+void dcore_buffer_discard(dowel_arena_t* arena, dowel_buffer_t* buffer);
+
+// Heap copy of a regular file as a refcounted view, and the bytes the view
+// holds (storage.c)
+dowel_file_view_t* dcore_file_view_read(const char* path);
+size_t dcore_file_view_footprint(const dowel_file_view_t* view);
+
+// I/O totals for dowel_storage_get_metrics (storage.c)
+void dcore_storage_count_read(size_t bytes);
+void dcore_storage_count_write(size_t bytes);
+
+// Crash injection for tests: a durable write that reaches the chosen point
+// calls _exit(DCORE_CRASH_EXIT_CODE) there (durable_write.c)
+enum {
+    DCORE_CRASH_NONE = 0,
+    DCORE_CRASH_AFTER_TEMP_WRITE = 1, // temp file written, nothing synced
+    DCORE_CRASH_AFTER_SYNC = 2,       // temp file synced, not yet renamed
+    DCORE_CRASH_AFTER_RENAME = 3,     // renamed, directory not yet synced
+};
+#define DCORE_CRASH_EXIT_CODE 86
+void dcore_storage_set_crash_point(int point);
+
+// Called once this API has written, created or removed path: drops the
+// cached contents and updates the metadata index (storage.c)
+void dcore_storage_changed(const char* path);
+
+// Metadata index answers for file_exists/get_file_size/get_file_modtime;
+// UNKNOWN means stat the path (meta_index.c)
+enum {
+    DCORE_INDEX_UNKNOWN = 0,
+    DCORE_INDEX_FOUND = 1,
+    DCORE_INDEX_ABSENT = 2,
+};
+int dcore_meta_index_lookup(const char* path, int64_t* size, int64_t* modtime);
+void dcore_meta_index_refresh(const char* path);
+void dcore_meta_index_shutdown(void);
+
+// Drops a path from the file cache once it has been written or removed, and
+// adds the cache counters to a metrics snapshot (file_cache.c)
+void dcore_file_cache_invalidate(const char* path);
+void dcore_file_cache_add_metrics(dowel_storage_metrics_t* metrics);
+void dcore_file_cache_shutdown(void);
+
+// AES-256-GCM with a caller-chosen nonce, for formats that seal data in
+// segments (crypto.c). seal writes size + DCORE_GCM_TAG_SIZE bytes; open
+// takes the sealed size and returns false if the tag does not match.
+#define DCORE_GCM_NONCE_SIZE 12
+#define DCORE_GCM_TAG_SIZE 16
+typedef struct dcore_gcm dcore_gcm_t;
+dcore_gcm_t* dcore_gcm_new(const dowel_crypto_key_t* key);
+void dcore_gcm_seal(const dcore_gcm_t* gcm, const uint8_t nonce[DCORE_GCM_NONCE_SIZE],
+                    const uint8_t* in, size_t size, uint8_t* out);
+bool dcore_gcm_open(const dcore_gcm_t* gcm, const uint8_t nonce[DCORE_GCM_NONCE_SIZE],
+                    const uint8_t* in, size_t size, uint8_t* out);
+void dcore_gcm_free(dcore_gcm_t* gcm);
+int dcore_crypto_random(uint8_t* out, size_t size);
+
+// CPU features that SIMD kernels are chosen by (cpu.c). dcore_cpu_restrict
+// masks features off, so tests can run the fallbacks; pass UINT32_MAX to undo.
+enum {
+    DCORE_CPU_SSE2 = 1 << 0,
+    DCORE_CPU_AVX2 = 1 << 1,
+    DCORE_CPU_NEON = 1 << 2,
+    DCORE_CPU_AES = 1 << 3,    // AES-NI, or the ARMv8 AES instructions
+    DCORE_CPU_CLMUL = 1 << 4,  // PCLMULQDQ, or ARMv8 PMULL
+    DCORE_CPU_SHA256 = 1 << 5, // SHA-NI, or the ARMv8 SHA2 instructions
+    DCORE_CPU_VAES = 1 << 6,   // AES on 256-bit registers (with AVX2)
+};
+uint32_t dcore_cpu_features(void);
+void dcore_cpu_restrict(uint32_t features);
+
+// JSON pieces shared by the tape parser and on-demand mode (json.c).
+// dcore_json_structure writes the positions of structural characters,
+// opening quotes and scalar starts (out needs length + 1 slots) and sets
+// closed to false if a string runs off the end. dcore_json_unescape decodes
+// the escape at *src into out (up to 4 bytes), advances *src past it and
+// returns the bytes written, 0 if it is invalid. dcore_json_scalar reads a
+// literal or number at s, which must be followed by a delimiter or NUL.
+// dcore_json_float_to_int truncates, saturating outside the int64 range.
+enum {
+    DCORE_JSON_INVALID = 0,
+    DCORE_JSON_NULL,
+    DCORE_JSON_TRUE,
+    DCORE_JSON_FALSE,
+    DCORE_JSON_INT,
+    DCORE_JSON_FLOAT,
+};
+size_t dcore_json_structure(const char* input, size_t length, uint32_t* out, bool* closed);
+size_t dcore_json_unescape(const char** src, const char* end, char* out);
+int dcore_json_scalar(const char* s, int64_t* integer, double* number);
+int64_t dcore_json_float_to_int(double number);
+
+// JSON output shared by dowel_json_stringify and the writer. dcore_json_escape
+// writes the string's escaped contents without quotes (out needs 6 bytes per
+// input byte, json.c). The format functions write a number's shortest text
+// that reads back exactly, without a NUL; value must be finite (json_writer.c).
+#define DCORE_JSON_NUMBER_MAX 32
+size_t dcore_json_escape(const char* s, size_t length, char* out);
+size_t dcore_json_format_int(int64_t value, char* out);
+size_t dcore_json_format_double(double value, char* out);
+
+// LZ4 block format with optional history in front of the input (lz4.c).
+// compress needs dcore_lz4_bound(size) bytes at dst and returns the block
+// size, 0 if out of memory. decompress returns the bytes written, -1 if the
+// block is corrupt or needs more than capacity; with partial it stops after
+// the first capacity bytes instead.
+size_t dcore_lz4_bound(size_t size);
+size_t dcore_lz4_compress(const uint8_t* dict, size_t dict_size, const uint8_t* src, size_t size, uint8_t* dst,
+                          int level);
+int64_t dcore_lz4_decompress(const uint8_t* dict, size_t dict_size, const uint8_t* src, size_t size, uint8_t* dst,
+                             size_t capacity, bool partial);
+
+// Block by block compression where each block may refer to the 64 KB before
+// it, keeping its tables between blocks. reset starts a new, unrelated
+// stream; blocks are at most DCORE_LZ4_BLOCK_MAX bytes.
+#define DCORE_LZ4_BLOCK_MAX (64 * 1024)
+typedef struct dcore_lz4_stream dcore_lz4_stream_t;
+dcore_lz4_stream_t* dcore_lz4_stream_new(int level);
+void dcore_lz4_stream_free(dcore_lz4_stream_t* stream);
+void dcore_lz4_stream_reset(dcore_lz4_stream_t* stream);
+size_t dcore_lz4_stream_compress(dcore_lz4_stream_t* stream, const uint8_t* src, size_t size, uint8_t* dst);
+
+// XXH32, whole or in pieces, for LZ4 frame checksums (lz4.c)
+typedef struct {
+    uint32_t v[4];
+    uint64_t total;
+    uint8_t buffer[16];
+    uint32_t buffered;
+} dcore_xxh32_t;
+void dcore_xxh32_init(dcore_xxh32_t* state, uint32_t seed);
+void dcore_xxh32_update(dcore_xxh32_t* state, const uint8_t* data, size_t size);
+uint32_t dcore_xxh32_digest(const dcore_xxh32_t* state);
+uint32_t dcore_xxh32(const uint8_t* data, size_t size, uint32_t seed);
+
+// Codec frames written and read in place, for the block archives
+// (compress.c). resolve validates the options and fills in defaults, reporting
+// any error; write needs dcore_frame_bound bytes and returns the frame size,
+// 0 on failure; read needs out_size to be the frame's exact content size and
+// decodes at least the first prefix bytes (all of them for zstd). max_content
+// is the most a payload of size bytes can decode to with codec, or with any
+// codec if it is not a valid one; frames claiming more are rejected.
+bool dcore_compress_resolve(const dowel_compress_options_t* options, size_t size, dowel_compress_options_t* resolved);
+size_t dcore_frame_bound(dowel_codec_t codec, size_t size);
+size_t dcore_frame_write(const dowel_compress_options_t* resolved, const uint8_t* data, size_t size, uint8_t* out,
+                         size_t capacity);
+int dcore_frame_read(const uint8_t* frame, size_t size, const dowel_compress_dict_t* dict, uint8_t* out,
+                     size_t out_size, size_t prefix);
+size_t dcore_frame_max_content(dowel_codec_t codec, size_t size);
+
+// Drains queued tasks and joins the async workers (async.c)
+void dcore_async_shutdown(void);
+
+// Failure injection for tests: once count more tasks have been created, the
+// next task creation fails; -1 disarms it (async.c)
+void dcore_async_fail_task_after(int count);
+
+// Monotonic clock used for metrics and timeouts
+int64_t dcore_now_ns(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DOWEL_CORE_INTERNAL_H
@@ -0,0 +1,60 @@
+#define _GNU_SOURCE
+#include <pthread.h>
+#if defined(__aarch64__) && defined(__linux__)
+#include <sys/auxv.h>
+#endif
+
+#include "core_internal.h"
+
+// CPU features for choosing SIMD kernels at runtime. Detection runs once;
+// dcore_cpu_restrict lets tests switch features off to cover the portable
+// paths.
+
+#if defined(__aarch64__) && defined(__linux__)
+// Bits of AT_HWCAP, in case the libc headers predate them
+#ifndef HWCAP_AES
+#define HWCAP_AES (1 << 3)
+#endif
+#ifndef HWCAP_PMULL
+#define HWCAP_PMULL (1 << 4)
+#endif
+#ifndef HWCAP_SHA2
+#define HWCAP_SHA2 (1 << 6)
+#endif
+#endif
+
+static pthread_once_t detect_once = PTHREAD_ONCE_INIT;
+static uint32_t detected;
+static uint32_t allowed = UINT32_MAX;
+
+static void detect(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2")) detected |= DCORE_CPU_SSE2;
+    if (__builtin_cpu_supports("avx2")) detected |= DCORE_CPU_AVX2;
+    if (__builtin_cpu_supports("aes") && __builtin_cpu_supports("ssse3")) detected |= DCORE_CPU_AES;
+    if (__builtin_cpu_supports("pclmul") && __builtin_cpu_supports("ssse3")) detected |= DCORE_CPU_CLMUL;
+    if (__builtin_cpu_supports("sha") && __builtin_cpu_supports("sse4.1")) detected |= DCORE_CPU_SHA256;
+    if (__builtin_cpu_supports("vaes") && __builtin_cpu_supports("avx2")) detected |= DCORE_CPU_VAES;
+#elif defined(__aarch64__)
+    detected |= DCORE_CPU_NEON;
+#if defined(__linux__)
+    unsigned long hwcap = getauxval(AT_HWCAP);
+    if (hwcap & HWCAP_AES) detected |= DCORE_CPU_AES;
+    if (hwcap & HWCAP_PMULL) detected |= DCORE_CPU_CLMUL;
+    if (hwcap & HWCAP_SHA2) detected |= DCORE_CPU_SHA256;
+#elif defined(__APPLE__)
+    // Every Apple arm64 core has the crypto extensions
+    detected |= DCORE_CPU_AES | DCORE_CPU_CLMUL | DCORE_CPU_SHA256;
+#endif
+#endif
+}
+
+uint32_t dcore_cpu_features(void) {
+    pthread_once(&detect_once, detect);
+    return detected & __atomic_load_n(&allowed, __ATOMIC_RELAXED);
+}
+
+void dcore_cpu_restrict(uint32_t features) {
+    __atomic_store_n(&allowed, features, __ATOMIC_RELAXED);
+}
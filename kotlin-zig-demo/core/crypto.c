@@ -0,0 +1,874 @@
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/random.h>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+#include "core_internal.h"
+
+// Crypto functions
+// SHA-256 and AES-256-GCM. Encrypted buffers are laid out as
+// nonce (12 bytes) || ciphertext || tag (16 bytes).
+//
+//  - Each primitive has a portable C kernel and, chosen per call from the
+//    CPU features, hardware ones: SHA-NI or the ARMv8 SHA2 instructions for
+//    SHA-256; AES-NI (VAES on 256-bit registers where present) or ARMv8 AES
+//    for the GCM counter stream; PCLMULQDQ or PMULL for GHASH.
+//  - A GCM key keeps its round keys and the GHASH key H. With a carry-less
+//    multiply it also keeps H^1..H^8, so GHASH folds eight blocks into one
+//    reduction.
+
+#define SHA256_DIGEST_SIZE 32
+#define AES256_KEY_SIZE 32
+#define GCM_NONCE_SIZE 12
+#define GCM_TAG_SIZE 16
+
+static int fill_random(uint8_t* out, size_t size) {
+    while (size > 0) {
+        ssize_t n = getrandom(out, size, 0);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return DOWEL_ERROR_CRYPTO_ERROR;
+        }
+        out += n;
+        size -= (size_t)n;
+    }
+    return DOWEL_SUCCESS;
+}
+
+// SHA-256
+
+static const uint32_t sha256_k[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+#define ROTR32(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+static uint32_t load_be32(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static void store_be32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+}
+
+static void sha256_compress_portable(uint32_t state[8], const uint8_t* block, size_t blocks) {
+    uint32_t w[64];
+
+    while (blocks--) {
+        for (int i = 0; i < 16; i++) w[i] = load_be32(block + i * 4);
+        for (int i = 16; i < 64; i++) {
+            uint32_t s0 = ROTR32(w[i - 15], 7) ^ ROTR32(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            uint32_t s1 = ROTR32(w[i - 2], 17) ^ ROTR32(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+
+        uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+        uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+
+        for (int i = 0; i < 64; i++) {
+            uint32_t s1 = ROTR32(e, 6) ^ ROTR32(e, 11) ^ ROTR32(e, 25);
+            uint32_t ch = (e & f) ^ (~e & g);
+            uint32_t t1 = h + s1 + ch + sha256_k[i] + w[i];
+            uint32_t s0 = ROTR32(a, 2) ^ ROTR32(a, 13) ^ ROTR32(a, 22);
+            uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+            uint32_t t2 = s0 + maj;
+
+            h = g; g = f; f = e; e = d + t1;
+            d = c; c = b; b = a; a = t1 + t2;
+        }
+
+        state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+        state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+        block += 64;
+    }
+}
+
+#if defined(__x86_64__)
+// SHA-NI keeps the state as ABEF and CDGH and does two rounds per
+// instruction; sha256msg1/2 extend the message schedule four words at a time.
+__attribute__((target("sha,sse4.1"))) static void sha256_compress_shani(uint32_t state[8], const uint8_t* block,
+                                                                      size_t blocks) {
+    const __m128i swap = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    __m128i dcba = _mm_loadu_si128((const __m128i*)state);
+    __m128i hgfe = _mm_loadu_si128((const __m128i*)(state + 4));
+    __m128i cdab = _mm_shuffle_epi32(dcba, 0xb1);
+    __m128i efgh = _mm_shuffle_epi32(hgfe, 0x1b);
+    __m128i abef = _mm_alignr_epi8(cdab, efgh, 8);
+    __m128i cdgh = _mm_blend_epi16(efgh, cdab, 0xf0);
+
+    while (blocks--) {
+        __m128i abef_saved = abef, cdgh_saved = cdgh;
+        __m128i msg[4];
+        for (int i = 0; i < 16; i++) {
+            __m128i m;
+            if (i < 4) {
+                m = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(block + 16 * i)), swap);
+            } else {
+                m = _mm_sha256msg1_epu32(msg[i & 3], msg[(i + 1) & 3]);
+                m = _mm_add_epi32(m, _mm_alignr_epi8(msg[(i + 3) & 3], msg[(i + 2) & 3], 4));
+                m = _mm_sha256msg2_epu32(m, msg[(i + 3) & 3]);
+            }
+            msg[i & 3] = m;
+            __m128i wk = _mm_add_epi32(m, _mm_loadu_si128((const __m128i*)(sha256_k + 4 * i)));
+            cdgh = _mm_sha256rnds2_epu32(cdgh, abef, wk);
+            abef = _mm_sha256rnds2_epu32(abef, cdgh, _mm_shuffle_epi32(wk, 0x0e));
+        }
+        abef = _mm_add_epi32(abef, abef_saved);
+        cdgh = _mm_add_epi32(cdgh, cdgh_saved);
+        block += 64;
+    }
+
+    __m128i feba = _mm_shuffle_epi32(abef, 0x1b);
+    __m128i dchg = _mm_shuffle_epi32(cdgh, 0xb1);
+    _mm_storeu_si128((__m128i*)state, _mm_blend_epi16(feba, dchg, 0xf0));
+    _mm_storeu_si128((__m128i*)(state + 4), _mm_alignr_epi8(dchg, feba, 8));
+}
+#elif defined(__aarch64__)
+#if defined(__clang__)
+#define ARM_CRYPTO __attribute__((target("crypto")))
+#else
+#define ARM_CRYPTO __attribute__((target("+crypto")))
+#endif
+
+// sha256h/h2 do four rounds on ABCD and EFGH; su0/su1 extend the schedule
+ARM_CRYPTO static void sha256_compress_ce(uint32_t state[8], const uint8_t* block, size_t blocks) {
+    uint32x4_t abcd = vld1q_u32(state);
+    uint32x4_t efgh = vld1q_u32(state + 4);
+
+    while (blocks--) {
+        uint32x4_t abcd_saved = abcd, efgh_saved = efgh;
+        uint32x4_t msg[4];
+        for (int i = 0; i < 4; i++) msg[i] = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(block + 16 * i)));
+        for (int i = 0; i < 16; i++) {
+            uint32x4_t wk = vaddq_u32(msg[i & 3], vld1q_u32(sha256_k + 4 * i));
+            if (i < 12) {
+                msg[i & 3] = vsha256su1q_u32(vsha256su0q_u32(msg[i & 3], msg[(i + 1) & 3]), msg[(i + 2) & 3],
+                                             msg[(i + 3) & 3]);
+            }
+            uint32x4_t abcd_before = abcd;
+            abcd = vsha256hq_u32(abcd, efgh, wk);
+            efgh = vsha256h2q_u32(efgh, abcd_before, wk);
+        }
+        abcd = vaddq_u32(abcd, abcd_saved);
+        efgh = vaddq_u32(efgh, efgh_saved);
+        block += 64;
+    }
+
+    vst1q_u32(state, abcd);
+    vst1q_u32(state + 4, efgh);
+}
+#endif
+
+static void sha256_compress(uint32_t state[8], const uint8_t* block, size_t blocks) {
+    uint32_t features = dcore_cpu_features();
+#if defined(__x86_64__)
+    if (features & DCORE_CPU_SHA256) return sha256_compress_shani(state, block, blocks);
+#elif defined(__aarch64__)
+    if (features & DCORE_CPU_SHA256) return sha256_compress_ce(state, block, blocks);
+#endif
+    (void)features;
+    sha256_compress_portable(state, block, blocks);
+}
+
+static void sha256(const uint8_t* data, size_t size, uint8_t out[SHA256_DIGEST_SIZE]) {
+    uint32_t state[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+        0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+    };
+
+    size_t full = size / 64;
+    sha256_compress(state, data, full);
+
+    uint8_t tail[128] = {0};
+    size_t rest = size - full * 64;
+    if (rest) memcpy(tail, data + full * 64, rest);
+    tail[rest] = 0x80;
+
+    size_t tail_blocks = (rest + 9 > 64) ? 2 : 1;
+    uint64_t bits = (uint64_t)size * 8;
+    store_be32(tail + tail_blocks * 64 - 8, (uint32_t)(bits >> 32));
+    store_be32(tail + tail_blocks * 64 - 4, (uint32_t)bits);
+    sha256_compress(state, tail, tail_blocks);
+
+    for (int i = 0; i < 8; i++) store_be32(out + i * 4, state[i]);
+}
+
+// AES-256 (encryption direction only, which is all GCM needs)
+
+static const uint8_t aes_sbox[256] = {
+    0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5, 0x30, 0x01, 0x67, 0x2b, 0xfe, 0xd7, 0xab, 0x76,
+    0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0, 0xad, 0xd4, 0xa2, 0xaf, 0x9c, 0xa4, 0x72, 0xc0,
+    0xb7, 0xfd, 0x93, 0x26, 0x36, 0x3f, 0xf7, 0xcc, 0x34, 0xa5, 0xe5, 0xf1, 0x71, 0xd8, 0x31, 0x15,
+    0x04, 0xc7, 0x23, 0xc3, 0x18, 0x96, 0x05, 0x9a, 0x07, 0x12, 0x80, 0xe2, 0xeb, 0x27, 0xb2, 0x75,
+    0x09, 0x83, 0x2c, 0x1a, 0x1b, 0x6e, 0x5a, 0xa0, 0x52, 0x3b, 0xd6, 0xb3, 0x29, 0xe3, 0x2f, 0x84,
+    0x53, 0xd1, 0x00, 0xed, 0x20, 0xfc, 0xb1, 0x5b, 0x6a, 0xcb, 0xbe, 0x39, 0x4a, 0x4c, 0x58, 0xcf,
+    0xd0, 0xef, 0xaa, 0xfb, 0x43, 0x4d, 0x33, 0x85, 0x45, 0xf9, 0x02, 0x7f, 0x50, 0x3c, 0x9f, 0xa8,
+    0x51, 0xa3, 0x40, 0x8f, 0x92, 0x9d, 0x38, 0xf5, 0xbc, 0xb6, 0xda, 0x21, 0x10, 0xff, 0xf3, 0xd2,
+    0xcd, 0x0c, 0x13, 0xec, 0x5f, 0x97, 0x44, 0x17, 0xc4, 0xa7, 0x7e, 0x3d, 0x64, 0x5d, 0x19, 0x73,
+    0x60, 0x81, 0x4f, 0xdc, 0x22, 0x2a, 0x90, 0x88, 0x46, 0xee, 0xb8, 0x14, 0xde, 0x5e, 0x0b, 0xdb,
+    0xe0, 0x32, 0x3a, 0x0a, 0x49, 0x06, 0x24, 0x5c, 0xc2, 0xd3, 0xac, 0x62, 0x91, 0x95, 0xe4, 0x79,
+    0xe7, 0xc8, 0x37, 0x6d, 0x8d, 0xd5, 0x4e, 0xa9, 0x6c, 0x56, 0xf4, 0xea, 0x65, 0x7a, 0xae, 0x08,
+    0xba, 0x78, 0x25, 0x2e, 0x1c, 0xa6, 0xb4, 0xc6, 0xe8, 0xdd, 0x74, 0x1f, 0x4b, 0xbd, 0x8b, 0x8a,
+    0x70, 0x3e, 0xb5, 0x66, 0x48, 0x03, 0xf6, 0x0e, 0x61, 0x35, 0x57, 0xb9, 0x86, 0xc1, 0x1d, 0x9e,
+    0xe1, 0xf8, 0x98, 0x11, 0x69, 0xd9, 0x8e, 0x94, 0x9b, 0x1e, 0x87, 0xe9, 0xce, 0x55, 0x28, 0xdf,
+    0x8c, 0xa1, 0x89, 0x0d, 0xbf, 0xe6, 0x42, 0x68, 0x41, 0x99, 0x2d, 0x0f, 0xb0, 0x54, 0xbb, 0x16,
+};
+
+#define AES256_ROUNDS 14
+
+typedef struct {
+    uint8_t round_keys[(AES256_ROUNDS + 1) * 16];
+} aes256_ctx_t;
+
+static void aes256_expand_key(aes256_ctx_t* ctx, const uint8_t key[AES256_KEY_SIZE]) {
+    uint8_t* rk = ctx->round_keys;
+    memcpy(rk, key, AES256_KEY_SIZE);
+
+    uint8_t rcon = 0x01;
+    for (int i = 8; i < 4 * (AES256_ROUNDS + 1); i++) {
+        uint8_t t[4];
+        memcpy(t, rk + (i - 1) * 4, 4);
+
+        if (i % 8 == 0) {
+            uint8_t first = t[0];
+            t[0] = aes_sbox[t[1]] ^ rcon;
+            t[1] = aes_sbox[t[2]];
+            t[2] = aes_sbox[t[3]];
+            t[3] = aes_sbox[first];
+            rcon = (uint8_t)((rcon << 1) ^ ((rcon & 0x80) ? 0x1b : 0));
+        } else if (i % 8 == 4) {
+            for (int j = 0; j < 4; j++) t[j] = aes_sbox[t[j]];
+        }
+
+        for (int j = 0; j < 4; j++) rk[i * 4 + j] = rk[(i - 8) * 4 + j] ^ t[j];
+    }
+}
+
+static uint8_t xtime(uint8_t x) {
+    return (uint8_t)((x << 1) ^ ((x & 0x80) ? 0x1b : 0));
+}
+
+static void aes256_encrypt_block(const aes256_ctx_t* ctx, const uint8_t in[16], uint8_t out[16]) {
+    uint8_t s[16];
+    for (int i = 0; i < 16; i++) s[i] = in[i] ^ ctx->round_keys[i];
+
+    for (int round = 1; round <= AES256_ROUNDS; round++) {
+        // SubBytes + ShiftRows
+        uint8_t t[16];
+        for (int c = 0; c < 4; c++) {
+            for (int r = 0; r < 4; r++) {
+                t[c * 4 + r] = aes_sbox[s[((c + r) % 4) * 4 + r]];
+            }
+        }
+
+        // MixColumns (skipped in the final round)
+        if (round != AES256_ROUNDS) {
+            for (int c = 0; c < 4; c++) {
+                uint8_t* col = t + c * 4;
+                uint8_t a0 = col[0], a1 = col[1], a2 = col[2], a3 = col[3];
+                uint8_t all = a0 ^ a1 ^ a2 ^ a3;
+                col[0] ^= all ^ xtime(a0 ^ a1);
+                col[1] ^= all ^ xtime(a1 ^ a2);
+                col[2] ^= all ^ xtime(a2 ^ a3);
+                col[3] ^= all ^ xtime(a3 ^ a0);
+            }
+        }
+
+        const uint8_t* rk = ctx->round_keys + round * 16;
+        for (int i = 0; i < 16; i++) s[i] = t[i] ^ rk[i];
+    }
+
+    memcpy(out, s, 16);
+}
+
+// GCM
+
+#define GHASH_STRIDE 8
+
+typedef struct {
+    uint64_t hi, lo;
+} gf128_t;
+
+// An expanded AES-256-GCM key
+typedef struct {
+    aes256_ctx_t aes;
+    gf128_t h;
+    bool has_powers;
+    uint8_t h_powers[GHASH_STRIDE][16]; // H^8 down to H^1, byte reversed for the carry-less kernels
+} gcm_key_t;
+
+static uint64_t load_be64(const uint8_t* p) {
+    return ((uint64_t)load_be32(p) << 32) | load_be32(p + 4);
+}
+
+static void store_be64(uint8_t* p, uint64_t v) {
+    store_be32(p, (uint32_t)(v >> 32));
+    store_be32(p + 4, (uint32_t)v);
+}
+
+static gf128_t gf128_mul(gf128_t x, gf128_t h) {
+    gf128_t z = {0, 0};
+    gf128_t v = h;
+
+    for (int i = 0; i < 128; i++) {
+        uint64_t bit = (i < 64) ? (x.hi >> (63 - i)) & 1 : (x.lo >> (127 - i)) & 1;
+        uint64_t mask = 0 - bit;
+        z.hi ^= v.hi & mask;
+        z.lo ^= v.lo & mask;
+
+        uint64_t carry = v.lo & 1;
+        v.lo = (v.lo >> 1) | (v.hi << 63);
+        v.hi = (v.hi >> 1) ^ ((0 - carry) & 0xe100000000000000ULL);
+    }
+    return z;
+}
+
+static void ghash_update(gf128_t* acc, gf128_t h, const uint8_t* data, size_t size) {
+    while (size > 0) {
+        uint8_t block[16] = {0};
+        size_t n = size < 16 ? size : 16;
+        memcpy(block, data, n);
+
+        acc->hi ^= load_be64(block);
+        acc->lo ^= load_be64(block + 8);
+        *acc = gf128_mul(*acc, h);
+
+        data += n;
+        size -= n;
+    }
+}
+
+// GHASH of the ciphertext and then the lengths block (there is never
+// associated data)
+static void ghash_portable(const gcm_key_t* key, const uint8_t* data, size_t size, uint8_t out[16]) {
+    gf128_t acc = {0, 0};
+    ghash_update(&acc, key->h, data, size);
+
+    uint8_t lengths[16] = {0};
+    store_be64(lengths + 8, (uint64_t)size * 8);
+    ghash_update(&acc, key->h, lengths, 16);
+
+    store_be64(out, acc.hi);
+    store_be64(out + 8, acc.lo);
+}
+
+// XORs the keystream for nonce || counter, counter + 1, ... into the data
+static void ctr_xor_portable(const aes256_ctx_t* aes, const uint8_t nonce[GCM_NONCE_SIZE], uint32_t counter,
+                             const uint8_t* in, uint8_t* out, size_t size) {
+    uint8_t block[16];
+    memcpy(block, nonce, GCM_NONCE_SIZE);
+
+    while (size > 0) {
+        uint8_t keystream[16];
+        store_be32(block + 12, counter++);
+        aes256_encrypt_block(aes, block, keystream);
+
+        size_t n = size < 16 ? size : 16;
+        for (size_t i = 0; i < n; i++) out[i] = in[i] ^ keystream[i];
+
+        in += n;
+        out += n;
+        size -= n;
+    }
+}
+
+#if defined(__x86_64__)
+// AES-NI takes the FIPS-197 round keys as they are. Eight counter blocks
+// are in flight at once to cover the latency of aesenc.
+__attribute__((target("aes,ssse3"))) static void ctr_xor_aesni(const aes256_ctx_t* aes,
+                                                              const uint8_t nonce[GCM_NONCE_SIZE], uint32_t counter,
+                                                              const uint8_t* in, uint8_t* out, size_t size) {
+    __m128i rk[AES256_ROUNDS + 1];
+    for (int i = 0; i <= AES256_ROUNDS; i++) rk[i] = _mm_loadu_si128((const __m128i*)(aes->round_keys + 16 * i));
+    uint8_t prefix[16] = {0};
+    memcpy(prefix, nonce, GCM_NONCE_SIZE);
+    __m128i base = _mm_loadu_si128((const __m128i*)prefix);
+    // The counter counts in the last lane and is byte swapped into place
+    const __m128i swap = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 15, 14, 13, 12);
+    const __m128i one = _mm_setr_epi32(0, 0, 0, 1);
+    __m128i ctr = _mm_setr_epi32(0, 0, 0, (int)counter);
+
+    while (size > 0) {
+        __m128i b[8];
+        size_t blocks = size >= 128 ? 8 : (size + 15) / 16;
+        for (size_t i = 0; i < blocks; i++) {
+            b[i] = _mm_xor_si128(_mm_or_si128(base, _mm_shuffle_epi8(ctr, swap)), rk[0]);
+            ctr = _mm_add_epi32(ctr, one);
+        }
+        for (int r = 1; r < AES256_ROUNDS; r++) {
+            for (size_t i = 0; i < blocks; i++) b[i] = _mm_aesenc_si128(b[i], rk[r]);
+        }
+        for (size_t i = 0; i < blocks; i++) {
+            b[i] = _mm_aesenclast_si128(b[i], rk[AES256_ROUNDS]);
+            if (size >= 16) {
+                _mm_storeu_si128((__m128i*)out, _mm_xor_si128(b[i], _mm_loadu_si128((const __m128i*)in)));
+                in += 16;
+                out += 16;
+                size -= 16;
+            } else {
+                uint8_t keystream[16];
+                _mm_storeu_si128((__m128i*)keystream, b[i]);
+                for (size_t j = 0; j < size; j++) out[j] = in[j] ^ keystream[j];
+                size = 0;
+            }
+        }
+    }
+}
+
+// VAES runs the same rounds on two blocks per 256-bit register
+__attribute__((target("vaes,avx2,aes"))) static void ctr_xor_vaes(const aes256_ctx_t* aes,
+                                                                 const uint8_t nonce[GCM_NONCE_SIZE], uint32_t counter,
+                                                                 const uint8_t* in, uint8_t* out, size_t size) {
+    __m256i rk[AES256_ROUNDS + 1];
+    for (int i = 0; i <= AES256_ROUNDS; i++) {
+        rk[i] = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)(aes->round_keys + 16 * i)));
+    }
+    uint8_t prefix[16] = {0};
+    memcpy(prefix, nonce, GCM_NONCE_SIZE);
+    __m256i base = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)prefix));
+    const __m256i swap = _mm256_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 15, 14, 13, 12,
+                                          -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 15, 14, 13, 12);
+    const __m256i two = _mm256_setr_epi32(0, 0, 0, 2, 0, 0, 0, 2);
+    __m256i ctr = _mm256_setr_epi32(0, 0, 0, (int)counter, 0, 0, 0, (int)(counter + 1));
+
+    while (size >= 256) {
+        __m256i b[8];
+        for (int i = 0; i < 8; i++) {
+            b[i] = _mm256_xor_si256(_mm256_or_si256(base, _mm256_shuffle_epi8(ctr, swap)), rk[0]);
+            ctr = _mm256_add_epi32(ctr, two);
+        }
+        for (int r = 1; r < AES256_ROUNDS; r++) {
+            for (int i = 0; i < 8; i++) b[i] = _mm256_aesenc_epi128(b[i], rk[r]);
+        }
+        for (int i = 0; i < 8; i++) {
+            b[i] = _mm256_aesenclast_epi128(b[i], rk[AES256_ROUNDS]);
+            _mm256_storeu_si256((__m256i*)(out + 32 * i),
+                                _mm256_xor_si256(b[i], _mm256_loadu_si256((const __m256i*)(in + 32 * i))));
+        }
+        in += 256;
+        out += 256;
+        size -= 256;
+        counter += 16;
+    }
+    if (size > 0) ctr_xor_aesni(aes, nonce, counter, in, out, size);
+}
+
+// Carry-less multiplication on byte reversed blocks, after the Intel
+// white paper on GCM: a 256-bit product, then a shift by one bit (the
+// blocks are bit reflected) and reduction modulo x^128 + x^7 + x^2 + x + 1.
+// Products can be summed before the reduction.
+__attribute__((target("pclmul,ssse3"))) static inline void clmul_wide(__m128i a, __m128i b, __m128i* lo, __m128i* hi) {
+    __m128i low = _mm_clmulepi64_si128(a, b, 0x00);
+    __m128i high = _mm_clmulepi64_si128(a, b, 0x11);
+    __m128i middle = _mm_xor_si128(_mm_clmulepi64_si128(a, b, 0x10), _mm_clmulepi64_si128(a, b, 0x01));
+    *lo = _mm_xor_si128(*lo, _mm_xor_si128(low, _mm_slli_si128(middle, 8)));
+    *hi = _mm_xor_si128(*hi, _mm_xor_si128(high, _mm_srli_si128(middle, 8)));
+}
+
+__attribute__((target("pclmul,ssse3"))) static inline __m128i clmul_reduce(__m128i lo, __m128i hi) {
+    __m128i carry_lo = _mm_srli_epi32(lo, 31);
+    __m128i carry_hi = _mm_srli_epi32(hi, 31);
+    __m128i cross = _mm_srli_si128(carry_lo, 12);
+    lo = _mm_or_si128(_mm_slli_epi32(lo, 1), _mm_slli_si128(carry_lo, 4));
+    hi = _mm_or_si128(_mm_or_si128(_mm_slli_epi32(hi, 1), _mm_slli_si128(carry_hi, 4)), cross);
+
+    __m128i t = _mm_xor_si128(_mm_xor_si128(_mm_slli_epi32(lo, 31), _mm_slli_epi32(lo, 30)), _mm_slli_epi32(lo, 25));
+    __m128i t_high = _mm_srli_si128(t, 4);
+    lo = _mm_xor_si128(lo, _mm_slli_si128(t, 12));
+    __m128i r = _mm_xor_si128(_mm_xor_si128(_mm_srli_epi32(lo, 1), _mm_srli_epi32(lo, 2)),
+                              _mm_xor_si128(_mm_srli_epi32(lo, 7), t_high));
+    return _mm_xor_si128(hi, _mm_xor_si128(lo, r));
+}
+
+__attribute__((target("pclmul,ssse3"))) static inline __m128i clmul_mul(__m128i a, __m128i b) {
+    __m128i lo = _mm_setzero_si128(), hi = _mm_setzero_si128();
+    clmul_wide(a, b, &lo, &hi);
+    return clmul_reduce(lo, hi);
+}
+
+__attribute__((target("pclmul,ssse3"))) static void ghash_powers_clmul(gcm_key_t* key, const uint8_t h_bytes[16]) {
+    const __m128i reverse = _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+    __m128i h = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)h_bytes), reverse);
+    __m128i power = h;
+    for (int i = GHASH_STRIDE - 1; i >= 0; i--) {
+        _mm_storeu_si128((__m128i*)key->h_powers[i], power);
+        power = clmul_mul(power, h);
+    }
+}
+
+__attribute__((target("pclmul,ssse3"))) static void ghash_clmul(const gcm_key_t* key, const uint8_t* data, size_t size,
+                                                               uint8_t out[16]) {
+    const __m128i reverse = _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+    __m128i h[GHASH_STRIDE];
+    for (int i = 0; i < GHASH_STRIDE; i++) h[i] = _mm_loadu_si128((const __m128i*)key->h_powers[i]);
+    uint64_t bits = (uint64_t)size * 8;
+
+    // X1..X8 with the running sum folded into X1: (acc + X1)H^8 + X2 H^7 + ... + X8 H
+    __m128i acc = _mm_setzero_si128();
+    while (size >= 16 * GHASH_STRIDE) {
+        __m128i lo = _mm_setzero_si128(), hi = _mm_setzero_si128();
+        for (int i = 0; i < GHASH_STRIDE; i++) {
+            __m128i x = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 16 * i)), reverse);
+            clmul_wide(i == 0 ? _mm_xor_si128(x, acc) : x, h[i], &lo, &hi);
+        }
+        acc = clmul_reduce(lo, hi);
+        data += 16 * GHASH_STRIDE;
+        size -= 16 * GHASH_STRIDE;
+    }
+
+    uint8_t block[16];
+    while (size > 0) {
+        size_t n = size < 16 ? size : 16;
+        memset(block, 0, sizeof(block));
+        memcpy(block, data, n);
+        __m128i x = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)block), reverse);
+        acc = clmul_mul(_mm_xor_si128(acc, x), h[GHASH_STRIDE - 1]);
+        data += n;
+        size -= n;
+    }
+    acc = clmul_mul(_mm_xor_si128(acc, _mm_set_epi64x(0, (long long)bits)), h[GHASH_STRIDE - 1]);
+    _mm_storeu_si128((__m128i*)out, _mm_shuffle_epi8(acc, reverse));
+}
+#elif defined(__aarch64__)
+// aese does AddRoundKey then SubBytes and ShiftRows, aesmc MixColumns
+ARM_CRYPTO static void ctr_xor_ce(const aes256_ctx_t* aes, const uint8_t nonce[GCM_NONCE_SIZE], uint32_t counter,
+                                  const uint8_t* in, uint8_t* out, size_t size) {
+    uint8x16_t rk[AES256_ROUNDS + 1];
+    for (int i = 0; i <= AES256_ROUNDS; i++) rk[i] = vld1q_u8(aes->round_keys + 16 * i);
+    uint8_t block[16];
+    memcpy(block, nonce, GCM_NONCE_SIZE);
+
+    while (size > 0) {
+        uint8x16_t b[4];
+        size_t blocks = size >= 64 ? 4 : (size + 15) / 16;
+        for (size_t i = 0; i < blocks; i++) {
+            store_be32(block + 12, counter++);
+            b[i] = vld1q_u8(block);
+        }
+        for (int r = 0; r < AES256_ROUNDS - 1; r++) {
+            for (size_t i = 0; i < blocks; i++) b[i] = vaesmcq_u8(vaeseq_u8(b[i], rk[r]));
+        }
+        for (size_t i = 0; i < blocks; i++) {
+            b[i] = veorq_u8(vaeseq_u8(b[i], rk[AES256_ROUNDS - 1]), rk[AES256_ROUNDS]);
+            if (size >= 16) {
+                vst1q_u8(out, veorq_u8(b[i], vld1q_u8(in)));
+                in += 16;
+                out += 16;
+                size -= 16;
+            } else {
+                uint8_t keystream[16];
+                vst1q_u8(keystream, b[i]);
+                for (size_t j = 0; j < size; j++) out[j] = in[j] ^ keystream[j];
+                size = 0;
+            }
+        }
+    }
+}
+
+// The x86 GHASH kernel's arithmetic, with PMULL for the carry-less products
+ARM_CRYPTO static inline uint64x2_t load_reversed(const uint8_t* p) {
+    uint8x16_t v = vrev64q_u8(vld1q_u8(p));
+    return vreinterpretq_u64_u8(vextq_u8(v, v, 8));
+}
+
+ARM_CRYPTO static inline void store_reversed(uint8_t* p, uint64x2_t x) {
+    uint8x16_t v = vrev64q_u8(vreinterpretq_u8_u64(x));
+    vst1q_u8(p, vextq_u8(v, v, 8));
+}
+
+ARM_CRYPTO static inline uint64x2_t pmull(uint64_t a, uint64_t b) {
+    return vreinterpretq_u64_p128(vmull_p64((poly64_t)a, (poly64_t)b));
+}
+
+ARM_CRYPTO static inline void pmull_wide(uint64x2_t a, uint64x2_t b, uint64x2_t* lo, uint64x2_t* hi) {
+    uint64_t a0 = vgetq_lane_u64(a, 0), a1 = vgetq_lane_u64(a, 1);
+    uint64_t b0 = vgetq_lane_u64(b, 0), b1 = vgetq_lane_u64(b, 1);
+    uint64x2_t middle = veorq_u64(pmull(a0, b1), pmull(a1, b0));
+    uint64x2_t zero = vdupq_n_u64(0);
+    *lo = veorq_u64(*lo, veorq_u64(pmull(a0, b0), vextq_u64(zero, middle, 1)));
+    *hi = veorq_u64(*hi, veorq_u64(pmull(a1, b1), vextq_u64(middle, zero, 1)));
+}
+
+ARM_CRYPTO static inline uint64x2_t pmull_reduce(uint64x2_t lo64, uint64x2_t hi64) {
+    uint32x4_t lo = vreinterpretq_u32_u64(lo64), hi = vreinterpretq_u32_u64(hi64);
+    uint32x4_t zero = vdupq_n_u32(0);
+    uint32x4_t carry_lo = vshrq_n_u32(lo, 31);
+    uint32x4_t carry_hi = vshrq_n_u32(hi, 31);
+    uint32x4_t cross = vextq_u32(carry_lo, zero, 3);
+    lo = vorrq_u32(vshlq_n_u32(lo, 1), vextq_u32(zero, carry_lo, 3));
+    hi = vorrq_u32(vorrq_u32(vshlq_n_u32(hi, 1), vextq_u32(zero, carry_hi, 3)), cross);
+
+    uint32x4_t t = veorq_u32(veorq_u32(vshlq_n_u32(lo, 31), vshlq_n_u32(lo, 30)), vshlq_n_u32(lo, 25));
+    uint32x4_t t_high = vextq_u32(t, zero, 1);
+    lo = veorq_u32(lo, vextq_u32(zero, t, 1));
+    uint32x4_t r = veorq_u32(veorq_u32(vshrq_n_u32(lo, 1), vshrq_n_u32(lo, 2)), veorq_u32(vshrq_n_u32(lo, 7), t_high));
+    return vreinterpretq_u64_u32(veorq_u32(hi, veorq_u32(lo, r)));
+}
+
+ARM_CRYPTO static inline uint64x2_t pmull_mul(uint64x2_t a, uint64x2_t b) {
+    uint64x2_t lo = vdupq_n_u64(0), hi = vdupq_n_u64(0);
+    pmull_wide(a, b, &lo, &hi);
+    return pmull_reduce(lo, hi);
+}
+
+ARM_CRYPTO static void ghash_powers_pmull(gcm_key_t* key, const uint8_t h_bytes[16]) {
+    uint64x2_t h = load_reversed(h_bytes);
+    uint64x2_t power = h;
+    for (int i = GHASH_STRIDE - 1; i >= 0; i--) {
+        vst1q_u64((uint64_t*)key->h_powers[i], power);
+        power = pmull_mul(power, h);
+    }
+}
+
+ARM_CRYPTO static void ghash_pmull(const gcm_key_t* key, const uint8_t* data, size_t size, uint8_t out[16]) {
+    uint64x2_t h[GHASH_STRIDE];
+    for (int i = 0; i < GHASH_STRIDE; i++) h[i] = vld1q_u64((const uint64_t*)key->h_powers[i]);
+    uint64_t bits = (uint64_t)size * 8;
+
+    uint64x2_t acc = vdupq_n_u64(0);
+    while (size >= 16 * GHASH_STRIDE) {
+        uint64x2_t lo = vdupq_n_u64(0), hi = vdupq_n_u64(0);
+        for (int i = 0; i < GHASH_STRIDE; i++) {
+            uint64x2_t x = load_reversed(data + 16 * i);
+            pmull_wide(i == 0 ? veorq_u64(x, acc) : x, h[i], &lo, &hi);
+        }
+        acc = pmull_reduce(lo, hi);
+        data += 16 * GHASH_STRIDE;
+        size -= 16 * GHASH_STRIDE;
+    }
+
+    uint8_t block[16];
+    while (size > 0) {
+        size_t n = size < 16 ? size : 16;
+        memset(block, 0, sizeof(block));
+        memcpy(block, data, n);
+        acc = pmull_mul(veorq_u64(acc, load_reversed(block)), h[GHASH_STRIDE - 1]);
+        data += n;
+        size -= n;
+    }
+    acc = pmull_mul(veorq_u64(acc, vcombine_u64(vcreate_u64(bits), vcreate_u64(0))), h[GHASH_STRIDE - 1]);
+    store_reversed(out, acc);
+}
+#endif
+
+static void ctr_xor(const aes256_ctx_t* aes, const uint8_t nonce[GCM_NONCE_SIZE], uint32_t counter,
+                    const uint8_t* in, uint8_t* out, size_t size) {
+    uint32_t features = dcore_cpu_features();
+#if defined(__x86_64__)
+    const uint32_t vaes = DCORE_CPU_VAES | DCORE_CPU_AES;
+    if ((features & vaes) == vaes && size >= 256) return ctr_xor_vaes(aes, nonce, counter, in, out, size);
+    if (features & DCORE_CPU_AES) return ctr_xor_aesni(aes, nonce, counter, in, out, size);
+#elif defined(__aarch64__)
+    if (features & DCORE_CPU_AES) return ctr_xor_ce(aes, nonce, counter, in, out, size);
+#endif
+    (void)features;
+    ctr_xor_portable(aes, nonce, counter, in, out, size);
+}
+
+static void ghash(const gcm_key_t* key, const uint8_t* data, size_t size, uint8_t out[16]) {
+#if defined(__x86_64__)
+    if (key->has_powers && (dcore_cpu_features() & DCORE_CPU_CLMUL)) return ghash_clmul(key, data, size, out);
+#elif defined(__aarch64__)
+    if (key->has_powers && (dcore_cpu_features() & DCORE_CPU_CLMUL)) return ghash_pmull(key, data, size, out);
+#endif
+    ghash_portable(key, data, size, out);
+}
+
+static void gcm_key_init(gcm_key_t* key, const uint8_t bytes[AES256_KEY_SIZE]) {
+    static const uint8_t zero[16];
+    uint8_t h[16];
+    aes256_expand_key(&key->aes, bytes);
+    ctr_xor(&key->aes, zero, 0, zero, h, 16); // H is the encrypted zero block
+    key->h = (gf128_t){ load_be64(h), load_be64(h + 8) };
+    key->has_powers = false;
+#if defined(__x86_64__)
+    if (dcore_cpu_features() & DCORE_CPU_CLMUL) {
+        ghash_powers_clmul(key, h);
+        key->has_powers = true;
+    }
+#elif defined(__aarch64__)
+    if (dcore_cpu_features() & DCORE_CPU_CLMUL) {
+        ghash_powers_pmull(key, h);
+        key->has_powers = true;
+    }
+#endif
+}
+
+static void gcm_ctr_xor(const gcm_key_t* key, const uint8_t nonce[GCM_NONCE_SIZE],
+                        const uint8_t* in, uint8_t* out, size_t size) {
+    ctr_xor(&key->aes, nonce, 2, in, out, size); // counter 1 is reserved for the tag
+}
+
+static void gcm_tag(const gcm_key_t* key, const uint8_t nonce[GCM_NONCE_SIZE],
+                    const uint8_t* ciphertext, size_t size, uint8_t tag[GCM_TAG_SIZE]) {
+    static const uint8_t zero[16];
+    uint8_t ek_j0[16];
+    ghash(key, ciphertext, size, tag);
+    ctr_xor(&key->aes, nonce, 1, zero, ek_j0, 16);
+    for (int i = 0; i < GCM_TAG_SIZE; i++) tag[i] ^= ek_j0[i];
+}
+
+// Segment sealing for streams (see core_internal.h)
+
+struct dcore_gcm {
+    gcm_key_t key;
+};
+
+dcore_gcm_t* dcore_gcm_new(const dowel_crypto_key_t* key) {
+    if (!key || key->size != AES256_KEY_SIZE) return NULL;
+    dcore_gcm_t* gcm = malloc(sizeof(*gcm));
+    if (gcm) gcm_key_init(&gcm->key, key->data);
+    return gcm;
+}
+
+void dcore_gcm_seal(const dcore_gcm_t* gcm, const uint8_t nonce[DCORE_GCM_NONCE_SIZE],
+                    const uint8_t* in, size_t size, uint8_t* out) {
+    gcm_ctr_xor(&gcm->key, nonce, in, out, size);
+    gcm_tag(&gcm->key, nonce, out, size, out + size);
+}
+
+bool dcore_gcm_open(const dcore_gcm_t* gcm, const uint8_t nonce[DCORE_GCM_NONCE_SIZE],
+                    const uint8_t* in, size_t size, uint8_t* out) {
+    if (size < GCM_TAG_SIZE) return false;
+    size_t plain_size = size - GCM_TAG_SIZE;
+    uint8_t tag[GCM_TAG_SIZE];
+    gcm_tag(&gcm->key, nonce, in, plain_size, tag);
+
+    uint8_t diff = 0;
+    for (int i = 0; i < GCM_TAG_SIZE; i++) diff |= tag[i] ^ in[plain_size + i];
+    if (diff != 0) return false;
+    gcm_ctr_xor(&gcm->key, nonce, in, out, plain_size);
+    return true;
+}
+
+void dcore_gcm_free(dcore_gcm_t* gcm) {
+    if (!gcm) return;
+    explicit_bzero(gcm, sizeof(*gcm));
+    free(gcm);
+}
+
+int dcore_crypto_random(uint8_t* out, size_t size) {
+    return fill_random(out, size);
+}
+
+// Public API
+
+int dowel_crypto_init(void) {
+    return DOWEL_SUCCESS;
+}
+
+void dowel_crypto_shutdown(void) {
+}
+
+dowel_buffer_t* dowel_crypto_hash_sha256(const uint8_t* data, size_t size) {
+    return dowel_crypto_hash_sha256_in(NULL, data, size);
+}
+
+dowel_buffer_t* dowel_crypto_hash_sha256_in(dowel_arena_t* arena, const uint8_t* data, size_t size) {
+    if (!data && size > 0) return NULL;
+
+    dowel_buffer_t* digest = dcore_buffer_new(arena, SHA256_DIGEST_SIZE);
+    if (!digest) return NULL;
+
+    sha256(data, size, digest->data);
+    return digest;
+}
+
+dowel_crypto_key_t* dowel_crypto_generate_key(void) {
+    dowel_crypto_key_t* key = malloc(sizeof(*key));
+    if (!key) return NULL;
+
+    key->size = AES256_KEY_SIZE;
+    key->data = malloc(AES256_KEY_SIZE);
+    if (!key->data || fill_random(key->data, key->size) != DOWEL_SUCCESS) {
+        free(key->data);
+        free(key);
+        dcore_report_error(DOWEL_ERROR_CRYPTO_ERROR, "Failed to generate key");
+        return NULL;
+    }
+    return key;
+}
+
+dowel_buffer_t* dowel_crypto_encrypt(const dowel_crypto_key_t* key, const uint8_t* data, size_t size) {
+    return dowel_crypto_encrypt_in(NULL, key, data, size);
+}
+
+dowel_buffer_t* dowel_crypto_encrypt_in(dowel_arena_t* arena, const dowel_crypto_key_t* key,
+                                        const uint8_t* data, size_t size) {
+    if (!key || key->size != AES256_KEY_SIZE || (!data && size > 0)) return NULL;
+
+    dowel_buffer_t* out = dcore_buffer_new(arena, GCM_NONCE_SIZE + size + GCM_TAG_SIZE);
+    if (!out) return NULL;
+
+    uint8_t* nonce = out->data;
+    uint8_t* ciphertext = out->data + GCM_NONCE_SIZE;
+    if (fill_random(nonce, GCM_NONCE_SIZE) != DOWEL_SUCCESS) {
+        dcore_buffer_discard(arena, out);
+        return NULL;
+    }
+
+    gcm_key_t gcm;
+    gcm_key_init(&gcm, key->data);
+    gcm_ctr_xor(&gcm, nonce, data, ciphertext, size);
+    gcm_tag(&gcm, nonce, ciphertext, size, ciphertext + size);
+    return out;
+}
+
+dowel_buffer_t* dowel_crypto_decrypt(const dowel_crypto_key_t* key, const uint8_t* encrypted_data, size_t size) {
+    return dowel_crypto_decrypt_in(NULL, key, encrypted_data, size);
+}
+
+dowel_buffer_t* dowel_crypto_decrypt_in(dowel_arena_t* arena, const dowel_crypto_key_t* key,
+                                        const uint8_t* encrypted_data, size_t size) {
+    if (!key || key->size != AES256_KEY_SIZE || !encrypted_data) return NULL;
+    if (size < GCM_NONCE_SIZE + GCM_TAG_SIZE) return NULL;
+
+    const uint8_t* nonce = encrypted_data;
+    const uint8_t* ciphertext = encrypted_data + GCM_NONCE_SIZE;
+    size_t plain_size = size - GCM_NONCE_SIZE - GCM_TAG_SIZE;
+
+    gcm_key_t gcm;
+    gcm_key_init(&gcm, key->data);
+
+    uint8_t tag[GCM_TAG_SIZE];
+    gcm_tag(&gcm, nonce, ciphertext, plain_size, tag);
+
+    uint8_t diff = 0;
+    for (int i = 0; i < GCM_TAG_SIZE; i++) diff |= tag[i] ^ ciphertext[plain_size + i];
+    if (diff != 0) {
+        dcore_report_error(DOWEL_ERROR_CRYPTO_ERROR, "Authentication tag mismatch");
+        return NULL;
+    }
+
+    dowel_buffer_t* out = dcore_buffer_new(arena, plain_size);
+    if (!out) return NULL;
+
+    gcm_ctr_xor(&gcm, nonce, ciphertext, out->data, plain_size);
+    return out;
+}
+
+void dowel_crypto_free_key(dowel_crypto_key_t* key) {
+    if (!key) return;
+    if (key->data) {
+        explicit_bzero(key->data, key->size);
+        free(key->data);
+    }
+    free(key);
+}
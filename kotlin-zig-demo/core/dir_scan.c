@@ -0,0 +1,396 @@
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <fcntl.h>
+#include <fnmatch.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/stat.h>
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
+
+#include "core_internal.h"
+
+// Recursive directory scan - dowel_storage_scan
+//
+//  - Directories wait in one shared queue. The caller reads the root, then
+//    (if it had subdirectories) task pool workers join in; each scanner pops
+//    a directory, reads it and queues the subdirectories it finds. The scan
+//    is over when the queue is empty and no scanner is mid-directory.
+//  - Each scanner appends to its own entry table and path block, so nothing
+//    is shared while reading; the tables are merged into the single result
+//    allocation at the end.
+//  - On Linux directories are read with getdents64 into a per-scanner
+//    buffer (readdir elsewhere). The dirent type decides whether to recurse,
+//    and the name filters run before the stat, so rejected files and
+//    unlisted directories cost no syscall.
+
+#define DIRENT_BUFFER_SIZE (32 * 1024)
+
+typedef struct dir_item {
+    struct dir_item* next;
+    int depth;
+    char path[]; // relative to the root, "" for the root itself
+} dir_item_t;
+
+typedef struct {
+    dowel_scan_entry_t* entries;
+    size_t count;
+    size_t capacity;
+    char* paths;
+    size_t paths_used;
+    size_t paths_capacity;
+    uint8_t dirents[DIRENT_BUFFER_SIZE];
+} scanner_t;
+
+typedef struct {
+    int root_fd;
+    const dowel_scan_options_t* options;
+
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    dir_item_t* queue;
+    int active; // scanners in the middle of a directory
+    bool out_of_memory;
+
+    scanner_t* scanners;
+    int scanner_count;
+    atomic_int next_scanner;
+    atomic_size_t skipped;
+} scan_t;
+
+// Directory reading
+
+typedef struct {
+    int fd;
+#if defined(__linux__)
+    uint8_t* buffer;
+    size_t pos;
+    size_t len;
+#else
+    DIR* dir;
+#endif
+} dir_reader_t;
+
+#if defined(__linux__)
+struct linux_dirent64 {
+    uint64_t d_ino;
+    int64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[];
+};
+#endif
+
+static bool reader_open(dir_reader_t* reader, int fd, scanner_t* scanner) {
+    reader->fd = fd;
+#if defined(__linux__)
+    reader->buffer = scanner->dirents;
+    reader->pos = reader->len = 0;
+    return true;
+#else
+    (void)scanner;
+    reader->dir = fdopendir(fd);
+    return reader->dir != NULL;
+#endif
+}
+
+static void reader_close(dir_reader_t* reader) {
+#if defined(__linux__)
+    close(reader->fd);
+#else
+    if (reader->dir) closedir(reader->dir); else close(reader->fd);
+#endif
+}
+
+// Next entry other than . and ..; false at the end or on an error
+static bool reader_next(dir_reader_t* reader, const char** name, unsigned char* type) {
+    for (;;) {
+#if defined(__linux__)
+        if (reader->pos >= reader->len) {
+            long n = syscall(SYS_getdents64, reader->fd, reader->buffer, DIRENT_BUFFER_SIZE);
+            if (n <= 0) return false;
+            reader->len = (size_t)n;
+            reader->pos = 0;
+        }
+        struct linux_dirent64* entry = (struct linux_dirent64*)(reader->buffer + reader->pos);
+        reader->pos += entry->d_reclen;
+#else
+        struct dirent* entry = readdir(reader->dir);
+        if (!entry) return false;
+#endif
+        const char* d_name = entry->d_name;
+        if (d_name[0] == '.' && (d_name[1] == '\0' || (d_name[1] == '.' && d_name[2] == '\0'))) continue;
+        *name = d_name;
+        *type = entry->d_type;
+        return true;
+    }
+}
+
+// Filters
+
+static bool has_extension(const char* name, const dowel_scan_options_t* options) {
+    const char* dot = strrchr(name, '.');
+    if (!dot || dot == name) return false;
+    for (size_t i = 0; i < options->extension_count; i++) {
+        const char* extension = options->extensions[i];
+        if (extension && extension[0] == '.') extension++;
+        if (extension && strcasecmp(dot + 1, extension) == 0) return true;
+    }
+    return false;
+}
+
+static bool name_matches(const char* name, const dowel_scan_options_t* options) {
+    if (options->pattern && fnmatch(options->pattern, name, 0) != 0) return false;
+    if (options->extension_count > 0 && !has_extension(name, options)) return false;
+    return true;
+}
+
+static uint8_t entry_type(mode_t mode) {
+    if (S_ISREG(mode)) return DOWEL_ENTRY_FILE;
+    if (S_ISDIR(mode)) return DOWEL_ENTRY_DIRECTORY;
+    if (S_ISLNK(mode)) return DOWEL_ENTRY_SYMLINK;
+    return DOWEL_ENTRY_OTHER;
+}
+
+// Per-scanner results
+
+static bool add_entry(scanner_t* scanner, const dir_item_t* dir, const char* name, const struct stat* st) {
+    size_t dir_length = strlen(dir->path);
+    size_t name_length = strlen(name);
+    size_t length = dir_length + (dir_length ? 1 : 0) + name_length;
+    if (length > UINT16_MAX) return true; // not representable; leave it out
+
+    if (scanner->count == scanner->capacity) {
+        size_t capacity = scanner->capacity ? scanner->capacity * 2 : 256;
+        dowel_scan_entry_t* grown = realloc(scanner->entries, capacity * sizeof(*grown));
+        if (!grown) return false;
+        scanner->entries = grown;
+        scanner->capacity = capacity;
+    }
+    if (scanner->paths_used + length + 1 > scanner->paths_capacity) {
+        size_t capacity = scanner->paths_capacity ? scanner->paths_capacity * 2 : 16384;
+        while (capacity < scanner->paths_used + length + 1) capacity *= 2;
+        char* grown = realloc(scanner->paths, capacity);
+        if (!grown) return false;
+        scanner->paths = grown;
+        scanner->paths_capacity = capacity;
+    }
+
+    char* path = scanner->paths + scanner->paths_used;
+    memcpy(path, dir->path, dir_length);
+    if (dir_length) path[dir_length++] = '/';
+    memcpy(path + dir_length, name, name_length + 1);
+
+    dowel_scan_entry_t* entry = &scanner->entries[scanner->count++];
+    entry->size = (int64_t)st->st_size;
+    entry->modtime = (int64_t)st->st_mtime;
+    entry->path_offset = (uint32_t)scanner->paths_used; // rebased when merged
+    entry->path_length = (uint16_t)length;
+    entry->type = entry_type(st->st_mode);
+    entry->depth = dir->depth > UINT8_MAX ? UINT8_MAX : (uint8_t)dir->depth;
+    scanner->paths_used += length + 1;
+    return true;
+}
+
+static dir_item_t* new_item(const dir_item_t* parent, const char* name) {
+    size_t parent_length = strlen(parent->path);
+    size_t name_length = strlen(name);
+    dir_item_t* item = malloc(sizeof(*item) + parent_length + name_length + 2);
+    if (!item) return NULL;
+    memcpy(item->path, parent->path, parent_length);
+    if (parent_length) item->path[parent_length++] = '/';
+    memcpy(item->path + parent_length, name, name_length + 1);
+    item->depth = parent->depth + 1;
+    return item;
+}
+
+// Reads one directory; subdirectories to descend are pushed onto found.
+// Returns false only when out of memory.
+static bool scan_directory(scan_t* scan, scanner_t* scanner, const dir_item_t* dir, dir_item_t** found) {
+    const dowel_scan_options_t* options = scan->options;
+    int fd = openat(scan->root_fd, dir->path[0] ? dir->path : ".",
+                    O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+    dir_reader_t reader;
+    if (fd < 0 || !reader_open(&reader, fd, scanner)) {
+        if (fd >= 0) close(fd);
+        atomic_fetch_add_explicit(&scan->skipped, 1, memory_order_relaxed);
+        return true;
+    }
+
+    bool descend = options->max_depth <= 0 || dir->depth + 1 < options->max_depth;
+    bool ok = true;
+    const char* name;
+    unsigned char d_type;
+    while (ok && reader_next(&reader, &name, &d_type)) {
+        bool is_directory = d_type == DT_DIR;
+        bool known = d_type != DT_UNKNOWN;
+        bool wanted = is_directory ? options->include_directories : name_matches(name, options);
+        if (known && !wanted && !(is_directory && descend)) continue;
+
+        struct stat st;
+        if ((wanted || !known) && fstatat(fd, name, &st, AT_SYMLINK_NOFOLLOW) != 0) continue; // gone since listed
+        if (!known) {
+            is_directory = S_ISDIR(st.st_mode);
+            wanted = is_directory ? options->include_directories : name_matches(name, options);
+        }
+
+        if (wanted) ok = add_entry(scanner, dir, name, &st);
+        if (ok && is_directory && descend) {
+            dir_item_t* item = new_item(dir, name);
+            if (item) {
+                item->next = *found;
+                *found = item;
+            }
+            ok = item != NULL;
+        }
+    }
+    reader_close(&reader);
+    return ok;
+}
+
+// Scanner loop, run by the caller and by each helper task
+static void scan_loop(scan_t* scan, scanner_t* scanner) {
+    pthread_mutex_lock(&scan->lock);
+    for (;;) {
+        while (!scan->queue && scan->active > 0) pthread_cond_wait(&scan->wake, &scan->lock);
+        if (!scan->queue) break;
+
+        dir_item_t* item = scan->queue;
+        scan->queue = item->next;
+        scan->active++;
+        bool skip = scan->out_of_memory;
+        pthread_mutex_unlock(&scan->lock);
+
+        dir_item_t* found = NULL;
+        bool ok = skip || scan_directory(scan, scanner, item, &found);
+        free(item);
+
+        pthread_mutex_lock(&scan->lock);
+        if (!ok) scan->out_of_memory = true;
+        if (found) {
+            dir_item_t* last = found;
+            while (last->next) last = last->next;
+            last->next = scan->queue;
+            scan->queue = found;
+        }
+        scan->active--;
+        if (found || scan->active == 0) pthread_cond_broadcast(&scan->wake);
+    }
+    pthread_mutex_unlock(&scan->lock);
+}
+
+static void run_scanner(void* data) {
+    scan_t* scan = data;
+    int index = atomic_fetch_add(&scan->next_scanner, 1);
+    if (index < scan->scanner_count) scan_loop(scan, &scan->scanners[index]);
+}
+
+// Public API
+
+dowel_scan_result_t* dowel_storage_scan(const char* root, const dowel_scan_options_t* options) {
+    if (!root) return NULL;
+    static const dowel_scan_options_t defaults = { 0 };
+    if (!options) options = &defaults;
+    if (options->extension_count > 0 && !options->extensions) return NULL;
+
+    scan_t scan = { .options = options };
+    scan.root_fd = open(root, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (scan.root_fd < 0) {
+        dcore_report_error(DOWEL_ERROR_STORAGE_ERROR, "Failed to open directory for scanning");
+        return NULL;
+    }
+
+    // One scanner for the caller plus one per pool worker
+    int workers = dowel_async_worker_count();
+    scan.scanner_count = 1 + (workers > 0 ? workers : 0);
+    scan.scanners = calloc((size_t)scan.scanner_count, sizeof(*scan.scanners));
+    dir_item_t* root_item = calloc(1, sizeof(*root_item) + 1);
+    if (!scan.scanners || !root_item) {
+        free(scan.scanners);
+        free(root_item);
+        close(scan.root_fd);
+        dcore_report_error(DOWEL_ERROR_OUT_OF_MEMORY, "Out of memory scanning directory");
+        return NULL;
+    }
+    pthread_mutex_init(&scan.lock, NULL);
+    pthread_cond_init(&scan.wake, NULL);
+
+    // The caller reads the root alone, so a flat directory never wakes the
+    // pool; helpers start only if there are subdirectories to share
+    if (!scan_directory(&scan, &scan.scanners[0], root_item, &scan.queue)) scan.out_of_memory = true;
+    free(root_item);
+
+    atomic_store(&scan.next_scanner, 1);
+    dowel_task_t** helpers = NULL;
+    int helper_count = 0;
+    if (scan.queue && workers > 0) {
+        helpers = malloc((size_t)workers * sizeof(*helpers));
+        for (int i = 0; helpers && i < workers; i++) {
+            helpers[helper_count] = dowel_async_spawn(run_scanner, &scan);
+            if (helpers[helper_count]) helper_count++;
+        }
+    }
+    scan_loop(&scan, &scan.scanners[0]);
+    for (int i = 0; i < helper_count; i++) dowel_async_free_task(helpers[i]);
+    free(helpers);
+
+    while (scan.queue) {
+        dir_item_t* next = scan.queue->next;
+        free(scan.queue);
+        scan.queue = next;
+    }
+    pthread_cond_destroy(&scan.wake);
+    pthread_mutex_destroy(&scan.lock);
+    close(scan.root_fd);
+
+    // Merge the per-scanner tables into one allocation
+    size_t count = 0;
+    size_t paths_size = 0;
+    for (int i = 0; i < scan.scanner_count; i++) {
+        count += scan.scanners[i].count;
+        paths_size += scan.scanners[i].paths_used;
+    }
+    dowel_scan_result_t* result = NULL;
+    if (!scan.out_of_memory && paths_size <= UINT32_MAX) {
+        result = malloc(sizeof(*result) + count * sizeof(dowel_scan_entry_t) + paths_size + 1);
+    }
+    if (result) {
+        dowel_scan_entry_t* entries = (dowel_scan_entry_t*)(result + 1);
+        char* paths = (char*)(entries + count);
+        size_t at = 0;
+        size_t base = 0;
+        for (int i = 0; i < scan.scanner_count; i++) {
+            scanner_t* scanner = &scan.scanners[i];
+            for (size_t j = 0; j < scanner->count; j++) {
+                entries[at] = scanner->entries[j];
+                entries[at].path_offset += (uint32_t)base;
+                at++;
+            }
+            if (scanner->paths_used) memcpy(paths + base, scanner->paths, scanner->paths_used);
+            base += scanner->paths_used;
+        }
+        paths[paths_size] = '\0';
+        result->entries = entries;
+        result->count = count;
+        result->paths = paths;
+        result->skipped_directories = atomic_load(&scan.skipped);
+    } else {
+        dcore_report_error(DOWEL_ERROR_OUT_OF_MEMORY, "Out of memory scanning directory");
+    }
+
+    for (int i = 0; i < scan.scanner_count; i++) {
+        free(scan.scanners[i].entries);
+        free(scan.scanners[i].paths);
+    }
+    free(scan.scanners);
+    return result;
+}
+
+void dowel_storage_free_scan(dowel_scan_result_t* result) {
+    free(result);
+}
@@ -0,0 +1,236 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <sys/stat.h>
+
+#include "core_internal.h"
+
+// Durable writes - dowel_storage_write_file_mode
+//
+//  - ATOMIC: the data goes to a temp file next to the target, which is synced,
+//    renamed over the target, and then the directory is synced so the rename
+//    itself survives a power cut. A reader or a crash sees the old file or
+//    the new one, never a mix.
+//  - GROUP: the same steps, but writers queue their temp files and one of
+//    them (the leader) commits everything queued: writeback for all files is
+//    started before any sync, and each directory is synced once per group.
+//    Writers arriving while a group commits form the next one, so under load
+//    the syncs are shared without adding latency when there is no load.
+//    "storage.group_commit_us" adds a wait for more writers before a commit.
+//  - Temp files are named .<name>.tmp.<pid>.<n>; a crash can leave one behind,
+//    but never in place of the target.
+
+static atomic_int crash_point = DCORE_CRASH_NONE;
+static atomic_uint temp_counter;
+
+void dcore_storage_set_crash_point(int point) {
+    atomic_store(&crash_point, point);
+}
+
+static void crash_if(int point) {
+    if (atomic_load_explicit(&crash_point, memory_order_relaxed) == point) _exit(DCORE_CRASH_EXIT_CODE);
+}
+
+// fdatasync is not enough on Apple platforms: F_FULLFSYNC also flushes the
+// drive's own cache
+static int sync_data(int fd) {
+#if defined(__APPLE__)
+    if (fcntl(fd, F_FULLFSYNC) == 0) return 0;
+    return fsync(fd);
+#else
+    int result;
+    do {
+        result = fdatasync(fd);
+    } while (result != 0 && errno == EINTR);
+    return result;
+#endif
+}
+
+static int sync_directory(const char* dir) {
+    int fd = open(dir, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) return -1;
+    int result = fsync(fd);
+    close(fd);
+    return result;
+}
+
+// Directory part of path ("." for a bare name); returns a malloc'd string
+static char* directory_of(const char* path) {
+    const char* slash = strrchr(path, '/');
+    if (!slash) return strdup(".");
+    if (slash == path) return strdup("/");
+    return strndup(path, (size_t)(slash - path));
+}
+
+typedef struct commit {
+    struct commit* next;
+    const char* path;
+    char* temp;
+    char* dir;
+    int fd;
+    int status;
+    bool done;
+} commit_t;
+
+// Creates the temp file for path and writes data to it, without syncing.
+// The temp keeps the target's permissions if it exists.
+static int write_temp(commit_t* commit, const uint8_t* data, size_t size) {
+    commit->fd = -1;
+    commit->temp = NULL;
+    commit->dir = directory_of(commit->path);
+    if (!commit->dir) return DOWEL_ERROR_OUT_OF_MEMORY;
+
+    const char* slash = strrchr(commit->path, '/');
+    const char* name = slash ? slash + 1 : commit->path;
+    unsigned serial = atomic_fetch_add_explicit(&temp_counter, 1, memory_order_relaxed);
+    if (asprintf(&commit->temp, "%s/.%s.tmp.%ld.%u", commit->dir, name, (long)getpid(), serial) < 0) {
+        commit->temp = NULL;
+        return DOWEL_ERROR_OUT_OF_MEMORY;
+    }
+
+    commit->fd = open(commit->temp, O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    if (commit->fd < 0) return DOWEL_ERROR_STORAGE_ERROR;
+    struct stat st;
+    if (stat(commit->path, &st) == 0) fchmod(commit->fd, st.st_mode & 07777);
+
+    size_t total = 0;
+    while (total < size) {
+        ssize_t n = write(commit->fd, data + total, size - total);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return DOWEL_ERROR_STORAGE_ERROR;
+        total += (size_t)n;
+    }
+    crash_if(DCORE_CRASH_AFTER_TEMP_WRITE);
+    return DOWEL_SUCCESS;
+}
+
+static void discard_temp(commit_t* commit) {
+    if (commit->fd >= 0) close(commit->fd);
+    if (commit->temp) unlink(commit->temp);
+    commit->fd = -1;
+}
+
+static void finish(commit_t* commit) {
+    dcore_storage_changed(commit->path);
+    free(commit->temp);
+    free(commit->dir);
+}
+
+// Syncs, renames and directory-syncs every commit in the list, setting each
+// one's status
+static void commit_group(commit_t* group) {
+#if defined(__linux__)
+    // Start writeback on every file so the syncs below overlap rather than
+    // each waiting for its own data to go out
+    for (commit_t* c = group; c; c = c->next) {
+        if (c->status == DOWEL_SUCCESS) sync_file_range(c->fd, 0, 0, SYNC_FILE_RANGE_WRITE);
+    }
+#endif
+    for (commit_t* c = group; c; c = c->next) {
+        if (c->status != DOWEL_SUCCESS) continue;
+        // Close even when the sync fails: nothing else will
+        int synced = sync_data(c->fd);
+        int closed = close(c->fd);
+        c->fd = -1;
+        if (synced != 0 || closed != 0) c->status = DOWEL_ERROR_STORAGE_ERROR;
+    }
+    crash_if(DCORE_CRASH_AFTER_SYNC);
+
+    for (commit_t* c = group; c; c = c->next) {
+        if (c->status == DOWEL_SUCCESS && rename(c->temp, c->path) != 0) c->status = DOWEL_ERROR_STORAGE_ERROR;
+        if (c->status != DOWEL_SUCCESS) discard_temp(c);
+    }
+    crash_if(DCORE_CRASH_AFTER_RENAME);
+
+    // One sync per distinct directory; a failure there means the rename may
+    // not be durable, so every commit in that directory reports it
+    for (commit_t* c = group; c; c = c->next) {
+        if (c->status != DOWEL_SUCCESS) continue;
+        bool seen = false;
+        for (commit_t* earlier = group; earlier != c && !seen; earlier = earlier->next) {
+            seen = earlier->status == DOWEL_SUCCESS && strcmp(earlier->dir, c->dir) == 0;
+        }
+        if (seen) continue;
+        if (sync_directory(c->dir) != 0) {
+            for (commit_t* same = c; same; same = same->next) {
+                if (strcmp(same->dir, c->dir) == 0) same->status = DOWEL_ERROR_STORAGE_ERROR;
+            }
+        }
+    }
+}
+
+// Group commit
+
+static struct {
+    pthread_mutex_t lock;
+    pthread_cond_t committed;
+    commit_t* head;
+    commit_t* tail;
+    bool leader_active;
+} queue = { .lock = PTHREAD_MUTEX_INITIALIZER, .committed = PTHREAD_COND_INITIALIZER };
+
+static void wait_for_group(commit_t* commit) {
+    pthread_mutex_lock(&queue.lock);
+    commit->next = NULL;
+    if (queue.tail) queue.tail->next = commit; else queue.head = commit;
+    queue.tail = commit;
+
+    while (!commit->done) {
+        if (queue.leader_active) {
+            pthread_cond_wait(&queue.committed, &queue.lock);
+            continue;
+        }
+
+        // Lead: take everything queued so far (including this commit) and
+        // commit it outside the lock
+        queue.leader_active = true;
+        int64_t window_us = dowel_config_get_int("storage.group_commit_us", 0);
+        if (window_us > 0) {
+            pthread_mutex_unlock(&queue.lock);
+            struct timespec delay = { window_us / 1000000, (window_us % 1000000) * 1000 };
+            nanosleep(&delay, NULL);
+            pthread_mutex_lock(&queue.lock);
+        }
+        commit_t* group = queue.head;
+        queue.head = queue.tail = NULL;
+        pthread_mutex_unlock(&queue.lock);
+
+        commit_group(group);
+
+        pthread_mutex_lock(&queue.lock);
+        for (commit_t* c = group; c; c = c->next) c->done = true;
+        queue.leader_active = false;
+        pthread_cond_broadcast(&queue.committed);
+    }
+    pthread_mutex_unlock(&queue.lock);
+}
+
+// Public API
+
+int dowel_storage_write_file_mode(const char* path, const uint8_t* data, size_t size, int mode) {
+    if (mode == DOWEL_WRITE_FAST) return dowel_storage_write_file(path, data, size);
+    if (!path || (!data && size > 0) || (mode != DOWEL_WRITE_ATOMIC && mode != DOWEL_WRITE_GROUP)) {
+        return DOWEL_ERROR_INVALID_PARAMETER;
+    }
+
+    commit_t commit = { .path = path };
+    commit.status = write_temp(&commit, data, size);
+    if (commit.status != DOWEL_SUCCESS) {
+        discard_temp(&commit);
+    } else if (mode == DOWEL_WRITE_ATOMIC) {
+        commit_group(&commit);
+    } else {
+        wait_for_group(&commit);
+    }
+    finish(&commit);
+
+    if (commit.status == DOWEL_SUCCESS) dcore_storage_count_write(size);
+    return commit.status;
+}
@@ -0,0 +1,459 @@
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "core_internal.h"
+
+// File cache - dowel_storage_read_cached
+//
+//  - Paths hash to one of SHARD_COUNT shards, each with its own mutex, hash
+//    table and queues, so readers of different files rarely contend.
+//  - Entries own one reference to a heap-copied dowel_file_view_t; a hit
+//    retains it for the caller, and eviction drops the cache's reference, so
+//    views handed out stay valid however long they are held.
+//  - Capacity is counted in bytes: file data, the view header, the entry and
+//    its key (dcore_file_view_footprint + entry size). The budget is shared
+//    by all shards, each accounting its own entries, so one file may use up
+//    to the whole budget. A shard over budget evicts its own entries first;
+//    when it has none left to give, other shards give up their LRU ends.
+//  - Admission is W-TinyLFU per shard: new files enter a small LRU window;
+//    what falls out of it only displaces the main region's LRU victim if a
+//    count-min sketch of recent accesses says it is used more often. The
+//    main region is a segmented LRU (probation, then protected on a hit).
+//  - Loading happens outside the lock. Each shard has a generation bumped by
+//    invalidation, and a load that raced with one is returned uncached.
+
+#define SHARD_COUNT 16
+#define DEFAULT_CAPACITY (64 * 1024 * 1024)
+#define WINDOW_PERCENT 1
+#define PROTECTED_PERCENT 80
+
+#define SKETCH_DEPTH 4
+#define SKETCH_WIDTH 1024 // per shard, a power of two
+#define SKETCH_MAX 15
+#define SKETCH_SAMPLE (10 * SKETCH_WIDTH)
+
+enum {
+    QUEUE_WINDOW = 0,
+    QUEUE_PROBATION = 1,
+    QUEUE_PROTECTED = 2,
+    QUEUE_COUNT = 3,
+};
+
+typedef struct cache_entry {
+    struct cache_entry* chain; // next in the hash bucket
+    struct cache_entry* prev;  // toward the queue's head (most recent)
+    struct cache_entry* next;  // toward the queue's tail (eviction end)
+    uint64_t hash;
+    dowel_file_view_t* view;
+    size_t charge;
+    int queue;
+    char path[];
+} cache_entry_t;
+
+typedef struct {
+    cache_entry_t* head;
+    cache_entry_t* tail;
+    size_t bytes;
+} queue_t;
+
+typedef struct {
+    pthread_mutex_t lock;
+    cache_entry_t** buckets;
+    size_t bucket_mask;
+    size_t count;
+    queue_t queues[QUEUE_COUNT];
+
+    size_t window_capacity;
+    size_t protected_capacity;
+    uint32_t capacity_generation; // of "storage.cache_bytes" when capacity was set
+    uint64_t generation;
+
+    uint8_t sketch[SKETCH_DEPTH][SKETCH_WIDTH];
+    uint32_t sketch_additions;
+
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+    uint64_t rejections;
+} __attribute__((aligned(64))) shard_t;
+
+static shard_t shards[SHARD_COUNT];
+
+// Byte budget shared by every shard
+static struct {
+    _Atomic size_t bytes;
+    _Atomic size_t capacity;
+} budget;
+static pthread_once_t shards_once = PTHREAD_ONCE_INIT;
+static _Atomic dowel_config_key_t capacity_key;
+
+static uint64_t hash_path(const char* s) {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    while (*s) {
+        h ^= (unsigned char)*s++;
+        h *= 0x100000001b3ULL;
+    }
+    // FNV's low bits are weak; finish with a mix so buckets, shards and
+    // sketch rows all see well-spread bits
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return h;
+}
+
+static void init_shards(void) {
+    for (size_t i = 0; i < SHARD_COUNT; i++) {
+        pthread_mutex_init(&shards[i].lock, NULL);
+        shards[i].capacity_generation = UINT32_MAX;
+    }
+}
+
+static shard_t* shard_for(uint64_t hash) {
+    pthread_once(&shards_once, init_shards);
+    return &shards[hash >> 60];
+}
+
+// Frequency sketch
+
+static size_t sketch_index(uint64_t hash, int row) {
+    static const uint64_t seeds[SKETCH_DEPTH] = {
+        0x9e3779b97f4a7c15ULL, 0xc2b2ae3d27d4eb4fULL, 0x165667b19e3779f9ULL, 0x27d4eb2f165667c5ULL,
+    };
+    return (size_t)((hash * seeds[row]) >> 32) & (SKETCH_WIDTH - 1);
+}
+
+static void sketch_add(shard_t* shard, uint64_t hash) {
+    for (int row = 0; row < SKETCH_DEPTH; row++) {
+        uint8_t* counter = &shard->sketch[row][sketch_index(hash, row)];
+        if (*counter < SKETCH_MAX) (*counter)++;
+    }
+    // Aging: halve everything periodically so old popularity fades
+    if (++shard->sketch_additions >= SKETCH_SAMPLE) {
+        for (int row = 0; row < SKETCH_DEPTH; row++) {
+            for (size_t i = 0; i < SKETCH_WIDTH; i++) shard->sketch[row][i] >>= 1;
+        }
+        shard->sketch_additions /= 2;
+    }
+}
+
+static unsigned sketch_estimate(const shard_t* shard, uint64_t hash) {
+    unsigned estimate = SKETCH_MAX;
+    for (int row = 0; row < SKETCH_DEPTH; row++) {
+        unsigned count = shard->sketch[row][sketch_index(hash, row)];
+        if (count < estimate) estimate = count;
+    }
+    return estimate;
+}
+
+// Queues
+
+static void queue_unlink(shard_t* shard, cache_entry_t* entry) {
+    queue_t* queue = &shard->queues[entry->queue];
+    if (entry->prev) entry->prev->next = entry->next; else queue->head = entry->next;
+    if (entry->next) entry->next->prev = entry->prev; else queue->tail = entry->prev;
+    queue->bytes -= entry->charge;
+}
+
+static void queue_push(shard_t* shard, cache_entry_t* entry, int which) {
+    queue_t* queue = &shard->queues[which];
+    entry->queue = which;
+    entry->prev = NULL;
+    entry->next = queue->head;
+    if (queue->head) queue->head->prev = entry; else queue->tail = entry;
+    queue->head = entry;
+    queue->bytes += entry->charge;
+}
+
+// Hash table
+
+static cache_entry_t* table_find(shard_t* shard, uint64_t hash, const char* path) {
+    if (!shard->buckets) return NULL;
+    for (cache_entry_t* entry = shard->buckets[hash & shard->bucket_mask]; entry; entry = entry->chain) {
+        if (entry->hash == hash && strcmp(entry->path, path) == 0) return entry;
+    }
+    return NULL;
+}
+
+static bool over_budget(void) {
+    return atomic_load_explicit(&budget.bytes, memory_order_relaxed) > atomic_load_explicit(&budget.capacity, memory_order_relaxed);
+}
+
+static bool table_insert(shard_t* shard, cache_entry_t* entry) {
+    if (shard->count >= (shard->buckets ? shard->bucket_mask + 1 : 0)) {
+        size_t size = shard->buckets ? 2 * (shard->bucket_mask + 1) : 64;
+        cache_entry_t** buckets = calloc(size, sizeof(*buckets));
+        if (!buckets) return false;
+        for (size_t i = 0; shard->buckets && i <= shard->bucket_mask; i++) {
+            cache_entry_t* chained = shard->buckets[i];
+            while (chained) {
+                cache_entry_t* next = chained->chain;
+                chained->chain = buckets[chained->hash & (size - 1)];
+                buckets[chained->hash & (size - 1)] = chained;
+                chained = next;
+            }
+        }
+        free(shard->buckets);
+        shard->buckets = buckets;
+        shard->bucket_mask = size - 1;
+    }
+    cache_entry_t** bucket = &shard->buckets[entry->hash & shard->bucket_mask];
+    entry->chain = *bucket;
+    *bucket = entry;
+    shard->count++;
+    atomic_fetch_add_explicit(&budget.bytes, entry->charge, memory_order_relaxed);
+    return true;
+}
+
+static void table_remove(shard_t* shard, cache_entry_t* entry) {
+    cache_entry_t** link = &shard->buckets[entry->hash & shard->bucket_mask];
+    while (*link != entry) link = &(*link)->chain;
+    *link = entry->chain;
+    shard->count--;
+    atomic_fetch_sub_explicit(&budget.bytes, entry->charge, memory_order_relaxed);
+}
+
+// Removes an entry from the shard and queues it on *dropped, to be released
+// once the lock is gone
+static void drop_entry(shard_t* shard, cache_entry_t* entry, cache_entry_t** dropped) {
+    queue_unlink(shard, entry);
+    table_remove(shard, entry);
+    entry->chain = *dropped;
+    *dropped = entry;
+}
+
+static void release_dropped(cache_entry_t* dropped) {
+    while (dropped) {
+        cache_entry_t* next = dropped->chain;
+        dowel_file_view_release(dropped->view);
+        free(dropped);
+        dropped = next;
+    }
+}
+
+// Capacity and eviction
+
+static void evict(shard_t* shard, cache_entry_t* entry, cache_entry_t** dropped) {
+    drop_entry(shard, entry, dropped);
+    shard->evictions++;
+}
+
+// A window entry pushed out by newer ones competes with the main region's
+// victim for a place; the more frequently used of the two stays. With no
+// victim left in this shard the candidate stays and trim_budget makes room.
+static void admit(shard_t* shard, cache_entry_t* candidate, cache_entry_t** dropped) {
+    queue_unlink(shard, candidate);
+    queue_push(shard, candidate, QUEUE_PROBATION);
+
+    while (over_budget()) {
+        cache_entry_t* victim = shard->queues[QUEUE_PROBATION].tail;
+        if (victim == candidate) victim = shard->queues[QUEUE_PROTECTED].tail;
+        if (!victim) return;
+        if (sketch_estimate(shard, candidate->hash) <= sketch_estimate(shard, victim->hash)) {
+            drop_entry(shard, candidate, dropped);
+            shard->rejections++;
+            return;
+        }
+        evict(shard, victim, dropped);
+    }
+}
+
+static void balance(shard_t* shard, cache_entry_t** dropped) {
+    while (shard->queues[QUEUE_WINDOW].bytes > shard->window_capacity) {
+        admit(shard, shard->queues[QUEUE_WINDOW].tail, dropped);
+    }
+    // Keep the protected segment within its share by demoting its LRU end
+    while (shard->queues[QUEUE_PROTECTED].bytes > shard->protected_capacity) {
+        cache_entry_t* demoted = shard->queues[QUEUE_PROTECTED].tail;
+        queue_unlink(shard, demoted);
+        queue_push(shard, demoted, QUEUE_PROBATION);
+    }
+}
+
+static cache_entry_t* lru_victim(shard_t* shard) {
+    for (int q = QUEUE_PROBATION; q < QUEUE_COUNT; q++) {
+        if (shard->queues[q].tail) return shard->queues[q].tail;
+    }
+    return shard->queues[QUEUE_WINDOW].tail;
+}
+
+// Takes a slice of the excess from each shard in turn, starting after the
+// caller's, until the budget holds again (after a lowered capacity, or an
+// insert into a shard with nothing left to evict). Called with no lock held.
+static void trim_budget(size_t start) {
+    bool progress = true;
+    while (progress && over_budget()) {
+        size_t excess = atomic_load_explicit(&budget.bytes, memory_order_relaxed) -
+            atomic_load_explicit(&budget.capacity, memory_order_relaxed);
+        size_t slice = excess / SHARD_COUNT + 1;
+        progress = false;
+        for (size_t i = 1; i <= SHARD_COUNT && over_budget(); i++) {
+            shard_t* shard = &shards[(start + i) % SHARD_COUNT];
+            cache_entry_t* dropped = NULL;
+            size_t freed = 0;
+            pthread_mutex_lock(&shard->lock);
+            for (cache_entry_t* victim; freed < slice && (victim = lru_victim(shard)) != NULL;) {
+                freed += victim->charge;
+                evict(shard, victim, &dropped);
+            }
+            pthread_mutex_unlock(&shard->lock);
+            release_dropped(dropped);
+            progress = progress || freed > 0;
+        }
+    }
+}
+
+// Re-reads "storage.cache_bytes" when it has been written since the shard
+// last looked; only the miss path checks, so hits never touch the config
+static void refresh_capacity(shard_t* shard, cache_entry_t** dropped) {
+    dowel_config_key_t key = atomic_load_explicit(&capacity_key, memory_order_acquire);
+    if (!key) {
+        key = dowel_config_resolve("storage.cache_bytes");
+        atomic_store_explicit(&capacity_key, key, memory_order_release);
+    }
+    uint32_t generation = dowel_config_key_generation(key);
+    if (generation == shard->capacity_generation) return;
+
+    int64_t total = dowel_config_key_get_int(key, DEFAULT_CAPACITY);
+    if (total < 0) total = 0;
+    atomic_store_explicit(&budget.capacity, (size_t)total, memory_order_relaxed);
+    // Segment sizes still follow the shard's even share of the budget
+    size_t share = (size_t)total / SHARD_COUNT;
+    shard->capacity_generation = generation;
+    shard->window_capacity = share * WINDOW_PERCENT / 100;
+    shard->protected_capacity = (share - shard->window_capacity) * PROTECTED_PERCENT / 100;
+    balance(shard, dropped);
+}
+
+// Public API
+
+dowel_file_view_t* dowel_storage_read_cached(const char* path) {
+    if (!path) return NULL;
+    uint64_t hash = hash_path(path);
+    shard_t* shard = shard_for(hash);
+
+    pthread_mutex_lock(&shard->lock);
+    sketch_add(shard, hash);
+    cache_entry_t* entry = table_find(shard, hash, path);
+    if (entry) {
+        // Window and protected hits move to their queue's head; a probation
+        // hit earns the entry a place in the protected segment
+        int target = entry->queue == QUEUE_WINDOW ? QUEUE_WINDOW : QUEUE_PROTECTED;
+        queue_unlink(shard, entry);
+        queue_push(shard, entry, target);
+        dowel_file_view_t* view = dowel_file_view_retain(entry->view);
+        shard->hits++;
+        cache_entry_t* dropped = NULL;
+        if (target == QUEUE_PROTECTED) balance(shard, &dropped);
+        pthread_mutex_unlock(&shard->lock);
+        release_dropped(dropped);
+        dcore_storage_count_read(view->size);
+        return view;
+    }
+    shard->misses++;
+    uint64_t generation = shard->generation;
+    pthread_mutex_unlock(&shard->lock);
+
+    dowel_file_view_t* view = dcore_file_view_read(path);
+    if (!view) {
+        dcore_report_error(DOWEL_ERROR_STORAGE_ERROR, "Failed to open file for reading");
+        return NULL;
+    }
+    dcore_storage_count_read(view->size);
+
+    size_t length = strlen(path);
+    cache_entry_t* dropped = NULL;
+    pthread_mutex_lock(&shard->lock);
+    refresh_capacity(shard, &dropped);
+
+    size_t charge = dcore_file_view_footprint(view) + sizeof(cache_entry_t) + length + 1;
+    size_t capacity = atomic_load_explicit(&budget.capacity, memory_order_relaxed);
+    if (shard->generation != generation || charge > capacity) {
+        // Stale (invalidated while loading) or larger than the whole budget
+        if (shard->generation == generation && capacity > 0) shard->rejections++;
+    } else if ((entry = table_find(shard, hash, path)) != NULL) {
+        // Another thread loaded it first; share its copy
+        dowel_file_view_t* cached = dowel_file_view_retain(entry->view);
+        pthread_mutex_unlock(&shard->lock);
+        release_dropped(dropped);
+        dowel_file_view_release(view);
+        return cached;
+    } else if ((entry = malloc(sizeof(*entry) + length + 1)) != NULL) {
+        entry->hash = hash;
+        entry->view = dowel_file_view_retain(view);
+        entry->charge = charge;
+        memcpy(entry->path, path, length + 1);
+        if (table_insert(shard, entry)) {
+            queue_push(shard, entry, QUEUE_WINDOW);
+            balance(shard, &dropped);
+        } else {
+            dowel_file_view_release(entry->view);
+            free(entry);
+        }
+    }
+    pthread_mutex_unlock(&shard->lock);
+    release_dropped(dropped);
+    if (over_budget()) trim_budget((size_t)(shard - shards));
+    return view;
+}
+
+void dcore_file_cache_invalidate(const char* path) {
+    uint64_t hash = hash_path(path);
+    shard_t* shard = shard_for(hash);
+
+    cache_entry_t* dropped = NULL;
+    pthread_mutex_lock(&shard->lock);
+    shard->generation++;
+    cache_entry_t* entry = table_find(shard, hash, path);
+    if (entry) drop_entry(shard, entry, &dropped);
+    pthread_mutex_unlock(&shard->lock);
+    release_dropped(dropped);
+}
+
+void dowel_storage_cache_invalidate(const char* path) {
+    if (path) dcore_file_cache_invalidate(path);
+}
+
+void dowel_storage_cache_clear(void) {
+    pthread_once(&shards_once, init_shards);
+    for (size_t i = 0; i < SHARD_COUNT; i++) {
+        shard_t* shard = &shards[i];
+        cache_entry_t* dropped = NULL;
+        pthread_mutex_lock(&shard->lock);
+        shard->generation++;
+        for (int q = 0; q < QUEUE_COUNT; q++) {
+            while (shard->queues[q].tail) drop_entry(shard, shard->queues[q].tail, &dropped);
+        }
+        pthread_mutex_unlock(&shard->lock);
+        release_dropped(dropped);
+    }
+}
+
+void dcore_file_cache_add_metrics(dowel_storage_metrics_t* metrics) {
+    pthread_once(&shards_once, init_shards);
+    for (size_t i = 0; i < SHARD_COUNT; i++) {
+        shard_t* shard = &shards[i];
+        pthread_mutex_lock(&shard->lock);
+        metrics->cache_hits += shard->hits;
+        metrics->cache_misses += shard->misses;
+        metrics->cache_evictions += shard->evictions;
+        metrics->cache_rejections += shard->rejections;
+        metrics->cached_files += shard->count;
+        for (int q = 0; q < QUEUE_COUNT; q++) metrics->cached_bytes += shard->queues[q].bytes;
+        pthread_mutex_unlock(&shard->lock);
+    }
+}
+
+// Config keys do not survive dcore_config_reset, so the capacity is re-read
+// after the next init
+void dcore_file_cache_shutdown(void) {
+    dowel_storage_cache_clear();
+    atomic_store_explicit(&capacity_key, 0, memory_order_release);
+    for (size_t i = 0; i < SHARD_COUNT; i++) {
+        pthread_mutex_lock(&shards[i].lock);
+        shards[i].capacity_generation = UINT32_MAX;
+        pthread_mutex_unlock(&shards[i].lock);
+    }
+}
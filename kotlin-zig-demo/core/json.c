@@ -0,0 +1,952 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+#include "core_internal.h"
+
+// JSON utilities - two-stage parser producing an immutable tape
+//
+//  - Stage 1 classifies the input 64 bytes at a time (AVX2 or SSE2 on
+//    x86-64, NEON on arm64, a lookup table elsewhere) into bitmasks of
+//    quotes, backslashes, structural characters and whitespace, works out
+//    which bytes are inside strings, and lists the position of every
+//    structural character, opening quote and scalar start.
+//  - Stage 2 walks that list and writes the tape: one 16 byte entry per
+//    value or object key in document order. A container records how many
+//    entries it spans, so a lookup steps over whole members. Strings are
+//    unescaped into a buffer behind the tape, length-prefixed and NUL
+//    terminated; object keys carry a hash taken at parse time, so a lookup
+//    compares bytes only when the hash matches. Objects with many members
+//    also get a hash directory in that buffer.
+//  - Header, tape and strings are one allocation sized from the stage 1
+//    count, and dowel_json_free releases it in one call. Values returned by
+//    dowel_json_get_object_value point into the tape; strings returned by the
+//    getters and by dowel_json_stringify live until dowel_json_free.
+
+#define JSON_MAX_DEPTH 512
+#define JSON_DIRECTORY_MIN 16 // members before an object gets a directory
+
+typedef enum {
+    JSON_NULL,
+    JSON_BOOL,
+    JSON_INT,
+    JSON_FLOAT,
+    JSON_STRING,
+    JSON_ARRAY,
+    JSON_OBJECT,
+    JSON_KEY, // an object member's name, followed by its value
+} json_type_t;
+
+enum { ENTRY_HAS_DIRECTORY = 1 };
+
+struct dowel_json_value {
+    uint8_t type;
+    uint8_t flags;
+    // Position in the tape; the name's hash for JSON_KEY; with a directory,
+    // the distance to it in 16 byte units
+    uint32_t index;
+    union {
+        bool boolean;
+        int64_t integer;
+        double number;
+        const char* string; // preceded by its uint32_t length
+        struct {
+            uint32_t count;
+            uint32_t span; // entries, including this one
+        } container;
+    } as;
+};
+
+// Open-addressed table of an object's members; offset is the key's distance
+// from the object entry, 0 for an empty slot
+typedef struct {
+    uint32_t index; // the object's tape position
+    uint32_t mask;
+    struct {
+        uint32_t hash;
+        uint32_t offset;
+    } slots[];
+} json_directory_t;
+
+// dowel_json_stringify results, released with the document
+typedef struct text_block {
+    struct text_block* next;
+    char text[];
+} text_block_t;
+
+typedef struct {
+    text_block_t* texts;
+    dowel_json_value_t tape[];
+} json_document_t;
+
+typedef struct {
+    char* data;
+    size_t length;
+    size_t capacity;
+} json_builder_t;
+
+static const json_directory_t* directory_of(const dowel_json_value_t* object) {
+    return (const json_directory_t*)((const char*)object + (size_t)object->index * 16);
+}
+
+static uint32_t position_of(const dowel_json_value_t* value) {
+    return value->flags & ENTRY_HAS_DIRECTORY ? directory_of(value)->index : value->index;
+}
+
+static json_document_t* document_of(const dowel_json_value_t* value) {
+    return (json_document_t*)((char*)(value - position_of(value)) - offsetof(json_document_t, tape));
+}
+
+static size_t string_length(const char* s) {
+    uint32_t length;
+    memcpy(&length, s - sizeof(length), sizeof(length));
+    return length;
+}
+
+// The entry after value and everything it contains
+static const dowel_json_value_t* next_entry(const dowel_json_value_t* value) {
+    if (value->type == JSON_ARRAY || value->type == JSON_OBJECT) return value + value->as.container.span;
+    return value + 1;
+}
+
+static uint32_t key_hash(const char* s, size_t length) {
+    uint64_t h = 0x9e3779b97f4a7c15ULL ^ length;
+    while (length >= 8) {
+        uint64_t word;
+        memcpy(&word, s, 8);
+        h = (h ^ word) * 0xff51afd7ed558ccdULL;
+        h ^= h >> 32;
+        s += 8;
+        length -= 8;
+    }
+    uint64_t tail = 0;
+    memcpy(&tail, s, length);
+    h = (h ^ tail) * 0xc4ceb9fe1a85ec53ULL;
+    return (uint32_t)(h ^ (h >> 29));
+}
+
+// Stage 1
+
+typedef struct {
+    uint64_t quote;
+    uint64_t backslash;
+    uint64_t structural; // { } [ ] : ,
+    uint64_t whitespace;
+} json_block_t;
+
+#define CLASSIFY static inline __attribute__((always_inline))
+
+enum { CLASS_QUOTE = 1, CLASS_BACKSLASH = 2, CLASS_STRUCTURAL = 4, CLASS_WHITESPACE = 8 };
+
+static const uint8_t byte_class[256] = {
+    ['"'] = CLASS_QUOTE, ['\\'] = CLASS_BACKSLASH,
+    ['{'] = CLASS_STRUCTURAL, ['}'] = CLASS_STRUCTURAL, ['['] = CLASS_STRUCTURAL, [']'] = CLASS_STRUCTURAL,
+    [':'] = CLASS_STRUCTURAL, [','] = CLASS_STRUCTURAL,
+    [' '] = CLASS_WHITESPACE, ['\t'] = CLASS_WHITESPACE, ['\n'] = CLASS_WHITESPACE, ['\r'] = CLASS_WHITESPACE,
+};
+
+CLASSIFY void classify_scalar(const uint8_t* in, json_block_t* block) {
+    *block = (json_block_t){ 0 };
+    for (int i = 0; i < 64; i++) {
+        uint8_t c = byte_class[in[i]];
+        block->quote |= (uint64_t)(c & CLASS_QUOTE) << i;
+        block->backslash |= (uint64_t)((c & CLASS_BACKSLASH) >> 1) << i;
+        block->structural |= (uint64_t)((c & CLASS_STRUCTURAL) >> 2) << i;
+        block->whitespace |= (uint64_t)((c & CLASS_WHITESPACE) >> 3) << i;
+    }
+}
+
+#if defined(__x86_64__)
+// '[' and ']' are '{' and '}' without 0x20, so one OR folds four brackets
+// into two compares
+CLASSIFY void classify_sse2(const uint8_t* in, json_block_t* block) {
+    *block = (json_block_t){ 0 };
+    for (int i = 0; i < 4; i++) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(in + 16 * i));
+        __m128i folded = _mm_or_si128(v, _mm_set1_epi8(0x20));
+        __m128i structural = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(folded, _mm_set1_epi8('{')), _mm_cmpeq_epi8(folded, _mm_set1_epi8('}'))),
+            _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(':')), _mm_cmpeq_epi8(v, _mm_set1_epi8(','))));
+        __m128i whitespace = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\t'))),
+            _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\r'))));
+        int shift = 16 * i;
+        block->quote |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('"'))) << shift;
+        block->backslash |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('\\'))) << shift;
+        block->structural |= (uint64_t)(uint16_t)_mm_movemask_epi8(structural) << shift;
+        block->whitespace |= (uint64_t)(uint16_t)_mm_movemask_epi8(whitespace) << shift;
+    }
+}
+
+__attribute__((target("avx2"))) CLASSIFY void classify_avx2(const uint8_t* in, json_block_t* block) {
+    *block = (json_block_t){ 0 };
+    for (int i = 0; i < 2; i++) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(in + 32 * i));
+        __m256i folded = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+        __m256i structural = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(folded, _mm256_set1_epi8('{')), _mm256_cmpeq_epi8(folded, _mm256_set1_epi8('}'))),
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(':')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8(','))));
+        __m256i whitespace = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t'))),
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r'))));
+        int shift = 32 * i;
+        block->quote |= (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('"'))) << shift;
+        block->backslash |= (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\'))) << shift;
+        block->structural |= (uint64_t)(uint32_t)_mm256_movemask_epi8(structural) << shift;
+        block->whitespace |= (uint64_t)(uint32_t)_mm256_movemask_epi8(whitespace) << shift;
+    }
+}
+#elif defined(__aarch64__)
+// Bit i of the result is set when byte i of the 64 compared bytes matched
+CLASSIFY uint64_t neon_movemask(uint8x16_t a, uint8x16_t b, uint8x16_t c, uint8x16_t d) {
+    const uint8x16_t bits = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+    uint8x16_t ab = vpaddq_u8(vandq_u8(a, bits), vandq_u8(b, bits));
+    uint8x16_t cd = vpaddq_u8(vandq_u8(c, bits), vandq_u8(d, bits));
+    uint8x16_t sum = vpaddq_u8(ab, cd);
+    sum = vpaddq_u8(sum, sum);
+    return vgetq_lane_u64(vreinterpretq_u64_u8(sum), 0);
+}
+
+CLASSIFY void classify_neon(const uint8_t* in, json_block_t* block) {
+    uint8x16_t quote[4], backslash[4], structural[4], whitespace[4];
+    for (int i = 0; i < 4; i++) {
+        uint8x16_t v = vld1q_u8(in + 16 * i);
+        uint8x16_t folded = vorrq_u8(v, vdupq_n_u8(0x20));
+        quote[i] = vceqq_u8(v, vdupq_n_u8('"'));
+        backslash[i] = vceqq_u8(v, vdupq_n_u8('\\'));
+        structural[i] = vorrq_u8(vorrq_u8(vceqq_u8(folded, vdupq_n_u8('{')), vceqq_u8(folded, vdupq_n_u8('}'))),
+                                 vorrq_u8(vceqq_u8(v, vdupq_n_u8(':')), vceqq_u8(v, vdupq_n_u8(','))));
+        whitespace[i] = vorrq_u8(vorrq_u8(vceqq_u8(v, vdupq_n_u8(' ')), vceqq_u8(v, vdupq_n_u8('\t'))),
+                                 vorrq_u8(vceqq_u8(v, vdupq_n_u8('\n')), vceqq_u8(v, vdupq_n_u8('\r'))));
+    }
+    block->quote = neon_movemask(quote[0], quote[1], quote[2], quote[3]);
+    block->backslash = neon_movemask(backslash[0], backslash[1], backslash[2], backslash[3]);
+    block->structural = neon_movemask(structural[0], structural[1], structural[2], structural[3]);
+    block->whitespace = neon_movemask(whitespace[0], whitespace[1], whitespace[2], whitespace[3]);
+}
+#endif
+
+// Bit i of the result is the XOR of bits 0..i: set from an opening quote up
+// to (not including) its closing quote
+static inline uint64_t prefix_xor(uint64_t x) {
+    x ^= x << 1;
+    x ^= x << 2;
+    x ^= x << 4;
+    x ^= x << 8;
+    x ^= x << 16;
+    x ^= x << 32;
+    return x;
+}
+
+// Writes the position of every structural character, opening quote and
+// scalar start to out and returns how many there are. *closed is false if
+// the input ends inside a string.
+static inline __attribute__((always_inline)) size_t find_structure(const uint8_t* in, size_t length, uint32_t* out,
+                                                                   bool* closed,
+                                                                   void (*classify)(const uint8_t*, json_block_t*)) {
+    uint64_t prev_escaped = 0;   // the next block starts with an escaped byte
+    uint64_t prev_in_string = 0; // all ones while inside a string
+    uint64_t prev_scalar = 0;    // the last block ended inside a scalar
+    uint8_t tail[64];
+    size_t count = 0;
+
+    for (size_t base = 0; base < length; base += 64) {
+        const uint8_t* chunk = in + base;
+        if (length - base < 64) {
+            memset(tail, ' ', sizeof(tail));
+            memcpy(tail, chunk, length - base);
+            chunk = tail;
+        }
+        json_block_t block;
+        classify(chunk, &block);
+
+        // A backslash escapes the next byte unless it is itself escaped.
+        // Backslashes are rare outside string-heavy text, so walk them.
+        uint64_t escaped = prev_escaped;
+        uint64_t backslash = block.backslash & ~prev_escaped;
+        prev_escaped = 0;
+        while (backslash) {
+            int i = __builtin_ctzll(backslash);
+            if (i == 63) {
+                prev_escaped = 1;
+                break;
+            }
+            escaped |= 2ULL << i;
+            backslash &= ~(3ULL << i);
+        }
+
+        uint64_t quote = block.quote & ~escaped;
+        uint64_t in_string = prefix_xor(quote) ^ prev_in_string;
+        prev_in_string = (uint64_t)((int64_t)in_string >> 63);
+        uint64_t scalar = ~(block.structural | block.whitespace | quote | in_string);
+        uint64_t scalar_start = scalar & ~((scalar << 1) | prev_scalar);
+        prev_scalar = scalar >> 63;
+
+        uint64_t bits = (block.structural & ~in_string) | (quote & in_string) | scalar_start;
+        while (bits) {
+            out[count++] = (uint32_t)(base + (size_t)__builtin_ctzll(bits));
+            bits &= bits - 1;
+        }
+    }
+    *closed = prev_in_string == 0;
+    return count;
+}
+
+static size_t find_structure_scalar(const uint8_t* in, size_t length, uint32_t* out, bool* closed) {
+    return find_structure(in, length, out, closed, classify_scalar);
+}
+
+#if defined(__x86_64__)
+static size_t find_structure_sse2(const uint8_t* in, size_t length, uint32_t* out, bool* closed) {
+    return find_structure(in, length, out, closed, classify_sse2);
+}
+
+__attribute__((target("avx2"))) static size_t find_structure_avx2(const uint8_t* in, size_t length, uint32_t* out,
+                                                                  bool* closed) {
+    return find_structure(in, length, out, closed, classify_avx2);
+}
+#elif defined(__aarch64__)
+static size_t find_structure_neon(const uint8_t* in, size_t length, uint32_t* out, bool* closed) {
+    return find_structure(in, length, out, closed, classify_neon);
+}
+#endif
+
+size_t dcore_json_structure(const char* input, size_t length, uint32_t* out, bool* closed) {
+    const uint8_t* in = (const uint8_t*)input;
+    uint32_t features = dcore_cpu_features();
+#if defined(__x86_64__)
+    if (features & DCORE_CPU_AVX2) return find_structure_avx2(in, length, out, closed);
+    if (features & DCORE_CPU_SSE2) return find_structure_sse2(in, length, out, closed);
+#elif defined(__aarch64__)
+    if (features & DCORE_CPU_NEON) return find_structure_neon(in, length, out, closed);
+#endif
+    (void)features;
+    return find_structure_scalar(in, length, out, closed);
+}
+
+// Stage 2
+
+typedef struct {
+    const char* input;
+    const uint32_t* positions;
+    size_t count;
+    size_t next; // next position to consume
+    dowel_json_value_t* tape;
+    uint32_t length; // tape entries written
+    char* strings;   // next free byte of the string buffer
+} json_parser_t;
+
+typedef struct {
+    uint32_t start; // tape position of the container
+    uint32_t count;
+    bool object;
+} json_frame_t;
+
+static inline bool is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+// What may follow a scalar
+static inline bool ends_scalar(char c) {
+    return c == '\0' || (byte_class[(uint8_t)c] & (CLASS_STRUCTURAL | CLASS_WHITESPACE));
+}
+
+static dowel_json_value_t* push_entry(json_parser_t* p, json_type_t type) {
+    dowel_json_value_t* entry = &p->tape[p->length];
+    entry->type = (uint8_t)type;
+    entry->flags = 0;
+    entry->index = p->length++;
+    return entry;
+}
+
+static bool parse_hex4(const char* s, uint32_t* out) {
+    uint32_t v = 0;
+    for (int i = 0; i < 4; i++) {
+        char c = s[i];
+        v <<= 4;
+        if (c >= '0' && c <= '9') v |= (uint32_t)(c - '0');
+        else if (c >= 'a' && c <= 'f') v |= (uint32_t)(c - 'a' + 10);
+        else if (c >= 'A' && c <= 'F') v |= (uint32_t)(c - 'A' + 10);
+        else return false;
+    }
+    *out = v;
+    return true;
+}
+
+static size_t encode_utf8(char* out, uint32_t cp) {
+    if (cp < 0x80) {
+        out[0] = (char)cp;
+        return 1;
+    }
+    if (cp < 0x800) {
+        out[0] = (char)(0xc0 | (cp >> 6));
+        out[1] = (char)(0x80 | (cp & 0x3f));
+        return 2;
+    }
+    if (cp < 0x10000) {
+        out[0] = (char)(0xe0 | (cp >> 12));
+        out[1] = (char)(0x80 | ((cp >> 6) & 0x3f));
+        out[2] = (char)(0x80 | (cp & 0x3f));
+        return 3;
+    }
+    out[0] = (char)(0xf0 | (cp >> 18));
+    out[1] = (char)(0x80 | ((cp >> 12) & 0x3f));
+    out[2] = (char)(0x80 | ((cp >> 6) & 0x3f));
+    out[3] = (char)(0x80 | (cp & 0x3f));
+    return 4;
+}
+
+#define ONES 0x0101010101010101ULL
+#define HIGHS 0x8080808080808080ULL
+
+size_t dcore_json_unescape(const char** src, const char* end, char* out) {
+    const char* s = *src + 1;
+    if (s >= end) return 0;
+    char c = *s++;
+    size_t written = 1;
+    switch (c) {
+        case '"': out[0] = '"'; break;
+        case '\\': out[0] = '\\'; break;
+        case '/': out[0] = '/'; break;
+        case 'b': out[0] = '\b'; break;
+        case 'f': out[0] = '\f'; break;
+        case 'n': out[0] = '\n'; break;
+        case 'r': out[0] = '\r'; break;
+        case 't': out[0] = '\t'; break;
+        case 'u': {
+            uint32_t cp;
+            if (end - s < 4 || !parse_hex4(s, &cp)) return 0;
+            s += 4;
+            if (cp >= 0xd800 && cp <= 0xdbff) {
+                uint32_t low;
+                if (end - s < 6 || s[0] != '\\' || s[1] != 'u') return 0;
+                if (!parse_hex4(s + 2, &low) || low < 0xdc00 || low > 0xdfff) return 0;
+                s += 6;
+                cp = 0x10000 + ((cp - 0xd800) << 10) + (low - 0xdc00);
+            }
+            written = encode_utf8(out, cp);
+            break;
+        }
+        default:
+            return 0;
+    }
+    *src = s;
+    return written;
+}
+
+// Copies from src to dst up to the first quote, backslash or control
+// character and returns how many bytes that was. Copies whole vectors, so
+// dst needs 16 bytes of slack.
+static inline size_t copy_plain(const char* src, const char* end, char* dst) {
+    const char* start = src;
+#if defined(__x86_64__)
+    while (end - src >= 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)src);
+        _mm_storeu_si128((__m128i*)dst, v);
+        __m128i special = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('"')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\\'))),
+            _mm_cmpeq_epi8(_mm_max_epu8(v, _mm_set1_epi8(0x1f)), _mm_set1_epi8(0x1f)));
+        int mask = _mm_movemask_epi8(special);
+        if (mask) return (size_t)(src - start) + (size_t)__builtin_ctz((unsigned)mask);
+        src += 16;
+        dst += 16;
+    }
+#elif defined(__aarch64__)
+    while (end - src >= 16) {
+        uint8x16_t v = vld1q_u8((const uint8_t*)src);
+        vst1q_u8((uint8_t*)dst, v);
+        uint8x16_t special = vorrq_u8(vorrq_u8(vceqq_u8(v, vdupq_n_u8('"')), vceqq_u8(v, vdupq_n_u8('\\'))),
+                                      vcltq_u8(v, vdupq_n_u8(0x20)));
+        // Narrowing leaves four bits per byte
+        uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(special), 4)), 0);
+        if (mask) return (size_t)(src - start) + (size_t)__builtin_ctzll(mask) / 4;
+        src += 16;
+        dst += 16;
+    }
+#endif
+    while (end - src >= 8) {
+        uint64_t word;
+        memcpy(&word, src, 8);
+        memcpy(dst, &word, 8);
+        uint64_t quote = word ^ (ONES * '"');
+        uint64_t backslash = word ^ (ONES * '\\');
+        uint64_t special = ((quote - ONES) & ~quote) | ((backslash - ONES) & ~backslash) | ((word - ONES * 0x20) & ~word);
+        special &= HIGHS;
+        if (special) return (size_t)(src - start) + (size_t)__builtin_ctzll(special) / 8;
+        src += 8;
+        dst += 8;
+    }
+    while (src < end && *src != '"' && *src != '\\' && (unsigned char)*src >= 0x20) *dst++ = *src++;
+    return (size_t)(src - start);
+}
+
+// Escape-free runs are copied by copy_plain; out needs 6 bytes per input byte
+size_t dcore_json_escape(const char* s, size_t length, char* out) {
+    static const char hex[] = "0123456789abcdef";
+    const char* end = s + length;
+    char* dst = out;
+    for (;;) {
+        size_t run = copy_plain(s, end, dst);
+        s += run;
+        dst += run;
+        if (s == end) break;
+
+        unsigned char c = (unsigned char)*s++;
+        *dst++ = '\\';
+        switch (c) {
+            case '"': *dst++ = '"'; break;
+            case '\\': *dst++ = '\\'; break;
+            case '\n': *dst++ = 'n'; break;
+            case '\r': *dst++ = 'r'; break;
+            case '\t': *dst++ = 't'; break;
+            case '\b': *dst++ = 'b'; break;
+            case '\f': *dst++ = 'f'; break;
+            default:
+                memcpy(dst, "u00", 3);
+                dst[3] = hex[c >> 4];
+                dst[4] = hex[c & 15];
+                dst += 5;
+                break;
+        }
+    }
+    return (size_t)(dst - out);
+}
+
+// Unescapes the string literal whose opening quote is at src into the
+// string buffer
+static const char* parse_string(json_parser_t* p, const char* src, const char* end, size_t* length) {
+    uint32_t prefix = 0;
+    char* start = p->strings + sizeof(prefix);
+    char* dst = start;
+    src++;
+
+    for (;;) {
+        size_t run = copy_plain(src, end, dst);
+        src += run;
+        dst += run;
+        if (src >= end || (unsigned char)*src < 0x20) return NULL;
+
+        if (*src == '"') break;
+
+        size_t written = dcore_json_unescape(&src, end, dst);
+        if (written == 0) return NULL;
+        dst += written;
+    }
+
+    *dst = '\0';
+    *length = (size_t)(dst - start);
+    prefix = (uint32_t)*length;
+    memcpy(p->strings, &prefix, sizeof(prefix));
+    p->strings = dst + 1;
+    return start;
+}
+
+static const double exact_powers_of_ten[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+// Up to 18 digit integers and decimals whose digits fit a double with a
+// power of ten up to 1e22 are exact in one multiply or divide; anything
+// else goes through strtoll/strtod
+static int parse_number(const char* s, int64_t* integer, double* number) {
+    const char* p = s;
+    bool negative = *p == '-';
+    if (negative) p++;
+    if (!is_digit(*p)) return DCORE_JSON_INVALID;
+
+    uint64_t mantissa = 0;
+    const char* digits = p;
+    while (is_digit(*p)) mantissa = mantissa * 10 + (uint64_t)(*p++ - '0');
+    size_t digit_count = (size_t)(p - digits);
+    if (digit_count > 1 && *digits == '0') return DCORE_JSON_INVALID;
+
+    bool is_float = false;
+    int exponent = 0;
+    if (*p == '.') {
+        is_float = true;
+        const char* fraction = ++p;
+        while (is_digit(*p)) mantissa = mantissa * 10 + (uint64_t)(*p++ - '0');
+        if (p == fraction) return DCORE_JSON_INVALID;
+        digit_count += (size_t)(p - fraction);
+        exponent = -(int)(p - fraction);
+    }
+    if (*p == 'e' || *p == 'E') {
+        is_float = true;
+        p++;
+        bool negative_exponent = *p == '-';
+        if (*p == '+' || *p == '-') p++;
+        if (!is_digit(*p)) return DCORE_JSON_INVALID;
+        int e = 0;
+        while (is_digit(*p)) {
+            if (e < 100000) e = e * 10 + (*p - '0');
+            p++;
+        }
+        exponent += negative_exponent ? -e : e;
+    }
+    if (!ends_scalar(*p)) return DCORE_JSON_INVALID;
+
+    if (!is_float) {
+        if (digit_count <= 18) {
+            *integer = negative ? -(int64_t)mantissa : (int64_t)mantissa;
+            return DCORE_JSON_INT;
+        }
+        errno = 0;
+        long long v = strtoll(s, NULL, 10);
+        if (errno != ERANGE) {
+            *integer = v;
+            return DCORE_JSON_INT;
+        }
+    }
+
+    if (digit_count <= 19 && mantissa <= (1ULL << 53) && exponent >= -22 && exponent <= 22) {
+        double d = (double)mantissa;
+        d = exponent < 0 ? d / exact_powers_of_ten[-exponent] : d * exact_powers_of_ten[exponent];
+        *number = negative ? -d : d;
+    } else {
+        *number = strtod(s, NULL);
+    }
+    return DCORE_JSON_FLOAT;
+}
+
+static bool parse_literal(const char* s, const char* literal, size_t length) {
+    return strncmp(s, literal, length) == 0 && ends_scalar(s[length]);
+}
+
+int dcore_json_scalar(const char* s, int64_t* integer, double* number) {
+    switch (*s) {
+        case 't':
+            return parse_literal(s, "true", 4) ? DCORE_JSON_TRUE : DCORE_JSON_INVALID;
+        case 'f':
+            return parse_literal(s, "false", 5) ? DCORE_JSON_FALSE : DCORE_JSON_INVALID;
+        case 'n':
+            return parse_literal(s, "null", 4) ? DCORE_JSON_NULL : DCORE_JSON_INVALID;
+        default:
+            return parse_number(s, integer, number);
+    }
+}
+
+static bool parse_scalar(json_parser_t* p, const char* s, const char* end) {
+    dowel_json_value_t* value = push_entry(p, JSON_NULL);
+    if (*s == '"') {
+        size_t length;
+        value->type = JSON_STRING;
+        value->as.string = parse_string(p, s, end, &length);
+        return value->as.string != NULL;
+    }
+    switch (dcore_json_scalar(s, &value->as.integer, &value->as.number)) {
+        case DCORE_JSON_NULL:
+            return true;
+        case DCORE_JSON_TRUE:
+        case DCORE_JSON_FALSE:
+            value->type = JSON_BOOL;
+            value->as.boolean = *s == 't';
+            return true;
+        case DCORE_JSON_INT:
+            value->type = JSON_INT;
+            return true;
+        case DCORE_JSON_FLOAT:
+            value->type = JSON_FLOAT;
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Writes a directory for object into the string buffer
+static void add_directory(json_parser_t* p, dowel_json_value_t* object) {
+    uint32_t capacity = 1;
+    while (capacity < object->as.container.count * 2) capacity *= 2;
+    // A whole number of 16 byte units past the object
+    size_t distance = ((size_t)(p->strings - (char*)object) + 15) / 16;
+    json_directory_t* directory = (json_directory_t*)((char*)object + distance * 16);
+    directory->index = object->index;
+    directory->mask = capacity - 1;
+    memset(directory->slots, 0, capacity * sizeof(directory->slots[0]));
+
+    const dowel_json_value_t* name = object + 1;
+    for (uint32_t i = 0; i < object->as.container.count; i++) {
+        uint32_t slot = name->index & directory->mask;
+        while (directory->slots[slot].offset != 0) slot = (slot + 1) & directory->mask;
+        directory->slots[slot].hash = name->index;
+        directory->slots[slot].offset = (uint32_t)(name - object);
+        name = next_entry(name + 1);
+    }
+
+    p->strings = (char*)&directory->slots[capacity];
+    object->flags |= ENTRY_HAS_DIRECTORY;
+    object->index = (uint32_t)distance;
+}
+
+#define NEXT_CHAR(p) ((p)->next < (p)->count ? (p)->input[(p)->positions[(p)->next++]] : '\0')
+#define PEEK_CHAR(p) ((p)->next < (p)->count ? (p)->input[(p)->positions[(p)->next]] : '\0')
+
+static bool build_tape(json_parser_t* p, const char* end) {
+    json_frame_t stack[JSON_MAX_DEPTH];
+    int depth = 0;
+    const char* at;
+    char c;
+
+value:
+    if (p->next >= p->count) return false;
+    at = p->input + p->positions[p->next++];
+    if (*at == '{' || *at == '[') {
+        if (depth == JSON_MAX_DEPTH) return false;
+        bool object = *at == '{';
+        dowel_json_value_t* container = push_entry(p, object ? JSON_OBJECT : JSON_ARRAY);
+        stack[depth++] = (json_frame_t){ container->index, 0, object };
+        if (PEEK_CHAR(p) == (object ? '}' : ']')) {
+            p->next++;
+            goto close;
+        }
+        if (object) goto key;
+        stack[depth - 1].count++;
+        goto value;
+    }
+    if (!parse_scalar(p, at, end)) return false;
+
+next_member:
+    if (depth == 0) return p->next == p->count;
+    c = NEXT_CHAR(p);
+    if (c == ',') {
+        if (stack[depth - 1].object) goto key;
+        stack[depth - 1].count++;
+        goto value;
+    }
+    if (c != (stack[depth - 1].object ? '}' : ']')) return false;
+
+close:
+    depth--;
+    {
+        dowel_json_value_t* container = &p->tape[stack[depth].start];
+        container->as.container.count = stack[depth].count;
+        container->as.container.span = p->length - stack[depth].start;
+        if (stack[depth].object && stack[depth].count >= JSON_DIRECTORY_MIN) add_directory(p, container);
+    }
+    goto next_member;
+
+key:
+    if (PEEK_CHAR(p) != '"') return false;
+    at = p->input + p->positions[p->next++];
+    {
+        size_t length;
+        dowel_json_value_t* name = push_entry(p, JSON_KEY);
+        name->as.string = parse_string(p, at, end, &length);
+        if (!name->as.string) return false;
+        name->index = key_hash(name->as.string, length);
+    }
+    stack[depth - 1].count++;
+    if (NEXT_CHAR(p) != ':') return false;
+    goto value;
+}
+
+dowel_json_value_t* dowel_json_parse(const char* json_string) {
+    if (!json_string) return NULL;
+
+    size_t length = strlen(json_string);
+    if (length == 0 || length > UINT32_MAX - 64) return NULL;
+    uint32_t* positions = malloc((length + 1) * sizeof(*positions));
+    if (!positions) return NULL;
+
+    bool closed;
+    size_t count = dcore_json_structure(json_string, length, positions, &closed);
+    json_document_t* doc = NULL;
+    if (closed && count > 0) {
+        // Every tape entry starts at its own position, and a string's
+        // unescaped bytes plus length prefix and NUL exceed its literal by at
+        // most 3 bytes. A member takes at least four positions and at most
+        // four 8 byte directory slots, and each directory adds a header and
+        // alignment; 16 more cover the vector copy in copy_plain.
+        size_t tape_size = count * sizeof(dowel_json_value_t);
+        doc = malloc(sizeof(*doc) + tape_size + length + 12 * count + 16);
+    }
+    if (doc) {
+        doc->texts = NULL;
+        json_parser_t parser = {
+            .input = json_string,
+            .positions = positions,
+            .count = count,
+            .tape = doc->tape,
+            .strings = (char*)(doc->tape + count),
+        };
+        if (!build_tape(&parser, json_string + length)) {
+            free(doc);
+            doc = NULL;
+        }
+    }
+    free(positions);
+    return doc ? doc->tape : NULL;
+}
+
+void dowel_json_free(dowel_json_value_t* value) {
+    // Values inside a document are released with its root
+    if (!value || value->type == JSON_KEY || position_of(value) != 0) return;
+
+    json_document_t* doc = document_of(value);
+    while (doc->texts) {
+        text_block_t* next = doc->texts->next;
+        free(doc->texts);
+        doc->texts = next;
+    }
+    free(doc);
+}
+
+// Serialization
+
+static bool builder_reserve(json_builder_t* b, size_t extra) {
+    if (b->length + extra + 1 <= b->capacity) return true;
+
+    size_t capacity = b->capacity ? b->capacity : 64;
+    while (capacity < b->length + extra + 1) capacity *= 2;
+
+    char* data = realloc(b->data, capacity);
+    if (!data) return false;
+    b->data = data;
+    b->capacity = capacity;
+    return true;
+}
+
+static bool builder_append(json_builder_t* b, const char* data, size_t length) {
+    if (!builder_reserve(b, length)) return false;
+    memcpy(b->data + b->length, data, length);
+    b->length += length;
+    b->data[b->length] = '\0';
+    return true;
+}
+
+static bool write_string(json_builder_t* b, const char* s, size_t length) {
+    if (!builder_reserve(b, 6 * length + 2)) return false;
+    char* out = b->data + b->length;
+    *out++ = '"';
+    out += dcore_json_escape(s, length, out);
+    *out++ = '"';
+    b->length = (size_t)(out - b->data);
+    b->data[b->length] = '\0';
+    return true;
+}
+
+static bool write_value(json_builder_t* b, const dowel_json_value_t* value) {
+    char number[DCORE_JSON_NUMBER_MAX];
+
+    switch ((json_type_t)value->type) {
+        case JSON_NULL:
+            return builder_append(b, "null", 4);
+        case JSON_BOOL:
+            return value->as.boolean ? builder_append(b, "true", 4) : builder_append(b, "false", 5);
+        case JSON_INT:
+            return builder_append(b, number, dcore_json_format_int(value->as.integer, number));
+        case JSON_FLOAT:
+            // Out of range literals parse to infinity, which JSON cannot spell
+            if (!isfinite(value->as.number)) return builder_append(b, "null", 4);
+            return builder_append(b, number, dcore_json_format_double(value->as.number, number));
+        case JSON_STRING:
+        case JSON_KEY:
+            return write_string(b, value->as.string, string_length(value->as.string));
+        case JSON_ARRAY:
+        case JSON_OBJECT: {
+            bool is_object = value->type == JSON_OBJECT;
+            if (!builder_append(b, is_object ? "{" : "[", 1)) return false;
+            const dowel_json_value_t* member = value + 1;
+            for (uint32_t i = 0; i < value->as.container.count; i++) {
+                if (i > 0 && !builder_append(b, ",", 1)) return false;
+                if (is_object) {
+                    if (!write_value(b, member) || !builder_append(b, ":", 1)) return false;
+                    member++;
+                }
+                if (!write_value(b, member)) return false;
+                member = next_entry(member);
+            }
+            return builder_append(b, is_object ? "}" : "]", 1);
+        }
+    }
+    return false;
+}
+
+const char* dowel_json_stringify(const dowel_json_value_t* value) {
+    if (!value || value->type == JSON_KEY) return NULL;
+
+    // Room for the text_block_t header in front of the text
+    json_builder_t b = { 0 };
+    if (!builder_reserve(&b, sizeof(text_block_t))) return NULL;
+    b.length = sizeof(text_block_t);
+    if (!write_value(&b, value)) {
+        free(b.data);
+        return NULL;
+    }
+
+    json_document_t* doc = document_of(value);
+    text_block_t* block = (text_block_t*)b.data;
+    block->next = doc->texts;
+    doc->texts = block;
+    return block->text;
+}
+
+// Accessors
+
+dowel_json_value_t* dowel_json_get_object_value(const dowel_json_value_t* object, const char* key) {
+    if (!object || !key || object->type != JSON_OBJECT) return NULL;
+
+    size_t length = strlen(key);
+    uint32_t hash = key_hash(key, length);
+    if (object->flags & ENTRY_HAS_DIRECTORY) {
+        const json_directory_t* directory = directory_of(object);
+        for (uint32_t slot = hash & directory->mask; directory->slots[slot].offset != 0; slot = (slot + 1) & directory->mask) {
+            if (directory->slots[slot].hash != hash) continue;
+            const dowel_json_value_t* name = object + directory->slots[slot].offset;
+            if (string_length(name->as.string) == length && memcmp(name->as.string, key, length) == 0) {
+                return (dowel_json_value_t*)(name + 1);
+            }
+        }
+        return NULL;
+    }
+
+    const dowel_json_value_t* name = object + 1;
+    for (uint32_t i = 0; i < object->as.container.count; i++) {
+        const dowel_json_value_t* value = name + 1;
+        if (name->index == hash && string_length(name->as.string) == length && memcmp(name->as.string, key, length) == 0) {
+            return (dowel_json_value_t*)value;
+        }
+        name = next_entry(value);
+    }
+    return NULL;
+}
+
+const char* dowel_json_get_string(const dowel_json_value_t* value) {
+    if (!value || value->type != JSON_STRING) return NULL;
+    return value->as.string;
+}
+
+// Truncates toward zero; casting a double outside the int64 range is
+// undefined, so those saturate
+int64_t dcore_json_float_to_int(double number) {
+    if (number >= 9223372036854775808.0) return INT64_MAX;
+    if (number < -9223372036854775808.0) return INT64_MIN;
+    return number == number ? (int64_t)number : 0;
+}
+
+int64_t dowel_json_get_int(const dowel_json_value_t* value) {
+    if (!value) return 0;
+    if (value->type == JSON_INT) return value->as.integer;
+    if (value->type == JSON_FLOAT) return dcore_json_float_to_int(value->as.number);
+    return 0;
+}
+
+double dowel_json_get_float(const dowel_json_value_t* value) {
+    if (!value) return 0.0;
+    if (value->type == JSON_FLOAT) return value->as.number;
+    if (value->type == JSON_INT) return (double)value->as.integer;
+    return 0.0;
+}
+
+bool dowel_json_get_bool(const dowel_json_value_t* value) {
+    return value && value->type == JSON_BOOL && value->as.boolean;
+}
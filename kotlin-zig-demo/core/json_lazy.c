@@ -0,0 +1,374 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "core_internal.h"
+
+// On-demand JSON - navigation over the stage 1 index, without a tree
+//
+//  - Opening runs the same structural scan as dowel_json_parse, then one
+//    pass over the positions matches brackets and records for each
+//    position where the value starting there ends. That pair of uint32_t
+//    arrays is the whole index: 8 bytes per structural character, string
+//    and scalar, in one allocation.
+//  - A cursor is a position in that index. Member and element lookups hop
+//    from value to value through the end table, so skipping a subtree is
+//    one step. Keys are compared against the document's bytes in place,
+//    decoding escapes only where a key has them.
+//  - Values are read when a getter asks: numbers and literals are parsed
+//    from the text, strings are unescaped into the caller's buffer.
+//  - Only what a lookup walks through is validated. Brackets are checked
+//    when opening.
+
+#define JSON_MAX_DEPTH 512
+#define NOWHERE DOWEL_JSON_NOWHERE
+
+struct dowel_json_lazy {
+    const char* input; // borrowed
+    size_t length;
+    uint32_t count;
+    const uint32_t* positions; // byte offset of each structural character, opening quote and scalar
+    const uint32_t* next;      // for a value's first position, the position after the value
+    uint32_t* storage;         // positions and next, one allocation
+};
+
+static const dowel_json_cursor_t missing = { NULL, NOWHERE };
+
+static inline char char_at(const dowel_json_lazy_t* doc, uint32_t at) {
+    return doc->input[doc->positions[at]];
+}
+
+static inline bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static inline bool valid(dowel_json_cursor_t cursor) {
+    return cursor.doc && cursor.at < cursor.doc->count;
+}
+
+static inline dowel_json_cursor_t cursor_at(const dowel_json_lazy_t* doc, uint32_t at) {
+    return at == NOWHERE ? missing : (dowel_json_cursor_t){ doc, at };
+}
+
+// Fills next and checks that brackets pair up and the root value spans the
+// whole document
+static bool match_brackets(dowel_json_lazy_t* doc, uint32_t* next) {
+    uint32_t stack[JSON_MAX_DEPTH];
+    int depth = 0;
+    for (uint32_t i = 0; i < doc->count; i++) {
+        char c = char_at(doc, i);
+        next[i] = i + 1;
+        if (c == '{' || c == '[') {
+            if (depth == JSON_MAX_DEPTH) return false;
+            stack[depth++] = i;
+        } else if (c == '}' || c == ']') {
+            if (depth == 0 || char_at(doc, stack[depth - 1]) != (c == '}' ? '{' : '[')) return false;
+            next[stack[--depth]] = i + 1;
+        }
+    }
+    return depth == 0 && next[0] == doc->count;
+}
+
+dowel_json_lazy_t* dowel_json_lazy_open(const char* json) {
+    if (!json) return NULL;
+    size_t length = strlen(json);
+    if (length == 0 || length > UINT32_MAX - 64) return NULL;
+
+    dowel_json_lazy_t* doc = calloc(1, sizeof(*doc));
+    uint32_t* positions = malloc((length + 1) * sizeof(*positions));
+    if (!doc || !positions) goto fail;
+
+    bool closed;
+    size_t count = dcore_json_structure(json, length, positions, &closed);
+    if (!closed || count == 0) goto fail;
+
+    // Shrink the scratch list to the index itself
+    uint32_t* storage = realloc(positions, 2 * count * sizeof(*storage));
+    if (!storage) goto fail;
+    positions = storage;
+    doc->input = json;
+    doc->length = length;
+    doc->count = (uint32_t)count;
+    doc->storage = storage;
+    doc->positions = storage;
+    doc->next = storage + count;
+    if (!match_brackets(doc, storage + count)) goto fail;
+    return doc;
+
+fail:
+    free(positions);
+    free(doc);
+    return NULL;
+}
+
+void dowel_json_lazy_close(dowel_json_lazy_t* doc) {
+    if (!doc) return;
+    free(doc->storage);
+    free(doc);
+}
+
+size_t dowel_json_lazy_footprint(const dowel_json_lazy_t* doc) {
+    return doc ? sizeof(*doc) + 2 * (size_t)doc->count * sizeof(uint32_t) : 0;
+}
+
+dowel_json_cursor_t dowel_json_lazy_root(const dowel_json_lazy_t* doc) {
+    return doc ? cursor_at(doc, 0) : missing;
+}
+
+// Strings
+
+// The closing quote of the string opening at position at: the last
+// non-space byte before the next position
+static const char* string_end(const dowel_json_lazy_t* doc, uint32_t at) {
+    const char* start = doc->input + doc->positions[at];
+    const char* p = at + 1 < doc->count ? doc->input + doc->positions[at + 1] : doc->input + doc->length;
+    do {
+        p--;
+    } while (p > start && is_space(*p));
+    return p > start && *p == '"' ? p : NULL;
+}
+
+// Compares the literal between s and its closing quote end with key
+static bool string_equals(const char* s, const char* end, const char* key, size_t key_length) {
+    // Escapes only ever shorten a string
+    if ((size_t)(end - s) < key_length) return false;
+
+    const char* k = key;
+    const char* key_end = key + key_length;
+    while (s < end) {
+        const char* escape = memchr(s, '\\', (size_t)(end - s));
+        size_t run = (size_t)((escape ? escape : end) - s);
+        if ((size_t)(key_end - k) < run || memcmp(s, k, run) != 0) return false;
+        s += run;
+        k += run;
+        if (!escape) break;
+
+        char unit[4];
+        size_t written = dcore_json_unescape(&s, end, unit);
+        if (written == 0 || (size_t)(key_end - k) < written || memcmp(unit, k, written) != 0) return false;
+        k += written;
+    }
+    return k == key_end;
+}
+
+// Navigation
+
+static uint32_t find_member(const dowel_json_lazy_t* doc, uint32_t object, const char* key, size_t key_length) {
+    uint32_t end = doc->next[object] - 1; // the closing brace
+    uint32_t at = object + 1;
+    while (at < end) {
+        // "name" : value , ...
+        uint32_t value = at + 2;
+        if (char_at(doc, at) != '"' || value >= end || char_at(doc, at + 1) != ':') return NOWHERE;
+        const char* name_end = string_end(doc, at);
+        if (!name_end) return NOWHERE;
+        if (string_equals(doc->input + doc->positions[at] + 1, name_end, key, key_length)) return value;
+
+        uint32_t after = doc->next[value];
+        if (after >= end || char_at(doc, after) != ',') return NOWHERE;
+        at = after + 1;
+    }
+    return NOWHERE;
+}
+
+static uint32_t find_element(const dowel_json_lazy_t* doc, uint32_t array, size_t index) {
+    uint32_t end = doc->next[array] - 1; // the closing bracket
+    uint32_t at = array + 1;
+    for (size_t i = 0; at < end; i++) {
+        if (i == index) return at;
+        uint32_t after = doc->next[at];
+        if (after >= end || char_at(doc, after) != ',') return NOWHERE;
+        at = after + 1;
+    }
+    return NOWHERE;
+}
+
+dowel_json_cursor_t dowel_json_lazy_member(dowel_json_cursor_t object, const char* key) {
+    if (!valid(object) || !key || char_at(object.doc, object.at) != '{') return missing;
+    return cursor_at(object.doc, find_member(object.doc, object.at, key, strlen(key)));
+}
+
+dowel_json_cursor_t dowel_json_lazy_element(dowel_json_cursor_t array, size_t index) {
+    if (!valid(array) || char_at(array.doc, array.at) != '[') return missing;
+    return cursor_at(array.doc, find_element(array.doc, array.at, index));
+}
+
+size_t dowel_json_lazy_count(dowel_json_cursor_t container) {
+    if (!valid(container)) return 0;
+    const dowel_json_lazy_t* doc = container.doc;
+    char open = char_at(doc, container.at);
+    if (open != '{' && open != '[') return 0;
+
+    uint32_t end = doc->next[container.at] - 1;
+    uint32_t at = container.at + 1;
+    size_t count = 0;
+    while (at < end) {
+        // Stop at a member that is not "name" : value, or a value not
+        // followed by ',', as find_member and find_element do
+        uint32_t value = at;
+        if (open == '{') {
+            value = at + 2;
+            if (char_at(doc, at) != '"' || value >= end || char_at(doc, at + 1) != ':') break;
+        }
+        count++;
+        uint32_t after = doc->next[value];
+        if (after >= end || char_at(doc, after) != ',') break;
+        at = after + 1;
+    }
+    return count;
+}
+
+// One reference token of a JSON pointer, with ~1 and ~0 decoded
+static bool decode_token(const char* token, size_t length, char* out, size_t* out_length) {
+    size_t n = 0;
+    for (size_t i = 0; i < length; i++) {
+        if (token[i] != '~') {
+            out[n++] = token[i];
+        } else if (i + 1 < length && (token[i + 1] == '0' || token[i + 1] == '1')) {
+            out[n++] = token[++i] == '0' ? '~' : '/';
+        } else {
+            return false;
+        }
+    }
+    *out_length = n;
+    return true;
+}
+
+// An array index token: digits without a leading zero
+static bool token_index(const char* token, size_t length, size_t* index) {
+    if (length == 0 || length > 18 || (length > 1 && token[0] == '0')) return false;
+    size_t value = 0;
+    for (size_t i = 0; i < length; i++) {
+        if (token[i] < '0' || token[i] > '9') return false;
+        value = value * 10 + (size_t)(token[i] - '0');
+    }
+    *index = value;
+    return true;
+}
+
+dowel_json_cursor_t dowel_json_lazy_find(dowel_json_cursor_t from, const char* pointer) {
+    if (!valid(from) || !pointer) return missing;
+    if (*pointer != '\0' && *pointer != '/') return missing;
+
+    const dowel_json_lazy_t* doc = from.doc;
+    uint32_t at = from.at;
+    char local[256];
+    while (*pointer == '/' && at != NOWHERE) {
+        const char* token = ++pointer;
+        while (*pointer && *pointer != '/') pointer++;
+        size_t length = (size_t)(pointer - token);
+
+        char open = char_at(doc, at);
+        if (open == '{') {
+            char* key = length <= sizeof(local) ? local : malloc(length);
+            size_t key_length;
+            bool decoded = key && decode_token(token, length, key, &key_length);
+            at = decoded ? find_member(doc, at, key, key_length) : NOWHERE;
+            if (key != local) free(key);
+        } else if (open == '[') {
+            size_t index;
+            at = token_index(token, length, &index) ? find_element(doc, at, index) : NOWHERE;
+        } else {
+            at = NOWHERE;
+        }
+    }
+    return cursor_at(doc, at);
+}
+
+// Values
+
+dowel_json_type_t dowel_json_lazy_type(dowel_json_cursor_t value) {
+    if (!valid(value)) return DOWEL_JSON_TYPE_MISSING;
+    char c = char_at(value.doc, value.at);
+    switch (c) {
+        case '{': return DOWEL_JSON_TYPE_OBJECT;
+        case '[': return DOWEL_JSON_TYPE_ARRAY;
+        case '"': return DOWEL_JSON_TYPE_STRING;
+        case 't':
+        case 'f': return DOWEL_JSON_TYPE_BOOL;
+        case 'n': return DOWEL_JSON_TYPE_NULL;
+        default: return c == '-' || (c >= '0' && c <= '9') ? DOWEL_JSON_TYPE_NUMBER : DOWEL_JSON_TYPE_MISSING;
+    }
+}
+
+static int read_scalar(dowel_json_cursor_t value, int64_t* integer, double* number) {
+    if (!valid(value)) return DCORE_JSON_INVALID;
+    return dcore_json_scalar(value.doc->input + value.doc->positions[value.at], integer, number);
+}
+
+int64_t dowel_json_lazy_get_int(dowel_json_cursor_t value) {
+    int64_t integer = 0;
+    double number = 0.0;
+    switch (read_scalar(value, &integer, &number)) {
+        case DCORE_JSON_INT: return integer;
+        case DCORE_JSON_FLOAT: return dcore_json_float_to_int(number);
+        default: return 0;
+    }
+}
+
+double dowel_json_lazy_get_float(dowel_json_cursor_t value) {
+    int64_t integer = 0;
+    double number = 0.0;
+    switch (read_scalar(value, &integer, &number)) {
+        case DCORE_JSON_INT: return (double)integer;
+        case DCORE_JSON_FLOAT: return number;
+        default: return 0.0;
+    }
+}
+
+bool dowel_json_lazy_get_bool(dowel_json_cursor_t value) {
+    int64_t integer;
+    double number;
+    return read_scalar(value, &integer, &number) == DCORE_JSON_TRUE;
+}
+
+int64_t dowel_json_lazy_get_string(dowel_json_cursor_t value, char* out, size_t capacity) {
+    if (!valid(value) || char_at(value.doc, value.at) != '"') return -1;
+    const char* s = value.doc->input + value.doc->positions[value.at] + 1;
+    const char* end = string_end(value.doc, value.at);
+    if (!end) return -1;
+
+    size_t length = 0;
+    while (s < end) {
+        char unit[4];
+        size_t written = 1;
+        if (*s == '\\') {
+            written = dcore_json_unescape(&s, end, unit);
+            if (written == 0) return -1;
+        } else if ((unsigned char)*s < 0x20) {
+            return -1;
+        } else {
+            unit[0] = *s++;
+        }
+        for (size_t i = 0; i < written; i++, length++) {
+            if (length + 1 < capacity) out[length] = unit[i];
+        }
+    }
+    if (capacity > 0) out[length < capacity ? length : capacity - 1] = '\0';
+    return (int64_t)length;
+}
+
+const char* dowel_json_lazy_raw(dowel_json_cursor_t value, size_t* length) {
+    if (!valid(value) || !length) return NULL;
+    const dowel_json_lazy_t* doc = value.doc;
+    const char* start = doc->input + doc->positions[value.at];
+    const char* end;
+    switch (*start) {
+        case '{':
+        case '[':
+            end = doc->input + doc->positions[doc->next[value.at] - 1] + 1;
+            break;
+        case '"':
+            end = string_end(doc, value.at);
+            if (!end) return NULL;
+            end++;
+            break;
+        default:
+            end = start;
+            while (*end && !is_space(*end) && *end != ',' && *end != ']' && *end != '}' && *end != ':') end++;
+            break;
+    }
+    *length = (size_t)(end - start);
+    return start;
+}
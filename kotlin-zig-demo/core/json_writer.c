@@ -0,0 +1,663 @@
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "core_internal.h"
+
+// Streaming JSON writer
+//
+//  - Values go straight into the output as they are written; nothing is
+//    buffered per value and there is no tree. Output is either a buffer the
+//    writer grows (from malloc or the caller's arena) and hands back whole,
+//    or a fixed chunk that is passed to a dowel stream whenever it fills.
+//  - The writer tracks nesting with one bit per level, so a key outside an
+//    object, a value where a key belongs or an unbalanced end fails the
+//    writer instead of producing broken JSON. The first failure sticks:
+//    later calls do nothing and return it.
+//  - Strings are escaped by the same vector scan the parser uses for plain
+//    runs. Doubles are printed with Ryu (Adams, PLDI 2018): the shortest
+//    digits that read back to the same double, found with 128-bit
+//    multiplies against a table of powers of five.
+
+#define JSON_MAX_DEPTH 512
+#define STREAM_CHUNK (64 * 1024)
+#define ESCAPE_SLICE 4096 // bytes escaped per reservation, 6x that worst case
+
+struct dowel_json_writer {
+    dowel_arena_t* arena;
+    dowel_stream_t* stream; // NULL when writing to the buffer
+    char* data;
+    size_t length;
+    size_t capacity;
+    int error;
+    uint32_t depth;
+    bool comma;     // something was written at this level
+    bool after_key; // an object key is waiting for its value
+    uint64_t objects[JSON_MAX_DEPTH / 64]; // per level: object or array
+};
+
+// Number formatting
+
+static const char digit_pairs[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+static const uint64_t powers_of_ten[20] = {
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL,
+    1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL,
+    100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL, 100000000000000000ULL,
+    1000000000000000000ULL, 10000000000000000000ULL,
+};
+
+// Digits in v: the bit length times log10(2) is right or one too many
+static int decimal_length(uint64_t v) {
+    int guess = ((64 - __builtin_clzll(v | 1)) * 1233) >> 12;
+    return guess + (v >= powers_of_ten[guess]) + (guess == 0 && v == 0);
+}
+
+// Writes exactly n digits of v, right to left
+static void write_digits(uint64_t v, int n, char* out) {
+    char* p = out + n;
+    while (v >= 100) {
+        uint64_t pair = v % 100;
+        v /= 100;
+        p -= 2;
+        memcpy(p, digit_pairs + 2 * pair, 2);
+    }
+    if (v >= 10) {
+        p -= 2;
+        memcpy(p, digit_pairs + 2 * v, 2);
+    } else {
+        *--p = (char)('0' + v);
+    }
+}
+
+size_t dcore_json_format_int(int64_t value, char* out) {
+    char* p = out;
+    uint64_t magnitude = (uint64_t)value;
+    if (value < 0) {
+        *p++ = '-';
+        magnitude = 0 - magnitude;
+    }
+    int n = decimal_length(magnitude);
+    write_digits(magnitude, n, p);
+    return (size_t)(p + n - out);
+}
+
+// digits * 10^exponent as JavaScript would print it: plain notation while
+// the point is at most 21 places left or 6 places right of the digits,
+// otherwise d.ddde+x
+static size_t format_decimal(bool negative, uint64_t digits, int32_t exponent, char* out) {
+    char* p = out;
+    if (negative) *p++ = '-';
+    int n = decimal_length(digits);
+    int point = n + exponent;
+
+    if (exponent >= 0 && point <= 21) {
+        write_digits(digits, n, p);
+        memset(p + n, '0', (size_t)exponent);
+        p += point;
+    } else if (point > 0 && point <= 21) {
+        write_digits(digits, n, p + 1);
+        memmove(p, p + 1, (size_t)point);
+        p[point] = '.';
+        p += n + 1;
+    } else if (point > -6 && point <= 0) {
+        memcpy(p, "0.", 2);
+        memset(p + 2, '0', (size_t)-point);
+        p += 2 - point;
+        write_digits(digits, n, p);
+        p += n;
+    } else {
+        write_digits(digits, n, p + 1);
+        p[0] = p[1];
+        if (n > 1) {
+            p[1] = '.';
+            p += n + 1;
+        } else {
+            p += 1;
+        }
+        int e = point - 1;
+        *p++ = 'e';
+        *p++ = e < 0 ? '-' : '+';
+        if (e < 0) e = -e;
+        int e_length = decimal_length((uint64_t)e);
+        write_digits((uint64_t)e, e_length, p);
+        p += e_length;
+    }
+    return (size_t)(p - out);
+}
+
+#if defined(__SIZEOF_INT128__)
+
+#define MANTISSA_BITS 52
+#define EXPONENT_BIAS 1023
+#define POW5_INV_BITCOUNT 125
+#define POW5_BITCOUNT 125
+#define POW5_INV_TABLE_SIZE 342
+#define POW5_TABLE_SIZE 326
+
+typedef unsigned __int128 uint128_t;
+
+// 2^k / 5^q and 5^i scaled to 125 significant bits, as { low, high }
+static uint64_t pow5_inv_split[POW5_INV_TABLE_SIZE][2];
+static uint64_t pow5_split[POW5_TABLE_SIZE][2];
+static pthread_once_t tables_once = PTHREAD_ONCE_INIT;
+
+// ceil(e * log2(5)), the bit length of 5^e
+static inline int32_t pow5bits(int32_t e) {
+    return (int32_t)(((uint32_t)e * 1217359) >> 19) + 1;
+}
+
+// floor(e * log10(2)) and floor(e * log10(5))
+static inline uint32_t log10_pow2(int32_t e) {
+    return ((uint32_t)e * 78913) >> 18;
+}
+
+static inline uint32_t log10_pow5(int32_t e) {
+    return ((uint32_t)e * 732923) >> 20;
+}
+
+// The tables are exact, so they are derived with big integers once instead
+// of being shipped as constants
+#define BIG_LIMBS 34 // 1088 bits, more than 5^325 and the 2^1056 numerator
+
+// Bits [shift, shift + 128) of big; bits below zero read as zero
+static void big_window(const uint32_t* big, int shift, uint64_t out[2]) {
+    out[0] = out[1] = 0;
+    for (int bit = 0; bit < 128; bit++) {
+        int source = shift + bit;
+        if (source < 0 || source >= 32 * BIG_LIMBS) continue;
+        if ((big[source / 32] >> (source % 32)) & 1) out[bit / 64] |= 1ULL << (bit % 64);
+    }
+}
+
+static void build_tables(void) {
+    // 5^i, keeping its top POW5_BITCOUNT bits
+    uint32_t power[BIG_LIMBS] = { 1 };
+    for (int i = 0; i < POW5_TABLE_SIZE; i++) {
+        big_window(power, pow5bits(i) - POW5_BITCOUNT, pow5_split[i]);
+        uint64_t carry = 0;
+        for (int limb = 0; limb < BIG_LIMBS; limb++) {
+            uint64_t product = (uint64_t)power[limb] * 5 + carry;
+            power[limb] = (uint32_t)product;
+            carry = product >> 32;
+        }
+    }
+
+    // floor(2^N / 5^q) by repeated division, so floor(2^k / 5^q) + 1 is a
+    // window of it
+    const int numerator_bits = 1056;
+    uint32_t quotient[BIG_LIMBS] = { 0 };
+    quotient[numerator_bits / 32] = 1u << (numerator_bits % 32);
+    for (int q = 0; q < POW5_INV_TABLE_SIZE; q++) {
+        int k = pow5bits(q) - 1 + POW5_INV_BITCOUNT;
+        uint64_t* entry = pow5_inv_split[q];
+        big_window(quotient, numerator_bits - k, entry);
+        if (++entry[0] == 0) entry[1]++;
+
+        uint64_t remainder = 0;
+        for (int limb = BIG_LIMBS - 1; limb >= 0; limb--) {
+            uint64_t part = (remainder << 32) | quotient[limb];
+            quotient[limb] = (uint32_t)(part / 5);
+            remainder = part % 5;
+        }
+    }
+}
+
+static inline uint64_t mul_shift(uint64_t m, const uint64_t* mul, int32_t j) {
+    uint128_t low = (uint128_t)m * mul[0];
+    uint128_t high = (uint128_t)m * mul[1];
+    return (uint64_t)(((low >> 64) + high) >> (j - 64));
+}
+
+static inline uint32_t pow5_factor(uint64_t value) {
+    uint32_t count = 0;
+    while (value % 5 == 0) {
+        value /= 5;
+        count++;
+    }
+    return count;
+}
+
+static inline bool multiple_of_pow5(uint64_t value, uint32_t p) {
+    return pow5_factor(value) >= p;
+}
+
+static inline bool multiple_of_pow2(uint64_t value, uint32_t p) {
+    return (value & ((1ULL << p) - 1)) == 0;
+}
+
+// The shortest decimal in the rounding interval of a positive finite double
+static void shortest(uint64_t ieee_mantissa, uint32_t ieee_exponent, uint64_t* digits, int32_t* exponent) {
+    int32_t e2;
+    uint64_t m2;
+    if (ieee_exponent == 0) {
+        e2 = 1 - EXPONENT_BIAS - MANTISSA_BITS - 2;
+        m2 = ieee_mantissa;
+    } else {
+        e2 = (int32_t)ieee_exponent - EXPONENT_BIAS - MANTISSA_BITS - 2;
+        m2 = (1ULL << MANTISSA_BITS) | ieee_mantissa;
+    }
+    const bool accept_bounds = (m2 & 1) == 0;
+
+    // The value and its neighbours' midpoints, times four
+    const uint64_t mv = 4 * m2;
+    const uint32_t mm_shift = ieee_mantissa != 0 || ieee_exponent <= 1;
+
+    uint64_t vr, vp, vm;
+    int32_t e10;
+    bool vm_trailing_zeros = false;
+    bool vr_trailing_zeros = false;
+    if (e2 >= 0) {
+        const uint32_t q = log10_pow2(e2) - (e2 > 3);
+        e10 = (int32_t)q;
+        const int32_t k = POW5_INV_BITCOUNT + pow5bits((int32_t)q) - 1;
+        const int32_t i = -e2 + (int32_t)q + k;
+        vr = mul_shift(mv, pow5_inv_split[q], i);
+        vp = mul_shift(mv + 2, pow5_inv_split[q], i);
+        vm = mul_shift(mv - 1 - mm_shift, pow5_inv_split[q], i);
+        if (q <= 21) {
+            if (mv % 5 == 0) {
+                vr_trailing_zeros = multiple_of_pow5(mv, q);
+            } else if (accept_bounds) {
+                vm_trailing_zeros = multiple_of_pow5(mv - 1 - mm_shift, q);
+            } else {
+                vp -= multiple_of_pow5(mv + 2, q);
+            }
+        }
+    } else {
+        const uint32_t q = log10_pow5(-e2) - (-e2 > 1);
+        e10 = (int32_t)q + e2;
+        const int32_t i = -e2 - (int32_t)q;
+        const int32_t k = pow5bits(i) - POW5_BITCOUNT;
+        const int32_t j = (int32_t)q - k;
+        vr = mul_shift(mv, pow5_split[i], j);
+        vp = mul_shift(mv + 2, pow5_split[i], j);
+        vm = mul_shift(mv - 1 - mm_shift, pow5_split[i], j);
+        if (q <= 1) {
+            vr_trailing_zeros = true;
+            if (accept_bounds) {
+                vm_trailing_zeros = mm_shift == 1;
+            } else {
+                vp--;
+            }
+        } else if (q < 63) {
+            vr_trailing_zeros = multiple_of_pow2(mv, q);
+        }
+    }
+
+    // Drop digits while the interval still holds a shorter number
+    int32_t removed = 0;
+    uint8_t last_removed = 0;
+    uint64_t output;
+    if (vm_trailing_zeros || vr_trailing_zeros) {
+        while (vp / 10 > vm / 10) {
+            vm_trailing_zeros &= vm % 10 == 0;
+            vr_trailing_zeros &= last_removed == 0;
+            last_removed = (uint8_t)(vr % 10);
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            removed++;
+        }
+        if (vm_trailing_zeros) {
+            while (vm % 10 == 0) {
+                vr_trailing_zeros &= last_removed == 0;
+                last_removed = (uint8_t)(vr % 10);
+                vr /= 10;
+                vp /= 10;
+                vm /= 10;
+                removed++;
+            }
+        }
+        // Exactly halfway rounds to even
+        if (vr_trailing_zeros && last_removed == 5 && vr % 2 == 0) last_removed = 4;
+        output = vr + ((vr == vm && (!accept_bounds || !vm_trailing_zeros)) || last_removed >= 5);
+    } else {
+        bool round_up = false;
+        if (vp / 100 > vm / 100) {
+            round_up = vr % 100 >= 50;
+            vr /= 100;
+            vp /= 100;
+            vm /= 100;
+            removed += 2;
+        }
+        while (vp / 10 > vm / 10) {
+            round_up = vr % 10 >= 5;
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            removed++;
+        }
+        output = vr + (vr == vm || round_up);
+    }
+    *digits = output;
+    *exponent = e10 + removed;
+}
+
+size_t dcore_json_format_double(double value, char* out) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    bool negative = bits >> 63;
+    uint64_t ieee_mantissa = bits & ((1ULL << MANTISSA_BITS) - 1);
+    uint32_t ieee_exponent = (uint32_t)((bits >> MANTISSA_BITS) & 0x7ff);
+    if (ieee_exponent == 0 && ieee_mantissa == 0) return format_decimal(negative, 0, 0, out);
+
+    pthread_once(&tables_once, build_tables);
+    uint64_t digits;
+    int32_t exponent;
+    shortest(ieee_mantissa, ieee_exponent, &digits, &exponent);
+    return format_decimal(negative, digits, exponent, out);
+}
+
+#else
+
+// Without 128-bit multiplies: the fewest %e digits that read back exactly
+size_t dcore_json_format_double(double value, char* out) {
+    char text[DCORE_JSON_NUMBER_MAX];
+    for (int precision = 0; precision < 17; precision++) {
+        snprintf(text, sizeof(text), "%.*e", precision, value);
+        if (strtod(text, NULL) == value) break;
+    }
+    // Back to digits * 10^exponent
+    bool negative = text[0] == '-';
+    uint64_t digits = 0;
+    int32_t exponent = 0;
+    const char* p = text + negative;
+    for (; *p != 'e'; p++) {
+        if (*p == '.') continue;
+        digits = digits * 10 + (uint64_t)(*p - '0');
+        exponent--;
+    }
+    exponent += (int32_t)strtol(p + 1, NULL, 10) + 1;
+    while (digits != 0 && digits % 10 == 0) {
+        digits /= 10;
+        exponent++;
+    }
+    return format_decimal(negative, digits, exponent, out);
+}
+
+#endif
+
+// Writer
+
+static int fail(dowel_json_writer_t* w, int error, const char* message) {
+    if (w->error == 0) {
+        w->error = error;
+        dcore_report_error(error, message);
+    }
+    return w->error;
+}
+
+static bool flush(dowel_json_writer_t* w) {
+    if (w->length == 0) return true;
+    int64_t written = dowel_stream_write(w->stream, (const uint8_t*)w->data, w->length);
+    if (written < 0) {
+        fail(w, (int)written, "JSON writer could not write to its stream");
+        return false;
+    }
+    w->length = 0;
+    return true;
+}
+
+static char* grow(dowel_json_writer_t* w, size_t size) {
+    if (w->stream) {
+        if (!flush(w)) return NULL;
+        if (w->capacity > size) return w->data;
+    }
+
+    size_t capacity = w->capacity ? w->capacity : 256;
+    while (capacity <= w->length + size) capacity *= 2;
+    char* data = dcore_realloc_in(w->arena, w->data, w->capacity, capacity);
+    if (!data) {
+        fail(w, DOWEL_ERROR_OUT_OF_MEMORY, "JSON writer ran out of memory");
+        return NULL;
+    }
+    w->data = data;
+    w->capacity = capacity;
+    return data + w->length;
+}
+
+// Room for size more bytes (plus a NUL in buffer mode), or NULL on failure
+static inline char* reserve(dowel_json_writer_t* w, size_t size) {
+    if (w->capacity - w->length > size) return w->data + w->length;
+    return grow(w, size);
+}
+
+static inline bool put(dowel_json_writer_t* w, const char* data, size_t size) {
+    char* out = reserve(w, size);
+    if (!out) return false;
+    memcpy(out, data, size);
+    w->length += size;
+    return true;
+}
+
+// The quoted string, then trail if it is not NUL. Short strings take one
+// reservation; long ones are escaped a slice at a time.
+static bool put_string(dowel_json_writer_t* w, const char* s, size_t length, char trail) {
+    if (length <= ESCAPE_SLICE) {
+        char* out = reserve(w, 6 * length + 3);
+        if (!out) return false;
+        char* p = out;
+        *p++ = '"';
+        p += dcore_json_escape(s, length, p);
+        *p++ = '"';
+        if (trail) *p++ = trail;
+        w->length += (size_t)(p - out);
+        return true;
+    }
+
+    if (!put(w, "\"", 1)) return false;
+    while (length > 0) {
+        size_t slice = length < ESCAPE_SLICE ? length : ESCAPE_SLICE;
+        char* out = reserve(w, 6 * slice);
+        if (!out) return false;
+        w->length += dcore_json_escape(s, slice, out);
+        s += slice;
+        length -= slice;
+    }
+    char end[2] = { '"', trail };
+    return put(w, end, trail ? 2 : 1);
+}
+
+static inline bool in_object(const dowel_json_writer_t* w) {
+    uint32_t level = w->depth - 1;
+    return w->depth > 0 && (w->objects[level / 64] >> (level % 64)) & 1;
+}
+
+// Checks that a value may come next and writes the comma before it
+static bool begin_value(dowel_json_writer_t* w) {
+    if (w->error) return false;
+    if (w->depth == 0) {
+        if (w->comma) {
+            fail(w, DOWEL_ERROR_INVALID_PARAMETER, "JSON writer already wrote its value");
+            return false;
+        }
+    } else if (in_object(w)) {
+        if (!w->after_key) {
+            fail(w, DOWEL_ERROR_INVALID_PARAMETER, "JSON writer expected a key");
+            return false;
+        }
+    } else if (w->comma && !put(w, ",", 1)) {
+        return false;
+    }
+    w->comma = true;
+    w->after_key = false;
+    return true;
+}
+
+static dowel_json_writer_t* writer_new(dowel_arena_t* arena, dowel_stream_t* stream) {
+    dowel_json_writer_t* w = dcore_alloc_in(arena, sizeof(*w));
+    if (!w) {
+        dcore_report_error(DOWEL_ERROR_OUT_OF_MEMORY, "Failed to allocate JSON writer");
+        return NULL;
+    }
+    memset(w, 0, sizeof(*w));
+    w->arena = arena;
+    w->stream = stream;
+    if (stream) {
+        w->data = malloc(STREAM_CHUNK);
+        w->capacity = STREAM_CHUNK;
+        if (!w->data) {
+            dcore_free_in(arena, w);
+            dcore_report_error(DOWEL_ERROR_OUT_OF_MEMORY, "Failed to allocate JSON writer");
+            return NULL;
+        }
+    }
+    return w;
+}
+
+dowel_json_writer_t* dowel_json_writer_create(void) {
+    return writer_new(NULL, NULL);
+}
+
+dowel_json_writer_t* dowel_json_writer_create_in(dowel_arena_t* arena) {
+    return writer_new(arena, NULL);
+}
+
+dowel_json_writer_t* dowel_json_writer_create_for_stream(dowel_stream_t* stream) {
+    if (!stream) {
+        dcore_report_error(DOWEL_ERROR_INVALID_PARAMETER, "JSON writer needs a stream");
+        return NULL;
+    }
+    return writer_new(NULL, stream);
+}
+
+void dowel_json_writer_destroy(dowel_json_writer_t* w) {
+    if (!w) return;
+    dcore_free_in(w->arena, w->data);
+    dcore_free_in(w->arena, w);
+}
+
+int dowel_json_writer_begin_object(dowel_json_writer_t* w) {
+    if (!w) return DOWEL_ERROR_INVALID_PARAMETER;
+    if (!begin_value(w)) return w->error;
+    if (w->depth == JSON_MAX_DEPTH) return fail(w, DOWEL_ERROR_INVALID_PARAMETER, "JSON writer nested too deeply");
+    if (!put(w, "{", 1)) return w->error;
+    w->objects[w->depth / 64] |= 1ULL << (w->depth % 64);
+    w->depth++;
+    w->comma = false;
+    return 0;
+}
+
+int dowel_json_writer_begin_array(dowel_json_writer_t* w) {
+    if (!w) return DOWEL_ERROR_INVALID_PARAMETER;
+    if (!begin_value(w)) return w->error;
+    if (w->depth == JSON_MAX_DEPTH) return fail(w, DOWEL_ERROR_INVALID_PARAMETER, "JSON writer nested too deeply");
+    if (!put(w, "[", 1)) return w->error;
+    w->objects[w->depth / 64] &= ~(1ULL << (w->depth % 64));
+    w->depth++;
+    w->comma = false;
+    return 0;
+}
+
+static int end_container(dowel_json_writer_t* w, bool object) {
+    if (!w) return DOWEL_ERROR_INVALID_PARAMETER;
+    if (w->error) return w->error;
+    if (w->depth == 0 || in_object(w) != object || w->after_key) {
+        return fail(w, DOWEL_ERROR_INVALID_PARAMETER, "JSON writer end does not match its begin");
+    }
+    if (!put(w, object ? "}" : "]", 1)) return w->error;
+    w->depth--;
+    w->comma = true;
+    return 0;
+}
+
+int dowel_json_writer_end_object(dowel_json_writer_t* w) {
+    return end_container(w, true);
+}
+
+int dowel_json_writer_end_array(dowel_json_writer_t* w) {
+    return end_container(w, false);
+}
+
+int dowel_json_writer_key(dowel_json_writer_t* w, const char* key, size_t length) {
+    if (!w) return DOWEL_ERROR_INVALID_PARAMETER;
+    if (w->error) return w->error;
+    if (!key && length > 0) return fail(w, DOWEL_ERROR_INVALID_PARAMETER, "JSON writer key is NULL");
+    if (!in_object(w) || w->after_key) return fail(w, DOWEL_ERROR_INVALID_PARAMETER, "JSON writer key outside an object");
+    if (w->comma && !put(w, ",", 1)) return w->error;
+    if (!put_string(w, key, length, ':')) return w->error;
+    w->comma = true;
+    w->after_key = true;
+    return 0;
+}
+
+int dowel_json_writer_string(dowel_json_writer_t* w, const char* s, size_t length) {
+    if (!w) return DOWEL_ERROR_INVALID_PARAMETER;
+    if (!s && length > 0) return fail(w, DOWEL_ERROR_INVALID_PARAMETER, "JSON writer string is NULL");
+    if (!begin_value(w) || !put_string(w, s, length, '\0')) return w->error;
+    return 0;
+}
+
+int dowel_json_writer_int(dowel_json_writer_t* w, int64_t value) {
+    if (!w) return DOWEL_ERROR_INVALID_PARAMETER;
+    if (!begin_value(w)) return w->error;
+    char* out = reserve(w, DCORE_JSON_NUMBER_MAX);
+    if (!out) return w->error;
+    w->length += dcore_json_format_int(value, out);
+    return 0;
+}
+
+int dowel_json_writer_float(dowel_json_writer_t* w, double value) {
+    if (!w) return DOWEL_ERROR_INVALID_PARAMETER;
+    if (!isfinite(value)) return fail(w, DOWEL_ERROR_INVALID_PARAMETER, "JSON has no infinity or NaN");
+    if (!begin_value(w)) return w->error;
+    char* out = reserve(w, DCORE_JSON_NUMBER_MAX);
+    if (!out) return w->error;
+    w->length += dcore_json_format_double(value, out);
+    return 0;
+}
+
+int dowel_json_writer_bool(dowel_json_writer_t* w, bool value) {
+    if (!w) return DOWEL_ERROR_INVALID_PARAMETER;
+    if (!begin_value(w) || !(value ? put(w, "true", 4) : put(w, "false", 5))) return w->error;
+    return 0;
+}
+
+int dowel_json_writer_null(dowel_json_writer_t* w) {
+    if (!w) return DOWEL_ERROR_INVALID_PARAMETER;
+    if (!begin_value(w) || !put(w, "null", 4)) return w->error;
+    return 0;
+}
+
+int dowel_json_writer_raw(dowel_json_writer_t* w, const char* json, size_t length) {
+    if (!w) return DOWEL_ERROR_INVALID_PARAMETER;
+    if (!json || length == 0) return fail(w, DOWEL_ERROR_INVALID_PARAMETER, "JSON writer raw value is empty");
+    if (!begin_value(w) || !put(w, json, length)) return w->error;
+    return 0;
+}
+
+int dowel_json_writer_finish(dowel_json_writer_t* w) {
+    if (!w) return DOWEL_ERROR_INVALID_PARAMETER;
+    if (w->error) return w->error;
+    if (w->depth != 0 || !w->comma) return fail(w, DOWEL_ERROR_INVALID_PARAMETER, "JSON writer finished an incomplete value");
+    if (w->stream && !flush(w)) return w->error;
+    return 0;
+}
+
+const char* dowel_json_writer_text(dowel_json_writer_t* w, size_t* length) {
+    if (!w || w->stream || w->error) return NULL;
+    if (!reserve(w, 0)) return NULL;
+    w->data[w->length] = '\0';
+    if (length) *length = w->length;
+    return w->data;
+}
+
+int dowel_json_writer_error(const dowel_json_writer_t* w) {
+    return w ? w->error : DOWEL_ERROR_INVALID_PARAMETER;
+}
+
+void dowel_json_writer_reset(dowel_json_writer_t* w) {
+    if (!w || w->stream) return;
+    w->length = 0;
+    w->error = 0;
+    w->depth = 0;
+    w->comma = false;
+    w->after_key = false;
+}
@@ -0,0 +1,88 @@
+#include <string.h>
+
+#include "log_format.h"
+
+int dcore_blog_next_spec(const char** cursor, dcore_blog_spec_t* spec) {
+    const char* p = *cursor;
+
+    for (;;) {
+        p = strchr(p, '%');
+        if (!p) {
+            *cursor += strlen(*cursor);
+            return 0;
+        }
+        if (p[1] != '%') break;
+        p += 2;
+    }
+
+    const char* start = p++;
+    while (*p && strchr("-+ #0'", *p)) p++;
+    while (*p >= '0' && *p <= '9') p++;
+    if (*p == '.') {
+        p++;
+        while (*p >= '0' && *p <= '9') p++;
+    }
+    if (*p == '*') return -1;
+
+    int longs = 0;
+    char modifier = 0;
+    for (;; p++) {
+        if (*p == 'l') {
+            longs++;
+        } else if (*p == 'h') {
+            // Promoted to int either way
+        } else if (*p == 'z' || *p == 't' || *p == 'j' || *p == 'L' || *p == 'q') {
+            modifier = *p;
+        } else {
+            break;
+        }
+    }
+
+    uint8_t type;
+    switch (*p) {
+        case 'c':
+            // %lc takes a wint_t and needs the locale, so it is formatted on the spot
+            if (longs || modifier) return -1;
+            type = DCORE_BLOG_ARG_INT;
+            break;
+        case 'd': case 'i': case 'u': case 'x': case 'X': case 'o':
+            if (modifier == 'z' || modifier == 't') type = DCORE_BLOG_ARG_SIZE;
+            else if (modifier == 'j' || modifier == 'q' || longs >= 2) type = DCORE_BLOG_ARG_LLONG;
+            else if (longs == 1) type = DCORE_BLOG_ARG_LONG;
+            else if (modifier == 'L') return -1;
+            else type = DCORE_BLOG_ARG_INT;
+            break;
+        case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+            if (modifier == 'L') return -1;
+            type = DCORE_BLOG_ARG_DOUBLE;
+            break;
+        case 's':
+            if (longs || modifier) return -1;
+            type = DCORE_BLOG_ARG_STRING;
+            break;
+        case 'p':
+            type = DCORE_BLOG_ARG_POINTER;
+            break;
+        default:
+            return -1; // %n, wide strings, or a malformed conversion
+    }
+
+    spec->start = start;
+    spec->length = (size_t)(p + 1 - start);
+    spec->conversion = *p;
+    spec->type = type;
+    *cursor = p + 1;
+    return 1;
+}
+
+int dcore_blog_parse_format(const char* format, uint8_t types[DCORE_BLOG_MAX_ARGS]) {
+    int count = 0;
+    dcore_blog_spec_t spec;
+    int found;
+
+    while ((found = dcore_blog_next_spec(&format, &spec)) > 0) {
+        if (count == DCORE_BLOG_MAX_ARGS) return -1;
+        types[count++] = spec.type;
+    }
+    return found < 0 ? -1 : count;
+}
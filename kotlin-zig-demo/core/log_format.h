@@ -0,0 +1,71 @@
+#ifndef DOWEL_LOG_FORMAT_H
+#define DOWEL_LOG_FORMAT_H
+
+// Binary structured log format, shared by the core (log_structured.c) and the
+// offline decoder (tools/log_decode.c).
+//
+// A file starts with the 8 byte magic "DOWELBL1" followed by records. Every
+// record starts with a 4 byte frame: u16 size of the whole record, u8 kind,
+// u8 level. Integers are in host byte order, so decode on the same
+// architecture (little endian on every platform the core targets).
+//
+//   SITE  u32 site id, u8 argument count, u8 argument types[count],
+//         u16 module length, module, u16 format length, format
+//   ENTRY u32 site id, u64 wall clock time in ns, then one value per argument:
+//         8 bytes for numbers and pointers, u16 length + bytes for strings
+//
+// Each file gets a SITE record for every call site used while it was open,
+// queued by the first thread to use it. Entries from other threads can reach
+// the file before it, so decoders read all SITE records before formatting.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DCORE_BLOG_MAGIC "DOWELBL1"
+#define DCORE_BLOG_MAGIC_SIZE 8
+#define DCORE_BLOG_FRAME_SIZE 4
+#define DCORE_BLOG_MAX_ARGS 16
+#define DCORE_BLOG_MAX_STRING 1024
+
+enum {
+    DCORE_BLOG_SITE = 1,
+    DCORE_BLOG_ENTRY = 2,
+};
+
+// How an argument is read from the va_list and stored
+typedef enum {
+    DCORE_BLOG_ARG_INT = 0,     // int or unsigned (also %c and h/hh)
+    DCORE_BLOG_ARG_LONG = 1,    // l
+    DCORE_BLOG_ARG_LLONG = 2,   // ll, j
+    DCORE_BLOG_ARG_SIZE = 3,    // z, t
+    DCORE_BLOG_ARG_DOUBLE = 4,  // f e g a
+    DCORE_BLOG_ARG_STRING = 5,  // s
+    DCORE_BLOG_ARG_POINTER = 6, // p
+} dcore_blog_arg_t;
+
+typedef struct {
+    const char* start; // the '%'
+    size_t length;     // up to and including the conversion character
+    char conversion;
+    uint8_t type;      // dcore_blog_arg_t
+} dcore_blog_spec_t;
+
+// Finds the next conversion at or after *cursor and moves the cursor past it.
+// "%%" is treated as literal text. Returns 1 for a conversion, 0 at the end
+// of the string and -1 for conversions that cannot be deferred ('*' widths,
+// %n, wide characters and strings, long double).
+int dcore_blog_next_spec(const char** cursor, dcore_blog_spec_t* spec);
+
+// Parses every conversion of format into types. Returns the argument count,
+// or -1 if the format cannot be deferred or has too many arguments.
+int dcore_blog_parse_format(const char* format, uint8_t types[DCORE_BLOG_MAX_ARGS]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DOWEL_LOG_FORMAT_H
@@ -0,0 +1,584 @@
+#define _GNU_SOURCE
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#if defined(__linux__)
+#include <linux/membarrier.h>
+#include <sys/syscall.h>
+#endif
+
+#include "log_pipeline.h"
+
+// Layout:
+//  - Every thread that logs owns one log_ring_t, registered on its first entry
+//    and found again through a thread-local pointer. Only that thread advances
+//    head; only the writer advances tail.
+//  - A record is a 4 byte header (length, stream) followed by the formatted
+//    line, padded to 4 bytes. Records never wrap: when the end of the buffer
+//    is too short the producer fills it with a padding record, so every line
+//    can be passed to writev straight from the ring.
+//  - While every ring is empty the writer sleeps without a timeout. The first
+//    entry after that wakes it, and it drains DRAIN_INTERVAL_NS later so a
+//    burst usually reaches the kernel in a few writev calls. Producers wake it
+//    at once when a ring is a quarter full or the entry is WARN or above.
+//  - Rings of exited threads are drained and freed by the writer; their
+//    counters are folded into the retired totals first.
+
+#define RING_MASK (DCORE_LOG_RING_SIZE - 1)
+#define RECORD_HEADER_SIZE 4
+#define WAKE_THRESHOLD (DCORE_LOG_RING_SIZE / 4)
+#define DRAIN_INTERVAL_NS (10 * 1000 * 1000)
+
+#ifdef IOV_MAX
+#define BATCH_IOV IOV_MAX
+#else
+#define BATCH_IOV 1024
+#endif
+
+enum { STREAM_OUT = 0, STREAM_ERR = 1, STREAM_BINARY = 2, STREAM_PAD = 3 };
+#define STREAM_COUNT 3
+
+typedef struct log_ring {
+    struct log_ring* next;
+    _Atomic bool orphaned;
+
+    // Counters are written by the owning thread only and summed on demand
+    _Atomic uint64_t entries[DCORE_LOG_LEVEL_COUNT];
+    _Atomic uint64_t dropped;
+
+    _Alignas(64) _Atomic uint64_t head;
+    _Alignas(64) _Atomic uint64_t tail;
+    _Alignas(64) uint8_t data[DCORE_LOG_RING_SIZE];
+} log_ring_t;
+
+static const char* const level_names[DCORE_LOG_LEVEL_COUNT] = {
+    "TRACE", "DEBUG", "INFO", "WARN", "ERROR", "FATAL",
+};
+
+static struct {
+    // Registry of rings, held by the writer while it drains
+    pthread_mutex_t registry_lock;
+    log_ring_t* rings;
+    uint64_t retired_entries[DCORE_LOG_LEVEL_COUNT];
+    uint64_t retired_dropped;
+    size_t memory_in_use;
+    size_t peak_memory;
+
+    // Writer thread and flush handshake
+    pthread_mutex_t lock;
+    pthread_cond_t wake_cond;
+    pthread_cond_t flushed_cond;
+    pthread_t writer;
+    _Atomic bool running;
+    bool stopping;
+    uint64_t flush_requested;
+    uint64_t flush_completed;
+    _Atomic bool wake_pending;
+    _Atomic bool idle; // writer is asleep with every ring empty
+    bool membarrier;   // writer fences every thread when it goes idle
+
+    _Atomic int min_level;
+    _Atomic int out_fd;
+    _Atomic int err_fd;
+    _Atomic int binary_fd;
+
+    // Writer-only statistics
+    _Atomic uint64_t written_entries;
+    _Atomic uint64_t write_time_ns;
+    _Atomic uint64_t wakeups;
+} pipeline = {
+    .registry_lock = PTHREAD_MUTEX_INITIALIZER,
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .wake_cond = PTHREAD_COND_INITIALIZER,
+    .flushed_cond = PTHREAD_COND_INITIALIZER,
+    .min_level = DCORE_LOG_INFO,
+    .out_fd = -1,
+    .err_fd = -1,
+    .binary_fd = -1,
+};
+
+// Set once the writer issues membarrier instead; a producer that still sees
+// false just fences itself, which is always safe
+static _Atomic bool producer_fence_elided;
+
+static _Thread_local log_ring_t* thread_ring;
+static pthread_key_t ring_key;
+static pthread_once_t ring_key_once = PTHREAD_ONCE_INIT;
+
+static int64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static inline void counter_add(_Atomic uint64_t* counter, uint64_t n) {
+    // Single writer: a relaxed load and store is enough and avoids a locked add
+    atomic_store_explicit(counter, atomic_load_explicit(counter, memory_order_relaxed) + n, memory_order_relaxed);
+}
+
+// Ring registration
+
+static void notify_idle_writer(void);
+
+static void release_thread_ring(void* ring) {
+    atomic_store_explicit(&((log_ring_t*)ring)->orphaned, true, memory_order_release);
+    // The writer frees orphaned rings, so it must not sleep through this one
+    notify_idle_writer();
+}
+
+static void create_ring_key(void) {
+    pthread_key_create(&ring_key, release_thread_ring);
+}
+
+static log_ring_t* current_ring(void) {
+    if (thread_ring) return thread_ring;
+
+    log_ring_t* ring;
+    if (posix_memalign((void**)&ring, 64, sizeof(*ring)) != 0) return NULL;
+    memset(ring, 0, offsetof(log_ring_t, data));
+
+    pthread_once(&ring_key_once, create_ring_key);
+    pthread_setspecific(ring_key, ring);
+
+    pthread_mutex_lock(&pipeline.registry_lock);
+    ring->next = pipeline.rings;
+    pipeline.rings = ring;
+    pipeline.memory_in_use += sizeof(*ring);
+    if (pipeline.memory_in_use > pipeline.peak_memory) pipeline.peak_memory = pipeline.memory_in_use;
+    pthread_mutex_unlock(&pipeline.registry_lock);
+
+    thread_ring = ring;
+    return ring;
+}
+
+// Writer
+
+static void write_all(int fd, struct iovec* iov, int count) {
+    while (count > 0) {
+        ssize_t written = writev(fd, iov, count);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return; // Nowhere to report a broken log stream; drop the batch
+        }
+
+        while (count > 0 && (size_t)written >= iov->iov_len) {
+            written -= (ssize_t)iov->iov_len;
+            iov++;
+            count--;
+        }
+        if (count > 0) {
+            iov->iov_base = (uint8_t*)iov->iov_base + written;
+            iov->iov_len -= (size_t)written;
+        }
+    }
+}
+
+static int output_fd(int stream) {
+    switch (stream) {
+        case STREAM_ERR: {
+            int fd = atomic_load_explicit(&pipeline.err_fd, memory_order_relaxed);
+            return fd >= 0 ? fd : STDERR_FILENO;
+        }
+        case STREAM_BINARY:
+            return atomic_load_explicit(&pipeline.binary_fd, memory_order_relaxed);
+        default: {
+            int fd = atomic_load_explicit(&pipeline.out_fd, memory_order_relaxed);
+            return fd >= 0 ? fd : STDOUT_FILENO;
+        }
+    }
+}
+
+// Writes everything currently in the ring, up to BATCH_IOV records per writev
+static void drain_ring(log_ring_t* ring) {
+    static struct iovec iov[STREAM_COUNT][BATCH_IOV];
+
+    uint64_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    uint64_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+
+    while (tail != head) {
+        int count[STREAM_COUNT] = {0};
+        uint64_t entries = 0;
+        uint64_t pos = tail;
+
+        while (pos != head) {
+            uint8_t* record = &ring->data[pos & RING_MASK];
+            uint16_t length;
+            memcpy(&length, record, sizeof(length));
+            uint8_t stream = record[2];
+
+            if (stream != STREAM_PAD) {
+                if (count[stream] == BATCH_IOV) break;
+                iov[stream][count[stream]].iov_base = record + RECORD_HEADER_SIZE;
+                iov[stream][count[stream]].iov_len = length;
+                count[stream]++;
+                entries++;
+            }
+            pos += RECORD_HEADER_SIZE + ((length + 3u) & ~3u);
+        }
+
+        int64_t start = now_ns();
+        for (int stream = 0; stream < STREAM_COUNT; stream++) {
+            int fd = count[stream] > 0 ? output_fd(stream) : -1;
+            // Binary records logged after the file was closed have nowhere to go
+            if (fd >= 0) write_all(fd, iov[stream], count[stream]);
+        }
+        counter_add(&pipeline.write_time_ns, (uint64_t)(now_ns() - start));
+        counter_add(&pipeline.written_entries, entries);
+
+        // Records are read in place, so the space is only handed back now
+        tail = pos;
+        atomic_store_explicit(&ring->tail, tail, memory_order_release);
+    }
+}
+
+static void drain_all(void) {
+    // Keep earlier printf output ahead of log lines on a shared terminal
+    if (atomic_load_explicit(&pipeline.out_fd, memory_order_relaxed) < 0) fflush(stdout);
+
+    pthread_mutex_lock(&pipeline.registry_lock);
+    log_ring_t** link = &pipeline.rings;
+    while (*link) {
+        log_ring_t* ring = *link;
+        bool orphaned = atomic_load_explicit(&ring->orphaned, memory_order_acquire);
+        drain_ring(ring);
+
+        if (!orphaned) {
+            link = &ring->next;
+            continue;
+        }
+
+        for (int i = 0; i < DCORE_LOG_LEVEL_COUNT; i++) {
+            pipeline.retired_entries[i] += atomic_load_explicit(&ring->entries[i], memory_order_relaxed);
+        }
+        pipeline.retired_dropped += atomic_load_explicit(&ring->dropped, memory_order_relaxed);
+        pipeline.memory_in_use -= sizeof(*ring);
+        *link = ring->next;
+        free(ring);
+    }
+    pthread_mutex_unlock(&pipeline.registry_lock);
+}
+
+// Pairs the writer's store to idle with each producer's store to head. Where
+// membarrier is available the writer pays for both sides, once per idle
+// period, and producers only need a compiler barrier.
+static void idle_fence(void) {
+#if defined(__linux__)
+    if (pipeline.membarrier) {
+        syscall(__NR_membarrier, MEMBARRIER_CMD_PRIVATE_EXPEDITED, 0);
+        return;
+    }
+#endif
+    atomic_thread_fence(memory_order_seq_cst);
+}
+
+// True if any ring holds records or is waiting to be freed
+static bool rings_pending(void) {
+    bool pending = false;
+    pthread_mutex_lock(&pipeline.registry_lock);
+    for (log_ring_t* ring = pipeline.rings; ring && !pending; ring = ring->next) {
+        pending = atomic_load_explicit(&ring->orphaned, memory_order_acquire) ||
+            atomic_load_explicit(&ring->head, memory_order_acquire) != atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    }
+    pthread_mutex_unlock(&pipeline.registry_lock);
+    return pending;
+}
+
+// Called with pipeline.lock held
+static bool drain_requested(void) {
+    return pipeline.stopping || atomic_load(&pipeline.wake_pending) || pipeline.flush_requested != pipeline.flush_completed;
+}
+
+static void* writer_main(void* arg) {
+    (void)arg;
+
+    pthread_mutex_lock(&pipeline.lock);
+    for (;;) {
+        if (!drain_requested()) {
+            // Announce the sleep before looking at the rings: a producer that
+            // publishes after the scan then sees idle and wakes us
+            atomic_store(&pipeline.idle, true);
+            idle_fence();
+            pthread_mutex_unlock(&pipeline.lock);
+            bool pending = rings_pending();
+            pthread_mutex_lock(&pipeline.lock);
+            while (!pending && atomic_load(&pipeline.idle) && !drain_requested()) {
+                pthread_cond_wait(&pipeline.wake_cond, &pipeline.lock);
+            }
+            atomic_store(&pipeline.idle, false);
+
+            struct timespec deadline;
+            clock_gettime(CLOCK_REALTIME, &deadline);
+            deadline.tv_nsec += DRAIN_INTERVAL_NS;
+            if (deadline.tv_nsec >= 1000000000L) {
+                deadline.tv_sec++;
+                deadline.tv_nsec -= 1000000000L;
+            }
+            while (!drain_requested()) {
+                if (pthread_cond_timedwait(&pipeline.wake_cond, &pipeline.lock, &deadline) == ETIMEDOUT) break;
+            }
+        }
+
+        uint64_t ticket = pipeline.flush_requested;
+        bool stopping = pipeline.stopping;
+        atomic_store(&pipeline.wake_pending, false);
+        pthread_mutex_unlock(&pipeline.lock);
+
+        counter_add(&pipeline.wakeups, 1);
+        drain_all();
+
+        pthread_mutex_lock(&pipeline.lock);
+        pipeline.flush_completed = ticket;
+        if (stopping) atomic_store_explicit(&pipeline.running, false, memory_order_release);
+        pthread_cond_broadcast(&pipeline.flushed_cond);
+        if (stopping) break;
+    }
+    pthread_mutex_unlock(&pipeline.lock);
+    return NULL;
+}
+
+static bool ensure_writer(void) {
+    if (atomic_load_explicit(&pipeline.running, memory_order_acquire)) return true;
+
+    pthread_mutex_lock(&pipeline.lock);
+    if (!atomic_load_explicit(&pipeline.running, memory_order_relaxed)) {
+        static bool exit_hook_installed = false;
+        pipeline.stopping = false;
+#if defined(__linux__)
+        static bool membarrier_registered = false;
+        if (!membarrier_registered) {
+            membarrier_registered = syscall(__NR_membarrier, MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED, 0) == 0;
+            atomic_store(&producer_fence_elided, membarrier_registered);
+            pipeline.membarrier = membarrier_registered;
+        }
+#endif
+        if (pthread_create(&pipeline.writer, NULL, writer_main, NULL) == 0) {
+            atomic_store_explicit(&pipeline.running, true, memory_order_release);
+            // Lines still queued when main() returns would otherwise be lost
+            if (!exit_hook_installed) exit_hook_installed = atexit(dcore_log_flush) == 0;
+        }
+    }
+    pthread_mutex_unlock(&pipeline.lock);
+    return atomic_load_explicit(&pipeline.running, memory_order_relaxed);
+}
+
+static void wake_writer(void) {
+    if (atomic_exchange(&pipeline.wake_pending, true)) return;
+    pthread_mutex_lock(&pipeline.lock);
+    pthread_cond_signal(&pipeline.wake_cond);
+    pthread_mutex_unlock(&pipeline.lock);
+}
+
+// Starts the drain timer of a writer sleeping on empty rings. Only the first
+// producer after the writer went idle pays for the lock.
+static void notify_idle_writer(void) {
+    if (atomic_load_explicit(&producer_fence_elided, memory_order_relaxed)) {
+        atomic_signal_fence(memory_order_seq_cst);
+    } else {
+        atomic_thread_fence(memory_order_seq_cst);
+    }
+    if (!atomic_load_explicit(&pipeline.idle, memory_order_relaxed)) return;
+    if (!atomic_exchange(&pipeline.idle, false)) return;
+    pthread_mutex_lock(&pipeline.lock);
+    pthread_cond_signal(&pipeline.wake_cond);
+    pthread_mutex_unlock(&pipeline.lock);
+}
+
+// Producer
+
+typedef void (*fill_fn)(uint8_t* out, size_t length, const void* context);
+
+// Copies one record of the given length into the ring. Returns false if there is no room.
+static bool ring_push(log_ring_t* ring, int level, int stream, size_t length, fill_fn fill, const void* context) {
+    size_t record_size = RECORD_HEADER_SIZE + ((length + 3) & ~(size_t)3);
+
+    uint64_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    uint64_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    size_t contiguous = DCORE_LOG_RING_SIZE - (head & RING_MASK);
+    size_t padding = contiguous < record_size ? contiguous : 0;
+
+    if (DCORE_LOG_RING_SIZE - (head - tail) < padding + record_size) return false;
+
+    if (padding) {
+        uint8_t* pad = &ring->data[head & RING_MASK];
+        uint16_t pad_length = (uint16_t)(padding - RECORD_HEADER_SIZE);
+        memcpy(pad, &pad_length, sizeof(pad_length));
+        pad[2] = STREAM_PAD;
+        head += padding;
+    }
+
+    uint8_t* record = &ring->data[head & RING_MASK];
+    uint16_t record_length = (uint16_t)length;
+    memcpy(record, &record_length, sizeof(record_length));
+    record[2] = (uint8_t)stream;
+    fill(record + RECORD_HEADER_SIZE, length, context);
+
+    head += record_size;
+    atomic_store_explicit(&ring->head, head, memory_order_release);
+
+    if (level >= DCORE_LOG_WARN || head - tail >= WAKE_THRESHOLD) {
+        wake_writer();
+    } else {
+        notify_idle_writer();
+    }
+    return true;
+}
+
+// Level -1 marks metadata records, which are neither filtered nor counted
+static bool submit(int level, int stream, size_t length, fill_fn fill, const void* context) {
+    log_ring_t* ring = current_ring();
+    if (!ring || !ensure_writer()) {
+        if (ring && level >= 0) counter_add(&ring->dropped, 1);
+        return false;
+    }
+
+    bool pushed = ring_push(ring, level, stream, length, fill, context);
+    if (!pushed && level == DCORE_LOG_FATAL) {
+        // A fatal entry is worth waiting for
+        dcore_log_flush();
+        pushed = ring_push(ring, level, stream, length, fill, context);
+    }
+
+    if (level >= 0) counter_add(pushed ? &ring->entries[level] : &ring->dropped, 1);
+    if (pushed && level == DCORE_LOG_FATAL) dcore_log_flush();
+    return pushed;
+}
+
+typedef struct {
+    const char* name;
+    size_t name_len;
+    const char* module;
+    size_t module_len;
+    const char* message;
+} text_line_t;
+
+// Formats "[LEVEL] module: message\n", truncating the message to fit
+static void fill_text(uint8_t* record, size_t length, const void* context) {
+    const text_line_t* line = context;
+    char* out = (char*)record;
+    char* end = out + length - 1;
+
+    *out++ = '[';
+    memcpy(out, line->name, line->name_len);
+    out += line->name_len;
+    *out++ = ']';
+    *out++ = ' ';
+    if (line->module) {
+        memcpy(out, line->module, line->module_len);
+        out += line->module_len;
+        *out++ = ':';
+        *out++ = ' ';
+    }
+    memcpy(out, line->message, (size_t)(end - out));
+    *end = '\n';
+}
+
+static void fill_binary(uint8_t* record, size_t length, const void* context) {
+    memcpy(record, context, length);
+}
+
+bool dcore_log_enabled(int level) {
+    return level >= atomic_load_explicit(&pipeline.min_level, memory_order_relaxed) && level <= DCORE_LOG_FATAL;
+}
+
+void dcore_log_write(int level, const char* module, const char* message) {
+    if (!message || level < DCORE_LOG_TRACE || !dcore_log_enabled(level)) return;
+
+    text_line_t line = {
+        .name = level_names[level],
+        .name_len = strlen(level_names[level]),
+        .module = module,
+        .module_len = module ? strlen(module) : 0,
+        .message = message,
+    };
+
+    // Truncate the message, not the prefix
+    size_t prefix_len = 1 + line.name_len + 2 + (module ? line.module_len + 2 : 0);
+    if (prefix_len + 1 > DCORE_LOG_MAX_LINE) return;
+    size_t message_len = strnlen(message, DCORE_LOG_MAX_LINE - prefix_len - 1);
+
+    submit(level, level >= DCORE_LOG_ERROR ? STREAM_ERR : STREAM_OUT, prefix_len + message_len + 1, fill_text, &line);
+}
+
+bool dcore_log_write_binary(int level, const void* record, size_t size) {
+    if (!record || size == 0 || size > DCORE_LOG_MAX_LINE || level < -1 || level > DCORE_LOG_FATAL) return false;
+    return submit(level, STREAM_BINARY, size, fill_binary, record);
+}
+
+void dcore_log_set_level(int level) {
+    if (level < DCORE_LOG_TRACE) level = DCORE_LOG_TRACE;
+    if (level > DCORE_LOG_FATAL) level = DCORE_LOG_FATAL;
+    atomic_store_explicit(&pipeline.min_level, level, memory_order_relaxed);
+}
+
+void dcore_log_flush(void) {
+    if (!atomic_load_explicit(&pipeline.running, memory_order_acquire)) return;
+
+    pthread_mutex_lock(&pipeline.lock);
+    if (atomic_load_explicit(&pipeline.running, memory_order_relaxed)) {
+        uint64_t ticket = ++pipeline.flush_requested;
+        pthread_cond_signal(&pipeline.wake_cond);
+        while (pipeline.flush_completed < ticket && atomic_load_explicit(&pipeline.running, memory_order_relaxed)) {
+            pthread_cond_wait(&pipeline.flushed_cond, &pipeline.lock);
+        }
+    }
+    pthread_mutex_unlock(&pipeline.lock);
+}
+
+void dcore_log_get_stats(dcore_log_stats_t* out) {
+    if (!out) return;
+    memset(out, 0, sizeof(*out));
+
+    pthread_mutex_lock(&pipeline.registry_lock);
+    for (int i = 0; i < DCORE_LOG_LEVEL_COUNT; i++) out->entries_by_level[i] = pipeline.retired_entries[i];
+    out->dropped_entries = pipeline.retired_dropped;
+
+    for (log_ring_t* ring = pipeline.rings; ring; ring = ring->next) {
+        for (int i = 0; i < DCORE_LOG_LEVEL_COUNT; i++) {
+            out->entries_by_level[i] += atomic_load_explicit(&ring->entries[i], memory_order_relaxed);
+        }
+        out->dropped_entries += atomic_load_explicit(&ring->dropped, memory_order_relaxed);
+    }
+    out->peak_memory_usage = pipeline.peak_memory;
+    pthread_mutex_unlock(&pipeline.registry_lock);
+
+    for (int i = 0; i < DCORE_LOG_LEVEL_COUNT; i++) out->total_entries += out->entries_by_level[i];
+
+    uint64_t written = atomic_load_explicit(&pipeline.written_entries, memory_order_relaxed);
+    uint64_t elapsed = atomic_load_explicit(&pipeline.write_time_ns, memory_order_relaxed);
+    out->avg_write_time_ns = written ? elapsed / written : 0;
+    out->writer_wakeups = atomic_load_explicit(&pipeline.wakeups, memory_order_relaxed);
+}
+
+void dcore_log_set_output(int out_fd, int err_fd) {
+    dcore_log_flush();
+    atomic_store(&pipeline.out_fd, out_fd);
+    atomic_store(&pipeline.err_fd, err_fd);
+}
+
+void dcore_log_set_binary_output(int fd) {
+    dcore_log_flush();
+    atomic_store(&pipeline.binary_fd, fd);
+}
+
+void dcore_log_shutdown(void) {
+    pthread_mutex_lock(&pipeline.lock);
+    if (!atomic_load_explicit(&pipeline.running, memory_order_relaxed)) {
+        pthread_mutex_unlock(&pipeline.lock);
+        return;
+    }
+    pipeline.stopping = true;
+    pthread_t writer = pipeline.writer;
+    pthread_cond_signal(&pipeline.wake_cond);
+    pthread_mutex_unlock(&pipeline.lock);
+
+    // The writer drains once more and clears running before it exits
+    pthread_join(writer, NULL);
+}
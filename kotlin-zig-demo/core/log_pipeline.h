@@ -0,0 +1,86 @@
+#ifndef DOWEL_LOG_PIPELINE_H
+#define DOWEL_LOG_PIPELINE_H
+
+// Asynchronous log pipeline shared by the C core (logging.c) and the minimal
+// C wrapper (c_wrapper.c). Self-contained for the same reason as
+// config_store.h.
+//
+// Each logging thread formats its line into its own single-producer ring; one
+// background writer drains all rings and hands each batch to writev. Logging
+// never takes a lock or touches stdio. When a ring is full the entry is
+// dropped and counted rather than blocking the caller. Memory is bounded by
+// DCORE_LOG_RING_SIZE per live thread that has logged; rings of exited
+// threads are freed once drained.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DCORE_LOG_RING_SIZE (64 * 1024)
+
+// Longer lines are truncated
+#define DCORE_LOG_MAX_LINE 4096
+
+// Same order and values as the dowel_log_* levels
+typedef enum {
+    DCORE_LOG_TRACE = 0,
+    DCORE_LOG_DEBUG = 1,
+    DCORE_LOG_INFO = 2,
+    DCORE_LOG_WARN = 3,
+    DCORE_LOG_ERROR = 4,
+    DCORE_LOG_FATAL = 5,
+} dcore_log_level_t;
+
+#define DCORE_LOG_LEVEL_COUNT 6
+
+typedef struct {
+    uint64_t total_entries;
+    uint64_t entries_by_level[DCORE_LOG_LEVEL_COUNT];
+    uint64_t dropped_entries;
+    uint64_t avg_write_time_ns; // writer time per entry, including writev
+    size_t peak_memory_usage;   // most ring memory allocated at once
+    uint64_t writer_wakeups;    // drain passes; stays put while nothing is logged
+} dcore_log_stats_t;
+
+// Writes "[LEVEL] module: message\n" ("[LEVEL] message\n" without a module).
+// ERROR and FATAL go to stderr, everything else to stdout. FATAL entries are
+// flushed before returning.
+void dcore_log_write(int level, const char* module, const char* message);
+
+// Queues an opaque record for the binary log (see log_format.h). It is
+// written unchanged and counted under level like a text entry; level -1 marks
+// metadata that is not counted. The caller has already applied the level
+// filter. Returns false if the record was dropped.
+bool dcore_log_write_binary(int level, const void* record, size_t size);
+
+// True if entries at level pass the current filter
+bool dcore_log_enabled(int level);
+
+// Entries below the level are discarded without being counted
+void dcore_log_set_level(int level);
+
+// Blocks until everything logged before the call has been written
+void dcore_log_flush(void);
+
+void dcore_log_get_stats(dcore_log_stats_t* out);
+
+// Redirects output, for tests. Pass -1 to restore stdout/stderr.
+void dcore_log_set_output(int out_fd, int err_fd);
+
+// Sets the file binary records are written to; -1 discards them. Flushes
+// first, so records queued before the call go to the previous file.
+void dcore_log_set_binary_output(int fd);
+
+// Flushes and stops the writer; the next entry starts it again. Rings of
+// threads that are still alive are kept for them. Must not race with loggers.
+void dcore_log_shutdown(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DOWEL_LOG_PIPELINE_H
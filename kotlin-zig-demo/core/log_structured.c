@@ -0,0 +1,209 @@
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "core_internal.h"
+#include "log_format.h"
+#include "log_pipeline.h"
+
+// Structured logging: call sites are registered once, then each entry is
+// encoded as raw arguments and queued as a binary record through the log
+// pipeline. See log_format.h for the file layout.
+
+// Call sites are static, so their states are never freed
+typedef struct site_state {
+    struct site_state* next;
+    uint32_t id;
+    int arg_count; // -1 if the format has to be rendered as text
+    uint8_t types[DCORE_BLOG_MAX_ARGS];
+    _Atomic uint32_t defined_epoch; // file the SITE record was last queued for
+} site_state_t;
+
+static struct {
+    pthread_mutex_t lock;
+    site_state_t* sites;
+    uint32_t next_id;
+    int fd;
+    _Atomic uint32_t epoch; // bumped on every open; 0 while no file is open
+    uint32_t last_epoch;
+} blog = { .lock = PTHREAD_MUTEX_INITIALIZER, .fd = -1 };
+
+static site_state_t* site_state(dowel_log_site_t* site) {
+    site_state_t* state = __atomic_load_n((site_state_t**)&site->state, __ATOMIC_ACQUIRE);
+    if (state) return state;
+
+    pthread_mutex_lock(&blog.lock);
+    state = site->state;
+    if (!state && (state = calloc(1, sizeof(*state)))) {
+        state->id = ++blog.next_id;
+        state->arg_count = site->format ? dcore_blog_parse_format(site->format, state->types) : -1;
+        state->next = blog.sites;
+        blog.sites = state;
+        __atomic_store_n((site_state_t**)&site->state, state, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&blog.lock);
+    return state;
+}
+
+static uint8_t* put_frame(uint8_t* out, uint8_t kind, int level) {
+    out[0] = out[1] = 0; // size, patched once the record is complete
+    out[2] = kind;
+    out[3] = (uint8_t)level;
+    return out + DCORE_BLOG_FRAME_SIZE;
+}
+
+static void finish_record(uint8_t* record, uint8_t* end) {
+    uint16_t size = (uint16_t)(end - record);
+    memcpy(record, &size, sizeof(size));
+}
+
+static uint8_t* put_string(uint8_t* out, const uint8_t* limit, const char* str, size_t max) {
+    size_t room = (size_t)(limit - out) - sizeof(uint16_t);
+    if (max > room) max = room;
+
+    // Measure and copy in one pass. Log arguments are short, and a variable
+    // length memcpy here gets inlined as rep movs, which costs more than the
+    // whole entry on some virtualized CPUs.
+    uint8_t* dst = out + sizeof(uint16_t);
+    size_t length = 0;
+    while (length < max && str[length]) {
+        dst[length] = (uint8_t)str[length];
+        length++;
+    }
+
+    uint16_t length16 = (uint16_t)length;
+    memcpy(out, &length16, sizeof(length16));
+    return dst + length;
+}
+
+// Queues the SITE record once per file. Returns false if it could not be queued.
+static bool define_site(const dowel_log_site_t* site, site_state_t* state, uint32_t epoch) {
+    uint32_t defined = atomic_load_explicit(&state->defined_epoch, memory_order_acquire);
+    if (defined == epoch) return true;
+    if (!atomic_compare_exchange_strong(&state->defined_epoch, &defined, epoch)) return true;
+
+    uint8_t record[DCORE_LOG_MAX_LINE];
+    const uint8_t* limit = record + sizeof(record);
+    uint8_t* out = put_frame(record, DCORE_BLOG_SITE, site->level);
+    memcpy(out, &state->id, sizeof(state->id));
+    out += sizeof(state->id);
+    *out++ = (uint8_t)state->arg_count;
+    memcpy(out, state->types, (size_t)state->arg_count);
+    out += state->arg_count;
+    out = put_string(out, limit, site->module ? site->module : "", 256);
+    out = put_string(out, limit, site->format, (size_t)(limit - out));
+    finish_record(record, out);
+
+    if (dcore_log_write_binary(-1, record, (size_t)(out - record))) return true;
+
+    // Let the next entry try again rather than leave the file undecodable
+    atomic_store_explicit(&state->defined_epoch, 0, memory_order_release);
+    return false;
+}
+
+static void write_text(const dowel_log_site_t* site, va_list args) {
+    char line[DCORE_LOG_MAX_LINE];
+    vsnprintf(line, sizeof(line), site->format, args);
+    dcore_log_write(site->level, site->module, line);
+}
+
+static void write_entry(const dowel_log_site_t* site, const site_state_t* state, va_list args) {
+    uint8_t record[DCORE_LOG_MAX_LINE];
+    const uint8_t* limit = record + sizeof(record);
+    uint8_t* out = put_frame(record, DCORE_BLOG_ENTRY, site->level);
+
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME_COARSE, &ts);
+    uint64_t timestamp = (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+
+    memcpy(out, &state->id, sizeof(state->id));
+    memcpy(out + sizeof(state->id), &timestamp, sizeof(timestamp));
+    out += sizeof(state->id) + sizeof(timestamp);
+
+    for (int i = 0; i < state->arg_count; i++) {
+        uint64_t bits;
+        switch (state->types[i]) {
+            case DCORE_BLOG_ARG_INT: bits = (uint64_t)(int64_t)va_arg(args, int); break;
+            case DCORE_BLOG_ARG_LONG: bits = (uint64_t)(int64_t)va_arg(args, long); break;
+            case DCORE_BLOG_ARG_LLONG: bits = (uint64_t)va_arg(args, long long); break;
+            case DCORE_BLOG_ARG_SIZE: bits = (uint64_t)va_arg(args, size_t); break;
+            case DCORE_BLOG_ARG_POINTER: bits = (uint64_t)(uintptr_t)va_arg(args, void*); break;
+            case DCORE_BLOG_ARG_DOUBLE: {
+                double value = va_arg(args, double);
+                memcpy(&bits, &value, sizeof(bits));
+                break;
+            }
+            default: {
+                const char* str = va_arg(args, const char*);
+                // Leave room for the arguments that follow
+                const uint8_t* room = limit - (size_t)(state->arg_count - i - 1) * sizeof(uint64_t);
+                out = put_string(out, room, str ? str : "(null)", DCORE_BLOG_MAX_STRING);
+                continue;
+            }
+        }
+        memcpy(out, &bits, sizeof(bits));
+        out += sizeof(bits);
+    }
+
+    finish_record(record, out);
+    dcore_log_write_binary(site->level, record, (size_t)(out - record));
+}
+
+void dowel_log_structured(dowel_log_site_t* site, ...) {
+    if (!site || !site->format || !dcore_log_enabled(site->level)) return;
+
+    site_state_t* state = site_state(site);
+    uint32_t epoch = atomic_load_explicit(&blog.epoch, memory_order_acquire);
+
+    va_list args;
+    va_start(args, site);
+    if (!state || state->arg_count < 0 || epoch == 0) {
+        write_text(site, args);
+    } else if (define_site(site, state, epoch)) {
+        write_entry(site, state, args);
+    }
+    va_end(args);
+}
+
+int dowel_log_binary_open(const char* path) {
+    if (!path) return DOWEL_ERROR_INVALID_PARAMETER;
+
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        dcore_report_error(DOWEL_ERROR_STORAGE_ERROR, "Failed to open binary log");
+        return DOWEL_ERROR_STORAGE_ERROR;
+    }
+    if (write(fd, DCORE_BLOG_MAGIC, DCORE_BLOG_MAGIC_SIZE) != DCORE_BLOG_MAGIC_SIZE) {
+        close(fd);
+        dcore_report_error(DOWEL_ERROR_STORAGE_ERROR, "Failed to write binary log header");
+        return DOWEL_ERROR_STORAGE_ERROR;
+    }
+
+    pthread_mutex_lock(&blog.lock);
+    int old_fd = blog.fd;
+    dcore_log_set_binary_output(fd);
+    blog.fd = fd;
+    atomic_store_explicit(&blog.epoch, ++blog.last_epoch, memory_order_release);
+    pthread_mutex_unlock(&blog.lock);
+
+    if (old_fd >= 0) close(old_fd);
+    return DOWEL_SUCCESS;
+}
+
+void dowel_log_binary_close(void) {
+    pthread_mutex_lock(&blog.lock);
+    int fd = blog.fd;
+    atomic_store_explicit(&blog.epoch, 0, memory_order_release);
+    dcore_log_set_binary_output(-1);
+    blog.fd = -1;
+    pthread_mutex_unlock(&blog.lock);
+
+    if (fd >= 0) close(fd);
+}
@@ -0,0 +1,52 @@
+#include "core_internal.h"
+#include "log_pipeline.h"
+
+// Logging functions backed by the asynchronous pipeline in log_pipeline.c
+
+void dowel_log_trace(const char* module, const char* message) {
+    dcore_log_write(DOWEL_LOG_TRACE, module, message);
+}
+
+void dowel_log_debug(const char* module, const char* message) {
+    dcore_log_write(DOWEL_LOG_DEBUG, module, message);
+}
+
+void dowel_log_info(const char* module, const char* message) {
+    dcore_log_write(DOWEL_LOG_INFO, module, message);
+}
+
+void dowel_log_warn(const char* module, const char* message) {
+    dcore_log_write(DOWEL_LOG_WARN, module, message);
+}
+
+void dowel_log_error(const char* module, const char* message) {
+    dcore_log_write(DOWEL_LOG_ERROR, module, message);
+}
+
+void dowel_log_fatal(const char* module, const char* message) {
+    dcore_log_write(DOWEL_LOG_FATAL, module, message);
+}
+
+void dowel_log_set_level(int level) {
+    dcore_log_set_level(level);
+}
+
+void dowel_log_flush(void) {
+    dcore_log_flush();
+}
+
+dowel_log_metrics_t dowel_log_get_metrics(void) {
+    dcore_log_stats_t stats;
+    dcore_log_get_stats(&stats);
+
+    dowel_log_metrics_t metrics = {
+        .total_entries = stats.total_entries,
+        .dropped_entries = stats.dropped_entries,
+        .avg_write_time_ns = stats.avg_write_time_ns,
+        .peak_memory_usage = stats.peak_memory_usage,
+    };
+    for (int i = 0; i < DCORE_LOG_LEVEL_COUNT; i++) {
+        metrics.entries_by_level[i] = stats.entries_by_level[i];
+    }
+    return metrics;
+}
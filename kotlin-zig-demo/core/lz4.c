@@ -0,0 +1,459 @@
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <string.h>
+
+#include "core_internal.h"
+
+// LZ4 block format (lz4.org/lz4_Block_format), implemented here so the fast
+// codec needs no extra library. Blocks are interchangeable with
+// LZ4_compress_default/LZ4_decompress_safe output.
+//
+//  - Level 1 is the greedy single-probe search LZ4 itself uses, skipping
+//    ahead faster the longer it goes without a match. Higher levels keep a
+//    hash chain over the last 64 KB and try 2^(level - 1) candidates per
+//    position, trading speed for ratio much like LZ4 HC.
+//  - The match tables hold stream offsets rather than buffer indexes, so a
+//    stream compressor keeps them from block to block: each block can refer
+//    to the 64 KB before it, and starting over only moves the offset past
+//    everything indexed instead of clearing the tables.
+//  - A dictionary is the history in front of the data: the compressor
+//    indexes it before the input and the decoder resolves matches that
+//    reach back past the output's start into it.
+//  - Decoding checks every length and offset against both buffers, so a
+//    corrupt block fails instead of reading or writing out of bounds. A
+//    partial decode stops once the output is full, for reads that only need
+//    the start of a block.
+//  - XXH32 is here for the checksums of the LZ4 frame format (codec_stream.c).
+
+#define MIN_MATCH 4
+#define LAST_LITERALS 5  // the block ends with at least this many literals
+#define MATCH_FIND_LIMIT 12 // no match starts closer than this to the end
+#define MAX_OFFSET 65535
+#define MAX_HASH_LOG 16
+#define STACK_HASH_LOG 12
+#define STREAM_HASH_LOG 14
+#define CHAIN_SIZE 65536
+#define HISTORY_SIZE (MAX_OFFSET + 1)
+#define REBASE_LIMIT (1u << 30) // stream offsets start over well before they wrap
+
+typedef struct {
+    uint32_t* head;  // per hash, the stream offset + 1 of the last position with it; 0 for none
+    uint16_t* chain; // per offset, the distance back to the previous one with its hash; NULL at level 1
+    int hash_log;
+    int attempts;
+    uint32_t base;   // stream offset of buf[0]; anything before it is gone
+} match_finder_t;
+
+struct dcore_lz4_stream {
+    match_finder_t finder;
+    uint8_t* window;  // up to 64 KB of history, then the block being compressed
+    size_t history;
+};
+
+static inline uint32_t read32(const uint8_t* p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint64_t read64(const uint8_t* p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint32_t hash4(uint32_t sequence, int hash_log) {
+    return (sequence * 2654435761u) >> (32 - hash_log);
+}
+
+// Bytes equal at a and b, not reading past limit from b
+static inline size_t match_length(const uint8_t* a, const uint8_t* b, const uint8_t* limit) {
+    const uint8_t* start = b;
+    while (limit - b >= 8) {
+        uint64_t diff = read64(a) ^ read64(b);
+        if (diff) return (size_t)(b - start) + (size_t)__builtin_ctzll(diff) / 8;
+        a += 8;
+        b += 8;
+    }
+    while (b < limit && *a == *b) {
+        a++;
+        b++;
+    }
+    return (size_t)(b - start);
+}
+
+static inline uint8_t* put_length(uint8_t* op, size_t n) {
+    while (n >= 255) {
+        *op++ = 255;
+        n -= 255;
+    }
+    *op++ = (uint8_t)n;
+    return op;
+}
+
+static uint8_t* put_sequence(uint8_t* op, const uint8_t* literals, size_t literal_length, size_t offset, size_t length) {
+    uint8_t* token = op++;
+    size_t extra = length - MIN_MATCH;
+    *token = (uint8_t)((literal_length >= 15 ? 15 : literal_length) << 4 | (extra >= 15 ? 15 : extra));
+    if (literal_length >= 15) op = put_length(op, literal_length - 15);
+    memcpy(op, literals, literal_length);
+    op += literal_length;
+    op[0] = (uint8_t)offset;
+    op[1] = (uint8_t)(offset >> 8);
+    op += 2;
+    if (extra >= 15) op = put_length(op, extra - 15);
+    return op;
+}
+
+static uint8_t* put_last_literals(uint8_t* op, const uint8_t* literals, size_t literal_length) {
+    *op++ = (uint8_t)((literal_length >= 15 ? 15 : literal_length) << 4);
+    if (literal_length >= 15) op = put_length(op, literal_length - 15);
+    memcpy(op, literals, literal_length);
+    return op + literal_length;
+}
+
+size_t dcore_lz4_bound(size_t size) {
+    return size + size / 255 + 16;
+}
+
+// Compresses buf[start, end) with buf[0, start) as history, indexing the
+// history from buf[indexed] on first
+static size_t compress_block(const uint8_t* buf, size_t start, size_t end, size_t indexed, uint8_t* dst,
+                             match_finder_t* finder) {
+    uint8_t* op = dst;
+    size_t anchor = start;
+    if (end - start <= MATCH_FIND_LIMIT) return (size_t)(put_last_literals(op, buf + anchor, end - anchor) - dst);
+
+    const size_t find_limit = end - MATCH_FIND_LIMIT;
+    const uint8_t* match_limit = buf + end - LAST_LITERALS;
+    uint32_t* head = finder->head;
+    uint16_t* chain = finder->chain;
+    const int hash_log = finder->hash_log;
+    const uint32_t base = finder->base;
+    size_t ip = start;
+
+    if (!chain) {
+        // Every other position of the history: a match missed at its first
+        // byte is found from the second, at half the cost per call
+        for (; indexed + MIN_MATCH <= start; indexed += 2) {
+            head[hash4(read32(buf + indexed), hash_log)] = base + (uint32_t)indexed + 1;
+        }
+    }
+
+    while (ip < find_limit) {
+        size_t best_length = 0;
+        size_t best = 0;
+        uint32_t at = base + (uint32_t)ip;
+        if (chain) {
+            // Index everything up to ip, then walk candidates newest first
+            for (; indexed < ip; indexed++) {
+                uint32_t h = hash4(read32(buf + indexed), hash_log);
+                uint32_t position = base + (uint32_t)indexed;
+                uint32_t delta = head[h] ? position - (head[h] - 1) : 0;
+                chain[position & (CHAIN_SIZE - 1)] = (uint16_t)(delta > MAX_OFFSET ? 0 : delta);
+                head[h] = position + 1;
+            }
+            uint32_t ref = head[hash4(read32(buf + ip), hash_log)];
+            for (int left = finder->attempts; ref && left > 0; left--) {
+                ref--;
+                if (ref < base || at - ref > MAX_OFFSET) break;
+                size_t candidate = ref - base;
+                if (read32(buf + candidate) == read32(buf + ip)) {
+                    size_t length = MIN_MATCH + match_length(buf + candidate + MIN_MATCH, buf + ip + MIN_MATCH, match_limit);
+                    if (length > best_length) {
+                        best_length = length;
+                        best = candidate;
+                    }
+                }
+                uint32_t delta = chain[ref & (CHAIN_SIZE - 1)];
+                if (delta == 0 || delta > ref) break;
+                ref = ref - delta + 1;
+            }
+        } else {
+            uint32_t h = hash4(read32(buf + ip), hash_log);
+            uint32_t ref = head[h];
+            head[h] = at + 1;
+            if (ref > base && at - (ref - 1) <= MAX_OFFSET && read32(buf + (ref - 1 - base)) == read32(buf + ip)) {
+                best = ref - 1 - base;
+                best_length = MIN_MATCH + match_length(buf + best + MIN_MATCH, buf + ip + MIN_MATCH, match_limit);
+            }
+        }
+
+        if (best_length == 0) {
+            // Step faster through data that is not matching
+            ip += chain ? 1 : 1 + ((ip - anchor) >> 6);
+            continue;
+        }
+
+        // Take back bytes that also match before the candidate
+        while (ip > anchor && best > 0 && buf[ip - 1] == buf[best - 1]) {
+            ip--;
+            best--;
+            best_length++;
+        }
+        op = put_sequence(op, buf + anchor, ip - anchor, ip - best, best_length);
+        ip += best_length;
+        anchor = ip;
+        if (!chain && ip < find_limit) head[hash4(read32(buf + ip - 2), hash_log)] = base + (uint32_t)(ip - 2) + 1;
+    }
+    return (size_t)(put_last_literals(op, buf + anchor, end - anchor) - dst);
+}
+
+size_t dcore_lz4_compress(const uint8_t* dict, size_t dict_size, const uint8_t* src, size_t size, uint8_t* dst,
+                          int level) {
+    if (dict_size > MAX_OFFSET) {
+        dict += dict_size - MAX_OFFSET;
+        dict_size = MAX_OFFSET;
+    }
+
+    // Matches need the history and the input in one buffer
+    const uint8_t* buf = src;
+    uint8_t* joined = NULL;
+    if (dict_size > 0) {
+        joined = malloc(dict_size + size);
+        if (!joined) return 0;
+        memcpy(joined, dict, dict_size);
+        memcpy(joined + dict_size, src, size);
+        buf = joined;
+    }
+
+    // Size the table to the input so small records stay cheap
+    size_t total = dict_size + size;
+    match_finder_t finder = { .hash_log = STACK_HASH_LOG, .attempts = level > 1 ? 1 << (level - 1) : 1 };
+    while (finder.hash_log > 8 && ((size_t)1 << (finder.hash_log - 1)) >= total) finder.hash_log--;
+    while (finder.hash_log < MAX_HASH_LOG && ((size_t)1 << finder.hash_log) < total) finder.hash_log++;
+
+    uint32_t stack_head[1 << STACK_HASH_LOG];
+    finder.head = finder.hash_log > STACK_HASH_LOG ? malloc(sizeof(uint32_t) << finder.hash_log) : stack_head;
+    if (level > 1) finder.chain = malloc(CHAIN_SIZE * sizeof(uint16_t));
+    size_t result = 0;
+    if (finder.head && (level <= 1 || finder.chain)) {
+        memset(finder.head, 0, sizeof(uint32_t) << finder.hash_log);
+        result = compress_block(buf, dict_size, total, 0, dst, &finder);
+    }
+
+    if (finder.head != stack_head) free(finder.head);
+    free(finder.chain);
+    free(joined);
+    return result;
+}
+
+dcore_lz4_stream_t* dcore_lz4_stream_new(int level) {
+    dcore_lz4_stream_t* stream = calloc(1, sizeof(*stream));
+    if (!stream) return NULL;
+    stream->finder.hash_log = STREAM_HASH_LOG;
+    stream->finder.attempts = level > 1 ? 1 << (level - 1) : 1;
+    stream->finder.head = calloc((size_t)1 << STREAM_HASH_LOG, sizeof(uint32_t));
+    stream->finder.chain = level > 1 ? malloc(CHAIN_SIZE * sizeof(uint16_t)) : NULL;
+    stream->window = malloc(HISTORY_SIZE + DCORE_LZ4_BLOCK_MAX);
+    if (!stream->finder.head || (level > 1 && !stream->finder.chain) || !stream->window) {
+        dcore_lz4_stream_free(stream);
+        return NULL;
+    }
+    return stream;
+}
+
+void dcore_lz4_stream_free(dcore_lz4_stream_t* stream) {
+    if (!stream) return;
+    free(stream->finder.head);
+    free(stream->finder.chain);
+    free(stream->window);
+    free(stream);
+}
+
+// Moves stream offsets on by shift, clearing the tables when they get large
+static void rebase(dcore_lz4_stream_t* stream, size_t shift) {
+    if (stream->finder.base + shift < REBASE_LIMIT) {
+        stream->finder.base += (uint32_t)shift;
+        return;
+    }
+    // The history is forgotten for one block
+    memset(stream->finder.head, 0, sizeof(uint32_t) << stream->finder.hash_log);
+    stream->finder.base = 0;
+}
+
+void dcore_lz4_stream_reset(dcore_lz4_stream_t* stream) {
+    // Everything indexed so far now lies before the base
+    rebase(stream, stream->history + HISTORY_SIZE);
+    stream->history = 0;
+}
+
+size_t dcore_lz4_stream_compress(dcore_lz4_stream_t* stream, const uint8_t* src, size_t size, uint8_t* dst) {
+    if (stream->history + size > HISTORY_SIZE + DCORE_LZ4_BLOCK_MAX) {
+        size_t keep = HISTORY_SIZE + DCORE_LZ4_BLOCK_MAX - size;
+        if (keep > HISTORY_SIZE) keep = HISTORY_SIZE;
+        size_t shift = stream->history - keep;
+        memmove(stream->window, stream->window + shift, keep);
+        stream->history = keep;
+        uint32_t before = stream->finder.base;
+        rebase(stream, shift);
+        if (stream->finder.base < before) stream->history = 0; // tables were cleared
+    }
+    memcpy(stream->window + stream->history, src, size);
+    size_t written = compress_block(stream->window, stream->history, stream->history + size, stream->history, dst,
+                                    &stream->finder);
+    stream->history += size;
+    return written;
+}
+
+static inline bool read_length(const uint8_t** ip, const uint8_t* end, size_t* length) {
+    unsigned byte;
+    do {
+        if (*ip >= end) return false;
+        byte = *(*ip)++;
+        *length += byte;
+    } while (byte == 255);
+    return true;
+}
+
+int64_t dcore_lz4_decompress(const uint8_t* dict, size_t dict_size, const uint8_t* src, size_t size, uint8_t* dst,
+                             size_t capacity, bool partial) {
+    const uint8_t* ip = src;
+    const uint8_t* const in_end = src + size;
+    uint8_t* op = dst;
+    uint8_t* const out_end = dst + capacity;
+
+    for (;;) {
+        if (partial && op == out_end) return (int64_t)capacity;
+        if (ip >= in_end) return -1;
+        unsigned token = *ip++;
+
+        size_t literal_length = token >> 4;
+        if (literal_length == 15 && !read_length(&ip, in_end, &literal_length)) return -1;
+        if (literal_length > (size_t)(in_end - ip)) return -1;
+        if (literal_length > (size_t)(out_end - op)) {
+            if (!partial) return -1;
+            memcpy(op, ip, (size_t)(out_end - op));
+            return (int64_t)capacity;
+        }
+        if (literal_length <= 16 && in_end - ip >= 16 && out_end - op >= 16) {
+            memcpy(op, ip, 16);
+        } else {
+            memcpy(op, ip, literal_length);
+        }
+        op += literal_length;
+        ip += literal_length;
+        if (ip == in_end) return (int64_t)(op - dst);
+
+        if (in_end - ip < 2) return -1;
+        size_t offset = (size_t)ip[0] | (size_t)ip[1] << 8;
+        ip += 2;
+        size_t length = token & 15;
+        if (length == 15 && !read_length(&ip, in_end, &length)) return -1;
+        length += MIN_MATCH;
+        if (offset == 0) return -1;
+        if (length > (size_t)(out_end - op)) {
+            if (!partial) return -1;
+            length = (size_t)(out_end - op);
+        }
+
+        size_t produced = (size_t)(op - dst);
+        if (offset > produced) {
+            // Starts in the dictionary
+            size_t back = offset - produced;
+            if (back > dict_size) return -1;
+            size_t n = back < length ? back : length;
+            memcpy(op, dict + dict_size - back, n);
+            op += n;
+            length -= n;
+            if (length == 0) continue;
+        }
+
+        const uint8_t* match = op - offset;
+        if (offset >= 16 && length <= 32 && out_end - op >= 32) {
+            memcpy(op, match, 16);
+            memcpy(op + 16, match + 16, 16);
+            op += length;
+        } else if (offset >= length) {
+            memcpy(op, match, length);
+            op += length;
+        } else {
+            // Overlapping: the copyable distance doubles each step
+            uint8_t* end = op + length;
+            while (op < end) {
+                size_t n = (size_t)(op - match);
+                if (n > (size_t)(end - op)) n = (size_t)(end - op);
+                memcpy(op, match, n);
+                op += n;
+            }
+        }
+    }
+}
+
+// XXH32 (github.com/Cyan4973/xxHash), as the LZ4 frame format uses it
+
+#define XXH_PRIME1 2654435761u
+#define XXH_PRIME2 2246822519u
+#define XXH_PRIME3 3266489917u
+#define XXH_PRIME4 668265263u
+#define XXH_PRIME5 374761393u
+
+static inline uint32_t rotl32(uint32_t x, int r) {
+    return (x << r) | (x >> (32 - r));
+}
+
+static inline uint32_t xxh_round(uint32_t acc, uint32_t input) {
+    return rotl32(acc + input * XXH_PRIME2, 13) * XXH_PRIME1;
+}
+
+void dcore_xxh32_init(dcore_xxh32_t* state, uint32_t seed) {
+    memset(state, 0, sizeof(*state));
+    state->v[0] = seed + XXH_PRIME1 + XXH_PRIME2;
+    state->v[1] = seed + XXH_PRIME2;
+    state->v[2] = seed;
+    state->v[3] = seed - XXH_PRIME1;
+}
+
+void dcore_xxh32_update(dcore_xxh32_t* state, const uint8_t* data, size_t size) {
+    state->total += size;
+    if (state->buffered + size < 16) {
+        memcpy(state->buffer + state->buffered, data, size);
+        state->buffered += (uint32_t)size;
+        return;
+    }
+    if (state->buffered) {
+        size_t fill = 16 - state->buffered;
+        memcpy(state->buffer + state->buffered, data, fill);
+        for (int i = 0; i < 4; i++) state->v[i] = xxh_round(state->v[i], read32(state->buffer + 4 * i));
+        data += fill;
+        size -= fill;
+        state->buffered = 0;
+    }
+    uint32_t v0 = state->v[0], v1 = state->v[1], v2 = state->v[2], v3 = state->v[3];
+    for (; size >= 16; data += 16, size -= 16) {
+        v0 = xxh_round(v0, read32(data));
+        v1 = xxh_round(v1, read32(data + 4));
+        v2 = xxh_round(v2, read32(data + 8));
+        v3 = xxh_round(v3, read32(data + 12));
+    }
+    state->v[0] = v0;
+    state->v[1] = v1;
+    state->v[2] = v2;
+    state->v[3] = v3;
+    memcpy(state->buffer, data, size);
+    state->buffered = (uint32_t)size;
+}
+
+uint32_t dcore_xxh32_digest(const dcore_xxh32_t* state) {
+    uint32_t h = state->total >= 16
+        ? rotl32(state->v[0], 1) + rotl32(state->v[1], 7) + rotl32(state->v[2], 12) + rotl32(state->v[3], 18)
+        : state->v[2] + XXH_PRIME5;
+    h += (uint32_t)state->total;
+    const uint8_t* p = state->buffer;
+    const uint8_t* end = p + state->buffered;
+    for (; end - p >= 4; p += 4) h = rotl32(h + read32(p) * XXH_PRIME3, 17) * XXH_PRIME4;
+    for (; p < end; p++) h = rotl32(h + *p * XXH_PRIME5, 11) * XXH_PRIME1;
+    h ^= h >> 15;
+    h *= XXH_PRIME2;
+    h ^= h >> 13;
+    h *= XXH_PRIME3;
+    h ^= h >> 16;
+    return h;
+}
+
+uint32_t dcore_xxh32(const uint8_t* data, size_t size, uint32_t seed) {
+    dcore_xxh32_t state;
+    dcore_xxh32_init(&state, seed);
+    dcore_xxh32_update(&state, data, size);
+    return dcore_xxh32_digest(&state);
+}
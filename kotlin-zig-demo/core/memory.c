@@ -0,0 +1,19 @@
+#include "core_internal.h"
+#include "pool_alloc.h"
+
+// General-purpose allocation backed by the size-class pools in pool_alloc.c
+
+_Static_assert(sizeof(dowel_alloc_class_stats_t) == sizeof(dcore_pool_stats_t),
+               "dowel_alloc_class_stats_t must mirror dcore_pool_stats_t");
+
+void* dowel_malloc(size_t size) {
+    return dcore_pool_alloc(size);
+}
+
+void dowel_free(void* ptr) {
+    dcore_pool_free(ptr);
+}
+
+size_t dowel_alloc_get_stats(dowel_alloc_class_stats_t* stats, size_t max) {
+    return dcore_pool_get_stats((dcore_pool_stats_t*)stats, max);
+}
@@ -0,0 +1,660 @@
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/stat.h>
+
+#include "core_internal.h"
+
+// Metadata index - dowel_storage_index_open
+//
+//  - Every entry under the root (the root included) is kept in a sharded
+//    hash table keyed by its path as the caller spells it: the root string,
+//    then '/'-joined names. Lookups take a shard's read lock and never make
+//    a syscall.
+//  - A lookup that misses is only answered "absent" if the parent is an
+//    indexed directory marked complete (all of its names are indexed).
+//    Anything else - symlinks (stat follows them, the index does not), paths
+//    with . or .. or doubled slashes, directories not yet listed - falls
+//    back to stat, so the index can be incomplete but not wrong.
+//  - Changes made through this API update the index before the call
+//    returns (dcore_meta_index_refresh). Other changes arrive through a
+//    recursive watcher on the shared watcher service, created before the
+//    tree is listed so nothing created in between is missed; the service
+//    watches new directories before listing them too. An event on the root
+//    itself, which is how the service reports a queue overflow, triggers a
+//    full rescan. Full scans hold scan_lock, so one scan's sweep cannot
+//    drop entries another has just seen.
+//  - Refreshes lstat outside the shard lock and only take it to publish.
+//    Each refresh draws a sequence number from its shard before the lstat,
+//    and an entry only takes a result newer than the one it holds, so a
+//    slow refresh cannot overwrite a newer one. A removal raises the shard's
+//    removal mark, and a refresh older than the mark does not add entries
+//    back (the scan then leaves the directory incomplete).
+//  - The snapshot is the entry table in native byte order, written
+//    atomically. On load, each directory whose mtime no longer matches
+//    loses its complete mark, so names created or removed while the app was
+//    not running fall back to stat. Entries from the snapshot are not
+//    answered from until a refresh has verified them, so files removed or
+//    modified in place fall back to stat as well. An async task then
+//    rescans the tree in the background, and sets ready.
+
+#define SHARD_COUNT 16
+#define SNAPSHOT_MAGIC "DWIX"
+#define SNAPSHOT_VERSION 1
+
+typedef struct index_entry {
+    struct index_entry* chain;
+    uint64_t hash;
+    int64_t size;
+    int64_t mtime_ns;
+    uint64_t seq;   // refresh the stat came from, 0 if from the snapshot
+    uint32_t pass;  // full scan that last saw the entry
+    uint8_t type;   // dowel_entry_type_t
+    bool complete;  // directory with every name indexed
+    uint16_t length;
+    char path[];
+} index_entry_t;
+
+typedef struct {
+    pthread_rwlock_t lock;
+    index_entry_t** buckets;
+    size_t bucket_mask;
+    size_t count;
+    atomic_uint_fast64_t next_seq; // refreshes started
+    uint64_t removed_seq;          // newest refresh that found a path gone
+    atomic_uint_fast64_t hits; // lookups answered, counted where the path hashed
+    atomic_uint_fast64_t fallbacks;
+} __attribute__((aligned(64))) shard_t;
+
+static shard_t shards[SHARD_COUNT];
+static pthread_once_t shards_once = PTHREAD_ONCE_INIT;
+static atomic_bool active;
+static atomic_bool ready;
+static atomic_uint current_pass;
+static pthread_mutex_t scan_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// Open/close state. Watcher callbacks and the rescan task read root but
+// never take lock: close waits for both under it.
+static struct {
+    pthread_mutex_t lock;
+    char* root;
+    char* snapshot;
+    bool from_snapshot;
+    dowel_file_watcher_t* watcher;
+    dowel_task_t* rescan;
+} state = { .lock = PTHREAD_MUTEX_INITIALIZER };
+
+// Eight bytes per step: lookups hash every path, and paths are long
+static uint64_t hash_path(const char* s) {
+    size_t length = strlen(s);
+    uint64_t h = 0x9e3779b97f4a7c15ULL ^ length;
+    for (; length >= 8; s += 8, length -= 8) {
+        uint64_t word;
+        memcpy(&word, s, 8);
+        h = (h ^ word) * 0xff51afd7ed558ccdULL;
+        h ^= h >> 32;
+    }
+    uint64_t tail = 0;
+    memcpy(&tail, s, length);
+    h = (h ^ tail) * 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return h;
+}
+
+static void init_shards(void) {
+    for (size_t i = 0; i < SHARD_COUNT; i++) pthread_rwlock_init(&shards[i].lock, NULL);
+}
+
+static shard_t* shard_for(uint64_t hash) {
+    pthread_once(&shards_once, init_shards);
+    return &shards[hash >> 60];
+}
+
+static int64_t mtime_ns(const struct stat* st) {
+    return (int64_t)st->st_mtim.tv_sec * 1000000000 + st->st_mtim.tv_nsec;
+}
+
+static uint8_t entry_type(mode_t mode) {
+    if (S_ISREG(mode)) return DOWEL_ENTRY_FILE;
+    if (S_ISDIR(mode)) return DOWEL_ENTRY_DIRECTORY;
+    if (S_ISLNK(mode)) return DOWEL_ENTRY_SYMLINK;
+    return DOWEL_ENTRY_OTHER;
+}
+
+// Shard tables; callers hold the shard's lock
+
+static index_entry_t* find_locked(shard_t* shard, uint64_t hash, const char* path) {
+    if (!shard->buckets) return NULL;
+    for (index_entry_t* entry = shard->buckets[hash & shard->bucket_mask]; entry; entry = entry->chain) {
+        if (entry->hash == hash && strcmp(entry->path, path) == 0) return entry;
+    }
+    return NULL;
+}
+
+static void grow_locked(shard_t* shard) {
+    size_t buckets = shard->buckets ? (shard->bucket_mask + 1) * 2 : 256;
+    index_entry_t** table = calloc(buckets, sizeof(*table));
+    if (!table) return;
+    for (size_t i = 0; shard->buckets && i <= shard->bucket_mask; i++) {
+        index_entry_t* entry = shard->buckets[i];
+        while (entry) {
+            index_entry_t* next = entry->chain;
+            entry->chain = table[entry->hash & (buckets - 1)];
+            table[entry->hash & (buckets - 1)] = entry;
+            entry = next;
+        }
+    }
+    free(shard->buckets);
+    shard->buckets = table;
+    shard->bucket_mask = buckets - 1;
+}
+
+static index_entry_t* insert_locked(shard_t* shard, uint64_t hash, const char* path) {
+    index_entry_t* entry = find_locked(shard, hash, path);
+    if (entry) return entry;
+    size_t length = strlen(path);
+    if (length > UINT16_MAX) return NULL;
+    if (!shard->buckets || shard->count > shard->bucket_mask) grow_locked(shard);
+    if (!shard->buckets) return NULL;
+
+    entry = calloc(1, sizeof(*entry) + length + 1);
+    if (!entry) return NULL;
+    entry->hash = hash;
+    entry->length = (uint16_t)length;
+    memcpy(entry->path, path, length + 1);
+    entry->chain = shard->buckets[hash & shard->bucket_mask];
+    shard->buckets[hash & shard->bucket_mask] = entry;
+    shard->count++;
+    return entry;
+}
+
+static bool remove_locked(shard_t* shard, uint64_t hash, const char* path) {
+    if (!shard->buckets) return false;
+    for (index_entry_t** link = &shard->buckets[hash & shard->bucket_mask]; *link; link = &(*link)->chain) {
+        index_entry_t* entry = *link;
+        if (entry->hash == hash && strcmp(entry->path, path) == 0) {
+            *link = entry->chain;
+            free(entry);
+            shard->count--;
+            return true;
+        }
+    }
+    return false;
+}
+
+static void set_stat(index_entry_t* entry, const struct stat* st) {
+    entry->type = entry_type(st->st_mode);
+    if (entry->type != DOWEL_ENTRY_DIRECTORY) entry->complete = false;
+    entry->size = (int64_t)st->st_size;
+    entry->mtime_ns = mtime_ns(st);
+}
+
+// Removes every entry whose pass is not keep_pass (a full scan's sweep),
+// or, with a prefix, every entry below prefix
+static void remove_where(const char* prefix, uint32_t keep_pass) {
+    size_t prefix_length = prefix ? strlen(prefix) : 0;
+    for (size_t i = 0; i < SHARD_COUNT; i++) {
+        shard_t* shard = shard_for((uint64_t)i << 60);
+        pthread_rwlock_wrlock(&shard->lock);
+        for (size_t b = 0; shard->buckets && b <= shard->bucket_mask; b++) {
+            index_entry_t** link = &shard->buckets[b];
+            while (*link) {
+                index_entry_t* entry = *link;
+                bool doomed = prefix ? entry->length > prefix_length && entry->path[prefix_length] == '/' &&
+                                           memcmp(entry->path, prefix, prefix_length) == 0
+                                     : entry->pass != keep_pass;
+                if (doomed) {
+                    *link = entry->chain;
+                    free(entry);
+                    shard->count--;
+                } else {
+                    link = &entry->chain;
+                }
+            }
+        }
+        pthread_rwlock_unlock(&shard->lock);
+    }
+}
+
+static void clear_all(void) {
+    for (size_t i = 0; i < SHARD_COUNT; i++) {
+        shard_t* shard = shard_for((uint64_t)i << 60);
+        pthread_rwlock_wrlock(&shard->lock);
+        for (size_t b = 0; shard->buckets && b <= shard->bucket_mask; b++) {
+            index_entry_t* entry = shard->buckets[b];
+            while (entry) {
+                index_entry_t* next = entry->chain;
+                free(entry);
+                entry = next;
+            }
+        }
+        free(shard->buckets);
+        shard->buckets = NULL;
+        shard->bucket_mask = 0;
+        shard->count = 0;
+        pthread_rwlock_unlock(&shard->lock);
+    }
+}
+
+enum {
+    GONE = -1,        // not there, and not indexed either
+    REMOVED = -2,     // no longer there; its entry was dropped
+    REMOVED_DIR = -3, // as REMOVED, for a directory: drop what was below it
+};
+
+// Stats path (relative to dir_fd if one is given), then updates its entry
+// under the shard lock unless a newer refresh got there first, stamping it
+// with the current scan's pass so the scan's sweep keeps it. Returns the
+// entry's type or one of the above.
+static int refresh_entry(int dir_fd, const char* name, const char* path) {
+    uint64_t hash = hash_path(path);
+    shard_t* shard = shard_for(hash);
+    uint64_t seq = atomic_fetch_add_explicit(&shard->next_seq, 1, memory_order_relaxed) + 1;
+    struct stat st;
+    int found = dir_fd >= 0 ? fstatat(dir_fd, name, &st, AT_SYMLINK_NOFOLLOW) : lstat(path, &st);
+
+    pthread_rwlock_wrlock(&shard->lock);
+    index_entry_t* entry = find_locked(shard, hash, path);
+    int type = GONE;
+    if (entry && entry->seq > seq) {
+        // Superseded: the newer result stands
+        entry->pass = atomic_load_explicit(&current_pass, memory_order_relaxed);
+        type = entry->type;
+    } else if (found == 0) {
+        if (!entry && seq > shard->removed_seq) entry = insert_locked(shard, hash, path);
+        if (entry) {
+            set_stat(entry, &st);
+            entry->seq = seq;
+            entry->pass = atomic_load_explicit(&current_pass, memory_order_relaxed);
+            type = entry->type;
+        }
+    } else {
+        if (seq > shard->removed_seq) shard->removed_seq = seq;
+        if (entry) type = entry->type == DOWEL_ENTRY_DIRECTORY ? REMOVED_DIR : REMOVED;
+        if (entry) remove_locked(shard, hash, path);
+    }
+    pthread_rwlock_unlock(&shard->lock);
+    return type;
+}
+
+static void mark_complete(const char* path, bool complete) {
+    uint64_t hash = hash_path(path);
+    shard_t* shard = shard_for(hash);
+    pthread_rwlock_wrlock(&shard->lock);
+    index_entry_t* entry = find_locked(shard, hash, path);
+    if (entry) entry->complete = complete;
+    pthread_rwlock_unlock(&shard->lock);
+}
+
+// Scanning
+
+// Lists and indexes dir (already indexed itself) and everything below it
+static void scan_tree(const char* dir) {
+    int fd = open(dir, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+    DIR* listing = fd >= 0 ? fdopendir(fd) : NULL;
+    if (!listing) {
+        if (fd >= 0) close(fd);
+        mark_complete(dir, false);
+        return;
+    }
+
+    size_t dir_length = strlen(dir);
+    size_t capacity = dir_length + 258;
+    char* path = malloc(capacity);
+    bool complete = path != NULL;
+    struct dirent* entry;
+    while (path && (entry = readdir(listing)) != NULL) {
+        const char* name = entry->d_name;
+        if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) continue;
+        size_t name_length = strlen(name);
+        if (dir_length + name_length + 2 > capacity) {
+            complete = false;
+            continue;
+        }
+        memcpy(path, dir, dir_length);
+        path[dir_length] = '/';
+        memcpy(path + dir_length + 1, name, name_length + 1);
+
+        int type = refresh_entry(dirfd(listing), name, path);
+        if (type < 0) complete = false;
+        if (type == DOWEL_ENTRY_DIRECTORY) scan_tree(path);
+    }
+    closedir(listing);
+    free(path);
+    mark_complete(dir, complete);
+}
+
+// Rescans everything and drops entries the scan did not see
+static void full_scan(void) {
+    pthread_mutex_lock(&scan_lock);
+    uint32_t pass = atomic_fetch_add(&current_pass, 1) + 1;
+    if (refresh_entry(-1, NULL, state.root) == DOWEL_ENTRY_DIRECTORY) scan_tree(state.root);
+    remove_where(NULL, pass);
+    pthread_mutex_unlock(&scan_lock);
+}
+
+// Snapshot
+
+typedef struct {
+    uint8_t type;
+    uint8_t complete;
+    uint16_t length; // of the path below the root, "" for the root itself
+    int64_t size;
+    int64_t mtime_ns;
+} snapshot_record_t;
+
+static bool load_snapshot(void) {
+    if (access(state.snapshot, F_OK) != 0) return false;
+    dowel_buffer_t* file = dowel_storage_read_file(state.snapshot);
+    if (!file) return false;
+
+    const uint8_t* at = file->data;
+    const uint8_t* end = file->data + file->size;
+    uint32_t version = 0, root_length = 0;
+    uint64_t count = 0;
+    bool ok = file->size >= 20 && memcmp(at, SNAPSHOT_MAGIC, 4) == 0;
+    if (ok) {
+        memcpy(&version, at + 4, 4);
+        memcpy(&root_length, at + 8, 4);
+        memcpy(&count, at + 12, 8);
+        at += 20;
+        ok = version == SNAPSHOT_VERSION && root_length == strlen(state.root) &&
+             (size_t)(end - at) >= root_length && memcmp(at, state.root, root_length) == 0;
+        at += ok ? root_length : 0;
+    }
+
+    size_t capacity = root_length + 1 + UINT16_MAX + 1;
+    char* path = ok ? malloc(capacity) : NULL;
+    if (path) memcpy(path, state.root, root_length);
+    for (uint64_t i = 0; path && ok && i < count; i++) {
+        snapshot_record_t record;
+        if ((size_t)(end - at) < sizeof(record)) break;
+        memcpy(&record, at, sizeof(record));
+        at += sizeof(record);
+        if ((size_t)(end - at) < record.length) break;
+
+        size_t length = root_length;
+        if (record.length) {
+            path[length++] = '/';
+            memcpy(path + length, at, record.length);
+            length += record.length;
+        }
+        path[length] = '\0';
+        at += record.length;
+
+        uint64_t hash = hash_path(path);
+        shard_t* shard = shard_for(hash);
+        pthread_rwlock_wrlock(&shard->lock);
+        // Events arrive while loading; an entry they refreshed is newer
+        index_entry_t* entry = insert_locked(shard, hash, path);
+        if (entry && entry->seq == 0) {
+            entry->type = record.type;
+            entry->size = record.size;
+            entry->mtime_ns = record.mtime_ns;
+            entry->complete = record.complete;
+        }
+        pthread_rwlock_unlock(&shard->lock);
+
+        // A directory changed since the snapshot may have gained or lost
+        // names: stat for those until the rescan has listed it again
+        if (record.type == DOWEL_ENTRY_DIRECTORY && record.complete) {
+            struct stat st;
+            if (lstat(path, &st) != 0 || !S_ISDIR(st.st_mode) || mtime_ns(&st) != record.mtime_ns) {
+                mark_complete(path, false);
+            }
+        }
+    }
+    free(path);
+    dowel_free_buffer(file);
+    if (!ok) clear_all();
+    return ok;
+}
+
+static int save_snapshot(void) {
+    size_t root_length = strlen(state.root);
+    size_t capacity = 4096;
+    size_t used = 20 + root_length;
+    uint8_t* out = malloc(capacity > used ? capacity : used);
+    if (!out) return DOWEL_ERROR_OUT_OF_MEMORY;
+    if (capacity < used) capacity = used;
+
+    uint64_t count = 0;
+    bool ok = true;
+    for (size_t i = 0; i < SHARD_COUNT && ok; i++) {
+        shard_t* shard = shard_for((uint64_t)i << 60);
+        pthread_rwlock_rdlock(&shard->lock);
+        for (size_t b = 0; ok && shard->buckets && b <= shard->bucket_mask; b++) {
+            for (index_entry_t* entry = shard->buckets[b]; ok && entry; entry = entry->chain) {
+                // Entries outside the root (a previous root's) are not saved
+                if (entry->length < root_length || memcmp(entry->path, state.root, root_length) != 0) continue;
+                const char* below = entry->path + root_length + (entry->length > root_length ? 1 : 0);
+                snapshot_record_t record = {
+                    .type = entry->type,
+                    .complete = entry->complete,
+                    .length = (uint16_t)strlen(below),
+                    .size = entry->size,
+                    .mtime_ns = entry->mtime_ns,
+                };
+                if (used + sizeof(record) + record.length > capacity) {
+                    while (used + sizeof(record) + record.length > capacity) capacity *= 2;
+                    uint8_t* grown = realloc(out, capacity);
+                    if (!grown) {
+                        ok = false;
+                        break;
+                    }
+                    out = grown;
+                }
+                memcpy(out + used, &record, sizeof(record));
+                memcpy(out + used + sizeof(record), below, record.length);
+                used += sizeof(record) + record.length;
+                count++;
+            }
+        }
+        pthread_rwlock_unlock(&shard->lock);
+    }
+    if (!ok) {
+        free(out);
+        return DOWEL_ERROR_OUT_OF_MEMORY;
+    }
+
+    uint32_t version = SNAPSHOT_VERSION, length32 = (uint32_t)root_length;
+    memcpy(out, SNAPSHOT_MAGIC, 4);
+    memcpy(out + 4, &version, 4);
+    memcpy(out + 8, &length32, 4);
+    memcpy(out + 12, &count, 8);
+    memcpy(out + 20, state.root, root_length);
+    int status = dowel_storage_write_file_mode(state.snapshot, out, used, DOWEL_WRITE_ATOMIC);
+    free(out);
+    return status;
+}
+
+// Watching
+
+static void on_events(const dowel_file_event_record_t* records, size_t count, void* user_data) {
+    (void)user_data;
+    for (size_t i = 0; i < count; i++) {
+        const char* path = records[i].path;
+        if (strcmp(path, state.root) == 0) {
+            full_scan();
+            continue;
+        }
+        int type = refresh_entry(-1, NULL, path);
+        if (type == REMOVED_DIR) remove_where(path, 0);
+        if (type == DOWEL_ENTRY_DIRECTORY && records[i].event != DOWEL_FILE_EVENT_MODIFIED) scan_tree(path);
+    }
+}
+
+static void rescan_task(void* user_data) {
+    (void)user_data;
+    full_scan();
+    atomic_store(&ready, true);
+}
+
+// Lookups
+
+int dcore_meta_index_lookup(const char* path, int64_t* size, int64_t* modtime) {
+    if (!path || !atomic_load_explicit(&active, memory_order_acquire)) return DCORE_INDEX_UNKNOWN;
+
+    uint64_t hash = hash_path(path);
+    shard_t* shard = shard_for(hash);
+    shard_t* counted = shard;
+    pthread_rwlock_rdlock(&shard->lock);
+    index_entry_t* entry = find_locked(shard, hash, path);
+    int result = DCORE_INDEX_UNKNOWN;
+    if (entry && entry->type != DOWEL_ENTRY_SYMLINK && entry->seq != 0) {
+        if (size) *size = entry->size;
+        if (modtime) *modtime = entry->mtime_ns / 1000000000;
+        result = DCORE_INDEX_FOUND;
+    }
+    pthread_rwlock_unlock(&shard->lock);
+    if (entry) goto done;
+
+    // Absent only if the parent is fully listed and path names a plain entry
+    const char* slash = strrchr(path, '/');
+    const char* name = slash ? slash + 1 : NULL;
+    if (!name || name[0] == '\0' || (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0')))) {
+        goto done;
+    }
+    size_t parent_length = (size_t)(slash - path);
+    char stack_parent[256];
+    char* parent = parent_length < sizeof(stack_parent) ? stack_parent : malloc(parent_length + 1);
+    if (!parent) goto done;
+    memcpy(parent, path, parent_length);
+    parent[parent_length] = '\0';
+
+    hash = hash_path(parent);
+    shard = shard_for(hash);
+    pthread_rwlock_rdlock(&shard->lock);
+    entry = find_locked(shard, hash, parent);
+    if (entry && entry->type == DOWEL_ENTRY_DIRECTORY && entry->complete) result = DCORE_INDEX_ABSENT;
+    pthread_rwlock_unlock(&shard->lock);
+    if (parent != stack_parent) free(parent);
+
+done:
+    atomic_fetch_add_explicit(result == DCORE_INDEX_UNKNOWN ? &counted->fallbacks : &counted->hits, 1,
+                              memory_order_relaxed);
+    return result;
+}
+
+void dcore_meta_index_refresh(const char* path) {
+    if (!path || !atomic_load_explicit(&active, memory_order_acquire)) return;
+
+    // Only paths whose parent is indexed belong to the index
+    const char* slash = strrchr(path, '/');
+    if (!slash) return;
+    size_t parent_length = (size_t)(slash - path);
+    char* parent = strndup(path, parent_length);
+    if (!parent) return;
+    uint64_t hash = hash_path(parent);
+    shard_t* shard = shard_for(hash);
+    pthread_rwlock_rdlock(&shard->lock);
+    index_entry_t* entry = find_locked(shard, hash, parent);
+    bool indexed = entry && entry->type == DOWEL_ENTRY_DIRECTORY;
+    pthread_rwlock_unlock(&shard->lock);
+    free(parent);
+
+    if (indexed && refresh_entry(-1, NULL, path) == REMOVED_DIR) remove_where(path, 0);
+}
+
+// Public API
+
+static void stop_locked(void) {
+    atomic_store(&active, false);
+    dowel_file_watcher_destroy(state.watcher);
+    dowel_async_free_task(state.rescan);
+    state.watcher = NULL;
+    state.rescan = NULL;
+    atomic_store(&ready, false);
+    clear_all();
+    free(state.root);
+    free(state.snapshot);
+    state.root = state.snapshot = NULL;
+}
+
+int dowel_storage_index_open(const char* root, const char* snapshot_path) {
+    if (!root || root[0] == '\0') return DOWEL_ERROR_INVALID_PARAMETER;
+    struct stat st;
+    if (stat(root, &st) != 0 || !S_ISDIR(st.st_mode)) return DOWEL_ERROR_STORAGE_ERROR;
+
+    pthread_mutex_lock(&state.lock);
+    if (state.root) stop_locked();
+
+    // Keys spell the root as given, minus trailing slashes
+    size_t root_length = strlen(root);
+    while (root_length > 1 && root[root_length - 1] == '/') root_length--;
+    state.root = strndup(root, root_length);
+    state.snapshot = snapshot_path ? strdup(snapshot_path) : NULL;
+    atomic_store(&current_pass, 0);
+    if (state.root) {
+        // Watching starts before anything is listed
+        dowel_file_watcher_options_t options = { .recursive = true, .batch_callback = on_events };
+        int events = DOWEL_FILE_EVENT_CREATED | DOWEL_FILE_EVENT_MODIFIED | DOWEL_FILE_EVENT_DELETED |
+                     DOWEL_FILE_EVENT_MOVED;
+        state.watcher = dowel_file_watcher_create_with(state.root, events, &options, NULL, NULL);
+        dowel_file_watcher_start(state.watcher);
+    }
+    if (!state.root || (snapshot_path && !state.snapshot) || !state.watcher) {
+        stop_locked();
+        pthread_mutex_unlock(&state.lock);
+        dcore_report_error(DOWEL_ERROR_SYSTEM_ERROR, "Failed to set up the metadata index");
+        return DOWEL_ERROR_SYSTEM_ERROR;
+    }
+    for (size_t i = 0; i < SHARD_COUNT; i++) {
+        atomic_store(&shards[i].hits, 0);
+        atomic_store(&shards[i].fallbacks, 0);
+    }
+
+    // A snapshot makes the index usable at once, with the verifying rescan
+    // left to a task; otherwise scan now
+    state.from_snapshot = state.snapshot && load_snapshot();
+    if (state.from_snapshot) state.rescan = dowel_async_spawn(rescan_task, NULL);
+    if (!state.rescan) rescan_task(NULL);
+    atomic_store(&active, true);
+    pthread_mutex_unlock(&state.lock);
+    return DOWEL_SUCCESS;
+}
+
+int dowel_storage_index_save(void) {
+    pthread_mutex_lock(&state.lock);
+    int status = !state.root ? DOWEL_ERROR_NOT_INITIALIZED
+               : !state.snapshot ? DOWEL_ERROR_INVALID_PARAMETER
+               : save_snapshot();
+    pthread_mutex_unlock(&state.lock);
+    return status;
+}
+
+void dowel_storage_index_close(void) {
+    pthread_mutex_lock(&state.lock);
+    if (state.root) {
+        if (state.snapshot) save_snapshot();
+        stop_locked();
+    }
+    pthread_mutex_unlock(&state.lock);
+}
+
+dowel_storage_index_stats_t dowel_storage_index_get_stats(void) {
+    dowel_storage_index_stats_t stats = { .ready = atomic_load(&ready) };
+    pthread_mutex_lock(&state.lock);
+    stats.from_snapshot = state.root && state.from_snapshot;
+    pthread_mutex_unlock(&state.lock);
+    for (size_t i = 0; i < SHARD_COUNT; i++) {
+        shard_t* shard = shard_for((uint64_t)i << 60);
+        pthread_rwlock_rdlock(&shard->lock);
+        stats.entries += shard->count;
+        pthread_rwlock_unlock(&shard->lock);
+        stats.hits += atomic_load(&shard->hits);
+        stats.fallbacks += atomic_load(&shard->fallbacks);
+    }
+    return stats;
+}
+
+void dcore_meta_index_shutdown(void) {
+    dowel_storage_index_close();
+}
@@ -0,0 +1,327 @@
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pool_alloc.h"
+
+// Layout:
+//  - A block is a 16 byte header followed by the caller's bytes. The header
+//    records the size class (or LARGE_CLASS for the malloc fallback), a magic
+//    value, and the requested size. Builds with DCORE_POOL_DEBUG check the
+//    magic on free and abort on a pooled block freed twice before reuse; a
+//    double free in general cannot be caught, since the block may have been
+//    handed out again or, for large blocks, returned to the system.
+//  - Each class has a global free list and a list of 64 KiB slabs, guarded by
+//    the class lock. Blocks move between it and the thread caches in batches
+//    of POOL_BATCH, so the lock is taken once per batch, not per call.
+//  - Each thread caches up to 2 * POOL_BATCH free blocks per class. The cache
+//    also holds that thread's counters; caches of exited threads are flushed
+//    and their counters folded into the retired totals.
+
+#define POOL_HEADER_SIZE 16
+#define POOL_SLAB_SIZE (64 * 1024)
+#define POOL_BATCH 32
+#define POOL_CACHE_LIMIT (2 * POOL_BATCH)
+#define LARGE_CLASS DCORE_POOL_CLASS_COUNT
+#define STAT_SLOTS (DCORE_POOL_CLASS_COUNT + 1)
+
+#define MAGIC_LIVE 0xd0e1a110u
+#define MAGIC_FREE 0xd0e1f4eeu
+
+typedef struct {
+    uint32_t size_class;
+    _Atomic uint32_t magic;
+    uint64_t size;
+} block_header_t;
+
+_Static_assert(sizeof(block_header_t) == POOL_HEADER_SIZE, "block header must keep 16 byte alignment");
+
+// Free blocks are linked through their first payload word
+typedef struct free_block {
+    block_header_t header;
+    struct free_block* next;
+} free_block_t;
+
+static const uint32_t class_sizes[DCORE_POOL_CLASS_COUNT] = {
+    16, 32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024, 1536, 2048, 3072, 4096,
+};
+
+typedef struct slab {
+    struct slab* next;
+} slab_t;
+
+typedef struct {
+    pthread_mutex_t lock;
+    free_block_t* free_list;
+    slab_t* slabs;
+    size_t reserved_bytes;
+} size_class_t;
+
+typedef struct thread_cache {
+    struct thread_cache* next;
+    free_block_t* free_list[DCORE_POOL_CLASS_COUNT];
+    uint32_t count[DCORE_POOL_CLASS_COUNT];
+
+    // Written by the owning thread only
+    _Atomic uint64_t allocations[STAT_SLOTS];
+    _Atomic uint64_t frees[STAT_SLOTS];
+} thread_cache_t;
+
+static size_class_t classes[DCORE_POOL_CLASS_COUNT];
+static pthread_once_t classes_once = PTHREAD_ONCE_INIT;
+
+static struct {
+    pthread_mutex_t lock;
+    thread_cache_t* caches;
+    uint64_t retired_allocations[STAT_SLOTS];
+    uint64_t retired_frees[STAT_SLOTS];
+    _Atomic size_t large_bytes;
+} registry = { .lock = PTHREAD_MUTEX_INITIALIZER };
+
+static _Thread_local thread_cache_t* thread_cache;
+static pthread_key_t cache_key;
+
+static inline void counter_add(_Atomic uint64_t* counter, uint64_t n) {
+    atomic_store_explicit(counter, atomic_load_explicit(counter, memory_order_relaxed) + n, memory_order_relaxed);
+}
+
+// 16..64 in steps of 16, then two classes per power of two up to 4096
+static inline uint32_t class_index(size_t size) {
+    if (size <= 64) return size ? (uint32_t)((size - 1) >> 4) : 0;
+    size_t n = size - 1;
+    uint32_t bits = 63 - (uint32_t)__builtin_clzll(n);
+    return 4 + (bits - 6) * 2 + (uint32_t)((n >> (bits - 1)) & 1);
+}
+
+static inline block_header_t* header_of(const void* ptr) {
+    return (block_header_t*)((uint8_t*)ptr - POOL_HEADER_SIZE);
+}
+
+static inline void* payload_of(block_header_t* header) {
+    return (uint8_t*)header + POOL_HEADER_SIZE;
+}
+
+// Global class lists
+
+static void flush_thread_cache(void* cache);
+
+static void init_classes(void) {
+    for (int i = 0; i < DCORE_POOL_CLASS_COUNT; i++) pthread_mutex_init(&classes[i].lock, NULL);
+    pthread_key_create(&cache_key, flush_thread_cache);
+}
+
+// Carves a new slab into free blocks (class lock held)
+static bool grow_class(uint32_t index) {
+    size_class_t* cls = &classes[index];
+    size_t stride = POOL_HEADER_SIZE + class_sizes[index];
+
+    uint8_t* slab = malloc(POOL_SLAB_SIZE);
+    if (!slab) return false;
+    ((slab_t*)slab)->next = cls->slabs;
+    cls->slabs = (slab_t*)slab;
+    cls->reserved_bytes += POOL_SLAB_SIZE;
+
+    // The slab link takes the first 16 bytes; blocks follow on 16 byte strides
+    for (size_t offset = 16; offset + stride <= POOL_SLAB_SIZE; offset += stride) {
+        free_block_t* block = (free_block_t*)(slab + offset);
+        block->header.size_class = index;
+        atomic_init(&block->header.magic, MAGIC_FREE);
+        block->next = cls->free_list;
+        cls->free_list = block;
+    }
+    return true;
+}
+
+// Moves up to POOL_BATCH blocks from the class list into the cache
+static bool refill(thread_cache_t* cache, uint32_t index) {
+    size_class_t* cls = &classes[index];
+
+    pthread_mutex_lock(&cls->lock);
+    if (!cls->free_list && !grow_class(index)) {
+        pthread_mutex_unlock(&cls->lock);
+        return false;
+    }
+
+    free_block_t* first = cls->free_list;
+    free_block_t* last = first;
+    uint32_t taken = 1;
+    while (taken < POOL_BATCH && last->next) {
+        last = last->next;
+        taken++;
+    }
+    cls->free_list = last->next;
+    pthread_mutex_unlock(&cls->lock);
+
+    last->next = cache->free_list[index];
+    cache->free_list[index] = first;
+    cache->count[index] += taken;
+    return true;
+}
+
+// Hands count blocks from the head of the cache back to the class list
+static void release(thread_cache_t* cache, uint32_t index, uint32_t count) {
+    free_block_t* first = cache->free_list[index];
+    if (!first || count == 0) return;
+
+    free_block_t* last = first;
+    uint32_t moved = 1;
+    while (moved < count && last->next) {
+        last = last->next;
+        moved++;
+    }
+    cache->free_list[index] = last->next;
+    cache->count[index] -= moved;
+
+    size_class_t* cls = &classes[index];
+    pthread_mutex_lock(&cls->lock);
+    last->next = cls->free_list;
+    cls->free_list = first;
+    pthread_mutex_unlock(&cls->lock);
+}
+
+// Thread caches
+
+static thread_cache_t* current_cache(void) {
+    if (thread_cache) return thread_cache;
+
+    pthread_once(&classes_once, init_classes);
+    thread_cache_t* cache = calloc(1, sizeof(*cache));
+    if (!cache) return NULL;
+    pthread_setspecific(cache_key, cache);
+
+    pthread_mutex_lock(&registry.lock);
+    cache->next = registry.caches;
+    registry.caches = cache;
+    pthread_mutex_unlock(&registry.lock);
+
+    thread_cache = cache;
+    return cache;
+}
+
+static void flush_thread_cache(void* arg) {
+    thread_cache_t* cache = arg;
+    for (uint32_t i = 0; i < DCORE_POOL_CLASS_COUNT; i++) release(cache, i, cache->count[i]);
+
+    pthread_mutex_lock(&registry.lock);
+    for (thread_cache_t** link = &registry.caches; *link; link = &(*link)->next) {
+        if (*link == cache) {
+            *link = cache->next;
+            break;
+        }
+    }
+    for (int i = 0; i < STAT_SLOTS; i++) {
+        registry.retired_allocations[i] += atomic_load_explicit(&cache->allocations[i], memory_order_relaxed);
+        registry.retired_frees[i] += atomic_load_explicit(&cache->frees[i], memory_order_relaxed);
+    }
+    pthread_mutex_unlock(&registry.lock);
+
+    // Another destructor may still allocate; it will get a fresh cache
+    thread_cache = NULL;
+    free(cache);
+}
+
+// Public (internal) API
+
+static void* alloc_large(thread_cache_t* cache, size_t size) {
+    if (size > SIZE_MAX - POOL_HEADER_SIZE) return NULL;
+    block_header_t* header = malloc(POOL_HEADER_SIZE + size);
+    if (!header) return NULL;
+
+    header->size_class = LARGE_CLASS;
+    atomic_init(&header->magic, MAGIC_LIVE);
+    header->size = size;
+    atomic_fetch_add_explicit(&registry.large_bytes, size, memory_order_relaxed);
+    if (cache) counter_add(&cache->allocations[LARGE_CLASS], 1);
+    return payload_of(header);
+}
+
+void* dcore_pool_alloc(size_t size) {
+    thread_cache_t* cache = current_cache();
+    if (size > DCORE_POOL_MAX_SMALL || !cache) return alloc_large(cache, size);
+
+    uint32_t index = class_index(size);
+    if (!cache->free_list[index] && !refill(cache, index)) return NULL;
+
+    free_block_t* block = cache->free_list[index];
+    cache->free_list[index] = block->next;
+    cache->count[index]--;
+
+    atomic_store_explicit(&block->header.magic, MAGIC_LIVE, memory_order_relaxed);
+    block->header.size = size;
+    counter_add(&cache->allocations[index], 1);
+    return payload_of(&block->header);
+}
+
+void dcore_pool_free(void* ptr) {
+    if (!ptr) return;
+
+    block_header_t* header = header_of(ptr);
+#ifdef DCORE_POOL_DEBUG
+    if (atomic_exchange_explicit(&header->magic, MAGIC_FREE, memory_order_relaxed) != MAGIC_LIVE) abort();
+#else
+    atomic_store_explicit(&header->magic, MAGIC_FREE, memory_order_relaxed);
+#endif
+
+    thread_cache_t* cache = current_cache();
+    uint32_t index = header->size_class;
+
+    if (index == LARGE_CLASS) {
+        atomic_fetch_sub_explicit(&registry.large_bytes, header->size, memory_order_relaxed);
+        if (cache) counter_add(&cache->frees[LARGE_CLASS], 1);
+        free(header);
+        return;
+    }
+
+    free_block_t* block = (free_block_t*)header;
+    if (!cache) {
+        // Out of memory for a cache: return the block straight to its class
+        pthread_mutex_lock(&classes[index].lock);
+        block->next = classes[index].free_list;
+        classes[index].free_list = block;
+        pthread_mutex_unlock(&classes[index].lock);
+        return;
+    }
+
+    block->next = cache->free_list[index];
+    cache->free_list[index] = block;
+    counter_add(&cache->frees[index], 1);
+    if (++cache->count[index] > POOL_CACHE_LIMIT) release(cache, index, POOL_BATCH);
+}
+
+size_t dcore_pool_size(const void* ptr) {
+    return ptr ? (size_t)header_of(ptr)->size : 0;
+}
+
+size_t dcore_pool_get_stats(dcore_pool_stats_t* out, size_t max) {
+    if (!out || max == 0) return STAT_SLOTS;
+    if (max > STAT_SLOTS) max = STAT_SLOTS;
+    memset(out, 0, max * sizeof(*out));
+
+    pthread_mutex_lock(&registry.lock);
+    for (size_t i = 0; i < max; i++) {
+        out[i].allocations = registry.retired_allocations[i];
+        out[i].frees = registry.retired_frees[i];
+        for (thread_cache_t* cache = registry.caches; cache; cache = cache->next) {
+            out[i].allocations += atomic_load_explicit(&cache->allocations[i], memory_order_relaxed);
+            out[i].frees += atomic_load_explicit(&cache->frees[i], memory_order_relaxed);
+        }
+    }
+    pthread_mutex_unlock(&registry.lock);
+
+    for (size_t i = 0; i < max; i++) {
+        out[i].live_blocks = out[i].allocations > out[i].frees ? out[i].allocations - out[i].frees : 0;
+        if (i == LARGE_CLASS) {
+            out[i].reserved_bytes = atomic_load_explicit(&registry.large_bytes, memory_order_relaxed);
+            continue;
+        }
+        out[i].block_size = class_sizes[i];
+        pthread_once(&classes_once, init_classes);
+        pthread_mutex_lock(&classes[i].lock);
+        out[i].reserved_bytes = classes[i].reserved_bytes;
+        pthread_mutex_unlock(&classes[i].lock);
+    }
+    return STAT_SLOTS;
+}
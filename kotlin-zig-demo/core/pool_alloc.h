@@ -0,0 +1,47 @@
+#ifndef DOWEL_POOL_ALLOC_H
+#define DOWEL_POOL_ALLOC_H
+
+// Size-class pool allocator behind dowel_malloc/dowel_free, shared by the C
+// core (memory.c) and the minimal C wrapper (c_wrapper.c). Self-contained for
+// the same reason as config_store.h.
+//
+// Requests up to DCORE_POOL_MAX_SMALL bytes are served from per-thread caches
+// of fixed-size blocks, refilled in batches from per-class slabs; larger ones
+// go to malloc. Every block carries a 16 byte header with its class, so a
+// block can be freed from any thread without the caller passing its size.
+// Pooled memory is kept for reuse rather than returned to the system.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DCORE_POOL_CLASS_COUNT 16
+#define DCORE_POOL_MAX_SMALL 4096
+
+// Blocks are aligned to 16 bytes, like malloc on 64-bit platforms
+void* dcore_pool_alloc(size_t size);
+void dcore_pool_free(void* ptr);
+
+// Requested size of a live block, or 0 for NULL
+size_t dcore_pool_size(const void* ptr);
+
+typedef struct {
+    size_t block_size;     // 0 for the malloc fallback above DCORE_POOL_MAX_SMALL
+    uint64_t allocations;
+    uint64_t frees;
+    uint64_t live_blocks;
+    size_t reserved_bytes; // slab memory for the class; live bytes for the fallback
+} dcore_pool_stats_t;
+
+// Fills up to max entries (one per size class, then the fallback) and returns
+// the number of entries available, DCORE_POOL_CLASS_COUNT + 1
+size_t dcore_pool_get_stats(dcore_pool_stats_t* out, size_t max);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DOWEL_POOL_ALLOC_H
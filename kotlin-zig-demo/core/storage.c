@@ -0,0 +1,337 @@
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "core_internal.h"
+
+// Storage functions - thin POSIX implementation of the StorageManager calls
+
+void dcore_storage_changed(const char* path) {
+    dcore_file_cache_invalidate(path);
+    dcore_meta_index_refresh(path);
+}
+
+dowel_buffer_t* dowel_storage_read_file(const char* path) {
+    return dowel_storage_read_file_in(NULL, path);
+}
+
+dowel_buffer_t* dowel_storage_read_file_in(dowel_arena_t* arena, const char* path) {
+    if (!path) return NULL;
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        dcore_report_error(DOWEL_ERROR_STORAGE_ERROR, "Failed to open file for reading");
+        return NULL;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return NULL;
+    }
+
+    dowel_buffer_t* buffer = dcore_buffer_new(arena, (size_t)st.st_size);
+    if (!buffer) {
+        close(fd);
+        return NULL;
+    }
+
+    size_t total = 0;
+    while (total < buffer->size) {
+        ssize_t n = read(fd, buffer->data + total, buffer->size - total);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        total += (size_t)n;
+    }
+    close(fd);
+
+    // The file may have shrunk between fstat and read
+    buffer->size = total;
+    dcore_storage_count_read(total);
+    return buffer;
+}
+
+int dowel_storage_write_file(const char* path, const uint8_t* data, size_t size) {
+    if (!path || (!data && size > 0)) return DOWEL_ERROR_INVALID_PARAMETER;
+
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) return DOWEL_ERROR_STORAGE_ERROR;
+
+    size_t total = 0;
+    while (total < size) {
+        ssize_t n = write(fd, data + total, size - total);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            close(fd);
+            dcore_storage_changed(path);
+            return DOWEL_ERROR_STORAGE_ERROR;
+        }
+        total += (size_t)n;
+    }
+
+    int status = close(fd) == 0 ? DOWEL_SUCCESS : DOWEL_ERROR_STORAGE_ERROR;
+    dcore_storage_changed(path);
+    if (status == DOWEL_SUCCESS) dcore_storage_count_write(size);
+    return status;
+}
+
+int dowel_storage_delete_file(const char* path) {
+    if (!path) return DOWEL_ERROR_INVALID_PARAMETER;
+    int status = unlink(path) == 0 ? DOWEL_SUCCESS : DOWEL_ERROR_STORAGE_ERROR;
+    dcore_storage_changed(path);
+    return status;
+}
+
+bool dowel_storage_file_exists(const char* path) {
+    if (!path) return false;
+    int known = dcore_meta_index_lookup(path, NULL, NULL);
+    if (known != DCORE_INDEX_UNKNOWN) return known == DCORE_INDEX_FOUND;
+    return access(path, F_OK) == 0;
+}
+
+int dowel_storage_create_directory(const char* path) {
+    if (!path) return DOWEL_ERROR_INVALID_PARAMETER;
+    if (mkdir(path, 0755) == 0) {
+        dcore_storage_changed(path);
+        return DOWEL_SUCCESS;
+    }
+    return errno == EEXIST ? DOWEL_SUCCESS : DOWEL_ERROR_STORAGE_ERROR;
+}
+
+char** dowel_storage_list_directory(const char* path, size_t* count) {
+    return dowel_storage_list_directory_in(NULL, path, count);
+}
+
+char** dowel_storage_list_directory_in(dowel_arena_t* arena, const char* path, size_t* count) {
+    if (!path || !count) return NULL;
+    *count = 0;
+
+    DIR* dir = opendir(path);
+    if (!dir) return NULL;
+
+    size_t capacity = 16;
+    size_t used = 0;
+    char** names = dcore_alloc_in(arena, capacity * sizeof(char*));
+    if (!names) {
+        closedir(dir);
+        return NULL;
+    }
+
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) continue;
+
+        if (used == capacity) {
+            char** grown = dcore_realloc_in(arena, names, capacity * sizeof(char*), capacity * 2 * sizeof(char*));
+            if (!grown) break;
+            names = grown;
+            capacity *= 2;
+        }
+
+        size_t length = strlen(entry->d_name);
+        names[used] = dcore_alloc_in(arena, length + 1);
+        if (!names[used]) break;
+        memcpy(names[used], entry->d_name, length + 1);
+        used++;
+    }
+    closedir(dir);
+
+    *count = used;
+    return names;
+}
+
+int64_t dowel_storage_get_file_size(const char* path) {
+    int64_t size;
+    int known = dcore_meta_index_lookup(path, &size, NULL);
+    if (known != DCORE_INDEX_UNKNOWN) return known == DCORE_INDEX_FOUND ? size : -1;
+    struct stat st;
+    if (!path || stat(path, &st) != 0) return -1;
+    return (int64_t)st.st_size;
+}
+
+int64_t dowel_storage_get_file_modtime(const char* path) {
+    int64_t modtime;
+    int known = dcore_meta_index_lookup(path, NULL, &modtime);
+    if (known != DCORE_INDEX_UNKNOWN) return known == DCORE_INDEX_FOUND ? modtime : -1;
+    struct stat st;
+    if (!path || stat(path, &st) != 0) return -1;
+    return (int64_t)st.st_mtime;
+}
+
+// Mapped views - read-only MAP_PRIVATE mappings handed out as
+// dowel_file_view_t. The public struct is the first member, so the view
+// pointer is the mapping's handle; the last release unmaps it.
+
+#define MAP_MIN_SIZE (64 * 1024)
+
+typedef struct {
+    dowel_file_view_t view;
+    atomic_int refs;
+    void* base;
+    size_t length;
+} mapped_file_t;
+
+static int advice_flag(int advice) {
+    switch (advice & (DOWEL_MAP_SEQUENTIAL | DOWEL_MAP_RANDOM)) {
+        case DOWEL_MAP_SEQUENTIAL: return MADV_SEQUENTIAL;
+        case DOWEL_MAP_RANDOM: return MADV_RANDOM;
+        default: return MADV_NORMAL;
+    }
+}
+
+static int apply_advice(void* start, size_t length, int advice) {
+    if (length == 0) return DOWEL_SUCCESS;
+    if (madvise(start, length, advice_flag(advice)) != 0) return DOWEL_ERROR_SYSTEM_ERROR;
+    if ((advice & DOWEL_MAP_WILLNEED) && madvise(start, length, MADV_WILLNEED) != 0) return DOWEL_ERROR_SYSTEM_ERROR;
+    return DOWEL_SUCCESS;
+}
+
+// A view holding a copy of the file's contents, read from fd
+static dowel_file_view_t* read_view(int fd, size_t size) {
+    mapped_file_t* mapped = malloc(sizeof(*mapped) + size + 1);
+    if (!mapped) return NULL;
+    atomic_init(&mapped->refs, 1);
+    mapped->base = NULL;
+
+    uint8_t* data = (uint8_t*)(mapped + 1);
+    size_t total = 0;
+    while (total < size) {
+        ssize_t n = read(fd, data + total, size - total);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        total += (size_t)n;
+    }
+    mapped->view.data = data;
+    mapped->view.size = total;
+    mapped->length = size; // the copy's capacity, for dcore_file_view_footprint
+    return &mapped->view;
+}
+
+dowel_file_view_t* dowel_storage_map_file(const char* path, int advice) {
+    if (!path) return NULL;
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        dcore_report_error(DOWEL_ERROR_STORAGE_ERROR, "Failed to open file for mapping");
+        return NULL;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        close(fd);
+        dcore_report_error(DOWEL_ERROR_STORAGE_ERROR, "Not a regular file");
+        return NULL;
+    }
+
+    // Below this size a read is cheaper than setting up and tearing down a
+    // mapping, so small files are copied into the view's own allocation
+    size_t size = (size_t)st.st_size;
+    if (size <= MAP_MIN_SIZE) {
+        dowel_file_view_t* view = read_view(fd, size);
+        close(fd);
+        if (view) dcore_storage_count_read(view->size);
+        return view;
+    }
+
+    mapped_file_t* mapped = malloc(sizeof(*mapped));
+    if (!mapped) {
+        close(fd);
+        return NULL;
+    }
+    atomic_init(&mapped->refs, 1);
+    mapped->length = size;
+    mapped->base = mmap(NULL, mapped->length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped->base == MAP_FAILED) {
+        free(mapped);
+        dcore_report_error(DOWEL_ERROR_STORAGE_ERROR, "Failed to map file");
+        return NULL;
+    }
+    mapped->view.data = mapped->base;
+    mapped->view.size = mapped->length;
+    // Advice is a hint; a kernel that ignores it still gives a valid view
+    apply_advice(mapped->base, mapped->length, advice);
+    dcore_storage_count_read(mapped->length);
+    return &mapped->view;
+}
+
+dowel_file_view_t* dowel_file_view_retain(dowel_file_view_t* view) {
+    if (view) atomic_fetch_add_explicit(&((mapped_file_t*)view)->refs, 1, memory_order_relaxed);
+    return view;
+}
+
+void dowel_file_view_release(dowel_file_view_t* view) {
+    if (!view) return;
+    mapped_file_t* mapped = (mapped_file_t*)view;
+    if (atomic_fetch_sub_explicit(&mapped->refs, 1, memory_order_acq_rel) != 1) return;
+    if (mapped->base) munmap(mapped->base, mapped->length);
+    free(mapped);
+}
+
+int dowel_file_view_advise(dowel_file_view_t* view, size_t offset, size_t length, int advice) {
+    if (!view || offset > view->size) return DOWEL_ERROR_INVALID_PARAMETER;
+    mapped_file_t* mapped = (mapped_file_t*)view;
+    if (!mapped->base) return DOWEL_SUCCESS;
+    if (length > view->size - offset) length = view->size - offset;
+
+    // madvise wants a page-aligned start
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t start = offset & ~(page - 1);
+    return apply_advice((uint8_t*)mapped->base + start, length + (offset - start), advice);
+}
+
+dowel_file_view_t* dcore_file_view_read(const char* path) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return NULL;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        close(fd);
+        return NULL;
+    }
+    dowel_file_view_t* view = read_view(fd, (size_t)st.st_size);
+    close(fd);
+    return view;
+}
+
+size_t dcore_file_view_footprint(const dowel_file_view_t* view) {
+    const mapped_file_t* mapped = (const mapped_file_t*)view;
+    return sizeof(*mapped) + (mapped->base ? 0 : mapped->length + 1);
+}
+
+// Metrics - I/O totals here, cache counters from file_cache.c
+
+static struct {
+    _Atomic uint64_t reads;
+    _Atomic uint64_t writes;
+    _Atomic uint64_t bytes_read;
+    _Atomic uint64_t bytes_written;
+} io_totals;
+
+void dcore_storage_count_read(size_t bytes) {
+    atomic_fetch_add_explicit(&io_totals.reads, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&io_totals.bytes_read, bytes, memory_order_relaxed);
+}
+
+void dcore_storage_count_write(size_t bytes) {
+    atomic_fetch_add_explicit(&io_totals.writes, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&io_totals.bytes_written, bytes, memory_order_relaxed);
+}
+
+dowel_storage_metrics_t dowel_storage_get_metrics(void) {
+    dowel_storage_metrics_t metrics;
+    memset(&metrics, 0, sizeof(metrics));
+    metrics.total_reads = atomic_load_explicit(&io_totals.reads, memory_order_relaxed);
+    metrics.total_writes = atomic_load_explicit(&io_totals.writes, memory_order_relaxed);
+    metrics.bytes_read = atomic_load_explicit(&io_totals.bytes_read, memory_order_relaxed);
+    metrics.bytes_written = atomic_load_explicit(&io_totals.bytes_written, memory_order_relaxed);
+    dcore_file_cache_add_metrics(&metrics);
+    return metrics;
+}
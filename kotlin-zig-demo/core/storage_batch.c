@@ -0,0 +1,625 @@
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+
+#include "core_internal.h"
+
+// Batched storage - dowel_storage_submit and dowel_storage_stat_directory
+//
+//  - io_uring backend: every request in a batch advances one step per ring
+//    round trip (open + statx, then reads or writes, then close), so N files
+//    cost a handful of io_uring_enter calls instead of ~4N syscalls. Rings
+//    are per thread, created on first use and closed when the thread exits.
+//  - Thread backend: when io_uring is unavailable (old kernel, seccomp) or
+//    "storage.io_uring" is false, each request runs the blocking calls as a
+//    task on the async pool and the batch waits for all of them.
+//  - There is no liburing dependency; the ring is set up with the raw
+//    syscalls and the kernel's ABI header.
+
+#define RING_ENTRIES 128
+#define MAX_IO_CHUNK (1u << 30)
+#define OP_NOT_RUN INT32_MIN
+
+typedef struct {
+    int fd;
+    unsigned sq_entries;
+    unsigned cq_entries;
+    _Atomic unsigned* sq_head;
+    _Atomic unsigned* sq_tail;
+    unsigned sq_mask;
+    unsigned* sq_array;
+    struct io_uring_sqe* sqes;
+    _Atomic unsigned* cq_head;
+    _Atomic unsigned* cq_tail;
+    unsigned cq_mask;
+    struct io_uring_cqe* cqes;
+
+    void* sq_map;
+    size_t sq_map_size;
+    void* cq_map;
+    size_t cq_map_size;
+    size_t sqes_size;
+} ring_t;
+
+// One SQE's worth of work; result gets the CQE's res
+typedef struct {
+    uint8_t opcode;
+    int fd;
+    const void* addr;
+    uint32_t len;
+    uint64_t off;
+    uint32_t flags;
+    int result;
+} ring_op_t;
+
+enum {
+    URING_UNKNOWN = 0,
+    URING_AVAILABLE = 1,
+    URING_UNAVAILABLE = 2,
+};
+
+static atomic_int uring_state = URING_UNKNOWN;
+static _Thread_local ring_t* thread_ring;
+static pthread_key_t ring_key;
+static pthread_once_t ring_key_once = PTHREAD_ONCE_INIT;
+
+// Ring setup
+
+static void ring_destroy(ring_t* ring) {
+    if (ring->sqes && ring->sqes != MAP_FAILED) munmap(ring->sqes, ring->sqes_size);
+    if (ring->cq_map && ring->cq_map != MAP_FAILED && ring->cq_map != ring->sq_map) {
+        munmap(ring->cq_map, ring->cq_map_size);
+    }
+    if (ring->sq_map && ring->sq_map != MAP_FAILED) munmap(ring->sq_map, ring->sq_map_size);
+    if (ring->fd >= 0) close(ring->fd);
+    free(ring);
+}
+
+static void release_thread_ring(void* ring) {
+    ring_destroy(ring);
+}
+
+static void create_ring_key(void) {
+    pthread_key_create(&ring_key, release_thread_ring);
+}
+
+// The ring set up on 5.1-5.5 kernels rejects every opcode used here, and
+// those kernels cannot be probed (IORING_REGISTER_PROBE is 5.6+ as well), so
+// either case counts as no io_uring
+static bool ring_supports_ops(int fd) {
+    static const uint8_t needed[] = {IORING_OP_OPENAT, IORING_OP_STATX, IORING_OP_READ, IORING_OP_WRITE, IORING_OP_CLOSE};
+    size_t size = sizeof(struct io_uring_probe) + IORING_OP_LAST * sizeof(struct io_uring_probe_op);
+    struct io_uring_probe* probe = calloc(1, size);
+    if (!probe) return false;
+    bool supported = syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE, probe, IORING_OP_LAST) == 0;
+    for (size_t i = 0; supported && i < sizeof(needed); i++) {
+        supported = needed[i] <= probe->last_op && (probe->ops[needed[i]].flags & IO_URING_OP_SUPPORTED);
+    }
+    free(probe);
+    return supported;
+}
+
+static ring_t* ring_create(void) {
+    ring_t* ring = calloc(1, sizeof(*ring));
+    if (!ring) return NULL;
+
+    // Rings are used by one thread that always waits for its completions, so
+    // completion work can run in that thread at io_uring_enter (6.1+); older
+    // kernels reject the flags and get a plain ring
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    params.flags = IORING_SETUP_SUBMIT_ALL | IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_DEFER_TASKRUN;
+    ring->fd = (int)syscall(__NR_io_uring_setup, RING_ENTRIES, &params);
+    if (ring->fd < 0 && errno == EINVAL) {
+        memset(&params, 0, sizeof(params));
+        ring->fd = (int)syscall(__NR_io_uring_setup, RING_ENTRIES, &params);
+    }
+    if (ring->fd < 0) {
+        free(ring);
+        return NULL;
+    }
+    if (!ring_supports_ops(ring->fd)) goto fail;
+
+    ring->sq_entries = params.sq_entries;
+    ring->cq_entries = params.cq_entries;
+    ring->sq_map_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cq_map_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        if (ring->cq_map_size > ring->sq_map_size) ring->sq_map_size = ring->cq_map_size;
+    }
+
+    ring->sq_map = mmap(NULL, ring->sq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                        ring->fd, IORING_OFF_SQ_RING);
+    if (ring->sq_map == MAP_FAILED) goto fail;
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        ring->cq_map = ring->sq_map;
+    } else {
+        ring->cq_map = mmap(NULL, ring->cq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                            ring->fd, IORING_OFF_CQ_RING);
+        if (ring->cq_map == MAP_FAILED) goto fail;
+    }
+    ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    ring->sqes = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      ring->fd, IORING_OFF_SQES);
+    if (ring->sqes == MAP_FAILED) goto fail;
+
+    uint8_t* sq = ring->sq_map;
+    ring->sq_head = (_Atomic unsigned*)(sq + params.sq_off.head);
+    ring->sq_tail = (_Atomic unsigned*)(sq + params.sq_off.tail);
+    ring->sq_mask = *(unsigned*)(sq + params.sq_off.ring_mask);
+    ring->sq_array = (unsigned*)(sq + params.sq_off.array);
+    uint8_t* cq = ring->cq_map;
+    ring->cq_head = (_Atomic unsigned*)(cq + params.cq_off.head);
+    ring->cq_tail = (_Atomic unsigned*)(cq + params.cq_off.tail);
+    ring->cq_mask = *(unsigned*)(cq + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe*)(cq + params.cq_off.cqes);
+    return ring;
+
+fail:
+    ring_destroy(ring);
+    return NULL;
+}
+
+// The calling thread's ring, or NULL if io_uring cannot be used here
+static ring_t* current_ring(void) {
+    if (thread_ring) return thread_ring;
+    if (atomic_load_explicit(&uring_state, memory_order_relaxed) == URING_UNAVAILABLE) return NULL;
+
+    ring_t* ring = ring_create();
+    if (!ring) {
+        // ENOSYS, EPERM (seccomp or io_uring_disabled) and the like do not
+        // change at runtime; stop trying
+        atomic_store_explicit(&uring_state, URING_UNAVAILABLE, memory_order_relaxed);
+        return NULL;
+    }
+    atomic_store_explicit(&uring_state, URING_AVAILABLE, memory_order_relaxed);
+    pthread_once(&ring_key_once, create_ring_key);
+    pthread_setspecific(ring_key, ring);
+    thread_ring = ring;
+    return ring;
+}
+
+static void prepare_sqe(struct io_uring_sqe* sqe, const ring_op_t* op, uint64_t index) {
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = op->opcode;
+    sqe->fd = op->fd;
+    sqe->addr = (uint64_t)(uintptr_t)op->addr;
+    sqe->len = op->len;
+    sqe->off = op->off;
+    sqe->open_flags = op->flags; // same union slot as statx_flags and rw_flags
+    sqe->user_data = index;
+}
+
+// Submits every op and waits for all completions. Returns false if the ring
+// itself failed; ops that never completed then hold OP_NOT_RUN.
+static bool ring_run(ring_t* ring, ring_op_t* ops, size_t count) {
+    for (size_t i = 0; i < count; i++) ops[i].result = OP_NOT_RUN;
+    size_t next = 0;
+    size_t done = 0;
+    size_t in_flight = 0;
+    bool ok = true;
+
+    while (done < count) {
+        // Fill the SQ, keeping in-flight ops within the CQ so none are dropped
+        unsigned tail = atomic_load_explicit(ring->sq_tail, memory_order_relaxed);
+        unsigned head = atomic_load_explicit(ring->sq_head, memory_order_acquire);
+        while (next < count && in_flight + (tail - head) < ring->cq_entries && tail - head < ring->sq_entries) {
+            unsigned slot = tail & ring->sq_mask;
+            prepare_sqe(&ring->sqes[slot], &ops[next], next);
+            ring->sq_array[slot] = slot;
+            tail++;
+            next++;
+        }
+        atomic_store_explicit(ring->sq_tail, tail, memory_order_release);
+
+        unsigned to_submit = tail - head;
+        int submitted = (int)syscall(__NR_io_uring_enter, ring->fd, to_submit, 1, IORING_ENTER_GETEVENTS, NULL, 0);
+        if (submitted < 0) {
+            if (errno == EINTR || errno == EAGAIN || errno == EBUSY) continue;
+            ok = false;
+            break;
+        }
+        in_flight += (size_t)submitted;
+
+        unsigned cq_head = atomic_load_explicit(ring->cq_head, memory_order_relaxed);
+        unsigned cq_tail = atomic_load_explicit(ring->cq_tail, memory_order_acquire);
+        while (cq_head != cq_tail) {
+            struct io_uring_cqe* cqe = &ring->cqes[cq_head & ring->cq_mask];
+            ops[cqe->user_data].result = cqe->res;
+            cq_head++;
+            done++;
+            in_flight--;
+        }
+        atomic_store_explicit(ring->cq_head, cq_head, memory_order_release);
+    }
+
+    return ok;
+}
+
+// io_uring backend
+
+typedef struct {
+    int fd;
+    struct statx stx;
+    size_t done;  // bytes read or written so far
+    size_t total; // bytes to read or write
+} request_state_t;
+
+static void set_stat(dowel_file_stat_t* out, const struct statx* stx) {
+    out->size = (int64_t)stx->stx_size;
+    out->modtime = (int64_t)stx->stx_mtime.tv_sec;
+    out->is_directory = S_ISDIR(stx->stx_mode);
+}
+
+static ring_op_t* add_op(ring_op_t* ops, size_t* count, uint8_t opcode, int fd, const void* addr) {
+    ring_op_t* op = &ops[(*count)++];
+    memset(op, 0, sizeof(*op));
+    op->opcode = opcode;
+    op->fd = fd;
+    op->addr = addr;
+    return op;
+}
+
+static bool submit_uring(ring_t* ring, dowel_arena_t* arena, dowel_io_request_t* requests, size_t count) {
+    request_state_t* states = calloc(count, sizeof(*states));
+    // At most two ops per request per round, plus the request index of each
+    ring_op_t* ops = malloc(2 * count * sizeof(*ops));
+    size_t* owners = malloc(2 * count * sizeof(*owners));
+    if (!states || !ops || !owners) {
+        free(states);
+        free(ops);
+        free(owners);
+        return false;
+    }
+
+    // Round 1: open files to read or write, statx everything read or stat-ed
+    size_t n = 0;
+    for (size_t i = 0; i < count; i++) {
+        dowel_io_request_t* request = &requests[i];
+        states[i].fd = -1;
+        if (request->op == DOWEL_IO_READ || request->op == DOWEL_IO_WRITE) {
+            ring_op_t* op = add_op(ops, &n, IORING_OP_OPENAT, AT_FDCWD, request->path);
+            op->flags = request->op == DOWEL_IO_READ ? O_RDONLY | O_CLOEXEC : O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+            op->len = 0644;
+            owners[n - 1] = i;
+        }
+        if (request->op == DOWEL_IO_READ || request->op == DOWEL_IO_STAT) {
+            ring_op_t* op = add_op(ops, &n, IORING_OP_STATX, AT_FDCWD, request->path);
+            op->len = STATX_TYPE | STATX_SIZE | STATX_MTIME;
+            op->off = (uint64_t)(uintptr_t)&states[i].stx;
+            owners[n - 1] = i;
+        }
+    }
+    bool ok = ring_run(ring, ops, n);
+
+    for (size_t k = 0; k < n; k++) {
+        dowel_io_request_t* request = &requests[owners[k]];
+        request_state_t* state = &states[owners[k]];
+        if (ops[k].result < 0) {
+            request->status = DOWEL_ERROR_STORAGE_ERROR;
+        } else if (ops[k].opcode == IORING_OP_OPENAT) {
+            state->fd = ops[k].result;
+        }
+    }
+    for (size_t i = 0; i < count; i++) {
+        dowel_io_request_t* request = &requests[i];
+        request_state_t* state = &states[i];
+        if (request->status != DOWEL_SUCCESS) continue;
+        if (request->op == DOWEL_IO_STAT) {
+            set_stat(&request->stat, &state->stx);
+        } else if (request->op == DOWEL_IO_READ) {
+            state->total = (size_t)state->stx.stx_size;
+            request->data = dcore_buffer_new(arena, state->total);
+            if (!request->data) request->status = DOWEL_ERROR_OUT_OF_MEMORY;
+        } else {
+            state->total = request->write_size;
+        }
+    }
+
+    // Round 2+: read or write until every file is done; short transfers are
+    // resubmitted for the remainder
+    while (ok) {
+        n = 0;
+        for (size_t i = 0; i < count; i++) {
+            dowel_io_request_t* request = &requests[i];
+            request_state_t* state = &states[i];
+            if (request->status != DOWEL_SUCCESS || request->op == DOWEL_IO_STAT || state->done == state->total) continue;
+            size_t chunk = state->total - state->done;
+            if (chunk > MAX_IO_CHUNK) chunk = MAX_IO_CHUNK;
+            ring_op_t* op;
+            if (request->op == DOWEL_IO_READ) {
+                op = add_op(ops, &n, IORING_OP_READ, state->fd, request->data->data + state->done);
+            } else {
+                op = add_op(ops, &n, IORING_OP_WRITE, state->fd, request->write_data + state->done);
+            }
+            op->len = (uint32_t)chunk;
+            op->off = state->done;
+            owners[n - 1] = i;
+        }
+        if (n == 0) break;
+        ok = ring_run(ring, ops, n);
+
+        for (size_t k = 0; k < n; k++) {
+            dowel_io_request_t* request = &requests[owners[k]];
+            request_state_t* state = &states[owners[k]];
+            int result = ops[k].result;
+            if (result == -EINTR || result == -EAGAIN) continue;
+            if (result > 0) {
+                state->done += (size_t)result;
+            } else if (result == 0 && request->op == DOWEL_IO_READ) {
+                // The file shrank after statx
+                state->total = state->done;
+            } else {
+                request->status = DOWEL_ERROR_STORAGE_ERROR;
+            }
+        }
+    }
+
+    // Last round: close. A failed close after a write means the data may not
+    // have made it, as in dowel_storage_write_file.
+    n = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (states[i].fd < 0) continue;
+        add_op(ops, &n, IORING_OP_CLOSE, states[i].fd, NULL);
+        owners[n - 1] = i;
+    }
+    if (n && ok) {
+        ok = ring_run(ring, ops, n);
+    } else {
+        for (size_t k = 0; k < n; k++) ops[k].result = OP_NOT_RUN;
+    }
+    for (size_t k = 0; k < n; k++) {
+        dowel_io_request_t* request = &requests[owners[k]];
+        if (!ok && ops[k].result == OP_NOT_RUN) ops[k].result = close(ops[k].fd) == 0 ? 0 : -errno;
+        if (ops[k].result < 0 && request->op == DOWEL_IO_WRITE) request->status = DOWEL_ERROR_STORAGE_ERROR;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        dowel_io_request_t* request = &requests[i];
+        if (ok && request->op == DOWEL_IO_WRITE && request->status == DOWEL_SUCCESS) {
+            dcore_storage_count_write(request->write_size);
+        }
+        if (request->op == DOWEL_IO_READ && request->data) {
+            if (request->status == DOWEL_SUCCESS) {
+                request->data->size = states[i].done;
+                if (ok) dcore_storage_count_read(states[i].done);
+            } else {
+                dcore_buffer_discard(arena, request->data);
+                request->data = NULL;
+            }
+        }
+    }
+
+    free(states);
+    free(ops);
+    free(owners);
+    return ok;
+}
+
+// Thread backend
+
+typedef struct {
+    dowel_arena_t* arena;
+    pthread_mutex_t arena_lock; // arenas are single-threaded
+} batch_t;
+
+typedef struct {
+    dowel_io_request_t* request;
+    batch_t* batch;
+} job_t;
+
+static dowel_buffer_t* read_whole_file(batch_t* batch, const char* path) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return NULL;
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return NULL;
+    }
+
+    pthread_mutex_lock(&batch->arena_lock);
+    dowel_buffer_t* buffer = dcore_buffer_new(batch->arena, (size_t)st.st_size);
+    pthread_mutex_unlock(&batch->arena_lock);
+    if (!buffer) {
+        close(fd);
+        return NULL;
+    }
+
+    size_t total = 0;
+    while (total < buffer->size) {
+        ssize_t n = read(fd, buffer->data + total, buffer->size - total);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        total += (size_t)n;
+    }
+    close(fd);
+    buffer->size = total;
+    dcore_storage_count_read(total);
+    return buffer;
+}
+
+static void run_blocking(void* data) {
+    job_t* job = data;
+    dowel_io_request_t* request = job->request;
+    switch (request->op) {
+        case DOWEL_IO_READ:
+            request->data = read_whole_file(job->batch, request->path);
+            if (!request->data) request->status = DOWEL_ERROR_STORAGE_ERROR;
+            break;
+        case DOWEL_IO_WRITE:
+            request->status = dowel_storage_write_file(request->path, request->write_data, request->write_size);
+            break;
+        case DOWEL_IO_STAT: {
+            struct stat st;
+            if (stat(request->path, &st) != 0) {
+                request->status = DOWEL_ERROR_STORAGE_ERROR;
+                break;
+            }
+            request->stat.size = (int64_t)st.st_size;
+            request->stat.modtime = (int64_t)st.st_mtime;
+            request->stat.is_directory = S_ISDIR(st.st_mode);
+            break;
+        }
+    }
+}
+
+static void submit_threads(dowel_arena_t* arena, dowel_io_request_t* requests, size_t count) {
+    batch_t batch = { .arena = arena };
+    pthread_mutex_init(&batch.arena_lock, NULL);
+    job_t* jobs = malloc(count * (sizeof(*jobs) + sizeof(dowel_task_t*)));
+    if (!jobs) {
+        job_t job = { .batch = &batch };
+        for (size_t i = 0; i < count; i++) {
+            job.request = &requests[i];
+            run_blocking(&job);
+        }
+        pthread_mutex_destroy(&batch.arena_lock);
+        return;
+    }
+
+    dowel_task_t** tasks = (dowel_task_t**)(jobs + count);
+    for (size_t i = 0; i < count; i++) {
+        jobs[i].request = &requests[i];
+        jobs[i].batch = &batch;
+        tasks[i] = dowel_async_spawn(run_blocking, &jobs[i]);
+        if (!tasks[i]) run_blocking(&jobs[i]);
+    }
+    for (size_t i = 0; i < count; i++) dowel_async_free_task(tasks[i]);
+    free(jobs);
+    pthread_mutex_destroy(&batch.arena_lock);
+}
+
+// Public API
+
+const char* dowel_storage_backend(void) {
+    if (!dowel_config_get_bool("storage.io_uring", true)) return "threads";
+    return current_ring() ? "io_uring" : "threads";
+}
+
+int dowel_storage_submit(dowel_io_request_t* requests, size_t count) {
+    return dowel_storage_submit_in(NULL, requests, count);
+}
+
+int dowel_storage_submit_in(dowel_arena_t* arena, dowel_io_request_t* requests, size_t count) {
+    if (count > 0 && !requests) return DOWEL_ERROR_INVALID_PARAMETER;
+    for (size_t i = 0; i < count; i++) {
+        dowel_io_request_t* request = &requests[i];
+        if (!request->path || request->op < DOWEL_IO_READ || request->op > DOWEL_IO_STAT ||
+            (request->op == DOWEL_IO_WRITE && !request->write_data && request->write_size > 0)) {
+            return DOWEL_ERROR_INVALID_PARAMETER;
+        }
+    }
+    for (size_t i = 0; i < count; i++) {
+        requests[i].status = DOWEL_SUCCESS;
+        requests[i].data = NULL;
+        memset(&requests[i].stat, 0, sizeof(requests[i].stat));
+        requests[i].stat.size = -1;
+    }
+    if (count == 0) return 0;
+
+    ring_t* ring = dowel_config_get_bool("storage.io_uring", true) ? current_ring() : NULL;
+    if (!ring || !submit_uring(ring, arena, requests, count)) {
+        // The ring failed part-way (or was never there): redo the whole batch
+        // the blocking way. Writes truncate first, so repeating one is safe.
+        for (size_t i = 0; i < count; i++) {
+            if (requests[i].data) dcore_buffer_discard(arena, requests[i].data);
+            requests[i].data = NULL;
+            requests[i].status = DOWEL_SUCCESS;
+        }
+        submit_threads(arena, requests, count);
+    }
+
+    int failed = 0;
+    for (size_t i = 0; i < count; i++) {
+        dowel_io_request_t* request = &requests[i];
+        if (request->op == DOWEL_IO_WRITE) dcore_storage_changed(request->path);
+        if (request->status != DOWEL_SUCCESS) failed++;
+    }
+    return failed;
+}
+
+dowel_dir_entry_t* dowel_storage_stat_directory(const char* path, size_t* count) {
+    if (!path || !count) return NULL;
+    *count = 0;
+
+    DIR* dir = opendir(path);
+    if (!dir) return NULL;
+
+    size_t capacity = 16;
+    size_t used = 0;
+    dowel_dir_entry_t* entries = malloc(capacity * sizeof(*entries));
+    struct dirent* entry;
+    while (entries && (entry = readdir(dir)) != NULL) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) continue;
+        if (used == capacity) {
+            dowel_dir_entry_t* grown = realloc(entries, capacity * 2 * sizeof(*entries));
+            if (!grown) break;
+            entries = grown;
+            capacity *= 2;
+        }
+        entries[used].name = strdup(entry->d_name);
+        if (!entries[used].name) break;
+        memset(&entries[used].stat, 0, sizeof(entries[used].stat));
+        used++;
+    }
+    if (!entries) {
+        closedir(dir);
+        return NULL;
+    }
+
+    // One statx per entry relative to the directory, all in one batch
+    int dir_fd = dirfd(dir);
+    ring_t* ring = dowel_config_get_bool("storage.io_uring", true) ? current_ring() : NULL;
+    struct statx* stx = ring && used ? malloc(used * sizeof(*stx)) : NULL;
+    ring_op_t* ops = stx ? malloc(used * sizeof(*ops)) : NULL;
+    bool done = false;
+    if (ops) {
+        size_t n = 0;
+        for (size_t i = 0; i < used; i++) {
+            ring_op_t* op = add_op(ops, &n, IORING_OP_STATX, dir_fd, entries[i].name);
+            op->len = STATX_TYPE | STATX_SIZE | STATX_MTIME;
+            op->off = (uint64_t)(uintptr_t)&stx[i];
+            op->flags = AT_SYMLINK_NOFOLLOW;
+        }
+        done = ring_run(ring, ops, n);
+        for (size_t i = 0; done && i < used; i++) {
+            if (ops[i].result == 0) {
+                set_stat(&entries[i].stat, &stx[i]);
+            } else {
+                entries[i].stat.size = -1; // removed since it was listed
+            }
+        }
+    }
+    for (size_t i = 0; !done && i < used; i++) {
+        struct stat st;
+        if (fstatat(dir_fd, entries[i].name, &st, AT_SYMLINK_NOFOLLOW) != 0) {
+            entries[i].stat.size = -1;
+            continue;
+        }
+        entries[i].stat.size = (int64_t)st.st_size;
+        entries[i].stat.modtime = (int64_t)st.st_mtime;
+        entries[i].stat.is_directory = S_ISDIR(st.st_mode);
+    }
+    free(ops);
+    free(stx);
+    closedir(dir);
+
+    *count = used;
+    return entries;
+}
+
+void dowel_storage_free_dir_entries(dowel_dir_entry_t* entries, size_t count) {
+    if (!entries) return;
+    for (size_t i = 0; i < count; i++) free(entries[i].name);
+    free(entries);
+}
@@ -0,0 +1,611 @@
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <zlib.h>
+#include <sys/stat.h>
+
+#include "core_internal.h"
+
+// Streams - dowel_stream_*
+//
+// A stream is a stack of stages with the file at the bottom. Writes are
+// pushed down through the stages (gzip, then encryption, then the file's
+// write-behind buffer); reads pull up through them in the reverse order.
+// Every stage holds at most a chunk or a segment, so memory does not grow
+// with the file.
+//
+//  - File stage: reads refill a chunk-sized buffer and ask the kernel to
+//    read the next chunk ahead; writes fill the buffer and, once it is
+//    written, start writeback for it so dirty pages do not pile up. Reads
+//    and writes of at least a chunk bypass the buffer.
+//  - Gzip stage: zlib deflate/inflate with standard gzip framing, so
+//    dowel_decompress_gzip can read a whole file written this way.
+//  - Encryption stage: AES-256-GCM over 64 KB segments, each authenticated
+//    before any of it is returned (the STREAM construction). Layout:
+//
+//        "DWE1" | nonce prefix (7) | segment* where segment = ciphertext | tag
+//
+//    The nonce of segment i is prefix | i (4 bytes, big endian) | last flag,
+//    so reordered, dropped or truncated segments fail authentication. This
+//    is not the dowel_crypto_encrypt layout, which seals one message.
+
+#define DEFAULT_CHUNK_SIZE (256 * 1024)
+#define MIN_CHUNK_SIZE 4096
+#define GZIP_WINDOW_BITS (15 + 16)
+#define GZIP_AUTO_WINDOW_BITS (15 + 32)
+
+#define SEGMENT_SIZE (64 * 1024)
+#define SEALED_SEGMENT_SIZE (SEGMENT_SIZE + DCORE_GCM_TAG_SIZE)
+#define PREFIX_SIZE 7
+#define HEADER_SIZE (4 + PREFIX_SIZE)
+static const uint8_t segment_magic[4] = { 'D', 'W', 'E', '1' };
+
+typedef struct stage stage_t;
+
+struct stage {
+    stage_t* next; // toward the file
+    // Write direction; finish flushes whatever the stage still holds
+    int (*push)(stage_t* stage, const uint8_t* data, size_t size);
+    int (*finish)(stage_t* stage);
+    // Read direction: up to size bytes, 0 at the end, or a negative error
+    int64_t (*pull)(stage_t* stage, uint8_t* out, size_t size);
+    void (*destroy)(stage_t* stage);
+};
+
+struct dowel_stream {
+    dowel_stream_mode_t mode;
+    stage_t* top;
+    struct file_stage* file;
+    char* path;
+    int status; // first error; the stream refuses further I/O after one
+};
+
+// Reads exactly size bytes from a stage unless it ends first
+static int64_t pull_full(stage_t* stage, uint8_t* out, size_t size) {
+    size_t total = 0;
+    while (total < size) {
+        int64_t n = stage->pull(stage, out + total, size - total);
+        if (n < 0) return n;
+        if (n == 0) break;
+        total += (size_t)n;
+    }
+    return (int64_t)total;
+}
+
+// File stage
+
+typedef struct file_stage {
+    stage_t base;
+    int fd;
+    uint8_t* buffer;
+    size_t capacity;
+    size_t pos; // read: next byte to hand out; write: bytes buffered
+    size_t len; // read: bytes in the buffer
+    int64_t offset; // file offset of buffer[0]
+    uint64_t bytes; // moved to or from the file, for metrics
+} file_stage_t;
+
+static int write_all(int fd, const uint8_t* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = write(fd, data, size);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return DOWEL_ERROR_STORAGE_ERROR;
+        data += n;
+        size -= (size_t)n;
+    }
+    return DOWEL_SUCCESS;
+}
+
+static int file_write_through(file_stage_t* file, const uint8_t* data, size_t size) {
+    int status = write_all(file->fd, data, size);
+    if (status != DOWEL_SUCCESS) return status;
+#if defined(__linux__)
+    // Write-behind: start writeback now rather than when the kernel gets to it
+    sync_file_range(file->fd, file->offset, (off_t)size, SYNC_FILE_RANGE_WRITE);
+#endif
+    file->offset += (int64_t)size;
+    file->bytes += size;
+    return DOWEL_SUCCESS;
+}
+
+static int file_flush(file_stage_t* file) {
+    if (file->pos == 0) return DOWEL_SUCCESS;
+    int status = file_write_through(file, file->buffer, file->pos);
+    file->pos = 0;
+    return status;
+}
+
+static int file_push(stage_t* stage, const uint8_t* data, size_t size) {
+    file_stage_t* file = (file_stage_t*)stage;
+    while (size > 0) {
+        if (file->pos == 0 && size >= file->capacity) return file_write_through(file, data, size);
+        size_t n = file->capacity - file->pos;
+        if (n > size) n = size;
+        memcpy(file->buffer + file->pos, data, n);
+        file->pos += n;
+        data += n;
+        size -= n;
+        if (file->pos == file->capacity) {
+            int status = file_flush(file);
+            if (status != DOWEL_SUCCESS) return status;
+        }
+    }
+    return DOWEL_SUCCESS;
+}
+
+static int file_finish(stage_t* stage) {
+    return file_flush((file_stage_t*)stage);
+}
+
+static int64_t file_read(file_stage_t* file, uint8_t* out, size_t size) {
+    for (;;) {
+        ssize_t n = read(file->fd, out, size);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) return DOWEL_ERROR_STORAGE_ERROR;
+        file->bytes += (size_t)n;
+        return n;
+    }
+}
+
+static int64_t file_pull(stage_t* stage, uint8_t* out, size_t size) {
+    file_stage_t* file = (file_stage_t*)stage;
+    if (file->pos == file->len) {
+        file->offset += (int64_t)file->len;
+        file->pos = file->len = 0;
+        if (size >= file->capacity) {
+            int64_t n = file_read(file, out, size);
+            if (n > 0) file->offset += n;
+            return n;
+        }
+        int64_t n = file_read(file, file->buffer, file->capacity);
+        if (n <= 0) return n;
+        file->len = (size_t)n;
+#if defined(__linux__)
+        // Readahead: the next chunk loads while this one is consumed
+        posix_fadvise(file->fd, file->offset + n, (off_t)file->capacity, POSIX_FADV_WILLNEED);
+#endif
+    }
+    size_t n = file->len - file->pos;
+    if (n > size) n = size;
+    memcpy(out, file->buffer + file->pos, n);
+    file->pos += n;
+    return (int64_t)n;
+}
+
+static void file_destroy(stage_t* stage) {
+    file_stage_t* file = (file_stage_t*)stage;
+    if (file->fd >= 0) close(file->fd);
+    free(file->buffer);
+    free(file);
+}
+
+static file_stage_t* file_stage_new(int fd, size_t chunk_size) {
+    file_stage_t* file = calloc(1, sizeof(*file));
+    if (!file) return NULL;
+    file->buffer = malloc(chunk_size);
+    if (!file->buffer) {
+        free(file);
+        return NULL;
+    }
+    file->fd = fd;
+    file->capacity = chunk_size;
+    file->base.push = file_push;
+    file->base.finish = file_finish;
+    file->base.pull = file_pull;
+    file->base.destroy = file_destroy;
+    return file;
+}
+
+// Gzip stage
+
+typedef struct {
+    stage_t base;
+    z_stream zs;
+    bool writing;
+    bool ended; // read: the last gzip member has been fully inflated
+    uint8_t* buffer; // write: deflate output; read: compressed input
+    size_t capacity;
+} gzip_stage_t;
+
+static int gzip_deflate(gzip_stage_t* gz, int flush) {
+    for (;;) {
+        gz->zs.next_out = gz->buffer;
+        gz->zs.avail_out = (uInt)gz->capacity;
+        int result = deflate(&gz->zs, flush);
+        if (result == Z_STREAM_ERROR) return DOWEL_ERROR_STORAGE_ERROR;
+        size_t produced = gz->capacity - gz->zs.avail_out;
+        if (produced > 0) {
+            int status = gz->base.next->push(gz->base.next, gz->buffer, produced);
+            if (status != DOWEL_SUCCESS) return status;
+        }
+        if (flush == Z_FINISH ? result == Z_STREAM_END : gz->zs.avail_out != 0) return DOWEL_SUCCESS;
+    }
+}
+
+static int gzip_push(stage_t* stage, const uint8_t* data, size_t size) {
+    gzip_stage_t* gz = (gzip_stage_t*)stage;
+    while (size > 0) {
+        // avail_in is 32-bit
+        uInt n = size > UINT32_MAX ? UINT32_MAX : (uInt)size;
+        gz->zs.next_in = (Bytef*)data;
+        gz->zs.avail_in = n;
+        int status = gzip_deflate(gz, Z_NO_FLUSH);
+        if (status != DOWEL_SUCCESS) return status;
+        data += n;
+        size -= n;
+    }
+    return DOWEL_SUCCESS;
+}
+
+static int gzip_finish(stage_t* stage) {
+    gzip_stage_t* gz = (gzip_stage_t*)stage;
+    gz->zs.next_in = NULL;
+    gz->zs.avail_in = 0;
+    int status = gzip_deflate(gz, Z_FINISH);
+    if (status != DOWEL_SUCCESS) return status;
+    return stage->next->finish(stage->next);
+}
+
+static int64_t gzip_pull(stage_t* stage, uint8_t* out, size_t size) {
+    gzip_stage_t* gz = (gzip_stage_t*)stage;
+    if (size > UINT32_MAX) size = UINT32_MAX;
+    gz->zs.next_out = out;
+    gz->zs.avail_out = (uInt)size;
+
+    while (gz->zs.avail_out == size && !gz->ended) {
+        if (gz->zs.avail_in == 0) {
+            int64_t n = stage->next->pull(stage->next, gz->buffer, gz->capacity);
+            if (n < 0) return n;
+            if (n == 0) return DOWEL_ERROR_STORAGE_ERROR; // truncated
+            gz->zs.next_in = gz->buffer;
+            gz->zs.avail_in = (uInt)n;
+        }
+        int result = inflate(&gz->zs, Z_NO_FLUSH);
+        if (result == Z_STREAM_END) {
+            // Concatenated members, as gzip itself allows, continue the data
+            if (gz->zs.avail_in == 0) {
+                int64_t n = stage->next->pull(stage->next, gz->buffer, gz->capacity);
+                if (n < 0) return n;
+                gz->zs.next_in = gz->buffer;
+                gz->zs.avail_in = (uInt)n;
+            }
+            if (gz->zs.avail_in == 0) {
+                gz->ended = true;
+            } else {
+                inflateReset(&gz->zs);
+            }
+        } else if (result != Z_OK && result != Z_BUF_ERROR) {
+            return DOWEL_ERROR_STORAGE_ERROR;
+        }
+    }
+    return (int64_t)(size - gz->zs.avail_out);
+}
+
+static void gzip_destroy(stage_t* stage) {
+    gzip_stage_t* gz = (gzip_stage_t*)stage;
+    if (gz->writing) deflateEnd(&gz->zs); else inflateEnd(&gz->zs);
+    free(gz->buffer);
+    free(gz);
+}
+
+static stage_t* gzip_stage_new(stage_t* next, bool writing, size_t chunk_size) {
+    gzip_stage_t* gz = calloc(1, sizeof(*gz));
+    if (!gz) return NULL;
+    gz->buffer = malloc(chunk_size);
+    int result = !gz->buffer ? Z_MEM_ERROR
+        : writing ? deflateInit2(&gz->zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, GZIP_WINDOW_BITS, 8, Z_DEFAULT_STRATEGY)
+                  : inflateInit2(&gz->zs, GZIP_AUTO_WINDOW_BITS);
+    if (result != Z_OK) {
+        free(gz->buffer);
+        free(gz);
+        return NULL;
+    }
+    gz->writing = writing;
+    gz->capacity = chunk_size;
+    gz->base.next = next;
+    gz->base.push = gzip_push;
+    gz->base.finish = gzip_finish;
+    gz->base.pull = gzip_pull;
+    gz->base.destroy = gzip_destroy;
+    return &gz->base;
+}
+
+// Encryption stage
+
+typedef struct {
+    stage_t base;
+    dcore_gcm_t* gcm;
+    uint8_t prefix[PREFIX_SIZE];
+    uint32_t counter;
+    bool started; // read: header checked
+    bool ended;   // read: last segment opened
+    uint8_t plain[SEGMENT_SIZE];
+    size_t plain_len;
+    size_t plain_pos; // read: next plaintext byte to hand out
+    uint8_t sealed[SEALED_SEGMENT_SIZE + 1]; // read: one byte of lookahead
+    size_t sealed_len;
+} crypt_stage_t;
+
+static void segment_nonce(const crypt_stage_t* crypt, bool last, uint8_t nonce[DCORE_GCM_NONCE_SIZE]) {
+    memcpy(nonce, crypt->prefix, PREFIX_SIZE);
+    nonce[7] = (uint8_t)(crypt->counter >> 24);
+    nonce[8] = (uint8_t)(crypt->counter >> 16);
+    nonce[9] = (uint8_t)(crypt->counter >> 8);
+    nonce[10] = (uint8_t)crypt->counter;
+    nonce[11] = last ? 1 : 0;
+}
+
+static int seal_segment(crypt_stage_t* crypt, bool last) {
+    if (crypt->counter == UINT32_MAX) return DOWEL_ERROR_CRYPTO_ERROR;
+    uint8_t nonce[DCORE_GCM_NONCE_SIZE];
+    segment_nonce(crypt, last, nonce);
+    dcore_gcm_seal(crypt->gcm, nonce, crypt->plain, crypt->plain_len, crypt->sealed);
+    crypt->counter++;
+    size_t sealed = crypt->plain_len + DCORE_GCM_TAG_SIZE;
+    crypt->plain_len = 0;
+    return crypt->base.next->push(crypt->base.next, crypt->sealed, sealed);
+}
+
+static int crypt_push(stage_t* stage, const uint8_t* data, size_t size) {
+    crypt_stage_t* crypt = (crypt_stage_t*)stage;
+    while (size > 0) {
+        // A full segment is only sealed once more data shows it is not the last
+        if (crypt->plain_len == SEGMENT_SIZE) {
+            int status = seal_segment(crypt, false);
+            if (status != DOWEL_SUCCESS) return status;
+        }
+        size_t n = SEGMENT_SIZE - crypt->plain_len;
+        if (n > size) n = size;
+        memcpy(crypt->plain + crypt->plain_len, data, n);
+        crypt->plain_len += n;
+        data += n;
+        size -= n;
+    }
+    return DOWEL_SUCCESS;
+}
+
+static int crypt_finish(stage_t* stage) {
+    crypt_stage_t* crypt = (crypt_stage_t*)stage;
+    int status = seal_segment(crypt, true);
+    if (status != DOWEL_SUCCESS) return status;
+    return stage->next->finish(stage->next);
+}
+
+// Reads and opens the next segment into plain
+static int open_segment(crypt_stage_t* crypt) {
+    stage_t* next = crypt->base.next;
+    if (!crypt->started) {
+        uint8_t header[HEADER_SIZE];
+        int64_t n = pull_full(next, header, HEADER_SIZE);
+        if (n < 0) return (int)n;
+        if (n != HEADER_SIZE || memcmp(header, segment_magic, sizeof(segment_magic)) != 0) {
+            return DOWEL_ERROR_CRYPTO_ERROR;
+        }
+        memcpy(crypt->prefix, header + sizeof(segment_magic), PREFIX_SIZE);
+        crypt->started = true;
+    }
+
+    // Fill one byte past a full segment: if it is there, this segment is not
+    // the last one
+    int64_t n = pull_full(next, crypt->sealed + crypt->sealed_len, sizeof(crypt->sealed) - crypt->sealed_len);
+    if (n < 0) return (int)n;
+    crypt->sealed_len += (size_t)n;
+    bool last = crypt->sealed_len <= SEALED_SEGMENT_SIZE;
+    size_t sealed = last ? crypt->sealed_len : SEALED_SEGMENT_SIZE;
+
+    uint8_t nonce[DCORE_GCM_NONCE_SIZE];
+    segment_nonce(crypt, last, nonce);
+    if (!dcore_gcm_open(crypt->gcm, nonce, crypt->sealed, sealed, crypt->plain)) {
+        dcore_report_error(DOWEL_ERROR_CRYPTO_ERROR, "Stream segment failed authentication");
+        return DOWEL_ERROR_CRYPTO_ERROR;
+    }
+    crypt->counter++;
+    crypt->plain_len = sealed - DCORE_GCM_TAG_SIZE;
+    crypt->plain_pos = 0;
+    crypt->ended = last;
+    if (!last) {
+        crypt->sealed[0] = crypt->sealed[SEALED_SEGMENT_SIZE];
+        crypt->sealed_len = 1;
+    }
+    return DOWEL_SUCCESS;
+}
+
+static int64_t crypt_pull(stage_t* stage, uint8_t* out, size_t size) {
+    crypt_stage_t* crypt = (crypt_stage_t*)stage;
+    while (crypt->plain_pos == crypt->plain_len) {
+        if (crypt->ended) return 0;
+        int status = open_segment(crypt);
+        if (status != DOWEL_SUCCESS) return status;
+    }
+    size_t n = crypt->plain_len - crypt->plain_pos;
+    if (n > size) n = size;
+    memcpy(out, crypt->plain + crypt->plain_pos, n);
+    crypt->plain_pos += n;
+    return (int64_t)n;
+}
+
+static void crypt_destroy(stage_t* stage) {
+    crypt_stage_t* crypt = (crypt_stage_t*)stage;
+    dcore_gcm_free(crypt->gcm);
+    explicit_bzero(crypt->plain, sizeof(crypt->plain));
+    free(crypt);
+}
+
+static stage_t* crypt_stage_new(stage_t* next, bool writing, const dowel_crypto_key_t* key) {
+    crypt_stage_t* crypt = calloc(1, sizeof(*crypt));
+    if (!crypt) return NULL;
+    crypt->gcm = dcore_gcm_new(key);
+    if (!crypt->gcm) {
+        free(crypt);
+        return NULL;
+    }
+    crypt->base.next = next;
+    crypt->base.push = crypt_push;
+    crypt->base.finish = crypt_finish;
+    crypt->base.pull = crypt_pull;
+    crypt->base.destroy = crypt_destroy;
+
+    if (writing) {
+        uint8_t header[HEADER_SIZE];
+        memcpy(header, segment_magic, sizeof(segment_magic));
+        int status = dcore_crypto_random(crypt->prefix, PREFIX_SIZE);
+        memcpy(header + sizeof(segment_magic), crypt->prefix, PREFIX_SIZE);
+        if (status == DOWEL_SUCCESS) status = next->push(next, header, HEADER_SIZE);
+        if (status != DOWEL_SUCCESS) {
+            crypt_destroy(&crypt->base);
+            return NULL;
+        }
+    }
+    return &crypt->base;
+}
+
+// Public API
+
+static void destroy_stages(stage_t* top) {
+    while (top) {
+        stage_t* next = top->next;
+        top->destroy(top);
+        top = next;
+    }
+}
+
+static bool push_stage(dowel_stream_t* stream, stage_t* stage) {
+    if (stage) stream->top = stage;
+    return stage != NULL;
+}
+
+dowel_stream_t* dowel_stream_open(const char* path, dowel_stream_mode_t mode, const dowel_stream_options_t* options) {
+    if (!path || (mode != DOWEL_STREAM_READ && mode != DOWEL_STREAM_WRITE)) return NULL;
+    dowel_stream_options_t defaults = { 0 };
+    if (!options) options = &defaults;
+    if (options->key && options->key->size != 32) return NULL; // AES-256
+    size_t chunk_size = options->chunk_size ? options->chunk_size : DEFAULT_CHUNK_SIZE;
+    if (chunk_size < MIN_CHUNK_SIZE) chunk_size = MIN_CHUNK_SIZE;
+    bool writing = mode == DOWEL_STREAM_WRITE;
+
+    int fd = writing ? open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644) : open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        dcore_report_error(DOWEL_ERROR_STORAGE_ERROR, "Failed to open file for streaming");
+        return NULL;
+    }
+    if (writing) dcore_storage_changed(path);
+#if defined(__linux__)
+    if (!writing) posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+    dowel_stream_t* stream = calloc(1, sizeof(*stream));
+    file_stage_t* file = file_stage_new(fd, chunk_size);
+    if (!stream || !file || !(stream->path = strdup(path))) {
+        if (file) file_destroy(&file->base); else close(fd);
+        free(stream);
+        return NULL;
+    }
+    stream->mode = mode;
+    stream->file = file;
+    stream->top = &file->base;
+
+    // Writes compress before encrypting, since ciphertext does not compress;
+    // reads undo the same steps from the bottom up
+    bool ok = true;
+    if (options->key) ok = push_stage(stream, crypt_stage_new(stream->top, writing, options->key));
+    if (ok && options->gzip) ok = push_stage(stream, gzip_stage_new(stream->top, writing, chunk_size));
+    if (!ok) {
+        destroy_stages(stream->top);
+        free(stream->path);
+        free(stream);
+        return NULL;
+    }
+    return stream;
+}
+
+int64_t dowel_stream_read(dowel_stream_t* stream, uint8_t* buffer, size_t size) {
+    if (!stream || stream->mode != DOWEL_STREAM_READ || (!buffer && size > 0)) return DOWEL_ERROR_INVALID_PARAMETER;
+    if (stream->status != DOWEL_SUCCESS) return stream->status;
+    if (size > INT64_MAX) size = INT64_MAX;
+
+    // Fill as much of the caller's buffer as the data allows. Bytes that were
+    // already verified are handed out before an error, which then sticks.
+    size_t total = 0;
+    while (total < size) {
+        int64_t n = stream->top->pull(stream->top, buffer + total, size - total);
+        if (n < 0) {
+            stream->status = (int)n;
+            return total > 0 ? (int64_t)total : n;
+        }
+        if (n == 0) break;
+        total += (size_t)n;
+    }
+    return (int64_t)total;
+}
+
+int64_t dowel_stream_write(dowel_stream_t* stream, const uint8_t* data, size_t size) {
+    if (!stream || stream->mode != DOWEL_STREAM_WRITE || (!data && size > 0)) return DOWEL_ERROR_INVALID_PARAMETER;
+    if (stream->status != DOWEL_SUCCESS) return stream->status;
+    if (size > INT64_MAX) return DOWEL_ERROR_INVALID_PARAMETER;
+
+    int status = stream->top->push(stream->top, data, size);
+    if (status != DOWEL_SUCCESS) {
+        stream->status = status;
+        return status;
+    }
+    return (int64_t)size;
+}
+
+int64_t dowel_stream_seek(dowel_stream_t* stream, int64_t offset, int whence) {
+    // Compressed and encrypted data has no byte-addressable layout
+    if (!stream || stream->top != &stream->file->base) return DOWEL_ERROR_INVALID_PARAMETER;
+    if (whence != DOWEL_SEEK_SET && whence != DOWEL_SEEK_CUR && whence != DOWEL_SEEK_END) {
+        return DOWEL_ERROR_INVALID_PARAMETER;
+    }
+    if (stream->status != DOWEL_SUCCESS) return stream->status;
+    file_stage_t* file = stream->file;
+
+    // The logical position includes what is buffered
+    int64_t position = file->offset + (int64_t)file->pos;
+    if (whence == DOWEL_SEEK_CUR) {
+        offset += position;
+    } else if (whence == DOWEL_SEEK_END) {
+        if (stream->mode == DOWEL_STREAM_WRITE && file_flush(file) != DOWEL_SUCCESS) {
+            return stream->status = DOWEL_ERROR_STORAGE_ERROR;
+        }
+        struct stat st;
+        if (fstat(file->fd, &st) != 0) return DOWEL_ERROR_STORAGE_ERROR;
+        offset += st.st_size;
+    }
+    if (offset < 0) return DOWEL_ERROR_INVALID_PARAMETER;
+
+    if (stream->mode == DOWEL_STREAM_READ) {
+        // Stay in the read buffer when the target is inside it
+        if (offset >= file->offset && offset <= file->offset + (int64_t)file->len) {
+            file->pos = (size_t)(offset - file->offset);
+            return offset;
+        }
+        file->pos = file->len = 0;
+    } else if (file_flush(file) != DOWEL_SUCCESS) {
+        return stream->status = DOWEL_ERROR_STORAGE_ERROR;
+    }
+    if (lseek(file->fd, offset, SEEK_SET) < 0) return DOWEL_ERROR_STORAGE_ERROR;
+    file->offset = offset;
+    return offset;
+}
+
+int dowel_stream_close(dowel_stream_t* stream) {
+    if (!stream) return DOWEL_ERROR_INVALID_PARAMETER;
+    int status = stream->status;
+    if (stream->mode == DOWEL_STREAM_WRITE) {
+        if (status == DOWEL_SUCCESS) status = stream->top->finish(stream->top);
+        if (close(stream->file->fd) != 0 && status == DOWEL_SUCCESS) status = DOWEL_ERROR_STORAGE_ERROR;
+        stream->file->fd = -1;
+        dcore_storage_changed(stream->path);
+        dcore_storage_count_write(stream->file->bytes);
+    } else {
+        dcore_storage_count_read(stream->file->bytes);
+    }
+    destroy_stages(stream->top);
+    free(stream->path);
+    free(stream);
+    return status;
+}
@@ -0,0 +1,723 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#include "core_internal.h"
+
+// File watching - one inotify instance shared by every watcher
+//
+//  - All watches live on a single inotify fd. One service thread waits in
+//    epoll on it and on an eventfd for wakeups, and runs while any watcher
+//    exists.
+//  - Watch descriptors map to a path and the watchers that asked for it, so
+//    watchers of the same directory share one descriptor. Every watch uses
+//    the same mask and each watcher filters for its own events.
+//  - Recursive watchers add a watch for each subdirectory as it appears, then
+//    list it and report what was created before the watch existed.
+//  - With a coalescing window, the events for one path fold into their net
+//    change, delivered when the window that opened with the first event
+//    closes: a file written many times is one MODIFIED, and a save that
+//    writes a temp file and renames it over the target is one MODIFIED on
+//    the target (the temp file itself nets to nothing).
+//  - Callbacks run on the service thread, outside its lock, with everything
+//    due for a watcher delivered as one batch. An inotify queue overflow is
+//    reported as MODIFIED on each watcher's root path.
+
+// Attribute changes (touch, chmod) are reported as MODIFIED
+#define WATCH_MASK (IN_CREATE | IN_DELETE | IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB | IN_MOVED_FROM | IN_MOVED_TO | \
+                    IN_DELETE_SELF | IN_MOVE_SELF | IN_EXCL_UNLINK)
+#define READ_BUFFER_SIZE (64 * 1024)
+
+// What an event did to the path's existence
+enum {
+    CHANGE_APPEARED = 0,
+    CHANGE_CHANGED = 1,
+    CHANGE_GONE = 2,
+};
+
+typedef struct pending {
+    struct pending* next;  // arrival order; deadlines follow it
+    struct pending* chain; // hash bucket
+    uint64_t hash;
+    int64_t deadline;
+    uint8_t first_change;
+    uint8_t last_change;
+    bool moved_in;  // the first event was a move into place
+    bool moved_out; // the latest event was a move away
+    char path[];
+} pending_t;
+
+struct dowel_file_watcher {
+    struct dowel_file_watcher* next;
+    char* path;
+    int events;
+    bool recursive;
+    int64_t window_ns;
+    dowel_file_event_callback_t callback;
+    dowel_file_batch_callback_t batch_callback;
+    void* user_data;
+    bool running;
+
+    int* wds;
+    size_t wd_count;
+    size_t wd_capacity;
+
+    // Coalescing: events waiting for their window to close
+    pending_t* head;
+    pending_t* tail;
+    pending_t** buckets;
+    size_t bucket_mask;
+    size_t pending_count;
+
+    // Cookie of a rename away from a file created within the window: the
+    // matching move into place is an atomic save, not a new file
+    uint32_t save_cookie;
+
+    // Due for delivery in this round
+    dowel_file_event_record_t* due;
+    size_t due_count;
+    size_t due_capacity;
+};
+
+typedef struct {
+    char* path;
+    dowel_file_watcher_t** watchers;
+    size_t count;
+    size_t capacity;
+} watch_t;
+
+static struct {
+    pthread_mutex_t lock;
+    pthread_cond_t round_done;
+    int inotify_fd;
+    int epoll_fd;
+    int wake_fd;
+    pthread_t thread;
+    bool thread_running;
+    bool stopping;
+    bool dispatching;
+    dowel_file_watcher_t* watchers;
+    dowel_file_watcher_t* zombies; // destroyed from a callback, freed after the round
+    watch_t* watches;              // indexed by watch descriptor
+    size_t watch_capacity;
+} service = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .round_done = PTHREAD_COND_INITIALIZER,
+    .inotify_fd = -1,
+    .epoll_fd = -1,
+    .wake_fd = -1,
+};
+
+static uint64_t hash_path(const char* s) {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    while (*s) {
+        h ^= (unsigned char)*s++;
+        h *= 0x100000001b3ULL;
+    }
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return h;
+}
+
+static char* join_path(const char* dir, const char* name) {
+    char* path;
+    return asprintf(&path, "%s/%s", dir, name) < 0 ? NULL : path;
+}
+
+static bool on_service_thread(void) {
+    return service.thread_running && pthread_equal(pthread_self(), service.thread);
+}
+
+static void wake_service(void) {
+    uint64_t one = 1;
+    ssize_t written = write(service.wake_fd, &one, sizeof(one));
+    (void)written;
+}
+
+// Events
+
+static void classify(uint32_t mask, dowel_file_event_t* kind, uint8_t* change) {
+    if (mask & IN_CREATE) {
+        *kind = DOWEL_FILE_EVENT_CREATED;
+        *change = CHANGE_APPEARED;
+    } else if (mask & IN_MOVED_TO) {
+        *kind = DOWEL_FILE_EVENT_MOVED;
+        *change = CHANGE_APPEARED;
+    } else if (mask & (IN_DELETE | IN_DELETE_SELF)) {
+        *kind = DOWEL_FILE_EVENT_DELETED;
+        *change = CHANGE_GONE;
+    } else if (mask & (IN_MOVED_FROM | IN_MOVE_SELF)) {
+        *kind = DOWEL_FILE_EVENT_MOVED;
+        *change = CHANGE_GONE;
+    } else {
+        *kind = DOWEL_FILE_EVENT_MODIFIED;
+        *change = CHANGE_CHANGED;
+    }
+}
+
+// Net effect of a coalesced run of events, or 0 if there was none
+static int net_event(const pending_t* pending) {
+    bool existed = pending->first_change != CHANGE_APPEARED;
+    bool exists = pending->last_change != CHANGE_GONE;
+    if (!existed && !exists) return 0;
+    if (!existed) return pending->moved_in ? DOWEL_FILE_EVENT_MOVED : DOWEL_FILE_EVENT_CREATED;
+    if (!exists) return pending->moved_out ? DOWEL_FILE_EVENT_MOVED : DOWEL_FILE_EVENT_DELETED;
+    return DOWEL_FILE_EVENT_MODIFIED;
+}
+
+// Takes ownership of path
+static void add_due(dowel_file_watcher_t* watcher, char* path, int kind) {
+    if (!(watcher->events & kind)) {
+        free(path);
+        return;
+    }
+    if (watcher->due_count == watcher->due_capacity) {
+        size_t capacity = watcher->due_capacity ? watcher->due_capacity * 2 : 64;
+        dowel_file_event_record_t* grown = realloc(watcher->due, capacity * sizeof(*grown));
+        if (!grown) {
+            free(path);
+            return;
+        }
+        watcher->due = grown;
+        watcher->due_capacity = capacity;
+    }
+    watcher->due[watcher->due_count].path = path;
+    watcher->due[watcher->due_count].event = (dowel_file_event_t)kind;
+    watcher->due_count++;
+}
+
+static void grow_pending(dowel_file_watcher_t* watcher) {
+    size_t buckets = watcher->buckets ? (watcher->bucket_mask + 1) * 2 : 64;
+    pending_t** table = calloc(buckets, sizeof(*table));
+    if (!table) return;
+    for (pending_t* p = watcher->head; p; p = p->next) {
+        p->chain = table[p->hash & (buckets - 1)];
+        table[p->hash & (buckets - 1)] = p;
+    }
+    free(watcher->buckets);
+    watcher->buckets = table;
+    watcher->bucket_mask = buckets - 1;
+}
+
+static pending_t* find_pending(const dowel_file_watcher_t* watcher, const char* path, uint64_t hash) {
+    if (!watcher->buckets) return NULL;
+    for (pending_t* pending = watcher->buckets[hash & watcher->bucket_mask]; pending; pending = pending->chain) {
+        if (pending->hash == hash && strcmp(pending->path, path) == 0) return pending;
+    }
+    return NULL;
+}
+
+static void record_event(dowel_file_watcher_t* watcher, const char* path, dowel_file_event_t kind, uint8_t change,
+                         int64_t now) {
+    if (watcher->window_ns <= 0) {
+        // A write is MODIFY then CLOSE_WRITE; report it once
+        const dowel_file_event_record_t* last = watcher->due_count ? &watcher->due[watcher->due_count - 1] : NULL;
+        if (last && last->event == kind && strcmp(last->path, path) == 0) return;
+        char* copy = strdup(path);
+        if (copy) add_due(watcher, copy, kind);
+        return;
+    }
+
+    uint64_t hash = hash_path(path);
+    pending_t* pending = find_pending(watcher, path, hash);
+    if (!pending) {
+        if (!watcher->buckets || watcher->pending_count > watcher->bucket_mask) grow_pending(watcher);
+        size_t length = strlen(path);
+        pending = watcher->buckets ? malloc(sizeof(*pending) + length + 1) : NULL;
+        if (!pending) return;
+        pending->hash = hash;
+        pending->deadline = now + watcher->window_ns;
+        pending->first_change = change;
+        pending->moved_in = change == CHANGE_APPEARED && kind == DOWEL_FILE_EVENT_MOVED;
+        memcpy(pending->path, path, length + 1);
+        pending->chain = watcher->buckets[hash & watcher->bucket_mask];
+        watcher->buckets[hash & watcher->bucket_mask] = pending;
+        pending->next = NULL;
+        if (watcher->tail) watcher->tail->next = pending; else watcher->head = pending;
+        watcher->tail = pending;
+        watcher->pending_count++;
+    }
+    pending->last_change = change;
+    pending->moved_out = change == CHANGE_GONE && kind == DOWEL_FILE_EVENT_MOVED;
+}
+
+// Moves pending events whose window has closed (all of them if now is
+// INT64_MAX) to the due list
+static void flush_pending(dowel_file_watcher_t* watcher, int64_t now) {
+    while (watcher->head && watcher->head->deadline <= now) {
+        pending_t* pending = watcher->head;
+        watcher->head = pending->next;
+        if (!watcher->head) watcher->tail = NULL;
+        for (pending_t** link = &watcher->buckets[pending->hash & watcher->bucket_mask]; *link; link = &(*link)->chain) {
+            if (*link == pending) {
+                *link = pending->chain;
+                break;
+            }
+        }
+        watcher->pending_count--;
+
+        int kind = net_event(pending);
+        char* path = kind ? strdup(pending->path) : NULL;
+        if (path) add_due(watcher, path, kind);
+        free(pending);
+    }
+}
+
+static void drop_due(dowel_file_event_record_t* records, size_t count) {
+    for (size_t i = 0; i < count; i++) free((char*)records[i].path);
+    free(records);
+}
+
+static void clear_events(dowel_file_watcher_t* watcher) {
+    while (watcher->head) {
+        pending_t* next = watcher->head->next;
+        free(watcher->head);
+        watcher->head = next;
+    }
+    watcher->tail = NULL;
+    watcher->pending_count = 0;
+    if (watcher->buckets) memset(watcher->buckets, 0, (watcher->bucket_mask + 1) * sizeof(*watcher->buckets));
+    drop_due(watcher->due, watcher->due_count);
+    watcher->due = NULL;
+    watcher->due_count = watcher->due_capacity = 0;
+}
+
+// Watches; callers hold the service lock
+
+static bool add_watch(dowel_file_watcher_t* watcher, const char* path, uint32_t extra_mask) {
+    int wd = inotify_add_watch(service.inotify_fd, path, WATCH_MASK | extra_mask);
+    if (wd < 0) return false;
+
+    if ((size_t)wd >= service.watch_capacity) {
+        size_t capacity = service.watch_capacity ? service.watch_capacity : 64;
+        while (capacity <= (size_t)wd) capacity *= 2;
+        watch_t* grown = realloc(service.watches, capacity * sizeof(*grown));
+        if (!grown) return false;
+        memset(grown + service.watch_capacity, 0, (capacity - service.watch_capacity) * sizeof(*grown));
+        service.watches = grown;
+        service.watch_capacity = capacity;
+    }
+    watch_t* watch = &service.watches[wd];
+    if (!watch->path || strcmp(watch->path, path) != 0) {
+        // A new watch, or a directory that was moved and re-added
+        char* copy = strdup(path);
+        if (!copy) return false;
+        free(watch->path);
+        watch->path = copy;
+    }
+    for (size_t i = 0; i < watch->count; i++) {
+        if (watch->watchers[i] == watcher) return true;
+    }
+
+    if (watch->count == watch->capacity) {
+        size_t capacity = watch->capacity ? watch->capacity * 2 : 2;
+        dowel_file_watcher_t** grown = realloc(watch->watchers, capacity * sizeof(*grown));
+        if (!grown) return false;
+        watch->watchers = grown;
+        watch->capacity = capacity;
+    }
+    if (watcher->wd_count == watcher->wd_capacity) {
+        size_t capacity = watcher->wd_capacity ? watcher->wd_capacity * 2 : 8;
+        int* grown = realloc(watcher->wds, capacity * sizeof(*grown));
+        if (!grown) return false;
+        watcher->wds = grown;
+        watcher->wd_capacity = capacity;
+    }
+    watch->watchers[watch->count++] = watcher;
+    watcher->wds[watcher->wd_count++] = wd;
+    return true;
+}
+
+// Forgets a descriptor the kernel has dropped
+static void forget_watch(int wd) {
+    watch_t* watch = &service.watches[wd];
+    for (size_t i = 0; i < watch->count; i++) {
+        dowel_file_watcher_t* watcher = watch->watchers[i];
+        for (size_t j = 0; j < watcher->wd_count; j++) {
+            if (watcher->wds[j] == wd) {
+                watcher->wds[j] = watcher->wds[--watcher->wd_count];
+                break;
+            }
+        }
+    }
+    free(watch->path);
+    free(watch->watchers);
+    memset(watch, 0, sizeof(*watch));
+}
+
+static void remove_watches(dowel_file_watcher_t* watcher) {
+    for (size_t i = 0; i < watcher->wd_count; i++) {
+        int wd = watcher->wds[i];
+        watch_t* watch = &service.watches[wd];
+        for (size_t j = 0; j < watch->count; j++) {
+            if (watch->watchers[j] == watcher) {
+                watch->watchers[j] = watch->watchers[--watch->count];
+                break;
+            }
+        }
+        if (watch->count == 0) {
+            inotify_rm_watch(service.inotify_fd, wd);
+            free(watch->path);
+            free(watch->watchers);
+            memset(watch, 0, sizeof(*watch));
+        }
+    }
+    watcher->wd_count = 0;
+}
+
+// Watches dir and every directory below it. With report set, entries found
+// are recorded as created: they appeared before their directory's watch.
+static void add_tree(dowel_file_watcher_t* watcher, const char* dir, bool report, int64_t now) {
+    if (!add_watch(watcher, dir, IN_ONLYDIR | IN_DONT_FOLLOW)) return;
+    DIR* listing = opendir(dir);
+    if (!listing) return;
+    struct dirent* entry;
+    while ((entry = readdir(listing)) != NULL) {
+        const char* name = entry->d_name;
+        if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) continue;
+        char* path = join_path(dir, name);
+        if (!path) continue;
+        if (report) record_event(watcher, path, DOWEL_FILE_EVENT_CREATED, CHANGE_APPEARED, now);
+        bool is_directory = entry->d_type == DT_DIR;
+        if (entry->d_type == DT_UNKNOWN) {
+            struct stat st;
+            is_directory = lstat(path, &st) == 0 && S_ISDIR(st.st_mode);
+        }
+        if (is_directory) add_tree(watcher, path, report, now);
+        free(path);
+    }
+    closedir(listing);
+}
+
+// Service thread
+
+static void handle_event(const struct inotify_event* event, int64_t now) {
+    if (event->mask & IN_Q_OVERFLOW) {
+        for (dowel_file_watcher_t* w = service.watchers; w; w = w->next) {
+            if (w->running) record_event(w, w->path, DOWEL_FILE_EVENT_MODIFIED, CHANGE_CHANGED, now);
+        }
+        return;
+    }
+    if (event->wd < 0 || (size_t)event->wd >= service.watch_capacity || !service.watches[event->wd].path) return;
+    if (event->mask & IN_IGNORED) {
+        forget_watch(event->wd);
+        return;
+    }
+
+    watch_t* watch = &service.watches[event->wd];
+    char* path = event->len > 0 ? join_path(watch->path, event->name) : strdup(watch->path);
+    if (!path) return;
+
+    dowel_file_event_t kind;
+    uint8_t change;
+    classify(event->mask, &kind, &change);
+    bool new_directory = (event->mask & IN_ISDIR) && (event->mask & (IN_CREATE | IN_MOVED_TO));
+
+    // add_tree can grow service.watches, so walk a copy of the watcher list
+    size_t count = watch->count;
+    dowel_file_watcher_t* stack_watchers[8];
+    dowel_file_watcher_t** watchers = count <= 8 ? stack_watchers : malloc(count * sizeof(*watchers));
+    if (watchers) memcpy(watchers, watch->watchers, count * sizeof(*watchers));
+    for (size_t i = 0; watchers && i < count; i++) {
+        dowel_file_watcher_t* watcher = watchers[i];
+        if (!watcher->running) continue;
+        // A directory's own deletion or move is reported by its parent,
+        // except for the watcher's root
+        if (event->len == 0 && strcmp(path, watcher->path) != 0) continue;
+        if (watcher->window_ns > 0 && event->cookie != 0) {
+            if (event->mask & IN_MOVED_FROM) {
+                pending_t* source = find_pending(watcher, path, hash_path(path));
+                watcher->save_cookie = source && source->first_change == CHANGE_APPEARED ? event->cookie : 0;
+            } else if ((event->mask & IN_MOVED_TO) && event->cookie == watcher->save_cookie) {
+                watcher->save_cookie = 0;
+                record_event(watcher, path, DOWEL_FILE_EVENT_MODIFIED, CHANGE_CHANGED, now);
+                continue;
+            }
+        }
+        record_event(watcher, path, kind, change, now);
+        if (new_directory && watcher->recursive) add_tree(watcher, path, true, now);
+    }
+    if (watchers != stack_watchers) free(watchers);
+    free(path);
+}
+
+typedef struct {
+    dowel_file_watcher_t* watcher;
+    dowel_file_event_record_t* records;
+    size_t count;
+} delivery_t;
+
+#define MAX_READ_PAUSE_NS 2000000
+
+// Earliest window to close. Sets pause to how long the thread may leave
+// events queued in the kernel between reads: when every running watcher
+// coalesces, a short pause turns a wakeup per event into one per burst.
+static int64_t next_deadline(int64_t* pause) {
+    int64_t deadline = INT64_MAX;
+    *pause = MAX_READ_PAUSE_NS;
+    for (dowel_file_watcher_t* w = service.watchers; w; w = w->next) {
+        if (!w->running) continue;
+        if (w->head && w->head->deadline < deadline) deadline = w->head->deadline;
+        if (w->window_ns / 8 < *pause) *pause = w->window_ns / 8;
+    }
+    return deadline;
+}
+
+static void* service_thread(void* arg) {
+    (void)arg;
+    char* buffer = aligned_alloc(__alignof__(struct inotify_event), READ_BUFFER_SIZE);
+    delivery_t* deliveries = NULL;
+    size_t delivery_capacity = 0;
+
+    bool readable = false;
+    pthread_mutex_lock(&service.lock);
+    while (buffer && !service.stopping) {
+        int64_t pause;
+        int64_t deadline = next_deadline(&pause);
+        pthread_mutex_unlock(&service.lock);
+
+        if (readable && pause > 0) {
+            struct timespec delay = { 0, (long)pause };
+            nanosleep(&delay, NULL);
+        }
+        int timeout = -1;
+        if (deadline != INT64_MAX) {
+            int64_t wait_ns = deadline - dcore_now_ns();
+            timeout = wait_ns <= 0 ? 0 : (int)((wait_ns + 999999) / 1000000);
+        }
+        struct epoll_event ready[2];
+        int n = epoll_wait(service.epoll_fd, ready, 2, timeout);
+        readable = false;
+        for (int i = 0; i < n; i++) {
+            if (ready[i].data.fd == service.wake_fd) {
+                uint64_t value;
+                ssize_t drained = read(service.wake_fd, &value, sizeof(value));
+                (void)drained;
+            } else {
+                readable = true;
+            }
+        }
+
+        pthread_mutex_lock(&service.lock);
+        if (service.stopping) break;
+        int64_t now = dcore_now_ns();
+        while (readable) {
+            ssize_t len = read(service.inotify_fd, buffer, READ_BUFFER_SIZE);
+            if (len <= 0) break;
+            for (char* p = buffer; p < buffer + len;) {
+                const struct inotify_event* event = (const struct inotify_event*)p;
+                handle_event(event, now);
+                p += sizeof(struct inotify_event) + event->len;
+            }
+        }
+
+        // Take every watcher's due events, then deliver outside the lock
+        size_t delivery_count = 0;
+        for (dowel_file_watcher_t* w = service.watchers; w; w = w->next) {
+            if (!w->running) continue;
+            // Once the oldest window closes, windows closing soon after go with it
+            if (w->head && w->head->deadline <= now) flush_pending(w, now + w->window_ns / 8);
+            if (w->due_count == 0) continue;
+            if (delivery_count == delivery_capacity) {
+                size_t capacity = delivery_capacity ? delivery_capacity * 2 : 8;
+                delivery_t* grown = realloc(deliveries, capacity * sizeof(*grown));
+                if (!grown) break;
+                deliveries = grown;
+                delivery_capacity = capacity;
+            }
+            deliveries[delivery_count++] = (delivery_t){ w, w->due, w->due_count };
+            w->due = NULL;
+            w->due_count = w->due_capacity = 0;
+        }
+        if (delivery_count == 0) continue;
+        service.dispatching = true;
+
+        for (size_t i = 0; i < delivery_count; i++) {
+            delivery_t* d = &deliveries[i];
+            // A callback earlier in the round may have stopped this watcher
+            bool running = d->watcher->running;
+            pthread_mutex_unlock(&service.lock);
+            if (running && d->watcher->batch_callback) {
+                d->watcher->batch_callback(d->records, d->count, d->watcher->user_data);
+            } else if (running) {
+                for (size_t j = 0; j < d->count; j++) {
+                    d->watcher->callback(d->records[j].path, d->records[j].event, d->watcher->user_data);
+                }
+            }
+            drop_due(d->records, d->count);
+            pthread_mutex_lock(&service.lock);
+        }
+
+        service.dispatching = false;
+        while (service.zombies) {
+            dowel_file_watcher_t* next = service.zombies->next;
+            free(service.zombies);
+            service.zombies = next;
+        }
+        pthread_cond_broadcast(&service.round_done);
+    }
+    pthread_mutex_unlock(&service.lock);
+    free(deliveries);
+    free(buffer);
+    return NULL;
+}
+
+// Sets up the shared inotify fd and starts the service thread if needed
+static bool ensure_service(void) {
+    if (service.thread_running) return true;
+    if (service.inotify_fd < 0) {
+        service.inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        service.epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        service.wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (service.inotify_fd < 0 || service.epoll_fd < 0 || service.wake_fd < 0) goto fail;
+        struct epoll_event in = { .events = EPOLLIN, .data.fd = service.inotify_fd };
+        struct epoll_event wake = { .events = EPOLLIN, .data.fd = service.wake_fd };
+        if (epoll_ctl(service.epoll_fd, EPOLL_CTL_ADD, service.inotify_fd, &in) != 0 ||
+            epoll_ctl(service.epoll_fd, EPOLL_CTL_ADD, service.wake_fd, &wake) != 0) {
+            goto fail;
+        }
+    }
+    service.stopping = false;
+    if (pthread_create(&service.thread, NULL, service_thread, NULL) != 0) goto fail;
+    service.thread_running = true;
+    return true;
+
+fail:
+    if (service.inotify_fd >= 0) close(service.inotify_fd);
+    if (service.epoll_fd >= 0) close(service.epoll_fd);
+    if (service.wake_fd >= 0) close(service.wake_fd);
+    service.inotify_fd = service.epoll_fd = service.wake_fd = -1;
+    return false;
+}
+
+// Public API
+
+dowel_file_watcher_t* dowel_file_watcher_create(const char* path, int events, dowel_file_event_callback_t callback, void* user_data) {
+    return dowel_file_watcher_create_with(path, events, NULL, callback, user_data);
+}
+
+dowel_file_watcher_t* dowel_file_watcher_create_with(const char* path, int events,
+                                                     const dowel_file_watcher_options_t* options,
+                                                     dowel_file_event_callback_t callback, void* user_data) {
+    dowel_file_batch_callback_t batch_callback = options ? options->batch_callback : NULL;
+    if (!path || (!callback && !batch_callback) || events == 0) return NULL;
+
+    dowel_file_watcher_t* watcher = calloc(1, sizeof(*watcher));
+    if (!watcher) return NULL;
+    watcher->path = strdup(path);
+    watcher->events = events;
+    watcher->callback = callback;
+    watcher->batch_callback = batch_callback;
+    watcher->user_data = user_data;
+    if (options) {
+        watcher->recursive = options->recursive;
+        watcher->window_ns = (int64_t)options->coalesce_ms * 1000000;
+    }
+    if (!watcher->path) {
+        free(watcher);
+        return NULL;
+    }
+
+    pthread_mutex_lock(&service.lock);
+    bool ok = ensure_service();
+    if (ok) {
+        struct stat st;
+        bool is_directory = stat(path, &st) == 0 && S_ISDIR(st.st_mode);
+        if (watcher->recursive && is_directory) {
+            add_tree(watcher, path, false, 0);
+            ok = watcher->wd_count > 0;
+        } else {
+            ok = add_watch(watcher, path, 0);
+        }
+    }
+    if (ok) {
+        watcher->next = service.watchers;
+        service.watchers = watcher;
+    } else {
+        remove_watches(watcher);
+    }
+    pthread_mutex_unlock(&service.lock);
+
+    if (!ok) {
+        dcore_report_error(DOWEL_ERROR_SYSTEM_ERROR, "Failed to create file watcher");
+        free(watcher->wds);
+        free(watcher->path);
+        free(watcher);
+        return NULL;
+    }
+    return watcher;
+}
+
+void dowel_file_watcher_start(dowel_file_watcher_t* watcher) {
+    if (!watcher) return;
+    pthread_mutex_lock(&service.lock);
+    watcher->running = true;
+    pthread_mutex_unlock(&service.lock);
+}
+
+void dowel_file_watcher_stop(dowel_file_watcher_t* watcher) {
+    if (!watcher) return;
+    pthread_mutex_lock(&service.lock);
+    watcher->running = false;
+    clear_events(watcher);
+    // After stop returns, no callback for this watcher is running (unless
+    // stop was called from one)
+    while (service.dispatching && !on_service_thread()) pthread_cond_wait(&service.round_done, &service.lock);
+    pthread_mutex_unlock(&service.lock);
+}
+
+void dowel_file_watcher_destroy(dowel_file_watcher_t* watcher) {
+    if (!watcher) return;
+    dowel_file_watcher_stop(watcher);
+
+    pthread_mutex_lock(&service.lock);
+    remove_watches(watcher);
+    for (dowel_file_watcher_t** link = &service.watchers; *link; link = &(*link)->next) {
+        if (*link == watcher) {
+            *link = watcher->next;
+            break;
+        }
+    }
+    free(watcher->wds);
+    free(watcher->buckets);
+    free(watcher->path);
+    watcher->path = NULL;
+
+    bool in_callback = on_service_thread();
+    if (in_callback) {
+        // The service thread may still look at it this round
+        watcher->next = service.zombies;
+        service.zombies = watcher;
+    } else {
+        free(watcher);
+    }
+
+    // The last watcher gone stops the thread, unless it is the caller
+    bool join = !service.watchers && service.thread_running && !in_callback;
+    if (join) {
+        service.stopping = true;
+        wake_service();
+    }
+    pthread_mutex_unlock(&service.lock);
+
+    if (join) {
+        pthread_join(service.thread, NULL);
+        pthread_mutex_lock(&service.lock);
+        service.thread_running = false;
+        // Watchers created meanwhile need the thread back
+        if (service.watchers) ensure_service();
+        pthread_mutex_unlock(&service.lock);
+    }
+}
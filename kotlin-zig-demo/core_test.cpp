@@ -0,0 +1,2207 @@
+#include <iostream>
+#include <algorithm>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <thread>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cwchar>
+#include <fcntl.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#include "dowel_steek_core.hpp"
+#include "dowel_steek_coro.hpp"
+#include "core/core_internal.h" // crash injection
+#include "core/log_pipeline.h"
+
+// Tests for the C core (core/*.c) through the full dowel_steek_core.h API
+// and the header-only C++ SDK.
+
+class TestSuite {
+private:
+    int tests_run = 0;
+    int tests_passed = 0;
+    int tests_failed = 0;
+    std::vector<std::string> failures;
+
+public:
+    void assert_test(bool condition, const std::string& test_name, const std::string& error_msg = "") {
+        tests_run++;
+        if (condition) {
+            tests_passed++;
+            std::cout << "✅ " << test_name << "\n";
+        } else {
+            tests_failed++;
+            failures.push_back(test_name + ": " + error_msg);
+            std::cout << "❌ " << test_name << " - " << error_msg << "\n";
+        }
+    }
+
+    void print_summary() {
+        std::cout << "\n" << std::string(60, '=') << "\n";
+        std::cout << "🧪 TEST SUMMARY\n";
+        std::cout << std::string(60, '=') << "\n";
+        std::cout << "Total tests: " << tests_run << "\n";
+        std::cout << "Passed: " << tests_passed << " ✅\n";
+        std::cout << "Failed: " << tests_failed << " ❌\n";
+
+        if (tests_failed > 0) {
+            std::cout << "\nFailed tests:\n";
+            for (const auto& failure : failures) {
+                std::cout << "  • " << failure << "\n";
+            }
+        }
+        std::cout << std::string(60, '=') << "\n";
+    }
+
+    bool all_passed() const {
+        return tests_failed == 0;
+    }
+};
+
+static std::string make_temp_dir() {
+    char path[] = "/tmp/dowel-core-test-XXXXXX";
+    return mkdtemp(path) ? std::string(path) : std::string("/tmp");
+}
+
+static std::string to_hex(dowel::bytes_view bytes) {
+    static const char digits[] = "0123456789abcdef";
+    std::string out;
+    for (auto b : bytes) {
+        out += digits[b >> 4];
+        out += digits[b & 0xf];
+    }
+    return out;
+}
+
+void test_sdk_handles(TestSuite& suite) {
+    std::cout << "\n🧩 Testing C++ SDK Handles\n";
+    std::cout << "---------------------------\n";
+
+    auto digest = dowel::sha256(dowel::as_bytes("abc"));
+    suite.assert_test(to_hex(digest.bytes()) == "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad",
+        "SHA-256 known answer", "Got " + to_hex(digest.bytes()));
+
+    const uint8_t* raw = digest.data();
+    dowel::buffer moved = std::move(digest);
+    suite.assert_test(!digest && moved && moved.data() == raw, "Buffer move transfers ownership",
+        "Moved-from buffer should be empty and the data pointer unchanged");
+
+    auto key = dowel::crypto_key::generate();
+    suite.assert_test(key && key.bytes().size() == 32, "Key generation", "Expected a 32 byte key");
+
+    std::string message = "Dowel-Steek vault entry";
+    auto sealed = key.encrypt(dowel::as_bytes(message));
+    auto opened = key.decrypt(sealed.bytes());
+    suite.assert_test(opened && opened.str() == message, "Encrypt/decrypt roundtrip", "Plaintext mismatch");
+
+    sealed.mutable_bytes()[sealed.size() / 2] ^= 0x01;
+    suite.assert_test(!key.decrypt(sealed.bytes()), "Tampered ciphertext rejected", "Decrypt should fail");
+
+    std::string text(4096, 'a');
+    auto packed = dowel::compress_gzip(dowel::as_bytes(text));
+    auto unpacked = dowel::decompress_gzip(packed.bytes());
+    suite.assert_test(packed.size() < text.size() && unpacked.str() == text, "Gzip roundtrip",
+        "Compressed " + std::to_string(packed.size()) + " bytes");
+
+    auto doc = dowel::json_document::parse(R"({"title":"Notes","count":3,"ratio":0.5,"ok":true,"nested":{"name":"xé"}})");
+    suite.assert_test(doc && doc["title"].as_string() == "Notes", "JSON string lookup", "Wrong title");
+    suite.assert_test(doc["count"].as_int() == 3 && doc["ratio"].as_float() == 0.5 && doc["ok"].as_bool(),
+        "JSON scalar lookup", "Wrong scalar values");
+    suite.assert_test(doc["nested"]["name"].as_string() == "x\xc3\xa9", "JSON nested lookup", "Wrong nested value");
+    suite.assert_test(!doc["missing"]["deeper"], "JSON missing key", "Missing keys should give an empty ref");
+
+    auto reparsed = dowel::json_document::parse(doc.stringify().data());
+    suite.assert_test(reparsed && reparsed["nested"]["name"].as_string() == "x\xc3\xa9", "JSON stringify roundtrip",
+        std::string(doc.stringify()));
+    suite.assert_test(!dowel::json_document::parse("{\"a\":}"), "JSON rejects malformed input", "Parse should fail");
+
+    std::atomic<int> counter{0};
+    auto increment = [&] { counter.fetch_add(1); };
+    {
+        auto task = dowel::task::spawn(increment);
+        task.wait();
+        suite.assert_test(task.is_complete() && counter.load() == 1, "Task spawn/wait", "Callback did not run");
+    }
+
+    std::string dir = make_temp_dir();
+    std::string file = dir + "/note.txt";
+    suite.assert_test(dowel::storage::write_file(file, dowel::as_bytes(message)) == DOWEL_SUCCESS,
+        "Storage write", "Write failed");
+    auto contents = dowel::storage::read_file(file);
+    suite.assert_test(contents.str() == message, "Storage read", "Read mismatch");
+    auto listing = dowel::storage::list_directory(dir);
+    suite.assert_test(listing.size() == 1 && listing[0] == "note.txt", "Storage list", "Unexpected listing");
+
+    std::atomic<int> events{0};
+    auto on_event = [&](std::string_view, dowel_file_event_t) { events.fetch_add(1); };
+    auto watcher = dowel::file_watcher::create(dir, DOWEL_FILE_EVENT_CREATED, on_event);
+    watcher.start();
+    dowel::storage::write_file(dir + "/created.txt", dowel::as_bytes(message));
+    for (int i = 0; i < 50 && events.load() == 0; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    watcher.stop();
+    suite.assert_test(events.load() >= 1, "File watcher create event", "No event delivered");
+
+    dowel::storage::delete_file(file);
+    dowel::storage::delete_file(dir + "/created.txt");
+    rmdir(dir.c_str());
+}
+
+void test_config_store(TestSuite& suite) {
+    std::cout << "\n⚙️ Testing Configuration Store\n";
+    std::cout << "--------------------------------\n";
+
+    suite.assert_test(dowel_config_set_string("ui.theme", "dark") == DOWEL_SUCCESS &&
+        dowel_config_set_int("ui.font_size", 14) == DOWEL_SUCCESS &&
+        dowel_config_set_bool("power.saver", true) == DOWEL_SUCCESS &&
+        dowel_config_set_float("display.scale", 1.5) == DOWEL_SUCCESS, "Config typed set", "A setter failed");
+
+    suite.assert_test(std::string(dowel_config_get_string("ui.theme", "light")) == "dark" &&
+        dowel_config_get_int("ui.font_size", 0) == 14 &&
+        dowel_config_get_bool("power.saver", false) &&
+        dowel_config_get_float("display.scale", 0.0) == 1.5, "Config typed get", "A getter returned the wrong value");
+
+    suite.assert_test(std::string(dowel_config_get_string("ui.missing", "fallback")) == "fallback" &&
+        std::string(dowel_config_get_string("ui.font_size", "fallback")) == "fallback",
+        "Config defaults for missing or mistyped keys", "Expected the default value");
+    suite.assert_test(dowel_config_get_float("ui.font_size", 0.0) == 14.0 && dowel_config_get_int("display.scale", 0) == 1,
+        "Config numeric conversion", "Numeric types should convert");
+
+    // Keys are independent (the old wrapper overwrote one shared buffer)
+    dowel_config_set_string("service.Display Manager", "active");
+    dowel_config_set_string("service.Audio System", "inactive");
+    suite.assert_test(std::string(dowel_config_get_string("service.Display Manager", "")) == "active" &&
+        std::string(dowel_config_get_string("service.Audio System", "")) == "inactive",
+        "Config keys are independent", "Keys overwrote each other");
+
+    // Interned values: a pointer read earlier stays valid after the key changes
+    const char* before = dowel_config_get_string("ui.theme", "");
+    dowel_config_set_string("ui.theme", "light");
+    dowel_config_set_string("ui.theme", "dark");
+    suite.assert_test(std::string(before) == "dark" && dowel_config_get_string("ui.theme", "") == before,
+        "Config string values are interned", "Expected the same interned pointer");
+
+    bool all_found = true;
+    for (int i = 0; i < 5000; i++) {
+        dowel_config_set_int(("bulk.key." + std::to_string(i)).c_str(), i);
+    }
+    for (int i = 0; i < 5000; i++) {
+        all_found &= dowel_config_get_int(("bulk.key." + std::to_string(i)).c_str(), -1) == i;
+    }
+    suite.assert_test(all_found, "Config table growth", "Lost keys while growing the table");
+
+    std::atomic<bool> stop{false};
+    std::atomic<int> torn{0};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; t++) {
+        readers.emplace_back([&] {
+            while (!stop.load(std::memory_order_relaxed)) {
+                std::string_view v = dowel_config_get_string("race.value", "unset");
+                if (v != "unset" && v != "alpha" && v != "beta") torn.fetch_add(1);
+                int64_t n = dowel_config_get_int("race.counter", 0);
+                if (n < 0) torn.fetch_add(1);
+            }
+        });
+    }
+    for (int i = 0; i < 20000; i++) {
+        dowel_config_set_string("race.value", (i & 1) ? "alpha" : "beta");
+        dowel_config_set_int("race.counter", i);
+        dowel_config_set_string(("race.new." + std::to_string(i)).c_str(), "x");
+    }
+    stop.store(true);
+    for (auto& reader : readers) reader.join();
+    suite.assert_test(torn.load() == 0, "Config concurrent readers see consistent values",
+        std::to_string(torn.load()) + " torn reads");
+}
+
+void test_config_handles(TestSuite& suite) {
+    std::cout << "\n🔑 Testing Configuration Key Handles\n";
+    std::cout << "--------------------------------------\n";
+
+    // Handles can be taken before the key is ever set
+    auto timeout = dowel::config_key::resolve("net.timeout_ms");
+    suite.assert_test(timeout && timeout.get_int(250) == 250 && timeout.generation() == 0,
+        "Config handle before first set", "Unset key should read as the default");
+
+    dowel_config_set_int("net.timeout_ms", 1000);
+    suite.assert_test(timeout.get_int(250) == 1000 && timeout.get_float(0.0) == 1000.0,
+        "Config handle sees path writes", "Handle and path disagree");
+    suite.assert_test(dowel::config_key::resolve("net.timeout_ms").get() == timeout.get(),
+        "Config resolve is stable", "Same path resolved to different handles");
+
+    std::uint32_t seen = timeout.generation();
+    suite.assert_test(!timeout.changed_since(seen) && timeout.set(2000) == DOWEL_SUCCESS &&
+        timeout.changed_since(seen) && dowel_config_get_int("net.timeout_ms", 0) == 2000,
+        "Config handle write bumps generation", "Generation or value not updated");
+
+    auto name = dowel::config_key::resolve("net.host");
+    name.set("example.org");
+    suite.assert_test(name.get_string() == "example.org" && name.get_int(7) == 7,
+        "Config handle typed reads", "String handle read failed");
+
+    dowel::config_key invalid;
+    suite.assert_test(!invalid && invalid.get_int(42) == 42 && invalid.set(1) == DOWEL_ERROR_INVALID_PARAMETER &&
+        dowel_config_key_get_bool(12345678, true), "Config invalid handle", "Invalid handles should read as the default");
+}
+
+// Points stdout and stderr at a file while fn runs and returns what was written
+template <typename F>
+static std::string capture_output(const std::string& path, F&& fn) {
+    std::fflush(stdout);
+    int saved_out = dup(STDOUT_FILENO);
+    int saved_err = dup(STDERR_FILENO);
+    FILE* file = std::fopen(path.c_str(), "w+");
+    dup2(fileno(file), STDOUT_FILENO);
+    dup2(fileno(file), STDERR_FILENO);
+
+    fn();
+    dowel::log::flush();
+
+    dup2(saved_out, STDOUT_FILENO);
+    dup2(saved_err, STDERR_FILENO);
+    close(saved_out);
+    close(saved_err);
+
+    std::string text;
+    char chunk[4096];
+    std::rewind(file);
+    for (size_t n; (n = std::fread(chunk, 1, sizeof(chunk), file)) > 0;) text.append(chunk, n);
+    std::fclose(file);
+    return text;
+}
+
+static size_t count_lines(const std::string& text, const std::string& needle) {
+    size_t count = 0;
+    for (size_t pos = 0; (pos = text.find(needle, pos)) != std::string::npos; pos += needle.size()) count++;
+    return count;
+}
+
+void test_logging(TestSuite& suite) {
+    std::cout << "\n📝 Testing Logging Pipeline\n";
+    std::cout << "-----------------------------\n";
+
+    std::string dir = make_temp_dir();
+    auto before = dowel::log::metrics();
+
+    dowel::log::set_level(DOWEL_LOG_DEBUG);
+    std::string text = capture_output(dir + "/basic.log", [] {
+        dowel::log::trace("core", "filtered out");
+        dowel::log::debug("core", "debug line");
+        dowel::log::info("core", "hello");
+        dowel::log::error("storage", "disk full");
+    });
+    dowel::log::set_level(DOWEL_LOG_INFO);
+
+    suite.assert_test(text.find("[INFO] core: hello\n") != std::string::npos &&
+        text.find("[DEBUG] core: debug line\n") != std::string::npos &&
+        text.find("[ERROR] storage: disk full\n") != std::string::npos,
+        "Log line format", "Unexpected output: " + text);
+    suite.assert_test(text.find("filtered out") == std::string::npos, "Log level filter", "TRACE was written");
+
+    auto after = dowel::log::metrics();
+    suite.assert_test(after.entries_by_level[DOWEL_LOG_TRACE] == before.entries_by_level[DOWEL_LOG_TRACE] &&
+        after.entries_by_level[DOWEL_LOG_DEBUG] == before.entries_by_level[DOWEL_LOG_DEBUG] + 1 &&
+        after.entries_by_level[DOWEL_LOG_ERROR] == before.entries_by_level[DOWEL_LOG_ERROR] + 1 &&
+        after.total_entries == before.total_entries + 3, "Log metrics per level", "Level counters are off");
+
+    // Several threads logging at once: every entry is written once or counted as dropped
+    const int threads = 4;
+    const int per_thread = 20000;
+    before = dowel::log::metrics();
+    text = capture_output(dir + "/threads.log", [&] {
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; t++) {
+            workers.emplace_back([t] {
+                std::string module = "worker" + std::to_string(t);
+                for (int i = 0; i < per_thread; i++) dowel::log::info(module, "tick");
+            });
+        }
+        for (auto& worker : workers) worker.join();
+    });
+    after = dowel::log::metrics();
+
+    uint64_t accepted = after.total_entries - before.total_entries;
+    uint64_t dropped = after.dropped_entries - before.dropped_entries;
+    suite.assert_test(accepted + dropped == uint64_t(threads) * per_thread &&
+        count_lines(text, ": tick\n") == accepted, "Log entries written or counted as dropped",
+        std::to_string(accepted) + " accepted, " + std::to_string(dropped) + " dropped, " +
+        std::to_string(count_lines(text, ": tick\n")) + " written");
+    suite.assert_test(after.peak_memory_usage > 0 && after.peak_memory_usage <= size_t(threads + 2) * 80 * 1024,
+        "Log memory stays bounded", "Peak " + std::to_string(after.peak_memory_usage) + " bytes");
+    suite.assert_test(after.avg_write_time_ns > 0, "Log write time measured", "avg_write_time_ns is zero");
+
+    // An idle writer sleeps until the next entry instead of polling, and an
+    // INFO line still reaches the file without a flush
+    dcore_log_stats_t idle_before, idle_after;
+    dcore_log_get_stats(&idle_before);
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    dcore_log_get_stats(&idle_after);
+    bool slept = idle_after.writer_wakeups == idle_before.writer_wakeups;
+    std::string late_path = dir + "/late.log";
+    FILE* late = std::fopen(late_path.c_str(), "w+");
+    dcore_log_set_output(fileno(late), fileno(late));
+    dowel::log::info("core", "no flush");
+    bool arrived = false;
+    for (int i = 0; i < 200 && !arrived; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        arrived = std::filesystem::file_size(late_path) > 0;
+    }
+    dcore_log_set_output(-1, -1);
+    std::fclose(late);
+    suite.assert_test(slept && arrived, "Idle log writer sleeps until the next entry",
+        std::to_string(idle_after.writer_wakeups - idle_before.writer_wakeups) + " wakeups while idle");
+}
+
+static std::string run_command(const std::string& command) {
+    std::string output;
+    FILE* pipe = popen(command.c_str(), "r");
+    if (!pipe) return output;
+    char chunk[4096];
+    for (size_t n; (n = std::fread(chunk, 1, sizeof(chunk), pipe)) > 0;) output.append(chunk, n);
+    pclose(pipe);
+    return output;
+}
+
+static void write_raw(const std::string& path, std::string_view data) {
+    FILE* file = std::fopen(path.c_str(), "wb");
+    std::fwrite(data.data(), 1, data.size(), file);
+    std::fclose(file);
+}
+
+void test_structured_logging(TestSuite& suite) {
+    std::cout << "\n🧾 Testing Structured Logging\n";
+    std::cout << "-------------------------------\n";
+
+    std::string dir = make_temp_dir();
+
+    // No binary log open: formatted on the spot
+    std::string text = capture_output(dir + "/text.log", [] {
+        DOWEL_LOG_STRUCTURED(DOWEL_LOG_INFO, "services", "Starting service: %s (%d)", "Display Manager", 3);
+    });
+    suite.assert_test(text == "[INFO] services: Starting service: Display Manager (3)\n",
+        "Structured log text fallback", "Got: " + text);
+
+    std::string path = dir + "/app.blog";
+    suite.assert_test(dowel_log_binary_open(path.c_str()) == DOWEL_SUCCESS, "Binary log open", "Open failed");
+
+    text = capture_output(dir + "/mixed.log", [] {
+        for (int i = 0; i < 3; i++) {
+            DOWEL_LOG_STRUCTURED(DOWEL_LOG_INFO, "services", "Starting service: %s (%d)", "Audio System", i);
+        }
+        std::thread([] {
+            DOWEL_LOG_STRUCTURED(DOWEL_LOG_WARN, "power", "battery %.1f%% left, %zu apps, flags %#x, %lld ms",
+                                 42.5, size_t(7), 0x2au, -1234567890123LL);
+        }).join();
+        DOWEL_LOG_STRUCTURED(DOWEL_LOG_ERROR, "", "[%-6s|%5d] %c", "ui", -12, 'z');
+        DOWEL_LOG_STRUCTURED(DOWEL_LOG_DEBUG, "filtered", "below the level %d", 1);
+        // '*' widths cannot be deferred, so this one is written as text
+        DOWEL_LOG_STRUCTURED(DOWEL_LOG_INFO, "services", "%*d", 4, 7);
+        // Nor can a wint_t for %lc
+        DOWEL_LOG_STRUCTURED(DOWEL_LOG_INFO, "services", "%lc%c", wint_t(L'w'), 'c');
+    });
+    dowel_log_binary_close();
+
+    suite.assert_test(text == "[INFO] services:    7\n[INFO] services: wc\n", "Structured log non-deferrable format", "Got: " + text);
+
+    FILE* file = std::fopen(path.c_str(), "rb");
+    char magic[8] = {};
+    size_t magic_read = file ? std::fread(magic, 1, sizeof(magic), file) : 0;
+    if (file) std::fclose(file);
+    suite.assert_test(magic_read == 8 && std::memcmp(magic, "DOWELBL1", 8) == 0, "Binary log header", "Missing magic");
+
+    const char* decoder = std::getenv("DOWEL_LOG_DECODE");
+    if (!decoder) {
+        std::cout << "⚠️  DOWEL_LOG_DECODE not set, skipping decoder check\n";
+        return;
+    }
+    std::string decoded = run_command(std::string(decoder) + " -n " + path);
+    std::string expected =
+        "[INFO] services: Starting service: Audio System (0)\n"
+        "[INFO] services: Starting service: Audio System (1)\n"
+        "[INFO] services: Starting service: Audio System (2)\n";
+    suite.assert_test(decoded.find(expected) != std::string::npos &&
+        decoded.find("[WARN] power: battery 42.5% left, 7 apps, flags 0x2a, -1234567890123 ms\n") != std::string::npos &&
+        decoded.find("[ERROR] [ui    |  -12] z\n") != std::string::npos &&
+        decoded.find("filtered") == std::string::npos,
+        "Decoder output matches printf", "Got:\n" + decoded);
+
+    std::string stamped = run_command(std::string(decoder) + " " + path);
+    suite.assert_test(stamped.size() > decoded.size() && stamped.compare(4, 1, "-") == 0 &&
+        stamped.find("Z [INFO] services: Starting service") != std::string::npos,
+        "Decoder timestamps", "Got:\n" + stamped);
+
+    // A corrupt site id is reported, not grown into
+    std::string corrupt = dir + "/corrupt.blog";
+    write_raw(corrupt, std::string("DOWELBL1\x0f\x00\x01\x00\xf0\xff\xff\xff\x00\x01\x00m\x01\x00f", 23));
+    std::string status = run_command("timeout 5 " + std::string(decoder) + " -n " + corrupt + " >/dev/null 2>&1; echo $?");
+    suite.assert_test(status == "1\n", "Decoder rejects a corrupt site id", "Exit status " + status);
+}
+
+void test_allocator(TestSuite& suite) {
+    std::cout << "\n🧮 Testing Pooled Allocator\n";
+    std::cout << "-----------------------------\n";
+
+    std::vector<dowel_alloc_class_stats_t> before(dowel_alloc_get_stats(nullptr, 0));
+    dowel_alloc_get_stats(before.data(), before.size());
+    suite.assert_test(before.size() == 17 && before[0].block_size == 16 && before[15].block_size == 4096 &&
+        before[16].block_size == 0, "Allocator size classes", "Got " + std::to_string(before.size()) + " entries");
+
+    // Every size keeps its bytes and 16 byte alignment
+    const size_t sizes[] = {0, 1, 16, 17, 64, 65, 100, 255, 1000, 4096, 4097, 100000};
+    std::vector<unsigned char*> blocks;
+    bool intact = true;
+    for (size_t size : sizes) {
+        auto* block = static_cast<unsigned char*>(dowel_malloc(size));
+        intact = intact && block && reinterpret_cast<uintptr_t>(block) % 16 == 0;
+        if (block) std::memset(block, int(size & 0xff), size);
+        blocks.push_back(block);
+    }
+    for (size_t i = 0; i < blocks.size(); i++) {
+        for (size_t j = 0; blocks[i] && j < sizes[i]; j++) intact = intact && blocks[i][j] == (sizes[i] & 0xff);
+        dowel_free(blocks[i]);
+    }
+    suite.assert_test(intact, "Allocations keep size and alignment", "Block missing, misaligned or overwritten");
+
+    std::vector<dowel_alloc_class_stats_t> after(before.size());
+    dowel_alloc_get_stats(after.data(), after.size());
+    suite.assert_test(after[7].allocations - before[7].allocations == 1 &&   // 255 -> 256
+        after[16].allocations - before[16].allocations == 2 &&
+        after[16].live_blocks == before[16].live_blocks, "Per-class allocation stats", "Counts did not match");
+
+    // A freed block is handed out again, once
+    void* first = dowel_malloc(40);
+    dowel_free(first);
+    void* second = dowel_malloc(40);
+    void* third = dowel_malloc(40);
+    suite.assert_test(second == first && third != first, "Freed block reused once", "Block reuse order changed");
+    dowel_free(second);
+    dowel_free(third);
+
+    // Blocks freed on another thread go back to that thread's cache
+    std::vector<void*> handoff;
+    for (int i = 0; i < 1000; i++) handoff.push_back(dowel_malloc(24));
+    std::thread([&] {
+        for (void* block : handoff) dowel_free(block);
+    }).join();
+
+    std::atomic<bool> churn_ok{true};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&, t] {
+            std::vector<unsigned char*> live;
+            for (int i = 0; i < 20000; i++) {
+                size_t size = 8 + size_t((i * 37 + t * 11) % 500);
+                auto* block = static_cast<unsigned char*>(dowel_malloc(size));
+                if (!block) {
+                    churn_ok = false;
+                    return;
+                }
+                block[0] = static_cast<unsigned char>(t);
+                block[size - 1] = static_cast<unsigned char>(t);
+                live.push_back(block);
+                if (live.size() > 64) {
+                    unsigned char* old = live[size_t(i) % live.size()];
+                    if (old[0] != t) churn_ok = false;
+                    dowel_free(old);
+                    live[size_t(i) % live.size()] = live.back();
+                    live.pop_back();
+                }
+            }
+            for (auto* block : live) dowel_free(block);
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    dowel_alloc_get_stats(after.data(), after.size());
+    bool balanced = true;
+    for (size_t i = 0; i < after.size(); i++) balanced = balanced && after[i].live_blocks == before[i].live_blocks;
+    suite.assert_test(churn_ok && balanced, "Cross-thread churn balances", "Live block counts drifted");
+}
+
+void test_arena(TestSuite& suite) {
+    std::cout << "\n🧱 Testing Arenas\n";
+    std::cout << "------------------\n";
+
+    dowel::arena scratch(4096);
+    suite.assert_test(static_cast<bool>(scratch), "Arena create", "dowel_arena_create returned NULL");
+
+    bool aligned = true;
+    for (size_t size : {1, 7, 16, 33, 1000}) {
+        aligned = aligned && reinterpret_cast<uintptr_t>(scratch.alloc(size)) % 16 == 0;
+    }
+    void* big = scratch.alloc(100000);
+    if (big) std::memset(big, 0xab, 100000);
+    char* line = dowel_arena_format(scratch.get(), "frame %d: %s", 42, std::string(5000, 'x').c_str());
+    suite.assert_test(aligned && big && line && std::strncmp(line, "frame 42: xxx", 13) == 0 &&
+        std::strlen(line) == 5010, "Arena alloc and format", "Bad block or formatted line");
+
+    std::string dir = make_temp_dir();
+    std::string payload(20000, 'q');
+    dowel::storage::write_file(dir + "/a.txt", dowel::as_bytes(payload));
+    dowel::storage::write_file(dir + "/b.txt", dowel::as_bytes("b"));
+
+    auto file = dowel::storage::read_file(scratch, dir + "/a.txt");
+    auto names = dowel::storage::list_directory(scratch, dir);
+    auto digest = dowel::sha256(scratch, dowel::as_bytes("abc"));
+    auto packed = dowel::compress_gzip(scratch, file);
+    auto unpacked = dowel::decompress_gzip(scratch, packed);
+    auto key = dowel::crypto_key::generate();
+    auto sealed = key.encrypt(scratch, dowel::as_bytes("secret"));
+    auto opened = key.decrypt(scratch, sealed);
+    suite.assert_test(file.size() == payload.size() && names.size() == 2 &&
+        to_hex(digest) == "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad" &&
+        std::string_view(reinterpret_cast<const char*>(unpacked.data()), unpacked.size()) == payload &&
+        std::string_view(reinterpret_cast<const char*>(opened.data()), opened.size()) == "secret",
+        "Core results allocated in arena", "An arena variant returned the wrong data");
+
+    // Reset rewinds to the same memory instead of allocating more
+    scratch.reset();
+    void* first = scratch.alloc(64);
+    auto again = dowel::sha256(scratch, dowel::as_bytes("abc"));
+    suite.assert_test(scratch.used() < 256 && first && again.data() > static_cast<std::uint8_t*>(first) &&
+        again.data() < static_cast<std::uint8_t*>(first) + 256, "Arena reset reuses memory",
+        "used() = " + std::to_string(scratch.used()));
+
+    dowel::storage::delete_file(dir + "/a.txt");
+    dowel::storage::delete_file(dir + "/b.txt");
+    rmdir(dir.c_str());
+}
+
+struct fanout_job {
+    int depth;
+    std::atomic<int>* leaves;
+};
+
+// Splits into two child tasks until depth runs out, waiting on both
+static void fanout(void* data) {
+    auto* job = static_cast<fanout_job*>(data);
+    if (job->depth == 0) {
+        job->leaves->fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    fanout_job left{job->depth - 1, job->leaves};
+    fanout_job right{job->depth - 1, job->leaves};
+    dowel_task_t* a = dowel_async_spawn(fanout, &left);
+    dowel_task_t* b = dowel_async_spawn(fanout, &right);
+    dowel_async_free_task(a);
+    dowel_async_free_task(b);
+}
+
+void test_async(TestSuite& suite) {
+    std::cout << "\n🧵 Testing Work-Stealing Pool\n";
+    std::cout << "-------------------------------\n";
+
+    int workers = dowel::async::worker_count();
+    suite.assert_test(workers >= 2 && dowel::async::current_worker() == DOWEL_ASYNC_ANY_WORKER,
+        "Worker pool started", std::to_string(workers) + " workers");
+
+    std::atomic<int> counter{0};
+    auto increment = [&] { counter.fetch_add(1, std::memory_order_relaxed); };
+    std::vector<dowel::task> tasks;
+    for (int i = 0; i < 10000; i++) tasks.push_back(dowel::task::spawn(increment));
+    for (auto& task : tasks) task.wait();
+    suite.assert_test(counter.load() == 10000, "Tasks spawned from outside the pool",
+        "Ran " + std::to_string(counter.load()));
+    tasks.clear();
+
+    // Nested spawns go to the worker's own deque; waiting inside a task runs
+    // other tasks, so even deep trees finish on a few workers
+    std::atomic<int> leaves{0};
+    fanout_job root{12, &leaves};
+    dowel_async_free_task(dowel_async_spawn(fanout, &root));
+    suite.assert_test(leaves.load() == 4096, "Nested fan-out and fan-in", "Leaves: " + std::to_string(leaves.load()));
+
+    // Occupy every worker so the next task stays queued, then cancel it
+    std::atomic<int> blocked{0};
+    std::atomic<bool> release{false};
+    auto blocker = [&] {
+        blocked.fetch_add(1);
+        while (!release.load()) std::this_thread::yield();
+    };
+    for (int i = 0; i < workers; i++) tasks.push_back(dowel::task::spawn(blocker));
+    while (blocked.load() < workers) std::this_thread::yield();
+    std::atomic<bool> victim_ran{false};
+    auto victim = [&] { victim_ran = true; };
+    auto pending = dowel::task::spawn(victim);
+    pending.cancel();
+    bool cancelled_done = pending.is_complete();
+    release = true;
+    tasks.clear();
+    pending = dowel::task();
+    suite.assert_test(cancelled_done && !victim_ran.load(), "Cancel drops a pending task", "Cancelled task ran");
+
+    // A running task sees the request and stops early
+    std::atomic<bool> started{false};
+    std::atomic<bool> saw_cancel{false};
+    auto cooperative = [&] {
+        started = true;
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (std::chrono::steady_clock::now() < deadline) {
+            if (dowel::async::cancel_requested()) {
+                saw_cancel = true;
+                return;
+            }
+            std::this_thread::yield();
+        }
+    };
+    auto running = dowel::task::spawn(cooperative);
+    while (!started.load()) std::this_thread::yield();
+    running.cancel();
+    running.wait();
+    suite.assert_test(saw_cancel.load() && !dowel::async::cancel_requested(), "Cooperative cancellation",
+        "Running task did not observe the cancel request");
+
+    std::atomic<int> ran_on{-2};
+    auto where = [&] { ran_on = dowel::async::current_worker(); };
+    dowel::task::spawn_on(workers - 1, where).wait();
+    suite.assert_test(ran_on.load() >= 0 && ran_on.load() < workers, "Affinity hint runs on a worker",
+        "current_worker() = " + std::to_string(ran_on.load()));
+
+    // A burst submitted to sleeping workers wakes all of them, not just one;
+    // restarted with 8 workers so the burst is wider than the CPU count
+    dcore_async_shutdown();
+    dowel_config_set_int("async.worker_threads", 8);
+    auto nap = [] { std::this_thread::sleep_for(std::chrono::milliseconds(100)); };
+    auto warm_up = [] {};
+    dowel::task::spawn(warm_up).wait();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    auto burst_start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 8; i++) tasks.push_back(dowel::task::spawn(nap));
+    for (auto& task : tasks) task.wait();
+    tasks.clear();
+    auto burst_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - burst_start).count();
+    dcore_async_shutdown();
+    dowel_config_set_int("async.worker_threads", 0);
+    suite.assert_test(burst_ms < 180, "Burst wakes every idle worker", "8 blocking tasks took " + std::to_string(burst_ms) + " ms");
+}
+
+void test_async_graph(TestSuite& suite) {
+    std::cout << "\n🕸️  Testing Continuations and Task Graphs\n";
+    std::cout << "-----------------------------------------\n";
+
+    // then() runs strictly after its antecedent, even when the antecedent's
+    // handle is dropped first
+    std::atomic<int> step{0};
+    std::atomic<bool> ordered{false};
+    auto first = [&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        step = 1;
+    };
+    auto second = [&] { ordered = step.load() == 1; };
+    auto head = dowel::task::spawn(first);
+    auto tail = head.then(second);
+    head = dowel::task();
+    tail.wait();
+    suite.assert_test(ordered.load(), "then() runs after its antecedent", "Continuation ran early");
+
+    std::atomic<int> parts{0};
+    std::atomic<int> seen{-1};
+    auto part = [&] { parts.fetch_add(1); };
+    auto join = [&] { seen = parts.load(); };
+    std::vector<dowel::task> owned;
+    std::vector<dowel_task_t*> raw;
+    for (int i = 0; i < 64; i++) {
+        owned.push_back(dowel::task::spawn(part));
+        raw.push_back(owned.back().get());
+    }
+    dowel::task::when_all(raw, join).wait();
+    suite.assert_test(seen.load() == 64, "when_all waits for every input", "Saw " + std::to_string(seen.load()));
+    owned.clear();
+
+    // Cancelling a queued antecedent cancels the whole chain behind it
+    int workers = dowel::async::worker_count();
+    std::atomic<int> blocked{0};
+    std::atomic<bool> release{false};
+    auto blocker = [&] {
+        blocked.fetch_add(1);
+        while (!release.load()) std::this_thread::yield();
+    };
+    for (int i = 0; i < workers; i++) owned.push_back(dowel::task::spawn(blocker));
+    while (blocked.load() < workers) std::this_thread::yield();
+    std::atomic<int> chain_ran{0};
+    auto link = [&] { chain_ran.fetch_add(1); };
+    auto queued = dowel::task::spawn(link);
+    auto next = queued.then(link);
+    auto last = next.then(link);
+    queued.cancel();
+    release = true;
+    last.wait();
+    owned.clear();
+    auto late = last.then(link);
+    late.wait();
+    suite.assert_test(chain_ran.load() == 0, "Cancellation propagates to continuations",
+        std::to_string(chain_ran.load()) + " continuations ran");
+
+    dowel::task_graph cyclic;
+    auto nothing = [] {};
+    int a = cyclic.add("a", nothing);
+    int b = cyclic.add("b", nothing);
+    cyclic.depends_on(a, b);
+    cyclic.depends_on(b, a);
+    suite.assert_test(cyclic.run() == DOWEL_ERROR_INVALID_PARAMETER, "Graph with a cycle is rejected");
+
+    // Diamond with a slow branch: load -> {fast, slow} -> merge
+    dowel::task_graph graph;
+    std::atomic<int> order{0};
+    int load_at = -1, merge_at = -1;
+    auto load = [&] { load_at = order.fetch_add(1); };
+    auto fast = [&] { order.fetch_add(1); };
+    auto slow = [&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        order.fetch_add(1);
+    };
+    auto merge = [&] { merge_at = order.fetch_add(1); };
+    int n_load = graph.add("load", load);
+    int n_fast = graph.add("fast", fast);
+    int n_slow = graph.add("slow", slow);
+    int n_merge = graph.add("merge", merge);
+    graph.depends_on(n_fast, n_load);
+    graph.depends_on(n_slow, n_load);
+    graph.depends_on(n_merge, n_fast);
+    graph.depends_on(n_merge, n_slow);
+    int status = graph.run();
+    suite.assert_test(status == DOWEL_SUCCESS && load_at == 0 && merge_at == 3, "Graph runs in dependency order",
+        "load at " + std::to_string(load_at) + ", merge at " + std::to_string(merge_at));
+
+    int path[8];
+    size_t length = dowel_graph_critical_path(graph.get(), path, 8);
+    auto stats = graph.stats();
+    suite.assert_test(length == 3 && graph.name(path[0]) == "load" && graph.name(path[1]) == "slow" &&
+        graph.name(path[2]) == "merge" && stats.critical_path_nodes == 3 &&
+        stats.critical_path_ns >= 20000000 && stats.critical_path_ns <= stats.work_ns &&
+        stats.critical_path_ns <= stats.wall_ns, "Critical path goes through the slow branch",
+        "Path length " + std::to_string(length));
+
+    // Graphs can be run again
+    suite.assert_test(graph.run() == DOWEL_SUCCESS && order.load() == 8, "Graph re-run");
+
+    // A node whose task cannot be created takes its dependents down with it:
+    // a runs; b fails to launch, so c (after b) and d (after a and c) never run
+    dowel::task_graph partial;
+    std::atomic<bool> ran[4] = {};
+    auto mark_a = [&] { ran[0] = true; };
+    auto mark_b = [&] { ran[1] = true; };
+    auto mark_c = [&] { ran[2] = true; };
+    auto mark_d = [&] { ran[3] = true; };
+    int p_a = partial.add("a", mark_a);
+    int p_b = partial.add("b", mark_b);
+    int p_c = partial.add("c", mark_c);
+    int p_d = partial.add("d", mark_d);
+    partial.depends_on(p_c, p_b);
+    partial.depends_on(p_d, p_a);
+    partial.depends_on(p_d, p_c);
+    dcore_async_fail_task_after(1);
+    status = partial.run();
+    dcore_async_fail_task_after(-1);
+    suite.assert_test(status == DOWEL_ERROR_OUT_OF_MEMORY && ran[0] && !ran[1] && !ran[2] && !ran[3] &&
+        partial.stats().wall_ns == 0, "Dependents of a node that failed to launch are skipped",
+        "status " + std::to_string(status) + ", ran " + std::to_string(ran[0]) + std::to_string(ran[1]) +
+        std::to_string(ran[2]) + std::to_string(ran[3]));
+}
+
+static dowel::async::task<int> add_later(int a, int b) {
+    co_await dowel::async::schedule();
+    co_return a + b;
+}
+
+static dowel::async::task<int> sum_chain(int depth) {
+    if (depth == 0) co_return 0;
+    int rest = co_await sum_chain(depth - 1);
+    co_return rest + co_await add_later(depth, 0);
+}
+
+// Reads and gzips one file; yields the compressed size, or -1 if resumed
+// anywhere but a pool worker
+static dowel::async::task<long> pack_file(std::string path) {
+    dowel::buffer data = co_await dowel::async::read_file(std::move(path));
+    if (dowel::async::current_worker() < 0) co_return -1;
+    dowel::buffer packed = co_await dowel::async::compress_gzip(data.bytes());
+    co_return dowel::async::current_worker() < 0 ? -1 : long(packed.size());
+}
+
+static dowel::async::task<bool> await_handle(const dowel::task& handle, std::atomic<bool>& suspended) {
+    suspended = true;
+    co_await handle;
+    co_return handle.is_complete();
+}
+
+void test_coroutines(TestSuite& suite) {
+    std::cout << "\n🔁 Testing Coroutine Tasks\n";
+    std::cout << "---------------------------\n";
+
+    suite.assert_test(add_later(2, 3).get() == 5, "Coroutine resumes on the pool and returns");
+    suite.assert_test(sum_chain(50).get() == 1275, "Nested co_await chain", "Wrong sum");
+
+    // Hundreds of reads and compressions in flight from one thread, which only
+    // blocks while collecting the results
+    std::string dir = make_temp_dir();
+    std::string payload(8192, 'z');
+    dowel::storage::write_file(dir + "/in.txt", dowel::as_bytes(payload));
+    std::vector<dowel::async::task<long>> jobs;
+    for (int i = 0; i < 300; i++) {
+        jobs.push_back(pack_file(dir + "/in.txt"));
+        jobs.back().start();
+    }
+    long expected = long(dowel::compress_gzip(dowel::as_bytes(payload)).size());
+    int good = 0;
+    for (auto& job : jobs) good += job.get() == expected;
+    jobs.clear();
+    suite.assert_test(good == 300, "Awaitable read_file and compress_gzip", std::to_string(good) + " of 300 matched");
+
+    // A task cancelled while the coroutine is suspended on it still resumes
+    // the coroutine: the victim waits behind a gate task, so it is pending
+    // when the coroutine suspends and when it is cancelled
+    std::atomic<bool> release{false};
+    auto gate_fn = [&] {
+        while (!release.load()) std::this_thread::yield();
+    };
+    auto nothing = [] {};
+    auto gate = dowel::task::spawn(gate_fn);
+    auto victim = gate.then(nothing);
+    std::atomic<bool> suspended{false};
+    auto awaiting = await_handle(victim, suspended);
+    awaiting.start();
+    while (!suspended.load()) std::this_thread::yield();
+    victim.cancel();
+    release = true;
+    suite.assert_test(awaiting.get(), "co_await on a cancelled task handle resumes");
+
+    dowel::storage::delete_file(dir + "/in.txt");
+    rmdir(dir.c_str());
+}
+
+void test_file_views(TestSuite& suite) {
+    std::cout << "\n🗺️  Testing Mapped File Views\n";
+    std::cout << "-----------------------------\n";
+
+    std::string dir = make_temp_dir();
+    std::string payload;
+    for (int i = 0; i < 100000; i++) payload += char('a' + i % 26);
+    dowel::storage::write_file(dir + "/big.bin", dowel::as_bytes(payload));
+    dowel::storage::write_file(dir + "/empty.bin", {});
+
+    auto view = dowel::storage::map_file(dir + "/big.bin", DOWEL_MAP_SEQUENTIAL | DOWEL_MAP_WILLNEED);
+    auto copy = dowel::storage::read_file(dir + "/big.bin");
+    suite.assert_test(view && view.str() == payload && view.str() == copy.str(), "Mapped view matches file",
+        "Size " + std::to_string(view.size()));
+
+    // Copies share the mapping, which outlives both the original handle and
+    // the file's directory entry
+    dowel::storage::file_view shared = view;
+    view = dowel::storage::file_view();
+    dowel::storage::delete_file(dir + "/big.bin");
+    suite.assert_test(shared.size() == payload.size() && shared.str().substr(99990) == payload.substr(99990) &&
+        shared.advise(70000, 4096, DOWEL_MAP_WILLNEED) == DOWEL_SUCCESS &&
+        shared.advise(shared.size() + 1, 1, DOWEL_MAP_RANDOM) == DOWEL_ERROR_INVALID_PARAMETER,
+        "Shared view survives unlink");
+
+    auto empty = dowel::storage::map_file(dir + "/empty.bin");
+    auto missing = dowel::storage::map_file(dir + "/missing.bin");
+    suite.assert_test(empty && empty.empty() && empty.data() != nullptr && !missing, "Empty and missing files");
+
+    dowel::storage::delete_file(dir + "/empty.bin");
+    rmdir(dir.c_str());
+}
+
+void test_storage_batch(TestSuite& suite) {
+    std::cout << "\n📦 Testing Batched Storage\n";
+    std::cout << "---------------------------\n";
+
+    std::string dir = make_temp_dir();
+    std::cout << "   backend: " << dowel::storage::backend() << "\n";
+
+    // Run everything on the default backend, then on the thread fallback;
+    // more files than ring entries so batches are split across submits
+    for (bool use_ring : {true, false}) {
+        dowel_config_set_bool("storage.io_uring", use_ring);
+        std::string label = use_ring ? std::string(dowel::storage::backend()) : "threads";
+        const int count = 200;
+
+        std::vector<std::string> paths, contents;
+        std::vector<dowel_io_request_t> requests(count);
+        for (int i = 0; i < count; i++) {
+            paths.push_back(dir + "/f" + std::to_string(i));
+            contents.push_back(std::string(size_t(i * 37), char('a' + i % 26)));
+            requests[i] = {};
+            requests[i].op = DOWEL_IO_WRITE;
+            requests[i].path = paths[i].c_str();
+            requests[i].write_data = reinterpret_cast<const uint8_t*>(contents[i].data());
+            requests[i].write_size = contents[i].size();
+        }
+        int write_failures = dowel::storage::submit(requests);
+
+        for (int i = 0; i < count; i++) requests[i].op = DOWEL_IO_READ;
+        int read_failures = dowel::storage::submit(requests);
+        int matched = 0;
+        for (int i = 0; i < count; i++) {
+            dowel::buffer data(requests[i].data);
+            matched += requests[i].status == DOWEL_SUCCESS && data.str() == contents[i];
+        }
+        suite.assert_test(write_failures == 0 && read_failures == 0 && matched == count,
+            "Batched write and read (" + label + ")", std::to_string(matched) + " of 200 matched");
+
+        std::vector<dowel_io_request_t> stats(2);
+        std::string missing = dir + "/missing";
+        stats[0] = {};
+        stats[0].op = DOWEL_IO_STAT;
+        stats[0].path = paths[10].c_str();
+        stats[1] = stats[0];
+        stats[1].path = missing.c_str();
+        int stat_failures = dowel::storage::submit(stats);
+        suite.assert_test(stat_failures == 1 && stats[0].status == DOWEL_SUCCESS && stats[0].stat.size == 370 &&
+            stats[0].stat.modtime > 0 && !stats[0].stat.is_directory && stats[1].status != DOWEL_SUCCESS &&
+            stats[1].stat.size == -1, "Batched stat (" + label + ")");
+
+        auto entries = dowel::storage::stat_directory(dir);
+        std::int64_t total = 0;
+        for (const auto& entry : entries) total += entry.stat.size;
+        suite.assert_test(entries.size() == size_t(count) && total == 37 * (count - 1) * count / 2,
+            "Directory stat in one batch (" + label + ")", std::to_string(entries.size()) + " entries");
+    }
+    dowel_config_set_bool("storage.io_uring", true);
+
+    dowel_io_request_t bad = {};
+    bad.op = DOWEL_IO_READ;
+    suite.assert_test(dowel_storage_submit(&bad, 1) == DOWEL_ERROR_INVALID_PARAMETER, "Malformed batch rejected");
+
+    for (const auto& entry : dowel::storage::stat_directory(dir)) dowel::storage::delete_file(dir + "/" + entry.name);
+    rmdir(dir.c_str());
+}
+
+void test_file_cache(TestSuite& suite) {
+    std::cout << "\n🗃️  Testing File Cache\n";
+    std::cout << "----------------------\n";
+
+    std::string dir = make_temp_dir();
+    std::string hot_path = dir + "/hot.txt";
+    dowel::storage::write_file(hot_path, dowel::as_bytes(std::string_view("first")));
+
+    auto before = dowel::storage::metrics();
+    auto first = dowel::storage::read_cached(hot_path);
+    auto second = dowel::storage::read_cached(hot_path);
+    auto after = dowel::storage::metrics();
+    suite.assert_test(first.str() == "first" && second.data() == first.data() &&
+        after.cache_hits == before.cache_hits + 1 && after.cache_misses == before.cache_misses + 1 &&
+        after.total_reads == before.total_reads + 2, "Hit shares the cached copy");
+
+    // A write drops the cached copy; the old view keeps its contents
+    dowel::storage::write_file(hot_path, dowel::as_bytes(std::string_view("second")));
+    auto rewritten = dowel::storage::read_cached(hot_path);
+    suite.assert_test(rewritten.str() == "second" && first.str() == "first" &&
+        dowel::storage::metrics().total_writes == after.total_writes + 1, "Write invalidates");
+
+    // 1 MB shared by 16 shards; a scan of 200 files of 16 KB read once each
+    // must stay within it and must not push out a file that is read often
+    dowel_config_set_int("storage.cache_bytes", 1024 * 1024);
+    dowel::storage::clear_cache();
+    for (int i = 0; i < 4; i++) dowel::storage::read_cached(hot_path);
+    std::string block(16 * 1024, 'x');
+    std::vector<std::string> scan;
+    for (int i = 0; i < 200; i++) {
+        scan.push_back(dir + "/scan" + std::to_string(i));
+        dowel::storage::write_file(scan.back(), dowel::as_bytes(block));
+    }
+    before = dowel::storage::metrics();
+    bool contents_ok = true;
+    for (const auto& path : scan) contents_ok &= dowel::storage::read_cached(path).str() == block;
+    after = dowel::storage::metrics();
+    suite.assert_test(contents_ok && after.cached_bytes <= 1024 * 1024 && after.cached_bytes > 0 &&
+        after.cache_evictions + after.cache_rejections > before.cache_evictions + before.cache_rejections,
+        "Byte-bounded under a scan", std::to_string(after.cached_bytes) + " bytes cached");
+
+    std::uint64_t hits = after.cache_hits;
+    suite.assert_test(dowel::storage::read_cached(hot_path).str() == "second" &&
+        dowel::storage::metrics().cache_hits == hits + 1, "Frequent file survives the scan");
+
+    // Concurrent readers of a shared working set
+    std::atomic<int> mismatches{0};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; t++) {
+        readers.emplace_back([&, t] {
+            for (int i = 0; i < 500; i++) {
+                const std::string& path = scan[(i * 7 + t) % 32];
+                if (dowel::storage::read_cached(path).str() != block) mismatches++;
+            }
+        });
+    }
+    for (auto& reader : readers) reader.join();
+    suite.assert_test(mismatches == 0, "Concurrent cached reads");
+
+    // A file far over one shard's even share still fits the shared budget;
+    // one over the whole budget is read but never cached
+    std::string big_path = dir + "/big.bin", huge_path = dir + "/huge.bin";
+    std::string big(300 * 1024, 'b'), huge(1536 * 1024, 'h');
+    dowel::storage::write_file(big_path, dowel::as_bytes(big));
+    dowel::storage::write_file(huge_path, dowel::as_bytes(huge));
+    dowel::storage::clear_cache();
+    before = dowel::storage::metrics();
+    bool big_ok = dowel::storage::read_cached(big_path).str() == big && dowel::storage::read_cached(big_path).str() == big &&
+        dowel::storage::read_cached(huge_path).str() == huge && dowel::storage::read_cached(huge_path).str() == huge;
+    after = dowel::storage::metrics();
+    suite.assert_test(big_ok && after.cache_hits == before.cache_hits + 1 && after.cache_misses == before.cache_misses + 3 &&
+        after.cached_bytes <= 1024 * 1024, "Large files share the whole budget",
+        std::to_string(after.cache_hits - before.cache_hits) + " hits, " + std::to_string(after.cached_bytes) + " bytes cached");
+    // Lowering the budget trims every shard on the next miss
+    dowel_config_set_int("storage.cache_bytes", 64 * 1024);
+    dowel::storage::invalidate_cached(hot_path);
+    dowel::storage::read_cached(hot_path);
+    after = dowel::storage::metrics();
+    suite.assert_test(after.cached_bytes <= 64 * 1024 && after.cached_bytes > 0, "Lowered budget trims the cache",
+        std::to_string(after.cached_bytes) + " bytes cached");
+    dowel_config_set_int("storage.cache_bytes", 1024 * 1024);
+    dowel::storage::delete_file(big_path);
+    dowel::storage::delete_file(huge_path);
+
+    dowel::storage::invalidate_cached(hot_path);
+    suite.assert_test(!dowel::storage::read_cached(dir + "/missing") &&
+        dowel::storage::read_cached(hot_path).str() == "second", "Missing file and explicit invalidate");
+
+    dowel_config_set_int("storage.cache_bytes", 64 * 1024 * 1024);
+    dowel::storage::clear_cache();
+    suite.assert_test(dowel::storage::metrics().cached_files == 0 && rewritten.str() == "second",
+        "Clear keeps outstanding views valid");
+
+    for (const auto& path : scan) dowel::storage::delete_file(path);
+    dowel::storage::delete_file(hot_path);
+    rmdir(dir.c_str());
+}
+
+static bool no_temp_files(const std::string& dir) {
+    auto names = dowel::storage::list_directory(dir);
+    for (std::size_t i = 0; i < names.size(); i++) {
+        if (names[i].find(".tmp.") != std::string_view::npos) return false;
+    }
+    return true;
+}
+
+void test_durable_writes(TestSuite& suite) {
+    std::cout << "\n💾 Testing Durable Write Modes\n";
+    std::cout << "------------------------------\n";
+
+    std::string dir = make_temp_dir();
+    std::string path = dir + "/vault.bin";
+
+    bool modes_ok = true;
+    for (auto mode : {DOWEL_WRITE_FAST, DOWEL_WRITE_ATOMIC, DOWEL_WRITE_GROUP}) {
+        std::string body = "mode " + std::to_string(mode);
+        modes_ok &= dowel::storage::write_file(path, dowel::as_bytes(body), mode) == DOWEL_SUCCESS &&
+            dowel::storage::read_file(path).str() == body;
+    }
+    suite.assert_test(modes_ok && no_temp_files(dir), "Every mode writes the file");
+
+    chmod(path.c_str(), 0600);
+    dowel::storage::write_file(path, dowel::as_bytes(std::string_view("kept")), DOWEL_WRITE_ATOMIC);
+    struct stat st {};
+    stat(path.c_str(), &st);
+    suite.assert_test((st.st_mode & 0777) == 0600, "Atomic replace keeps permissions");
+    suite.assert_test(dowel_storage_write_file_mode(path.c_str(), nullptr, 0, 7) == DOWEL_ERROR_INVALID_PARAMETER &&
+        dowel_storage_write_file_mode((dir + "/no/such/dir").c_str(), nullptr, 0, DOWEL_WRITE_ATOMIC) ==
+            DOWEL_ERROR_STORAGE_ERROR, "Bad mode and missing directory rejected");
+
+    // Concurrent group writers all commit, to separate files and to one file
+    std::atomic<int> failures{0};
+    std::vector<std::thread> writers;
+    for (int t = 0; t < 8; t++) {
+        writers.emplace_back([&, t] {
+            for (int i = 0; i < 10; i++) {
+                std::string body = std::to_string(t) + ":" + std::to_string(i);
+                std::string own = dir + "/group" + std::to_string(t);
+                if (dowel::storage::write_file(own, dowel::as_bytes(body), DOWEL_WRITE_GROUP) != DOWEL_SUCCESS ||
+                    dowel::storage::read_file(own).str() != body ||
+                    dowel::storage::write_file(path, dowel::as_bytes(body), DOWEL_WRITE_GROUP) != DOWEL_SUCCESS) {
+                    failures++;
+                }
+            }
+        });
+    }
+    for (auto& writer : writers) writer.join();
+    suite.assert_test(failures == 0 && no_temp_files(dir), "Concurrent group commits",
+        std::to_string(failures.load()) + " failures");
+
+    // Crash injection: a child process dies at each step of an atomic write;
+    // the target must hold the old contents until the rename and the new ones
+    // after it
+    bool crashes_ok = true;
+    std::string report;
+    for (int point : {DCORE_CRASH_AFTER_TEMP_WRITE, DCORE_CRASH_AFTER_SYNC, DCORE_CRASH_AFTER_RENAME}) {
+        for (auto mode : {DOWEL_WRITE_ATOMIC, DOWEL_WRITE_GROUP}) {
+            dowel::storage::write_file(path, dowel::as_bytes(std::string_view("old contents")), DOWEL_WRITE_ATOMIC);
+            pid_t child = fork();
+            if (child == 0) {
+                dcore_storage_set_crash_point(point);
+                std::string body(100000, 'n');
+                dowel_storage_write_file_mode(path.c_str(), reinterpret_cast<const uint8_t*>(body.data()),
+                    body.size(), mode);
+                _exit(0);
+            }
+            int status = 0;
+            waitpid(child, &status, 0);
+            std::string contents(dowel::storage::read_file(path).str());
+            bool expect_new = point == DCORE_CRASH_AFTER_RENAME;
+            bool ok = WIFEXITED(status) && WEXITSTATUS(status) == DCORE_CRASH_EXIT_CODE &&
+                (expect_new ? contents == std::string(100000, 'n') : contents == "old contents");
+            if (!ok) report += " point " + std::to_string(point) + " mode " + std::to_string(mode);
+            crashes_ok &= ok;
+        }
+    }
+    suite.assert_test(crashes_ok, "Crash at each step leaves old or new contents", report);
+
+    // And a child killed at arbitrary moments while rewriting the file
+    bool kills_ok = true;
+    std::string small(1000, 'a');
+    std::string large(30000, 'b');
+    for (int round = 0; round < 8; round++) {
+        pid_t child = fork();
+        if (child == 0) {
+            for (int i = 0;; i++) {
+                const std::string& body = i % 2 ? large : small;
+                dowel::storage::write_file(path, dowel::as_bytes(body), DOWEL_WRITE_ATOMIC);
+            }
+        }
+        usleep(2000 + round * 1500);
+        kill(child, SIGKILL);
+        waitpid(child, nullptr, 0);
+        std::string contents(dowel::storage::read_file(path).str());
+        kills_ok &= contents == small || contents == large || contents == "old contents" ||
+            contents == std::string(100000, 'n');
+    }
+    suite.assert_test(kills_ok, "SIGKILL mid-rewrite never tears the file");
+
+    auto names = dowel::storage::list_directory(dir);
+    for (std::size_t i = 0; i < names.size(); i++) dowel::storage::delete_file(dir + "/" + std::string(names[i]));
+    rmdir(dir.c_str());
+}
+
+// Writes data to path through a stream in uneven pieces
+static int stream_out(const std::string& path, std::string_view data, const dowel_stream_options_t* options) {
+    auto out = dowel::storage::open_stream(path, DOWEL_STREAM_WRITE, options);
+    for (std::size_t at = 0; at < data.size(); at += 7777) {
+        if (out.write(dowel::as_bytes(data.substr(at, 7777))) < 0) return DOWEL_ERROR_STORAGE_ERROR;
+    }
+    return out.close();
+}
+
+// Reads a stream back in small pieces; a negative status on failure
+static std::string stream_in(const std::string& path, const dowel_stream_options_t* options, std::int64_t& status) {
+    auto in = dowel::storage::open_stream(path, DOWEL_STREAM_READ, options);
+    std::string data;
+    std::uint8_t piece[1000];
+    while ((status = in.read(piece)) > 0) data.append(reinterpret_cast<const char*>(piece), std::size_t(status));
+    return data;
+}
+
+void test_streams(TestSuite& suite) {
+    std::cout << "\n🌊 Testing Streams\n";
+    std::cout << "------------------\n";
+
+    std::string dir = make_temp_dir();
+    std::string path = dir + "/stream.bin";
+    std::string data;
+    for (int i = 0; data.size() < 3 * 1024 * 1024; i++) data += "line " + std::to_string(i * 2654435761u) + "\n";
+
+    dowel_stream_options_t plain = {};
+    plain.chunk_size = 64 * 1024;
+    std::int64_t status = 0;
+    suite.assert_test(stream_out(path, data, &plain) == DOWEL_SUCCESS && stream_in(path, &plain, status) == data &&
+        status == 0 && dowel::storage::read_file(path).str() == data, "Plain stream round trip");
+
+    auto in = dowel::storage::open_stream(path, DOWEL_STREAM_READ, &plain);
+    std::uint8_t window[100];
+    bool seek_ok = in.seek(1000000) == 1000000 && in.read(window) == 100 &&
+        std::string_view(reinterpret_cast<const char*>(window), 100) == std::string_view(data).substr(1000000, 100) &&
+        in.seek(-10, DOWEL_SEEK_END) == std::int64_t(data.size() - 10) && in.read(window) == 10 &&
+        in.seek(5, DOWEL_SEEK_SET) == 5 && in.seek(10, DOWEL_SEEK_CUR) == 15 && in.read(window) == 100 &&
+        std::string_view(reinterpret_cast<const char*>(window), 100) == std::string_view(data).substr(15, 100);
+    in.close();
+    auto out = dowel::storage::open_stream(path, DOWEL_STREAM_WRITE);
+    out.write(dowel::as_bytes(std::string_view("0123456789")));
+    out.seek(2);
+    out.write(dowel::as_bytes(std::string_view("ab")));
+    seek_ok &= out.close() == DOWEL_SUCCESS && dowel::storage::read_file(path).str() == "01ab456789";
+    suite.assert_test(seek_ok, "Seek in read and write streams");
+
+    dowel_stream_options_t gzip = {};
+    gzip.gzip = true;
+    suite.assert_test(stream_out(path, data, &gzip) == DOWEL_SUCCESS && stream_in(path, &gzip, status) == data &&
+        status == 0 && dowel::storage::file_size(path) < std::int64_t(data.size() / 2) &&
+        dowel::decompress_gzip(dowel::storage::read_file(path).bytes()).str() == data,
+        "Gzip stream matches dowel_decompress_gzip");
+
+    auto key = dowel::crypto_key::generate();
+    dowel_stream_options_t sealed = {};
+    sealed.gzip = true;
+    sealed.key = key.get();
+    suite.assert_test(stream_out(path, data, &sealed) == DOWEL_SUCCESS && stream_in(path, &sealed, status) == data &&
+        status == 0, "Gzip + encrypted stream round trip");
+
+    auto other = dowel::crypto_key::generate();
+    dowel_stream_options_t wrong = sealed;
+    wrong.key = other.get();
+    stream_in(path, &wrong, status);
+    bool wrong_key = status == DOWEL_ERROR_CRYPTO_ERROR;
+
+    // Flip one ciphertext byte, then cut the file short at a segment boundary
+    std::string raw(dowel::storage::read_file(path).str());
+    std::string tampered = raw;
+    tampered[tampered.size() / 2] ^= 1;
+    dowel::storage::write_file(path, dowel::as_bytes(tampered));
+    stream_in(path, &sealed, status);
+    bool tamper_caught = status == DOWEL_ERROR_CRYPTO_ERROR;
+
+    dowel_stream_options_t encrypted = {};
+    encrypted.key = key.get();
+    stream_out(path, data, &encrypted);
+    raw = std::string(dowel::storage::read_file(path).str());
+    dowel::storage::write_file(path, dowel::as_bytes(std::string_view(raw).substr(0, 11 + (64 * 1024 + 16) * 2)));
+    std::string partial = stream_in(path, &encrypted, status);
+    bool truncation_caught = status == DOWEL_ERROR_CRYPTO_ERROR && partial.size() == 64 * 1024;
+    suite.assert_test(wrong_key && tamper_caught && truncation_caught, "Wrong key, tampering and truncation rejected");
+
+    suite.assert_test(stream_out(path, "", &sealed) == DOWEL_SUCCESS && stream_in(path, &sealed, status).empty() &&
+        status == 0, "Empty encrypted stream");
+
+    auto transformed = dowel::storage::open_stream(path, DOWEL_STREAM_READ, &sealed);
+    suite.assert_test(transformed.seek(0) == DOWEL_ERROR_INVALID_PARAMETER &&
+        transformed.write(dowel::as_bytes(std::string_view("x"))) == DOWEL_ERROR_INVALID_PARAMETER &&
+        !dowel::storage::open_stream(dir + "/missing", DOWEL_STREAM_READ), "Invalid stream operations rejected");
+    transformed.close();
+
+    dowel::storage::delete_file(path);
+    rmdir(dir.c_str());
+}
+
+void test_directory_scan(TestSuite& suite) {
+    std::cout << "\n🗂️  Testing Directory Scan\n";
+    std::cout << "--------------------------\n";
+
+    // 12 albums of 3 subfolders, each with a photo, an upper-case photo and
+    // a note, plus a symlink to the first album that must not be followed
+    std::string dir = make_temp_dir();
+    std::vector<std::string> expected;
+    std::int64_t expected_bytes = 0;
+    for (int a = 0; a < 12; a++) {
+        std::string album = "album" + std::to_string(a);
+        dowel::storage::create_directory(dir + "/" + album);
+        for (int s = 0; s < 3; s++) {
+            std::string sub = album + "/day" + std::to_string(s);
+            dowel::storage::create_directory(dir + "/" + sub);
+            for (std::string name : {"IMG_1.jpg", "IMG_2.JPG", "notes.txt"}) {
+                std::string body(size_t(a * 10 + s), 'p');
+                dowel::storage::write_file(dir + "/" + sub + "/" + name, dowel::as_bytes(body));
+                expected.push_back(sub + "/" + name);
+                expected_bytes += std::int64_t(body.size());
+            }
+        }
+    }
+    symlink((dir + "/album0").c_str(), (dir + "/shortcut").c_str());
+    expected.push_back("shortcut");
+    std::sort(expected.begin(), expected.end());
+
+    auto all = dowel::storage::scan(dir);
+    std::vector<std::string> found;
+    std::int64_t bytes = 0;
+    bool types_ok = true;
+    for (const auto& entry : all) {
+        found.emplace_back(all.path(entry));
+        bool link = all.path(entry) == "shortcut";
+        types_ok = types_ok && entry.type == (link ? DOWEL_ENTRY_SYMLINK : DOWEL_ENTRY_FILE) &&
+            entry.modtime > 0 && entry.depth == (link ? 0 : 2);
+        if (!link) bytes += entry.size;
+    }
+    std::sort(found.begin(), found.end());
+    suite.assert_test(found == expected && bytes == expected_bytes && types_ok && all.skipped_directories() == 0,
+        "Recursive scan lists every file once", std::to_string(found.size()) + " entries");
+
+    const char* photos[] = {"jpg"};
+    dowel_scan_options_t options = {};
+    options.extensions = photos;
+    options.extension_count = 1;
+    std::size_t jpgs = dowel::storage::scan(dir, &options).size();
+    options.pattern = "*_2.*";
+    std::size_t second = dowel::storage::scan(dir, &options).size();
+    suite.assert_test(jpgs == 72 && second == 36, "Extension and glob filters",
+        std::to_string(jpgs) + " / " + std::to_string(second));
+
+    dowel_scan_options_t shallow = {};
+    shallow.include_directories = true;
+    shallow.max_depth = 2;
+    auto top = dowel::storage::scan(dir, &shallow);
+    int directories = 0;
+    for (const auto& entry : top) directories += entry.type == DOWEL_ENTRY_DIRECTORY;
+    suite.assert_test(top.size() == 12 + 36 + 1 && directories == 48, "Directories listed down to max_depth",
+        std::to_string(top.size()) + " entries");
+
+    suite.assert_test(!dowel::storage::scan(dir + "/missing") && !dowel::storage::scan(dir + "/album0/day0/notes.txt"),
+        "Scanning a missing root or a file fails");
+
+    std::filesystem::remove_all(dir);
+}
+
+// Polls until check() holds or two seconds pass
+template <typename Check>
+static bool eventually(Check check) {
+    for (int i = 0; i < 200; i++) {
+        if (check()) return true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return check();
+}
+
+static int inotify_instances() {
+    int count = 0;
+    std::error_code error;
+    for (const auto& fd : std::filesystem::directory_iterator("/proc/self/fd", error)) {
+        count += std::filesystem::read_symlink(fd.path(), error).string() == "anon_inode:inotify";
+    }
+    return count;
+}
+
+void test_metadata_index(TestSuite& suite) {
+    std::cout << "\n🗃️  Testing Metadata Index\n";
+    std::cout << "--------------------------\n";
+
+    std::string dir = make_temp_dir();
+    std::string snapshot = make_temp_dir() + "/index.bin";
+    dowel::storage::create_directory(dir + "/notes");
+    for (int i = 0; i < 20; i++) {
+        dowel::storage::write_file(dir + "/notes/n" + std::to_string(i), dowel::as_bytes(std::string(size_t(i), 'n')));
+    }
+
+    int opened = dowel::storage::open_index(dir, snapshot);
+    auto before = dowel::storage::index_stats();
+    bool answers = dowel::storage::file_exists(dir + "/notes/n7") && dowel::storage::file_size(dir + "/notes/n7") == 7 &&
+        dowel::storage::file_modtime(dir + "/notes/n7") > 0 && !dowel::storage::file_exists(dir + "/notes/missing") &&
+        dowel::storage::file_size(dir + "/notes/missing") == -1 && dowel::storage::file_exists(dir + "/notes");
+    auto after = dowel::storage::index_stats();
+    suite.assert_test(opened == DOWEL_SUCCESS && answers && after.entries == 22 && after.ready &&
+        after.hits - before.hits == 6 && after.fallbacks == before.fallbacks,
+        "Lookups answered from the index without stat", std::to_string(after.entries) + " entries");
+
+    suite.assert_test(dowel::storage::file_exists(dir + "/notes/../notes/n3") && !dowel::storage::file_exists(dir + "/notes/n3/") &&
+        dowel::storage::file_size(dir + "//notes/n3") == 3, "Other spellings fall back to stat");
+
+    dowel::storage::write_file(dir + "/notes/new", dowel::as_bytes(std::string_view("12345")));
+    bool written = dowel::storage::file_size(dir + "/notes/new") == 5;
+    dowel::storage::delete_file(dir + "/notes/n0");
+    suite.assert_test(written && !dowel::storage::file_exists(dir + "/notes/n0"), "Writes through the API show at once");
+
+    write_raw(dir + "/notes/outside", "abc");
+    unlink((dir + "/notes/n1").c_str());
+    mkdir((dir + "/photos").c_str(), 0755);
+    write_raw(dir + "/photos/p.jpg", "jpeg");
+    bool seen = eventually([&] {
+        return dowel::storage::file_size(dir + "/notes/outside") == 3 && !dowel::storage::file_exists(dir + "/notes/n1") &&
+            dowel::storage::file_size(dir + "/photos/p.jpg") == 4;
+    });
+    suite.assert_test(seen, "Outside changes arrive through the watches");
+
+    // The index watches through the shared service: a watcher of its own
+    // adds no inotify instance, and touch (an attribute change) shows
+    auto ignore = [](std::string_view, dowel_file_event_t) {};
+    auto watcher = dowel::file_watcher::create(dir, DOWEL_FILE_EVENT_CREATED, ignore);
+    int instances = inotify_instances();
+    struct timespec times[2] = {{1000000000, 0}, {1000000000, 0}};
+    utimensat(AT_FDCWD, (dir + "/notes/outside").c_str(), times, 0);
+    bool touched = eventually([&] { return dowel::storage::file_modtime(dir + "/notes/outside") == 1000000000; });
+    watcher = dowel::file_watcher();
+    suite.assert_test(instances == 1 && touched, "Index shares the file watcher service",
+        std::to_string(instances) + " inotify instances");
+
+    rename((dir + "/photos").c_str(), (dir + "/pictures").c_str());
+    bool moved = eventually([&] {
+        return !dowel::storage::file_exists(dir + "/photos/p.jpg") && dowel::storage::file_size(dir + "/pictures/p.jpg") == 4;
+    });
+    suite.assert_test(moved, "Renamed directory moves its entries");
+
+    // Change the tree while the index is closed, then warm-start from the
+    // snapshot: new names, removals and in-place edits all show at once,
+    // before the rescan has verified the snapshot's entries
+    dowel::storage::close_index();
+    bool saved = dowel::storage::file_exists(snapshot);
+    write_raw(dir + "/notes/offline", "xy");
+    write_raw(dir + "/notes/n5", "edited in place");
+    unlink((dir + "/notes/n7").c_str());
+    int reopened = dowel::storage::open_index(dir, snapshot);
+    bool warm = dowel::storage::index_stats().from_snapshot;
+    bool offline_seen = dowel::storage::file_size(dir + "/notes/offline") == 2 &&
+        dowel::storage::file_size(dir + "/notes/n5") == 15 && !dowel::storage::file_exists(dir + "/notes/n7");
+    bool verified = eventually([&] { return dowel::storage::index_stats().ready; }) &&
+        dowel::storage::file_size(dir + "/notes/n5") == 15 && dowel::storage::file_size(dir + "/pictures/p.jpg") == 4;
+    suite.assert_test(saved && reopened == DOWEL_SUCCESS && warm && offline_seen && verified,
+        "Warm start from the snapshot", std::to_string(saved) + std::to_string(warm) + std::to_string(offline_seen) +
+        std::to_string(verified));
+
+    dowel::storage::close_index();
+    auto closed = dowel::storage::index_stats();
+    suite.assert_test(closed.entries == 0 && dowel::storage::file_size(dir + "/notes/n5") == 15 &&
+        dowel::storage::open_index(dir + "/missing") == DOWEL_ERROR_STORAGE_ERROR, "Closed index falls back to stat");
+
+    std::filesystem::remove_all(dir);
+    std::filesystem::remove_all(std::filesystem::path(snapshot).parent_path());
+}
+
+void test_json_parser(TestSuite& suite) {
+    std::cout << "\n🧾 Testing JSON Parser\n";
+    std::cout << "-----------------------\n";
+
+    // Quotes and runs of backslashes at every offset across the 64 byte
+    // blocks stage 1 classifies, with each SIMD kernel and the portable one
+    auto block_edges = [] {
+        for (int pad = 0; pad < 140; pad++) {
+            std::string text = R"({"p":")" + std::string(size_t(pad), 'x') + R"(","s":"q\"\\\\\"e","t":true,"u":"\u00e9\ud83d\ude00"})";
+            auto doc = dowel::json_document::parse(text);
+            if (!doc || doc["s"].as_string() != "q\"\\\\\"e" || !doc["t"].as_bool() ||
+                doc["u"].as_string() != "\xc3\xa9\xf0\x9f\x98\x80" || doc["p"].as_string().size() != size_t(pad)) {
+                return false;
+            }
+            auto again = dowel::json_document::parse(doc.stringify().data());
+            if (again.stringify() != doc.stringify()) return false;
+        }
+        return true;
+    };
+    bool kernels = block_edges();
+    dcore_cpu_restrict(DCORE_CPU_SSE2 | DCORE_CPU_NEON);
+    kernels = kernels && block_edges();
+    dcore_cpu_restrict(0);
+    kernels = kernels && block_edges();
+    dcore_cpu_restrict(UINT32_MAX);
+    suite.assert_test(kernels, "Stage 1 kernels agree across block boundaries");
+
+    auto numbers = dowel::json_document::parse(
+        R"({"zero":-0,"exp":1.5e3,"tenth":0.1,"big":123456789012345678901,"min":-9223372036854775808,)"
+        R"("max":9223372036854775807,"huge":1e400,"tiny":-2.5E-3})");
+    suite.assert_test(numbers && numbers["zero"].as_int() == 0 && numbers["exp"].as_float() == 1500.0 &&
+        numbers["tenth"].as_float() == 0.1 && numbers["big"].as_float() == 123456789012345678901.0 &&
+        numbers["min"].as_int() == INT64_MIN && numbers["max"].as_int() == INT64_MAX &&
+        numbers["huge"].as_float() == HUGE_VAL && numbers["tiny"].as_float() == -0.0025, "JSON numbers");
+
+    auto floats = dowel::json_document::parse(
+        R"({"a":1e300,"b":-1e300,"c":1e400,"d":-2.9,"e":9223372036854775807.0,"f":-9223372036854775808.0})");
+    suite.assert_test(floats && floats["a"].as_int() == INT64_MAX && floats["b"].as_int() == INT64_MIN &&
+        floats["c"].as_int() == INT64_MAX && floats["d"].as_int() == -2 && floats["e"].as_int() == INT64_MAX &&
+        floats["f"].as_int() == INT64_MIN, "Floats outside the int64 range saturate");
+
+    const char* malformed[] = {
+        "", "  ", "{\"a\":}", "[1,]", "{\"a\" 1}", "{\"a\":1,}", "\"abc", "[1 2]", "01", "tru", "nul", "-", "1.",
+        ".5", "\"\\x\"", "[\"\\ud800\"]", "\"a\x01\"", "{\"a\":1}}", "[\"a\"b]", "{1:2}", "[1]x",
+    };
+    bool rejected = true;
+    for (const char* text : malformed) rejected = rejected && !dowel::json_document::parse(text);
+    suite.assert_test(rejected, "JSON rejects each malformed input");
+
+    std::string deep = std::string(512, '[') + std::string(512, ']');
+    std::string deeper = std::string(513, '[') + std::string(513, ']');
+    suite.assert_test(dowel::json_document::parse(deep) && !dowel::json_document::parse(deeper) &&
+        dowel::json_document::parse(" 42 ").root().as_int() == 42 &&
+        dowel::json_document::parse("\"s\"").root().as_string() == "s", "JSON depth limit and top-level scalars");
+
+    // Large objects are looked up through their directory
+    std::string wide = "{\"dup\":1";
+    for (int i = 0; i < 1000; i++) wide += ",\"key" + std::to_string(i) + "\":{\"v\":" + std::to_string(i) + "}";
+    wide += ",\"dup\":2}";
+    auto object = dowel::json_document::parse(wide);
+    bool found = true;
+    for (int i = 0; i < 1000; i++) found = found && object["key" + std::to_string(i)]["v"].as_int() == i;
+    suite.assert_test(found && !object["key1000"] && object["dup"].as_int() == 1 &&
+        dowel::json_document::parse(object.stringify().data())["key999"]["v"].as_int() == 999,
+        "JSON lookups in a 1000 member object");
+}
+
+void test_json_lazy(TestSuite& suite) {
+    std::cout << "\n🔎 Testing On-Demand JSON\n";
+    std::cout << "--------------------------\n";
+
+    std::string text = R"({"title":"Chat","mapping":{"abc":{"message":{"content":"hi \"there\"","parts":[1,{"x":2.5},true]}}},)"
+        R"("a/b":1,"m~n":2,"key":"escaped","skip":[[[{"deep":[]}]]],"n":null,"e":{}})";
+    auto doc = dowel::json_lazy::open(text);
+    auto parts = doc.find("/mapping/abc/message/parts");
+    suite.assert_test(doc && doc.find("/mapping/abc/message/content").as_string() == "hi \"there\"" &&
+        doc["title"].as_string() == "Chat" && parts.size() == 3 && parts[1]["x"].as_float() == 2.5 &&
+        parts.find("/2").as_bool() && parts[0].as_int() == 1 && doc.find("").type() == DOWEL_JSON_TYPE_OBJECT,
+        "JSON pointer lookups");
+
+    suite.assert_test(doc.find("/a~1b").as_int() == 1 && doc.find("/m~0n").as_int() == 2 &&
+        doc["key"].as_string() == "escaped" && !doc.find("/a~2b") && !parts.find("/01") && !parts.find("/3") &&
+        !parts.find("/-") && !doc.find("title") && !doc.find("/title/0") && !doc["missing"] &&
+        doc["n"].type() == DOWEL_JSON_TYPE_NULL && doc["e"].size() == 0 && !doc["e"]["x"] &&
+        doc["skip"].raw() == R"([[[{"deep":[]}]]])" && doc["title"].raw() == "\"Chat\"",
+        "JSON pointer escapes, indices and misses");
+
+    char small[5];
+    auto content = doc.find("/mapping/abc/message/content");
+    suite.assert_test(dowel_json_lazy_get_string(content.get(), small, sizeof(small)) == 10 &&
+        std::string(small) == "hi \"" && dowel_json_lazy_get_string(parts.get(), small, sizeof(small)) == -1 &&
+        parts[0].as_string().empty() && content.as_int() == 0, "Strings are unescaped into a bounded buffer");
+
+    // Brackets are checked when opening; the rest only where lookups go
+    const char* unopenable[] = {"", "{\"a\":[1}", "{} {}", "\"abc", "[1]]", "{"};
+    bool rejected = true;
+    for (const char* bad : unopenable) rejected = rejected && !dowel::json_lazy::open(bad);
+    auto partial = dowel::json_lazy::open(R"({"ok":1,"bad":[1 2],"after":3})");
+    suite.assert_test(rejected && partial["ok"].as_int() == 1 && partial["bad"][0].as_int() == 1 &&
+        !partial["bad"][1] && partial["after"].as_int() == 3 && !dowel::json_lazy::open((std::string(513, '[') + std::string(513, ']')).c_str()),
+        "On-demand JSON validates lazily");
+
+    // Counting stops at a member that is not "name": value, without reading past the index
+    auto keyless = dowel::json_lazy::open(R"({"a"})");
+    auto trailing = dowel::json_lazy::open(R"({"a":1,"b"})");
+    auto valueless = dowel::json_lazy::open(R"({"a":})");
+    auto unseparated = dowel::json_lazy::open(R"({"a":1 "b":2})");
+    suite.assert_test(keyless && keyless.root().size() == 0 && trailing && trailing.root().size() == 1 &&
+        valueless && valueless.root().size() == 0 && partial["bad"].size() == 1 && unseparated &&
+        unseparated.root().size() == 1, "Malformed members and elements stop the count");
+
+    auto floats = dowel::json_lazy::open(R"([1e300,-1e300,-2.9])");
+    suite.assert_test(floats.root()[0].as_int() == INT64_MAX && floats.root()[1].as_int() == INT64_MIN &&
+        floats.root()[2].as_int() == -2, "On-demand floats outside the int64 range saturate");
+
+    // Agrees with the tape parser field for field, in 8 bytes per indexed position
+    std::string wide = "{";
+    for (int i = 0; i < 1000; i++) {
+        wide += (i ? ",\"key" : "\"key") + std::to_string(i) + "\":{\"v\":" + std::to_string(i) + ",\"s\":\"s\\n" + std::to_string(i) + "\"}";
+    }
+    wide += "}";
+    auto lazy = dowel::json_lazy::open(wide);
+    auto tree = dowel::json_document::parse(wide);
+    bool agree = lazy.root().size() == 1000;
+    for (int i = 0; i < 1000; i += 7) {
+        std::string key = "key" + std::to_string(i);
+        agree = agree && lazy[key]["v"].as_int() == tree[key]["v"].as_int() && lazy[key]["s"].as_string() == tree[key]["s"].as_string();
+    }
+    suite.assert_test(agree && lazy.footprint() <= 8 * wide.size() / 2 + 64, "On-demand JSON matches the tape parser",
+        std::to_string(lazy.footprint()) + " index bytes for " + std::to_string(wide.size()));
+}
+
+void test_json_writer(TestSuite& suite) {
+    std::cout << "\n✏️  Testing JSON Writer\n";
+    std::cout << "-----------------------\n";
+
+    auto writer = dowel::json_writer::create();
+    writer.begin_object().key("title").value("Chat").key("count").value(3).key("ok").value(true)
+        .key("none").null().key("items").begin_array().value(1.5).value(-7).begin_object().end_object()
+        .begin_array().end_array().raw(R"({"kept":[1]})").end_array().end_object();
+    suite.assert_test(writer.finish() == DOWEL_SUCCESS &&
+        writer.text() == R"({"title":"Chat","count":3,"ok":true,"none":null,"items":[1.5,-7,{},[],{"kept":[1]}]})",
+        "Writer builds nested documents");
+
+    // Control characters, quotes and multi-byte text, in pieces longer than
+    // one escape slice
+    std::string tricky;
+    for (int c = 1; c < 0x20; c++) tricky += char(c);
+    tricky += "\"\\/\xc3\xa9\xf0\x9f\x98\x80 plain";
+    std::string long_text;
+    for (int i = 0; long_text.size() < 20000; i++) long_text += (i % 97 == 0 ? tricky : std::string("abcdefghij"));
+    writer.reset();
+    writer.begin_object().key(tricky).value(tricky).key("long").value(long_text).end_object();
+    auto escaped = dowel::json_document::parse(std::string(writer.text()));
+    suite.assert_test(writer.finish() == DOWEL_SUCCESS && escaped && escaped[tricky].as_string() == tricky &&
+        escaped["long"].as_string() == long_text && writer.text().find("\\u001f") != std::string_view::npos,
+        "Writer escapes strings");
+
+    // Shortest text that reads back to the same double
+    const double samples[] = {0.1, 0.3, 1.0 / 3, 2.0 / 3, 1e21, 1e-7, 123.456, -0.0, 5e-324, 1.7976931348623157e308,
+                              2.2250738585072014e-308, 9007199254740993.0, 1e23, 4.35, 0.000001, 100.0};
+    bool exact = true;
+    for (double sample : samples) {
+        writer.reset();
+        writer.value(sample);
+        exact = exact && writer.finish() == DOWEL_SUCCESS &&
+            std::strtod(std::string(writer.text()).c_str(), nullptr) == sample && std::signbit(sample) == (writer.text()[0] == '-');
+    }
+    std::string printed;
+    for (double sample : {0.1, 1e21, 1e-7, 5e-324, 123.456, 100.0, 0.000001}) {
+        writer.reset();
+        writer.value(sample);
+        printed += std::string(writer.text()) + " ";
+    }
+    suite.assert_test(exact && printed == "0.1 1e+21 1e-7 5e-324 123.456 100 0.000001 ", "Doubles print short and exact", printed);
+
+    auto misuse = [](auto&& write) {
+        auto w = dowel::json_writer::create();
+        write(w);
+        return w.finish() == DOWEL_ERROR_INVALID_PARAMETER && w.error() == DOWEL_ERROR_INVALID_PARAMETER && w.text().empty();
+    };
+    suite.assert_test(misuse([](auto& w) { w.key("x"); }) && misuse([](auto& w) { w.begin_object().value(1).end_object(); }) &&
+        misuse([](auto& w) { w.begin_object().end_array(); }) && misuse([](auto& w) { w.value(1).value(2); }) &&
+        misuse([](auto& w) { w.begin_array(); }) && misuse([](auto& w) { w.begin_object().key("a").end_object(); }) &&
+        misuse([](auto& w) { w.value(std::nan("")); }) && misuse([](auto&) {}) &&
+        misuse([](auto& w) { for (int i = 0; i < 513; i++) w.begin_array(); }), "Writer rejects malformed sequences");
+
+    // Straight to a gzip stream, in 64 KB chunks
+    std::string dir = make_temp_dir();
+    std::string path = dir + "/export.json.gz";
+    dowel_stream_options_t gzip = {};
+    gzip.gzip = true;
+    auto file = dowel::storage::open_stream(path, DOWEL_STREAM_WRITE, &gzip);
+    auto streamed = dowel::json_writer::create(file);
+    streamed.begin_array();
+    for (int i = 0; i < 20000; i++) {
+        streamed.begin_object().key("id").value(i).key("text").value("note \"" + std::to_string(i) + "\"\n").end_object();
+    }
+    streamed.end_array();
+    bool written = streamed.finish() == DOWEL_SUCCESS && file.close() == DOWEL_SUCCESS;
+    std::int64_t status = 0;
+    // The lazy parser borrows its text, so it must outlive the document
+    std::string exported_text = stream_in(path, &gzip, status);
+    auto exported = dowel::json_lazy::open(exported_text);
+    suite.assert_test(written && status == 0 && !streamed.text().data() && exported.root().size() == 20000 &&
+        exported.find("/19999/text").as_string() == "note \"19999\"\n", "Writer streams to a dowel stream");
+
+    dowel::arena scratch;
+    auto in_arena = dowel::json_writer::create(scratch);
+    in_arena.begin_array().value("scratch").end_array();
+    suite.assert_test(in_arena.finish() == DOWEL_SUCCESS && in_arena.text() == R"(["scratch"])" && scratch.used() > 0 &&
+        dowel::json_document::parse(R"({"x":0.1,"big":1e400})").stringify() == R"({"x":0.1,"big":null})",
+        "Writer in an arena, stringify shares the formatting");
+    std::filesystem::remove_all(dir);
+}
+
+void test_compression_codecs(TestSuite& suite) {
+    std::cout << "\n🗜️  Testing Compression Codecs\n";
+    std::cout << "------------------------------\n";
+
+    std::string text;
+    for (int i = 0; text.size() < 3 << 20; i++) {
+        text += R"({"role":"assistant","id":)" + std::to_string(i) + R"(,"content":"Reply number )" + std::to_string(i * 7) + "\"}\n";
+    }
+    std::string noise(100000, '\0');
+    for (size_t i = 0; i < noise.size(); i++) noise[i] = char((i * 2654435761u) >> 13);
+
+    bool round_trips = true;
+    std::string failed;
+    for (dowel_codec_t codec : {DOWEL_CODEC_GZIP, DOWEL_CODEC_LZ4, DOWEL_CODEC_ZSTD}) {
+        if (!dowel::codec_available(codec)) continue;
+        for (int level : {0, 1, 5, 9}) {
+            for (const std::string* input : {&text, &noise}) {
+                for (size_t size : {size_t(0), size_t(1), size_t(13), size_t(4096), input->size()}) {
+                    auto data = dowel::as_bytes(std::string_view(*input).substr(0, size));
+                    auto packed = dowel::compress(data, codec, level);
+                    dowel_frame_info_t info{};
+                    bool ok = packed && dowel_compress_frame_info(packed.data(), packed.size(), &info) == DOWEL_SUCCESS &&
+                        info.codec == codec && info.content_size == size && dowel::decompress(packed.bytes()).str() == std::string_view(*input).substr(0, size);
+                    if (!ok) failed += std::to_string(codec) + "/" + std::to_string(level) + "/" + std::to_string(size) + " ";
+                    round_trips = round_trips && ok;
+                }
+            }
+        }
+    }
+    auto lz4 = dowel::compress(dowel::as_bytes(text));
+    auto gzip = dowel::compress(dowel::as_bytes(text), DOWEL_CODEC_GZIP, 9);
+    suite.assert_test(round_trips && lz4.size() < text.size() / 4 && gzip.size() < lz4.size(),
+        "Every codec round trips at every level", failed + std::to_string(lz4.size()) + " / " + std::to_string(gzip.size()));
+
+    dowel::arena scratch;
+    auto in_arena = dowel::decompress(scratch, dowel::compress(scratch, dowel::as_bytes(text), DOWEL_CODEC_LZ4, 4));
+    suite.assert_test(std::string_view(reinterpret_cast<const char*>(in_arena.data()), in_arena.size()) == text &&
+        dowel::codec_available(DOWEL_CODEC_ZSTD) == bool(dowel::compress(dowel::as_bytes(text), DOWEL_CODEC_ZSTD)) &&
+        !dowel::compress(dowel::as_bytes(text), DOWEL_CODEC_LZ4, 10) && !dowel::compress(dowel::as_bytes(text), dowel_codec_t(9)),
+        "Arena frames, codec availability and level ranges");
+
+    // Damaged frames fail cleanly, whichever byte is hit
+    bool rejected = true;
+    for (dowel_codec_t codec : {DOWEL_CODEC_GZIP, DOWEL_CODEC_LZ4}) {
+        auto packed = dowel::compress(dowel::as_bytes(std::string_view(text).substr(0, 50000)), codec);
+        std::vector<std::uint8_t> frame(packed.data(), packed.data() + packed.size());
+        for (size_t cut : {size_t(0), size_t(2), size_t(5), frame.size() / 2, frame.size() - 1}) {
+            rejected = rejected && !dowel::decompress(dowel::bytes_view(frame.data(), cut));
+        }
+        for (size_t i = 0; i < 200; i++) {
+            std::vector<std::uint8_t> damaged = frame;
+            size_t at = (i * 7919) % damaged.size();
+            damaged[at] ^= std::uint8_t(1 + i % 255);
+            auto out = dowel::decompress(dowel::bytes_view(damaged.data(), damaged.size()));
+            // A flipped literal can still decode; it must then be the right size
+            rejected = rejected && (!out || out.size() == 50000);
+        }
+    }
+    suite.assert_test(rejected, "Truncated and corrupt frames are rejected");
+
+    // The content size is checked against what the payload could decode to
+    // before anything is allocated; real content at each codec's best ratio
+    // still fits
+    bool capped = true;
+    std::string zeros(8 << 20, '\0');
+    for (dowel_codec_t codec : {DOWEL_CODEC_GZIP, DOWEL_CODEC_LZ4, DOWEL_CODEC_ZSTD}) {
+        std::vector<std::uint8_t> forged{'D', 'W', std::uint8_t(codec), 0x80, 0x80, 0x80, 0x80, 0x80, 0x01};
+        forged.resize(forged.size() + 16, 0);
+        dowel_frame_info_t info{};
+        capped = capped && !dowel::decompress(dowel::bytes_view(forged.data(), forged.size())) &&
+            dowel_compress_frame_info(forged.data(), forged.size(), &info) == DOWEL_ERROR_INVALID_PARAMETER;
+        if (dowel::codec_available(codec)) {
+            capped = capped && dowel::decompress(dowel::compress(dowel::as_bytes(zeros), codec, 9).bytes()).size() == zeros.size();
+        }
+    }
+    suite.assert_test(capped, "Frames claiming more than their payload holds are rejected");
+
+    // Small records share most of their bytes with each other but little within
+    std::vector<std::string> records;
+    for (int i = 0; i < 2000; i++) {
+        records.push_back(R"({"type":"message","conversation_id":"conv_)" + std::to_string(i % 37) +
+            R"(","role":")" + (i % 2 ? "assistant" : "user") + R"(","model":"small-model-2024","created_at":"2024-01-)" +
+            std::to_string(10 + i % 20) + R"(T12:00:00Z","content":"Message )" + std::to_string(i) +
+            R"( about the sync schedule","metadata":{"tokens":)" + std::to_string(i * 13 % 900) + R"(,"cached":false}})");
+    }
+    std::vector<dowel::bytes_view> samples;
+    for (int i = 0; i < 1000; i++) samples.push_back(dowel::as_bytes(records[i]));
+    auto dict = dowel::compress_dict::train(samples, 4096);
+    auto reloaded = dowel::compress_dict::load(dict.bytes());
+    size_t plain = 0, with_dict = 0;
+    bool dict_trips = dict && reloaded && reloaded.id() == dict.id() && dict.bytes().size() <= 4096;
+    for (dowel_codec_t codec : {DOWEL_CODEC_GZIP, DOWEL_CODEC_LZ4, DOWEL_CODEC_ZSTD}) {
+        if (!dowel::codec_available(codec)) continue;
+        for (int i = 1000; i < 2000; i++) {
+            auto record = dowel::as_bytes(records[i]);
+            auto alone = dowel::compress(record, codec);
+            auto shared = dowel::compress(record, codec, 0, &dict);
+            plain += alone.size();
+            with_dict += shared.size();
+            dict_trips = dict_trips && dowel::decompress(shared.bytes(), &reloaded).str() == records[i] &&
+                !dowel::decompress(shared.bytes()) && !dowel::decompress(alone.bytes(), &dict);
+        }
+    }
+    suite.assert_test(dict_trips && with_dict * 2 < plain, "A trained dictionary shrinks small records",
+        std::to_string(plain) + " bytes alone, " + std::to_string(with_dict) + " with the dictionary");
+
+    std::vector<std::string> unrelated{"a", "b"};
+    std::vector<dowel::bytes_view> tiny{dowel::as_bytes(unrelated[0]), dowel::as_bytes(unrelated[1])};
+    suite.assert_test(!dowel::compress_dict::train(tiny, 4096) && !dowel::compress_dict::load({}),
+        "Dictionary training needs enough samples");
+}
+
+void test_block_compression(TestSuite& suite) {
+    std::cout << "\n🗄️  Testing Block Compression\n";
+    std::cout << "----------------------------\n";
+
+    std::string log;
+    for (int i = 0; log.size() < (5 << 20) + 1234; i++) {
+        log += "2024-01-15T12:" + std::to_string(i % 60) + " INFO sync: pushed note " + std::to_string(i * 31 % 100003) + "\n";
+    }
+    auto text = dowel::as_bytes(log);
+
+    bool round_trips = true;
+    for (dowel_codec_t codec : {DOWEL_CODEC_LZ4, DOWEL_CODEC_GZIP, DOWEL_CODEC_ZSTD}) {
+        if (!dowel::codec_available(codec)) continue;
+        auto archive = dowel::compress_blocks(text, codec, 0, 256 << 10);
+        round_trips = round_trips && archive && archive.size() < log.size() / 3 && dowel::decompress_blocks(archive.bytes()).str() == log;
+    }
+    auto empty = dowel::compress_blocks({});
+    suite.assert_test(round_trips && empty && dowel::decompress_blocks(empty.bytes()) && dowel::decompress_blocks(empty.bytes()).empty(),
+        "Block archives round trip with every codec");
+
+    // Reads from the middle, across block edges and off the end
+    auto archive = dowel::compress_blocks(text, DOWEL_CODEC_LZ4, 0, 64 << 10);
+    auto reader = dowel::seekable_archive::open(archive.bytes());
+    bool ranges = reader && reader.content_size() == log.size() && reader.block_count() == (log.size() + 65535) / 65536 &&
+        reader.block_size() == 65536;
+    for (std::uint64_t offset : {std::uint64_t(0), std::uint64_t(65535), std::uint64_t(65536), std::uint64_t(3000000), std::uint64_t(log.size() - 10)}) {
+        for (std::size_t length : {std::size_t(0), std::size_t(1), std::size_t(4096), std::size_t(65536), std::size_t(1 << 20)}) {
+            std::string expected = log.substr(offset, length);
+            ranges = ranges && reader.read(offset, length).str() == expected;
+        }
+    }
+    dowel::arena scratch;
+    auto in_arena = reader.read(scratch, 100000, 200000);
+    ranges = ranges && std::string_view(reinterpret_cast<const char*>(in_arena.data()), in_arena.size()) == log.substr(100000, 200000) &&
+        reader.read_block(40).str() == log.substr(40 * 65536, 65536) &&
+        reader.read_block(reader.block_count() - 1).str() == log.substr((reader.block_count() - 1) * 65536) &&
+        !reader.read_block(reader.block_count()) && !reader.read(log.size() + 1, 1) && reader.read(log.size(), 5).empty();
+    suite.assert_test(ranges, "Seekable reads return any range");
+
+    // Straight from a mapped file
+    std::string dir = make_temp_dir();
+    dowel::storage::write_file(dir + "/sync.log.dwsk", archive.bytes());
+    auto mapped = dowel::storage::map_file(dir + "/sync.log.dwsk", DOWEL_MAP_RANDOM);
+    auto from_file = dowel::seekable_archive::open(mapped.bytes());
+    suite.assert_test(from_file && from_file.read(4000000, 100).str() == log.substr(4000000, 100),
+        "Seekable archive reads from a mapped file");
+    std::filesystem::remove_all(dir);
+
+    std::vector<std::uint8_t> damaged(archive.data(), archive.data() + archive.size());
+    damaged[damaged.size() - 30] ^= 0x40; // a frame size in the table
+    std::vector<std::uint8_t> flipped(archive.data(), archive.data() + archive.size());
+    flipped[1000] ^= 0x40; // inside the first frame
+    auto flipped_reader = dowel::seekable_archive::open(dowel::bytes_view(flipped.data(), flipped.size()));
+    suite.assert_test(!dowel::seekable_archive::open(dowel::bytes_view(damaged.data(), damaged.size())) &&
+        !dowel::seekable_archive::open(dowel::bytes_view(archive.data(), archive.size() - 1)) &&
+        !dowel::compress_blocks(text, DOWEL_CODEC_LZ4, 0, 100) && flipped_reader &&
+        (!flipped_reader.read_block(0) || flipped_reader.read_block(0).size() == 65536) &&
+        flipped_reader.read_block(1).str() == log.substr(65536, 65536),
+        "Damage is confined to the block it hits");
+
+    // Sizes in the trailer must fit the archive: a tiny frame cannot hold a
+    // huge block even if the archive as a whole could hold the total
+    std::string mixed(4096, '\0');
+    for (size_t i = 0; i < 4096; i++) mixed += char((i * 2654435761u) >> 13);
+    auto small = dowel::compress_blocks(dowel::as_bytes(mixed), DOWEL_CODEC_LZ4, 0, 4096);
+    auto forge = [&](std::uint64_t content_size, std::uint32_t block_size) {
+        std::vector<std::uint8_t> forged(small.data(), small.data() + small.size());
+        std::uint8_t* trailer = forged.data() + forged.size() - 20;
+        for (int i = 0; i < 4; i++) {
+            trailer[i] = std::uint8_t(content_size >> (8 * i));
+            trailer[4 + i] = std::uint8_t(content_size >> (32 + 8 * i));
+            trailer[12 + i] = std::uint8_t(block_size >> (8 * i));
+        }
+        return forged;
+    };
+    auto inflated_total = forge(std::uint64_t(300) << 20, 256u << 20);
+    auto inflated_block = forge((std::uint64_t(8) << 20) + 1, 8u << 20);
+    suite.assert_test(small && dowel::seekable_archive::open(small.bytes()) &&
+        !dowel::seekable_archive::open(dowel::bytes_view(inflated_total.data(), inflated_total.size())) &&
+        !dowel::seekable_archive::open(dowel::bytes_view(inflated_block.data(), inflated_block.size())),
+        "Trailer sizes larger than the archive holds are rejected");
+
+    std::vector<std::string> records(200, R"({"type":"message","role":"assistant","model":"small-model-2024","cached":false})");
+    std::vector<dowel::bytes_view> samples;
+    for (const std::string& record : records) samples.push_back(dowel::as_bytes(record));
+    auto dict = dowel::compress_dict::train(samples, 1024);
+    auto with_dict = dowel::compress_blocks(text, DOWEL_CODEC_LZ4, 0, 1 << 20, &dict);
+    suite.assert_test(dict && dowel::decompress_blocks(with_dict.bytes(), &dict).str() == log &&
+        !dowel::decompress_blocks(with_dict.bytes()), "Block archives carry a dictionary");
+}
+
+void test_codec_streams(TestSuite& suite) {
+    std::cout << "\n🚰 Testing Codec Streams\n";
+    std::cout << "------------------------\n";
+
+    std::vector<std::string> messages{""};
+    for (size_t size : {size_t(1), size_t(700), size_t(65536), size_t(200000), size_t(3 << 20)}) {
+        std::string message;
+        for (int i = 0; message.size() < size; i++) {
+            message += "{\"seq\":" + std::to_string(i) + ",\"op\":\"upsert\",\"note\":" + std::to_string(i * 131 % 9973) + "}\n";
+        }
+        message.resize(size);
+        messages.push_back(message);
+    }
+    std::string noise(300000, '\0');
+    for (size_t i = 0; i < noise.size(); i++) noise[i] = char((i * 2654435761u) >> 13);
+    messages.push_back(noise);
+
+    // Every message through one pair of contexts, fed in uneven pieces with a
+    // flush now and then
+    bool round_trips = true;
+    std::string failed;
+    for (dowel_codec_t codec : {DOWEL_CODEC_GZIP, DOWEL_CODEC_LZ4, DOWEL_CODEC_ZSTD}) {
+        if (!dowel::codec_available(codec)) continue;
+        std::string packed, unpacked;
+        auto collect_packed = [&](dowel::bytes_view out) { packed.append(reinterpret_cast<const char*>(out.data()), out.size()); };
+        auto collect_unpacked = [&](dowel::bytes_view out) { unpacked.append(reinterpret_cast<const char*>(out.data()), out.size()); };
+        auto compressor = dowel::codec_context::compressor(codec, 0, collect_packed);
+        auto decompressor = dowel::codec_context::decompressor(codec, collect_unpacked);
+        std::uint32_t seed = 7;
+        for (int round = 0; round < 2; round++) {
+            for (const std::string& message : messages) {
+                packed.clear();
+                unpacked.clear();
+                bool ok = compressor && decompressor;
+                for (size_t at = 0; ok && at < message.size();) {
+                    seed = seed * 1103515245 + 12345;
+                    size_t piece = std::min<size_t>(message.size() - at, seed >> 12 & 0x3ffff);
+                    ok = compressor.feed(std::string_view(message).substr(at, piece)) == DOWEL_SUCCESS &&
+                        (seed & 0x300 || compressor.flush() == DOWEL_SUCCESS);
+                    at += piece;
+                }
+                ok = ok && compressor.finish() == DOWEL_SUCCESS;
+                for (size_t at = 0; ok && at < packed.size();) {
+                    seed = seed * 1103515245 + 12345;
+                    size_t piece = std::min<size_t>(packed.size() - at, 1 + (seed >> 16 & 0x7fff));
+                    ok = decompressor.feed(std::string_view(packed).substr(at, piece)) == DOWEL_SUCCESS;
+                    at += piece;
+                }
+                ok = ok && decompressor.finish() == DOWEL_SUCCESS && unpacked == message;
+                if (!ok) failed += std::to_string(codec) + "/" + std::to_string(message.size()) + " ";
+                round_trips = round_trips && ok;
+            }
+        }
+    }
+    suite.assert_test(round_trips, "Streams round trip many messages through one context", failed);
+
+    // Standard formats: a gzip member and LZ4 frames that decode by themselves
+    std::string log;
+    for (int i = 0; log.size() < 500000; i++) log += "INFO sync: pushed note " + std::to_string(i * 31 % 100003) + "\n";
+    std::string gz, lz;
+    auto to_gz = [&](dowel::bytes_view out) { gz.append(reinterpret_cast<const char*>(out.data()), out.size()); };
+    auto to_lz = [&](dowel::bytes_view out) { lz.append(reinterpret_cast<const char*>(out.data()), out.size()); };
+    auto gzip = dowel::codec_context::compressor(DOWEL_CODEC_GZIP, 6, to_gz);
+    auto lz4 = dowel::codec_context::compressor(DOWEL_CODEC_LZ4, 0, to_lz);
+    gzip.feed(log);
+    lz4.feed(log);
+    bool standard = gzip.finish() == DOWEL_SUCCESS && lz4.finish() == DOWEL_SUCCESS &&
+        dowel::decompress_gzip(dowel::as_bytes(gz)).str() == log && lz.size() < log.size() / 3 &&
+        static_cast<std::uint8_t>(lz[0]) == 0x04 && lz.compare(1, 3, "\x22\x4d\x18") == 0;
+    // Two frames back to back, with a skippable frame between them
+    std::string doubled = lz + std::string("\x50\x2a\x4d\x18\x03\x00\x00\x00xyz", 11) + lz;
+    std::string out;
+    auto to_out = [&](dowel::bytes_view bytes) { out.append(reinterpret_cast<const char*>(bytes.data()), bytes.size()); };
+    auto reader = dowel::codec_context::decompressor(DOWEL_CODEC_LZ4, to_out);
+    standard = standard && reader.feed(doubled) == DOWEL_SUCCESS && reader.finish() == DOWEL_SUCCESS && out == log + log;
+    suite.assert_test(standard, "Streams use the codecs' standard formats");
+
+    // Truncated and damaged streams fail at the latest on finish, then the
+    // context works again
+    bool rejected = true;
+    for (dowel_codec_t codec : {DOWEL_CODEC_GZIP, DOWEL_CODEC_LZ4, DOWEL_CODEC_ZSTD}) {
+        if (!dowel::codec_available(codec)) continue;
+        std::string packed;
+        auto collect = [&](dowel::bytes_view bytes) { packed.append(reinterpret_cast<const char*>(bytes.data()), bytes.size()); };
+        auto compressor = dowel::codec_context::compressor(codec, 0, collect);
+        compressor.feed(std::string_view(log).substr(0, 100000));
+        compressor.finish();
+        std::size_t produced = 0;
+        auto count = [&](dowel::bytes_view bytes) { produced += bytes.size(); };
+        auto decompressor = dowel::codec_context::decompressor(codec, count);
+        for (size_t cut : {size_t(1), size_t(9), packed.size() / 2, packed.size() - 1}) {
+            int fed = decompressor.feed(std::string_view(packed).substr(0, cut));
+            rejected = rejected && (fed != DOWEL_SUCCESS || decompressor.finish() != DOWEL_SUCCESS);
+            decompressor.reset();
+        }
+        for (size_t i = 0; i < 50; i++) {
+            std::string damaged = packed;
+            damaged[(i * 7919) % damaged.size()] ^= char(1 + i % 255);
+            produced = 0;
+            int fed = decompressor.feed(damaged);
+            int finished = decompressor.finish();
+            // A flipped literal can slip past gzip and zstd without checksums;
+            // the output must then still be the right size
+            rejected = rejected && (fed != DOWEL_SUCCESS || finished != DOWEL_SUCCESS || produced == 100000);
+        }
+        produced = 0;
+        rejected = rejected && decompressor.feed(packed) == DOWEL_SUCCESS && decompressor.finish() == DOWEL_SUCCESS && produced == 100000;
+    }
+    suite.assert_test(rejected, "Truncated and corrupt streams are rejected");
+
+    int calls = 0;
+    auto refuse = [&](dowel::bytes_view) { return ++calls < 3 ? DOWEL_SUCCESS : DOWEL_ERROR_STORAGE_ERROR; };
+    auto stubborn = dowel::codec_context::compressor(DOWEL_CODEC_LZ4, 1, refuse);
+    int first = stubborn.feed(noise);
+    int again = stubborn.feed("more");
+    int finished = stubborn.finish();
+    int next = stubborn.feed("next message");
+    std::uint8_t junk[4] = {1, 2, 3, 4};
+    auto junk_reader = dowel::codec_context::decompressor(DOWEL_CODEC_LZ4, refuse);
+    suite.assert_test(first == DOWEL_ERROR_STORAGE_ERROR && again == DOWEL_ERROR_STORAGE_ERROR && finished == DOWEL_ERROR_STORAGE_ERROR && next == DOWEL_SUCCESS &&
+        junk_reader.feed(dowel::bytes_view(junk, 4)) == DOWEL_ERROR_INVALID_PARAMETER &&
+        !dowel::codec_context::compressor(DOWEL_CODEC_LZ4, 12, refuse) &&
+        !dowel::codec_context::decompressor(dowel_codec_t(9), refuse),
+        "Sink errors stick until the message ends");
+}
+
+void test_crypto_kernels(TestSuite& suite) {
+    std::cout << "\n🔐 Testing Crypto Kernels\n";
+    std::cout << "-------------------------\n";
+
+    auto unhex = [](std::string_view hex) {
+        std::vector<std::uint8_t> bytes;
+        for (size_t i = 0; i + 1 < hex.size(); i += 2) bytes.push_back(std::uint8_t(std::stoi(std::string(hex.substr(i, 2)), nullptr, 16)));
+        return bytes;
+    };
+    // Every kernel the CPU has, then with each hardware path switched off in turn
+    const std::vector<std::uint32_t> feature_sets{
+        UINT32_MAX, ~std::uint32_t(DCORE_CPU_VAES), ~std::uint32_t(DCORE_CPU_VAES | DCORE_CPU_AES),
+        ~std::uint32_t(DCORE_CPU_CLMUL), ~std::uint32_t(DCORE_CPU_SHA256), 0};
+
+    // FIPS 180-2 and the GCM specification's AES-256 test cases 13-15
+    std::string million(1000000, 'a');
+    std::vector<std::pair<std::string, std::string>> digests{
+        {"", "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"},
+        {"abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq", "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1"},
+        {million, "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0"}};
+    struct gcm_case {
+        const char *key, *nonce, *plain, *sealed;
+    };
+    const gcm_case gcm_cases[] = {
+        {"0000000000000000000000000000000000000000000000000000000000000000", "000000000000000000000000", "",
+         "530f8afbc74536b9a963b4f1c4cb738b"},
+        {"0000000000000000000000000000000000000000000000000000000000000000", "000000000000000000000000",
+         "00000000000000000000000000000000", "cea7403d4d606b6e074ec5d3baf39d18d0d1c8a799996bf0265b98b5d48ab919"},
+        {"feffe9928665731c6d6a8f9467308308feffe9928665731c6d6a8f9467308308", "cafebabefacedbaddecaf888",
+         "d9313225f88406e5a55909c5aff5269a86a7a9531534f7da2e4c303d8a318a721c3c0c95956809532fcf0e2449a6b525b16aedf5aa0de657ba637b391aafd255",
+         "522dc1f099567d07f47f37a32a84427d643a8cdcbfe5c0c97598a2bd2555d1aa8cb08e48590dbb3da7b08b1056828838c5f61e6393ba7a0abcc9f662898015ad"
+         "b094dac5d93471bdec1a502270e3cc6c"}};
+    bool known = true;
+    std::string failed;
+    for (std::uint32_t features : feature_sets) {
+        dcore_cpu_restrict(features);
+        for (const auto& [text, digest] : digests) {
+            bool ok = to_hex(dowel::sha256(dowel::as_bytes(text)).bytes()) == digest;
+            if (!ok) failed += "sha256/" + std::to_string(text.size()) + " ";
+            known = known && ok;
+        }
+        for (const gcm_case& c : gcm_cases) {
+            auto key_bytes = unhex(c.key), nonce = unhex(c.nonce), plain = unhex(c.plain);
+            dowel_crypto_key_t key{key_bytes.data(), key_bytes.size()};
+            dcore_gcm_t* gcm = dcore_gcm_new(&key);
+            std::vector<std::uint8_t> sealed(plain.size() + 16), opened(plain.size());
+            dcore_gcm_seal(gcm, nonce.data(), plain.data(), plain.size(), sealed.data());
+            bool ok = to_hex(dowel::bytes_view(sealed.data(), sealed.size())) == c.sealed &&
+                dcore_gcm_open(gcm, nonce.data(), sealed.data(), sealed.size(), opened.data()) && opened == plain;
+            if (!ok) failed += "gcm/" + std::to_string(plain.size()) + " ";
+            known = known && ok;
+            dcore_gcm_free(gcm);
+        }
+    }
+    dcore_cpu_restrict(UINT32_MAX);
+    suite.assert_test(known, "Known answers with every kernel", failed);
+
+    // Long and odd sizes reach the wide loops and their tails; each kernel
+    // must match the portable one byte for byte
+    std::string data(70000, '\0');
+    for (size_t i = 0; i < data.size(); i++) data[i] = char((i * 2654435761u) >> 11);
+    std::vector<std::uint8_t> key_bytes(32), nonce(12);
+    for (int i = 0; i < 32; i++) key_bytes[size_t(i)] = std::uint8_t(i * 37 + 1);
+    dowel_crypto_key_t key{key_bytes.data(), key_bytes.size()};
+    bool agree = true;
+    for (size_t size : {size_t(1), size_t(15), size_t(127), size_t(128), size_t(255), size_t(256), size_t(257), size_t(4099), size_t(65536 + 13)}) {
+        auto input = dowel::as_bytes(std::string_view(data).substr(3, size));
+        dcore_cpu_restrict(0);
+        dcore_gcm_t* portable = dcore_gcm_new(&key);
+        std::vector<std::uint8_t> expected(size + 16), sealed(size + 16), opened(size);
+        dcore_gcm_seal(portable, nonce.data(), input.data(), size, expected.data());
+        std::string digest = to_hex(dowel::sha256(input).bytes());
+        for (std::uint32_t features : feature_sets) {
+            dcore_cpu_restrict(features);
+            dcore_gcm_t* gcm = dcore_gcm_new(&key);
+            dcore_gcm_seal(gcm, nonce.data(), input.data(), size, sealed.data());
+            agree = agree && sealed == expected && to_hex(dowel::sha256(input).bytes()) == digest &&
+                dcore_gcm_open(portable, nonce.data(), sealed.data(), sealed.size(), opened.data()) &&
+                dcore_gcm_open(gcm, nonce.data(), expected.data(), expected.size(), opened.data()) &&
+                std::equal(opened.begin(), opened.end(), input.begin());
+            sealed[size / 2] ^= 0x20;
+            agree = agree && !dcore_gcm_open(gcm, nonce.data(), sealed.data(), sealed.size(), opened.data());
+            dcore_gcm_free(gcm);
+        }
+        dcore_gcm_free(portable);
+    }
+    dcore_cpu_restrict(UINT32_MAX);
+    auto vault_key = dowel::crypto_key::generate();
+    auto sealed = vault_key.encrypt(dowel::as_bytes(data));
+    dcore_cpu_restrict(0);
+    auto opened = vault_key.decrypt(sealed.bytes());
+    dcore_cpu_restrict(UINT32_MAX);
+    suite.assert_test(agree && opened.str() == data, "Hardware kernels match the portable ones");
+}
+
+void test_file_watcher(TestSuite& suite) {
+    std::cout << "\n👀 Testing File Watcher\n";
+    std::cout << "------------------------\n";
+
+    std::string dir = make_temp_dir();
+    std::mutex lock;
+    std::vector<std::pair<std::string, dowel_file_event_t>> seen;
+    auto on_event = [&](std::string_view path, dowel_file_event_t event) {
+        std::lock_guard<std::mutex> guard(lock);
+        seen.emplace_back(path, event);
+    };
+    auto has = [&](const std::string& path, dowel_file_event_t event) {
+        std::lock_guard<std::mutex> guard(lock);
+        return std::count(seen.begin(), seen.end(), std::make_pair(path, event));
+    };
+    const int all = DOWEL_FILE_EVENT_CREATED | DOWEL_FILE_EVENT_MODIFIED | DOWEL_FILE_EVENT_DELETED | DOWEL_FILE_EVENT_MOVED;
+
+    dowel_file_watcher_options_t options{};
+    options.recursive = true;
+    auto recursive = dowel::file_watcher::create(dir, all, options, [](const char* path, dowel_file_event_t event, void* data) {
+        (*static_cast<decltype(on_event)*>(data))(std::string_view(path), event);
+    }, &on_event);
+    recursive.start();
+    mkdir((dir + "/a").c_str(), 0755);
+    mkdir((dir + "/a/b").c_str(), 0755);
+    write_raw(dir + "/a/b/deep.txt", "deep");
+    bool deep = eventually([&] {
+        return has(dir + "/a", DOWEL_FILE_EVENT_CREATED) == 1 && has(dir + "/a/b/deep.txt", DOWEL_FILE_EVENT_CREATED) == 1;
+    });
+    suite.assert_test(recursive && deep, "Recursive watcher follows new subdirectories");
+    recursive = dowel::file_watcher();
+
+    // A save storm and a temp-file-and-rename save each arrive as one MODIFIED
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        seen.clear();
+    }
+    options.coalesce_ms = 100;
+    auto coalescing = dowel::file_watcher::create(dir, all, options, [](const char* path, dowel_file_event_t event, void* data) {
+        (*static_cast<decltype(on_event)*>(data))(std::string_view(path), event);
+    }, &on_event);
+    coalescing.start();
+    for (int i = 0; i < 20; i++) write_raw(dir + "/a/storm.txt", std::string(size_t(i), 's'));
+    write_raw(dir + "/a/b/.deep.txt.tmp", "replaced");
+    rename((dir + "/a/b/.deep.txt.tmp").c_str(), (dir + "/a/b/deep.txt").c_str());
+    bool settled = eventually([&] { return has(dir + "/a/b/deep.txt", DOWEL_FILE_EVENT_MODIFIED) == 1; });
+    std::this_thread::sleep_for(std::chrono::milliseconds(150));
+    size_t total;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        total = seen.size();
+    }
+    suite.assert_test(settled && has(dir + "/a/storm.txt", DOWEL_FILE_EVENT_CREATED) == 1 && total == 2,
+        "Coalescing folds bursts into their net change", std::to_string(total) + " events");
+    coalescing = dowel::file_watcher();
+
+    std::atomic<size_t> batches{0}, records{0};
+    auto on_batch = [&](std::span<const dowel_file_event_record_t> batch) {
+        batches.fetch_add(1);
+        records.fetch_add(batch.size());
+    };
+    options.coalesce_ms = 50;
+    auto batched = dowel::file_watcher::create_batched(dir, DOWEL_FILE_EVENT_CREATED, options, on_batch);
+    batched.start();
+    for (int i = 0; i < 50; i++) write_raw(dir + "/a/b/f" + std::to_string(i), "x");
+    bool delivered = eventually([&] { return records.load() == 50; });
+    batched.stop();
+    suite.assert_test(delivered && batches.load() < 50, "Batch callback receives events together",
+        std::to_string(records.load()) + " records in " + std::to_string(batches.load()) + " batches");
+
+    suite.assert_test(!dowel::file_watcher::create(dir + "/missing", all, options, nullptr, nullptr) &&
+        !dowel::file_watcher::create(dir + "/missing", all, on_event), "Watching a missing path fails");
+
+    std::filesystem::remove_all(dir);
+}
+
+int main() {
+    std::cout << "🚀 Dowel-Steek Core Test Suite\n";
+    std::cout << "================================\n";
+
+    TestSuite suite;
+    dowel::core_session session;
+    suite.assert_test(static_cast<bool>(session), "Core initialization",
+        std::string(dowel::error_message(session.status())));
+
+    test_sdk_handles(suite);
+    test_config_store(suite);
+    test_config_handles(suite);
+    test_logging(suite);
+    test_structured_logging(suite);
+    test_allocator(suite);
+    test_arena(suite);
+    test_file_views(suite);
+    test_storage_batch(suite);
+    test_file_cache(suite);
+    test_durable_writes(suite);
+    test_streams(suite);
+    test_directory_scan(suite);
+    test_metadata_index(suite);
+    test_file_watcher(suite);
+    test_json_parser(suite);
+    test_json_lazy(suite);
+    test_json_writer(suite);
+    test_compression_codecs(suite);
+    test_block_compression(suite);
+    test_codec_streams(suite);
+    test_crypto_kernels(suite);
+    test_async(suite);
+    test_async_graph(suite);
+    test_coroutines(suite);
+
+    suite.print_summary();
+    return suite.all_passed() ? 0 : 1;
+}
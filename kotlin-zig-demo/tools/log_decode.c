@@ -0,0 +1,296 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+
+#include "../core/log_format.h"
+
+// Offline decoder for binary structured logs (dowel_log_binary_open).
+// Usage: dowel_log_decode [-n] <file>
+//   -n  omit timestamps
+// Prints one "[time] [LEVEL] module: message" line per entry, in file order.
+
+typedef struct {
+    bool defined;
+    uint8_t arg_count;
+    uint8_t types[DCORE_BLOG_MAX_ARGS];
+    char* module;
+    char* format;
+} site_t;
+
+static const char* const level_names[] = { "TRACE", "DEBUG", "INFO", "WARN", "ERROR", "FATAL" };
+
+static site_t* sites;
+static uint32_t site_capacity;
+
+// The writer numbers sites from 1 up, one per call site; a larger id can
+// only come from a corrupt file
+#define MAX_SITE_ID (1u << 24)
+
+static uint8_t* read_file(const char* path, size_t* size) {
+    FILE* file = fopen(path, "rb");
+    if (!file) return NULL;
+
+    uint8_t* data = NULL;
+    size_t used = 0, capacity = 0, n;
+    do {
+        if (used == capacity) {
+            capacity = capacity ? capacity * 2 : 64 * 1024;
+            uint8_t* grown = realloc(data, capacity);
+            if (!grown) {
+                free(data);
+                fclose(file);
+                return NULL;
+            }
+            data = grown;
+        }
+        n = fread(data + used, 1, capacity - used, file);
+        used += n;
+    } while (n > 0);
+
+    fclose(file);
+    *size = used;
+    return data;
+}
+
+static char* copy_string(const uint8_t** p, const uint8_t* end) {
+    uint16_t length;
+    if (end - *p < (ptrdiff_t)sizeof(length)) return NULL;
+    memcpy(&length, *p, sizeof(length));
+    *p += sizeof(length);
+    if (end - *p < length) return NULL;
+
+    char* str = malloc((size_t)length + 1);
+    if (!str) return NULL;
+    memcpy(str, *p, length);
+    str[length] = '\0';
+    *p += length;
+    return str;
+}
+
+static bool read_site(const uint8_t* p, const uint8_t* end) {
+    uint32_t id;
+    if (end - p < (ptrdiff_t)(sizeof(id) + 1)) return false;
+    memcpy(&id, p, sizeof(id));
+    p += sizeof(id);
+    if (id > MAX_SITE_ID) return false;
+
+    if (id >= site_capacity) {
+        uint32_t capacity = site_capacity ? site_capacity : 64;
+        while (capacity <= id) capacity *= 2;
+        site_t* grown = realloc(sites, capacity * sizeof(*grown));
+        if (!grown) return false;
+        memset(grown + site_capacity, 0, (capacity - site_capacity) * sizeof(*grown));
+        sites = grown;
+        site_capacity = capacity;
+    }
+
+    site_t* site = &sites[id];
+    if (site->defined) return true; // repeated after a reopen or a retry
+
+    site->arg_count = *p++;
+    if (site->arg_count > DCORE_BLOG_MAX_ARGS || end - p < site->arg_count) return false;
+    memcpy(site->types, p, site->arg_count);
+    p += site->arg_count;
+
+    site->module = copy_string(&p, end);
+    site->format = copy_string(&p, end);
+    site->defined = site->module && site->format;
+    return site->defined;
+}
+
+typedef struct {
+    char* data;
+    size_t length;
+    size_t capacity;
+} text_t;
+
+static void append(text_t* text, const char* data, size_t length) {
+    if (text->length + length + 1 > text->capacity) {
+        size_t capacity = text->capacity ? text->capacity : 256;
+        while (text->length + length + 1 > capacity) capacity *= 2;
+        char* grown = realloc(text->data, capacity);
+        if (!grown) return;
+        text->data = grown;
+        text->capacity = capacity;
+    }
+    memcpy(text->data + text->length, data, length);
+    text->length += length;
+    text->data[text->length] = '\0';
+}
+
+// Copies literal text, turning "%%" into "%"
+static void append_literal(text_t* text, const char* start, const char* end) {
+    while (start < end) {
+        const char* percent = memchr(start, '%', (size_t)(end - start));
+        if (!percent) {
+            append(text, start, (size_t)(end - start));
+            return;
+        }
+        append(text, start, (size_t)(percent - start) + 1);
+        start = percent + 2;
+    }
+}
+
+// Formats one argument with the original flags, width and precision
+static bool append_value(text_t* text, const dcore_blog_spec_t* spec, const uint8_t** p, const uint8_t* end) {
+    char format[64];
+    size_t prefix = 0;
+    for (size_t i = 0; i < spec->length - 1 && prefix < sizeof(format) - 4; i++) {
+        char c = spec->start[i];
+        if (!strchr("hlzjtqL", c)) format[prefix++] = c;
+    }
+
+    char buffer[128];
+    char* out = buffer;
+    int length;
+
+    if (spec->type == DCORE_BLOG_ARG_STRING) {
+        char* str = copy_string(p, end);
+        if (!str) return false;
+        memcpy(format + prefix, "s", 2);
+        length = snprintf(NULL, 0, format, str);
+        if (length >= (int)sizeof(buffer) && !(out = malloc((size_t)length + 1))) {
+            free(str);
+            return false;
+        }
+        snprintf(out, (size_t)length + 1, format, str);
+        free(str);
+    } else {
+        uint64_t bits;
+        if (end - *p < (ptrdiff_t)sizeof(bits)) return false;
+        memcpy(&bits, *p, sizeof(bits));
+        *p += sizeof(bits);
+
+        if (spec->type == DCORE_BLOG_ARG_DOUBLE) {
+            double value;
+            memcpy(&value, &bits, sizeof(value));
+            format[prefix] = spec->conversion;
+            format[prefix + 1] = '\0';
+            length = snprintf(buffer, sizeof(buffer), format, value);
+        } else if (spec->type == DCORE_BLOG_ARG_POINTER) {
+            memcpy(format + prefix, "p", 2);
+            length = snprintf(buffer, sizeof(buffer), format, (void*)(uintptr_t)bits);
+        } else if (spec->conversion == 'c') {
+            memcpy(format + prefix, "c", 2);
+            length = snprintf(buffer, sizeof(buffer), format, (int)bits);
+        } else {
+            // Stored sign- or zero-extended from the original width, so long long
+            // gives the same digits
+            format[prefix] = 'l';
+            format[prefix + 1] = 'l';
+            format[prefix + 2] = spec->conversion;
+            format[prefix + 3] = '\0';
+            length = snprintf(buffer, sizeof(buffer), format, (long long)bits);
+        }
+        if (length >= (int)sizeof(buffer)) length = sizeof(buffer) - 1;
+    }
+
+    if (length > 0) append(text, out, (size_t)length);
+    if (out != buffer) free(out);
+    return true;
+}
+
+static bool print_entry(const uint8_t* p, const uint8_t* end, int level, bool timestamps) {
+    uint32_t id;
+    uint64_t timestamp;
+    if (end - p < (ptrdiff_t)(sizeof(id) + sizeof(timestamp))) return false;
+    memcpy(&id, p, sizeof(id));
+    memcpy(&timestamp, p + sizeof(id), sizeof(timestamp));
+    p += sizeof(id) + sizeof(timestamp);
+
+    if (id >= site_capacity || !sites[id].defined) {
+        printf("[%s] <unknown site %u>\n", level_names[level % 6], id);
+        return true;
+    }
+    site_t* site = &sites[id];
+
+    text_t text = {0};
+    append(&text, "", 0);
+    const char* cursor = site->format;
+    const char* literal = cursor;
+    dcore_blog_spec_t spec;
+    for (int i = 0; i < site->arg_count && dcore_blog_next_spec(&cursor, &spec) > 0; i++) {
+        append_literal(&text, literal, spec.start);
+        if (!append_value(&text, &spec, &p, end)) {
+            free(text.data);
+            return false;
+        }
+        literal = cursor;
+    }
+    append_literal(&text, literal, literal + strlen(literal));
+
+    if (timestamps) {
+        time_t seconds = (time_t)(timestamp / 1000000000ULL);
+        struct tm tm;
+        gmtime_r(&seconds, &tm);
+        char when[32];
+        strftime(when, sizeof(when), "%Y-%m-%dT%H:%M:%S", &tm);
+        printf("%s.%09lluZ ", when, (unsigned long long)(timestamp % 1000000000ULL));
+    }
+    if (site->module[0]) {
+        printf("[%s] %s: %s\n", level_names[level % 6], site->module, text.data ? text.data : "");
+    } else {
+        printf("[%s] %s\n", level_names[level % 6], text.data ? text.data : "");
+    }
+    free(text.data);
+    return true;
+}
+
+// Visits each record; returns false on a truncated or malformed file
+static bool for_each_record(const uint8_t* data, size_t size, uint8_t kind, bool timestamps) {
+    const uint8_t* p = data + DCORE_BLOG_MAGIC_SIZE;
+    const uint8_t* end = data + size;
+
+    while (end - p >= DCORE_BLOG_FRAME_SIZE) {
+        uint16_t record_size;
+        memcpy(&record_size, p, sizeof(record_size));
+        if (record_size < DCORE_BLOG_FRAME_SIZE || end - p < record_size) return false;
+
+        const uint8_t* body = p + DCORE_BLOG_FRAME_SIZE;
+        const uint8_t* record_end = p + record_size;
+        if (p[2] == kind) {
+            bool ok = kind == DCORE_BLOG_SITE ? read_site(body, record_end)
+                                              : print_entry(body, record_end, p[3], timestamps);
+            if (!ok) return false;
+        }
+        p = record_end;
+    }
+    return p == end;
+}
+
+int main(int argc, char** argv) {
+    bool timestamps = true;
+    const char* path = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0) timestamps = false;
+        else path = argv[i];
+    }
+    if (!path) {
+        fprintf(stderr, "Usage: %s [-n] <file>\n", argv[0]);
+        return 2;
+    }
+
+    size_t size = 0;
+    uint8_t* data = read_file(path, &size);
+    if (!data) {
+        fprintf(stderr, "Cannot read %s\n", path);
+        return 1;
+    }
+    if (size < DCORE_BLOG_MAGIC_SIZE || memcmp(data, DCORE_BLOG_MAGIC, DCORE_BLOG_MAGIC_SIZE) != 0) {
+        fprintf(stderr, "%s is not a binary dowel log\n", path);
+        free(data);
+        return 1;
+    }
+
+    // Sites first: an entry can be written before its definition
+    bool ok = for_each_record(data, size, DCORE_BLOG_SITE, timestamps) &&
+              for_each_record(data, size, DCORE_BLOG_ENTRY, timestamps);
+    if (!ok) fprintf(stderr, "%s: truncated or corrupt record\n", path);
+
+    free(data);
+    return ok ? 0 : 1;
+}
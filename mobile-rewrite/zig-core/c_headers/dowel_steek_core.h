@@ -47,7 +47,43 @@ int dowel_config_set_int(const char* path, int64_t value);
 int dowel_config_set_bool(const char* path, bool value);
 int dowel_config_set_float(const char* path, double value);
 
-// Logging functions
+// Pre-resolved configuration keys for hot paths. Resolving hashes the path
+// once; the handle then reads and writes with an indexed load. Keys that
+// were never set can be resolved and read as the default until they are.
+// Handles stay valid until dowel_core_shutdown. 0 is never a valid handle.
+typedef uint32_t dowel_config_key_t;
+
+#define DOWEL_CONFIG_INVALID_KEY 0
+
+dowel_config_key_t dowel_config_resolve(const char* path);
+
+const char* dowel_config_key_get_string(dowel_config_key_t key, const char* default_value);
+int64_t dowel_config_key_get_int(dowel_config_key_t key, int64_t default_value);
+bool dowel_config_key_get_bool(dowel_config_key_t key, bool default_value);
+double dowel_config_key_get_float(dowel_config_key_t key, double default_value);
+
+int dowel_config_key_set_string(dowel_config_key_t key, const char* value);
+int dowel_config_key_set_int(dowel_config_key_t key, int64_t value);
+int dowel_config_key_set_bool(dowel_config_key_t key, bool value);
+int dowel_config_key_set_float(dowel_config_key_t key, double value);
+
+// Incremented by every write to the key. Compare against a saved value to
+// detect changes without reading the value itself.
+uint32_t dowel_config_key_generation(dowel_config_key_t key);
+
+// Logging functions. Entries are queued per thread and written by a
+// background thread; call dowel_log_flush to wait for them. FATAL entries are
+// flushed before the call returns. Entries are dropped, and counted in
+// dowel_log_metrics_t, if a thread logs faster than they can be written.
+typedef enum {
+    DOWEL_LOG_TRACE = 0,
+    DOWEL_LOG_DEBUG = 1,
+    DOWEL_LOG_INFO = 2,
+    DOWEL_LOG_WARN = 3,
+    DOWEL_LOG_ERROR = 4,
+    DOWEL_LOG_FATAL = 5
+} dowel_log_level_t;
+
 void dowel_log_trace(const char* module, const char* message);
 void dowel_log_debug(const char* module, const char* message);
 void dowel_log_info(const char* module, const char* message);
@@ -57,6 +93,58 @@ void dowel_log_fatal(const char* module, const char* message);
 void dowel_log_set_level(int level);
 void dowel_log_flush(void);
 
+// Structured logging with deferred formatting. Each call site registers its
+// printf-style format once; after that a call only stores the site id, a
+// timestamp and the raw arguments into a binary log, which the
+// dowel_log_decode tool formats offline. Strings are copied (up to 1024
+// bytes). Without an open binary log, or for formats that cannot be deferred
+// ('*' widths, %n, long double), the line is formatted and written as text.
+typedef struct {
+    const char* module;
+    const char* format;
+    int level;
+    void* state; // owned by the core, NULL until first use
+} dowel_log_site_t;
+
+int dowel_log_binary_open(const char* path);
+void dowel_log_binary_close(void);
+void dowel_log_structured(dowel_log_site_t* site, ...);
+
+#if defined(__GNUC__) || defined(__clang__)
+__attribute__((format(printf, 1, 2)))
+#endif
+static inline void dowel_log_check_format(const char* format, ...) { (void)format; }
+
+// The format and module must be string literals
+#define DOWEL_LOG_STRUCTURED(level, module, format, ...)                                   \
+    do {                                                                                   \
+        static dowel_log_site_t dowel_log_site_ = { (module), (format), (level), NULL }; \
+        if (0) dowel_log_check_format(format, ##__VA_ARGS__);                              \
+        dowel_log_structured(&dowel_log_site_, ##__VA_ARGS__);                            \
+    } while (0)
+
+// Scratch arenas for per-frame or per-request data. The *_in variants below
+// allocate their results (buffer headers included) in the arena instead of
+// on the heap; those results must not be passed to dowel_free_buffer or
+// dowel_free_string_array and stay valid until the arena is reset or
+// destroyed. An arena is not thread-safe: use one per thread.
+typedef struct dowel_arena dowel_arena_t;
+
+// chunk_size 0 selects the default of 64 KiB. Larger allocations get their
+// own chunk, which is released by the next reset.
+dowel_arena_t* dowel_arena_create(size_t chunk_size);
+void* dowel_arena_alloc(dowel_arena_t* arena, size_t size);
+char* dowel_arena_strdup(dowel_arena_t* arena, const char* str);
+#if defined(__GNUC__) || defined(__clang__)
+__attribute__((format(printf, 2, 3)))
+#endif
+char* dowel_arena_format(dowel_arena_t* arena, const char* format, ...);
+void dowel_arena_reset(dowel_arena_t* arena);
+void dowel_arena_destroy(dowel_arena_t* arena);
+
+// Bytes allocated since the last reset
+size_t dowel_arena_used(const dowel_arena_t* arena);
+
 // Storage functions
 typedef struct {
     uint8_t* data;
@@ -64,19 +152,222 @@ typedef struct {
 } dowel_buffer_t;
 
 dowel_buffer_t* dowel_storage_read_file(const char* path);
+dowel_buffer_t* dowel_storage_read_file_in(dowel_arena_t* arena, const char* path);
 int dowel_storage_write_file(const char* path, const uint8_t* data, size_t size);
 int dowel_storage_delete_file(const char* path);
 bool dowel_storage_file_exists(const char* path);
 int dowel_storage_create_directory(const char* path);
 char** dowel_storage_list_directory(const char* path, size_t* count);
+char** dowel_storage_list_directory_in(dowel_arena_t* arena, const char* path, size_t* count);
 int64_t dowel_storage_get_file_size(const char* path);
 int64_t dowel_storage_get_file_modtime(const char* path);
 
+// Write modes. dowel_storage_write_file is DOWEL_WRITE_FAST.
+typedef enum {
+    // Rewrites the file in place without syncing: fastest, but a crash can
+    // leave it empty or partly written
+    DOWEL_WRITE_FAST = 0,
+    // Writes a temp file, syncs it, renames it over the target and syncs the
+    // directory. After a crash the file holds either the old or the new
+    // contents; once the call returns, the new ones survive power loss.
+    DOWEL_WRITE_ATOMIC = 1,
+    // As ATOMIC, but concurrent writers share one commit: their syncs overlap
+    // and each directory is synced once per group. Returns once durable.
+    // "storage.group_commit_us" makes a commit wait for more writers first.
+    DOWEL_WRITE_GROUP = 2,
+} dowel_write_mode_t;
+
+int dowel_storage_write_file_mode(const char* path, const uint8_t* data, size_t size, int mode);
+
+// Read-only memory-mapped view of a file: no copy, pages load on first touch.
+// Views are refcounted; each retain needs a matching release, and the last
+// release unmaps. A view is not a snapshot: other writers show through, and
+// touching pages past the end of a file truncated while mapped raises
+// SIGBUS, so map files that are replaced atomically, not rewritten in place.
+// Files up to 64 KB are read into the view instead, which is cheaper.
+typedef struct {
+    const uint8_t* data;
+    size_t size;
+} dowel_file_view_t;
+
+typedef enum {
+    DOWEL_MAP_NORMAL = 0,
+    DOWEL_MAP_SEQUENTIAL = 1,
+    DOWEL_MAP_RANDOM = 2,
+    DOWEL_MAP_WILLNEED = 4 // combinable with either access pattern
+} dowel_map_advice_t;
+
+dowel_file_view_t* dowel_storage_map_file(const char* path, int advice);
+dowel_file_view_t* dowel_file_view_retain(dowel_file_view_t* view);
+void dowel_file_view_release(dowel_file_view_t* view);
+// Re-advises part of a view, e.g. WILLNEED ahead of a range about to be read
+int dowel_file_view_advise(dowel_file_view_t* view, size_t offset, size_t length, int advice);
+
+// Batched storage. A batch goes through io_uring where the kernel allows it,
+// so N files cost a few syscalls rather than a few per file; otherwise (or
+// with "storage.io_uring" set to false) its requests run in parallel on the
+// task pool. Requests in one batch should not touch the same file.
+typedef enum {
+    DOWEL_IO_READ = 0,  // whole file into data
+    DOWEL_IO_WRITE = 1, // replace the file with write_data
+    DOWEL_IO_STAT = 2,  // size, modtime and type into stat
+} dowel_io_op_t;
+
+typedef struct {
+    int64_t size; // -1 if the entry could not be stat-ed
+    int64_t modtime;
+    bool is_directory;
+} dowel_file_stat_t;
+
+typedef struct {
+    dowel_io_op_t op;
+    const char* path;
+    const uint8_t* write_data;
+    size_t write_size;
+
+    // Results, filled by dowel_storage_submit
+    int status;
+    dowel_buffer_t* data; // READ; free with dowel_free_buffer
+    dowel_file_stat_t stat;
+} dowel_io_request_t;
+
+// Returns how many requests failed (see each status), or a negative error
+// code if the batch is malformed and nothing ran
+int dowel_storage_submit(dowel_io_request_t* requests, size_t count);
+// As above with READ results allocated in the arena (not freed individually)
+int dowel_storage_submit_in(dowel_arena_t* arena, dowel_io_request_t* requests, size_t count);
+
+typedef struct {
+    char* name;
+    dowel_file_stat_t stat;
+} dowel_dir_entry_t;
+
+// Lists a directory and stats every entry (symlinks themselves, not their
+// targets) in one batch
+dowel_dir_entry_t* dowel_storage_stat_directory(const char* path, size_t* count);
+void dowel_storage_free_dir_entries(dowel_dir_entry_t* entries, size_t count);
+
+// "io_uring" or "threads": the backend the calling thread's batches use
+const char* dowel_storage_backend(void);
+
+// Recursive directory scan. Subdirectories are read in parallel on the task
+// pool, and the whole result is one allocation: a table of fixed-size entries
+// whose paths (relative to the root, '/'-separated, NUL-terminated) sit
+// together in one string block. Entries come in no particular order.
+// Symlinks are reported, never followed; unreadable subdirectories are
+// skipped and counted.
+typedef enum {
+    DOWEL_ENTRY_FILE = 0,
+    DOWEL_ENTRY_DIRECTORY = 1,
+    DOWEL_ENTRY_SYMLINK = 2,
+    DOWEL_ENTRY_OTHER = 3,
+} dowel_entry_type_t;
+
+typedef struct {
+    int64_t size;
+    int64_t modtime;
+    uint32_t path_offset; // into dowel_scan_result_t.paths
+    uint16_t path_length;
+    uint8_t type;         // dowel_entry_type_t
+    uint8_t depth;        // 0 for entries directly under the root, capped at 255
+} dowel_scan_entry_t;
+
+typedef struct {
+    const dowel_scan_entry_t* entries;
+    size_t count;
+    const char* paths;
+    size_t skipped_directories;
+} dowel_scan_result_t;
+
+typedef struct {
+    // Filters on the entry name, applied during the scan so rejected files
+    // are never stat-ed. pattern is an fnmatch glob ("IMG_*.jpg"); extensions
+    // are matched without the dot and ignoring case. NULL/0 accept anything.
+    const char* pattern;
+    const char* const* extensions;
+    size_t extension_count;
+    // Directories are always descended; this also lists them (unfiltered)
+    bool include_directories;
+    // Levels below the root to descend; 0 for no limit
+    int max_depth;
+} dowel_scan_options_t;
+
+// options may be NULL to list every non-directory entry
+dowel_scan_result_t* dowel_storage_scan(const char* root, const dowel_scan_options_t* options);
+void dowel_storage_free_scan(dowel_scan_result_t* result);
+
+// Cached reads. Whole files are kept in a bounded in-memory cache (the
+// "storage.cache_bytes" config value, 64 MB by default, 0 to disable) and
+// handed out as views that share the cached copy; release them as usual.
+// Files larger than the whole budget are read but not cached.
+// Writes and deletes through this API drop the cached copy. Changes made
+// outside it are not seen until dowel_storage_cache_invalidate.
+dowel_file_view_t* dowel_storage_read_cached(const char* path);
+void dowel_storage_cache_invalidate(const char* path);
+void dowel_storage_cache_clear(void);
+
+typedef struct {
+    uint64_t total_reads;
+    uint64_t total_writes;
+    uint64_t bytes_read;
+    uint64_t bytes_written;
+    uint64_t cache_hits;
+    uint64_t cache_misses;
+    uint64_t cache_evictions;
+    uint64_t cache_rejections; // loaded but not admitted: too rare or too large
+    uint64_t cached_files;
+    size_t cached_bytes; // file data plus bookkeeping
+} dowel_storage_metrics_t;
+
+dowel_storage_metrics_t dowel_storage_get_metrics(void);
+
+// Metadata index. While open, dowel_storage_file_exists, get_file_size and
+// get_file_modtime answer paths under root from memory instead of calling
+// stat. Paths must be spelled with root as passed here, e.g. root + "/a/b";
+// other spellings, symlinks and paths outside root still stat. Changes made
+// through this API show at once; changes made by other processes show once
+// the shared file watcher delivers them, usually within milliseconds.
+// With a snapshot path the index is saved there by save and close, and the
+// next open loads it and is usable before rescanning the tree in the
+// background; without one, open scans the tree before returning.
+// dowel_core_shutdown closes the index.
+int dowel_storage_index_open(const char* root, const char* snapshot_path);
+int dowel_storage_index_save(void);
+void dowel_storage_index_close(void);
+
+typedef struct {
+    uint64_t entries;
+    uint64_t hits;      // lookups answered from memory
+    uint64_t fallbacks; // lookups that had to stat
+    bool from_snapshot;
+    bool ready;         // the tree has been scanned since open
+} dowel_storage_index_stats_t;
+
+dowel_storage_index_stats_t dowel_storage_index_get_stats(void);
+
 // Memory management for returned data
 void dowel_free_buffer(dowel_buffer_t* buffer);
 void dowel_free_string(char* string);
 void dowel_free_string_array(char** strings, size_t count);
 
+// General-purpose allocation for bindings. Blocks up to 4096 bytes come from
+// per-thread size-class pools; larger ones from the system allocator. Memory
+// may be freed from any thread. Freeing a block twice is undefined.
+void* dowel_malloc(size_t size);
+void dowel_free(void* ptr);
+
+// One entry per size class, then one for allocations above 4096 bytes
+typedef struct {
+    size_t block_size;     // 0 for the large allocation entry
+    uint64_t allocations;
+    uint64_t frees;
+    uint64_t live_blocks;
+    size_t reserved_bytes; // pooled memory for the class; live bytes for large allocations
+} dowel_alloc_class_stats_t;
+
+// Fills up to max entries and returns the number available
+size_t dowel_alloc_get_stats(dowel_alloc_class_stats_t* stats, size_t max);
+
 // System information functions
 float dowel_system_get_battery_level(void);
 const char* dowel_system_get_battery_state(void);
@@ -146,11 +437,56 @@ typedef struct {
 int dowel_crypto_init(void);
 void dowel_crypto_shutdown(void);
 dowel_buffer_t* dowel_crypto_hash_sha256(const uint8_t* data, size_t size);
+dowel_buffer_t* dowel_crypto_hash_sha256_in(dowel_arena_t* arena, const uint8_t* data, size_t size);
 dowel_crypto_key_t* dowel_crypto_generate_key(void);
 dowel_buffer_t* dowel_crypto_encrypt(const dowel_crypto_key_t* key, const uint8_t* data, size_t size);
 dowel_buffer_t* dowel_crypto_decrypt(const dowel_crypto_key_t* key, const uint8_t* encrypted_data, size_t size);
+dowel_buffer_t* dowel_crypto_encrypt_in(dowel_arena_t* arena, const dowel_crypto_key_t* key,
+                                        const uint8_t* data, size_t size);
+dowel_buffer_t* dowel_crypto_decrypt_in(dowel_arena_t* arena, const dowel_crypto_key_t* key,
+                                        const uint8_t* encrypted_data, size_t size);
 void dowel_crypto_free_key(dowel_crypto_key_t* key);
 
+// Streams move a file through caller-supplied buffers, so memory stays
+// bounded by the chunk size however large the file is. Reads read ahead and
+// writes are written behind in chunk-sized steps. Optional transforms:
+// gzip (standard framing, readable by dowel_decompress_gzip) and AES-256-GCM
+// in 64 KB authenticated segments (a stream format, not the
+// dowel_crypto_encrypt layout). Writes compress before encrypting; a read
+// stream needs the same options as the write that produced the file.
+typedef struct dowel_stream dowel_stream_t;
+
+typedef enum {
+    DOWEL_STREAM_READ = 0,
+    DOWEL_STREAM_WRITE = 1, // creates or truncates the file
+} dowel_stream_mode_t;
+
+typedef struct {
+    size_t chunk_size;             // 0 for 256 KB
+    bool gzip;
+    const dowel_crypto_key_t* key; // encrypt or decrypt with it, or NULL
+} dowel_stream_options_t;
+
+typedef enum {
+    DOWEL_SEEK_SET = 0,
+    DOWEL_SEEK_CUR = 1,
+    DOWEL_SEEK_END = 2,
+} dowel_seek_origin_t;
+
+// options may be NULL for a plain stream
+dowel_stream_t* dowel_stream_open(const char* path, dowel_stream_mode_t mode, const dowel_stream_options_t* options);
+// Fills buffer unless the data ends first; returns the bytes read, 0 at the
+// end, or a negative error (after which the stream only reports that error).
+// Bytes read before an error are returned first; the error comes next call.
+int64_t dowel_stream_read(dowel_stream_t* stream, uint8_t* buffer, size_t size);
+// Returns size or a negative error
+int64_t dowel_stream_write(dowel_stream_t* stream, const uint8_t* data, size_t size);
+// Plain streams only; returns the new position or a negative error
+int64_t dowel_stream_seek(dowel_stream_t* stream, int64_t offset, int whence);
+// Flushes a write stream (finishing any transforms) and frees the stream.
+// Returns the first error the stream hit, if any.
+int dowel_stream_close(dowel_stream_t* stream);
+
 // Performance monitoring
 typedef struct {
     uint64_t total_entries;
@@ -178,16 +514,81 @@ bool dowel_platform_is_desktop(void);
 const char* dowel_error_get_message(int error_code);
 void dowel_error_set_callback(void (*callback)(int error_code, const char* message));
 
-// Threading and async support
+// Threading and async support. Tasks run on a work-stealing pool with one
+// worker per CPU (or the "async.worker_threads" config value, read when the
+// first task is spawned). Callbacks should not block for long: a blocked
+// callback holds a worker. dowel_async_is_complete is a plain atomic load,
+// and waiting from inside a task runs other queued tasks meanwhile.
 typedef void (*dowel_callback_t)(void* user_data);
 typedef struct dowel_task dowel_task_t;
 
+#define DOWEL_ASYNC_ANY_WORKER -1
+
 dowel_task_t* dowel_async_spawn(dowel_callback_t callback, void* user_data);
 bool dowel_async_is_complete(const dowel_task_t* task);
 void dowel_async_wait(dowel_task_t* task);
 void dowel_async_cancel(dowel_task_t* task);
 void dowel_async_free_task(dowel_task_t* task);
 
+// Prefers running the task on the given worker (0..count-1), e.g. to keep
+// work on one file or cache together. Idle workers may still take it.
+dowel_task_t* dowel_async_spawn_on(int worker, dowel_callback_t callback, void* user_data);
+int dowel_async_worker_count(void);
+
+// Index of the calling worker, or DOWEL_ASYNC_ANY_WORKER off the pool
+int dowel_async_current_worker(void);
+
+// Cancelling a pending task drops it. A running task is not interrupted;
+// long callbacks should poll this and return early.
+bool dowel_async_cancel_requested(void);
+
+// Continuations. The returned task runs once every antecedent has finished
+// (NULL entries are ignored); if any antecedent is cancelled, it is cancelled
+// too and so are its own continuations. when_all with a NULL callback is a
+// plain join. Antecedents may be freed before their continuations run.
+dowel_task_t* dowel_async_then(dowel_task_t* antecedent, dowel_callback_t callback, void* user_data);
+dowel_task_t* dowel_async_when_all(dowel_task_t* const* tasks, size_t count,
+                                   dowel_callback_t callback, void* user_data);
+// As then, but runs whether the antecedent completed or was cancelled
+dowel_task_t* dowel_async_finally(dowel_task_t* antecedent, dowel_callback_t callback, void* user_data);
+
+// Drops the caller's handle without waiting; the task still runs
+void dowel_async_detach(dowel_task_t* task);
+
+// Task graphs: named nodes plus dependency edges, launched as one unit. Each
+// node starts as soon as its dependencies finish; a launch with a cycle fails
+// with DOWEL_ERROR_INVALID_PARAMETER. After a run, the stats give wall time,
+// summed node time and the critical path - the dependent chain with the
+// largest summed run time, i.e. the nodes worth speeding up.
+typedef struct dowel_task_graph dowel_task_graph_t;
+
+typedef struct {
+    int64_t wall_ns;
+    int64_t work_ns;
+    int64_t critical_path_ns;
+    size_t critical_path_nodes;
+} dowel_graph_stats_t;
+
+dowel_task_graph_t* dowel_graph_create(void);
+void dowel_graph_destroy(dowel_task_graph_t* graph);
+
+// Returns the node id (>= 0) or an error code
+int dowel_graph_add_node(dowel_task_graph_t* graph, const char* name, dowel_callback_t callback, void* user_data);
+int dowel_graph_add_dependency(dowel_task_graph_t* graph, int node, int depends_on);
+
+// Launches without waiting; the returned task finishes with the last node and
+// is owned by the graph (do not free it). dowel_graph_run launches and waits.
+// If a node's task cannot be created, it and everything depending on it are
+// skipped, and dowel_graph_run returns DOWEL_ERROR_OUT_OF_MEMORY.
+dowel_task_t* dowel_graph_launch(dowel_task_graph_t* graph);
+int dowel_graph_run(dowel_task_graph_t* graph);
+
+int dowel_graph_get_stats(const dowel_task_graph_t* graph, dowel_graph_stats_t* stats);
+// Writes up to max node ids, first node first; returns the full path length
+size_t dowel_graph_critical_path(const dowel_task_graph_t* graph, int* nodes, size_t max);
+const char* dowel_graph_node_name(const dowel_task_graph_t* graph, int node);
+int64_t dowel_graph_node_duration_ns(const dowel_task_graph_t* graph, int node);
+
 // File watching
 typedef struct dowel_file_watcher dowel_file_watcher_t;
 typedef enum {
@@ -200,11 +601,33 @@ typedef enum {
 typedef void (*dowel_file_event_callback_t)(const char* path, dowel_file_event_t event, void* user_data);
 
 dowel_file_watcher_t* dowel_file_watcher_create(const char* path, int events, dowel_file_event_callback_t callback, void* user_data);
+
+// One event of a batch; path is valid for the duration of the callback
+typedef struct {
+    const char* path;
+    dowel_file_event_t event;
+} dowel_file_event_record_t;
+
+typedef void (*dowel_file_batch_callback_t)(const dowel_file_event_record_t* records, size_t count, void* user_data);
+
+typedef struct {
+    bool recursive;       // also watch subdirectories, including ones created later
+    uint32_t coalesce_ms; // fold a path's events into their net change over this window; 0 reports each event
+    dowel_file_batch_callback_t batch_callback; // if set, used instead of the per-event callback
+} dowel_file_watcher_options_t;
+
+// All watchers share one inotify instance and one thread. options may be NULL.
+dowel_file_watcher_t* dowel_file_watcher_create_with(const char* path, int events,
+                                                     const dowel_file_watcher_options_t* options,
+                                                     dowel_file_event_callback_t callback, void* user_data);
 void dowel_file_watcher_start(dowel_file_watcher_t* watcher);
 void dowel_file_watcher_stop(dowel_file_watcher_t* watcher);
 void dowel_file_watcher_destroy(dowel_file_watcher_t* watcher);
 
 // JSON utilities (for structured data exchange)
+// Values returned by dowel_json_get_object_value and strings returned by
+// dowel_json_stringify/dowel_json_get_string are owned by the parsed document
+// and stay valid until dowel_json_free is called on its root.
 typedef struct dowel_json_value dowel_json_value_t;
 
 dowel_json_value_t* dowel_json_parse(const char* json_string);
@@ -213,10 +636,95 @@ void dowel_json_free(dowel_json_value_t* value);
 
 dowel_json_value_t* dowel_json_get_object_value(const dowel_json_value_t* object, const char* key);
 const char* dowel_json_get_string(const dowel_json_value_t* value);
+// A float is truncated toward zero, saturating outside the int64 range
 int64_t dowel_json_get_int(const dowel_json_value_t* value);
 double dowel_json_get_float(const dowel_json_value_t* value);
 bool dowel_json_get_bool(const dowel_json_value_t* value);
 
+// On-demand JSON: dowel_json_lazy_open only indexes the document's
+// structure, and values are read when a getter reaches them, with no
+// allocation per value. The index costs 8 bytes per bracket, separator,
+// string and scalar (dowel_json_lazy_footprint). json is borrowed and must
+// stay unchanged until dowel_json_lazy_close. Brackets are checked on open;
+// the rest only where a lookup walks.
+typedef struct dowel_json_lazy dowel_json_lazy_t;
+
+// A position in a lazy document; at is DOWEL_JSON_NOWHERE after a failed lookup
+#define DOWEL_JSON_NOWHERE UINT32_MAX
+typedef struct {
+    const dowel_json_lazy_t* doc;
+    uint32_t at;
+} dowel_json_cursor_t;
+
+typedef enum {
+    DOWEL_JSON_TYPE_MISSING = 0,
+    DOWEL_JSON_TYPE_NULL = 1,
+    DOWEL_JSON_TYPE_BOOL = 2,
+    DOWEL_JSON_TYPE_NUMBER = 3,
+    DOWEL_JSON_TYPE_STRING = 4,
+    DOWEL_JSON_TYPE_ARRAY = 5,
+    DOWEL_JSON_TYPE_OBJECT = 6,
+} dowel_json_type_t;
+
+dowel_json_lazy_t* dowel_json_lazy_open(const char* json);
+void dowel_json_lazy_close(dowel_json_lazy_t* doc);
+size_t dowel_json_lazy_footprint(const dowel_json_lazy_t* doc);
+
+// pointer is a JSON pointer (RFC 6901) relative to from, e.g.
+// "/mapping/abc/message/content"; "" is from itself
+dowel_json_cursor_t dowel_json_lazy_root(const dowel_json_lazy_t* doc);
+dowel_json_cursor_t dowel_json_lazy_find(dowel_json_cursor_t from, const char* pointer);
+dowel_json_cursor_t dowel_json_lazy_member(dowel_json_cursor_t object, const char* key);
+dowel_json_cursor_t dowel_json_lazy_element(dowel_json_cursor_t array, size_t index);
+size_t dowel_json_lazy_count(dowel_json_cursor_t container);
+
+// Getters return 0/false when the value has another type
+dowel_json_type_t dowel_json_lazy_type(dowel_json_cursor_t value);
+int64_t dowel_json_lazy_get_int(dowel_json_cursor_t value);
+double dowel_json_lazy_get_float(dowel_json_cursor_t value);
+bool dowel_json_lazy_get_bool(dowel_json_cursor_t value);
+// Unescapes into out, truncated to capacity and NUL terminated, and returns
+// the full length; -1 if value is not a valid string
+int64_t dowel_json_lazy_get_string(dowel_json_cursor_t value, char* out, size_t capacity);
+// The value's text as it appears in the document
+const char* dowel_json_lazy_raw(dowel_json_cursor_t value, size_t* length);
+
+// Streaming JSON writer: values are written out as they are added, without
+// building a tree. A buffer writer grows its output (from the arena with
+// _in) and dowel_json_writer_text returns it; it stays valid until the next
+// write, reset or destroy. A stream writer sends the output to stream in
+// 64 KB chunks and never closes it; finish flushes the rest. Calls return 0
+// or a negative error, e.g. DOWEL_ERROR_INVALID_PARAMETER for a key outside
+// an object or an unmatched end. The first error sticks until reset.
+// Doubles are written in the shortest form that reads back exactly.
+typedef struct dowel_json_writer dowel_json_writer_t;
+
+dowel_json_writer_t* dowel_json_writer_create(void);
+dowel_json_writer_t* dowel_json_writer_create_in(dowel_arena_t* arena);
+dowel_json_writer_t* dowel_json_writer_create_for_stream(dowel_stream_t* stream);
+void dowel_json_writer_destroy(dowel_json_writer_t* writer);
+
+int dowel_json_writer_begin_object(dowel_json_writer_t* writer);
+int dowel_json_writer_end_object(dowel_json_writer_t* writer);
+int dowel_json_writer_begin_array(dowel_json_writer_t* writer);
+int dowel_json_writer_end_array(dowel_json_writer_t* writer);
+int dowel_json_writer_key(dowel_json_writer_t* writer, const char* key, size_t length);
+int dowel_json_writer_string(dowel_json_writer_t* writer, const char* value, size_t length);
+int dowel_json_writer_int(dowel_json_writer_t* writer, int64_t value);
+int dowel_json_writer_float(dowel_json_writer_t* writer, double value); // finite only
+int dowel_json_writer_bool(dowel_json_writer_t* writer, bool value);
+int dowel_json_writer_null(dowel_json_writer_t* writer);
+// Copies an already serialized value (e.g. from dowel_json_lazy_raw) as is
+int dowel_json_writer_raw(dowel_json_writer_t* writer, const char* json, size_t length);
+
+// Checks that exactly one complete value was written
+int dowel_json_writer_finish(dowel_json_writer_t* writer);
+int dowel_json_writer_error(const dowel_json_writer_t* writer);
+// Buffer writers only: the NUL-terminated output, or NULL after an error
+const char* dowel_json_writer_text(dowel_json_writer_t* writer, size_t* length);
+// Buffer writers only: starts a new document, keeping the buffer
+void dowel_json_writer_reset(dowel_json_writer_t* writer);
+
 // Time utilities
 int64_t dowel_time_now_timestamp(void);
 int64_t dowel_time_now_timestamp_ms(void);
@@ -225,6 +733,103 @@ const char* dowel_time_format_iso8601(int64_t timestamp);
 // Compression utilities
 dowel_buffer_t* dowel_compress_gzip(const uint8_t* data, size_t size);
 dowel_buffer_t* dowel_decompress_gzip(const uint8_t* compressed_data, size_t size);
+dowel_buffer_t* dowel_compress_gzip_in(dowel_arena_t* arena, const uint8_t* data, size_t size);
+dowel_buffer_t* dowel_decompress_gzip_in(dowel_arena_t* arena, const uint8_t* compressed_data, size_t size);
+
+// Codec-tagged frames: the header names the codec, the content size and the
+// dictionary, so dowel_decompress needs nothing else. LZ4 is the fastest,
+// gzip the most portable, zstd (when built in) the best ratio for its speed.
+typedef enum {
+    DOWEL_CODEC_GZIP = 1,
+    DOWEL_CODEC_LZ4 = 2,
+    DOWEL_CODEC_ZSTD = 3,
+} dowel_codec_t;
+
+// Shared history for many small, similar records, e.g. notes or messages
+typedef struct dowel_compress_dict dowel_compress_dict_t;
+
+typedef struct {
+    dowel_codec_t codec;
+    int level; // 0 for the codec's default; gzip and lz4 1-9, zstd 1-19
+    const dowel_compress_dict_t* dict; // optional
+} dowel_compress_options_t;
+
+typedef struct {
+    dowel_codec_t codec;
+    size_t content_size;
+    uint32_t dict_id; // 0 without a dictionary
+} dowel_frame_info_t;
+
+bool dowel_codec_available(dowel_codec_t codec);
+// NULL options means LZ4 at its default level
+dowel_buffer_t* dowel_compress(const uint8_t* data, size_t size, const dowel_compress_options_t* options);
+dowel_buffer_t* dowel_compress_in(dowel_arena_t* arena, const uint8_t* data, size_t size,
+                                  const dowel_compress_options_t* options);
+// dict must be the one the frame was compressed with, or NULL if none was
+dowel_buffer_t* dowel_decompress(const uint8_t* frame, size_t size, const dowel_compress_dict_t* dict);
+dowel_buffer_t* dowel_decompress_in(dowel_arena_t* arena, const uint8_t* frame, size_t size,
+                                    const dowel_compress_dict_t* dict);
+int dowel_compress_frame_info(const uint8_t* frame, size_t size, dowel_frame_info_t* info);
+
+// Picks up to capacity bytes of the content most common across the samples
+dowel_compress_dict_t* dowel_compress_dict_train(const uint8_t* const* samples, const size_t* sizes, size_t count,
+                                                 size_t capacity);
+// Restores a dictionary saved from dowel_compress_dict_bytes
+dowel_compress_dict_t* dowel_compress_dict_load(const uint8_t* data, size_t size);
+const uint8_t* dowel_compress_dict_bytes(const dowel_compress_dict_t* dict, size_t* size);
+uint32_t dowel_compress_dict_id(const dowel_compress_dict_t* dict);
+void dowel_compress_dict_free(dowel_compress_dict_t* dict);
+
+// Seekable archives: the input in independent blocks of block_size bytes
+// (0 for 1 MB), compressed in parallel on the task pool, then a table of
+// where each block is. A reader decodes only the blocks a read covers, so
+// the middle of a large log can be read without inflating the rest.
+typedef struct dowel_seekable dowel_seekable_t;
+
+dowel_buffer_t* dowel_compress_blocks(const uint8_t* data, size_t size, const dowel_compress_options_t* options,
+                                      size_t block_size);
+// The whole content, blocks decoded in parallel
+dowel_buffer_t* dowel_decompress_blocks(const uint8_t* archive, size_t size, const dowel_compress_dict_t* dict);
+
+// Borrows archive (e.g. a mapped dowel_file_view_t) and dict until closed.
+// Reads do not modify the reader and may run concurrently.
+dowel_seekable_t* dowel_seekable_open(const uint8_t* archive, size_t size, const dowel_compress_dict_t* dict);
+void dowel_seekable_close(dowel_seekable_t* reader);
+uint64_t dowel_seekable_content_size(const dowel_seekable_t* reader);
+size_t dowel_seekable_block_count(const dowel_seekable_t* reader);
+size_t dowel_seekable_block_size(const dowel_seekable_t* reader);
+// length is cut short at the end of the content
+dowel_buffer_t* dowel_seekable_read(const dowel_seekable_t* reader, uint64_t offset, size_t length);
+dowel_buffer_t* dowel_seekable_read_in(dowel_arena_t* arena, const dowel_seekable_t* reader, uint64_t offset,
+                                       size_t length);
+dowel_buffer_t* dowel_seekable_read_block(const dowel_seekable_t* reader, size_t index);
+dowel_buffer_t* dowel_seekable_read_block_in(dowel_arena_t* arena, const dowel_seekable_t* reader, size_t index);
+
+// Streaming codec contexts: one message at a time in fixed memory, fed in
+// pieces, output handed to the sink as it is produced. A context is made
+// once and reused; finishing a message keeps its tables for the next one.
+// Output is each codec's standard stream: gzip members, LZ4 frames, zstd
+// frames (dictionaries are for dowel_compress frames only).
+typedef struct dowel_codec_ctx dowel_codec_ctx_t;
+
+// Returns DOWEL_SUCCESS, or an error that the feed, flush or finish returns
+typedef int (*dowel_codec_sink_t)(const uint8_t* data, size_t size, void* user_data);
+
+// NULL options means LZ4 at its default level; options->dict must be NULL
+dowel_codec_ctx_t* dowel_codec_compressor_create(const dowel_compress_options_t* options, dowel_codec_sink_t sink,
+                                                 void* user_data);
+dowel_codec_ctx_t* dowel_codec_decompressor_create(dowel_codec_t codec, dowel_codec_sink_t sink, void* user_data);
+void dowel_codec_ctx_destroy(dowel_codec_ctx_t* ctx);
+
+// The first error sticks until the message is finished or reset
+int dowel_codec_feed(dowel_codec_ctx_t* ctx, const uint8_t* data, size_t size);
+// Hands over everything fed so far, e.g. before a network write
+int dowel_codec_flush(dowel_codec_ctx_t* ctx);
+// Ends the message (decompressing: fails if it stopped partway through)
+// and readies the context for the next one
+int dowel_codec_finish(dowel_codec_ctx_t* ctx);
+// Drops the message in progress and any error
+void dowel_codec_reset(dowel_codec_ctx_t* ctx);
 
 #ifdef __cplusplus
 }
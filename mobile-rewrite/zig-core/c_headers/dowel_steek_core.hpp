@@ -0,0 +1,1038 @@
+#ifndef DOWEL_STEEK_CORE_HPP
+#define DOWEL_STEEK_CORE_HPP
+
+// Header-only C++20 SDK over dowel_steek_core.h.
+//
+// Every handle type is a move-only owner of the C object it wraps and releases
+// it with the matching dowel_*_free/destroy call. Results are exposed as
+// std::span/std::string_view over memory owned by the library, so nothing is
+// copied unless the caller asks for it. All wrappers are inline and add no
+// state beyond the C pointer they hold.
+
+#include "dowel_steek_core.h"
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace dowel {
+
+// Non-owning reference to a NUL-terminated string. Accepts literals, C strings
+// and std::string without copying, so it can be passed straight to the C API.
+class zstring_view {
+public:
+    constexpr zstring_view(const char* str) noexcept : str_(str) {}
+    zstring_view(const std::string& str) noexcept : str_(str.c_str()) {}
+
+    constexpr const char* c_str() const noexcept { return str_; }
+    std::string_view view() const noexcept { return str_ ? std::string_view(str_) : std::string_view(); }
+
+private:
+    const char* str_;
+};
+
+namespace detail {
+
+// Move-only owner of a C handle released through Free
+template <typename T, void (*Free)(T*)>
+class unique_handle {
+public:
+    constexpr unique_handle() noexcept = default;
+    constexpr explicit unique_handle(T* handle) noexcept : handle_(handle) {}
+
+    unique_handle(const unique_handle&) = delete;
+    unique_handle& operator=(const unique_handle&) = delete;
+
+    unique_handle(unique_handle&& other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+    unique_handle& operator=(unique_handle&& other) noexcept {
+        reset(std::exchange(other.handle_, nullptr));
+        return *this;
+    }
+
+    ~unique_handle() {
+        if (handle_) Free(handle_);
+    }
+
+    T* get() const noexcept { return handle_; }
+    T* release() noexcept { return std::exchange(handle_, nullptr); }
+    void reset(T* handle = nullptr) noexcept {
+        if (T* old = std::exchange(handle_, handle)) Free(old);
+    }
+    explicit operator bool() const noexcept { return handle_ != nullptr; }
+
+private:
+    T* handle_ = nullptr;
+};
+
+} // namespace detail
+
+using bytes_view = std::span<const std::uint8_t>;
+
+inline bytes_view as_bytes(std::string_view str) noexcept {
+    return { reinterpret_cast<const std::uint8_t*>(str.data()), str.size() };
+}
+
+// Error handling
+inline std::string_view error_message(int error_code) noexcept {
+    return dowel_error_get_message(error_code);
+}
+
+// Initializes the core for the lifetime of the object
+class core_session {
+public:
+    core_session() noexcept : status_(dowel_core_init()) {}
+    ~core_session() {
+        if (status_ == DOWEL_SUCCESS) dowel_core_shutdown();
+    }
+
+    core_session(const core_session&) = delete;
+    core_session& operator=(const core_session&) = delete;
+
+    int status() const noexcept { return status_; }
+    explicit operator bool() const noexcept { return status_ == DOWEL_SUCCESS; }
+
+private:
+    int status_;
+};
+
+inline std::string_view version() noexcept {
+    return dowel_core_version();
+}
+
+// Library-allocated byte buffer (dowel_buffer_t)
+class buffer {
+public:
+    buffer() noexcept = default;
+    explicit buffer(dowel_buffer_t* raw) noexcept : handle_(raw) {}
+
+    const std::uint8_t* data() const noexcept { return handle_ ? handle_.get()->data : nullptr; }
+    std::size_t size() const noexcept { return handle_ ? handle_.get()->size : 0; }
+    bool empty() const noexcept { return size() == 0; }
+
+    bytes_view bytes() const noexcept { return { data(), size() }; }
+    std::span<std::uint8_t> mutable_bytes() noexcept {
+        return handle_ ? std::span<std::uint8_t>(handle_.get()->data, handle_.get()->size) : std::span<std::uint8_t>();
+    }
+    std::string_view str() const noexcept {
+        return { reinterpret_cast<const char*>(data()), size() };
+    }
+
+    dowel_buffer_t* get() const noexcept { return handle_.get(); }
+    dowel_buffer_t* release() noexcept { return handle_.release(); }
+    explicit operator bool() const noexcept { return static_cast<bool>(handle_); }
+
+private:
+    detail::unique_handle<dowel_buffer_t, dowel_free_buffer> handle_;
+};
+
+// Directory listing (char** + count from dowel_storage_list_directory)
+class string_list {
+public:
+    string_list() noexcept = default;
+    string_list(char** strings, std::size_t count) noexcept : strings_(strings), count_(count) {}
+
+    string_list(const string_list&) = delete;
+    string_list& operator=(const string_list&) = delete;
+
+    string_list(string_list&& other) noexcept
+        : strings_(std::exchange(other.strings_, nullptr)), count_(std::exchange(other.count_, 0)) {}
+    string_list& operator=(string_list&& other) noexcept {
+        if (this != &other) {
+            dowel_free_string_array(strings_, count_);
+            strings_ = std::exchange(other.strings_, nullptr);
+            count_ = std::exchange(other.count_, 0);
+        }
+        return *this;
+    }
+
+    ~string_list() { dowel_free_string_array(strings_, count_); }
+
+    std::size_t size() const noexcept { return count_; }
+    bool empty() const noexcept { return count_ == 0; }
+    std::string_view operator[](std::size_t i) const noexcept { return strings_[i]; }
+    std::span<char* const> raw() const noexcept { return { strings_, count_ }; }
+
+private:
+    char** strings_ = nullptr;
+    std::size_t count_ = 0;
+};
+
+// Scratch arena (dowel_arena_t). Results of the arena overloads below are
+// views into it and stay valid until reset() or destruction.
+class arena {
+public:
+    explicit arena(std::size_t chunk_size = 0) noexcept : handle_(dowel_arena_create(chunk_size)) {}
+
+    void* alloc(std::size_t size) noexcept { return dowel_arena_alloc(handle_.get(), size); }
+    std::string_view copy(std::string_view str) noexcept {
+        auto* out = static_cast<char*>(alloc(str.size() + 1));
+        if (!out) return {};
+        str.copy(out, str.size());
+        out[str.size()] = '\0';
+        return { out, str.size() };
+    }
+
+    void reset() noexcept { dowel_arena_reset(handle_.get()); }
+    std::size_t used() const noexcept { return dowel_arena_used(handle_.get()); }
+
+    dowel_arena_t* get() const noexcept { return handle_.get(); }
+    explicit operator bool() const noexcept { return static_cast<bool>(handle_); }
+
+private:
+    detail::unique_handle<dowel_arena_t, dowel_arena_destroy> handle_;
+};
+
+namespace detail {
+
+inline bytes_view arena_bytes(const dowel_buffer_t* raw) noexcept {
+    return raw ? bytes_view(raw->data, raw->size) : bytes_view();
+}
+
+} // namespace detail
+
+// Configuration key resolved once, for code that reads the same setting on
+// every call. Handles are plain integers owned by the core session, so this is
+// freely copyable.
+class config_key {
+public:
+    constexpr config_key() noexcept = default;
+    constexpr explicit config_key(dowel_config_key_t raw) noexcept : key_(raw) {}
+
+    static config_key resolve(zstring_view path) noexcept { return config_key(dowel_config_resolve(path.c_str())); }
+
+    // Valid until shutdown
+    std::string_view get_string(zstring_view default_value = "") const noexcept {
+        const char* str = dowel_config_key_get_string(key_, default_value.c_str());
+        return str ? std::string_view(str) : std::string_view();
+    }
+    std::int64_t get_int(std::int64_t default_value = 0) const noexcept {
+        return dowel_config_key_get_int(key_, default_value);
+    }
+    bool get_bool(bool default_value = false) const noexcept { return dowel_config_key_get_bool(key_, default_value); }
+    double get_float(double default_value = 0.0) const noexcept {
+        return dowel_config_key_get_float(key_, default_value);
+    }
+
+    int set(zstring_view value) const noexcept { return dowel_config_key_set_string(key_, value.c_str()); }
+    int set(const char* value) const noexcept { return dowel_config_key_set_string(key_, value); }
+    int set(std::int64_t value) const noexcept { return dowel_config_key_set_int(key_, value); }
+    int set(int value) const noexcept { return dowel_config_key_set_int(key_, value); }
+    int set(bool value) const noexcept { return dowel_config_key_set_bool(key_, value); }
+    int set(double value) const noexcept { return dowel_config_key_set_float(key_, value); }
+
+    std::uint32_t generation() const noexcept { return dowel_config_key_generation(key_); }
+    bool changed_since(std::uint32_t seen) const noexcept { return generation() != seen; }
+
+    dowel_config_key_t get() const noexcept { return key_; }
+    explicit operator bool() const noexcept { return key_ != DOWEL_CONFIG_INVALID_KEY; }
+
+private:
+    dowel_config_key_t key_ = DOWEL_CONFIG_INVALID_KEY;
+};
+
+// Logging. Entries are written asynchronously; flush() waits for them.
+namespace log {
+
+inline void trace(zstring_view module, zstring_view message) noexcept { dowel_log_trace(module.c_str(), message.c_str()); }
+inline void debug(zstring_view module, zstring_view message) noexcept { dowel_log_debug(module.c_str(), message.c_str()); }
+inline void info(zstring_view module, zstring_view message) noexcept { dowel_log_info(module.c_str(), message.c_str()); }
+inline void warn(zstring_view module, zstring_view message) noexcept { dowel_log_warn(module.c_str(), message.c_str()); }
+inline void error(zstring_view module, zstring_view message) noexcept { dowel_log_error(module.c_str(), message.c_str()); }
+inline void fatal(zstring_view module, zstring_view message) noexcept { dowel_log_fatal(module.c_str(), message.c_str()); }
+
+inline void set_level(dowel_log_level_t level) noexcept { dowel_log_set_level(level); }
+inline void flush() noexcept { dowel_log_flush(); }
+inline dowel_log_metrics_t metrics() noexcept { return dowel_log_get_metrics(); }
+
+// Structured entries (DOWEL_LOG_STRUCTURED) go to this file until it is closed
+inline int open_binary(zstring_view path) noexcept { return dowel_log_binary_open(path.c_str()); }
+inline void close_binary() noexcept { dowel_log_binary_close(); }
+
+} // namespace log
+
+// Storage
+namespace storage {
+
+inline buffer read_file(zstring_view path) noexcept {
+    return buffer(dowel_storage_read_file(path.c_str()));
+}
+
+inline bytes_view read_file(arena& scratch, zstring_view path) noexcept {
+    return detail::arena_bytes(dowel_storage_read_file_in(scratch.get(), path.c_str()));
+}
+
+inline int write_file(zstring_view path, bytes_view data) noexcept {
+    return dowel_storage_write_file(path.c_str(), data.data(), data.size());
+}
+
+inline int write_file(zstring_view path, bytes_view data, dowel_write_mode_t mode) noexcept {
+    return dowel_storage_write_file_mode(path.c_str(), data.data(), data.size(), mode);
+}
+
+inline int delete_file(zstring_view path) noexcept {
+    return dowel_storage_delete_file(path.c_str());
+}
+
+inline bool file_exists(zstring_view path) noexcept {
+    return dowel_storage_file_exists(path.c_str());
+}
+
+inline int create_directory(zstring_view path) noexcept {
+    return dowel_storage_create_directory(path.c_str());
+}
+
+inline string_list list_directory(zstring_view path) noexcept {
+    std::size_t count = 0;
+    char** names = dowel_storage_list_directory(path.c_str(), &count);
+    return string_list(names, names ? count : 0);
+}
+
+inline std::span<char* const> list_directory(arena& scratch, zstring_view path) noexcept {
+    std::size_t count = 0;
+    char** names = dowel_storage_list_directory_in(scratch.get(), path.c_str(), &count);
+    return { names, names ? count : 0 };
+}
+
+inline std::int64_t file_size(zstring_view path) noexcept {
+    return dowel_storage_get_file_size(path.c_str());
+}
+
+inline std::int64_t file_modtime(zstring_view path) noexcept {
+    return dowel_storage_get_file_modtime(path.c_str());
+}
+
+// Refcounted read-only mapping of a file (dowel_file_view_t). Copies share
+// the mapping; the last one unmaps it.
+class file_view {
+public:
+    file_view() noexcept = default;
+    explicit file_view(dowel_file_view_t* raw) noexcept : view_(raw) {}
+
+    file_view(const file_view& other) noexcept : view_(dowel_file_view_retain(other.view_)) {}
+    file_view& operator=(const file_view& other) noexcept {
+        if (this != &other) {
+            dowel_file_view_release(view_);
+            view_ = dowel_file_view_retain(other.view_);
+        }
+        return *this;
+    }
+    file_view(file_view&& other) noexcept : view_(std::exchange(other.view_, nullptr)) {}
+    file_view& operator=(file_view&& other) noexcept {
+        if (this != &other) {
+            dowel_file_view_release(view_);
+            view_ = std::exchange(other.view_, nullptr);
+        }
+        return *this;
+    }
+    ~file_view() { dowel_file_view_release(view_); }
+
+    const std::uint8_t* data() const noexcept { return view_ ? view_->data : nullptr; }
+    std::size_t size() const noexcept { return view_ ? view_->size : 0; }
+    bool empty() const noexcept { return size() == 0; }
+    bytes_view bytes() const noexcept { return { data(), size() }; }
+    std::string_view str() const noexcept { return { reinterpret_cast<const char*>(data()), size() }; }
+
+    int advise(std::size_t offset, std::size_t length, int advice) const noexcept {
+        return dowel_file_view_advise(view_, offset, length, advice);
+    }
+
+    dowel_file_view_t* get() const noexcept { return view_; }
+    explicit operator bool() const noexcept { return view_ != nullptr; }
+
+private:
+    dowel_file_view_t* view_ = nullptr;
+};
+
+inline file_view map_file(zstring_view path, int advice = DOWEL_MAP_NORMAL) noexcept {
+    return file_view(dowel_storage_map_file(path.c_str(), advice));
+}
+
+// Runs a batch; returns how many requests failed. READ results must still be
+// freed by the caller (e.g. by moving them into a buffer).
+inline int submit(std::span<dowel_io_request_t> requests) noexcept {
+    return dowel_storage_submit(requests.data(), requests.size());
+}
+
+// READ results live in the arena until it is reset
+inline int submit(arena& scratch, std::span<dowel_io_request_t> requests) noexcept {
+    return dowel_storage_submit_in(scratch.get(), requests.data(), requests.size());
+}
+
+// Directory entries with their stats (dowel_storage_stat_directory)
+class dir_entries {
+public:
+    dir_entries() noexcept = default;
+    dir_entries(dowel_dir_entry_t* entries, std::size_t count) noexcept : entries_(entries), count_(count) {}
+
+    dir_entries(const dir_entries&) = delete;
+    dir_entries& operator=(const dir_entries&) = delete;
+
+    dir_entries(dir_entries&& other) noexcept
+        : entries_(std::exchange(other.entries_, nullptr)), count_(std::exchange(other.count_, 0)) {}
+    dir_entries& operator=(dir_entries&& other) noexcept {
+        if (this != &other) {
+            dowel_storage_free_dir_entries(entries_, count_);
+            entries_ = std::exchange(other.entries_, nullptr);
+            count_ = std::exchange(other.count_, 0);
+        }
+        return *this;
+    }
+
+    ~dir_entries() { dowel_storage_free_dir_entries(entries_, count_); }
+
+    std::size_t size() const noexcept { return count_; }
+    bool empty() const noexcept { return count_ == 0; }
+    const dowel_dir_entry_t& operator[](std::size_t i) const noexcept { return entries_[i]; }
+    const dowel_dir_entry_t* begin() const noexcept { return entries_; }
+    const dowel_dir_entry_t* end() const noexcept { return entries_ + count_; }
+
+private:
+    dowel_dir_entry_t* entries_ = nullptr;
+    std::size_t count_ = 0;
+};
+
+inline dir_entries stat_directory(zstring_view path) noexcept {
+    std::size_t count = 0;
+    dowel_dir_entry_t* entries = dowel_storage_stat_directory(path.c_str(), &count);
+    return dir_entries(entries, count);
+}
+
+inline std::string_view backend() noexcept {
+    return dowel_storage_backend();
+}
+
+// Result of a recursive scan (dowel_scan_result_t); paths are views into it
+class scan_result {
+public:
+    scan_result() noexcept = default;
+    explicit scan_result(dowel_scan_result_t* raw) noexcept : handle_(raw) {}
+
+    std::size_t size() const noexcept { return handle_ ? handle_.get()->count : 0; }
+    bool empty() const noexcept { return size() == 0; }
+    const dowel_scan_entry_t& operator[](std::size_t i) const noexcept { return handle_.get()->entries[i]; }
+    const dowel_scan_entry_t* begin() const noexcept { return handle_ ? handle_.get()->entries : nullptr; }
+    const dowel_scan_entry_t* end() const noexcept { return begin() + size(); }
+
+    std::string_view path(const dowel_scan_entry_t& entry) const noexcept {
+        return { handle_.get()->paths + entry.path_offset, entry.path_length };
+    }
+    std::size_t skipped_directories() const noexcept { return handle_ ? handle_.get()->skipped_directories : 0; }
+
+    dowel_scan_result_t* get() const noexcept { return handle_.get(); }
+    explicit operator bool() const noexcept { return static_cast<bool>(handle_); }
+
+private:
+    detail::unique_handle<dowel_scan_result_t, dowel_storage_free_scan> handle_;
+};
+
+inline scan_result scan(zstring_view root, const dowel_scan_options_t* options = nullptr) noexcept {
+    return scan_result(dowel_storage_scan(root.c_str(), options));
+}
+
+// Chunked file stream (dowel_stream_t). The destructor closes it; call
+// close() to see whether the final flush succeeded.
+class stream {
+public:
+    stream() noexcept = default;
+    explicit stream(dowel_stream_t* raw) noexcept : stream_(raw) {}
+
+    stream(const stream&) = delete;
+    stream& operator=(const stream&) = delete;
+
+    stream(stream&& other) noexcept : stream_(std::exchange(other.stream_, nullptr)) {}
+    stream& operator=(stream&& other) noexcept {
+        if (this != &other) {
+            close();
+            stream_ = std::exchange(other.stream_, nullptr);
+        }
+        return *this;
+    }
+
+    ~stream() { close(); }
+
+    std::int64_t read(std::span<std::uint8_t> out) noexcept {
+        return dowel_stream_read(stream_, out.data(), out.size());
+    }
+    std::int64_t write(bytes_view data) noexcept { return dowel_stream_write(stream_, data.data(), data.size()); }
+    std::int64_t seek(std::int64_t offset, int whence = DOWEL_SEEK_SET) noexcept {
+        return dowel_stream_seek(stream_, offset, whence);
+    }
+    int close() noexcept {
+        return stream_ ? dowel_stream_close(std::exchange(stream_, nullptr)) : DOWEL_SUCCESS;
+    }
+
+    dowel_stream_t* get() const noexcept { return stream_; }
+    explicit operator bool() const noexcept { return stream_ != nullptr; }
+
+private:
+    dowel_stream_t* stream_ = nullptr;
+};
+
+inline stream open_stream(zstring_view path, dowel_stream_mode_t mode,
+                          const dowel_stream_options_t* options = nullptr) noexcept {
+    return stream(dowel_stream_open(path.c_str(), mode, options));
+}
+
+// Shares the cached copy; no bytes are copied on a hit
+inline file_view read_cached(zstring_view path) noexcept {
+    return file_view(dowel_storage_read_cached(path.c_str()));
+}
+
+inline void invalidate_cached(zstring_view path) noexcept { dowel_storage_cache_invalidate(path.c_str()); }
+inline void clear_cache() noexcept { dowel_storage_cache_clear(); }
+inline dowel_storage_metrics_t metrics() noexcept { return dowel_storage_get_metrics(); }
+
+// Metadata index (dowel_storage_index_open)
+inline int open_index(zstring_view root, zstring_view snapshot_path = nullptr) noexcept {
+    return dowel_storage_index_open(root.c_str(), snapshot_path.c_str());
+}
+
+inline int save_index() noexcept {
+    return dowel_storage_index_save();
+}
+
+inline void close_index() noexcept {
+    dowel_storage_index_close();
+}
+
+inline dowel_storage_index_stats_t index_stats() noexcept {
+    return dowel_storage_index_get_stats();
+}
+
+} // namespace storage
+
+// Crypto
+class crypto_key {
+public:
+    crypto_key() noexcept = default;
+    explicit crypto_key(dowel_crypto_key_t* raw) noexcept : handle_(raw) {}
+
+    static crypto_key generate() noexcept { return crypto_key(dowel_crypto_generate_key()); }
+
+    bytes_view bytes() const noexcept {
+        return handle_ ? bytes_view(handle_.get()->data, handle_.get()->size) : bytes_view();
+    }
+
+    buffer encrypt(bytes_view plaintext) const noexcept {
+        return buffer(dowel_crypto_encrypt(handle_.get(), plaintext.data(), plaintext.size()));
+    }
+
+    buffer decrypt(bytes_view ciphertext) const noexcept {
+        return buffer(dowel_crypto_decrypt(handle_.get(), ciphertext.data(), ciphertext.size()));
+    }
+
+    bytes_view encrypt(arena& scratch, bytes_view plaintext) const noexcept {
+        return detail::arena_bytes(
+            dowel_crypto_encrypt_in(scratch.get(), handle_.get(), plaintext.data(), plaintext.size()));
+    }
+
+    bytes_view decrypt(arena& scratch, bytes_view ciphertext) const noexcept {
+        return detail::arena_bytes(
+            dowel_crypto_decrypt_in(scratch.get(), handle_.get(), ciphertext.data(), ciphertext.size()));
+    }
+
+    dowel_crypto_key_t* get() const noexcept { return handle_.get(); }
+    explicit operator bool() const noexcept { return static_cast<bool>(handle_); }
+
+private:
+    detail::unique_handle<dowel_crypto_key_t, dowel_crypto_free_key> handle_;
+};
+
+inline buffer sha256(bytes_view data) noexcept {
+    return buffer(dowel_crypto_hash_sha256(data.data(), data.size()));
+}
+
+inline bytes_view sha256(arena& scratch, bytes_view data) noexcept {
+    return detail::arena_bytes(dowel_crypto_hash_sha256_in(scratch.get(), data.data(), data.size()));
+}
+
+// Compression
+inline buffer compress_gzip(bytes_view data) noexcept {
+    return buffer(dowel_compress_gzip(data.data(), data.size()));
+}
+
+inline buffer decompress_gzip(bytes_view data) noexcept {
+    return buffer(dowel_decompress_gzip(data.data(), data.size()));
+}
+
+inline bytes_view compress_gzip(arena& scratch, bytes_view data) noexcept {
+    return detail::arena_bytes(dowel_compress_gzip_in(scratch.get(), data.data(), data.size()));
+}
+
+inline bytes_view decompress_gzip(arena& scratch, bytes_view data) noexcept {
+    return detail::arena_bytes(dowel_decompress_gzip_in(scratch.get(), data.data(), data.size()));
+}
+
+class compress_dict {
+public:
+    compress_dict() noexcept = default;
+    explicit compress_dict(dowel_compress_dict_t* raw) noexcept : handle_(raw) {}
+
+    static compress_dict train(std::span<const bytes_view> samples, std::size_t capacity) {
+        std::vector<const std::uint8_t*> data;
+        std::vector<std::size_t> sizes;
+        for (bytes_view sample : samples) {
+            data.push_back(sample.data());
+            sizes.push_back(sample.size());
+        }
+        return compress_dict(dowel_compress_dict_train(data.data(), sizes.data(), samples.size(), capacity));
+    }
+
+    static compress_dict load(bytes_view data) noexcept {
+        return compress_dict(dowel_compress_dict_load(data.data(), data.size()));
+    }
+
+    bytes_view bytes() const noexcept {
+        std::size_t size = 0;
+        const std::uint8_t* data = dowel_compress_dict_bytes(handle_.get(), &size);
+        return { data, size };
+    }
+    std::uint32_t id() const noexcept { return dowel_compress_dict_id(handle_.get()); }
+
+    const dowel_compress_dict_t* get() const noexcept { return handle_.get(); }
+    explicit operator bool() const noexcept { return static_cast<bool>(handle_); }
+
+private:
+    detail::unique_handle<dowel_compress_dict_t, dowel_compress_dict_free> handle_;
+};
+
+inline bool codec_available(dowel_codec_t codec) noexcept {
+    return dowel_codec_available(codec);
+}
+
+inline buffer compress(bytes_view data, dowel_codec_t codec = DOWEL_CODEC_LZ4, int level = 0,
+                       const compress_dict* dict = nullptr) noexcept {
+    dowel_compress_options_t options{ codec, level, dict ? dict->get() : nullptr };
+    return buffer(dowel_compress(data.data(), data.size(), &options));
+}
+
+inline buffer decompress(bytes_view frame, const compress_dict* dict = nullptr) noexcept {
+    return buffer(dowel_decompress(frame.data(), frame.size(), dict ? dict->get() : nullptr));
+}
+
+inline bytes_view compress(arena& scratch, bytes_view data, dowel_codec_t codec = DOWEL_CODEC_LZ4, int level = 0,
+                           const compress_dict* dict = nullptr) noexcept {
+    dowel_compress_options_t options{ codec, level, dict ? dict->get() : nullptr };
+    return detail::arena_bytes(dowel_compress_in(scratch.get(), data.data(), data.size(), &options));
+}
+
+inline bytes_view decompress(arena& scratch, bytes_view frame, const compress_dict* dict = nullptr) noexcept {
+    return detail::arena_bytes(dowel_decompress_in(scratch.get(), frame.data(), frame.size(), dict ? dict->get() : nullptr));
+}
+
+inline buffer compress_blocks(bytes_view data, dowel_codec_t codec = DOWEL_CODEC_LZ4, int level = 0,
+                              std::size_t block_size = 0, const compress_dict* dict = nullptr) noexcept {
+    dowel_compress_options_t options{ codec, level, dict ? dict->get() : nullptr };
+    return buffer(dowel_compress_blocks(data.data(), data.size(), &options, block_size));
+}
+
+inline buffer decompress_blocks(bytes_view archive, const compress_dict* dict = nullptr) noexcept {
+    return buffer(dowel_decompress_blocks(archive.data(), archive.size(), dict ? dict->get() : nullptr));
+}
+
+// Random access into a dowel_compress_blocks archive, which must outlive it
+class seekable_archive {
+public:
+    seekable_archive() noexcept = default;
+    explicit seekable_archive(dowel_seekable_t* raw) noexcept : handle_(raw) {}
+
+    static seekable_archive open(bytes_view archive, const compress_dict* dict = nullptr) noexcept {
+        return seekable_archive(dowel_seekable_open(archive.data(), archive.size(), dict ? dict->get() : nullptr));
+    }
+
+    std::uint64_t content_size() const noexcept { return dowel_seekable_content_size(handle_.get()); }
+    std::size_t block_count() const noexcept { return dowel_seekable_block_count(handle_.get()); }
+    std::size_t block_size() const noexcept { return dowel_seekable_block_size(handle_.get()); }
+
+    buffer read(std::uint64_t offset, std::size_t length) const noexcept {
+        return buffer(dowel_seekable_read(handle_.get(), offset, length));
+    }
+    bytes_view read(arena& scratch, std::uint64_t offset, std::size_t length) const noexcept {
+        return detail::arena_bytes(dowel_seekable_read_in(scratch.get(), handle_.get(), offset, length));
+    }
+    buffer read_block(std::size_t index) const noexcept { return buffer(dowel_seekable_read_block(handle_.get(), index)); }
+
+    dowel_seekable_t* get() const noexcept { return handle_.get(); }
+    explicit operator bool() const noexcept { return static_cast<bool>(handle_); }
+
+private:
+    detail::unique_handle<dowel_seekable_t, dowel_seekable_close> handle_;
+};
+
+// A reusable streaming compressor or decompressor. Output goes to
+// fn(bytes_view), which returns nothing or an int status; fn is borrowed and
+// must outlive the context.
+class codec_context {
+public:
+    codec_context() noexcept = default;
+    explicit codec_context(dowel_codec_ctx_t* raw) noexcept : handle_(raw) {}
+
+    template <typename F>
+    static codec_context compressor(dowel_codec_t codec, int level, F& fn) noexcept {
+        dowel_compress_options_t options{codec, level, nullptr};
+        return codec_context(dowel_codec_compressor_create(&options, &sink<F>, &fn));
+    }
+
+    template <typename F>
+    static codec_context decompressor(dowel_codec_t codec, F& fn) noexcept {
+        return codec_context(dowel_codec_decompressor_create(codec, &sink<F>, &fn));
+    }
+
+    int feed(bytes_view data) const noexcept { return dowel_codec_feed(handle_.get(), data.data(), data.size()); }
+    int feed(std::string_view text) const noexcept {
+        return dowel_codec_feed(handle_.get(), reinterpret_cast<const std::uint8_t*>(text.data()), text.size());
+    }
+    int flush() const noexcept { return dowel_codec_flush(handle_.get()); }
+    int finish() const noexcept { return dowel_codec_finish(handle_.get()); }
+    void reset() const noexcept { dowel_codec_reset(handle_.get()); }
+
+    dowel_codec_ctx_t* get() const noexcept { return handle_.get(); }
+    explicit operator bool() const noexcept { return static_cast<bool>(handle_); }
+
+private:
+    template <typename F>
+    static int sink(const std::uint8_t* data, size_t size, void* user_data) {
+        F& fn = *static_cast<F*>(user_data);
+        if constexpr (requires { { fn(bytes_view(data, size)) } -> std::same_as<void>; }) {
+            fn(bytes_view(data, size));
+            return DOWEL_SUCCESS;
+        } else {
+            return fn(bytes_view(data, size));
+        }
+    }
+
+    detail::unique_handle<dowel_codec_ctx_t, dowel_codec_ctx_destroy> handle_;
+};
+
+// Async tasks. The task is waited for (not cancelled) when the handle is dropped.
+class task {
+public:
+    task() noexcept = default;
+    explicit task(dowel_task_t* raw) noexcept : handle_(raw) {}
+
+    static task spawn(dowel_callback_t callback, void* user_data) noexcept {
+        return task(dowel_async_spawn(callback, user_data));
+    }
+
+    // Runs fn() on the core's executor. fn is borrowed, not copied, and must
+    // outlive the task.
+    template <typename F>
+    static task spawn(F& fn) noexcept {
+        return spawn([](void* data) { (*static_cast<F*>(data))(); }, &fn);
+    }
+
+    // As spawn, preferring the given worker
+    template <typename F>
+    static task spawn_on(int worker, F& fn) noexcept {
+        return task(dowel_async_spawn_on(worker, [](void* data) { (*static_cast<F*>(data))(); }, &fn));
+    }
+
+    // Runs fn() after this task finishes; cancelled if this task is. fn is
+    // borrowed and must outlive the continuation.
+    template <typename F>
+    task then(F& fn) const noexcept {
+        return task(dowel_async_then(handle_.get(), [](void* data) { (*static_cast<F*>(data))(); }, &fn));
+    }
+
+    // A task that finishes once all of the given tasks have; raw handles stay
+    // owned by their task objects
+    static task when_all(std::span<dowel_task_t* const> tasks) noexcept {
+        return task(dowel_async_when_all(tasks.data(), tasks.size(), nullptr, nullptr));
+    }
+
+    template <typename F>
+    static task when_all(std::span<dowel_task_t* const> tasks, F& fn) noexcept {
+        return task(dowel_async_when_all(tasks.data(), tasks.size(),
+                                         [](void* data) { (*static_cast<F*>(data))(); }, &fn));
+    }
+
+    bool is_complete() const noexcept { return dowel_async_is_complete(handle_.get()); }
+    void wait() const noexcept { dowel_async_wait(handle_.get()); }
+    void cancel() const noexcept { dowel_async_cancel(handle_.get()); }
+
+    dowel_task_t* get() const noexcept { return handle_.get(); }
+    explicit operator bool() const noexcept { return static_cast<bool>(handle_); }
+
+private:
+    detail::unique_handle<dowel_task_t, dowel_async_free_task> handle_;
+};
+
+namespace async {
+
+inline int worker_count() noexcept { return dowel_async_worker_count(); }
+inline int current_worker() noexcept { return dowel_async_current_worker(); }
+inline bool cancel_requested() noexcept { return dowel_async_cancel_requested(); }
+
+} // namespace async
+
+// Dependency graph of named nodes; see dowel_graph_* for semantics
+class task_graph {
+public:
+    task_graph() noexcept : handle_(dowel_graph_create()) {}
+
+    // Returns the node id or a negative error code. fn is borrowed and must
+    // outlive every run of the graph.
+    template <typename F>
+    int add(zstring_view name, F& fn) noexcept {
+        return dowel_graph_add_node(handle_.get(), name.c_str(), [](void* data) { (*static_cast<F*>(data))(); }, &fn);
+    }
+
+    int depends_on(int node, int dependency) noexcept {
+        return dowel_graph_add_dependency(handle_.get(), node, dependency);
+    }
+
+    int run() noexcept { return dowel_graph_run(handle_.get()); }
+
+    dowel_graph_stats_t stats() const noexcept {
+        dowel_graph_stats_t out{};
+        dowel_graph_get_stats(handle_.get(), &out);
+        return out;
+    }
+
+    std::string_view name(int node) const noexcept {
+        const char* raw = dowel_graph_node_name(handle_.get(), node);
+        return raw ? std::string_view(raw) : std::string_view();
+    }
+
+    std::int64_t duration_ns(int node) const noexcept { return dowel_graph_node_duration_ns(handle_.get(), node); }
+
+    dowel_task_graph_t* get() const noexcept { return handle_.get(); }
+    explicit operator bool() const noexcept { return static_cast<bool>(handle_); }
+
+private:
+    detail::unique_handle<dowel_task_graph_t, dowel_graph_destroy> handle_;
+};
+
+// File watching
+class file_watcher {
+public:
+    file_watcher() noexcept = default;
+    explicit file_watcher(dowel_file_watcher_t* raw) noexcept : handle_(raw) {}
+
+    static file_watcher create(zstring_view path, int events, dowel_file_event_callback_t callback, void* user_data) noexcept {
+        return file_watcher(dowel_file_watcher_create(path.c_str(), events, callback, user_data));
+    }
+
+    // Calls fn(std::string_view path, dowel_file_event_t event) from the watcher
+    // thread. fn is borrowed and must outlive the watcher.
+    template <typename F>
+    static file_watcher create(zstring_view path, int events, F& fn) noexcept {
+        return create(path, events, [](const char* p, dowel_file_event_t e, void* data) {
+            (*static_cast<F*>(data))(std::string_view(p), e);
+        }, &fn);
+    }
+
+    static file_watcher create(zstring_view path, int events, const dowel_file_watcher_options_t& options,
+                               dowel_file_event_callback_t callback, void* user_data) noexcept {
+        return file_watcher(dowel_file_watcher_create_with(path.c_str(), events, &options, callback, user_data));
+    }
+
+    // Calls fn(std::span<const dowel_file_event_record_t> batch) from the
+    // watcher thread. fn is borrowed and must outlive the watcher.
+    template <typename F>
+    static file_watcher create_batched(zstring_view path, int events, dowel_file_watcher_options_t options, F& fn) noexcept {
+        options.batch_callback = [](const dowel_file_event_record_t* records, size_t count, void* data) {
+            (*static_cast<F*>(data))(std::span<const dowel_file_event_record_t>(records, count));
+        };
+        return create(path, events, options, nullptr, &fn);
+    }
+
+    void start() const noexcept { dowel_file_watcher_start(handle_.get()); }
+    void stop() const noexcept { dowel_file_watcher_stop(handle_.get()); }
+
+    dowel_file_watcher_t* get() const noexcept { return handle_.get(); }
+    explicit operator bool() const noexcept { return static_cast<bool>(handle_); }
+
+private:
+    detail::unique_handle<dowel_file_watcher_t, dowel_file_watcher_destroy> handle_;
+};
+
+// JSON. json_ref is a non-owning view of a node that stays valid as long as
+// the json_document it came from.
+class json_ref {
+public:
+    constexpr json_ref() noexcept = default;
+    constexpr explicit json_ref(const dowel_json_value_t* value) noexcept : value_(value) {}
+
+    json_ref operator[](zstring_view key) const noexcept {
+        return json_ref(dowel_json_get_object_value(value_, key.c_str()));
+    }
+
+    std::string_view as_string() const noexcept {
+        const char* str = dowel_json_get_string(value_);
+        return str ? std::string_view(str) : std::string_view();
+    }
+    std::int64_t as_int() const noexcept { return dowel_json_get_int(value_); }
+    double as_float() const noexcept { return dowel_json_get_float(value_); }
+    bool as_bool() const noexcept { return dowel_json_get_bool(value_); }
+
+    const dowel_json_value_t* get() const noexcept { return value_; }
+    explicit operator bool() const noexcept { return value_ != nullptr; }
+
+private:
+    const dowel_json_value_t* value_ = nullptr;
+};
+
+class json_document {
+public:
+    json_document() noexcept = default;
+    explicit json_document(dowel_json_value_t* raw) noexcept : handle_(raw) {}
+
+    static json_document parse(zstring_view text) noexcept {
+        return json_document(dowel_json_parse(text.c_str()));
+    }
+
+    json_ref root() const noexcept { return json_ref(handle_.get()); }
+    json_ref operator[](zstring_view key) const noexcept { return root()[key]; }
+
+    // Valid until the next stringify() or until the document is destroyed
+    std::string_view stringify() const noexcept {
+        const char* text = dowel_json_stringify(handle_.get());
+        return text ? std::string_view(text) : std::string_view();
+    }
+
+    dowel_json_value_t* get() const noexcept { return handle_.get(); }
+    explicit operator bool() const noexcept { return static_cast<bool>(handle_); }
+
+private:
+    detail::unique_handle<dowel_json_value_t, dowel_json_free> handle_;
+};
+
+// On-demand JSON. json_cursor is a position that stays valid as long as the
+// json_lazy it came from; the text given to open() must outlive both.
+class json_cursor {
+public:
+    constexpr json_cursor() noexcept = default;
+    constexpr explicit json_cursor(dowel_json_cursor_t raw) noexcept : raw_(raw) {}
+
+    json_cursor operator[](zstring_view key) const noexcept {
+        return json_cursor(dowel_json_lazy_member(raw_, key.c_str()));
+    }
+    json_cursor operator[](std::size_t index) const noexcept {
+        return json_cursor(dowel_json_lazy_element(raw_, index));
+    }
+    json_cursor find(zstring_view pointer) const noexcept {
+        return json_cursor(dowel_json_lazy_find(raw_, pointer.c_str()));
+    }
+    std::size_t size() const noexcept { return dowel_json_lazy_count(raw_); }
+    dowel_json_type_t type() const noexcept { return dowel_json_lazy_type(raw_); }
+
+    std::string as_string() const {
+        std::string out;
+        std::int64_t length = dowel_json_lazy_get_string(raw_, nullptr, 0);
+        if (length > 0) {
+            out.resize(static_cast<std::size_t>(length));
+            dowel_json_lazy_get_string(raw_, out.data(), out.size() + 1);
+        }
+        return out;
+    }
+    std::int64_t as_int() const noexcept { return dowel_json_lazy_get_int(raw_); }
+    double as_float() const noexcept { return dowel_json_lazy_get_float(raw_); }
+    bool as_bool() const noexcept { return dowel_json_lazy_get_bool(raw_); }
+
+    // The value's text in the document, without unescaping
+    std::string_view raw() const noexcept {
+        std::size_t length = 0;
+        const char* text = dowel_json_lazy_raw(raw_, &length);
+        return text ? std::string_view(text, length) : std::string_view();
+    }
+
+    dowel_json_cursor_t get() const noexcept { return raw_; }
+    explicit operator bool() const noexcept { return raw_.at != DOWEL_JSON_NOWHERE; }
+
+private:
+    dowel_json_cursor_t raw_ = {nullptr, DOWEL_JSON_NOWHERE};
+};
+
+class json_lazy {
+public:
+    json_lazy() noexcept = default;
+    explicit json_lazy(dowel_json_lazy_t* raw) noexcept : handle_(raw) {}
+
+    // The text is borrowed: it must outlive the json_lazy and every cursor taken from it
+    static json_lazy open(zstring_view text) noexcept {
+        return json_lazy(dowel_json_lazy_open(text.c_str()));
+    }
+    static json_lazy open(const char* text) noexcept { return json_lazy(dowel_json_lazy_open(text)); }
+    static json_lazy open(std::string&&) = delete;
+
+    json_cursor root() const noexcept { return json_cursor(dowel_json_lazy_root(handle_.get())); }
+    json_cursor operator[](zstring_view key) const noexcept { return root()[key]; }
+    json_cursor find(zstring_view pointer) const noexcept { return root().find(pointer); }
+    std::size_t footprint() const noexcept { return dowel_json_lazy_footprint(handle_.get()); }
+
+    dowel_json_lazy_t* get() const noexcept { return handle_.get(); }
+    explicit operator bool() const noexcept { return static_cast<bool>(handle_); }
+
+private:
+    detail::unique_handle<dowel_json_lazy_t, dowel_json_lazy_close> handle_;
+};
+
+// Streaming JSON writer. Calls chain and the first error sticks, so a whole
+// document can be written and checked once with finish().
+class json_writer {
+public:
+    json_writer() noexcept = default;
+    explicit json_writer(dowel_json_writer_t* raw) noexcept : handle_(raw) {}
+
+    static json_writer create() noexcept { return json_writer(dowel_json_writer_create()); }
+    static json_writer create(arena& scratch) noexcept {
+        return json_writer(dowel_json_writer_create_in(scratch.get()));
+    }
+    // The stream must stay open until finish()
+    static json_writer create(storage::stream& out) noexcept {
+        return json_writer(dowel_json_writer_create_for_stream(out.get()));
+    }
+
+    json_writer& begin_object() noexcept { dowel_json_writer_begin_object(handle_.get()); return *this; }
+    json_writer& end_object() noexcept { dowel_json_writer_end_object(handle_.get()); return *this; }
+    json_writer& begin_array() noexcept { dowel_json_writer_begin_array(handle_.get()); return *this; }
+    json_writer& end_array() noexcept { dowel_json_writer_end_array(handle_.get()); return *this; }
+    json_writer& key(std::string_view name) noexcept {
+        dowel_json_writer_key(handle_.get(), name.data(), name.size());
+        return *this;
+    }
+
+    json_writer& value(std::string_view text) noexcept {
+        dowel_json_writer_string(handle_.get(), text.data(), text.size());
+        return *this;
+    }
+    json_writer& value(const char* text) noexcept { return value(std::string_view(text)); }
+    json_writer& value(bool flag) noexcept { dowel_json_writer_bool(handle_.get(), flag); return *this; }
+    template <std::integral T>
+    json_writer& value(T number) noexcept {
+        dowel_json_writer_int(handle_.get(), static_cast<std::int64_t>(number));
+        return *this;
+    }
+    json_writer& value(double number) noexcept { dowel_json_writer_float(handle_.get(), number); return *this; }
+    json_writer& null() noexcept { dowel_json_writer_null(handle_.get()); return *this; }
+    json_writer& raw(std::string_view json) noexcept {
+        dowel_json_writer_raw(handle_.get(), json.data(), json.size());
+        return *this;
+    }
+
+    int finish() noexcept { return dowel_json_writer_finish(handle_.get()); }
+    int error() const noexcept { return dowel_json_writer_error(handle_.get()); }
+    // Buffer writers: valid until the next write, reset or destruction
+    std::string_view text() noexcept {
+        std::size_t length = 0;
+        const char* out = dowel_json_writer_text(handle_.get(), &length);
+        return out ? std::string_view(out, length) : std::string_view();
+    }
+    void reset() noexcept { dowel_json_writer_reset(handle_.get()); }
+
+    dowel_json_writer_t* get() const noexcept { return handle_.get(); }
+    explicit operator bool() const noexcept { return static_cast<bool>(handle_); }
+
+private:
+    detail::unique_handle<dowel_json_writer_t, dowel_json_writer_destroy> handle_;
+};
+
+} // namespace dowel
+
+#endif // DOWEL_STEEK_CORE_HPP
@@ -0,0 +1,327 @@
+#ifndef DOWEL_STEEK_CORO_HPP
+#define DOWEL_STEEK_CORO_HPP
+
+// C++20 coroutines over the core's task pool, on top of dowel_steek_core.hpp.
+//
+// dowel::async::task<T> is a lazy coroutine: it starts when another coroutine
+// awaits it, or on the pool through start()/get(). Awaiting a dowel::task
+// handle, schedule() or an offloaded call (read_file, compress_gzip, ...)
+// suspends without holding a thread and resumes on the pool worker that
+// finishes the work, so one caller can keep hundreds of operations in flight
+// and block once at the end. (dowel::task stays the plain task handle; the
+// coroutine type lives in dowel::async next to the pool queries.)
+
+#include "dowel_steek_core.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace dowel {
+
+namespace detail {
+
+// dowel_callback_t that resumes a suspended coroutine
+inline void resume_coroutine(void* address) noexcept {
+    std::coroutine_handle<>::from_address(address).resume();
+}
+
+} // namespace detail
+
+// co_await on a task handle resumes once it has finished or been cancelled
+inline auto operator co_await(const task& antecedent) noexcept {
+    struct awaiter {
+        const task& antecedent;
+
+        bool await_ready() const noexcept { return antecedent.is_complete(); }
+        bool await_suspend(std::coroutine_handle<> awaiting) const noexcept {
+            dowel_task_t* next = dowel_async_finally(antecedent.get(), detail::resume_coroutine, awaiting.address());
+            if (!next) {
+                antecedent.wait();
+                return false;
+            }
+            dowel_async_detach(next);
+            return true;
+        }
+        void await_resume() const noexcept {}
+    };
+    return awaiter{ antecedent };
+}
+
+namespace async {
+
+template <typename T = void>
+class task;
+
+namespace detail {
+
+class promise_base {
+public:
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+
+    // Marks the coroutine finished and transfers to the awaiting coroutine, if
+    // any. Everything happens under the lock: wait() cannot return, and the
+    // owner cannot destroy this frame, until it is released.
+    struct final_awaiter {
+        bool await_ready() const noexcept { return false; }
+
+        template <typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> self) const noexcept {
+            promise_base& promise = self.promise();
+            std::lock_guard<std::mutex> guard(promise.lock_);
+            void* awaiting = promise.continuation_.exchange(finished_tag(), std::memory_order_acq_rel);
+            promise.finished_ = true;
+            promise.finished_cv_.notify_all();
+            return awaiting ? std::coroutine_handle<>::from_address(awaiting) : std::noop_coroutine();
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    final_awaiter final_suspend() const noexcept { return {}; }
+    void unhandled_exception() const noexcept { std::terminate(); }
+
+    // Registers the coroutine to resume when this one finishes; false if it
+    // already has
+    bool set_continuation(std::coroutine_handle<> awaiting) noexcept {
+        void* expected = nullptr;
+        return continuation_.compare_exchange_strong(expected, awaiting.address(),
+                                                     std::memory_order_acq_rel, std::memory_order_acquire);
+    }
+
+    bool is_finished() const noexcept {
+        return continuation_.load(std::memory_order_acquire) == finished_tag();
+    }
+
+    void wait() noexcept {
+        std::unique_lock<std::mutex> guard(lock_);
+        finished_cv_.wait(guard, [this] { return finished_; });
+    }
+
+private:
+    static void* finished_tag() noexcept {
+        static char tag;
+        return &tag;
+    }
+
+    std::atomic<void*> continuation_{ nullptr };
+    std::mutex lock_;
+    std::condition_variable finished_cv_;
+    bool finished_ = false;
+};
+
+template <typename T>
+class promise : public promise_base {
+public:
+    task<T> get_return_object() noexcept;
+
+    template <typename U>
+    void return_value(U&& value) noexcept(std::is_nothrow_constructible_v<T, U&&>) {
+        value_.emplace(std::forward<U>(value));
+    }
+
+    T take() noexcept { return std::move(*value_); }
+
+private:
+    std::optional<T> value_;
+};
+
+template <>
+class promise<void> : public promise_base {
+public:
+    task<void> get_return_object() noexcept;
+    void return_void() const noexcept {}
+    void take() const noexcept {}
+};
+
+} // namespace detail
+
+// Lazy coroutine producing a T. Move-only; destroying a started task waits
+// for it to finish. The result can be taken once, by co_await or get().
+template <typename T>
+class task {
+public:
+    using promise_type = detail::promise<T>;
+
+    task() noexcept = default;
+    explicit task(std::coroutine_handle<promise_type> handle) noexcept : handle_(handle) {}
+
+    task(task&& other) noexcept
+        : handle_(std::exchange(other.handle_, nullptr)), started_(std::exchange(other.started_, false)) {}
+    task& operator=(task&& other) noexcept {
+        if (this != &other) {
+            destroy();
+            handle_ = std::exchange(other.handle_, nullptr);
+            started_ = std::exchange(other.started_, false);
+        }
+        return *this;
+    }
+
+    ~task() { destroy(); }
+
+    // Begins running on the pool without waiting
+    void start() noexcept {
+        if (!handle_ || std::exchange(started_, true)) return;
+        dowel_task_t* first = dowel_async_spawn(dowel::detail::resume_coroutine, handle_.address());
+        if (first) {
+            dowel_async_detach(first);
+        } else {
+            handle_.resume();
+        }
+    }
+
+    // Starts if needed and blocks the calling thread until the result is ready.
+    // Meant for the edge of coroutine code; inside it, co_await instead.
+    T get() noexcept {
+        start();
+        handle_.promise().wait();
+        return handle_.promise().take();
+    }
+
+    bool is_ready() const noexcept { return handle_ && handle_.promise().is_finished(); }
+    explicit operator bool() const noexcept { return static_cast<bool>(handle_); }
+
+    auto operator co_await() noexcept {
+        struct awaiter {
+            std::coroutine_handle<promise_type> handle;
+            bool started;
+
+            bool await_ready() const noexcept { return started && handle.promise().is_finished(); }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) const noexcept {
+                if (!started) {
+                    handle.promise().set_continuation(awaiting);
+                    return handle;
+                }
+                if (handle.promise().set_continuation(awaiting)) return std::noop_coroutine();
+                return awaiting; // finished in the meantime
+            }
+            T await_resume() const noexcept { return handle.promise().take(); }
+        };
+        return awaiter{ handle_, std::exchange(started_, true) };
+    }
+
+private:
+    void destroy() noexcept {
+        if (!handle_) return;
+        if (started_) handle_.promise().wait();
+        handle_.destroy();
+        handle_ = nullptr;
+    }
+
+    std::coroutine_handle<promise_type> handle_;
+    bool started_ = false;
+};
+
+namespace detail {
+
+template <typename T>
+task<T> promise<T>::get_return_object() noexcept {
+    return task<T>(std::coroutine_handle<promise<T>>::from_promise(*this));
+}
+
+inline task<void> promise<void>::get_return_object() noexcept {
+    return task<void>(std::coroutine_handle<promise<void>>::from_promise(*this));
+}
+
+// Runs fn on the pool and resumes the awaiting coroutine there with its result
+template <typename F>
+class offload_awaiter {
+public:
+    using result_type = std::invoke_result_t<F&>;
+
+    explicit offload_awaiter(F fn) noexcept(std::is_nothrow_move_constructible_v<F>) : fn_(std::move(fn)) {}
+
+    bool await_ready() const noexcept { return false; }
+
+    bool await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        awaiting_ = awaiting;
+        dowel_task_t* work = dowel_async_spawn(run, this);
+        if (!work) {
+            // Pool unavailable: do the work here and carry on without suspending
+            invoke();
+            return false;
+        }
+        // Not this->anything from here on: run() may already have resumed the
+        // coroutine that owns this awaiter
+        dowel_async_detach(work);
+        return true;
+    }
+
+    result_type await_resume() noexcept {
+        if constexpr (!std::is_void_v<result_type>) return std::move(*result_);
+    }
+
+private:
+    struct empty {};
+    using stored_type = std::conditional_t<std::is_void_v<result_type>, empty, result_type>;
+
+    void invoke() noexcept {
+        if constexpr (std::is_void_v<result_type>) {
+            fn_();
+        } else {
+            result_.emplace(fn_());
+        }
+    }
+
+    static void run(void* data) noexcept {
+        auto* self = static_cast<offload_awaiter*>(data);
+        self->invoke();
+        self->awaiting_.resume();
+    }
+
+    F fn_;
+    std::optional<stored_type> result_;
+    std::coroutine_handle<> awaiting_;
+};
+
+} // namespace detail
+
+// co_await schedule() moves the rest of the coroutine onto the pool;
+// schedule(worker) prefers the given worker
+inline auto schedule(int worker = DOWEL_ASYNC_ANY_WORKER) noexcept {
+    struct awaiter {
+        int worker;
+
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(std::coroutine_handle<> awaiting) const noexcept {
+            dowel_task_t* next = dowel_async_spawn_on(worker, dowel::detail::resume_coroutine, awaiting.address());
+            if (!next) return false;
+            dowel_async_detach(next);
+            return true;
+        }
+        void await_resume() const noexcept {}
+    };
+    return awaiter{ worker };
+}
+
+// co_await offload(fn) runs fn() on a pool worker and yields its result
+template <typename F>
+auto offload(F fn) noexcept(std::is_nothrow_move_constructible_v<F>) {
+    return detail::offload_awaiter<F>(std::move(fn));
+}
+
+// Awaitable versions of the blocking calls. Each takes what it needs by
+// value or as a view the caller keeps alive until the co_await completes.
+inline auto read_file(std::string path) {
+    return offload([path = std::move(path)] { return storage::read_file(path); });
+}
+
+inline auto compress_gzip(bytes_view data) noexcept {
+    return offload([data] { return dowel::compress_gzip(data); });
+}
+
+inline auto decompress_gzip(bytes_view data) noexcept {
+    return offload([data] { return dowel::decompress_gzip(data); });
+}
+
+} // namespace async
+
+} // namespace dowel
+
+#endif // DOWEL_STEEK_CORO_HPP
@@ -11,6 +11,7 @@ pub const DowelError = enum(c_int) {
 
 // Global state
 var initialized: bool = false;
+var gpa = std.heap.GeneralPurposeAllocator(.{}){};
 var allocator: std.mem.Allocator = undefined;
 
 // Core system functions
@@ -18,7 +19,6 @@ export fn dowel_core_init() c_int {
     if (initialized) return @intFromEnum(DowelError.SUCCESS);
 
     // Use heap allocator for now
-    var gpa = std.heap.GeneralPurposeAllocator(.{}){};
     allocator = gpa.allocator();
 
     initialized = true;
@@ -64,19 +64,26 @@ export fn dowel_string_length(str: [*c]const u8) c_int {
 }
 
 // Memory allocation functions for Kotlin/Native interop
+//
+// Each block is preceded by a 16 byte header holding the requested size, so
+// dowel_free can hand the whole slice back to the allocator.
+const alloc_header_size = 16;
+
 export fn dowel_malloc(size: usize) ?*anyopaque {
     if (!initialized) return null;
 
-    const ptr = allocator.alloc(u8, size) catch return null;
-    return ptr.ptr;
+    const total = std.math.add(usize, size, alloc_header_size) catch return null;
+    const block = allocator.alignedAlloc(u8, alloc_header_size, total) catch return null;
+    @as(*usize, @ptrCast(block.ptr)).* = size;
+    return block.ptr + alloc_header_size;
 }
 
 export fn dowel_free(ptr: ?*anyopaque) void {
     if (!initialized or ptr == null) return;
 
-    // Note: We can't easily free without size info in this simple example
-    // In a real implementation, you'd track allocations
-    // For now, just ignore the pointer since we can't properly free it
+    const base: [*]align(alloc_header_size) u8 = @ptrFromInt(@intFromPtr(ptr.?) - alloc_header_size);
+    const size = @as(*usize, @ptrCast(base)).*;
+    allocator.free(base[0 .. size + alloc_header_size]);
 }
 
 // Configuration functions